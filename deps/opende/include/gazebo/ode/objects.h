@@ -95,21 +95,30 @@ ODE_API void dWorldDestroy (dWorldID world);
 ODE_API void dWorldSetGravity (dWorldID, dReal x, dReal y, dReal z);
 
 /**
- * @brief Get the number of thread pool threads for islands
+ * @brief Get the number of threads requested for islands
  *
  * @ingroup world
  */
 ODE_API int dWorldGetIslandThreads (dWorldID);
 
 /**
- * @brief Set the number of thread pool threads for islands
+ * @brief Set the number of threads that solve islands in parallel
+ *
+ * As before, at most num_island_threads islands are solved at the same
+ * time, but the stepping thread is one of them instead of waiting for a
+ * separate pool. Islands and the quickstep position correction share one
+ * work-stealing scheduler with the larger of the island and quickstep
+ * thread counts, instead of one pool of each size. Islands are started
+ * largest first.
  *
  * @ingroup world
  */
 ODE_API void dWorldSetIslandThreads (dWorldID, int num_island_threads);
 
 /**
- * @brief Set the number of thread pool threads for quickstep
+ * @brief Set the number of threads that solve the quickstep position
+ * correction alongside the rows. Row chunks are solved one after another,
+ * since they share bodies.
  *
  * @ingroup world
  */
@@ -606,6 +615,13 @@ ODE_API dReal dWorldGetQuickStepWarmStartFactor (dWorldID);
  */
 ODE_API int dWorldGetQuickStepExtraFrictionIterations (dWorldID);
 
+/**
+ * @brief Get whether independent PGS rows are solved with vector
+ * instructions.
+ * @ingroup world
+ */
+ODE_API bool dWorldGetQuickStepVectorizedRows (dWorldID);
+
 /**
  * @brief Get the friction model.
  * @ingroup world
@@ -678,6 +694,16 @@ ODE_API void dWorldSetQuickStepWarmStartFactor (dWorldID, dReal warm);
  */
 ODE_API void dWorldSetQuickStepExtraFrictionIterations (dWorldID, int iters);
 
+/**
+ * @brief Solve blocks of PGS rows that share no body with vector
+ * instructions. Rows that share a body keep their order, so the result
+ * matches the scalar sweep. Preconditioned iterations, cone friction and
+ * CPUs without AVX always use the scalar sweep.
+ * @ingroup world
+ * @param vectorized true to use the vectorized sweep (default).
+ */
+ODE_API void dWorldSetQuickStepVectorizedRows (dWorldID, bool vectorized);
+
 /**
  * @brief Set the friction model from: cone friction, pyramid friction
  * and box friction.
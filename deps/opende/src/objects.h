@@ -32,7 +32,7 @@
 #include <gazebo/ode/mass.h>
 #include <gazebo/ode/objects.h>
 #include "array.h"
-#include <boost/threadpool.hpp>
+#include "scheduler.h"
 
 class dxStepWorkingMemory;
 
@@ -123,6 +123,7 @@ struct dxQuickStepParameters {
   bool row_reorder1;  // control quickstep row reordering
   dReal warm_start;  // warm start factor, 0: no warm start, 1: full warm start
   int friction_iterations;  // extra quickstep iterations friction.
+  bool pgs_vectorized;  // solve independent PGS rows with vector instructions
   Friction_Model friction_model;  // friction model, enum type Friction_Model
   World_Solver_Type world_solver_type;  // world step solver, enum type World_Solver_Type.
 };
@@ -202,8 +203,9 @@ struct dxWorld : public dBase {
   dxContactParameters contactp;
   dxDampingParameters dampingp; // damping parameters
   dReal max_angular_speed;      // limit the angular velocity to this magnitude
-  boost::threadpool::pool *threadpool;
-  boost::threadpool::pool *row_threadpool;
+  int island_threads;            // threads requested for islands
+  int quickstep_threads;         // threads requested for quickstep rows
+  dxScheduler *scheduler;        // threads shared by islands and rows
 };
 
 
@@ -27,6 +27,8 @@
 // this source file is mostly concerned with the data structures, not the
 // numerics.
 
+#include <algorithm>
+
 #include <gazebo/ode/ode.h>
 #include <gazebo/ode/odemath.h>
 #include <gazebo/ode/matrix.h>
@@ -1669,6 +1671,7 @@ dxWorld * dWorldCreate()
   w->qs.row_reorder1 = true;
   w->qs.warm_start = 0.5;
   w->qs.friction_iterations = 10;
+  w->qs.pgs_vectorized = true;
   w->qs.friction_model = pyramid_friction;
   w->qs.world_solver_type = ODE_DEFAULT;
 
@@ -1681,8 +1684,9 @@ dxWorld * dWorldCreate()
   w->dampingp.angular_threshold = REAL(0.01) * REAL(0.01);
   w->max_angular_speed = dInfinity;
 
-  w->threadpool = NULL; // new boost::threadpool::pool(0);
-  w->row_threadpool = NULL; // new boost::threadpool::pool(0);
+  w->island_threads = 0;
+  w->quickstep_threads = 0;
+  w->scheduler = NULL;
 
   return w;
 }
@@ -1747,15 +1751,7 @@ void dWorldDestroy (dxWorld *w)
     w->wmem->Release();
   }
 
-  if (w->threadpool) {
-    w->threadpool->wait();
-    delete w->threadpool;
-  }
-
-  if (w->row_threadpool) {
-    w->row_threadpool->wait();
-    delete w->row_threadpool;
-  }
+  delete w->scheduler;
 
   delete w;
 }
@@ -1769,41 +1765,38 @@ void dWorldSetGravity (dWorldID w, dReal x, dReal y, dReal z)
   w->gravity[2] = z;
 }
 
+// islands and quickstep rows share one scheduler, sized for the larger of
+// the two requests so that they never oversubscribe each other
+static void dxWorldUpdateScheduler (dWorldID w)
+{
+  int threads = std::max(w->island_threads, w->quickstep_threads);
+  if (w->scheduler && w->scheduler->GetThreadCount() == threads)
+    return;
+  delete w->scheduler;
+  w->scheduler = NULL;
+  if (threads > 1) {
+    w->scheduler = new dxScheduler(threads);
+  }
+}
+
 int dWorldGetIslandThreads (dWorldID w)
 {
   dAASSERT (w);
-  if (!w->threadpool) {
-    return 0;
-  }
-  // else
-  return w->threadpool->size();
+  return w->island_threads;
 }
 
 void dWorldSetIslandThreads (dWorldID w, int num_island_threads)
 {
   dAASSERT (w);
-  if (w->threadpool) {
-    w->threadpool->wait();
-    delete w->threadpool;
-    w->threadpool = NULL;
-  }
-  if (num_island_threads > 0) {
-    w->threadpool = new boost::threadpool::pool(num_island_threads);
-  }
+  w->island_threads = num_island_threads > 0 ? num_island_threads : 0;
+  dxWorldUpdateScheduler (w);
 }
 
 void dWorldSetQuickStepThreads (dWorldID w, int num_quickstep_threads)
 {
   dAASSERT (w);
-  if (w->row_threadpool) {
-    w->row_threadpool->wait();
-    delete w->row_threadpool;
-    w->row_threadpool = NULL;
-  }
-  if (num_quickstep_threads > 0) {
-    w->row_threadpool = new boost::threadpool::pool(num_quickstep_threads);
-    printf("setting quickstep pool threads to %d\n",num_quickstep_threads);
-  }
+  w->quickstep_threads = num_quickstep_threads > 0 ? num_quickstep_threads : 0;
+  dxWorldUpdateScheduler (w);
 }
 
 void dWorldGetGravity (dWorldID w, dVector3 g)
@@ -2325,6 +2318,12 @@ int  dWorldGetQuickStepExtraFrictionIterations (dWorldID w)
   return w->qs.friction_iterations;
 }
 
+bool dWorldGetQuickStepVectorizedRows (dWorldID w)
+{
+  dAASSERT(w);
+  return w->qs.pgs_vectorized;
+}
+
 Friction_Model dWorldGetQuickStepFrictionModel (dWorldID w)
 {
   dAASSERT(w);
@@ -2379,6 +2378,12 @@ void dWorldSetQuickStepExtraFrictionIterations (dWorldID w, int iters)
   w->qs.friction_iterations = iters;
 }
 
+void dWorldSetQuickStepVectorizedRows (dWorldID w, bool vectorized)
+{
+  dAASSERT(w);
+  w->qs.pgs_vectorized = vectorized;
+}
+
 
 void dWorldSetQuickStepFrictionModel (dWorldID w, Friction_Model fricmodel)
 {
@@ -512,11 +512,7 @@ void dxQuickStepper (dxWorldProcessContext *context,
                caccel,caccel_erp,cforce,
                rhs,rhs_erp,rhs_precon,
                lo,hi,cfm,findex,
-               &world->qs
-#ifdef USE_TPROW
-               , world->row_threadpool
-#endif
-      );
+               &world->qs, world->scheduler);
 
     } END_STATE_SAVE(context, lcpstate);
 
@@ -0,0 +1,534 @@
+/*************************************************************************
+ *                                                                       *
+ * Open Dynamics Engine, Copyright (C) 2001,2002 Russell L. Smith.       *
+ * All rights reserved.  Email: russ@q12.org   Web: www.q12.org          *
+ *                                                                       *
+ * This library is free software; you can redistribute it and/or         *
+ * modify it under the terms of EITHER:                                  *
+ *   (1) The GNU Lesser General Public License as published by the Free  *
+ *       Software Foundation; either version 2.1 of the License, or (at  *
+ *       your option) any later version. The text of the GNU Lesser      *
+ *       General Public License is included with this library in the     *
+ *       file LICENSE.TXT.                                               *
+ *   (2) The BSD-style license that is included with this library in     *
+ *       the file LICENSE-BSD.TXT.                                       *
+ *                                                                       *
+ * This library is distributed in the hope that it will be useful,       *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the files    *
+ * LICENSE.TXT and LICENSE-BSD.TXT for more details.                     *
+ *                                                                       *
+ *************************************************************************/
+
+#include <algorithm>
+#include <cstdint>
+
+#include <gazebo/ode/common.h>
+#include <gazebo/ode/odemath.h>
+#include <gazebo/ode/error.h>
+#include "config.h"
+#include "objects.h"
+#include "joints/joint.h"
+#include "quickstep_pgs_blocks.h"
+
+// blocks are solved with gcc vector extensions and AVX, selected at run time
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define PGS_BLOCKS_X86 1
+
+// helpers of the sweep are inlined into the AVX function
+#define PGS_INLINE static inline __attribute__((always_inline, target("avx")))
+
+// the lane loops must be unrolled for the lanes to stay in registers
+#if defined(__clang__) || (defined(__GNUC__) && __GNUC__ >= 8)
+#define PGS_UNROLL _Pragma("GCC unroll 12")
+#else
+#define PGS_UNROLL
+#endif
+#endif
+
+using namespace ode;
+
+//***************************************************************************
+int quickstep::PGSBlockWidth()
+{
+  static const int width = []()
+  {
+#ifdef PGS_BLOCKS_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx"))
+      return 4;
+#endif
+    return 0;
+  }();
+  return width;
+}
+
+//***************************************************************************
+void quickstep::BuildPGSBlocks(PGSBlocks &_blocks, int _width,
+  const PGSSweep &_sweep, const IndexError *_order, int _startRow,
+  int _nRows, int _nb, const int *_jb, dRealPtr _J, dRealPtr _iMJ)
+{
+  _blocks.width = _width;
+  _blocks.count = 0;
+
+  // the level of a row is one more than the level of the last earlier row
+  // that shares a body with it. rows of one level are independent, and
+  // solving the levels in turn keeps every pair of dependent rows in order.
+  _blocks.bodyLevel.assign(_nb, 0);
+  _blocks.rowLevel.resize(_nRows);
+  _blocks.levelBlock.clear();
+  for (int i = 0; i < _nRows; ++i)
+  {
+    const int row = _order[_startRow + i].index;
+    const int body1 = _jb[row*2];
+    const int body2 = _jb[row*2+1];
+    int level = _blocks.bodyLevel[body1];
+    if (body2 >= 0)
+      level = std::max(level, _blocks.bodyLevel[body2]);
+    _blocks.bodyLevel[body1] = level + 1;
+    if (body2 >= 0)
+      _blocks.bodyLevel[body2] = level + 1;
+    _blocks.rowLevel[i] = level;
+
+    if (level >= static_cast<int>(_blocks.levelBlock.size()))
+      _blocks.levelBlock.resize(level + 1, 0);
+    // count rows per level for now
+    ++_blocks.levelBlock[level];
+  }
+
+  // first block of every level, and the lanes filled so far
+  const int levels = static_cast<int>(_blocks.levelBlock.size());
+  _blocks.levelLane.assign(levels, 0);
+  for (int level = 0; level < levels; ++level)
+  {
+    const int rows = _blocks.levelBlock[level];
+    _blocks.levelBlock[level] = _blocks.count;
+    _blocks.count += (rows + _width - 1) / _width;
+  }
+
+  const size_t lanes = static_cast<size_t>(_blocks.count) * _width;
+  if (_blocks.index.size() < lanes)
+  {
+    _blocks.index.resize(lanes);
+    _blocks.normal.resize(lanes);
+    _blocks.b1.resize(lanes);
+    _blocks.b2.resize(lanes);
+    _blocks.J.resize(lanes * 12);
+    _blocks.iMJ.resize(lanes * 12);
+    _blocks.rows.resize(lanes * 6);
+    _blocks.masks.resize(lanes * 7);
+  }
+  std::fill(_blocks.index.begin(), _blocks.index.begin() + lanes, 0);
+  std::fill(_blocks.normal.begin(), _blocks.normal.begin() + lanes, 0);
+  std::fill(_blocks.b1.begin(), _blocks.b1.begin() + lanes, -1);
+  std::fill(_blocks.b2.begin(), _blocks.b2.begin() + lanes, -1);
+  std::fill(_blocks.J.begin(), _blocks.J.begin() + lanes * 12, dReal(0));
+  std::fill(_blocks.iMJ.begin(), _blocks.iMJ.begin() + lanes * 12, dReal(0));
+  std::fill(_blocks.rows.begin(), _blocks.rows.begin() + lanes * 6, dReal(0));
+  std::fill(_blocks.masks.begin(), _blocks.masks.begin() + lanes * 7, 0);
+
+  const bool pyramid = _sweep.friction_model == pyramid_friction;
+  for (int i = 0; i < _nRows; ++i)
+  {
+    const int level = _blocks.rowLevel[i];
+    const int lane = _blocks.levelLane[level]++;
+    const int blk = _blocks.levelBlock[level] + lane / _width;
+    const int l = lane % _width;
+
+    const int row = _order[_startRow + i].index;
+    const int body2 = _jb[row*2+1];
+    const int constraint_index = _sweep.findex[row];
+    const bool friction = constraint_index >= 0;
+    _blocks.index[blk * _width + l] = row;
+    _blocks.normal[blk * _width + l] = friction ? constraint_index : row;
+    _blocks.b1[blk * _width + l] = _jb[row*2];
+    _blocks.b2[blk * _width + l] = body2;
+
+    // the second body columns of a row without one stay zero
+    dReal *J = &_blocks.J[blk * 12 * _width];
+    dReal *iMJ = &_blocks.iMJ[blk * 12 * _width];
+    const int columns = body2 >= 0 ? 12 : 6;
+    for (int k = 0; k < columns; ++k)
+    {
+      J[k * _width + l] = _J[row*12 + k];
+      iMJ[k * _width + l] = _iMJ[row*12 + k];
+    }
+
+    // the residual of a row is only recorded where Ad is not zero, see
+    // ComputeRows
+    dReal *rows = &_blocks.rows[blk * 6 * _width];
+    const dReal Ad = _sweep.Ad[row];
+    rows[0 * _width + l] = _sweep.hi[row];
+    rows[1 * _width + l] = _sweep.lo[row];
+    rows[2 * _width + l] = _sweep.Adcfm[row];
+    rows[3 * _width + l] = _sweep.rhs[row];
+    rows[4 * _width + l] = _sweep.rhs_erp ? _sweep.rhs_erp[row] : 0;
+    rows[5 * _width + l] = _dequal(Ad, 0.0) ? 0 : 1.0 / (Ad*Ad);
+
+    // torsional friction is scaled by the normal force in every model, the
+    // other friction rows only in the pyramid model. cone friction is never
+    // blocked.
+    int64_t *masks = &_blocks.masks[blk * 7 * _width];
+    masks[0 * _width + l] = -1;
+    masks[1 * _width + l] = -static_cast<int64_t>(friction);
+    masks[2 * _width + l] = -static_cast<int64_t>(friction &&
+        (row - constraint_index >= 3 || pyramid));
+    masks[3 * _width + l] = -static_cast<int64_t>(constraint_index != -1);
+    masks[4 * _width + l] = -static_cast<int64_t>(constraint_index == -1);
+    masks[5 * _width + l] = -static_cast<int64_t>(constraint_index == -2);
+    masks[6 * _width + l] = -static_cast<int64_t>(friction);
+  }
+}
+
+#ifdef PGS_BLOCKS_X86
+namespace
+{
+  // read in place of a missing body
+  const dReal zeroBody[6] = {0, 0, 0, 0, 0, 0};
+}
+
+//***************************************************************************
+// vector of W dReal, a lane mask of the same size, and unaligned variants
+// for loads from the block arrays
+template <int W> struct PGSVector;
+
+template <> struct PGSVector<2>
+{
+  typedef dReal type __attribute__((vector_size(2 * sizeof(dReal))));
+  typedef dReal unaligned __attribute__((vector_size(2 * sizeof(dReal)),
+    aligned(sizeof(dReal))));
+};
+
+template <> struct PGSVector<4>
+{
+  typedef dReal type __attribute__((vector_size(4 * sizeof(dReal))));
+  typedef int64_t mask __attribute__((vector_size(4 * sizeof(dReal))));
+  typedef dReal unaligned __attribute__((vector_size(4 * sizeof(dReal)),
+    aligned(sizeof(dReal))));
+  typedef int64_t umask __attribute__((vector_size(4 * sizeof(dReal)),
+    aligned(sizeof(int64_t))));
+};
+
+//***************************************************************************
+// _m ? _a : _b for every lane
+template <typename V, typename M>
+PGS_INLINE V PGSSelect(const M &_m, const V &_a, const V &_b)
+{
+  return (V)(((M)_a & _m) | ((M)_b & ~_m));
+}
+
+//***************************************************************************
+// lanes _i... of the concatenation of _a and _b
+#if defined(__clang__)
+#define PGS_SHUFFLE(_a, _b, ...) __builtin_shufflevector(_a, _b, __VA_ARGS__)
+#else
+#define PGS_SHUFFLE(_a, _b, ...) \
+  __builtin_shuffle(_a, _b, (PGSVector<4>::mask){__VA_ARGS__})
+#endif
+
+//***************************************************************************
+// Transpose the 6 constraint accelerations of W bodies into 6 vectors of W
+// lanes, and back. Gather builds a vector from W rows of a solver array.
+template <int W> struct PGSLanes;
+
+template <>
+struct PGSLanes<4>
+{
+  typedef PGSVector<4>::type vec;
+  typedef PGSVector<4>::mask mask;
+  typedef PGSVector<4>::unaligned uvec;
+
+  PGS_INLINE vec Gather(const dReal *_a, const int *_i)
+  {
+    return vec{_a[_i[0]], _a[_i[1]], _a[_i[2]], _a[_i[3]]};
+  }
+
+  PGS_INLINE void Load(vec *_c, const dReal *const *_p)
+  {
+    const vec r0 = *reinterpret_cast<const uvec *>(_p[0]);
+    const vec r1 = *reinterpret_cast<const uvec *>(_p[1]);
+    const vec r2 = *reinterpret_cast<const uvec *>(_p[2]);
+    const vec r3 = *reinterpret_cast<const uvec *>(_p[3]);
+    const vec t0 = PGS_SHUFFLE(r0, r1, 0, 4, 2, 6);
+    const vec t1 = PGS_SHUFFLE(r0, r1, 1, 5, 3, 7);
+    const vec t2 = PGS_SHUFFLE(r2, r3, 0, 4, 2, 6);
+    const vec t3 = PGS_SHUFFLE(r2, r3, 1, 5, 3, 7);
+    _c[0] = PGS_SHUFFLE(t0, t2, 0, 1, 4, 5);
+    _c[1] = PGS_SHUFFLE(t1, t3, 0, 1, 4, 5);
+    _c[2] = PGS_SHUFFLE(t0, t2, 2, 3, 6, 7);
+    _c[3] = PGS_SHUFFLE(t1, t3, 2, 3, 6, 7);
+
+    const vec u0 = {_p[0][4], _p[0][5], _p[2][4], _p[2][5]};
+    const vec u1 = {_p[1][4], _p[1][5], _p[3][4], _p[3][5]};
+    _c[4] = PGS_SHUFFLE(u0, u1, 0, 4, 2, 6);
+    _c[5] = PGS_SHUFFLE(u0, u1, 1, 5, 3, 7);
+  }
+
+  PGS_INLINE void Store(const vec *_c, dReal *const *_p)
+  {
+    const vec t0 = PGS_SHUFFLE(_c[0], _c[1], 0, 4, 2, 6);
+    const vec t1 = PGS_SHUFFLE(_c[0], _c[1], 1, 5, 3, 7);
+    const vec t2 = PGS_SHUFFLE(_c[2], _c[3], 0, 4, 2, 6);
+    const vec t3 = PGS_SHUFFLE(_c[2], _c[3], 1, 5, 3, 7);
+    *reinterpret_cast<uvec *>(_p[0]) = PGS_SHUFFLE(t0, t2, 0, 1, 4, 5);
+    *reinterpret_cast<uvec *>(_p[1]) = PGS_SHUFFLE(t1, t3, 0, 1, 4, 5);
+    *reinterpret_cast<uvec *>(_p[2]) = PGS_SHUFFLE(t0, t2, 2, 3, 6, 7);
+    *reinterpret_cast<uvec *>(_p[3]) = PGS_SHUFFLE(t1, t3, 2, 3, 6, 7);
+
+    typedef PGSVector<2>::type half;
+    typedef PGSVector<2>::unaligned uhalf;
+    const vec u0 = PGS_SHUFFLE(_c[4], _c[5], 0, 4, 2, 6);
+    const vec u1 = PGS_SHUFFLE(_c[4], _c[5], 1, 5, 3, 7);
+    *reinterpret_cast<uhalf *>(_p[0] + 4) = half{u0[0], u0[1]};
+    *reinterpret_cast<uhalf *>(_p[1] + 4) = half{u1[0], u1[1]};
+    *reinterpret_cast<uhalf *>(_p[2] + 4) = half{u0[2], u0[3]};
+    *reinterpret_cast<uhalf *>(_p[3] + 4) = half{u1[2], u1[3]};
+  }
+};
+#undef PGS_SHUFFLE
+
+//***************************************************************************
+// Solve all blocks with W lanes per vector. Every lane performs the
+// operations of the non-precon branch of ComputeRows in the same order, so
+// lambda and caccel match the scalar sweep. Rows of different types share
+// a block, so the limits are selected with lane masks instead of branches.
+template <int W, bool ERP>
+PGS_INLINE void SweepBlocks(const quickstep::PGSBlocks &_blocks,
+  const quickstep::PGSSweep &_s, dReal *_rms_dlambda, dReal *_rms_error,
+  int *_m_rms_dlambda)
+{
+  typedef typename PGSVector<W>::type vec;
+  typedef typename PGSVector<W>::mask mask;
+  typedef typename PGSVector<W>::unaligned uvec;
+  typedef typename PGSVector<W>::umask umask;
+  typedef PGSLanes<W> lanes;
+
+  // a missing body is read from zeroBody and written to a lane of its own,
+  // so blocks never depend on each other through it. J and iMJ of missing
+  // bodies are zero in the blocks.
+  dReal discard[W][6];
+
+  const vec zero = vec() * 0;
+  const mask none = (mask)zero & 0;
+  const mask abs_mask = none | 0x7fffffffffffffffLL;
+  // extra friction iterations skip all but the friction rows
+  const mask all_rows = _s.friction_only ? none : ~none;
+#ifdef SMOOTH_LAMBDA
+  const bool smoothing = !_s.position_correction_thread;
+  const vec smooth_old = zero + _s.smooth_contacts;
+  const vec smooth_new = zero + (1.0 - _s.smooth_contacts);
+#endif
+
+  // squared lambda updates, residuals and row counts per row type, kept in
+  // registers and added to the totals at the end of the sweep
+  vec sum_dlambda[3] = {zero, zero, zero};
+  vec sum_error[3] = {zero, zero, zero};
+  mask count[3] = {none, none, none};
+
+  for (int blk = 0; blk < _blocks.count; ++blk)
+  {
+    const int *row = &_blocks.index[blk * W];
+    const int *normal_row = &_blocks.normal[blk * W];
+    const int *b1 = &_blocks.b1[blk * W];
+    const int *b2 = &_blocks.b2[blk * W];
+    const uvec *Jb =
+      reinterpret_cast<const uvec *>(&_blocks.J[blk * 12 * W]);
+    const uvec *iMJb =
+      reinterpret_cast<const uvec *>(&_blocks.iMJ[blk * 12 * W]);
+    const uvec *rows =
+      reinterpret_cast<const uvec *>(&_blocks.rows[blk * 6 * W]);
+    const umask *masks =
+      reinterpret_cast<const umask *>(&_blocks.masks[blk * 7 * W]);
+
+    const dReal *r1[W], *r2[W], *re1[W], *re2[W];
+    dReal *w1[W], *w2[W], *we1[W], *we2[W];
+    PGS_UNROLL
+    for (int l = 0; l < W; ++l)
+    {
+      w1[l] = b1[l] >= 0 ? _s.caccel + 6*b1[l] : discard[l];
+      w2[l] = b2[l] >= 0 ? _s.caccel + 6*b2[l] : discard[l];
+      r1[l] = b1[l] >= 0 ? w1[l] : zeroBody;
+      r2[l] = b2[l] >= 0 ? w2[l] : zeroBody;
+      if (ERP)
+      {
+        we1[l] = b1[l] >= 0 ? _s.caccel_erp + 6*b1[l] : discard[l];
+        we2[l] = b2[l] >= 0 ? _s.caccel_erp + 6*b2[l] : discard[l];
+        re1[l] = b1[l] >= 0 ? we1[l] : zeroBody;
+        re2[l] = b2[l] >= 0 ? we2[l] : zeroBody;
+      }
+    }
+
+    // padding lanes read row 0, they and skipped rows are inactive and
+    // keep their bodies unchanged
+    const mask is_friction = masks[1];
+    const mask is_scaled = masks[2];
+    const mask is_active = masks[0] & (is_friction | all_rows);
+    const vec hi_row = rows[0];
+    const vec lo_row = rows[1];
+    const vec Adcfm = rows[2];
+
+    // set the limits for this constraint. the normal row of a friction
+    // row is in an earlier level, so its lambda is up to date.
+#define PGS_LIMITS(lambda, lo_act, hi_act) \
+    const vec hi_act = PGSSelect(is_scaled, \
+        (vec)((mask)(hi_row*lanes::Gather(lambda, normal_row)) & abs_mask), \
+        hi_row); \
+    const vec lo_act = PGSSelect(is_friction, -hi_act, lo_row);
+
+    // compute lambda and clamp it to [lo,hi]
+#define PGS_CLAMP(old_lambda, lambda, delta, lo_act, hi_act) \
+    vec lambda = old_lambda + delta; \
+    { \
+      const mask below = (mask)(lambda < lo_act); \
+      const mask above = (mask)(lambda > hi_act) & ~below; \
+      delta = PGSSelect(below, lo_act - old_lambda, \
+          PGSSelect(above, hi_act - old_lambda, delta)); \
+      lambda = PGSSelect(below, lo_act, PGSSelect(above, hi_act, lambda)); \
+    }
+
+    // J * caccel of every lane, associated like quickstep::dot6. a missing
+    // second body contributes an exact zero.
+#ifdef ODE_SSE
+#define PGS_DOT6(c, j) \
+    ((c[0]*j[0] + c[2]*j[2] + c[4]*j[4]) + (c[1]*j[1] + c[3]*j[3] + c[5]*j[5]))
+#else
+#define PGS_DOT6(c, j) \
+    (c[0]*j[0] + c[1]*j[1] + c[2]*j[2] + c[3]*j[3] + c[4]*j[4] + c[5]*j[5])
+#endif
+
+    vec c1[6], c2[6];
+    lanes::Load(c1, r1);
+    lanes::Load(c2, r2);
+    const vec old_lambda = lanes::Gather(_s.lambda, row);
+    vec delta = rows[3] - old_lambda*Adcfm;
+    delta -= PGS_DOT6(c1, Jb);
+    delta -= PGS_DOT6(c2, (Jb + 6));
+
+    PGS_LIMITS(_s.lambda, lo_act, hi_act)
+    PGS_CLAMP(old_lambda, lambda, delta, lo_act, hi_act)
+#ifdef SMOOTH_LAMBDA
+    if (smoothing)
+    {
+      lambda = PGSSelect(masks[3],
+          smooth_new*lambda + smooth_old*old_lambda, lambda);
+    }
+#endif
+    delta = PGSSelect(is_active, delta, zero);
+
+    // update caccel
+    PGS_UNROLL
+    for (int k = 0; k < 6; ++k)
+    {
+      c1[k] += delta * iMJb[k];
+      c2[k] += delta * iMJb[k + 6];
+    }
+    lanes::Store(c1, w1);
+    lanes::Store(c2, w2);
+
+    if (ERP)
+    {
+      vec ce1[6], ce2[6];
+      lanes::Load(ce1, re1);
+      lanes::Load(ce2, re2);
+      const vec old_lambda_erp = lanes::Gather(_s.lambda_erp, row);
+      vec delta_erp = rows[4] - old_lambda_erp*Adcfm;
+      delta_erp -= PGS_DOT6(ce1, Jb);
+      delta_erp -= PGS_DOT6(ce2, (Jb + 6));
+
+      PGS_LIMITS(_s.lambda_erp, lo_act_erp, hi_act_erp)
+      PGS_CLAMP(old_lambda_erp, lambda_erp, delta_erp, lo_act_erp,
+          hi_act_erp)
+      delta_erp = PGSSelect(is_active, delta_erp, zero);
+
+      PGS_UNROLL
+      for (int k = 0; k < 6; ++k)
+      {
+        ce1[k] += delta_erp * iMJb[k];
+        ce2[k] += delta_erp * iMJb[k + 6];
+      }
+      lanes::Store(ce1, we1);
+      lanes::Store(ce2, we2);
+
+      PGS_UNROLL
+      for (int l = 0; l < W; ++l)
+      {
+        if (is_active[l])
+          _s.lambda_erp[row[l]] = lambda_erp[l];
+      }
+    }
+#undef PGS_DOT6
+#undef PGS_CLAMP
+#undef PGS_LIMITS
+
+    PGS_UNROLL
+    for (int l = 0; l < W; ++l)
+    {
+      if (is_active[l])
+        _s.lambda[row[l]] = lambda[l];
+    }
+
+    // record residual (error) (for the non-erp version)
+    const vec delta2 = delta*delta;
+    const vec error2 = delta2*rows[5];
+    PGS_UNROLL
+    for (int t = 0; t < 3; ++t)
+    {
+      const mask is_type = masks[4 + t] & is_active;
+      sum_dlambda[t] += PGSSelect(is_type, delta2, zero);
+      sum_error[t] += PGSSelect(is_type, error2, zero);
+      count[t] -= is_type;
+    }
+  }
+
+  PGS_UNROLL
+  for (int t = 0; t < 3; ++t)
+  {
+    PGS_UNROLL
+    for (int l = 0; l < W; ++l)
+    {
+      _rms_dlambda[t] += sum_dlambda[t][l];
+      _rms_error[t] += sum_error[t][l];
+      _m_rms_dlambda[t] += static_cast<int>(count[t][l]);
+    }
+  }
+}
+
+//***************************************************************************
+template <int W>
+PGS_INLINE void SweepBlocks(const quickstep::PGSBlocks &_blocks,
+  const quickstep::PGSSweep &_s, dReal *_rms_dlambda, dReal *_rms_error,
+  int *_m_rms_dlambda)
+{
+  if (_s.inline_position_correction)
+    SweepBlocks<W, true>(_blocks, _s, _rms_dlambda, _rms_error,
+        _m_rms_dlambda);
+  else
+    SweepBlocks<W, false>(_blocks, _s, _rms_dlambda, _rms_error,
+        _m_rms_dlambda);
+}
+
+//***************************************************************************
+__attribute__((target("avx")))
+static void SweepBlocksAVX(const quickstep::PGSBlocks &_blocks,
+  const quickstep::PGSSweep &_s, dReal *_rms_dlambda, dReal *_rms_error,
+  int *_m_rms_dlambda)
+{
+  SweepBlocks<4>(_blocks, _s, _rms_dlambda, _rms_error, _m_rms_dlambda);
+}
+#endif
+
+//***************************************************************************
+void quickstep::SweepPGSBlocks(const PGSBlocks &_blocks,
+  const PGSSweep &_sweep, dReal *_rms_dlambda, dReal *_rms_error,
+  int *_m_rms_dlambda)
+{
+#ifdef PGS_BLOCKS_X86
+  if (_blocks.width == 4)
+  {
+    SweepBlocksAVX(_blocks, _sweep, _rms_dlambda, _rms_error,
+        _m_rms_dlambda);
+    return;
+  }
+#endif
+  dMessage (d_ERR_UASSERT, "internal error, unsupported PGS block width");
+}
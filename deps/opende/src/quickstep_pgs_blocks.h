@@ -0,0 +1,149 @@
+/*************************************************************************
+ *                                                                       *
+ * Open Dynamics Engine, Copyright (C) 2001,2002 Russell L. Smith.       *
+ * All rights reserved.  Email: russ@q12.org   Web: www.q12.org          *
+ *                                                                       *
+ * This library is free software; you can redistribute it and/or         *
+ * modify it under the terms of EITHER:                                  *
+ *   (1) The GNU Lesser General Public License as published by the Free  *
+ *       Software Foundation; either version 2.1 of the License, or (at  *
+ *       your option) any later version. The text of the GNU Lesser      *
+ *       General Public License is included with this library in the     *
+ *       file LICENSE.TXT.                                               *
+ *   (2) The BSD-style license that is included with this library in     *
+ *       the file LICENSE-BSD.TXT.                                       *
+ *                                                                       *
+ * This library is distributed in the hope that it will be useful,       *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the files    *
+ * LICENSE.TXT and LICENSE-BSD.TXT for more details.                     *
+ *                                                                       *
+ *************************************************************************/
+
+#ifndef _ODE_QUICK_STEP_PGS_BLOCKS_H_
+#define _ODE_QUICK_STEP_PGS_BLOCKS_H_
+
+#include <cstdint>
+#include <vector>
+
+#include <gazebo/ode/common.h>
+#include "objects.h"
+#include "quickstep_util.h"
+
+namespace ode {
+    namespace quickstep{
+
+/// \brief Constraint rows of one PGS chunk packed into blocks of
+/// independent rows, stored as structure-of-arrays.
+///
+/// Rows are grouped by level: a row is one level above the last earlier
+/// row it shares a body with. Rows of one level never touch the same body,
+/// so a block can be solved with vector instructions, consecutive blocks of
+/// a level do not wait on each other, and rows that share a body are still
+/// solved in the original order. This gives the same lambda as the scalar
+/// sweep.
+struct PGSBlocks
+{
+  /// \brief Number of rows (lanes) per block.
+  int width;
+
+  /// \brief Number of blocks.
+  int count;
+
+  /// \brief Row index of each lane, 0 for padding, [count * width].
+  std::vector<int> index;
+
+  /// \brief Row holding the normal force of each friction lane, the row
+  /// itself otherwise, [count * width].
+  std::vector<int> normal;
+
+  /// \brief First body of each lane, -1 for padding, [count * width].
+  std::vector<int> b1;
+
+  /// \brief Second body of each lane, -1 if none, [count * width].
+  std::vector<int> b2;
+
+  /// \brief J of each block as 12 rows of width lanes, [count * 12 * width].
+  std::vector<dReal> J;
+
+  /// \brief iMJ of each block as 12 rows of width lanes,
+  /// [count * 12 * width].
+  std::vector<dReal> iMJ;
+
+  /// \brief Constant row data of each block as hi, lo, Adcfm, rhs, rhs_erp
+  /// and 1/Ad^2, width lanes each, [count * 6 * width].
+  std::vector<dReal> rows;
+
+  /// \brief Lane masks of each block as valid, friction, scaled, smooth and
+  /// the three row types, width lanes each, [count * 7 * width].
+  std::vector<int64_t> masks;
+
+  /// \brief Scratch: level of the next row of each body.
+  std::vector<int> bodyLevel;
+
+  /// \brief Scratch: level of each row of the chunk.
+  std::vector<int> rowLevel;
+
+  /// \brief Scratch: first block of each level.
+  std::vector<int> levelBlock;
+
+  /// \brief Scratch: lanes filled in each level.
+  std::vector<int> levelLane;
+};
+
+/// \brief Inputs of a vectorized PGS sweep, mirroring the non-precon
+/// branch of ComputeRows.
+struct PGSSweep
+{
+  const int *findex;
+  dRealPtr hi;
+  dRealPtr lo;
+  dRealPtr Ad;
+  dRealPtr Adcfm;
+  dRealPtr rhs;
+  dRealMutablePtr caccel;
+  dRealMutablePtr lambda;
+  dRealPtr rhs_erp;
+  dRealMutablePtr caccel_erp;
+  dRealMutablePtr lambda_erp;
+  bool inline_position_correction;
+  bool position_correction_thread;
+  Friction_Model friction_model;
+  dReal smooth_contacts;
+
+  /// \brief Only solve friction rows (extra friction iterations).
+  bool friction_only;
+};
+
+/// \brief Native number of lanes of the vectorized sweep on this CPU.
+/// \return 4 when AVX is available, 0 if rows are not vectorized.
+int PGSBlockWidth();
+
+/// \brief Pack the rows order[_startRow, _startRow + _nRows) into blocks.
+/// \param[out] _blocks Blocks to fill, storage is reused between calls.
+/// \param[in] _width Number of lanes per block.
+/// \param[in] _sweep Solver state, only the constant row data is read.
+/// \param[in] _order Constraint solving order.
+/// \param[in] _startRow First row of the chunk.
+/// \param[in] _nRows Number of rows of the chunk.
+/// \param[in] _nb Number of bodies.
+/// \param[in] _jb Body pair of each row.
+/// \param[in] _J Scaled Jacobian, 12 dReal per row.
+/// \param[in] _iMJ inv(M)*J', 12 dReal per row.
+void BuildPGSBlocks(PGSBlocks &_blocks, int _width, const PGSSweep &_sweep,
+  const IndexError *_order, int _startRow, int _nRows, int _nb,
+  const int *_jb, dRealPtr _J, dRealPtr _iMJ);
+
+/// \brief Run one PGS sweep over all blocks.
+/// \param[in] _blocks Blocks built by BuildPGSBlocks.
+/// \param[in] _sweep Solver state.
+/// \param[in,out] _rms_dlambda Sum of squared lambda updates per row type.
+/// \param[in,out] _rms_error Sum of squared residuals per row type.
+/// \param[in,out] _m_rms_dlambda Number of rows solved per row type.
+void SweepPGSBlocks(const PGSBlocks &_blocks, const PGSSweep &_sweep,
+  dReal *_rms_dlambda, dReal *_rms_error, int *_m_rms_dlambda);
+
+    } // namespace quickstep
+} // namespace ode
+
+#endif
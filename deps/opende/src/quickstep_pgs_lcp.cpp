@@ -19,7 +19,9 @@
 * LICENSE.TXT and LICENSE-BSD.TXT for more details.                     *
 *                                                                       *
 *************************************************************************/
+#include <algorithm>
 #include <thread>
+#include <vector>
 
 #include <gazebo/ode/common.h>
 #include <gazebo/ode/odemath.h>
@@ -40,6 +42,7 @@
 
 #include "quickstep_util.h"
 #include "quickstep_pgs_lcp.h"
+#include "quickstep_pgs_blocks.h"
 #ifndef TIMING
 #ifdef HDF5_INSTRUMENT
 #define DUMP
@@ -62,19 +65,25 @@ static void* ComputeRows(void *p)
   // printf("thread %d started at time %f\n",thread_id,cur_time);
   #endif
 
-  IndexError* order             = params->order;
   dxBody* const* body           = params->body;
-#ifdef RANDOMLY_REORDER_CONSTRAINTS
-#ifdef LOCK_WHILE_RANDOMLY_REORDER_CONSTRAINTS
-  boost::recursive_mutex* mutex = params->mutex;
-#endif
-#endif
   bool inline_position_correction = params->inline_position_correction;
   bool position_correction_thread = params->position_correction_thread;
 
   dxQuickStepParameters *qs    = params->qs;
   int startRow                 = params->nStart;   // 0
   int nRows                    = params->nChunkSize; // m
+
+#if defined(REORDER_CONSTRAINTS) || defined(RANDOMLY_REORDER_CONSTRAINTS)
+  // reorder a private copy of our segment, so chunks that overlap
+  // never swap the same entries and no lock is needed.
+  static thread_local std::vector<IndexError> chunk_order;
+  chunk_order.resize(startRow + nRows);
+  std::copy(params->order + startRow, params->order + startRow + nRows,
+      chunk_order.begin() + startRow);
+  IndexError* order             = chunk_order.data();
+#else
+  IndexError* order             = params->order;
+#endif
 #ifdef USE_1NORM
   int m                        = params->m; // m used for rms error computation
 #endif
@@ -180,6 +189,39 @@ static void* ComputeRows(void *p)
   Friction_Model friction_model = qs->friction_model;
   dReal smooth_contacts = qs->smooth_contacts;
 
+  // solve blocks of rows that share no body with vector instructions.
+  // preconditioning, cone friction, skipped friction rows and CPUs without
+  // AVX keep the scalar sweep.
+#ifdef PENETRATION_JVERROR_CORRECTION
+  bool use_blocks = false;
+#else
+  bool use_blocks = qs->pgs_vectorized && !skip_friction &&
+    friction_model != cone_friction && nRows > 1 &&
+    quickstep::PGSBlockWidth() > 0;
+#endif
+  static thread_local quickstep::PGSBlocks blocks;
+  bool blocks_dirty = true;
+  quickstep::PGSSweep sweep;
+  if (use_blocks)
+  {
+    sweep.findex = findex;
+    sweep.hi = hi;
+    sweep.lo = lo;
+    sweep.Ad = Ad;
+    sweep.Adcfm = Adcfm;
+    sweep.rhs = rhs;
+    sweep.caccel = caccel;
+    sweep.lambda = lambda;
+    sweep.rhs_erp = rhs_erp;
+    sweep.caccel_erp = caccel_erp;
+    sweep.lambda_erp = lambda_erp;
+    sweep.inline_position_correction = inline_position_correction;
+    sweep.position_correction_thread = position_correction_thread;
+    sweep.friction_model = friction_model;
+    sweep.smooth_contacts = smooth_contacts;
+    sweep.friction_only = false;
+  }
+
 #ifdef SHOW_CONVERGENCE
     // show starting lambda
     printf("lambda start: [");
@@ -263,15 +305,14 @@ static void* ComputeRows(void *p)
     //    than copying the data. we must make sure lambda is properly
     //    returned to the caller
     memcpy (last_lambda+startRow,lambda+startRow,nRows*sizeof(dReal));
+    blocks_dirty = true;
 
     //if (thread_id == 0) for (int i=startRow;i<startRow+nRows;i++) printf("-----> %d %d %d %f %d\n",thread_id,iteration,i,order[i].error,order[i].index);
 
 #endif
 #ifdef RANDOMLY_REORDER_CONSTRAINTS
     if ((iteration & 7) == 0) {
-      #ifdef LOCK_WHILE_RANDOMLY_REORDER_CONSTRAINTS
-        boost::recursive_mutex::scoped_lock lock(*mutex); // lock for every swap
-      #endif
+      blocks_dirty = true;
       //  int swapi = dRandInt(i+1); // swap across engire matrix
       for (int i=startRow+1; i<startRow+nRows; i++) { // swap within boundary of our own segment
         int swapi = dRandInt(i+1-startRow)+startRow; // swap within boundary of our own segment
@@ -301,8 +342,21 @@ static void* ComputeRows(void *p)
     const dReal stepsize1 = dRecip(stepsize);
     dReal Jvnew = 0;
 #endif
-    for (int i=startRow; i<startRow+nRows; i++) {
-      //boost::recursive_mutex::scoped_lock lock(*mutex); // lock for every row
+    const bool block_sweep = use_blocks && iteration >= precon_iterations;
+    if (block_sweep)
+    {
+      if (blocks_dirty)
+      {
+        quickstep::BuildPGSBlocks(blocks, quickstep::PGSBlockWidth(), sweep,
+            order, startRow, nRows, nb, jb, J, iMJ);
+        blocks_dirty = false;
+      }
+      sweep.friction_only = iteration >= (num_iterations + precon_iterations);
+      quickstep::SweepPGSBlocks(blocks, sweep, rms_dlambda, rms_error,
+          m_rms_dlambda);
+    }
+
+    for (int i=startRow; !block_sweep && i<startRow+nRows; i++) {
 
       // @@@ potential optimization: we could pre-sort J and iMJ, thereby
       //     linearizing access to those arrays. hmmm, this does not seem
@@ -975,11 +1029,7 @@ void quickstep::PGS_LCP (dxWorldProcessContext *context,
   dRealMutablePtr caccel, dRealMutablePtr caccel_erp, dRealMutablePtr cforce,
   dRealMutablePtr rhs, dRealMutablePtr rhs_erp, dRealMutablePtr rhs_precon,
   dRealPtr lo, dRealPtr hi, dRealPtr cfm, const int *findex,
-  dxQuickStepParameters *qs
-#ifdef USE_TPROW
-  , boost::threadpool::pool* row_threadpool
-#endif
-  )
+  dxQuickStepParameters *qs, dxScheduler *scheduler)
 {
 
   // precompute iMJ = inv(M)*J'
@@ -1197,9 +1247,6 @@ void quickstep::PGS_LCP (dxWorldProcessContext *context,
   dReal *last_lambda_erp = context->AllocateArray<dReal> (m);
 #endif
 
-  boost::recursive_mutex* mutex =
-    context->AllocateArray<boost::recursive_mutex>(1);
-
   // number of chunks must be at least 1
   // (single iteration, through all the constraints)
   int num_chunks = qs->num_chunks > 0 ? qs->num_chunks : 1; // min is 1
@@ -1246,8 +1293,6 @@ void quickstep::PGS_LCP (dxWorldProcessContext *context,
     int nEnd   = i + chunk + qs->num_overlap;
     if (nEnd > m) nEnd = m;
 
-    std::thread params_erp_thread;
-
     if (qs->thread_position_correction && params_erp != NULL)
     {
       // setup params for ComputeRows
@@ -1259,7 +1304,6 @@ void quickstep::PGS_LCP (dxWorldProcessContext *context,
       params_erp[thread_id].thread_id = thread_id;
       params_erp[thread_id].order     = order;
       params_erp[thread_id].body      = body;
-      params_erp[thread_id].mutex     = mutex;
       params_erp[thread_id].inline_position_correction = false;
       params_erp[thread_id].position_correction_thread = true;
 #ifdef PENETRATION_JVERROR_CORRECTION
@@ -1303,23 +1347,6 @@ void quickstep::PGS_LCP (dxWorldProcessContext *context,
       printf("thread summary: id %d i %d m %d chunk %d start %d end %d \n",
         thread_id,i,m,chunk,nStart,nEnd);
 #endif
-
-#ifdef USE_TPROW
-      if (row_threadpool && row_threadpool->size() > 1)
-      {
-        // skip threadpool if less than 2 threads allocated
-        // printf("threading out for params_erp\n");
-        row_threadpool->schedule(boost::bind(*ComputeRows, (void*)(&params_erp[thread_id])));
-      }
-      else
-      {
-        params_erp_thread = std::thread(*ComputeRows,
-          (void*)(&(params_erp[thread_id])));
-      }
-#else
-      params_erp_thread = std::thread(*ComputeRows,
-        (void*)(&(params_erp[thread_id])));
-#endif
     }
 
 
@@ -1327,7 +1354,6 @@ void quickstep::PGS_LCP (dxWorldProcessContext *context,
     params[thread_id].thread_id = thread_id;
     params[thread_id].order     = order;
     params[thread_id].body      = body;
-    params[thread_id].mutex     = mutex;
     params[thread_id].inline_position_correction = !qs->thread_position_correction;
     params[thread_id].position_correction_thread = false;
 #ifdef PENETRATION_JVERROR_CORRECTION
@@ -1380,41 +1406,49 @@ void quickstep::PGS_LCP (dxWorldProcessContext *context,
     printf("thread summary: id %d i %d m %d chunk %d start %d end %d \n",
       thread_id,i,m,chunk,nStart,nEnd);
 #endif
-#ifdef USE_TPROW
-    if (row_threadpool && row_threadpool->size() > 0)
+  }
+
+  // chunks share bodies, so they are solved one after another. only the
+  // position correction of a chunk runs at the same time as the chunk,
+  // since the two solves write to separate caccel and lambda arrays.
+  const int num_chunks = thread_id;
+  const bool erp_task = qs->thread_position_correction && params_erp != NULL;
+  for (int chunk_id = 0; chunk_id < num_chunks; ++chunk_id)
+  {
+    if (!erp_task)
     {
-      // skip threadpool if less than 2 threads allocated
-      // printf("threading out for params\n");
-      row_threadpool->schedule(boost::bind(*ComputeRows, (void*)(&(params[thread_id]))));
+      ComputeRows((void*)(&(params[chunk_id])));
+    }
+    else if (scheduler)
+    {
+      // the world scheduler may also be solving other islands
+      scheduler->ParallelFor(2, [&](int _task)
+      {
+        if (_task == 1)
+          ComputeRows((void*)(&(params_erp[chunk_id])));
+        else
+          ComputeRows((void*)(&(params[chunk_id])));
+      });
     }
     else
-      ComputeRows((void*)(&(params[thread_id])));
-#else
-    ComputeRows((void*)(&(params[thread_id])));
-#endif
-
-    if (qs->thread_position_correction && params_erp_thread.joinable())
     {
+      std::thread params_erp_thread(*ComputeRows,
+        (void*)(&(params_erp[chunk_id])));
+
+      ComputeRows((void*)(&(params[chunk_id])));
+
       IFTIMING (dTimerNow ("wait for params_erp threads"));
       params_erp_thread.join();
       IFTIMING (dTimerNow ("params_erp threads done"));
     }
   }
 
-
   // check time for scheduling, this is usually very quick
   //gettimeofday(&tv,NULL);
   //double wait_time = (double)tv.tv_sec + (double)tv.tv_usec / 1.e6;
   //printf("      quickstep done scheduling start time %f stopped time %f duration %f\n",
   //       cur_time,wait_time,wait_time - cur_time);
 
-#ifdef USE_TPROW
-  IFTIMING (dTimerNow ("wait for threads"));
-  if (row_threadpool && row_threadpool->size() > 0)
-    row_threadpool->wait();
-  IFTIMING (dTimerNow ("threads done"));
-#endif
-
 
   #ifdef REPORT_THREAD_TIMING
   gettimeofday(&tv,NULL);
@@ -1584,7 +1618,6 @@ size_t quickstep::EstimatePGS_LCPMemoryRequirements(int m,int /*nb*/)
 #endif
   res += dEFFICIENT_SIZE(sizeof(dxPGSLCPParameters) * m); // for params_erp
   res += dEFFICIENT_SIZE(sizeof(dxPGSLCPParameters) * m); // for params
-  res += dEFFICIENT_SIZE(sizeof(boost::recursive_mutex)); // for mutex
   return res;
 }
 
@@ -43,11 +43,7 @@ void PGS_LCP (dxWorldProcessContext *context,
   dRealMutablePtr caccel, dRealMutablePtr caccel_erp, dRealMutablePtr cforce,
   dRealMutablePtr rhs, dRealMutablePtr rhs_erp, dRealMutablePtr rhs_precon,
   dRealPtr lo, dRealPtr hi, dRealPtr cfm, const int *findex,
-  dxQuickStepParameters *qs
-#ifdef USE_TPROW
-  , boost::threadpool::pool* row_threadpool
-#endif
-  );
+  dxQuickStepParameters *qs, dxScheduler *scheduler);
 
 /// \brief Compute the hi and lo bound for cone friction model to project onto
 /// \param[in] lo_act The low bound for cone friction model to project onto
@@ -33,7 +33,6 @@
 
 
 #undef REPORT_THREAD_TIMING
-#undef USE_TPROW
 #undef TIMING
 #undef DEBUG_CONVERGENCE_TOLERANCE
 #undef SHOW_CONVERGENCE
@@ -54,13 +53,6 @@
 #endif  // instrument
 #endif  // timing
 
-#ifdef USE_TPROW
-// added for threading per constraint rows
-#include <boost/thread/recursive_mutex.hpp>
-#include <boost/bind.hpp>
-#include "gazebo/ode/odeinit.h"
-#endif
-
 typedef const dReal *dRealPtr;
 typedef dReal *dRealMutablePtr;
 
@@ -87,7 +79,6 @@ typedef dReal *dRealMutablePtr;
 // or hardly at all, but it doesn't seem to hurt.
 
 // #define RANDOMLY_REORDER_CONSTRAINTS 1
-#undef LOCK_WHILE_RANDOMLY_REORDER_CONSTRAINTS
 
 //***************************************************************************
 // testing stuff
@@ -125,7 +116,6 @@ struct dxPGSLCPParameters {
     int thread_id;
     IndexError* order;
     dxBody* const* body;
-    boost::recursive_mutex* mutex;
     bool inline_position_correction;
     bool position_correction_thread;
     dxQuickStepParameters *qs;
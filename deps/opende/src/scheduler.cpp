@@ -0,0 +1,217 @@
+/*************************************************************************
+ *                                                                       *
+ * Open Dynamics Engine, Copyright (C) 2001,2002 Russell L. Smith.       *
+ * All rights reserved.  Email: russ@q12.org   Web: www.q12.org          *
+ *                                                                       *
+ * This library is free software; you can redistribute it and/or         *
+ * modify it under the terms of EITHER:                                  *
+ *   (1) The GNU Lesser General Public License as published by the Free  *
+ *       Software Foundation; either version 2.1 of the License, or (at  *
+ *       your option) any later version. The text of the GNU Lesser      *
+ *       General Public License is included with this library in the     *
+ *       file LICENSE.TXT.                                               *
+ *   (2) The BSD-style license that is included with this library in     *
+ *       the file LICENSE-BSD.TXT.                                       *
+ *                                                                       *
+ * This library is distributed in the hope that it will be useful,       *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the files    *
+ * LICENSE.TXT and LICENSE-BSD.TXT for more details.                     *
+ *                                                                       *
+ *************************************************************************/
+
+#include <algorithm>
+
+#include "scheduler.h"
+
+namespace
+{
+  // scheduler and deque of the current worker thread
+  thread_local const dxScheduler *workerScheduler = nullptr;
+  thread_local int workerSlot = 0;
+}
+
+//***************************************************************************
+dxScheduler::dxScheduler(int _threads)
+  : threadCount(_threads > 1 ? _threads : 1), generation(0), stop(false)
+{
+  // the calling thread works on its own jobs, so it counts towards the
+  // budget
+  for (int i = 0; i < this->threadCount; ++i)
+    this->queues.emplace_back(new Queue);
+  for (int i = 1; i < this->threadCount; ++i)
+    this->workers.emplace_back(&dxScheduler::Work, this, i);
+}
+
+//***************************************************************************
+dxScheduler::~dxScheduler()
+{
+  {
+    std::lock_guard<std::mutex> lock(this->sleepMutex);
+    this->stop = true;
+  }
+  this->wake.notify_all();
+  for (auto &worker : this->workers)
+    worker.join();
+}
+
+//***************************************************************************
+int dxScheduler::GetThreadCount() const
+{
+  return this->threadCount;
+}
+
+//***************************************************************************
+int dxScheduler::Slot() const
+{
+  return workerScheduler == this ? workerSlot : 0;
+}
+
+//***************************************************************************
+void dxScheduler::ParallelFor(int _count,
+  const std::function<void(int)> &_fn)
+{
+  if (_count <= 0)
+    return;
+  if (this->workers.empty() || _count == 1)
+  {
+    for (int i = 0; i < _count; ++i)
+      _fn(i);
+    return;
+  }
+
+  dxSchedulerJob job;
+  job.fn = &_fn;
+  job.count = _count;
+  job.next = 0;
+  job.done = 0;
+
+  const int slot = this->Slot();
+  Queue &queue = *this->queues[slot];
+  {
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    queue.jobs.push_back(&job);
+  }
+  {
+    std::lock_guard<std::mutex> lock(this->sleepMutex);
+    ++this->generation;
+  }
+  this->wake.notify_all();
+
+  // work on our own job first
+  for (int i = job.next++; i < _count; i = job.next++)
+  {
+    _fn(i);
+    ++job.done;
+  }
+
+  // other threads find the job through the deque only, so once it is
+  // removed no new index can be claimed and it only has to outlive the
+  // indices that are still running
+  {
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    auto it = std::find(queue.jobs.begin(), queue.jobs.end(), &job);
+    if (it != queue.jobs.end())
+      queue.jobs.erase(it);
+  }
+
+  // help with other jobs while the last indices finish, and sleep when
+  // there are none. the thread that completes the job wakes us up.
+  while (job.done.load() < _count)
+  {
+    unsigned int seen;
+    {
+      std::lock_guard<std::mutex> lock(this->sleepMutex);
+      seen = this->generation;
+    }
+
+    if (this->RunOne(slot))
+      continue;
+
+    std::unique_lock<std::mutex> lock(this->sleepMutex);
+    this->wake.wait(lock, [this, &job, _count, seen]
+    {
+      return job.done.load() >= _count || this->generation != seen;
+    });
+  }
+}
+
+//***************************************************************************
+bool dxScheduler::RunOne(int _slot)
+{
+  const int queueCount = static_cast<int>(this->queues.size());
+  for (int k = 0; k < queueCount; ++k)
+  {
+    // newest job of our own deque, then the oldest job of the others
+    const bool own = k == 0;
+    Queue &queue = *this->queues[(_slot + k) % queueCount];
+
+    dxSchedulerJob *job = nullptr;
+    int index = 0;
+    {
+      std::lock_guard<std::mutex> lock(queue.mutex);
+      while (!queue.jobs.empty())
+      {
+        dxSchedulerJob *candidate =
+          own ? queue.jobs.back() : queue.jobs.front();
+        index = candidate->next++;
+        if (index < candidate->count)
+        {
+          job = candidate;
+          break;
+        }
+        // every index is claimed, the job no longer needs to be found
+        if (own)
+          queue.jobs.pop_back();
+        else
+          queue.jobs.pop_front();
+      }
+    }
+
+    if (job)
+    {
+      (*job->fn)(index);
+      // the owner may return as soon as done reaches count, so the job is
+      // not touched after this
+      const int count = job->count;
+      if (++job->done == count)
+      {
+        // taking the lock orders the notification after the owner either
+        // saw the count or started waiting
+        std::lock_guard<std::mutex> lock(this->sleepMutex);
+        this->wake.notify_all();
+      }
+      return true;
+    }
+  }
+  return false;
+}
+
+//***************************************************************************
+void dxScheduler::Work(int _slot)
+{
+  workerScheduler = this;
+  workerSlot = _slot;
+
+  for (;;)
+  {
+    unsigned int seen;
+    {
+      std::lock_guard<std::mutex> lock(this->sleepMutex);
+      if (this->stop)
+        return;
+      seen = this->generation;
+    }
+
+    while (this->RunOne(_slot))
+    {
+    }
+
+    // sleep until a job is pushed after the search above started
+    std::unique_lock<std::mutex> lock(this->sleepMutex);
+    this->wake.wait(lock, [this, seen]
+    {
+      return this->stop || this->generation != seen;
+    });
+  }
+}
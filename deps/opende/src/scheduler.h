@@ -0,0 +1,128 @@
+/*************************************************************************
+ *                                                                       *
+ * Open Dynamics Engine, Copyright (C) 2001,2002 Russell L. Smith.       *
+ * All rights reserved.  Email: russ@q12.org   Web: www.q12.org          *
+ *                                                                       *
+ * This library is free software; you can redistribute it and/or         *
+ * modify it under the terms of EITHER:                                  *
+ *   (1) The GNU Lesser General Public License as published by the Free  *
+ *       Software Foundation; either version 2.1 of the License, or (at  *
+ *       your option) any later version. The text of the GNU Lesser      *
+ *       General Public License is included with this library in the     *
+ *       file LICENSE.TXT.                                               *
+ *   (2) The BSD-style license that is included with this library in     *
+ *       the file LICENSE-BSD.TXT.                                       *
+ *                                                                       *
+ * This library is distributed in the hope that it will be useful,       *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the files    *
+ * LICENSE.TXT and LICENSE-BSD.TXT for more details.                     *
+ *                                                                       *
+ *************************************************************************/
+
+#ifndef _ODE_SCHEDULER_H_
+#define _ODE_SCHEDULER_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/// \brief A task of dxScheduler::ParallelFor, shared by the threads that
+/// help with it.
+struct dxSchedulerJob
+{
+  /// \brief Function to run for every index.
+  const std::function<void(int)> *fn;
+
+  /// \brief Number of indices.
+  int count;
+
+  /// \brief Next index to claim.
+  std::atomic<int> next;
+
+  /// \brief Number of indices completed.
+  std::atomic<int> done;
+};
+
+/// \brief Persistent work-stealing thread pool shared by island and row
+/// parallelism of a world.
+///
+/// Every worker owns a deque of jobs. A thread runs the newest job of its
+/// own deque first, so nested work (the rows of an island) finishes before
+/// new outer work is started, and steals the oldest job of another deque
+/// when its own is empty. A thread waiting for its job to complete keeps
+/// running other jobs, so nested ParallelFor calls never block a worker and
+/// the total number of busy threads stays within the thread budget. It
+/// sleeps when there is nothing to run, until the job completes or another
+/// job is pushed.
+class dxScheduler
+{
+  /// \brief Constructor.
+  /// \param[in] _threads Number of threads that run jobs, including the
+  /// calling thread, which takes part in its own jobs.
+  public: explicit dxScheduler(int _threads);
+
+  /// \brief Destructor, stops and joins the workers.
+  public: ~dxScheduler();
+
+  /// \brief Number of threads that run jobs, including the caller.
+  /// \return Thread budget given to the constructor.
+  public: int GetThreadCount() const;
+
+  /// \brief Run _fn(i) for every i in [0, _count) and wait for all of them.
+  /// Indices are claimed in increasing order, so the caller should put the
+  /// most expensive work first. May be called from inside a job.
+  /// \param[in] _count Number of indices.
+  /// \param[in] _fn Function to run for every index.
+  public: void ParallelFor(int _count, const std::function<void(int)> &_fn);
+
+  /// \brief Main loop of a worker.
+  /// \param[in] _slot Deque owned by the worker.
+  private: void Work(int _slot);
+
+  /// \brief Claim and run one index of some job.
+  /// \param[in] _slot Deque of the calling thread, searched first.
+  /// \return False if no job had an unclaimed index.
+  private: bool RunOne(int _slot);
+
+  /// \brief Deque of the calling thread, 0 for threads that are not
+  /// workers of this scheduler.
+  private: int Slot() const;
+
+  /// \brief Jobs of one thread.
+  private: struct Queue
+  {
+    std::mutex mutex;
+    std::deque<dxSchedulerJob *> jobs;
+  };
+
+  /// \brief Thread budget.
+  private: int threadCount;
+
+  /// \brief One deque per worker, slot 0 is used by outside callers.
+  private: std::vector<std::unique_ptr<Queue>> queues;
+
+  /// \brief Worker threads.
+  private: std::vector<std::thread> workers;
+
+  /// \brief Protects generation and stop, and orders job completion
+  /// with the owner going to sleep.
+  private: std::mutex sleepMutex;
+
+  /// \brief Wakes idle threads when a job is pushed or completes, and on
+  /// shutdown.
+  private: std::condition_variable wake;
+
+  /// \brief Incremented for every pushed job.
+  private: unsigned int generation;
+
+  /// \brief True when the workers should exit.
+  private: bool stop;
+};
+
+#endif
@@ -25,8 +25,8 @@
 #include "objects.h"
 #include "joints/joint.h"
 #include "util.h"
-#include <boost/thread/recursive_mutex.hpp>
-#include <boost/bind.hpp>
+#include <algorithm>
+#include <vector>
 #include <gazebo/ode/timer.h>
 
 #undef REPORT_THREAD_TIMING
@@ -593,6 +593,16 @@ void dxProcessOneIsland(dxWorldProcessContext *island_context, dxWorld *world, d
 #endif
 }
 
+// an island of dxProcessIslands
+struct dxIslandTask
+{
+  dxBody *const *bodystart;
+  int bcount;
+  dxJoint *const *jointstart;
+  int jcount;
+  dxStepWorkingMemory *wmem;
+};
+
 void dxProcessIslands (dxWorld *world, dReal stepsize, dstepper_fn_t stepper)
 {
   const int sizeelements = 2;
@@ -624,35 +634,47 @@ void dxProcessIslands (dxWorld *world, dReal stepsize, dstepper_fn_t stepper)
   printf(">>>>>>>>>>>> start island spawn threads at time %f\n",cur_time);
 #endif
 
+  // island start pointers and working memory, in discovery order
+  std::vector<dxIslandTask> islands;
+  islands.reserve(islandcount);
   for (int const *sizescurr = islandsizes; sizescurr != sizesend; sizescurr += sizeelements) {
-    int bcount = sizescurr[0];
-    int jcount = sizescurr[1];
-
-    // get working memory for each island
-    dxStepWorkingMemory *island_wmem = world->island_wmems[island_index++];
-    dIASSERT(island_wmem != NULL);
-    dxWorldProcessContext *island_context = island_wmem->GetWorldProcessingContext();
-
-#define USE_TPISLAND
-#ifdef USE_TPISLAND
-    IFTIMING(dTimerNow("scheduling island"));
-    //printf("debug opende tp %d\n",world->threadpool->size());
-    if (world->threadpool && world->threadpool->size() > 0)
-      world->threadpool->schedule(boost::bind(dxProcessOneIsland,island_context, world, stepsize, stepper,bodystart, bcount, jointstart, jcount));
-    else //automatically skip threadpool if only 1 thread allocated
-      dxProcessOneIsland(island_context, world, stepsize, stepper,bodystart, bcount, jointstart, jcount);
-#else
-    dxProcessOneIsland(island_context, world, stepsize, stepper,bodystart, bcount, jointstart, jcount);
-#endif
+    dxIslandTask island;
+    island.bodystart = bodystart;
+    island.bcount = sizescurr[0];
+    island.jointstart = jointstart;
+    island.jcount = sizescurr[1];
+    island.wmem = world->island_wmems[island_index++];
+    dIASSERT(island.wmem != NULL);
+    islands.push_back(island);
+
+    bodystart += island.bcount;
+    jointstart += island.jcount;
+  }
 
-    bodystart += bcount;
-    jointstart += jcount;
+  if (world->scheduler && islands.size() > 1) {
+    // start the largest islands first, so one big island does not end up
+    // last with every other thread idle. rows of an island are solved on
+    // the same scheduler, so islands and rows share the thread budget.
+    IFTIMING(dTimerNow("scheduling islands"));
+    std::stable_sort(islands.begin(), islands.end(),
+      [](const dxIslandTask &_a, const dxIslandTask &_b) {
+        return _a.jcount + _a.bcount > _b.jcount + _b.bcount;
+      });
+    world->scheduler->ParallelFor(static_cast<int>(islands.size()),
+      [&](int _i) {
+        const dxIslandTask &island = islands[_i];
+        dxProcessOneIsland(island.wmem->GetWorldProcessingContext(), world,
+          stepsize, stepper, island.bodystart, island.bcount,
+          island.jointstart, island.jcount);
+      });
+  }
+  else {
+    for (const dxIslandTask &island : islands) {
+      dxProcessOneIsland(island.wmem->GetWorldProcessingContext(), world,
+        stepsize, stepper, island.bodystart, island.bcount,
+        island.jointstart, island.jcount);
+    }
   }
-#ifdef USE_TPISLAND
-  IFTIMING(dTimerNow("islands wait"));
-  if (world->threadpool && world->threadpool->size() > 0)
-    world->threadpool->wait();
-#endif
   IFTIMING(dTimerEnd());
   IFTIMING(dTimerReport (stdout,1));
 
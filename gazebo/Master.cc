@@ -15,9 +15,13 @@
  *
 */
 
+#include <algorithm>
 #include <functional>
 #include <thread>
 #include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 #include <boost/bind.hpp>
 #include <boost/make_shared.hpp>
@@ -33,6 +37,26 @@ using namespace gazebo;
 
 namespace gazebo
 {
+  /// \brief Publishers and subscribers of a topic.
+  struct MasterTopic
+  {
+    /// \brief Publishers of the topic, in the order they advertised.
+    std::vector<Master::PubList::iterator> publishers;
+
+    /// \brief Subscribers of the topic, in the order they subscribed.
+    std::vector<Master::SubList::iterator> subscribers;
+  };
+
+  /// \brief Topics a connection advertised or subscribed to.
+  struct MasterConnectionTopics
+  {
+    /// \brief Topics the connection advertised.
+    std::unordered_set<std::string> published;
+
+    /// \brief Topics the connection subscribed to.
+    std::unordered_set<std::string> subscribed;
+  };
+
   struct MasterPrivate
   {
     /// \brief All the known publishers.
@@ -41,6 +65,29 @@ namespace gazebo
     /// \brief All the known subscribers.
     gazebo::Master::SubList subscribers;
 
+    /// \brief Publishers and subscribers by topic name.
+    std::unordered_map<std::string, MasterTopic> topics;
+
+    /// \brief Topics of each connection, by connection index.
+    std::unordered_map<unsigned int, MasterConnectionTopics> connectionTopics;
+
+    /// \brief All the publishers, kept up to date as publishers are
+    /// advertised, and rebuilt after a publisher is removed.
+    msgs::Publishers publishersMsg;
+
+    /// \brief False when publishersMsg must be rebuilt.
+    bool publishersMsgValid = true;
+
+    /// \brief The publishers_init packet sent to new connections, shared
+    /// by all the connections accepted while no publisher changes.
+    std::string publishersInit;
+
+    /// \brief False when publishersInit must be serialized again.
+    bool publishersInitValid = false;
+
+    /// \brief Index of the next accepted connection.
+    unsigned int nextConnectionIndex = 0;
+
     /// \brief All the known connections.
     gazebo::Master::Connection_M connections;
 
@@ -59,7 +106,8 @@ namespace gazebo
     /// \brief True to stop Master.
     bool stop;
 
-    /// \brief Mutex to protect connections.
+    /// \brief Mutex to protect connections, and the publishers and
+    /// subscribers.
     std::recursive_mutex connectionMutex;
 
     /// \brief Mutex to protect msg bufferes.
@@ -105,40 +153,50 @@ void Master::OnAccept(transport::ConnectionPtr _newConnection)
   versionMsg.set_data(std::string("gazebo ") + GAZEBO_VERSION);
   _newConnection->EnqueueMsg(msgs::Package("version_init", versionMsg), true);
 
-  // Send all the current topic namespaces
-  msgs::GzString_V namespacesMsg;
-  std::list<std::string>::iterator iter;
-  for (iter = this->dataPtr->worldNames.begin();
-       iter != this->dataPtr->worldNames.end(); ++iter)
-  {
-    namespacesMsg.add_data(*iter);
-  }
-  _newConnection->EnqueueMsg(msgs::Package("topic_namepaces_init",
-                              namespacesMsg), true);
-
-  // Send all the publishers
-  msgs::Publishers publishersMsg;
-  PubList::iterator pubiter;
-  for (pubiter = this->dataPtr->publishers.begin();
-       pubiter != this->dataPtr->publishers.end(); ++pubiter)
+  // The initial messages are only queued while the connection mutex is
+  // held, and written once it is released, so that a slow peer does not
+  // stall the other master operations. Queueing them before the
+  // connection is added keeps them ahead of any later publisher_add.
+  unsigned int index;
   {
-    msgs::Publish *pub = publishersMsg.add_publisher();
-    pub->CopyFrom(pubiter->first);
-  }
-  _newConnection->EnqueueMsg(
-      msgs::Package("publishers_init", publishersMsg), true);
+    std::lock_guard<std::recursive_mutex> lock(
+        this->dataPtr->connectionMutex);
 
-  // Add the connection to our list
-  {
-    std::lock_guard<std::recursive_mutex> lock(this->dataPtr->connectionMutex);
-    int index = this->dataPtr->connections.size();
+    // Send all the current topic namespaces
+    msgs::GzString_V namespacesMsg;
+    std::list<std::string>::iterator iter;
+    for (iter = this->dataPtr->worldNames.begin();
+         iter != this->dataPtr->worldNames.end(); ++iter)
+    {
+      namespacesMsg.add_data(*iter);
+    }
+    _newConnection->EnqueueMsg(msgs::Package("topic_namepaces_init",
+                                namespacesMsg), false);
 
-    this->dataPtr->connections[index] = _newConnection;
+    // Send all the publishers. The packet is only serialized again after
+    // the publishers change, so a burst of connections shares it. Later
+    // changes reach the connection as publisher_add and publisher_del.
+    if (!this->dataPtr->publishersInitValid)
+    {
+      this->dataPtr->publishersInit =
+        msgs::Package("publishers_init", this->PublishersMsg());
+      this->dataPtr->publishersInitValid = true;
+    }
+    _newConnection->EnqueueMsg(this->dataPtr->publishersInit, false);
 
-    // Start reading from the connection
-    _newConnection->AsyncRead(
-        boost::bind(&Master::OnRead, this, index, _1));
+    // Add the connection to our list. Indices are never reused, so
+    // messages still queued for a removed connection are not given to a
+    // new one.
+    index = this->dataPtr->nextConnectionIndex++;
+    this->dataPtr->connections[index] = _newConnection;
   }
+
+  // Write the queued messages
+  _newConnection->ProcessWriteQueue();
+
+  // Start reading from the connection
+  _newConnection->AsyncRead(
+      boost::bind(&Master::OnRead, this, index, _1));
 }
 
 //////////////////////////////////////////////////
@@ -148,12 +206,17 @@ void Master::OnRead(const unsigned int _connectionIndex,
   if (this->dataPtr->stop)
     return;
 
-  if (!this->dataPtr->connections[_connectionIndex] ||
-      !this->dataPtr->connections[_connectionIndex]->IsOpen())
-    return;
-
   // Get the connection
-  transport::ConnectionPtr conn = this->dataPtr->connections[_connectionIndex];
+  transport::ConnectionPtr conn;
+  {
+    std::lock_guard<std::recursive_mutex> lock(this->dataPtr->connectionMutex);
+    auto iter = this->dataPtr->connections.find(_connectionIndex);
+    if (iter != this->dataPtr->connections.end())
+      conn = iter->second;
+  }
+
+  if (!conn || !conn->IsOpen())
+    return;
 
   // Read the next message
   if (conn && conn->IsOpen())
@@ -177,11 +240,14 @@ void Master::OnRead(const unsigned int _connectionIndex,
 void Master::SendSubscribers(const std::string &_topic,
                              const std::string &_buffer)
 {
+  auto topicIter = this->dataPtr->topics.find(_topic);
+  if (topicIter == this->dataPtr->topics.end())
+    return;
+
   // Find all subscribers for this topic
   std::set<transport::ConnectionPtr> uniqueConnections;
-  for (auto const &subscriber : this->dataPtr->subscribers)
-    if (subscriber.first.topic() == _topic)
-      uniqueConnections.insert(subscriber.second);
+  for (auto const &subscriber : topicIter->second.subscribers)
+    uniqueConnections.insert(subscriber->second);
 
   // Send message to all unique connections
   for (auto &conn : uniqueConnections)
@@ -192,190 +258,186 @@ void Master::SendSubscribers(const std::string &_topic,
 void Master::ProcessMessage(const unsigned int _connectionIndex,
                             const std::string &_data)
 {
-  transport::ConnectionPtr conn = this->dataPtr->connections[_connectionIndex];
+  // Replies that are written right away. They are built while the
+  // connection mutex is held, and written once it is released, so a slow
+  // peer does not stall the other master operations.
+  transport::ConnectionPtr conn;
+  std::string reply;
 
-  if (!conn || !conn->IsOpen())
-    return;
+  {
+    std::lock_guard<std::recursive_mutex> lock(
+        this->dataPtr->connectionMutex);
 
-  msgs::Packet packet;
-  packet.ParseFromString(_data);
+    auto connIter = this->dataPtr->connections.find(_connectionIndex);
+    if (connIter == this->dataPtr->connections.end())
+      return;
 
-  if (packet.type() == "register_topic_namespace")
-  {
-    msgs::GzString worldNameMsg;
-    worldNameMsg.ParseFromString(packet.serialized_data());
+    conn = connIter->second;
+    if (!conn || !conn->IsOpen())
+      return;
 
-    std::list<std::string>::iterator iter;
-    iter = std::find(this->dataPtr->worldNames.begin(),
-                     this->dataPtr->worldNames.end(),
-                     worldNameMsg.data());
-    if (iter == this->dataPtr->worldNames.end())
+    msgs::Packet packet;
+    packet.ParseFromString(_data);
+
+    if (packet.type() == "register_topic_namespace")
     {
-      std::lock_guard<std::recursive_mutex>
-          lock(this->dataPtr->connectionMutex);
-      this->dataPtr->worldNames.push_back(worldNameMsg.data());
+      msgs::GzString worldNameMsg;
+      worldNameMsg.ParseFromString(packet.serialized_data());
 
-      Connection_M::iterator iter2;
-      for (iter2 = this->dataPtr->connections.begin();
-          iter2 != this->dataPtr->connections.end(); ++iter2)
+      std::list<std::string>::iterator iter;
+      iter = std::find(this->dataPtr->worldNames.begin(),
+                       this->dataPtr->worldNames.end(),
+                       worldNameMsg.data());
+      if (iter == this->dataPtr->worldNames.end())
       {
-        iter2->second->EnqueueMsg(
-            msgs::Package("topic_namespace_add", worldNameMsg));
+        std::lock_guard<std::recursive_mutex>
+            lock(this->dataPtr->connectionMutex);
+        this->dataPtr->worldNames.push_back(worldNameMsg.data());
+
+        Connection_M::iterator iter2;
+        for (iter2 = this->dataPtr->connections.begin();
+            iter2 != this->dataPtr->connections.end(); ++iter2)
+        {
+          iter2->second->EnqueueMsg(
+              msgs::Package("topic_namespace_add", worldNameMsg));
+        }
       }
     }
-  }
-  else if (packet.type() == "advertise")
-  {
-    std::lock_guard<std::recursive_mutex> lock(this->dataPtr->connectionMutex);
-    msgs::Publish pub;
-    pub.ParseFromString(packet.serialized_data());
-
-    Connection_M::iterator iter2;
-    for (iter2 = this->dataPtr->connections.begin();
-         iter2 != this->dataPtr->connections.end(); ++iter2)
+    else if (packet.type() == "advertise")
     {
-      iter2->second->EnqueueMsg(msgs::Package("publisher_add", pub));
-    }
+      msgs::Publish pub;
+      pub.ParseFromString(packet.serialized_data());
 
-    this->dataPtr->publishers.push_back(std::make_pair(pub, conn));
-
-    this->SendSubscribers(pub.topic(),
-        msgs::Package("publisher_advertise", pub));
-  }
-  else if (packet.type() == "unadvertise")
-  {
-    msgs::Publish pub;
-    pub.ParseFromString(packet.serialized_data());
-    this->RemovePublisher(pub);
-  }
-  else if (packet.type() == "unsubscribe")
-  {
-    msgs::Subscribe sub;
-    sub.ParseFromString(packet.serialized_data());
-    this->RemoveSubscriber(sub);
-  }
-  else if (packet.type() == "subscribe")
-  {
-    msgs::Subscribe sub;
-    sub.ParseFromString(packet.serialized_data());
+      Connection_M::iterator iter2;
+      for (iter2 = this->dataPtr->connections.begin();
+           iter2 != this->dataPtr->connections.end(); ++iter2)
+      {
+        iter2->second->EnqueueMsg(msgs::Package("publisher_add", pub));
+      }
 
-    this->dataPtr->subscribers.push_back(std::make_pair(sub, conn));
+      this->dataPtr->publishers.push_back(std::make_pair(pub, conn));
+      this->dataPtr->topics[pub.topic()].publishers.push_back(
+          std::prev(this->dataPtr->publishers.end()));
+      this->dataPtr->connectionTopics[_connectionIndex].published.insert(
+          pub.topic());
 
-    PubList::iterator iter;
+      if (this->dataPtr->publishersMsgValid)
+        this->dataPtr->publishersMsg.add_publisher()->CopyFrom(pub);
+      this->dataPtr->publishersInitValid = false;
 
-    // Find all publishers of the topic
-    for (iter = this->dataPtr->publishers.begin();
-        iter != this->dataPtr->publishers.end(); ++iter)
+      this->SendSubscribers(pub.topic(),
+          msgs::Package("publisher_advertise", pub));
+    }
+    else if (packet.type() == "unadvertise")
     {
-      if (iter->first.topic() == sub.topic())
-      {
-        conn->EnqueueMsg(msgs::Package("publisher_subscribe", iter->first));
-      }
+      msgs::Publish pub;
+      pub.ParseFromString(packet.serialized_data());
+      this->RemovePublisher(pub);
     }
-  }
-  else if (packet.type() == "request")
-  {
-    msgs::Request req;
-    req.ParseFromString(packet.serialized_data());
-
-    if (req.request() == "get_publishers")
+    else if (packet.type() == "unsubscribe")
     {
-      msgs::Publishers msg;
-      PubList::iterator iter;
-      for (iter = this->dataPtr->publishers.begin();
-          iter != this->dataPtr->publishers.end(); ++iter)
-      {
-        msgs::Publish *pub = msg.add_publisher();
-        pub->CopyFrom(iter->first);
-      }
-      conn->EnqueueMsg(msgs::Package("publisher_list", msg), true);
+      msgs::Subscribe sub;
+      sub.ParseFromString(packet.serialized_data());
+      this->RemoveSubscriber(sub);
     }
-    else if (req.request() == "get_topics")
+    else if (packet.type() == "subscribe")
     {
-      std::set<std::string> topics;
-      msgs::GzString_V msg;
+      msgs::Subscribe sub;
+      sub.ParseFromString(packet.serialized_data());
 
-      // Add all topics that are published
-      for (PubList::iterator iter = this->dataPtr->publishers.begin();
-          iter != this->dataPtr->publishers.end(); ++iter)
-      {
-        topics.insert(iter->first.topic());
-      }
+      this->dataPtr->subscribers.push_back(std::make_pair(sub, conn));
+      MasterTopic &topic = this->dataPtr->topics[sub.topic()];
+      topic.subscribers.push_back(std::prev(this->dataPtr->subscribers.end()));
+      this->dataPtr->connectionTopics[_connectionIndex].subscribed.insert(
+          sub.topic());
 
-      // Add all topics that are subscribed
-      for (SubList::iterator iter = this->dataPtr->subscribers.begin();
-           iter != this->dataPtr->subscribers.end(); ++iter)
+      // Find all publishers of the topic
+      for (auto &pubIter : topic.publishers)
       {
-        topics.insert(iter->first.topic());
+        conn->EnqueueMsg(msgs::Package("publisher_subscribe", pubIter->first));
       }
+    }
+    else if (packet.type() == "request")
+    {
+      msgs::Request req;
+      req.ParseFromString(packet.serialized_data());
 
-      // Construct the message of only unique names
-      for (std::set<std::string>::iterator iter =
-          topics.begin(); iter != topics.end(); ++iter)
+      if (req.request() == "get_publishers")
       {
-        msg.add_data(*iter);
+        reply = msgs::Package("publisher_list", this->PublishersMsg());
       }
+      else if (req.request() == "get_topics")
+      {
+        std::vector<std::string> topics;
+        topics.reserve(this->dataPtr->topics.size());
+        msgs::GzString_V msg;
 
-      // Send the topic list message
-      conn->EnqueueMsg(msgs::Package("topic_list", msg), true);
-    }
-    else if (req.request() == "topic_info")
-    {
-      msgs::Publish pub = this->GetPublisher(req.data());
-      msgs::TopicInfo ti;
-      ti.set_msg_type(pub.msg_type());
+        // Add all topics that are published or subscribed
+        for (auto const &topic : this->dataPtr->topics)
+          topics.push_back(topic.first);
 
-      PubList::iterator piter;
-      SubList::iterator siter;
+        // Construct the message of sorted names
+        std::sort(topics.begin(), topics.end());
+        for (auto const &topic : topics)
+          msg.add_data(topic);
 
-      // Find all publishers of the topic
-      for (piter = this->dataPtr->publishers.begin();
-          piter != this->dataPtr->publishers.end(); ++piter)
+        // Send the topic list message
+        reply = msgs::Package("topic_list", msg);
+      }
+      else if (req.request() == "topic_info")
       {
-        if (piter->first.topic() == req.data())
+        msgs::Publish pub = this->GetPublisher(req.data());
+        msgs::TopicInfo ti;
+        ti.set_msg_type(pub.msg_type());
+
+        auto topicIter = this->dataPtr->topics.find(req.data());
+        if (topicIter != this->dataPtr->topics.end())
         {
-          msgs::Publish *pubPtr = ti.add_publisher();
-          pubPtr->CopyFrom(piter->first);
+          // Add all publishers of the topic
+          for (auto &piter : topicIter->second.publishers)
+          {
+            msgs::Publish *pubPtr = ti.add_publisher();
+            pubPtr->CopyFrom(piter->first);
+          }
+
+          // Add all subscribers of the topic
+          for (auto &siter : topicIter->second.subscribers)
+          {
+            // If the topic info message type has not been set or the
+            // topic info message type is an empty string, then set the topic
+            // info message type based on a subscriber's message type.
+            if (!ti.has_msg_type() || ti.msg_type().empty())
+              ti.set_msg_type(siter->first.msg_type());
+            msgs::Subscribe *sub = ti.add_subscriber();
+            sub->CopyFrom(siter->first);
+          }
         }
-      }
 
-      // Find all subscribers of the topic
-      for (siter = this->dataPtr->subscribers.begin();
-          siter != this->dataPtr->subscribers.end(); ++siter)
+        conn->EnqueueMsg(msgs::Package("topic_info_response", ti));
+      }
+      else if (req.request() == "get_topic_namespaces")
       {
-        if (siter->first.topic() == req.data())
+        msgs::GzString_V msg;
+        std::list<std::string>::iterator iter;
+        for (iter = this->dataPtr->worldNames.begin();
+            iter != this->dataPtr->worldNames.end(); ++iter)
         {
-          // If the topic info message type has not been set or the
-          // topic info message type is an empty string, then set the topic
-          // info message type based on a subscriber's message type.
-          if (!ti.has_msg_type() || ti.msg_type().empty())
-            ti.set_msg_type(siter->first.msg_type());
-          msgs::Subscribe *sub = ti.add_subscriber();
-          sub->CopyFrom(siter->first);
+          msg.add_data(*iter);
         }
+        conn->EnqueueMsg(msgs::Package("get_topic_namespaces_response", msg));
       }
-
-      conn->EnqueueMsg(msgs::Package("topic_info_response", ti));
-    }
-    else if (req.request() == "get_topic_namespaces")
-    {
-      msgs::GzString_V msg;
-      std::list<std::string>::iterator iter;
-      for (iter = this->dataPtr->worldNames.begin();
-          iter != this->dataPtr->worldNames.end(); ++iter)
+      else
       {
-        msg.add_data(*iter);
+        gzerr << "Unknown request[" << req.request() << "]\n";
       }
-      conn->EnqueueMsg(msgs::Package("get_topic_namespaces_response", msg));
     }
     else
-    {
-      gzerr << "Unknown request[" << req.request() << "]\n";
-    }
+      std::cerr << "Master Unknown message type[" << packet.type()
+                << "] From[" << conn->GetRemotePort() << "]\n";
   }
-  else
-    std::cerr << "Master Unknown message type[" << packet.type()
-              << "] From[" << conn->GetRemotePort() << "]\n";
+
+  if (!reply.empty())
+    conn->EnqueueMsg(reply, true);
 }
 
 //////////////////////////////////////////////////
@@ -450,43 +512,59 @@ void Master::RemoveConnection(Connection_M::iterator _connIter)
     }
   }
 
-  // Remove all publishers for this connection
-  bool done = false;
-  while (!done)
+  // Only the topics the connection used are visited
+  auto topicsIter = this->dataPtr->connectionTopics.find(_connIter->first);
+  if (topicsIter != this->dataPtr->connectionTopics.end())
   {
-    done = true;
-    PubList::iterator pubIter = this->dataPtr->publishers.begin();
-    while (pubIter != this->dataPtr->publishers.end())
+    const unsigned int id = _connIter->second->GetId();
+    MasterConnectionTopics connTopics;
+    std::swap(connTopics, topicsIter->second);
+    this->dataPtr->connectionTopics.erase(topicsIter);
+
+    // Remove all publishers for this connection. A removal also removes
+    // the other publishers of the topic with the same address, and may
+    // remove the topic, so it is looked up again each time.
+    for (auto const &topicName : connTopics.published)
     {
-      if ((*pubIter).second->GetId() == _connIter->second->GetId())
+      for (;;)
       {
-        this->RemovePublisher((*pubIter).first);
-        done = false;
-        break;
+        auto topicIter = this->dataPtr->topics.find(topicName);
+        if (topicIter == this->dataPtr->topics.end())
+          break;
+
+        auto &pubs = topicIter->second.publishers;
+        auto pubIter = std::find_if(pubs.begin(), pubs.end(),
+            [id](const PubList::iterator &_pub)
+            {
+              return _pub->second->GetId() == id;
+            });
+        if (pubIter == pubs.end())
+          break;
+
+        this->RemovePublisher((*pubIter)->first);
       }
-      else
-        ++pubIter;
     }
-  }
-
-
-  done = false;
-  while (!done)
-  {
-    done = true;
 
     // Remove all subscribers for this connection
-    SubList::iterator subIter = this->dataPtr->subscribers.begin();
-    while (subIter != this->dataPtr->subscribers.end())
+    for (auto const &topicName : connTopics.subscribed)
     {
-      if ((*subIter).second->GetId() == _connIter->second->GetId())
+      for (;;)
       {
-        this->RemoveSubscriber((*subIter).first);
-        done = false;
-        break;
+        auto topicIter = this->dataPtr->topics.find(topicName);
+        if (topicIter == this->dataPtr->topics.end())
+          break;
+
+        auto &subs = topicIter->second.subscribers;
+        auto subIter = std::find_if(subs.begin(), subs.end(),
+            [id](const SubList::iterator &_sub)
+            {
+              return _sub->second->GetId() == id;
+            });
+        if (subIter == subs.end())
+          break;
+
+        this->RemoveSubscriber((*subIter)->first);
       }
-      else
-        ++subIter;
     }
   }
 
@@ -496,58 +574,71 @@ void Master::RemoveConnection(Connection_M::iterator _connIter)
 /////////////////////////////////////////////////
 void Master::RemovePublisher(const msgs::Publish _pub)
 {
+  std::lock_guard<std::recursive_mutex> lock(this->dataPtr->connectionMutex);
+
+  Connection_M::iterator iter2;
+  for (iter2 = this->dataPtr->connections.begin();
+      iter2 != this->dataPtr->connections.end(); ++iter2)
   {
-    std::lock_guard<std::recursive_mutex> lock(this->dataPtr->connectionMutex);
-    Connection_M::iterator iter2;
-    for (iter2 = this->dataPtr->connections.begin();
-        iter2 != this->dataPtr->connections.end(); ++iter2)
-    {
-      iter2->second->EnqueueMsg(msgs::Package("publisher_del", _pub));
-    }
+    iter2->second->EnqueueMsg(msgs::Package("publisher_del", _pub));
   }
 
   this->SendSubscribers(_pub.topic(), msgs::Package("unadvertise", _pub));
 
-  PubList::iterator pubIter = this->dataPtr->publishers.begin();
-  while (pubIter != this->dataPtr->publishers.end())
+  auto topicIter = this->dataPtr->topics.find(_pub.topic());
+  if (topicIter == this->dataPtr->topics.end())
+    return;
+
+  auto &pubs = topicIter->second.publishers;
+  auto pubIter = pubs.begin();
+  while (pubIter != pubs.end())
   {
-    if (pubIter->first.topic() == _pub.topic() &&
-        pubIter->first.host() == _pub.host() &&
-        pubIter->first.port() == _pub.port())
+    if ((*pubIter)->first.host() == _pub.host() &&
+        (*pubIter)->first.port() == _pub.port())
     {
-      pubIter = this->dataPtr->publishers.erase(pubIter);
+      this->dataPtr->publishers.erase(*pubIter);
+      pubIter = pubs.erase(pubIter);
+      this->dataPtr->publishersMsgValid = false;
+      this->dataPtr->publishersInitValid = false;
     }
     else
       ++pubIter;
   }
+
+  if (pubs.empty() && topicIter->second.subscribers.empty())
+    this->dataPtr->topics.erase(topicIter);
 }
 
 /////////////////////////////////////////////////
 void Master::RemoveSubscriber(const msgs::Subscribe _sub)
 {
+  std::lock_guard<std::recursive_mutex> lock(this->dataPtr->connectionMutex);
+
+  auto topicIter = this->dataPtr->topics.find(_sub.topic());
+  if (topicIter == this->dataPtr->topics.end())
+    return;
+
   // Find all publishers of the topic, and remove the subscriptions
-  for (PubList::iterator iter = this->dataPtr->publishers.begin();
-      iter != this->dataPtr->publishers.end(); ++iter)
-  {
-    if (iter->first.topic() == _sub.topic())
-    {
-      iter->second->EnqueueMsg(msgs::Package("unsubscribe", _sub));
-    }
-  }
+  for (auto &pubIter : topicIter->second.publishers)
+    pubIter->second->EnqueueMsg(msgs::Package("unsubscribe", _sub));
 
   // Remove the subscribers from our list
-  SubList::iterator subiter = this->dataPtr->subscribers.begin();
-  while (subiter != this->dataPtr->subscribers.end())
+  auto &subs = topicIter->second.subscribers;
+  auto subIter = subs.begin();
+  while (subIter != subs.end())
   {
-    if (subiter->first.topic() == _sub.topic() &&
-        subiter->first.host() == _sub.host() &&
-        subiter->first.port() == _sub.port())
+    if ((*subIter)->first.host() == _sub.host() &&
+        (*subIter)->first.port() == _sub.port())
     {
-      subiter = this->dataPtr->subscribers.erase(subiter);
+      this->dataPtr->subscribers.erase(*subIter);
+      subIter = subs.erase(subIter);
     }
     else
-      ++subiter;
+      ++subIter;
   }
+
+  if (subs.empty() && topicIter->second.publishers.empty())
+    this->dataPtr->topics.erase(topicIter);
 }
 
 //////////////////////////////////////////////////
@@ -578,8 +669,13 @@ void Master::Fini()
   this->dataPtr->msgs.clear();
   this->dataPtr->worldNames.clear();
   this->dataPtr->connections.clear();
+  this->dataPtr->topics.clear();
+  this->dataPtr->connectionTopics.clear();
   this->dataPtr->subscribers.clear();
   this->dataPtr->publishers.clear();
+  this->dataPtr->publishersMsg.Clear();
+  this->dataPtr->publishersMsgValid = true;
+  this->dataPtr->publishersInitValid = false;
 }
 
 //////////////////////////////////////////////////
@@ -587,22 +683,30 @@ msgs::Publish Master::GetPublisher(const std::string &_topic)
 {
   msgs::Publish msg;
 
-  PubList::iterator iter;
-
-  // Find all publishers of the topic
-  for (iter = this->dataPtr->publishers.begin();
-       iter != this->dataPtr->publishers.end(); ++iter)
+  auto topicIter = this->dataPtr->topics.find(_topic);
+  if (topicIter != this->dataPtr->topics.end() &&
+      !topicIter->second.publishers.empty())
   {
-    if (iter->first.topic() == _topic)
-    {
-      msg = iter->first;
-      break;
-    }
+    msg = topicIter->second.publishers.front()->first;
   }
 
   return msg;
 }
 
+//////////////////////////////////////////////////
+const msgs::Publishers &Master::PublishersMsg()
+{
+  if (!this->dataPtr->publishersMsgValid)
+  {
+    this->dataPtr->publishersMsg.Clear();
+    for (auto const &pub : this->dataPtr->publishers)
+      this->dataPtr->publishersMsg.add_publisher()->CopyFrom(pub.first);
+    this->dataPtr->publishersMsgValid = true;
+  }
+
+  return this->dataPtr->publishersMsg;
+}
+
 //////////////////////////////////////////////////
 transport::ConnectionPtr Master::FindConnection(const std::string &_host,
                                                 uint16_t _port)
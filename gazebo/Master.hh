@@ -106,6 +106,11 @@ namespace gazebo
     /// \return A publish message
     private: msgs::Publish GetPublisher(const std::string &_topic);
 
+    /// \brief Get a message with all the publishers, rebuilt if a
+    /// publisher was removed since the last call.
+    /// \return The publishers message.
+    private: const msgs::Publishers &PublishersMsg();
+
     /// \brief Find a connection given a host and port
     /// \param[in] _host Host name
     /// \param[in] _port Port number
@@ -0,0 +1,298 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+#include <cmath>
+
+#include <ignition/math/Helpers.hh>
+#include <ignition/math/Quaternion.hh>
+#include <ignition/math/Vector3.hh>
+
+#include "gazebo/common/SkeletonAnimation.hh"
+#include "gazebo/common/BakedSkeletonAnimation.hh"
+
+using namespace gazebo;
+using namespace common;
+
+namespace gazebo
+{
+  namespace common
+  {
+    /// \internal
+    /// \brief Key frames of one node, in structure of arrays layout.
+    class BakedTrack
+    {
+      /// \brief Get the index of the first key frame after a time.
+      /// \param[in] _time The time.
+      /// \return Index of the key frame, the key frame count if there is
+      /// none.
+      public: size_t UpperBound(const double _time) const;
+
+      /// \brief Sample the track, like NodeAnimation::FrameAt.
+      /// \param[in] _time The time.
+      /// \param[in] _loop When true, the time wraps around the length.
+      /// \param[out] _trans The transform.
+      public: void FrameAt(const double _time, const bool _loop,
+                  ignition::math::Matrix4d &_trans) const;
+
+      /// \brief Time of the last key frame.
+      public: double length = 0.0;
+
+      /// \brief Time between key frames when they are evenly spaced, zero
+      /// otherwise.
+      public: double step = 0.0;
+
+      /// \brief Time of every key frame, in increasing order.
+      public: std::vector<double> times;
+
+      /// \brief Transform of every key frame.
+      public: std::vector<ignition::math::Matrix4d> keys;
+
+      /// \brief Translation of every key frame.
+      public: std::vector<ignition::math::Vector3d> positions;
+
+      /// \brief Rotation of every key frame.
+      public: std::vector<ignition::math::Quaterniond> rotations;
+
+      /// \brief Largest translation along the X axis of the key frames up
+      /// to and including every key frame.
+      public: std::vector<double> maxX;
+    };
+
+    /// \internal
+    /// \brief BakedSkeletonAnimation private data.
+    class BakedSkeletonAnimationPrivate
+    {
+      /// \brief Every track, in the order of the node list.
+      public: std::vector<BakedTrack> tracks;
+    };
+  }
+}
+
+//////////////////////////////////////////////////
+size_t BakedTrack::UpperBound(const double _time) const
+{
+  if (this->step <= 0.0)
+  {
+    return std::upper_bound(this->times.begin(), this->times.end(), _time) -
+        this->times.begin();
+  }
+
+  // Evenly spaced key frames: start from a guess, which is at most one key
+  // frame off
+  const size_t count = this->times.size();
+  const double guess = std::floor((_time - this->times[0]) / this->step) + 1;
+  size_t index = 0;
+  if (guess >= count)
+    index = count;
+  else if (guess > 0)
+    index = static_cast<size_t>(guess);
+
+  while (index > 0 && this->times[index - 1] > _time)
+    --index;
+  while (index < count && this->times[index] <= _time)
+    ++index;
+  return index;
+}
+
+//////////////////////////////////////////////////
+void BakedTrack::FrameAt(const double _time, const bool _loop,
+    ignition::math::Matrix4d &_trans) const
+{
+  double time = _time;
+  if (time > this->length)
+  {
+    if (_loop && this->length > 0.0)
+    {
+      time = std::fmod(time, this->length);
+      if (time <= 0.0)
+        time = this->length;
+    }
+    else
+    {
+      time = this->length;
+    }
+  }
+
+  if (ignition::math::equal(time, this->length))
+  {
+    _trans = this->keys.back();
+    return;
+  }
+
+  const size_t next = this->UpperBound(time);
+  if (next >= this->times.size())
+  {
+    _trans = this->keys.back();
+    return;
+  }
+
+  if (next == 0 || ignition::math::equal(this->times[next], time))
+  {
+    _trans = this->keys[next];
+    return;
+  }
+
+  const size_t prev = next - 1;
+  if (ignition::math::equal(this->times[prev], time))
+  {
+    _trans = this->keys[prev];
+    return;
+  }
+
+  const double t = (time - this->times[prev]) /
+      (this->times[next] - this->times[prev]);
+
+  const ignition::math::Vector3d &prevPos = this->positions[prev];
+  const ignition::math::Vector3d &nextPos = this->positions[next];
+  const ignition::math::Quaterniond rot = ignition::math::Quaterniond::Slerp(
+      t, this->rotations[prev], this->rotations[next], true);
+
+  _trans = ignition::math::Matrix4d(rot);
+  _trans.SetTranslation(prevPos + (nextPos - prevPos) * t);
+}
+
+//////////////////////////////////////////////////
+BakedSkeletonAnimation::BakedSkeletonAnimation()
+  : dataPtr(new BakedSkeletonAnimationPrivate)
+{
+}
+
+//////////////////////////////////////////////////
+BakedSkeletonAnimation::~BakedSkeletonAnimation()
+{
+}
+
+//////////////////////////////////////////////////
+void BakedSkeletonAnimation::Bake(const SkeletonAnimation &_animation,
+    const std::vector<std::string> &_nodes)
+{
+  this->dataPtr->tracks.clear();
+  this->dataPtr->tracks.resize(_nodes.size());
+
+  for (size_t i = 0; i < _nodes.size(); ++i)
+  {
+    const NodeAnimation *node = _animation.NodeAnimationByName(_nodes[i]);
+    if (!node || node->GetFrameCount() == 0)
+      continue;
+
+    BakedTrack &track = this->dataPtr->tracks[i];
+    const size_t count = node->GetFrameCount();
+    track.times.reserve(count);
+    track.keys.reserve(count);
+    track.positions.reserve(count);
+    track.rotations.reserve(count);
+    track.maxX.reserve(count);
+
+    for (auto const &frame : node->KeyFrames())
+    {
+      const ignition::math::Vector3d pos = frame.second.Translation();
+      track.times.push_back(frame.first);
+      track.keys.push_back(frame.second);
+      track.positions.push_back(pos);
+      track.rotations.push_back(frame.second.Rotation());
+      track.maxX.push_back(track.maxX.empty() ?
+          pos.X() : std::max(track.maxX.back(), pos.X()));
+    }
+    track.length = node->GetLength();
+
+    // Animations loaded from BVH files have evenly spaced key frames, which
+    // are found without a search
+    if (count > 1)
+    {
+      const double step =
+          (track.times.back() - track.times.front()) / (count - 1);
+      bool even = step > 0.0;
+      for (size_t k = 0; even && k < count; ++k)
+      {
+        even = std::abs(track.times[k] - (track.times[0] + k * step)) <
+            step * 0.25;
+      }
+      if (even)
+        track.step = step;
+    }
+  }
+}
+
+//////////////////////////////////////////////////
+size_t BakedSkeletonAnimation::TrackCount() const
+{
+  return this->dataPtr->tracks.size();
+}
+
+//////////////////////////////////////////////////
+bool BakedSkeletonAnimation::HasTrack(const size_t _track) const
+{
+  return _track < this->dataPtr->tracks.size() &&
+      !this->dataPtr->tracks[_track].times.empty();
+}
+
+//////////////////////////////////////////////////
+void BakedSkeletonAnimation::PoseAt(const double _time, const bool _loop,
+    std::vector<ignition::math::Matrix4d> &_pose) const
+{
+  const std::vector<BakedTrack> &tracks = this->dataPtr->tracks;
+  if (_pose.size() < tracks.size())
+    _pose.resize(tracks.size(), ignition::math::Matrix4d::Identity);
+
+  for (size_t i = 0; i < tracks.size(); ++i)
+  {
+    if (!tracks[i].times.empty())
+      tracks[i].FrameAt(_time, _loop, _pose[i]);
+  }
+}
+
+//////////////////////////////////////////////////
+double BakedSkeletonAnimation::TimeAtX(const double _x, const size_t _track,
+    const bool _loop) const
+{
+  if (!this->HasTrack(_track))
+    return 0.0;
+
+  const BakedTrack &track = this->dataPtr->tracks[_track];
+
+  double x = std::max(_x, track.positions.front().X());
+  const double lastX = track.positions.back().X();
+  if (x > lastX)
+  {
+    if (_loop && lastX > 0.0)
+    {
+      x = std::fmod(x, lastX);
+      if (x <= 0.0)
+        x = lastX;
+    }
+    else
+    {
+      x = lastX;
+    }
+  }
+
+  // First key frame whose translation along X is not below x
+  size_t next = std::lower_bound(track.maxX.begin(), track.maxX.end(), x) -
+      track.maxX.begin();
+  if (next >= track.maxX.size())
+    next = track.maxX.size() - 1;
+
+  const double nextX = track.positions[next].X();
+  if (next == 0 || ignition::math::equal(nextX, x))
+    return track.times[next];
+
+  const double prevX = track.positions[next - 1].X();
+  const double prevTime = track.times[next - 1];
+  return prevTime + (track.times[next] - prevTime) * (x - prevX) /
+      (nextX - prevX);
+}
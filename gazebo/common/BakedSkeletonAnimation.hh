@@ -0,0 +1,105 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#ifndef GAZEBO_COMMON_BAKEDSKELETONANIMATION_HH_
+#define GAZEBO_COMMON_BAKEDSKELETONANIMATION_HH_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <ignition/math/Matrix4.hh>
+
+#include "gazebo/util/system.hh"
+
+namespace gazebo
+{
+  namespace common
+  {
+    class SkeletonAnimation;
+
+    /// \addtogroup gazebo_common Common Animation
+    /// \{
+
+    /// Forward declare private data class.
+    class BakedSkeletonAnimationPrivate;
+
+    /// \class BakedSkeletonAnimation BakedSkeletonAnimation.hh
+    /// common/common.hh
+    /// \brief A SkeletonAnimation baked into contiguous arrays.
+    ///
+    /// The key frames of every node are copied into per-track arrays of
+    /// times, positions and rotations, and the tracks are indexed by an
+    /// integer chosen by the caller instead of the node name. Sampling the
+    /// baked animation gives the same transforms as
+    /// SkeletonAnimation::PoseAt and SkeletonAnimation::PoseAtX, but fills a
+    /// caller-owned vector and does not allocate memory. Sampling only
+    /// reads the baked data, so it is safe to sample one animation from
+    /// several threads.
+    class GZ_COMMON_VISIBLE BakedSkeletonAnimation
+    {
+      /// \brief Constructor. The animation has no tracks until it is baked.
+      public: BakedSkeletonAnimation();
+
+      /// \brief Destructor.
+      public: virtual ~BakedSkeletonAnimation();
+
+      /// \brief Bake an animation.
+      /// \param[in] _animation The animation to bake.
+      /// \param[in] _nodes Name of the node of every track. Track i samples
+      /// the node named _nodes[i]. Nodes that are not in the animation give
+      /// empty tracks.
+      public: void Bake(const SkeletonAnimation &_animation,
+                  const std::vector<std::string> &_nodes);
+
+      /// \brief Get the number of tracks.
+      /// \return Size of the node list given to Bake.
+      public: size_t TrackCount() const;
+
+      /// \brief Get whether a track has key frames.
+      /// \param[in] _track Index of the track.
+      /// \return True if the node of the track is in the animation.
+      public: bool HasTrack(const size_t _track) const;
+
+      /// \brief Sample every track at a time, like
+      /// SkeletonAnimation::PoseAt.
+      /// \param[in] _time The time.
+      /// \param[in] _loop When true, the time wraps around the length of
+      /// each track.
+      /// \param[in,out] _pose Transform of every track. It is resized to
+      /// TrackCount() if it is smaller. Entries of empty tracks are left
+      /// untouched.
+      public: void PoseAt(const double _time, const bool _loop,
+                  std::vector<ignition::math::Matrix4d> &_pose) const;
+
+      /// \brief Get the time where the translation of a track along the X
+      /// axis is equal to a value, like SkeletonAnimation::PoseAtX.
+      /// \param[in] _x The value along X.
+      /// \param[in] _track Index of the track.
+      /// \param[in] _loop When true, _x wraps around the last translation of
+      /// the track.
+      /// \return The time, or zero if the track is empty.
+      public: double TimeAtX(const double _x, const size_t _track,
+                  const bool _loop) const;
+
+      /// \internal
+      /// \brief Private data pointer.
+      private: std::unique_ptr<BakedSkeletonAnimationPrivate> dataPtr;
+    };
+    /// \}
+  }
+}
+#endif
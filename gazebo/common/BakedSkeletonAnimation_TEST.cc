@@ -0,0 +1,150 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <gtest/gtest.h>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "gazebo/common/BakedSkeletonAnimation.hh"
+#include "gazebo/common/SkeletonAnimation.hh"
+#include "test/util.hh"
+
+using namespace gazebo;
+
+class BakedSkeletonAnimationTest : public gazebo::testing::AutoLogFixture
+{
+  /// \brief Create an animation with a walking root node sampled evenly,
+  /// and an arm node with unevenly spaced key frames.
+  /// \param[out] _animation The animation.
+  public: static void Fill(common::SkeletonAnimation &_animation);
+
+  /// \brief Expect two transforms to be equal.
+  /// \param[in] _a First transform.
+  /// \param[in] _b Second transform.
+  public: static void ExpectNear(const ignition::math::Matrix4d &_a,
+              const ignition::math::Matrix4d &_b);
+};
+
+/////////////////////////////////////////////////
+void BakedSkeletonAnimationTest::Fill(common::SkeletonAnimation &_animation)
+{
+  for (int i = 0; i <= 20; ++i)
+  {
+    _animation.AddKeyFrame("root", i * 0.1, ignition::math::Pose3d(
+        0.05 * i, 0.1 * (i % 2), 1, 0, 0, 0.1 * i));
+  }
+
+  const double times[] = {0.0, 0.3, 0.35, 1.1, 1.6};
+  for (int i = 0; i < 5; ++i)
+  {
+    _animation.AddKeyFrame("arm", times[i], ignition::math::Pose3d(
+        0, 0.2 * i, 0, 0.3 * i, -0.2 * i, 0));
+  }
+}
+
+/////////////////////////////////////////////////
+void BakedSkeletonAnimationTest::ExpectNear(
+    const ignition::math::Matrix4d &_a, const ignition::math::Matrix4d &_b)
+{
+  for (int r = 0; r < 4; ++r)
+  {
+    for (int c = 0; c < 4; ++c)
+      EXPECT_NEAR(_a(r, c), _b(r, c), 1e-9) << r << " " << c;
+  }
+}
+
+/////////////////////////////////////////////////
+TEST_F(BakedSkeletonAnimationTest, PoseAt)
+{
+  common::SkeletonAnimation animation("walk");
+  Fill(animation);
+
+  common::BakedSkeletonAnimation baked;
+  EXPECT_EQ(baked.TrackCount(), 0u);
+  baked.Bake(animation, {"arm", "missing", "root"});
+  EXPECT_EQ(baked.TrackCount(), 3u);
+  EXPECT_TRUE(baked.HasTrack(0));
+  EXPECT_FALSE(baked.HasTrack(1));
+  EXPECT_TRUE(baked.HasTrack(2));
+  EXPECT_FALSE(baked.HasTrack(3));
+
+  // Empty tracks are left untouched
+  const ignition::math::Matrix4d marker(
+      1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16);
+  std::vector<ignition::math::Matrix4d> pose(3, marker);
+
+  for (const bool loop : {true, false})
+  {
+    for (double t = -0.2; t < 5.0; t += 0.037)
+    {
+      std::map<std::string, ignition::math::Matrix4d> expected =
+          animation.PoseAt(t, loop);
+      baked.PoseAt(t, loop, pose);
+      ExpectNear(pose[0], expected["arm"]);
+      ExpectNear(pose[2], expected["root"]);
+      EXPECT_EQ(pose[1], marker);
+    }
+
+    // Exactly on key frames
+    for (const double t : {0.0, 0.3, 0.35, 1.1, 1.6, 2.0})
+    {
+      std::map<std::string, ignition::math::Matrix4d> expected =
+          animation.PoseAt(t, loop);
+      baked.PoseAt(t, loop, pose);
+      ExpectNear(pose[0], expected["arm"]);
+      ExpectNear(pose[2], expected["root"]);
+    }
+  }
+
+  // The output is resized when it is too small
+  std::vector<ignition::math::Matrix4d> small;
+  baked.PoseAt(0.5, true, small);
+  EXPECT_EQ(small.size(), 3u);
+}
+
+/////////////////////////////////////////////////
+TEST_F(BakedSkeletonAnimationTest, TimeAtX)
+{
+  common::SkeletonAnimation animation("walk");
+  Fill(animation);
+
+  common::BakedSkeletonAnimation baked;
+  baked.Bake(animation, {"root", "arm"});
+
+  std::vector<ignition::math::Matrix4d> pose;
+  for (const bool loop : {true, false})
+  {
+    for (double x = -0.5; x < 3.0; x += 0.043)
+    {
+      std::map<std::string, ignition::math::Matrix4d> expected =
+          animation.PoseAtX(x, "root", loop);
+      baked.PoseAt(baked.TimeAtX(x, 0, loop), loop, pose);
+      ExpectNear(pose[0], expected["root"]);
+      ExpectNear(pose[1], expected["arm"]);
+    }
+  }
+
+  EXPECT_DOUBLE_EQ(baked.TimeAtX(1.0, 5, true), 0.0);
+}
+
+/////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,281 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+#include "gazebo/common/FrameSink.hh"
+
+using namespace gazebo;
+using namespace common;
+
+namespace gazebo
+{
+  namespace common
+  {
+    /// \internal
+    /// \brief FrameSink private data.
+    class FrameSinkPrivate
+    {
+      /// \brief Function called on each frame.
+      public: FrameSink::Consumer consumer;
+
+      /// \brief What to do when every buffer is in use.
+      public: FrameSinkPolicy policy = FrameSinkPolicy::DROP;
+
+      /// \brief The ring of frame buffers.
+      public: std::vector<FrameSinkFrame> frames;
+
+      /// \brief Index of the buffers that are free.
+      public: std::vector<size_t> freeFrames;
+
+      /// \brief Index of the queued buffers, in the order they were
+      /// pushed.
+      public: std::deque<size_t> queue;
+
+      /// \brief Worker threads.
+      public: std::vector<std::thread> workers;
+
+      /// \brief Statistics.
+      public: FrameSinkStats stats;
+
+      /// \brief True between Start and Stop.
+      public: bool running = false;
+
+      /// \brief True when the workers must exit once the queue is empty.
+      public: bool stop = false;
+
+      /// \brief Number of calls to Push that wait for a buffer, or fill
+      /// one without the lock. Start waits for them to return before
+      /// reallocating the buffers.
+      public: unsigned int producers = 0;
+
+      /// \brief Protects the members above, except the data of the buffers
+      /// that are queued or being consumed.
+      public: mutable std::mutex mutex;
+
+      /// \brief Notified when a frame is queued or the sink stops.
+      public: std::condition_variable queued;
+
+      /// \brief Notified when a frame is consumed, or a call to Push
+      /// returns while the sink is stopped.
+      public: std::condition_variable consumed;
+    };
+  }
+}
+
+//////////////////////////////////////////////////
+FrameSink::FrameSink()
+  : dataPtr(new FrameSinkPrivate)
+{
+}
+
+//////////////////////////////////////////////////
+FrameSink::~FrameSink()
+{
+  this->Stop();
+}
+
+//////////////////////////////////////////////////
+void FrameSink::Start(const Consumer &_consumer,
+    const unsigned int _capacity, const unsigned int _threads,
+    const FrameSinkPolicy _policy)
+{
+  this->Stop();
+
+  std::unique_lock<std::mutex> lock(this->dataPtr->mutex);
+
+  // A Push from another thread may still be filling a buffer, so the
+  // buffers are only reallocated once it returns.
+  this->dataPtr->consumed.wait(lock, [this]
+      {
+        return this->dataPtr->producers == 0;
+      });
+
+  this->dataPtr->consumer = _consumer;
+  this->dataPtr->policy = _policy;
+  this->dataPtr->stats = FrameSinkStats();
+  this->dataPtr->stop = false;
+  this->dataPtr->running = true;
+
+  // The buffers are allocated by the first frames, and then reused.
+  const size_t capacity = std::max(_capacity, 1u);
+  this->dataPtr->frames.resize(capacity);
+  this->dataPtr->freeFrames.clear();
+  for (size_t i = capacity; i > 0; --i)
+    this->dataPtr->freeFrames.push_back(i - 1);
+  this->dataPtr->queue.clear();
+
+  for (unsigned int i = 0; i < std::max(_threads, 1u); ++i)
+    this->dataPtr->workers.push_back(std::thread(&FrameSink::Run, this));
+}
+
+//////////////////////////////////////////////////
+void FrameSink::Stop()
+{
+  {
+    std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+    if (!this->dataPtr->running)
+      return;
+    this->dataPtr->running = false;
+    this->dataPtr->stop = true;
+  }
+  this->dataPtr->queued.notify_all();
+  this->dataPtr->consumed.notify_all();
+
+  for (auto &worker : this->dataPtr->workers)
+    worker.join();
+  this->dataPtr->workers.clear();
+}
+
+//////////////////////////////////////////////////
+bool FrameSink::Running() const
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  return this->dataPtr->running;
+}
+
+//////////////////////////////////////////////////
+bool FrameSink::Push(const unsigned char *_data, const size_t _size,
+    const unsigned int _width, const unsigned int _height,
+    const std::string &_name,
+    const std::chrono::steady_clock::time_point &_timestamp)
+{
+  size_t index;
+  {
+    std::unique_lock<std::mutex> lock(this->dataPtr->mutex);
+    if (!this->dataPtr->running || !_data)
+      return false;
+
+    this->dataPtr->stats.pushed++;
+
+    if (this->dataPtr->freeFrames.empty())
+    {
+      if (this->dataPtr->policy == FrameSinkPolicy::DROP)
+      {
+        this->dataPtr->stats.dropped++;
+        return false;
+      }
+
+      this->dataPtr->producers++;
+      this->dataPtr->consumed.wait(lock, [this]
+          {
+            return !this->dataPtr->running ||
+                !this->dataPtr->freeFrames.empty();
+          });
+      this->dataPtr->producers--;
+
+      // Start may be waiting for this call to return
+      if (!this->dataPtr->running)
+      {
+        this->dataPtr->stats.dropped++;
+        this->dataPtr->consumed.notify_all();
+        return false;
+      }
+    }
+
+    index = this->dataPtr->freeFrames.back();
+    this->dataPtr->freeFrames.pop_back();
+    this->dataPtr->producers++;
+  }
+
+  // The buffer is neither free nor queued, so it is filled without the
+  // lock.
+  FrameSinkFrame &frame = this->dataPtr->frames[index];
+  frame.data.assign(_data, _data + _size);
+  frame.width = _width;
+  frame.height = _height;
+  frame.name = _name;
+  frame.timestamp = _timestamp;
+
+  {
+    std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+    this->dataPtr->producers--;
+
+    // The workers may have exited while the buffer was filled, and Start
+    // may be waiting for the buffer.
+    if (!this->dataPtr->running)
+    {
+      this->dataPtr->freeFrames.push_back(index);
+      this->dataPtr->stats.dropped++;
+      this->dataPtr->consumed.notify_all();
+      return false;
+    }
+
+    this->dataPtr->queue.push_back(index);
+
+    FrameSinkStats &stats = this->dataPtr->stats;
+    stats.queued = static_cast<unsigned int>(
+        this->dataPtr->frames.size() - this->dataPtr->freeFrames.size());
+    stats.maxQueued = std::max(stats.maxQueued, stats.queued);
+  }
+  this->dataPtr->queued.notify_one();
+
+  return true;
+}
+
+//////////////////////////////////////////////////
+void FrameSink::Flush()
+{
+  std::unique_lock<std::mutex> lock(this->dataPtr->mutex);
+  this->dataPtr->consumed.wait(lock, [this]
+      {
+        return this->dataPtr->workers.empty() ||
+            this->dataPtr->freeFrames.size() == this->dataPtr->frames.size();
+      });
+}
+
+//////////////////////////////////////////////////
+FrameSinkStats FrameSink::Stats() const
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  return this->dataPtr->stats;
+}
+
+//////////////////////////////////////////////////
+void FrameSink::Run()
+{
+  std::unique_lock<std::mutex> lock(this->dataPtr->mutex);
+  while (true)
+  {
+    this->dataPtr->queued.wait(lock, [this]
+        {
+          return this->dataPtr->stop || !this->dataPtr->queue.empty();
+        });
+
+    // The queued frames are consumed before stopping
+    if (this->dataPtr->queue.empty())
+      return;
+
+    const size_t index = this->dataPtr->queue.front();
+    this->dataPtr->queue.pop_front();
+
+    lock.unlock();
+    if (this->dataPtr->consumer)
+      this->dataPtr->consumer(this->dataPtr->frames[index]);
+    lock.lock();
+
+    this->dataPtr->freeFrames.push_back(index);
+    this->dataPtr->stats.processed++;
+    this->dataPtr->stats.queued = static_cast<unsigned int>(
+        this->dataPtr->frames.size() - this->dataPtr->freeFrames.size());
+    this->dataPtr->consumed.notify_all();
+  }
+}
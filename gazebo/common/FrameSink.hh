@@ -0,0 +1,167 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#ifndef GAZEBO_COMMON_FRAMESINK_HH_
+#define GAZEBO_COMMON_FRAMESINK_HH_
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gazebo/util/system.hh"
+
+namespace gazebo
+{
+  namespace common
+  {
+    // Forward declare private data class
+    class FrameSinkPrivate;
+
+    /// \addtogroup gazebo_common
+    /// \{
+
+    /// \brief What FrameSink::Push does when every buffer of the ring is
+    /// in use.
+    enum class FrameSinkPolicy
+    {
+      /// \brief Drop the frame being pushed, so that the caller never
+      /// waits.
+      DROP,
+
+      /// \brief Wait until a worker frees a buffer, so that no frame is
+      /// lost.
+      BLOCK
+    };
+
+    /// \brief A frame queued in a FrameSink.
+    class GZ_COMMON_VISIBLE FrameSinkFrame
+    {
+      /// \brief Image data. The buffer is reused by later frames, so it
+      /// must not be kept after the consumer returns.
+      public: std::vector<unsigned char> data;
+
+      /// \brief Width of the image in pixels.
+      public: unsigned int width = 0;
+
+      /// \brief Height of the image in pixels.
+      public: unsigned int height = 0;
+
+      /// \brief Time the frame was pushed at, or given to Push.
+      public: std::chrono::steady_clock::time_point timestamp;
+
+      /// \brief Name given to Push, such as the file to write the frame to.
+      public: std::string name;
+    };
+
+    /// \brief Statistics of a FrameSink since it was started.
+    class GZ_COMMON_VISIBLE FrameSinkStats
+    {
+      /// \brief Number of frames given to Push.
+      public: uint64_t pushed = 0;
+
+      /// \brief Number of frames handed to the consumer and done.
+      public: uint64_t processed = 0;
+
+      /// \brief Number of frames dropped because the ring was full.
+      public: uint64_t dropped = 0;
+
+      /// \brief Number of frames queued or being consumed.
+      public: unsigned int queued = 0;
+
+      /// \brief Largest number of frames that were queued or being
+      /// consumed at once.
+      public: unsigned int maxQueued = 0;
+    };
+
+    /// \class FrameSink FrameSink.hh common/common.hh
+    /// \brief Hands image frames to worker threads, so that encoding and
+    /// writing them does not hold up the thread that produces them.
+    ///
+    /// Push copies a frame into a ring of buffers that are allocated once
+    /// and reused. Worker threads call the consumer on the queued frames.
+    /// With one worker the frames are consumed in the order they were
+    /// pushed, which is what a video encoder needs. When every buffer is
+    /// in use, Push either drops the frame or waits, depending on the
+    /// policy.
+    class GZ_COMMON_VISIBLE FrameSink
+    {
+      /// \brief Function called by the workers on each frame.
+      public: using Consumer = std::function<void(const FrameSinkFrame &)>;
+
+      /// \brief Constructor. The sink does not accept frames until it is
+      /// started.
+      public: FrameSink();
+
+      /// \brief Destructor. Stops the sink, which consumes the queued
+      /// frames.
+      public: virtual ~FrameSink();
+
+      /// \brief Start the workers. A sink that is running is stopped
+      /// first.
+      /// \param[in] _consumer Function called on each frame.
+      /// \param[in] _capacity Number of frame buffers in the ring. At
+      /// least one is used.
+      /// \param[in] _threads Number of worker threads. At least one is
+      /// used.
+      /// \param[in] _policy What to do when every buffer is in use.
+      public: void Start(const Consumer &_consumer,
+                  const unsigned int _capacity = 4,
+                  const unsigned int _threads = 1,
+                  const FrameSinkPolicy _policy = FrameSinkPolicy::DROP);
+
+      /// \brief Consume the queued frames, and stop the workers.
+      public: void Stop();
+
+      /// \brief Get whether the sink is started.
+      /// \return True between Start and Stop.
+      public: bool Running() const;
+
+      /// \brief Queue a copy of a frame.
+      /// \param[in] _data Image data.
+      /// \param[in] _size Size of the image data in bytes.
+      /// \param[in] _width Width of the image in pixels.
+      /// \param[in] _height Height of the image in pixels.
+      /// \param[in] _name Name of the frame, passed to the consumer.
+      /// \param[in] _timestamp Time of the frame.
+      /// \return True if the frame was queued, false if it was dropped or
+      /// the sink is not running.
+      public: bool Push(const unsigned char *_data, const size_t _size,
+                  const unsigned int _width, const unsigned int _height,
+                  const std::string &_name = "",
+                  const std::chrono::steady_clock::time_point &_timestamp =
+                  std::chrono::steady_clock::now());
+
+      /// \brief Wait until every queued frame is consumed.
+      public: void Flush();
+
+      /// \brief Get the statistics since the sink was started.
+      /// \return The statistics.
+      public: FrameSinkStats Stats() const;
+
+      /// \brief Worker thread.
+      private: void Run();
+
+      /// \internal
+      /// \brief Private data pointer
+      private: std::unique_ptr<FrameSinkPrivate> dataPtr;
+    };
+    /// \}
+  }
+}
+#endif
@@ -0,0 +1,246 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gazebo/common/CommonIface.hh"
+#include "gazebo/common/FrameSink.hh"
+#include "gazebo/common/VideoEncoder.hh"
+#include "test/util.hh"
+
+using namespace gazebo;
+using namespace common;
+
+class FrameSinkTest : public gazebo::testing::AutoLogFixture { };
+
+/////////////////////////////////////////////////
+TEST_F(FrameSinkTest, Order)
+{
+  FrameSink sink;
+  EXPECT_FALSE(sink.Running());
+
+  const unsigned char pixel[3] = {1, 2, 3};
+  EXPECT_FALSE(sink.Push(pixel, 3, 1, 1));
+
+  std::vector<std::string> names;
+  sink.Start([&](const FrameSinkFrame &_frame)
+      {
+        EXPECT_EQ(_frame.data.size(), 3u);
+        EXPECT_EQ(_frame.data[2], 3u);
+        EXPECT_EQ(_frame.width, 1u);
+        EXPECT_EQ(_frame.height, 1u);
+        names.push_back(_frame.name);
+      }, 2, 1, FrameSinkPolicy::BLOCK);
+  EXPECT_TRUE(sink.Running());
+
+  for (int i = 0; i < 50; ++i)
+    EXPECT_TRUE(sink.Push(pixel, 3, 1, 1, std::to_string(i)));
+  sink.Flush();
+
+  ASSERT_EQ(names.size(), 50u);
+  for (int i = 0; i < 50; ++i)
+    EXPECT_EQ(names[i], std::to_string(i));
+
+  FrameSinkStats stats = sink.Stats();
+  EXPECT_EQ(stats.pushed, 50u);
+  EXPECT_EQ(stats.processed, 50u);
+  EXPECT_EQ(stats.dropped, 0u);
+  EXPECT_EQ(stats.queued, 0u);
+  EXPECT_GE(stats.maxQueued, 1u);
+  EXPECT_LE(stats.maxQueued, 2u);
+
+  sink.Stop();
+  EXPECT_FALSE(sink.Running());
+  EXPECT_FALSE(sink.Push(pixel, 3, 1, 1));
+}
+
+/////////////////////////////////////////////////
+TEST_F(FrameSinkTest, Drop)
+{
+  std::mutex mutex;
+  mutex.lock();
+
+  // The consumer waits on the mutex, so the ring fills up
+  FrameSink sink;
+  int count = 0;
+  sink.Start([&](const FrameSinkFrame &)
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        ++count;
+      }, 3, 1, FrameSinkPolicy::DROP);
+
+  const unsigned char pixel[3] = {1, 2, 3};
+  int queued = 0;
+  for (int i = 0; i < 10; ++i)
+    queued += sink.Push(pixel, 3, 1, 1) ? 1 : 0;
+  EXPECT_EQ(queued, 3);
+
+  FrameSinkStats stats = sink.Stats();
+  EXPECT_EQ(stats.pushed, 10u);
+  EXPECT_EQ(stats.dropped, 7u);
+  EXPECT_EQ(stats.queued, 3u);
+  EXPECT_EQ(stats.maxQueued, 3u);
+
+  mutex.unlock();
+
+  // Stop consumes the queued frames
+  sink.Stop();
+  EXPECT_EQ(count, 3);
+  EXPECT_EQ(sink.Stats().processed, 3u);
+}
+
+/////////////////////////////////////////////////
+TEST_F(FrameSinkTest, Block)
+{
+  FrameSink sink;
+  int count = 0;
+  sink.Start([&](const FrameSinkFrame &)
+      {
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        ++count;
+      }, 1, 1, FrameSinkPolicy::BLOCK);
+
+  const unsigned char pixel[3] = {1, 2, 3};
+  for (int i = 0; i < 20; ++i)
+    EXPECT_TRUE(sink.Push(pixel, 3, 1, 1));
+  sink.Stop();
+
+  EXPECT_EQ(count, 20);
+  FrameSinkStats stats = sink.Stats();
+  EXPECT_EQ(stats.pushed, 20u);
+  EXPECT_EQ(stats.processed, 20u);
+  EXPECT_EQ(stats.dropped, 0u);
+  EXPECT_EQ(stats.maxQueued, 1u);
+
+  // Restarting clears the statistics
+  sink.Start(nullptr);
+  EXPECT_EQ(sink.Stats().pushed, 0u);
+}
+
+/////////////////////////////////////////////////
+TEST_F(FrameSinkTest, Threads)
+{
+  std::mutex mutex;
+  int count = 0;
+
+  FrameSink sink;
+  sink.Start([&](const FrameSinkFrame &)
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        ++count;
+      }, 8, 4, FrameSinkPolicy::BLOCK);
+
+  std::vector<unsigned char> image(64 * 48 * 3, 128);
+  for (int i = 0; i < 200; ++i)
+    EXPECT_TRUE(sink.Push(image.data(), image.size(), 64, 48));
+  sink.Flush();
+
+  EXPECT_EQ(count, 200);
+  EXPECT_EQ(sink.Stats().processed, 200u);
+}
+
+/////////////////////////////////////////////////
+TEST_F(FrameSinkTest, RestartWhilePushing)
+{
+  FrameSink sink;
+  sink.Start(nullptr, 2, 1, FrameSinkPolicy::DROP);
+
+  // Restart the sink with other capacities while frames are pushed from
+  // another thread
+  std::vector<unsigned char> image(640 * 480 * 3, 128);
+  bool done = false;
+  std::mutex mutex;
+  std::thread producer([&]()
+      {
+        while (true)
+        {
+          {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (done)
+              return;
+          }
+          sink.Push(image.data(), image.size(), 640, 480);
+        }
+      });
+
+  for (unsigned int i = 0; i < 100; ++i)
+  {
+    sink.Start(nullptr, 1 + i % 4, 1, FrameSinkPolicy::BLOCK);
+    std::this_thread::sleep_for(std::chrono::microseconds(100));
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    done = true;
+  }
+  producer.join();
+
+  sink.Flush();
+  const FrameSinkStats stats = sink.Stats();
+  EXPECT_EQ(stats.pushed, stats.processed + stats.dropped);
+  EXPECT_EQ(stats.queued, 0u);
+}
+
+/////////////////////////////////////////////////
+TEST_F(FrameSinkTest, VideoEncoder)
+{
+#ifdef HAVE_FFMPEG
+  const unsigned int width = 320;
+  const unsigned int height = 240;
+
+  VideoEncoder video;
+  ASSERT_TRUE(video.Start("mp4", "", width, height));
+
+  FrameSink sink;
+  sink.Start([&](const FrameSinkFrame &_frame)
+      {
+        video.AddFrame(_frame.data.data(), _frame.width, _frame.height,
+            _frame.timestamp);
+      }, 4, 1, FrameSinkPolicy::BLOCK);
+
+  std::vector<unsigned char> image(width * height * 3);
+  auto timestamp = std::chrono::steady_clock::now();
+  for (int i = 0; i < 30; ++i)
+  {
+    std::fill(image.begin(), image.end(), static_cast<unsigned char>(i * 8));
+    timestamp += std::chrono::milliseconds(40);
+    EXPECT_TRUE(sink.Push(image.data(), image.size(), width, height, "",
+        timestamp));
+  }
+  sink.Stop();
+  EXPECT_EQ(sink.Stats().processed, 30u);
+
+  const std::string filename = common::cwd() + "/FrameSinkTest.mp4";
+  EXPECT_TRUE(video.SaveToFile(filename));
+  EXPECT_TRUE(common::exists(filename));
+  std::remove(filename.c_str());
+#endif
+}
+
+/////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,459 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
+#include <ignition/math/Helpers.hh>
+
+#include "gazebo/common/Console.hh"
+#include "gazebo/common/HeightmapTiles.hh"
+
+using namespace gazebo;
+using namespace common;
+
+namespace
+{
+  /// \brief Identifies a tile file.
+  const char kMagic[8] = {'G', 'Z', 'H', 'M', 'T', 'I', 'L', 'E'};
+
+  /// \brief Version of the tile file format.
+  const uint32_t kVersion = 1;
+
+  /// \brief Largest number of samples along the side of a tile, 64 MB of
+  /// floats per tile.
+  const unsigned int kMaxTileSize = 1u << 12;
+
+  /// \brief Header of a tile file. It is followed by the key, padded to a
+  /// multiple of 8 bytes, then by the minimum and maximum height of each
+  /// tile, and then by the tiles. The tiles are stored row after row, and
+  /// the samples of each tile too. The file is a cache that stays on the
+  /// machine that built it, so it uses the native byte order.
+  struct TileFileHeader
+  {
+    /// \brief Set to kMagic.
+    char magic[8];
+
+    /// \brief Set to kVersion.
+    uint32_t version;
+
+    /// \brief Number of samples along the side of a tile.
+    uint32_t tileSize;
+
+    /// \brief Number of samples along the side of the heightmap.
+    uint32_t side;
+
+    /// \brief Number of tiles along the side of the heightmap.
+    uint32_t tiles;
+
+    /// \brief Number of characters of the key.
+    uint32_t keySize;
+
+    /// \brief Unused, keeps the header 8 byte aligned.
+    uint32_t reserved;
+  };
+
+  /// \brief Get the offset of the tile bounds in a tile file.
+  /// \param[in] _keySize Number of characters of the key.
+  /// \return The offset in bytes.
+  size_t BoundsOffset(const size_t _keySize)
+  {
+    return sizeof(TileFileHeader) + ((_keySize + 7) & ~size_t(7));
+  }
+}
+
+namespace gazebo
+{
+  namespace common
+  {
+    /// \internal
+    /// \brief HeightmapTiles private data.
+    class HeightmapTilesPrivate
+    {
+      /// \brief The mapped tile file.
+      public: boost::iostreams::mapped_file_source file;
+
+      /// \brief First sample of the first tile, in the mapped file.
+      public: const float *tiles = nullptr;
+
+      /// \brief Number of samples along the side of the heightmap.
+      public: unsigned int side = 0;
+
+      /// \brief Number of samples along the side of a tile.
+      public: unsigned int tileSize = 0;
+
+      /// \brief Log2 of the tile size.
+      public: unsigned int tileShift = 0;
+
+      /// \brief Tile size minus one, to get the offset in a tile.
+      public: unsigned int tileMask = 0;
+
+      /// \brief Number of tiles along the side of the heightmap.
+      public: unsigned int tileCount = 0;
+
+      /// \brief Number of vertices per sample.
+      public: unsigned int subSampling = 1;
+
+      /// \brief True to flip the vertices along the y direction.
+      public: bool flipY = false;
+
+      /// \brief Number of vertices along the side of the terrain.
+      public: unsigned int vertCount = 0;
+
+      /// \brief Minimum height.
+      public: float minHeight = 0;
+
+      /// \brief Maximum height.
+      public: float maxHeight = 0;
+    };
+  }
+}
+
+//////////////////////////////////////////////////
+HeightmapTiles::HeightmapTiles()
+  : dataPtr(new HeightmapTilesPrivate)
+{
+}
+
+//////////////////////////////////////////////////
+HeightmapTiles::~HeightmapTiles()
+{
+  this->Unload();
+}
+
+//////////////////////////////////////////////////
+bool HeightmapTiles::Load(HeightmapData &_data, const std::string &_filename,
+    const std::string &_key, const int _subSampling,
+    const ignition::math::Vector3d &_size,
+    const ignition::math::Vector3d &_scale, const bool _flipY,
+    const unsigned int _tileSize)
+{
+  this->Unload();
+
+  if (_subSampling <= 0)
+  {
+    gzerr << "Illegal subsampling value (" << _subSampling << ")\n";
+    return false;
+  }
+
+  const unsigned int tileSize =
+      ignition::math::roundUpPowerOfTwo(
+          ignition::math::clamp(_tileSize, 2u, kMaxTileSize));
+
+  if (!this->Map(_filename, _key, tileSize))
+  {
+    if (!HeightmapTiles::Build(_data, _filename, _key, _size, _scale,
+          tileSize) || !this->Map(_filename, _key, tileSize))
+    {
+      gzerr << "Unable to build heightmap tiles [" << _filename << "]\n";
+      this->Unload();
+      return false;
+    }
+  }
+
+  this->dataPtr->subSampling = static_cast<unsigned int>(_subSampling);
+  this->dataPtr->flipY = _flipY;
+  this->dataPtr->vertCount = this->dataPtr->side * this->dataPtr->subSampling
+      - this->dataPtr->subSampling + 1;
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool HeightmapTiles::Build(HeightmapData &_data, const std::string &_filename,
+    const std::string &_key, const ignition::math::Vector3d &_size,
+    const ignition::math::Vector3d &_scale, const unsigned int _tileSize)
+{
+  const unsigned int side = _data.GetWidth();
+  if (side == 0 || side != _data.GetHeight())
+  {
+    gzerr << "Heightmap data must be square\n";
+    return false;
+  }
+
+  // One height per sample. The dense table of vertices is never filled.
+  std::vector<float> samples;
+  _data.FillHeightMap(1, side, _size, _scale, false, samples);
+  if (samples.size() != static_cast<size_t>(side) * side)
+    return false;
+
+  TileFileHeader header;
+  std::memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.version = kVersion;
+  header.tileSize = _tileSize;
+  header.side = side;
+  header.tiles = (side + _tileSize - 1) / _tileSize;
+  header.keySize = static_cast<uint32_t>(_key.size());
+  header.reserved = 0;
+
+  // Samples past the border are copies of the border, so that every tile
+  // is full, and the bounds of a tile are those of its samples.
+  const size_t tileArea = static_cast<size_t>(_tileSize) * _tileSize;
+  std::vector<float> tile(tileArea);
+  auto fillTile = [&](const unsigned int _tx, const unsigned int _ty)
+  {
+    float *out = tile.data();
+    for (unsigned int r = 0; r < _tileSize; ++r)
+    {
+      const size_t y = std::min(_ty * _tileSize + r, side - 1);
+      for (unsigned int c = 0; c < _tileSize; ++c)
+      {
+        const size_t x = std::min(_tx * _tileSize + c, side - 1);
+        *out++ = samples[y * side + x];
+      }
+    }
+  };
+
+  std::vector<float> bounds;
+  bounds.reserve(2 * header.tiles * header.tiles);
+  for (unsigned int ty = 0; ty < header.tiles; ++ty)
+  {
+    for (unsigned int tx = 0; tx < header.tiles; ++tx)
+    {
+      fillTile(tx, ty);
+      auto minMax = std::minmax_element(tile.begin(), tile.end());
+      bounds.push_back(*minMax.first);
+      bounds.push_back(*minMax.second);
+    }
+  }
+
+  boost::system::error_code ec;
+  boost::filesystem::path path(_filename);
+  if (path.has_parent_path())
+    boost::filesystem::create_directories(path.parent_path(), ec);
+
+  // Write to a temporary file, so that another process never maps a file
+  // that is partly written. Each build has its own temporary file, so that
+  // processes building the same terrain at once do not write to the same.
+  const std::string tmpFilename = (path.parent_path() /
+      boost::filesystem::unique_path(
+          path.filename().string() + ".%%%%-%%%%.tmp")).string();
+  {
+    std::ofstream out(tmpFilename, std::ios::out | std::ios::binary |
+        std::ios::trunc);
+    if (!out)
+      return false;
+
+    const char padding[8] = {0};
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    out.write(_key.data(), _key.size());
+    out.write(padding, BoundsOffset(_key.size()) - sizeof(header) -
+        _key.size());
+    out.write(reinterpret_cast<const char *>(bounds.data()),
+        bounds.size() * sizeof(float));
+    for (unsigned int ty = 0; ty < header.tiles && out; ++ty)
+    {
+      for (unsigned int tx = 0; tx < header.tiles && out; ++tx)
+      {
+        fillTile(tx, ty);
+        out.write(reinterpret_cast<const char *>(tile.data()),
+            tile.size() * sizeof(float));
+      }
+    }
+    if (!out)
+    {
+      out.close();
+      boost::filesystem::remove(tmpFilename, ec);
+      return false;
+    }
+  }
+
+  boost::filesystem::rename(tmpFilename, _filename, ec);
+  if (ec)
+  {
+    boost::filesystem::remove(tmpFilename, ec);
+    return false;
+  }
+
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool HeightmapTiles::Map(const std::string &_filename,
+    const std::string &_key, const unsigned int _tileSize)
+{
+  if (!boost::filesystem::exists(_filename))
+    return false;
+
+  try
+  {
+    this->dataPtr->file.open(_filename);
+  }
+  catch(std::exception &_e)
+  {
+    gzwarn << "Unable to map heightmap tiles [" << _filename << "]: "
+           << _e.what() << std::endl;
+    return false;
+  }
+
+  const char *data = this->dataPtr->file.data();
+  const size_t size = this->dataPtr->file.size();
+
+  TileFileHeader header;
+  if (size < sizeof(header))
+  {
+    this->dataPtr->file.close();
+    return false;
+  }
+  std::memcpy(&header, data, sizeof(header));
+
+  // A file built from other data, or that is corrupt, is rebuilt. The
+  // header is checked before the sizes are computed from it, and the tile
+  // size is at most kMaxTileSize, so none of the sizes below overflow.
+  if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 ||
+      header.version != kVersion || header.tileSize != _tileSize ||
+      header.keySize != _key.size() || header.side == 0 ||
+      header.tiles != (static_cast<uint64_t>(header.side) + _tileSize - 1) /
+          _tileSize)
+  {
+    this->dataPtr->file.close();
+    return false;
+  }
+
+  // A truncated file is rebuilt too
+  const size_t boundsOffset = BoundsOffset(header.keySize);
+  const uint64_t tileCount = static_cast<uint64_t>(header.tiles) *
+      header.tiles;
+  const uint64_t tileBytes = (2 + static_cast<uint64_t>(header.tileSize) *
+      header.tileSize) * sizeof(float);
+  if (size < boundsOffset || tileCount > (size - boundsOffset) / tileBytes ||
+      _key.compare(0, _key.size(), data + sizeof(header),
+          header.keySize) != 0)
+  {
+    this->dataPtr->file.close();
+    return false;
+  }
+  const size_t tilesOffset = boundsOffset + 2 * tileCount * sizeof(float);
+
+  const float *bounds = reinterpret_cast<const float *>(data + boundsOffset);
+  this->dataPtr->minHeight = std::numeric_limits<float>::max();
+  this->dataPtr->maxHeight = -std::numeric_limits<float>::max();
+  for (size_t i = 0; i < tileCount; ++i)
+  {
+    this->dataPtr->minHeight = std::min(this->dataPtr->minHeight,
+        bounds[2 * i]);
+    this->dataPtr->maxHeight = std::max(this->dataPtr->maxHeight,
+        bounds[2 * i + 1]);
+  }
+
+  this->dataPtr->tiles = reinterpret_cast<const float *>(data + tilesOffset);
+  this->dataPtr->side = header.side;
+  this->dataPtr->tileSize = header.tileSize;
+  this->dataPtr->tileMask = header.tileSize - 1;
+  this->dataPtr->tileShift = 0;
+  while ((1u << this->dataPtr->tileShift) < header.tileSize)
+    ++this->dataPtr->tileShift;
+  this->dataPtr->tileCount = header.tiles;
+
+  return true;
+}
+
+//////////////////////////////////////////////////
+void HeightmapTiles::Unload()
+{
+  if (this->dataPtr->file.is_open())
+    this->dataPtr->file.close();
+  this->dataPtr->tiles = nullptr;
+  this->dataPtr->side = 0;
+  this->dataPtr->vertCount = 0;
+}
+
+//////////////////////////////////////////////////
+bool HeightmapTiles::Valid() const
+{
+  return this->dataPtr->tiles != nullptr;
+}
+
+//////////////////////////////////////////////////
+unsigned int HeightmapTiles::VertexCount() const
+{
+  return this->dataPtr->vertCount;
+}
+
+//////////////////////////////////////////////////
+unsigned int HeightmapTiles::TileSize() const
+{
+  return this->dataPtr->tileSize;
+}
+
+//////////////////////////////////////////////////
+float HeightmapTiles::MinHeight() const
+{
+  return this->dataPtr->minHeight;
+}
+
+//////////////////////////////////////////////////
+float HeightmapTiles::MaxHeight() const
+{
+  return this->dataPtr->maxHeight;
+}
+
+//////////////////////////////////////////////////
+float HeightmapTiles::Sample(const unsigned int _x, const unsigned int _y)
+    const
+{
+  const size_t tile = static_cast<size_t>(_y >> this->dataPtr->tileShift) *
+      this->dataPtr->tileCount + (_x >> this->dataPtr->tileShift);
+  return this->dataPtr->tiles[
+      (tile << (2 * this->dataPtr->tileShift)) +
+      ((_y & this->dataPtr->tileMask) << this->dataPtr->tileShift) +
+      (_x & this->dataPtr->tileMask)];
+}
+
+//////////////////////////////////////////////////
+float HeightmapTiles::Height(const unsigned int _x, const unsigned int _y)
+    const
+{
+  if (!this->dataPtr->tiles)
+    return 0;
+
+  const unsigned int last = this->dataPtr->vertCount - 1;
+  const unsigned int x = std::min(_x, last);
+  const unsigned int y = this->dataPtr->flipY ?
+      last - std::min(_y, last) : std::min(_y, last);
+
+  // Interpolate between the samples around the vertex, like
+  // HeightmapData::FillHeightMap.
+  const unsigned int s = this->dataPtr->subSampling;
+  const unsigned int x1 = x / s;
+  const unsigned int y1 = y / s;
+  const unsigned int rx = x % s;
+  const unsigned int ry = y % s;
+
+  const float px1 = this->Sample(x1, y1);
+  if (rx == 0 && ry == 0)
+    return px1;
+
+  const unsigned int x2 = std::min(x1 + 1, this->dataPtr->side - 1);
+  const unsigned int y2 = std::min(y1 + 1, this->dataPtr->side - 1);
+  const double dx = rx / static_cast<double>(s);
+  const double dy = ry / static_cast<double>(s);
+
+  const double px2 = this->Sample(x2, y1);
+  const double h1 = px1 - ((px1 - px2) * dx);
+
+  const double px3 = this->Sample(x1, y2);
+  const double px4 = this->Sample(x2, y2);
+  const double h2 = px3 - ((px3 - px4) * dx);
+
+  return static_cast<float>(h1 - ((h1 - h2) * dy));
+}
@@ -0,0 +1,149 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#ifndef GAZEBO_COMMON_HEIGHTMAPTILES_HH_
+#define GAZEBO_COMMON_HEIGHTMAPTILES_HH_
+
+#include <memory>
+#include <string>
+#include <ignition/math/Vector3.hh>
+
+#include "gazebo/common/HeightmapData.hh"
+#include "gazebo/util/system.hh"
+
+namespace gazebo
+{
+  namespace common
+  {
+    // Forward declare private data class
+    class HeightmapTilesPrivate;
+
+    /// \addtogroup gazebo_common
+    /// \{
+
+    /// \class HeightmapTiles HeightmapTiles.hh common/common.hh
+    /// \brief Heights of a terrain, stored in square tiles in a memory
+    /// mapped file.
+    ///
+    /// The file holds one height per sample of the heightmap data, so it is
+    /// a subsampling squared times smaller than the lookup table filled by
+    /// HeightmapData::FillHeightMap. The heights of the vertices between the
+    /// samples are interpolated when they are looked up, the same way as
+    /// FillHeightMap does, and only the tiles that are looked up are paged
+    /// in. The file is kept, and reused as long as it was built with the
+    /// same key, so that a terrain is only converted once.
+    ///
+    /// Building the file still needs the whole heightmap data in memory,
+    /// and fills one height per sample with FillHeightMap before writing
+    /// the tiles, since HeightmapData can not be read one window at a
+    /// time.
+    class GZ_COMMON_VISIBLE HeightmapTiles
+    {
+      /// \brief Constructor.
+      public: HeightmapTiles();
+
+      /// \brief Destructor. Unmaps the file.
+      public: virtual ~HeightmapTiles();
+
+      /// \brief Map a tile file, building it from heightmap data first if
+      /// it does not exist or was built with another key or tile size.
+      /// \param[in] _data Heightmap data. Only used to build the file.
+      /// \param[in] _filename Path to the tile file.
+      /// \param[in] _key Identifies the data and the height scale. It is
+      /// stored in the file, and must change whenever the heights would.
+      /// \param[in] _subSampling Number of vertices per sample, as given to
+      /// FillHeightMap.
+      /// \param[in] _size Size of the terrain, as given to FillHeightMap.
+      /// \param[in] _scale Scale of the terrain, as given to FillHeightMap.
+      /// \param[in] _flipY True to flip the vertices along the y direction.
+      /// \param[in] _tileSize Number of samples along the side of a tile,
+      /// clamped to [2, 4096] and rounded up to a power of two.
+      /// \return True on success.
+      public: bool Load(HeightmapData &_data, const std::string &_filename,
+                  const std::string &_key, const int _subSampling,
+                  const ignition::math::Vector3d &_size,
+                  const ignition::math::Vector3d &_scale, const bool _flipY,
+                  const unsigned int _tileSize = 256);
+
+      /// \brief Unmap the file.
+      public: void Unload();
+
+      /// \brief Get whether a file is mapped.
+      /// \return True after Load succeeded.
+      public: bool Valid() const;
+
+      /// \brief Get the number of vertices along a side of the terrain.
+      /// \return The number of vertices, the same as the _vertSize given to
+      /// FillHeightMap.
+      public: unsigned int VertexCount() const;
+
+      /// \brief Get the number of samples along a side of a tile.
+      /// \return The tile size.
+      public: unsigned int TileSize() const;
+
+      /// \brief Get the height at a vertex. Vertices outside the terrain
+      /// are clamped to its border.
+      /// \param[in] _x Index of the vertex along x.
+      /// \param[in] _y Index of the vertex along y.
+      /// \return The height, equal to the one FillHeightMap stores at
+      /// _y * VertexCount() + _x.
+      public: float Height(const unsigned int _x, const unsigned int _y) const;
+
+      /// \brief Get the minimum height.
+      /// \return The minimum height.
+      public: float MinHeight() const;
+
+      /// \brief Get the maximum height.
+      /// \return The maximum height.
+      public: float MaxHeight() const;
+
+      /// \brief Write a tile file.
+      /// \param[in] _data Heightmap data.
+      /// \param[in] _filename Path to the tile file.
+      /// \param[in] _key Key stored in the file.
+      /// \param[in] _size Size of the terrain.
+      /// \param[in] _scale Scale of the terrain.
+      /// \param[in] _tileSize Number of samples along the side of a tile.
+      /// \return True on success.
+      private: static bool Build(HeightmapData &_data,
+                   const std::string &_filename, const std::string &_key,
+                   const ignition::math::Vector3d &_size,
+                   const ignition::math::Vector3d &_scale,
+                   const unsigned int _tileSize);
+
+      /// \brief Map a tile file.
+      /// \param[in] _filename Path to the tile file.
+      /// \param[in] _key Key the file must have been built with.
+      /// \param[in] _tileSize Tile size the file must have been built with.
+      /// \return True if the file was mapped.
+      private: bool Map(const std::string &_filename, const std::string &_key,
+                   const unsigned int _tileSize);
+
+      /// \brief Get a sample of the heightmap data.
+      /// \param[in] _x Column of the sample.
+      /// \param[in] _y Row of the sample.
+      /// \return The height of the sample.
+      private: float Sample(const unsigned int _x, const unsigned int _y)
+                   const;
+
+      /// \internal
+      /// \brief Private data pointer
+      private: std::unique_ptr<HeightmapTilesPrivate> dataPtr;
+    };
+    /// \}
+  }
+}
+#endif
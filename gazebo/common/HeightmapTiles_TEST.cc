@@ -0,0 +1,162 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <boost/filesystem.hpp>
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "gazebo/common/HeightmapTiles.hh"
+#include "gazebo/common/ImageHeightmap.hh"
+#include "test/util.hh"
+
+using namespace gazebo;
+
+class HeightmapTilesTest : public gazebo::testing::AutoLogFixture
+{
+  /// \brief Remove the tile file.
+  public: virtual void TearDown()
+  {
+    boost::filesystem::remove(this->filename);
+    gazebo::testing::AutoLogFixture::TearDown();
+  }
+
+  /// \brief Path to the tile file.
+  public: std::string filename = (boost::filesystem::temp_directory_path() /
+      boost::filesystem::unique_path("heightmap_tiles_%%%%%%%%")).string();
+};
+
+/////////////////////////////////////////////////
+TEST_F(HeightmapTilesTest, MatchesFillHeightMap)
+{
+  common::ImageHeightmap img;
+  ASSERT_EQ(0, img.Load("file://media/materials/textures/heightmap_bowl.png"));
+
+  const ignition::math::Vector3d size(129, 129, 10);
+  const ignition::math::Vector3d scale(1, 1, 10);
+
+  for (const int subSampling : {1, 2, 4})
+  {
+    for (const bool flipY : {false, true})
+    {
+      const unsigned int vertSize =
+          img.GetWidth() * subSampling - subSampling + 1;
+      std::vector<float> heights;
+      img.FillHeightMap(subSampling, vertSize, size, scale, flipY, heights);
+
+      common::HeightmapTiles tiles;
+      EXPECT_FALSE(tiles.Valid());
+      ASSERT_TRUE(tiles.Load(img, this->filename, "bowl", subSampling, size,
+          scale, flipY, 24));
+      EXPECT_TRUE(tiles.Valid());
+      EXPECT_EQ(tiles.TileSize(), 32u);
+      ASSERT_EQ(tiles.VertexCount(), vertSize);
+
+      for (unsigned int y = 0; y < vertSize; ++y)
+      {
+        for (unsigned int x = 0; x < vertSize; ++x)
+        {
+          ASSERT_NEAR(tiles.Height(x, y), heights[y * vertSize + x], 1e-5)
+              << x << " " << y;
+        }
+      }
+
+      EXPECT_FLOAT_EQ(tiles.MinHeight(),
+          *std::min_element(heights.begin(), heights.end()));
+      EXPECT_FLOAT_EQ(tiles.MaxHeight(),
+          *std::max_element(heights.begin(), heights.end()));
+
+      // Vertices outside the terrain are clamped
+      EXPECT_FLOAT_EQ(tiles.Height(vertSize + 5, 0),
+          heights[vertSize - 1]);
+    }
+  }
+}
+
+/////////////////////////////////////////////////
+TEST_F(HeightmapTilesTest, Reuse)
+{
+  common::ImageHeightmap bowl;
+  ASSERT_EQ(0, bowl.Load("file://media/materials/textures/heightmap_bowl.png"));
+  common::ImageHeightmap valley;
+  ASSERT_EQ(0,
+      valley.Load("file://media/materials/textures/heightmap_valley.png"));
+
+  const ignition::math::Vector3d size(129, 129, 10);
+  const ignition::math::Vector3d scale(1, 1, 10);
+
+  common::HeightmapTiles tiles;
+  ASSERT_TRUE(tiles.Load(bowl, this->filename, "bowl", 2, size, scale,
+      false));
+  const float bowlHeight = tiles.Height(100, 37);
+  tiles.Unload();
+  EXPECT_FALSE(tiles.Valid());
+
+  // The file is reused when the key matches, even with other data
+  ASSERT_TRUE(tiles.Load(valley, this->filename, "bowl", 2, size, scale,
+      false));
+  EXPECT_FLOAT_EQ(tiles.Height(100, 37), bowlHeight);
+
+  // and rebuilt when it does not
+  std::vector<float> heights;
+  valley.FillHeightMap(2, 257, size, scale, false, heights);
+  ASSERT_TRUE(tiles.Load(valley, this->filename, "valley", 2, size, scale,
+      false));
+  EXPECT_NEAR(tiles.Height(100, 37), heights[37 * 257 + 100], 1e-5);
+
+  // A corrupt file is rebuilt
+  tiles.Unload();
+  boost::filesystem::resize_file(this->filename, 16);
+  ASSERT_TRUE(tiles.Load(valley, this->filename, "valley", 2, size, scale,
+      false));
+  EXPECT_NEAR(tiles.Height(100, 37), heights[37 * 257 + 100], 1e-5);
+
+  // as is a file whose header would overflow the size computations
+  tiles.Unload();
+  {
+    std::fstream file(this->filename,
+        std::ios::in | std::ios::out | std::ios::binary);
+    ASSERT_TRUE(file.good());
+    const uint32_t side = std::numeric_limits<uint32_t>::max();
+    const uint32_t tileCount = 0;
+    file.seekp(16);
+    file.write(reinterpret_cast<const char *>(&side), sizeof(side));
+    file.write(reinterpret_cast<const char *>(&tileCount),
+        sizeof(tileCount));
+    ASSERT_TRUE(file.good());
+  }
+  ASSERT_TRUE(tiles.Load(valley, this->filename, "valley", 2, size, scale,
+      false));
+  EXPECT_EQ(tiles.VertexCount(), 257u);
+  EXPECT_NEAR(tiles.Height(100, 37), heights[37 * 257 + 100], 1e-5);
+
+  EXPECT_FALSE(tiles.Load(valley, this->filename, "valley", 0, size, scale,
+      false));
+  EXPECT_FALSE(tiles.Valid());
+  EXPECT_FLOAT_EQ(tiles.Height(0, 0), 0.0f);
+}
+
+/////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -105,6 +105,13 @@ std::pair<double, ignition::math::Matrix4d> NodeAnimation::KeyFrame(
   return std::make_pair(t, mat);
 }
 
+//////////////////////////////////////////////////
+const std::map<double, ignition::math::Matrix4d> &NodeAnimation::KeyFrames()
+    const
+{
+  return this->keyFrames;
+}
+
 //////////////////////////////////////////////////
 double NodeAnimation::GetLength() const
 {
@@ -240,6 +247,16 @@ bool SkeletonAnimation::HasNode(const std::string& _node) const
   return (this->animations.find(_node) != this->animations.end());
 }
 
+//////////////////////////////////////////////////
+const NodeAnimation *SkeletonAnimation::NodeAnimationByName(
+    const std::string &_node) const
+{
+  auto iter = this->animations.find(_node);
+  if (iter == this->animations.end())
+    return nullptr;
+  return iter->second;
+}
+
 //////////////////////////////////////////////////
 void SkeletonAnimation::AddKeyFrame(const std::string& _node,
     const double _time, const ignition::math::Matrix4d &_mat)
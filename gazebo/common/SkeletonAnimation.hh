@@ -86,6 +86,11 @@ namespace gazebo
       public: std::pair<double, ignition::math::Matrix4d> KeyFrame(
                       const unsigned int _i) const;
 
+      /// \brief Returns every key frame.
+      /// \return the transformations indexed by time
+      public: const std::map<double, ignition::math::Matrix4d> &KeyFrames()
+                  const;
+
       /// \brief Returns the duration of the animations
       /// \return the time of the last animation
       public: double GetLength() const;
@@ -150,6 +155,12 @@ namespace gazebo
       /// \return true if the node exits
       public: bool HasNode(const std::string &_node) const;
 
+      /// \brief Returns the animation of a named node
+      /// \param[in] _node the name of the node
+      /// \return the node animation, or nullptr if the node does not exist
+      public: const NodeAnimation *NodeAnimationByName(
+                  const std::string &_node) const;
+
       /// \brief Adds or replaces a named key frame at a specific time
       /// \param[in] _node the name of the new or existing node
       /// \param[in] _time the time
@@ -17,7 +17,11 @@
 #include <sstream>
 #include <limits>
 #include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <vector>
 
+#include "gazebo/common/BakedSkeletonAnimation.hh"
 #include "gazebo/common/BVHLoader.hh"
 #include "gazebo/common/Console.hh"
 #include "gazebo/common/KeyFrame.hh"
@@ -35,9 +39,50 @@
 
 #include "gazebo/transport/Node.hh"
 
+namespace gazebo
+{
+  namespace physics
+  {
+    /// \brief A skeleton animation of an actor baked for its skin
+    class ActorBakedAnimation
+    {
+      /// \brief The animation this was baked from
+      public: const common::SkeletonAnimation *source = nullptr;
+
+      /// \brief The baked animation. Track i samples the animation node which
+      /// moves the skin node with handle i.
+      public: common::BakedSkeletonAnimation animation;
+
+      /// \brief True if the animation is interpolated along X
+      public: bool interpolateX = false;
+
+      /// \brief Translation aligner of every skin node, by handle
+      public: std::vector<ignition::math::Matrix4d> translationAligners;
+
+      /// \brief Rotation aligner of every skin node, by handle
+      public: std::vector<ignition::math::Matrix4d> rotationAligners;
+    };
+  }
+}
+
 /// \brief Private data for Actor class
 class gazebo::physics::ActorPrivate
 {
+  /// \brief Bake a skeleton animation of the actor, unless it is already
+  /// baked.
+  /// \param[in] _type Name of the animation.
+  /// \param[in] _animation The animation.
+  /// \param[in] _skeleton The skin skeleton.
+  /// \param[in] _skelMap Skin node names and the animation nodes which
+  /// move them.
+  /// \param[in] _interpolateX True if the animation is interpolated along X.
+  /// \return The baked animation.
+  public: const ActorBakedAnimation *Bake(const std::string &_type,
+      const common::SkeletonAnimation *_animation,
+      common::Skeleton *_skeleton,
+      const std::map<std::string, std::string> &_skelMap,
+      const bool _interpolateX);
+
   /// \brief True if the animation is loaded from BVH file
   public: bool bvhFile = false;
 
@@ -49,17 +94,80 @@ class gazebo::physics::ActorPrivate
   public: std::map<std::string, ignition::math::Matrix4d>
       rotationAligner;
 
-  /// \brief Last animated frame
-  public: std::map<std::string, ignition::math::Matrix4d> lastFrame;
+  /// \brief Baked skeleton animations, indexed by name
+  public: std::map<std::string, std::unique_ptr<ActorBakedAnimation>>
+      bakedAnimations;
+
+  /// \brief Every skin node, by handle
+  public: std::vector<common::SkeletonNode *> bones;
 
-  /// \brief Last map associating skeleton nodes from skin and animation
-  public: std::map<std::string, std::string> lastSkelMap;
+  /// \brief Link of every skin node, by handle
+  public: std::vector<LinkPtr> boneLinks;
+
+  /// \brief Link of the parent of every skin node, by handle
+  public: std::vector<LinkPtr> parentLinks;
+
+  /// \brief Handle of the root node of the skin
+  public: unsigned int rootHandle = 0;
+
+  /// \brief Last animated frame, a transform for every skin node, by handle
+  public: std::vector<ignition::math::Matrix4d> frame;
+
+  /// \brief Whether the last animated frame moves every skin node, by
+  /// handle
+  public: std::vector<uint8_t> frameSet;
+
+  /// \brief Animation of the last animated frame
+  public: const ActorBakedAnimation *lastAnimation = nullptr;
+
+  /// \brief Skeleton pose message, reused for every frame
+  public: msgs::PoseAnimation poseMsg;
 };
 
 using namespace gazebo;
 using namespace physics;
 using namespace common;
 
+//////////////////////////////////////////////////
+const ActorBakedAnimation *ActorPrivate::Bake(const std::string &_type,
+    const SkeletonAnimation *_animation, Skeleton *_skeleton,
+    const std::map<std::string, std::string> &_skelMap,
+    const bool _interpolateX)
+{
+  std::unique_ptr<ActorBakedAnimation> &baked = this->bakedAnimations[_type];
+  if (baked && baked->source == _animation &&
+      baked->interpolateX == _interpolateX)
+  {
+    return baked.get();
+  }
+
+  baked.reset(new ActorBakedAnimation);
+  baked->source = _animation;
+  baked->interpolateX = _interpolateX;
+
+  const unsigned int nodeCount = _skeleton->GetNumNodes();
+  std::vector<std::string> nodes(nodeCount);
+  baked->translationAligners.resize(nodeCount);
+  baked->rotationAligners.resize(nodeCount);
+  for (unsigned int i = 0; i < nodeCount; ++i)
+  {
+    auto node = _skelMap.find(_skeleton->GetNodeByHandle(i)->GetName());
+    if (node == _skelMap.end())
+      continue;
+    nodes[i] = node->second;
+
+    auto aligner = this->translationAligner.find(node->second);
+    if (aligner != this->translationAligner.end())
+      baked->translationAligners[i] = aligner->second;
+    aligner = this->rotationAligner.find(node->second);
+    if (aligner != this->rotationAligner.end())
+      baked->rotationAligners[i] = aligner->second;
+  }
+  baked->animation.Bake(*_animation, nodes);
+
+  return baked.get();
+}
+
 //////////////////////////////////////////////////
 Actor::Actor(BasePtr _parent)
   : Model(_parent), dataPtr(new ActorPrivate)
@@ -649,6 +757,41 @@ void Actor::Init()
   if (this->autoStart)
     this->Play();
   this->mainLink = this->GetChildLink(this->GetName() + "_pose");
+
+  if (!this->skeleton)
+    return;
+
+  // Index the skin nodes and their links by handle
+  const unsigned int nodeCount = this->skeleton->GetNumNodes();
+  this->dataPtr->bones.resize(nodeCount);
+  this->dataPtr->boneLinks.resize(nodeCount);
+  this->dataPtr->parentLinks.resize(nodeCount);
+  for (unsigned int i = 0; i < nodeCount; ++i)
+  {
+    SkeletonNode *bone = this->skeleton->GetNodeByHandle(i);
+    this->dataPtr->bones[i] = bone;
+    this->dataPtr->boneLinks[i] = this->GetChildLink(bone->GetName());
+    if (bone->GetParent())
+    {
+      this->dataPtr->parentLinks[i] =
+          this->GetChildLink(bone->GetParent()->GetName());
+    }
+    if (bone == this->skeleton->GetRootNode())
+      this->dataPtr->rootHandle = i;
+  }
+  this->dataPtr->frame.resize(nodeCount, ignition::math::Matrix4d::Identity);
+  this->dataPtr->frameSet.resize(nodeCount, 0);
+  this->dataPtr->poseMsg.Clear();
+
+  // Bake the animations now that all of them are aligned
+  for (auto const &anim : this->skelAnimation)
+  {
+    if (anim.second)
+    {
+      this->dataPtr->Bake(anim.first, anim.second, this->skeleton,
+          this->skelNodesMap[anim.first], this->interpolateX[anim.first]);
+    }
+  }
 }
 
 //////////////////////////////////////////////////
@@ -676,8 +819,7 @@ void Actor::Update()
   common::Time currentTime = this->world->SimTime();
   if (!this->active)
   {
-    this->SetPose(this->dataPtr->lastFrame, this->dataPtr->lastSkelMap,
-                  currentTime.Double());
+    this->ApplyFrame(currentTime.Double());
     return;
   }
 
@@ -698,8 +840,7 @@ void Actor::Update()
     // waiting for delayed start
     if (this->scriptTime < 0)
     {
-      this->SetPose(this->dataPtr->lastFrame, this->dataPtr->lastSkelMap,
-                    currentTime.Double());
+      this->ApplyFrame(currentTime.Double());
       return;
     }
 
@@ -774,44 +915,40 @@ void Actor::Update()
     this->lastPos = modelPose.Pos();
   }
 
-  SkeletonAnimation *skelAnim = this->skelAnimation[tinfo->type];
+  SkeletonAnimation *skelAnim = nullptr;
+  auto animIter = this->skelAnimation.find(tinfo->type);
+  if (animIter != this->skelAnimation.end())
+    skelAnim = animIter->second;
 
   // If there's no skeleton animation, we just update the global pose
-  if (!skelAnim)
+  if (!skelAnim || !this->skeleton ||
+      this->dataPtr->frame.size() != this->skeleton->GetNumNodes())
   {
     this->SetWorldPose(modelPose);
     return;
   }
 
-  auto skelMap = this->skelNodesMap[tinfo->type];
+  const ActorBakedAnimation *baked = this->dataPtr->Bake(tinfo->type,
+      skelAnim, this->skeleton, this->skelNodesMap[tinfo->type],
+      this->interpolateX[tinfo->type]);
 
-  std::map<std::string, ignition::math::Matrix4d> frame;
-  if (!this->customTrajectoryInfo)
-  {
-    if (this->interpolateX[tinfo->type] &&
-          this->trajectories.find(tinfo->id) != this->trajectories.end())
-    {
-      frame = skelAnim->PoseAtX(this->pathLength,
-                skelMap[this->skeleton->GetRootNode()->GetName()]);
-    }
-    else
-    {
-      frame = skelAnim->PoseAt(this->scriptTime);
-    }
-  }
-  else
+  // Sample the skeleton animation into the frame, which is reused
+  const unsigned int root = this->dataPtr->rootHandle;
+  double animTime = this->scriptTime;
+  if (!this->customTrajectoryInfo && baked->interpolateX &&
+      this->trajectories.find(tinfo->id) != this->trajectories.end())
   {
-    frame = skelAnim->PoseAt(this->scriptTime);
+    animTime = baked->animation.TimeAtX(this->pathLength, root, true);
   }
+  baked->animation.PoseAt(animTime, true, this->dataPtr->frame);
+  for (size_t i = 0; i < this->dataPtr->frameSet.size(); ++i)
+    this->dataPtr->frameSet[i] = baked->animation.HasTrack(i);
 
   this->lastTraj = tinfo->id;
 
   ignition::math::Matrix4d rootTrans = ignition::math::Matrix4d::Identity;
-  auto iter = frame.find(skelMap[this->skeleton->GetRootNode()->GetName()]);
-  if (iter != frame.end())
-  {
-    rootTrans = frame[skelMap[this->skeleton->GetRootNode()->GetName()]];
-  }
+  if (this->dataPtr->frameSet[root])
+    rootTrans = this->dataPtr->frame[root];
 
   ignition::math::Vector3d rootPos = rootTrans.Translation();
   ignition::math::Quaterniond rootRot = rootTrans.Rotation();
@@ -852,23 +989,46 @@ void Actor::Update()
   // workaround for rotation bug
   rootM.SetTranslation(rootM.Translation() * this->skinScale);
 
-  frame[skelMap[this->skeleton->GetRootNode()->GetName()]] = rootM;
-
-  this->dataPtr->lastFrame = frame;
-  this->dataPtr->lastSkelMap = skelMap;
+  this->dataPtr->frame[root] = rootM;
+  this->dataPtr->frameSet[root] = 1;
+  this->dataPtr->lastAnimation = baked;
 
-  this->SetPose(frame, skelMap, currentTime.Double());
+  this->ApplyFrame(currentTime.Double());
 }
 
 //////////////////////////////////////////////////
-void Actor::SetPose(std::map<std::string, ignition::math::Matrix4d> _frame,
-    std::map<std::string, std::string> _skelMap, const double _time)
+void Actor::ApplyFrame(const double _time)
 {
-  msgs::PoseAnimation msg;
-  msg.set_model_name(this->visualName);
-  msg.set_model_id(this->visualId);
+  if (!this->skeleton ||
+      this->dataPtr->bones.size() != this->skeleton->GetNumNodes())
+  {
+    return;
+  }
+
+  // The pose message is only filled in when someone listens to it
+  const bool publish = this->bonePosePub &&
+      this->bonePosePub->HasConnections();
+  msgs::PoseAnimation &msg = this->dataPtr->poseMsg;
+  if (publish && msg.pose_size() == 0)
+  {
+    msg.set_model_name(this->visualName);
+    msg.set_model_id(this->visualId);
+    for (unsigned int i = 0; i < this->dataPtr->bones.size(); ++i)
+    {
+      msg.add_pose()->set_name(this->dataPtr->bones[i]->GetName());
+      msgs::Pose *linkPoseMsg = msg.add_pose();
+      if (this->dataPtr->boneLinks[i])
+      {
+        linkPoseMsg->set_name(this->dataPtr->boneLinks[i]->GetScopedName());
+        linkPoseMsg->set_id(this->dataPtr->boneLinks[i]->GetId());
+      }
+    }
+    msg.add_time();
+    msgs::Pose *modelPoseMsg = msg.add_pose();
+    modelPoseMsg->set_name(this->GetScopedName());
+    modelPoseMsg->set_id(this->GetId());
+  }
 
-  ignition::math::Matrix4d modelTrans(ignition::math::Matrix4d::Identity);
   ignition::math::Pose3d mainLinkPose;
 
   if (this->customTrajectoryInfo)
@@ -877,20 +1037,19 @@ void Actor::SetPose(std::map<std::string, ignition::math::Matrix4d> _frame,
     mainLinkPose.Rot() = this->worldPose.Rot();
   }
 
-  for (unsigned int i = 0; i < this->skeleton->GetNumNodes(); ++i)
+  const ActorBakedAnimation *anim = this->dataPtr->lastAnimation;
+  for (unsigned int i = 0; i < this->dataPtr->bones.size(); ++i)
   {
-    SkeletonNode *bone = this->skeleton->GetNodeByHandle(i);
-    SkeletonNode *parentBone = bone->GetParent();
+    SkeletonNode *bone = this->dataPtr->bones[i];
     ignition::math::Matrix4d transform(ignition::math::Matrix4d::Identity);
 
-    if (_frame.find(_skelMap[bone->GetName()]) != _frame.end())
+    if (this->dataPtr->frameSet[i])
     {
-      if (this->dataPtr->bvhFile)
-      {
-        std::string tempStr(_skelMap[bone->GetName()]);
-        transform = _frame[tempStr];
+      transform = this->dataPtr->frame[i];
 
-        if (bone->GetName() != this->skeleton->GetRootNode()->GetName())
+      if (this->dataPtr->bvhFile && anim)
+      {
+        if (i != this->dataPtr->rootHandle)
         {
           ignition::math::Vector3d bvhOffset = transform.Translation();
           ignition::math::Vector3d daeOffset = bone->Transform().Translation();
@@ -898,12 +1057,8 @@ void Actor::SetPose(std::map<std::string, ignition::math::Matrix4d> _frame,
           transform.SetTranslation(daeOffset.Length() * bvhOffset.Normalize());
         }
 
-        transform = this->dataPtr->translationAligner[tempStr] * transform *
-            this->dataPtr->rotationAligner[tempStr];
-      }
-      else
-      {
-        transform = _frame[_skelMap[bone->GetName()]];
+        transform = anim->translationAligners[i] * transform *
+            anim->rotationAligners[i];
       }
     }
     else
@@ -911,7 +1066,10 @@ void Actor::SetPose(std::map<std::string, ignition::math::Matrix4d> _frame,
       transform = bone->Transform();
     }
 
-    LinkPtr currentLink = this->GetChildLink(bone->GetName());
+    LinkPtr currentLink = this->dataPtr->boneLinks[i];
+    if (!currentLink)
+      continue;
+
     ignition::math::Pose3d bonePose = transform.Pose();
     if (!bonePose.IsFinite())
     {
@@ -920,59 +1078,57 @@ void Actor::SetPose(std::map<std::string, ignition::math::Matrix4d> _frame,
       bonePose.Correct();
     }
 
-    msgs::Pose *bone_pose = msg.add_pose();
-    bone_pose->set_name(bone->GetName());
+    msgs::Pose *bonePoseMsg = publish ? msg.mutable_pose(2 * i) : nullptr;
 
-    if (!parentBone)
+    if (!bone->GetParent())
     {
-      bone_pose->mutable_position()->CopyFrom(
-          msgs::Convert(ignition::math::Vector3d()));
-      bone_pose->mutable_orientation()->CopyFrom(msgs::Convert(
-          ignition::math::Quaterniond()));
+      if (bonePoseMsg)
+      {
+        msgs::Set(bonePoseMsg->mutable_position(),
+            ignition::math::Vector3d::Zero);
+        msgs::Set(bonePoseMsg->mutable_orientation(),
+            ignition::math::Quaterniond::Identity);
+      }
       if (!this->customTrajectoryInfo)
         mainLinkPose = bonePose;
     }
     else
     {
-      bone_pose->mutable_position()->CopyFrom(msgs::Convert(bonePose.Pos()));
-      bone_pose->mutable_orientation()->CopyFrom(msgs::Convert(bonePose.Rot()));
-      LinkPtr parentLink = this->GetChildLink(parentBone->GetName());
-      auto parentPose = parentLink->WorldPose();
-      ignition::math::Matrix4d parentTrans(parentPose);
-      transform = parentTrans * transform;
+      if (bonePoseMsg)
+      {
+        msgs::Set(bonePoseMsg->mutable_position(), bonePose.Pos());
+        msgs::Set(bonePoseMsg->mutable_orientation(), bonePose.Rot());
+      }
+      if (this->dataPtr->parentLinks[i])
+      {
+        ignition::math::Matrix4d parentTrans(
+            this->dataPtr->parentLinks[i]->WorldPose());
+        transform = parentTrans * transform;
+      }
     }
 
-    msgs::Pose *link_pose = msg.add_pose();
-    link_pose->set_name(currentLink->GetScopedName());
-    link_pose->set_id(currentLink->GetId());
-    ignition::math::Pose3d linkPose = transform.Pose() - mainLinkPose;
-    link_pose->mutable_position()->CopyFrom(msgs::Convert(linkPose.Pos()));
-    link_pose->mutable_orientation()->CopyFrom(msgs::Convert(linkPose.Rot()));
+    if (publish)
+    {
+      msgs::Pose *linkPoseMsg = msg.mutable_pose(2 * i + 1);
+      ignition::math::Pose3d linkPose = transform.Pose() - mainLinkPose;
+      msgs::Set(linkPoseMsg->mutable_position(), linkPose.Pos());
+      msgs::Set(linkPoseMsg->mutable_orientation(), linkPose.Rot());
+    }
     currentLink->SetWorldPose(transform.Pose(), true, false);
   }
 
-  msgs::Time *stamp = msg.add_time();
-  stamp->CopyFrom(msgs::Convert(_time));
-
-  msgs::Pose *model_pose = msg.add_pose();
-  model_pose->set_name(this->GetScopedName());
-  model_pose->set_id(this->GetId());
-  if (!this->customTrajectoryInfo)
+  if (publish)
   {
-    model_pose->mutable_position()->CopyFrom(msgs::Convert(mainLinkPose.Pos()));
-    model_pose->mutable_orientation()->CopyFrom(
-        msgs::Convert(mainLinkPose.Rot()));
-  }
-  else
-  {
-    model_pose->mutable_position()->CopyFrom(
-        msgs::Convert(this->worldPose.Pos()));
-    model_pose->mutable_orientation()->CopyFrom(
-        msgs::Convert(this->worldPose.Rot()));
-  }
+    msgs::Set(msg.mutable_time(0), common::Time(_time));
+
+    msgs::Pose *modelPoseMsg = msg.mutable_pose(msg.pose_size() - 1);
+    if (!this->customTrajectoryInfo)
+      msgs::Set(modelPoseMsg, mainLinkPose);
+    else
+      msgs::Set(modelPoseMsg, this->worldPose);
 
-  if (this->bonePosePub && this->bonePosePub->HasConnections())
     this->bonePosePub->Publish(msg);
+  }
   if (!this->customTrajectoryInfo)
     this->SetWorldPose(mainLinkPose, true, false);
 }
@@ -277,15 +277,11 @@ namespace gazebo
       /// \param[in] _sdf SDF element containing the trajectory script.
       private: void LoadScript(sdf::ElementPtr _sdf);
 
-      /// \brief Set the actor's pose. This sets the pose for each bone in the
-      /// skeleton and also the actor's pose in the world.
-      /// \param[in] _frame Each frame name and transform.
-      /// \param[in] _skelMap Map of bone relationships.
+      /// \brief Set the actor's pose from the last animated frame. This sets
+      /// the pose for each bone in the skeleton and also the actor's pose in
+      /// the world.
       /// \param[in] _time Time over which to animate the set pose.
-      private: void SetPose(
-                   std::map<std::string, ignition::math::Matrix4d> _frame,
-                   std::map<std::string, std::string> _skelMap,
-                   const double _time);
+      private: void ApplyFrame(const double _time);
 
       /// \brief Pointer to the actor's mesh.
       protected: const common::Mesh *mesh = nullptr;
@@ -14,6 +14,10 @@
  * limitations under the License.
  *
 */
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
 #include "gazebo/common/Assert.hh"
 #include "gazebo/common/Console.hh"
 #include "gazebo/common/Exception.hh"
@@ -26,6 +30,35 @@
 using namespace gazebo;
 using namespace physics;
 
+namespace gazebo
+{
+  namespace physics
+  {
+    /// \internal
+    /// \brief Private data for the Base class.
+    class BasePrivate
+    {
+      /// \brief Name the object was added to the entity index with.
+      public: std::string indexedName;
+
+      /// \brief Scoped name the object was added to the entity index with.
+      public: std::string indexedScopedName;
+
+      /// \brief World whose entity index contains the object.
+      public: WorldPtr indexWorld;
+    };
+  }
+}
+
+// TODO added here for ABI compatibility
+// move to a private data pointer in Base when merging forward.
+/// \brief Private data of the objects that are in the entity index of
+/// their world.
+static std::unordered_map<const Base *, BasePrivate> gIndexedBases;
+
+/// \brief Mutex that protects gIndexedBases.
+static std::mutex gIndexedBasesMutex;
+
 //////////////////////////////////////////////////
 Base::Base(BasePtr _parent)
 : parent(_parent)
@@ -49,6 +82,11 @@ Base::Base(BasePtr _parent)
 //////////////////////////////////////////////////
 Base::~Base()
 {
+  // Drop the entry of the entity index table before anything else, so
+  // that it never outlives the object, even if Fini is overridden or
+  // fails. Another object may be allocated at the same address later.
+  this->RemoveFromIndex();
+
   this->Fini();
 }
 
@@ -73,6 +111,10 @@ void Base::Load(sdf::ElementPtr _sdf)
 
   this->ComputeScopedName();
 
+  // Make the object available to World::BaseByName and World::BaseById
+  if (this->parent)
+    this->AddToIndex();
+
   this->RegisterIntrospectionItems();
 }
 
@@ -89,6 +131,8 @@ void Base::Fini()
 {
   this->UnregisterIntrospectionItems();
 
+  this->RemoveFromIndex();
+
   // Remove self as a child of the parent
   if (this->parent)
   {
@@ -242,7 +286,20 @@ BasePtr Base::GetChild(unsigned int _i) const
 //////////////////////////////////////////////////
 BasePtr Base::GetChild(const std::string &_name)
 {
-  std::string fullName = this->GetScopedName() + "::" + _name;
+  std::string fullName = this->scopedName + "::" + _name;
+
+  // Use the entity index of the world, if the entity it finds is in
+  // this subtree.
+  if (this->world)
+  {
+    BasePtr result = this->world->BaseByName(fullName);
+    for (BasePtr p = result; p; p = p->GetParent())
+    {
+      if (p.get() == this)
+        return result;
+    }
+  }
+
   return this->GetByName(fullName);
 }
 
@@ -295,7 +352,7 @@ BasePtr Base::GetById(unsigned int _id) const
 //////////////////////////////////////////////////
 BasePtr Base::GetByName(const std::string &_name)
 {
-  if (this->GetScopedName() == _name || this->GetName() == _name)
+  if (this->scopedName == _name || this->name == _name)
     return shared_from_this();
 
   BasePtr result;
@@ -371,6 +428,54 @@ void Base::ComputeScopedName()
       this->scopedName.insert(0, p->GetName()+"::");
     p = p->GetParent();
   }
+
+  bool indexed;
+  {
+    std::lock_guard<std::mutex> lock(gIndexedBasesMutex);
+    indexed = gIndexedBases.count(this) > 0;
+  }
+
+  if (indexed)
+    this->AddToIndex();
+
+  // The scoped names of the children contain the name of this object
+  for (auto &child : this->children)
+    child->ComputeScopedName();
+}
+
+//////////////////////////////////////////////////
+void Base::AddToIndex()
+{
+  this->RemoveFromIndex();
+
+  if (!this->world)
+    return;
+
+  BasePrivate data;
+  data.indexWorld = this->world;
+  data.indexedName = this->name;
+  data.indexedScopedName = this->scopedName;
+  data.indexWorld->_AddToEntityIndex(shared_from_this());
+
+  std::lock_guard<std::mutex> lock(gIndexedBasesMutex);
+  gIndexedBases[this] = std::move(data);
+}
+
+//////////////////////////////////////////////////
+void Base::RemoveFromIndex()
+{
+  BasePrivate data;
+  {
+    std::lock_guard<std::mutex> lock(gIndexedBasesMutex);
+    auto iter = gIndexedBases.find(this);
+    if (iter == gIndexedBases.end())
+      return;
+    data = std::move(iter->second);
+    gIndexedBases.erase(iter);
+  }
+
+  data.indexWorld->_RemoveFromEntityIndex(this->id, data.indexedName,
+      data.indexedScopedName);
 }
 
 //////////////////////////////////////////////////
@@ -336,11 +336,18 @@ namespace gazebo
       /// \brief Unregister items in the introspection service.
       protected: virtual void UnregisterIntrospectionItems();
 
-      /// \brief Compute the scoped name of this object based on its
-      /// parents.
+      /// \brief Compute the scoped name of this object and its children
+      /// based on their parents, and update the world's entity index.
       /// \sa Base::GetScopedName
       protected: void ComputeScopedName();
 
+      /// \brief Add this object to the entity index of its world, under
+      /// its current name and scoped name.
+      private: void AddToIndex();
+
+      /// \brief Remove this object from the entity index of its world.
+      private: void RemoveFromIndex();
+
       /// \brief The SDF values for this object.
       protected: sdf::ElementPtr sdf;
 
@@ -14,6 +14,18 @@
  * limitations under the License.
  *
 */
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
 #include <boost/algorithm/string.hpp>
 
 #include "gazebo/transport/Node.hh"
@@ -30,12 +42,204 @@
 using namespace gazebo;
 using namespace physics;
 
+/// \brief Minimum number of contacts added to the pool when it is empty.
+static const size_t kContactPoolChunk = 16;
+
+/// \brief Largest number of snapshots waiting to be published. Further
+/// steps are merged into the last snapshot.
+static const size_t kMaxContactSnapshots = 16;
+
+namespace gazebo
+{
+  namespace physics
+  {
+    /// \internal
+    /// \brief The contacts of one or more steps, and the topics they go
+    /// to.
+    class ContactSnapshot
+    {
+      /// \brief Contact records. Only the first recordCount are valid,
+      /// the others are kept to reuse their memory. Records without
+      /// contact points are skipped when publishing.
+      public: std::vector<ContactRecord> records;
+
+      /// \brief Number of valid records.
+      public: size_t recordCount = 0;
+
+      /// \brief Name of each filter, with the indices of its records.
+      /// Only the first filterCount are valid.
+      public: std::vector<std::pair<std::string, std::vector<unsigned int> > >
+              filters;
+
+      /// \brief Number of valid filters.
+      public: size_t filterCount = 0;
+
+      /// \brief Publish all the records to the default contacts topic.
+      public: bool publishDefault = false;
+
+      /// \brief Simulation time of the last step in the snapshot.
+      public: common::Time time;
+    };
+
+    /// \internal
+    /// \brief Private data for the ContactManager class.
+    class ContactManagerPrivate
+    {
+      /// \brief Snapshots waiting to be published, oldest first.
+      public: std::deque<ContactSnapshot> pending;
+
+      /// \brief Published snapshots, whose memory is reused by
+      /// SnapshotContacts.
+      public: std::vector<ContactSnapshot> spare;
+
+      /// \brief Protects pending and spare. It is only held to move the
+      /// snapshots.
+      public: std::mutex snapshotMutex;
+
+      /// \brief Held while PublishSnapshot publishes, so RemoveFilter
+      /// doesn't finalize a publisher that is in use.
+      public: std::mutex publishMutex;
+
+      /// \brief Contacts that go to a filter with receivers, reused
+      /// every step.
+      public: std::vector<bool> recordUsed;
+
+      /// \brief In-process listeners of each filter, indexed by filter
+      /// name and by the id returned by ContactManager::ConnectFilter.
+      /// Filters without listeners have no entry. It is modified with
+      /// both publishMutex and customMutex held, so it may be read with
+      /// either of them held.
+      public: std::map<std::string, std::map<int,
+              std::function<void(const ContactRecordSpan &)> > > listeners;
+
+      /// \brief Id of the next listener connected with ConnectFilter.
+      public: int nextListenerId = 0;
+
+      /// \brief Storage of the contacts. A deque doesn't move its elements
+      /// when it grows, so the pointers in ContactManager::contacts stay
+      /// valid.
+      public: std::deque<Contact> contactPool;
+
+      /// \brief Custom publishers of each collision monitored by a filter.
+      /// Only RebuildFilters modifies it, so it is read without a lock.
+      public: boost::unordered_map<const Collision *,
+              std::vector<ContactPublisher *> > filterTable;
+
+      /// \brief True if the filters changed since the filter table was
+      /// built. The custom publishers are then searched under the lock.
+      public: std::atomic<bool> filtersDirty{false};
+
+      /// \brief True if a filter has collision names that were not found
+      /// when the filter table was built.
+      public: bool filterNamesPending = false;
+
+      /// \brief True if the default contact publisher had connections at
+      /// the last ResetCount.
+      public: std::atomic<bool> contactPubConnected{false};
+
+      /// \brief Publishers of removed filters. They are deleted by
+      /// RebuildFilters, once the filter table doesn't refer to them.
+      public: std::vector<ContactPublisher *> removedPublishers;
+
+      /// \brief Indices in ContactManager::GetContacts() of the contacts
+      /// of each custom publisher, in the current step. It is only used
+      /// on the physics thread.
+      public: std::unordered_map<const ContactPublisher *,
+              std::vector<unsigned int> > contactIndices;
+    };
+  }
+}
+
+// TODO added here for ABI compatibility
+// move to a private data pointer in ContactManager when merging forward.
+static std::map<const ContactManager *,
+    std::unique_ptr<ContactManagerPrivate>> gContactManagerData;
+
+/// \brief Mutex that protects gContactManagerData.
+static std::mutex gContactManagerDataMutex;
+
+/// \brief Incremented, with gContactManagerDataMutex held, whenever an
+/// entry is added to or removed from gContactManagerData.
+static std::atomic<uint64_t> gContactManagerDataVersion(0);
+
+/////////////////////////////////////////////////
+/// \brief Get the private data of a contact manager. This is called for
+/// every contact, so each thread keeps the result of its last lookup
+/// until a contact manager is created or destroyed.
+/// \param[in] _manager The contact manager.
+/// \return The private data, which lives as long as the manager.
+static ContactManagerPrivate *contactManagerData(
+    const ContactManager *_manager)
+{
+  thread_local const ContactManager *cachedManager = nullptr;
+  thread_local ContactManagerPrivate *cachedData = nullptr;
+  thread_local uint64_t cachedVersion = 0;
+
+  if (_manager == cachedManager &&
+      gContactManagerDataVersion.load(std::memory_order_acquire) ==
+      cachedVersion)
+  {
+    return cachedData;
+  }
+
+  std::lock_guard<std::mutex> lock(gContactManagerDataMutex);
+  auto iter = gContactManagerData.find(_manager);
+  GZ_ASSERT(iter != gContactManagerData.end(),
+      "ContactManager has no private data");
+  cachedManager = _manager;
+  cachedData = iter->second.get();
+  cachedVersion = gContactManagerDataVersion.load(std::memory_order_relaxed);
+  return cachedData;
+}
+
+/////////////////////////////////////////////////
+/// \brief Move the contacts of a snapshot to the end of another one.
+/// \param[in,out] _from Snapshot whose contacts are moved. Its records
+/// are left in an unspecified state, to be reused.
+/// \param[in,out] _to Snapshot that receives the contacts.
+static void mergeSnapshot(ContactSnapshot &_from, ContactSnapshot &_to)
+{
+  const unsigned int offset = _to.recordCount;
+  if (_to.records.size() < _to.recordCount + _from.recordCount)
+    _to.records.resize(_to.recordCount + _from.recordCount);
+  for (size_t i = 0; i < _from.recordCount; ++i)
+    std::swap(_to.records[_to.recordCount++], _from.records[i]);
+
+  for (size_t i = 0; i < _from.filterCount; ++i)
+  {
+    auto &from = _from.filters[i];
+
+    size_t j = 0;
+    while (j < _to.filterCount && _to.filters[j].first != from.first)
+      ++j;
+
+    if (j == _to.filterCount)
+    {
+      if (_to.filters.size() == _to.filterCount)
+        _to.filters.emplace_back();
+      _to.filters[_to.filterCount].first = from.first;
+      _to.filters[_to.filterCount].second.clear();
+      ++_to.filterCount;
+    }
+
+    for (auto const &index : from.second)
+      _to.filters[j].second.push_back(index + offset);
+  }
+
+  _to.publishDefault = _to.publishDefault || _from.publishDefault;
+  _to.time = _from.time;
+}
+
 /////////////////////////////////////////////////
 ContactManager::ContactManager()
 {
   this->contactIndex = 0;
   this->customMutex = new boost::recursive_mutex();
   this->neverDropContacts = false;
+
+  std::lock_guard<std::mutex> lock(gContactManagerDataMutex);
+  gContactManagerData[this].reset(new ContactManagerPrivate);
+  ++gContactManagerDataVersion;
 }
 
 /////////////////////////////////////////////////
@@ -62,10 +266,21 @@ ContactManager::~ContactManager()
     }
   }
   this->customContactPublishers.clear();
+
+  ContactManagerPrivate *data = contactManagerData(this);
+  for (auto &removed : data->removedPublishers)
+    delete removed;
+  data->removedPublishers.clear();
+  data->filterTable.clear();
+
   delete this->customMutex;
   this->customMutex = NULL;
 
   this->world.reset();
+
+  std::lock_guard<std::mutex> lock(gContactManagerDataMutex);
+  gContactManagerData.erase(this);
+  ++gContactManagerDataVersion;
 }
 
 /////////////////////////////////////////////////
@@ -95,6 +310,24 @@ bool ContactManager::NeverDropContacts() const
 /////////////////////////////////////////////////
 bool ContactManager::SubscribersConnected(Collision *_collision1,
                                           Collision *_collision2) const
+{
+  // This is called for every candidate pair from the collision callback,
+  // so it uses the connection state and the filter table that were
+  // updated by ResetCount, without taking a lock.
+  ContactManagerPrivate *data = contactManagerData(this);
+  if (data->contactPubConnected)
+    return true;
+
+  if (data->filtersDirty)
+    return this->SubscribersConnectedLocked(_collision1, _collision2);
+
+  return data->filterTable.find(_collision1) != data->filterTable.end() ||
+         data->filterTable.find(_collision2) != data->filterTable.end();
+}
+
+/////////////////////////////////////////////////
+bool ContactManager::SubscribersConnectedLocked(Collision *_collision1,
+                                                Collision *_collision2) const
 {
   if (this->contactPub->HasConnections()) return true;
 
@@ -141,6 +374,7 @@ void ContactManager::GetCustomPublishers(Collision *_collision1,
                      Collision *_collision2, const bool _getOnlyConnected,
                      std::vector<ContactPublisher*> &_publishers)
 {
+  ContactManagerPrivate *data = contactManagerData(this);
   boost::recursive_mutex::scoped_lock lock(*this->customMutex);
   boost::unordered_map<std::string, ContactPublisher *>::iterator iter;
   for (iter = this->customContactPublishers.begin();
@@ -163,6 +397,7 @@ void ContactManager::GetCustomPublishers(Collision *_collision1,
         }
         it = iter->second->collisionNames.erase(it);
         iter->second->collisions.insert(col);
+        data->filtersDirty = true;
       }
     }
 
@@ -198,30 +433,64 @@ Contact *ContactManager::NewContact(Collision *_collision1,
   // This is a signal to the Physics engine that it can skip the extra
   // processing necessary to get back contact information.
 
+  // Custom publishers of each collision. They come from the filter table,
+  // unless the filters changed since the last ResetCount.
+  const std::vector<ContactPublisher *> *publishers1 = nullptr;
+  const std::vector<ContactPublisher *> *publishers2 = nullptr;
   std::vector<ContactPublisher *> publishers;
-  bool getOnlyConnected = false;
-  // TODO check: getOnlyConnected set to false to keep same behaviour as before.
-  // But should we not only add publishers which are connected, as is done
-  // for this->contactPub->HasConnections() condition?
-  this->GetCustomPublishers(_collision1, _collision2,
-                            getOnlyConnected, publishers);
-
-  if (this->NeverDropContacts() ||
-      this->contactPub->HasConnections() ||
-      !publishers.empty())
+  bool connected;
+
+  ContactManagerPrivate *data = contactManagerData(this);
+  if (data->filtersDirty)
   {
-    // Get or create a contact feedback object.
-    if (this->contactIndex < this->contacts.size())
-      result = this->contacts[this->contactIndex++];
-    else
+    bool getOnlyConnected = false;
+    // TODO check: getOnlyConnected set to false to keep same behaviour as
+    // before. But should we not only add publishers which are connected, as
+    // is done for this->contactPub->HasConnections() condition?
+    this->GetCustomPublishers(_collision1, _collision2,
+                              getOnlyConnected, publishers);
+    if (!publishers.empty())
+      publishers1 = &publishers;
+    connected = this->contactPub->HasConnections();
+  }
+  else
+  {
+    auto iter = data->filterTable.find(_collision1);
+    if (iter != data->filterTable.end())
+      publishers1 = &iter->second;
+
+    iter = data->filterTable.find(_collision2);
+    if (iter != data->filterTable.end() && _collision2 != _collision1)
+      publishers2 = &iter->second;
+    connected = data->contactPubConnected;
+  }
+
+  if (this->NeverDropContacts() || connected || publishers1 || publishers2)
+  {
+    result = this->AllocateContact();
+    unsigned int index = this->contactIndex - 1;
+
+    if (publishers1)
     {
-      result = new Contact();
-      this->contacts.push_back(result);
-      this->contactIndex = this->contacts.size();
+      for (auto const &pub : *publishers1)
+      {
+        pub->contacts.push_back(result);
+        data->contactIndices[pub].push_back(index);
+      }
     }
-    for (unsigned int i = 0; i < publishers.size(); ++i)
+
+    // A publisher that monitors both collisions gets the contact once
+    if (publishers2)
     {
-      publishers[i]->contacts.push_back(result);
+      for (auto const &pub : *publishers2)
+      {
+        if (!publishers1 || std::find(publishers1->begin(),
+              publishers1->end(), pub) == publishers1->end())
+        {
+          pub->contacts.push_back(result);
+          data->contactIndices[pub].push_back(index);
+        }
+      }
     }
   }
 
@@ -262,21 +531,100 @@ const std::vector<Contact*> &ContactManager::GetContacts() const
 void ContactManager::ResetCount()
 {
   this->contactIndex = 0;
+
+  ContactManagerPrivate *data = contactManagerData(this);
+  data->contactPubConnected =
+    this->contactPub && this->contactPub->HasConnections();
+
+  if (data->filtersDirty || data->filterNamesPending)
+    this->RebuildFilters();
+}
+
+/////////////////////////////////////////////////
+Contact *ContactManager::AllocateContact()
+{
+  if (this->contactIndex >= this->contacts.size())
+  {
+    // Grow the pool geometrically, so contacts are allocated in a few
+    // large blocks instead of one at a time.
+    ContactManagerPrivate *data = contactManagerData(this);
+    size_t count = std::max(kContactPoolChunk, data->contactPool.size());
+    for (size_t i = 0; i < count; ++i)
+    {
+      data->contactPool.emplace_back();
+      this->contacts.push_back(&data->contactPool.back());
+    }
+  }
+
+  return this->contacts[this->contactIndex++];
+}
+
+/////////////////////////////////////////////////
+void ContactManager::RebuildFilters()
+{
+  ContactManagerPrivate *data = contactManagerData(this);
+  boost::recursive_mutex::scoped_lock lock(*this->customMutex);
+
+  // A model can simply be loaded later, so convert the collision names
+  // that can now be found.
+  for (auto &iter : this->customContactPublishers)
+  {
+    std::vector<std::string> &names = iter.second->collisionNames;
+    for (auto it = names.begin(); it != names.end();)
+    {
+      Collision *col = boost::dynamic_pointer_cast<Collision>(
+          this->world->BaseByName(*it)).get();
+      if (!col)
+      {
+        ++it;
+        continue;
+      }
+      it = names.erase(it);
+      iter.second->collisions.insert(col);
+      data->filtersDirty = true;
+    }
+  }
+
+  if (!data->filtersDirty)
+    return;
+
+  data->filterTable.clear();
+  data->filterNamesPending = false;
+  for (auto &iter : this->customContactPublishers)
+  {
+    for (auto const &col : iter.second->collisions)
+      data->filterTable[col].push_back(iter.second);
+
+    if (!iter.second->collisionNames.empty())
+      data->filterNamesPending = true;
+  }
+
+  for (auto &removed : data->removedPublishers)
+  {
+    data->contactIndices.erase(removed);
+    delete removed;
+  }
+  data->removedPublishers.clear();
+
+  data->filtersDirty = false;
 }
 
 /////////////////////////////////////////////////
 void ContactManager::Clear()
 {
   // Delete all the contacts.
-  for (unsigned int i = 0; i < this->contacts.size(); ++i)
-    delete this->contacts[i];
-
+  ContactManagerPrivate *data = contactManagerData(this);
   this->contacts.clear();
+  data->contactPool.clear();
 
   boost::unordered_map<std::string, ContactPublisher *>::iterator iter;
   for (iter = this->customContactPublishers.begin();
       iter != this->customContactPublishers.end(); ++iter)
+  {
     iter->second->contacts.clear();
+  }
+  for (auto &indices : data->contactIndices)
+    indices.second.clear();
 
   // Reset the contact count to zero.
   this->contactIndex = 0;
@@ -285,9 +633,13 @@ void ContactManager::Clear()
 /////////////////////////////////////////////////
 void ContactManager::PublishContacts()
 {
-//  if (this->contacts.size() == 0)
-//    return;
+  this->SnapshotContacts();
+  this->PublishSnapshot();
+}
 
+/////////////////////////////////////////////////
+void ContactManager::SnapshotContacts()
+{
   if (!this->contactPub)
   {
     gzerr << "ContactManager has not been initialized. "
@@ -295,43 +647,260 @@ void ContactManager::PublishContacts()
     return;
   }
 
+  ContactManagerPrivate *data = contactManagerData(this);
+
+  ContactSnapshot snapshot;
+  {
+    std::lock_guard<std::mutex> lock(data->snapshotMutex);
+    if (!data->spare.empty())
+    {
+      snapshot = std::move(data->spare.back());
+      data->spare.pop_back();
+    }
+  }
+
   // publish to default topic, ~/physics/contacts
-  if (!transport::getMinimalComms())
+  snapshot.publishDefault =
+    !transport::getMinimalComms() && data->contactPubConnected;
+  snapshot.time = this->world->SimTime();
+
+  // publish to other custom topics that have receivers
+  bool filtered = false;
   {
-    msgs::Contacts msg;
-    for (unsigned int i = 0; i < this->contactIndex; ++i)
+    boost::recursive_mutex::scoped_lock lock(*this->customMutex);
+    if (snapshot.filters.size() < this->customContactPublishers.size())
+      snapshot.filters.resize(this->customContactPublishers.size());
+
+    if (!snapshot.publishDefault)
+      data->recordUsed.assign(this->contactIndex, false);
+
+    snapshot.filterCount = 0;
+    for (auto &iter : this->customContactPublishers)
     {
-      if (this->contacts[i]->count == 0)
-        continue;
+      ContactPublisher *contactPublisher = iter.second;
+      if (data->listeners.count(iter.first) > 0 ||
+          (contactPublisher->publisher &&
+           contactPublisher->publisher->HasConnections()))
+      {
+        auto &filter = snapshot.filters[snapshot.filterCount++];
+        filter.first = iter.first;
+        filter.second.swap(data->contactIndices[contactPublisher]);
+        filtered = true;
+
+        if (!snapshot.publishDefault)
+        {
+          for (auto const &index : filter.second)
+          {
+            if (index < this->contactIndex)
+              data->recordUsed[index] = true;
+          }
+        }
+      }
 
-      msgs::Contact *contactMsg = msg.add_contact();
-      this->contacts[i]->FillMsg(*contactMsg);
+      contactPublisher->contacts.clear();
+      auto indices = data->contactIndices.find(contactPublisher);
+      if (indices != data->contactIndices.end())
+        indices->second.clear();
     }
+  }
 
-    msgs::Set(msg.mutable_time(), this->world->SimTime());
-    this->contactPub->Publish(msg);
+  // Nobody receives the contacts of this step
+  if (!snapshot.publishDefault && !filtered)
+  {
+    std::lock_guard<std::mutex> lock(data->snapshotMutex);
+    if (data->spare.size() < kMaxContactSnapshots)
+      data->spare.push_back(std::move(snapshot));
+    return;
   }
 
-  // publish to other custom topics
-  boost::recursive_mutex::scoped_lock lock(*this->customMutex);
-  boost::unordered_map<std::string, ContactPublisher *>::iterator iter;
-  for (iter = this->customContactPublishers.begin();
-      iter != this->customContactPublishers.end(); ++iter)
+  // Copy the contacts of this step. Record i is contacts[i]. Only the
+  // contacts of the filters are copied when the default topic has no
+  // subscribers.
+  if (snapshot.records.size() < this->contactIndex)
+    snapshot.records.resize(this->contactIndex);
+  for (unsigned int i = 0; i < this->contactIndex; ++i)
   {
-    ContactPublisher *contactPublisher = iter->second;
-    msgs::Contacts msg2;
-    for (unsigned int j = 0;
-        j < contactPublisher->contacts.size(); ++j)
+    if (snapshot.publishDefault || data->recordUsed[i])
+      snapshot.records[i].Set(*this->contacts[i]);
+    else
+      snapshot.records[i].depths.clear();
+  }
+  snapshot.recordCount = this->contactIndex;
+
+  std::lock_guard<std::mutex> lock(data->snapshotMutex);
+  if (data->pending.size() < kMaxContactSnapshots)
+  {
+    data->pending.push_back(std::move(snapshot));
+    return;
+  }
+
+  // The publisher fell behind. Merge the contacts into the last snapshot,
+  // so they are all published, in fewer messages.
+  mergeSnapshot(snapshot, data->pending.back());
+  if (data->spare.size() < kMaxContactSnapshots)
+    data->spare.push_back(std::move(snapshot));
+}
+
+/////////////////////////////////////////////////
+bool ContactManager::PublishSnapshot()
+{
+  ContactManagerPrivate *data = contactManagerData(this);
+  std::lock_guard<std::mutex> publishLock(data->publishMutex);
+
+  bool published = false;
+  while (true)
+  {
+    ContactSnapshot snapshot;
     {
-      if (contactPublisher->contacts[j]->count == 0)
+      std::lock_guard<std::mutex> lock(data->snapshotMutex);
+      if (data->pending.empty())
+        break;
+      snapshot = std::move(data->pending.front());
+      data->pending.pop_front();
+    }
+
+    const std::string &worldName = this->world->Name();
+
+    if (snapshot.publishDefault && this->contactPub)
+    {
+      msgs::Contacts msg;
+      for (size_t i = 0; i < snapshot.recordCount; ++i)
+      {
+        if (snapshot.records[i].depths.empty())
+          continue;
+
+        snapshot.records[i].FillMsg(worldName, *msg.add_contact());
+      }
+
+      msgs::Set(msg.mutable_time(), snapshot.time);
+      this->contactPub->Publish(msg);
+    }
+
+    for (size_t i = 0; i < snapshot.filterCount; ++i)
+    {
+      auto &filter = snapshot.filters[i];
+
+      // Only hand over records with contact points
+      const size_t recordCount = snapshot.recordCount;
+      filter.second.erase(std::remove_if(filter.second.begin(),
+          filter.second.end(), [&](const unsigned int _index)
+          {
+            return _index >= recordCount ||
+                snapshot.records[_index].depths.empty();
+          }), filter.second.end());
+
+      // The publisher can't be removed while publishMutex is held
+      ContactPublisher *contactPublisher = nullptr;
+      {
+        boost::recursive_mutex::scoped_lock lock(*this->customMutex);
+        auto iter = this->customContactPublishers.find(filter.first);
+        if (iter == this->customContactPublishers.end())
+          continue;
+        contactPublisher = iter->second;
+      }
+
+      auto listeners = data->listeners.find(filter.first);
+      if (listeners != data->listeners.end())
+      {
+        ContactRecordSpan span(snapshot.records, filter.second,
+            snapshot.time);
+        for (auto const &listener : listeners->second)
+          listener.second(span);
+      }
+
+      // Subscribers of the topic may be in other processes, so they get a
+      // message
+      transport::PublisherPtr publisher = contactPublisher->publisher;
+      if (!publisher || !publisher->HasConnections())
         continue;
 
-      msgs::Contact *contactMsg = msg2.add_contact();
-      contactPublisher->contacts[j]->FillMsg(*contactMsg);
+      msgs::Contacts msg2;
+      for (auto const &index : filter.second)
+        snapshot.records[index].FillMsg(worldName, *msg2.add_contact());
+      msgs::Set(msg2.mutable_time(), snapshot.time);
+      publisher->Publish(msg2);
     }
-    msgs::Set(msg2.mutable_time(), this->world->SimTime());
-    contactPublisher->publisher->Publish(msg2);
-    contactPublisher->contacts.clear();
+
+    published = true;
+
+    std::lock_guard<std::mutex> lock(data->snapshotMutex);
+    if (data->spare.size() < kMaxContactSnapshots)
+      data->spare.push_back(std::move(snapshot));
+  }
+
+  return published;
+}
+
+/////////////////////////////////////////////////
+ContactRecordSpan::ContactRecordSpan(const std::vector<ContactRecord> &_records,
+    const std::vector<unsigned int> &_indices, const common::Time &_time)
+  : records(_records), indices(_indices), time(_time)
+{
+}
+
+/////////////////////////////////////////////////
+size_t ContactRecordSpan::Size() const
+{
+  return this->indices.size();
+}
+
+/////////////////////////////////////////////////
+const ContactRecord &ContactRecordSpan::operator[](const size_t _index) const
+{
+  return this->records[this->indices[_index]];
+}
+
+/////////////////////////////////////////////////
+const common::Time &ContactRecordSpan::Time() const
+{
+  return this->time;
+}
+
+/////////////////////////////////////////////////
+void ContactRecord::Set(const Contact &_contact)
+{
+  this->collision1 = _contact.collision1->GetScopedName();
+  this->collision2 = _contact.collision2->GetScopedName();
+  this->id1 = _contact.collision1->GetId();
+  this->id2 = _contact.collision2->GetId();
+  this->time = _contact.time;
+
+  this->positions.assign(_contact.positions,
+      _contact.positions + _contact.count);
+  this->normals.assign(_contact.normals, _contact.normals + _contact.count);
+  this->depths.assign(_contact.depths, _contact.depths + _contact.count);
+  this->wrench.assign(_contact.wrench, _contact.wrench + _contact.count);
+}
+
+/////////////////////////////////////////////////
+void ContactRecord::FillMsg(const std::string &_world,
+                            msgs::Contact &_msg) const
+{
+  _msg.set_world(_world);
+  _msg.set_collision1(this->collision1);
+  _msg.set_collision2(this->collision2);
+  msgs::Set(_msg.mutable_time(), this->time);
+
+  for (size_t j = 0; j < this->depths.size(); ++j)
+  {
+    _msg.add_depth(this->depths[j]);
+
+    msgs::Set(_msg.add_position(), this->positions[j]);
+    msgs::Set(_msg.add_normal(), this->normals[j]);
+
+    msgs::JointWrench *jntWrench = _msg.add_wrench();
+    jntWrench->set_body_1_name(this->collision1);
+    jntWrench->set_body_1_id(this->id1);
+    jntWrench->set_body_2_name(this->collision2);
+    jntWrench->set_body_2_id(this->id2);
+
+    msgs::Wrench *wrenchMsg =  jntWrench->mutable_body_1_wrench();
+    msgs::Set(wrenchMsg->mutable_force(), this->wrench[j].body1Force);
+    msgs::Set(wrenchMsg->mutable_torque(), this->wrench[j].body1Torque);
+
+    wrenchMsg =  jntWrench->mutable_body_2_wrench();
+    msgs::Set(wrenchMsg->mutable_force(), this->wrench[j].body2Force);
+    msgs::Set(wrenchMsg->mutable_torque(), this->wrench[j].body2Torque);
   }
 }
 
@@ -375,6 +944,7 @@ std::string ContactManager::CreateFilter(const std::string &_name,
   {
     boost::recursive_mutex::scoped_lock lock(*this->customMutex);
     this->customContactPublishers[name] = contactPublisher;
+    contactManagerData(this)->filtersDirty = true;
   }
 
   return topic;
@@ -419,6 +989,7 @@ std::string ContactManager::CreateFilter(const std::string &_name,
 
     // Let it know about collisions not yet found.
     this->customContactPublishers[name]->collisionNames = collisionNames;
+    contactManagerData(this)->filtersDirty = true;
   }
 
   return topic;
@@ -430,6 +1001,8 @@ void ContactManager::RemoveFilter(const std::string &_name)
   std::string name = _name;
   boost::replace_all(name, "::", "/");
 
+  ContactManagerPrivate *data = contactManagerData(this);
+  std::lock_guard<std::mutex> publishLock(data->publishMutex);
   boost::recursive_mutex::scoped_lock lock(*this->customMutex);
   boost::unordered_map<std::string, ContactPublisher *>::iterator iter
       = this->customContactPublishers.find(name);
@@ -439,9 +1012,56 @@ void ContactManager::RemoveFilter(const std::string &_name)
     contactPublisher->contacts.clear();
     contactPublisher->collisionNames.clear();
     contactPublisher->collisions.clear();
+    data->listeners.erase(name);
     contactPublisher->publisher->Fini();
     contactPublisher->publisher.reset();
     this->customContactPublishers.erase(iter);
+
+    // The filter table may still refer to the publisher during a collision
+    // update, so it is deleted by the next RebuildFilters.
+    data->removedPublishers.push_back(contactPublisher);
+    data->filtersDirty = true;
+  }
+}
+
+/////////////////////////////////////////////////
+int ContactManager::ConnectFilter(const std::string &_name,
+    const std::function<void(const ContactRecordSpan &)> &_listener)
+{
+  std::string name = _name;
+  boost::replace_all(name, "::", "/");
+
+  ContactManagerPrivate *data = contactManagerData(this);
+  std::lock_guard<std::mutex> publishLock(data->publishMutex);
+  boost::recursive_mutex::scoped_lock lock(*this->customMutex);
+  if (this->customContactPublishers.find(name) ==
+      this->customContactPublishers.end())
+  {
+    gzerr << "Contact filter [" << _name << "] not found" << std::endl;
+    return -1;
+  }
+
+  const int id = data->nextListenerId++;
+  data->listeners[name][id] = _listener;
+  return id;
+}
+
+/////////////////////////////////////////////////
+void ContactManager::DisconnectFilter(const std::string &_name,
+    const int _id)
+{
+  std::string name = _name;
+  boost::replace_all(name, "::", "/");
+
+  ContactManagerPrivate *data = contactManagerData(this);
+  std::lock_guard<std::mutex> publishLock(data->publishMutex);
+  boost::recursive_mutex::scoped_lock lock(*this->customMutex);
+  auto iter = data->listeners.find(name);
+  if (iter != data->listeners.end())
+  {
+    iter->second.erase(_id);
+    if (iter->second.empty())
+      data->listeners.erase(iter);
   }
 }
 
@@ -18,6 +18,7 @@
 #ifndef GAZEBO_PHYSICS_CONTACTMANAGER_HH_
 #define GAZEBO_PHYSICS_CONTACTMANAGER_HH_
 
+#include <functional>
 #include <vector>
 #include <string>
 #include <map>
@@ -37,6 +38,8 @@ namespace gazebo
 {
   namespace physics
   {
+    class ContactRecordSpan;
+
     /// \brief A custom contact publisher created for each contact filter
     /// in the Contact Manager.
     class GZ_PHYSICS_VISIBLE ContactPublisher
@@ -63,6 +66,87 @@ namespace gazebo
       public: ignition::transport::Node::Publisher publisherIgn;
     };
 
+    /// \internal
+    /// \brief Copy of a contact, taken on the physics thread so the
+    /// contact message can be built while the next step runs.
+    class GZ_PHYSICS_VISIBLE ContactRecord
+    {
+      /// \brief Copy a contact. Only the first _contact.count entries of
+      /// the contact arrays are copied.
+      /// \param[in] _contact Contact to copy.
+      public: void Set(const Contact &_contact);
+
+      /// \brief Populate a contact message.
+      /// \param[in] _world Name of the world.
+      /// \param[out] _msg Contact message.
+      public: void FillMsg(const std::string &_world,
+                           msgs::Contact &_msg) const;
+
+      /// \brief Scoped name of the first collision.
+      public: std::string collision1;
+
+      /// \brief Scoped name of the second collision.
+      public: std::string collision2;
+
+      /// \brief Id of the first collision.
+      public: uint32_t id1 = 0;
+
+      /// \brief Id of the second collision.
+      public: uint32_t id2 = 0;
+
+      /// \brief Time of the contact.
+      public: common::Time time;
+
+      /// \brief Contact positions.
+      public: std::vector<ignition::math::Vector3d> positions;
+
+      /// \brief Contact normals.
+      public: std::vector<ignition::math::Vector3d> normals;
+
+      /// \brief Contact depths.
+      public: std::vector<double> depths;
+
+      /// \brief Contact wrenches.
+      public: std::vector<JointWrench> wrench;
+    };
+
+    /// \brief The contacts of a contact filter in one step, handed to the
+    /// in-process listeners of the filter instead of a message. It refers
+    /// to records owned by the ContactManager, so it is only valid during
+    /// the call to the listener.
+    class GZ_PHYSICS_VISIBLE ContactRecordSpan
+    {
+      /// \brief Constructor.
+      /// \param[in] _records Contact records of the step.
+      /// \param[in] _indices Indices of the records of the filter.
+      /// \param[in] _time Simulation time of the step.
+      public: ContactRecordSpan(const std::vector<ContactRecord> &_records,
+                  const std::vector<unsigned int> &_indices,
+                  const common::Time &_time);
+
+      /// \brief Get the number of contacts.
+      /// \return Number of contacts.
+      public: size_t Size() const;
+
+      /// \brief Get a contact.
+      /// \param[in] _index Index of the contact, less than Size().
+      /// \return The contact.
+      public: const ContactRecord &operator[](const size_t _index) const;
+
+      /// \brief Get the simulation time of the step.
+      /// \return The time.
+      public: const common::Time &Time() const;
+
+      /// \brief Contact records of the step.
+      private: const std::vector<ContactRecord> &records;
+
+      /// \brief Indices of the records of the filter.
+      private: const std::vector<unsigned int> &indices;
+
+      /// \brief Simulation time of the step.
+      private: const common::Time &time;
+    };
+
     /// \addtogroup gazebo_physics
     /// \{
 
@@ -159,10 +243,27 @@ namespace gazebo
       /// \brief Clear all stored contacts.
       public: void Clear();
 
-      /// \brief Publish all contacts in a msgs::Contacts message.
+      /// \brief Publish all contacts in a msgs::Contacts message. This is
+      /// SnapshotContacts followed by PublishSnapshot.
       public: void PublishContacts();
 
-      /// \brief Set the contact count to zero.
+      /// \brief Copy the contacts of the current step, to be published by
+      /// PublishSnapshot. This does not build any message, and doesn't
+      /// wait for PublishSnapshot. The snapshots are queued until they are
+      /// published. If the queue is full, the contacts are merged into the
+      /// last queued snapshot, so no contact is lost. Nothing is copied
+      /// when the contacts topic has no subscribers and no filter has
+      /// subscribers or listeners.
+      public: void SnapshotContacts();
+
+      /// \brief Publish the snapshots taken by SnapshotContacts, oldest
+      /// first. This may run on a thread other than the physics thread.
+      /// \return True if a snapshot was published.
+      public: bool PublishSnapshot();
+
+      /// \brief Set the contact count to zero. The physics engine calls
+      /// this before each collision update. Filters created or removed
+      /// since the previous call take effect here.
       public: void ResetCount();
 
       /// \brief Create a filter for contacts. A new publisher will be created
@@ -195,6 +296,27 @@ namespace gazebo
       /// param[in] _name Filter name.
       public: void RemoveFilter(const std::string &_name);
 
+      /// \brief Receive the contacts of a filter in process. The listener
+      /// is called with the contacts of every step, from the thread that
+      /// publishes them, without building or parsing a message. The
+      /// filter topic is then only published while it has subscribers,
+      /// such as consumers in other processes.
+      /// The listener must not connect or disconnect listeners.
+      /// \param[in] _name Filter name.
+      /// \param[in] _listener Function called with the contacts.
+      /// \return Id of the listener, -1 if there is no such filter.
+      /// \sa DisconnectFilter
+      public: int ConnectFilter(const std::string &_name,
+                  const std::function<void(const ContactRecordSpan &)>
+                  &_listener);
+
+      /// \brief Stop calling a listener connected with ConnectFilter. The
+      /// listener is not called anymore once this returns. Removing the
+      /// filter disconnects all its listeners.
+      /// \param[in] _name Filter name.
+      /// \param[in] _id Id returned by ConnectFilter.
+      public: void DisconnectFilter(const std::string &_name, const int _id);
+
       /// \brief Get the number of filters in the contact manager.
       /// return Number of filters
       public: unsigned int GetFilterCount();
@@ -215,6 +337,24 @@ namespace gazebo
                        Collision *_collision2, const bool _getOnlyConnected,
                        std::vector<ContactPublisher*> &_publishers);
 
+      /// \brief Same as SubscribersConnected, but searches the custom
+      /// publishers instead of the filter table. Used while the filters
+      /// are being changed.
+      /// \param[in] _collision1 the first collision object
+      /// \param[in] _collision2 the second collision object
+      /// \return true if any subscribers are connected for this pair
+      private: bool SubscribersConnectedLocked(Collision *_collision1,
+                                               Collision *_collision2) const;
+
+      /// \brief Rebuild the filter table from the custom publishers, and
+      /// delete the publishers of removed filters. Must not be called
+      /// while a collision update is in progress.
+      private: void RebuildFilters();
+
+      /// \brief Get a contact from the contact pool.
+      /// \return A contact whose address is stable until Clear().
+      private: Contact *AllocateContact();
+
       private: std::vector<Contact*> contacts;
 
       private: unsigned int contactIndex;
@@ -24,6 +24,19 @@ class ContactManagerTest : public ServerFixture
 {
 };
 
+/// \brief Contact messages received by OnContacts.
+std::vector<msgs::Contacts> g_contacts;
+
+/// \brief Protects g_contacts.
+std::mutex g_contactsMutex;
+
+/////////////////////////////////////////////////
+void OnContacts(ConstContactsPtr &_msg)
+{
+  std::lock_guard<std::mutex> lock(g_contactsMutex);
+  g_contacts.push_back(*_msg);
+}
+
 /////////////////////////////////////////////////
 TEST_F(ContactManagerTest, CreateFilter)
 {
@@ -194,6 +207,243 @@ TEST_F(ContactManagerTest, NeverDropContacts)
   }
 }
 
+/////////////////////////////////////////////////
+TEST_F(ContactManagerTest, FilterTable)
+{
+  Load("test/worlds/box.world", true);
+
+  physics::WorldPtr world = physics::get_world("default");
+  ASSERT_TRUE(world != nullptr);
+
+  physics::PhysicsEnginePtr physics = world->Physics();
+  ASSERT_TRUE(physics != nullptr);
+
+  physics::ContactManager *manager = physics->GetContactManager();
+  ASSERT_TRUE(manager != nullptr);
+
+  physics::CollisionPtr box = boost::dynamic_pointer_cast<physics::Collision>(
+      world->BaseByName("box::link::collision"));
+  physics::CollisionPtr ground =
+    boost::dynamic_pointer_cast<physics::Collision>(
+      world->BaseByName("ground_plane::link::collision"));
+  ASSERT_TRUE(box != nullptr);
+  ASSERT_TRUE(ground != nullptr);
+
+  world->Step(1);
+  EXPECT_EQ(manager->GetContactCount(), 0u);
+  EXPECT_FALSE(manager->SubscribersConnected(box.get(), ground.get()));
+
+  // The filter is found before and after the next collision update
+  manager->CreateFilter("box_filter", "box::link::collision");
+  EXPECT_TRUE(manager->SubscribersConnected(box.get(), ground.get()));
+  world->Step(1);
+  EXPECT_TRUE(manager->SubscribersConnected(box.get(), ground.get()));
+  EXPECT_TRUE(manager->SubscribersConnected(ground.get(), box.get()));
+  EXPECT_FALSE(manager->SubscribersConnected(ground.get(), ground.get()));
+  unsigned int numContacts = manager->GetContactCount();
+  EXPECT_GT(numContacts, 0u);
+
+  // Contacts are reused from the pool across steps
+  const std::vector<physics::Contact *> contacts = manager->GetContacts();
+  world->Step(1);
+  ASSERT_EQ(manager->GetContactCount(), numContacts);
+  for (unsigned int i = 0; i < numContacts; ++i)
+    EXPECT_EQ(contacts[i], manager->GetContact(i));
+
+  // Removing the filter stops the contacts
+  manager->RemoveFilter("box_filter");
+  EXPECT_FALSE(manager->SubscribersConnected(box.get(), ground.get()));
+  world->Step(1);
+  EXPECT_FALSE(manager->SubscribersConnected(box.get(), ground.get()));
+  EXPECT_EQ(manager->GetContactCount(), 0u);
+}
+
+/////////////////////////////////////////////////
+TEST_F(ContactManagerTest, PublishFilteredContacts)
+{
+  Load("test/worlds/box.world", true);
+
+  physics::WorldPtr world = physics::get_world("default");
+  ASSERT_TRUE(world != nullptr);
+
+  physics::ContactManager *manager =
+    world->Physics()->GetContactManager();
+  ASSERT_TRUE(manager != nullptr);
+
+  std::string topic = manager->CreateFilter("box_filter",
+      "box::link::collision");
+
+  // The contact messages are built and published by the world's publish
+  // thread, after the step.
+  transport::SubscriberPtr sub = this->node->Subscribe(topic, OnContacts);
+
+  world->Step(10);
+
+  int sleep = 0;
+  while (sleep++ < 50)
+  {
+    {
+      std::lock_guard<std::mutex> lock(g_contactsMutex);
+      if (!g_contacts.empty() && g_contacts.back().contact_size() > 0)
+        break;
+    }
+    common::Time::MSleep(100);
+  }
+
+  std::lock_guard<std::mutex> lock(g_contactsMutex);
+  ASSERT_FALSE(g_contacts.empty());
+  const msgs::Contacts &msg = g_contacts.back();
+  ASSERT_GT(msg.contact_size(), 0);
+  for (int i = 0; i < msg.contact_size(); ++i)
+  {
+    const msgs::Contact &contact = msg.contact(i);
+    EXPECT_EQ(contact.world(), "default");
+    EXPECT_TRUE(contact.collision1() == "box::link::collision" ||
+                contact.collision2() == "box::link::collision");
+    EXPECT_GT(contact.depth_size(), 0);
+    EXPECT_EQ(contact.depth_size(), contact.wrench_size());
+  }
+}
+
+/////////////////////////////////////////////////
+TEST_F(ContactManagerTest, ConnectFilter)
+{
+  Load("test/worlds/box.world", true);
+
+  physics::WorldPtr world = physics::get_world("default");
+  ASSERT_TRUE(world != nullptr);
+
+  physics::ContactManager *manager =
+    world->Physics()->GetContactManager();
+  ASSERT_TRUE(manager != nullptr);
+
+  EXPECT_EQ(manager->ConnectFilter("box_filter",
+      [](const physics::ContactRecordSpan &) {}), -1);
+
+  manager->CreateFilter("box_filter", "box::link::collision");
+
+  std::mutex mutex;
+  size_t calls = 0;
+  std::vector<std::string> collisions;
+  std::vector<size_t> depths;
+  common::Time time;
+  const int id = manager->ConnectFilter("box_filter",
+      [&](const physics::ContactRecordSpan &_contacts)
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        ++calls;
+        time = _contacts.Time();
+        collisions.clear();
+        depths.clear();
+        for (size_t i = 0; i < _contacts.Size(); ++i)
+        {
+          collisions.push_back(_contacts[i].collision1);
+          collisions.push_back(_contacts[i].collision2);
+          depths.push_back(_contacts[i].depths.size());
+        }
+      });
+  EXPECT_GE(id, 0);
+
+  world->Step(10);
+
+  int sleep = 0;
+  while (sleep++ < 50)
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (!depths.empty())
+        break;
+    }
+    common::Time::MSleep(100);
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    EXPECT_GT(calls, 0u);
+    EXPECT_GT(time, common::Time::Zero);
+    ASSERT_FALSE(depths.empty());
+    for (size_t i = 0; i < depths.size(); ++i)
+    {
+      EXPECT_GT(depths[i], 0u);
+      EXPECT_TRUE(collisions[2 * i] == "box::link::collision" ||
+                  collisions[2 * i + 1] == "box::link::collision");
+    }
+  }
+
+  // A disconnected listener is not called anymore
+  manager->DisconnectFilter("box_filter", id);
+  size_t lastCalls;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    lastCalls = calls;
+  }
+  world->Step(10);
+  common::Time::MSleep(500);
+  std::lock_guard<std::mutex> lock(mutex);
+  EXPECT_EQ(calls, lastCalls);
+}
+
+/////////////////////////////////////////////////
+TEST_F(ContactManagerTest, QueuedSnapshots)
+{
+  Load("test/worlds/box.world", true);
+
+  physics::WorldPtr world = physics::get_world("default");
+  ASSERT_TRUE(world != nullptr);
+
+  physics::ContactManager *manager =
+    world->Physics()->GetContactManager();
+  ASSERT_TRUE(manager != nullptr);
+
+  transport::SubscriberPtr sub =
+    this->node->Subscribe("~/physics/contacts", OnContacts);
+
+  // Step until the default topic is known to have a subscriber
+  int sleep = 0;
+  while (sleep++ < 50)
+  {
+    world->Step(1);
+    common::Time::MSleep(100);
+    std::lock_guard<std::mutex> lock(g_contactsMutex);
+    if (!g_contacts.empty() && g_contacts.back().contact_size() > 0)
+      break;
+  }
+
+  const int contactCount = manager->GetContactCount();
+  ASSERT_GT(contactCount, 0);
+  {
+    std::lock_guard<std::mutex> lock(g_contactsMutex);
+    g_contacts.clear();
+  }
+
+  // More snapshots than the queue holds. The ones that don't fit are
+  // merged, so no contact is lost.
+  const int snapshots = 40;
+  for (int i = 0; i < snapshots; ++i)
+    manager->SnapshotContacts();
+  manager->PublishSnapshot();
+  EXPECT_FALSE(manager->PublishSnapshot());
+
+  int received = 0;
+  sleep = 0;
+  while (sleep++ < 50)
+  {
+    {
+      std::lock_guard<std::mutex> lock(g_contactsMutex);
+      received = 0;
+      for (auto const &msg : g_contacts)
+        received += msg.contact_size();
+      if (received >= snapshots * contactCount)
+        break;
+    }
+    common::Time::MSleep(100);
+  }
+
+  std::lock_guard<std::mutex> lock(g_contactsMutex);
+  EXPECT_EQ(received, snapshots * contactCount);
+  EXPECT_LE(g_contacts.size(), static_cast<size_t>(snapshots));
+}
+
 int main(int argc, char **argv)
 {
   ::testing::InitGoogleTest(&argc, argv);
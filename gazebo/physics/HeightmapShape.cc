@@ -15,8 +15,17 @@
  *
 */
 #include <algorithm>
+#include <atomic>
 #include <cmath>
+#include <cstdint>
+#include <functional>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
 #include <string>
+#include <boost/filesystem.hpp>
 #include <ignition/math/Helpers.hh>
 #include <gazebo/gazebo_config.h>
 
@@ -24,7 +33,9 @@
 #include "gazebo/common/Console.hh"
 #include "gazebo/common/Image.hh"
 #include "gazebo/common/CommonIface.hh"
+#include "gazebo/common/HeightmapTiles.hh"
 #include "gazebo/common/SphericalCoordinates.hh"
+#include "gazebo/common/SystemPaths.hh"
 #include "gazebo/physics/HeightmapShape.hh"
 #include "gazebo/physics/World.hh"
 #include "gazebo/transport/transport.hh"
@@ -32,6 +43,74 @@
 using namespace gazebo;
 using namespace physics;
 
+namespace gazebo
+{
+  namespace physics
+  {
+    /// \internal
+    /// \brief Private data for the HeightmapShape class.
+    class HeightmapShapePrivate
+    {
+      /// \brief True if the physics engine can look the heights up in
+      /// tiles, so that a terrain too large for a lookup table can be
+      /// loaded into tiles. When false, the heights are always filled.
+      public: bool tilesSupported = false;
+
+      /// \brief Heights of a tiled terrain. The heights lookup table is
+      /// empty when these are valid.
+      public: common::HeightmapTiles tiles;
+    };
+  }
+}
+
+// TODO added here for ABI compatibility
+// move to a private data pointer in HeightmapShape when merging forward.
+static std::map<const HeightmapShape *,
+    std::unique_ptr<HeightmapShapePrivate>> gHeightmapShapeData;
+
+/// \brief Mutex that protects gHeightmapShapeData.
+static std::mutex gHeightmapShapeDataMutex;
+
+/// \brief Incremented, with gHeightmapShapeDataMutex held, whenever an
+/// entry is added to or removed from gHeightmapShapeData.
+static std::atomic<uint64_t> gHeightmapShapeDataVersion(0);
+
+/// \brief Number of vertices above which the heights of a terrain are
+/// looked up in tiles. The default is 256 MB of float heights, a little
+/// less than a 4097x4097 heightmap sampled twice.
+static std::atomic<uint64_t> gTileThreshold(uint64_t(1) << 26);
+
+/////////////////////////////////////////////////
+/// \brief Get the private data of a heightmap shape. The heights of a
+/// tiled terrain are looked up through it for every vertex, so each
+/// thread keeps the result of its last lookup until a heightmap shape is
+/// created or destroyed.
+/// \param[in] _shape The heightmap shape.
+/// \return The private data, which lives as long as the shape.
+static HeightmapShapePrivate *heightmapShapeData(
+    const HeightmapShape *_shape)
+{
+  thread_local const HeightmapShape *cachedShape = nullptr;
+  thread_local HeightmapShapePrivate *cachedData = nullptr;
+  thread_local uint64_t cachedVersion = 0;
+
+  if (_shape == cachedShape &&
+      gHeightmapShapeDataVersion.load(std::memory_order_acquire) ==
+      cachedVersion)
+  {
+    return cachedData;
+  }
+
+  std::lock_guard<std::mutex> lock(gHeightmapShapeDataMutex);
+  auto iter = gHeightmapShapeData.find(_shape);
+  GZ_ASSERT(iter != gHeightmapShapeData.end(),
+      "HeightmapShape has no private data");
+  cachedShape = _shape;
+  cachedData = iter->second.get();
+  cachedVersion =
+      gHeightmapShapeDataVersion.load(std::memory_order_relaxed);
+  return cachedData;
+}
 
 //////////////////////////////////////////////////
 HeightmapShape::HeightmapShape(CollisionPtr _parent)
@@ -43,6 +122,10 @@ HeightmapShape::HeightmapShape(CollisionPtr _parent)
       "Height field needs to be double or float");
   this->vertSize = 0;
   this->AddType(Base::HEIGHTMAP_SHAPE);
+
+  std::lock_guard<std::mutex> lock(gHeightmapShapeDataMutex);
+  gHeightmapShapeData[this].reset(new HeightmapShapePrivate);
+  ++gHeightmapShapeDataVersion;
 }
 
 //////////////////////////////////////////////////
@@ -53,6 +136,10 @@ HeightmapShape::~HeightmapShape()
   if (this->node)
     this->node->Fini();
   this->node.reset();
+
+  std::lock_guard<std::mutex> lock(gHeightmapShapeDataMutex);
+  gHeightmapShapeData.erase(this);
+  ++gHeightmapShapeDataVersion;
 }
 
 //////////////////////////////////////////////////
@@ -245,8 +332,86 @@ void HeightmapShape::Init()
   else
     this->scale.Z() = fabs(terrainSize.Z()) / heightmapSizeZ;
 
-  // Construct the heightmap lookup table
-  this->FillHeightfield(this->heights);
+  // Construct the heightmap lookup table, unless the terrain is too large
+  // for it and can be tiled instead.
+  HeightmapShapePrivate *data = heightmapShapeData(this);
+  data->tiles.Unload();
+  this->heights.clear();
+  const uint64_t vertexCount =
+      static_cast<uint64_t>(this->vertSize) * this->vertSize;
+  if (!data->tilesSupported || vertexCount <= gTileThreshold ||
+      !this->LoadTiles())
+  {
+    this->FillHeightfield(this->heights);
+  }
+}
+
+//////////////////////////////////////////////////
+bool HeightmapShape::LoadTiles()
+{
+  const std::string filename =
+      common::find_file(this->sdf->Get<std::string>("uri"));
+
+  // The key changes whenever the heights would, so that stale tiles are
+  // rebuilt.
+  boost::system::error_code ec;
+  std::ostringstream key;
+  key << std::setprecision(17) << filename
+      << "|" << boost::filesystem::file_size(filename, ec)
+      << "|" << boost::filesystem::last_write_time(filename, ec)
+      << "|" << this->heightmapData->GetWidth()
+      << "|" << this->Size().Z() << "|" << this->scale.Z();
+
+  std::ostringstream name;
+  name << boost::filesystem::path(filename).stem().string() << "-"
+       << std::hex << std::hash<std::string>()(key.str()) << ".tiles";
+  boost::filesystem::path path =
+      boost::filesystem::path(common::SystemPaths::Instance()->GetLogPath()) /
+      "heightmap_tiles" / name.str();
+
+  if (!heightmapShapeData(this)->tiles.Load(*this->heightmapData,
+        path.string(), key.str(), this->subSampling, this->Size(),
+        this->scale, this->flipY))
+  {
+    gzwarn << "Unable to tile heightmap[" << this->GetURI() << "], "
+           << "filling the heights of every vertex instead\n";
+    return false;
+  }
+
+  gzmsg << "Heightmap[" << this->GetURI() << "] is sampled from tiles in ["
+        << path.string() << "]\n";
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool HeightmapShape::Tiled() const
+{
+  return heightmapShapeData(this)->tiles.Valid();
+}
+
+//////////////////////////////////////////////////
+void HeightmapShape::SetTileThreshold(const uint64_t _vertices)
+{
+  gTileThreshold = _vertices;
+}
+
+//////////////////////////////////////////////////
+uint64_t HeightmapShape::TileThreshold()
+{
+  return gTileThreshold;
+}
+
+//////////////////////////////////////////////////
+void HeightmapShape::SetTilesSupported(const bool _supported)
+{
+  heightmapShapeData(this)->tilesSupported = _supported;
+}
+
+//////////////////////////////////////////////////
+const common::HeightmapTiles *HeightmapShape::Tiles() const
+{
+  const HeightmapShapePrivate *data = heightmapShapeData(this);
+  return data->tiles.Valid() ? &data->tiles : nullptr;
 }
 
 //////////////////////////////////////////////////
@@ -294,6 +459,29 @@ void HeightmapShape::FillMsg(msgs::Geometry &_msg)
 //////////////////////////////////////////////////
 void HeightmapShape::FillHeights(msgs::Geometry &_msg) const
 {
+  // A tiled terrain has too many vertices for a message, so only the
+  // vertices at the samples of the heightmap data are sent, as a heightmap
+  // that is not subsampled.
+  const common::HeightmapTiles *tiles = this->Tiles();
+  if (tiles)
+  {
+    const unsigned int s = static_cast<unsigned int>(this->subSampling);
+    const unsigned int side = (this->vertSize - 1) / s + 1;
+    msgs::HeightmapGeom *heightmap = _msg.mutable_heightmap();
+    heightmap->set_width(side);
+    heightmap->set_height(side);
+    heightmap->set_sampling(1);
+
+    auto *heights = heightmap->mutable_heights();
+    heights->Reserve(side * side);
+    for (unsigned int y = 0; y < side; ++y)
+    {
+      for (unsigned int x = 0; x < side; ++x)
+        heights->Add(tiles->Height(x * s, this->vertSize - 1 - y * s));
+    }
+    return;
+  }
+
   for (unsigned int y = 0; y < this->vertSize; ++y)
   {
     for (unsigned int x = 0; x < this->vertSize; ++x)
@@ -319,6 +507,19 @@ ignition::math::Vector2i HeightmapShape::VertexCount() const
 /////////////////////////////////////////////////
 HeightmapShape::HeightType HeightmapShape::GetHeight(int _x, int _y) const
 {
+  // Only a tiled terrain has no lookup table
+  if (this->heights.empty())
+  {
+    const common::HeightmapTiles *tiles = this->Tiles();
+    if (!tiles || _x < 0 || _y < 0 ||
+        _x >= static_cast<int>(this->vertSize) ||
+        _y >= static_cast<int>(this->vertSize))
+    {
+      return 0.0;
+    }
+    return tiles->Height(_x, _y);
+  }
+
   int index =  _y * this->vertSize + _x;
   if (_x < 0 || _y < 0 || index >= static_cast<int>(this->heights.size()))
     return 0.0;
@@ -326,9 +527,43 @@ HeightmapShape::HeightType HeightmapShape::GetHeight(int _x, int _y) const
   return this->heights[index];
 }
 
+/////////////////////////////////////////////////
+ignition::math::Vector3d HeightmapShape::Normal(int _x, int _y) const
+{
+  const int last = static_cast<int>(this->vertSize) - 1;
+  if (last < 1)
+    return ignition::math::Vector3d::UnitZ;
+
+  // Central differences, or one sided ones on the border. Columns are
+  // along X and rows along -Y, as in the heightfields of the physics
+  // engines.
+  const int x = ignition::math::clamp(_x, 0, last);
+  const int y = ignition::math::clamp(_y, 0, last);
+  const int x0 = std::max(x - 1, 0);
+  const int x1 = std::min(x + 1, last);
+  const int y0 = std::max(y - 1, 0);
+  const int y1 = std::min(y + 1, last);
+
+  const ignition::math::Vector3d size = this->Size();
+  const double dx = size.X() / last;
+  const double dy = size.Y() / last;
+
+  const double dzdx = (this->GetHeight(x1, y) - this->GetHeight(x0, y)) /
+      ((x1 - x0) * dx);
+  const double dzdy = -(this->GetHeight(x, y1) - this->GetHeight(x, y0)) /
+      ((y1 - y0) * dy);
+
+  return ignition::math::Vector3d(-dzdx, -dzdy, 1.0).Normalize();
+}
+
 /////////////////////////////////////////////////
 HeightmapShape::HeightType HeightmapShape::GetMaxHeight() const
 {
+  const common::HeightmapTiles *tiles =
+      this->heights.empty() ? this->Tiles() : nullptr;
+  if (tiles)
+    return tiles->MaxHeight();
+
   HeightType max = -std::numeric_limits<HeightType>::max();
   for (unsigned int i = 0; i < this->heights.size(); ++i)
   {
@@ -342,6 +577,11 @@ HeightmapShape::HeightType HeightmapShape::GetMaxHeight() const
 /////////////////////////////////////////////////
 HeightmapShape::HeightType HeightmapShape::GetMinHeight() const
 {
+  const common::HeightmapTiles *tiles =
+      this->heights.empty() ? this->Tiles() : nullptr;
+  if (tiles)
+    return tiles->MinHeight();
+
   HeightType min = std::numeric_limits<HeightType>::max();
   for (unsigned int i = 0; i < this->heights.size(); ++i)
   {
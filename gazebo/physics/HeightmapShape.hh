@@ -17,6 +17,7 @@
 #ifndef GAZEBO_PHYSICS_HEIGHTMAPSHAPE_HH_
 #define GAZEBO_PHYSICS_HEIGHTMAPSHAPE_HH_
 
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <ignition/transport/Node.hh>
@@ -33,6 +34,11 @@
 
 namespace gazebo
 {
+  namespace common
+  {
+    class HeightmapTiles;
+  }
+
   namespace physics
   {
     /// \addtogroup gazebo_physics
@@ -94,6 +100,33 @@ namespace gazebo
       /// \param[in] _y Y position.
       public: void SetHeight(int _x, int _y, float _value);
 
+      /// \brief Get the normal of the terrain at a vertex, from the heights
+      /// of the vertices around it. Columns of vertices are along X, and
+      /// rows along -Y.
+      /// \param[in] _x X position.
+      /// \param[in] _y Y position.
+      /// \return The unit normal, in the frame of the heightmap.
+      public: ignition::math::Vector3d Normal(int _x, int _y) const;
+
+      /// \brief Get whether the heights are looked up in memory mapped
+      /// tiles, instead of a lookup table of every vertex.
+      /// \return True if the heights are tiled.
+      /// \sa common::HeightmapTiles
+      public: bool Tiled() const;
+
+      /// \brief Set the number of vertices above which the heights of a
+      /// terrain are looked up in tiles, if the physics engine supports it.
+      /// Applies to the heightmaps initialized afterwards.
+      /// \param[in] _vertices Number of vertices, the square of the number
+      /// of vertices along a side. The default is 2^26.
+      public: static void SetTileThreshold(const uint64_t _vertices);
+
+      /// \brief Get the number of vertices above which the heights of a
+      /// terrain are looked up in tiles.
+      /// \return Number of vertices.
+      /// \sa SetTileThreshold
+      public: static uint64_t TileThreshold();
+
       /// \brief Fill a geometry message with this shape's data. Raw height
       /// data are not packed in this message to minimize packet size.
       /// \param[in] _msg Message to fill.
@@ -140,6 +173,22 @@ namespace gazebo
       /// \param[in] _msg The request message.
       private: void OnRequest(ConstRequestPtr &_msg);
 
+      /// \brief Load the heights into memory mapped tiles, which are cached
+      /// in the gazebo log directory.
+      /// \return True on success.
+      private: bool LoadTiles();
+
+      /// \brief Set whether the physics engine looks the heights up with
+      /// GetHeight or Tiles, so that a terrain too large for a lookup table
+      /// can be loaded into tiles. Must be called before Init.
+      /// \param[in] _supported True if tiles are supported. The default is
+      /// false, which always fills the lookup table.
+      protected: void SetTilesSupported(const bool _supported);
+
+      /// \brief Get the tiles of a tiled terrain.
+      /// \return The tiles, or nullptr if the heights are not tiled.
+      protected: const common::HeightmapTiles *Tiles() const;
+
       /// \brief Fills the heightmap data (float) into the vector
       /// by calling HeightmapData::FillHeightMap with \e heights
       /// \param[in] heights height field to fill with data.
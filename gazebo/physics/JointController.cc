@@ -15,6 +15,7 @@
  *
 */
 
+#include <algorithm>
 #include <boost/algorithm/string.hpp>
 
 #include "gazebo/transport/Node.hh"
@@ -69,21 +70,70 @@ JointController::~JointController()
 /////////////////////////////////////////////////
 void JointController::AddJoint(JointPtr _joint)
 {
-  this->dataPtr->joints[_joint->GetScopedName()] = _joint;
-  this->dataPtr->posPids[_joint->GetScopedName()].Init(
-      1, 0.1, 0.01, 1, -1, 1000, -1000);
-  this->dataPtr->velPids[_joint->GetScopedName()].Init(
-      1, 0.1, 0.01, 1, -1, 1000, -1000);
+  const std::string name = _joint->GetScopedName();
+
+  unsigned int index;
+  auto iter = this->dataPtr->indices.find(name);
+  if (iter != this->dataPtr->indices.end())
+  {
+    // Replace the joint, and keep its targets
+    index = iter->second;
+    this->dataPtr->jointList[index] = _joint;
+  }
+  else
+  {
+    index = this->dataPtr->jointList.size();
+    this->dataPtr->indices[name] = index;
+    this->dataPtr->nameIndices.emplace(_joint->GetName(), index);
+    this->dataPtr->jointList.push_back(_joint);
+    this->dataPtr->posPids.emplace_back();
+    this->dataPtr->velPids.emplace_back();
+    this->dataPtr->forces.push_back(0);
+    this->dataPtr->positions.push_back(0);
+    this->dataPtr->velocities.push_back(0);
+    this->dataPtr->commands.push_back(0);
+  }
+
+  this->dataPtr->joints[name] = _joint;
+  this->dataPtr->posPids[index].Init(1, 0.1, 0.01, 1, -1, 1000, -1000);
+  this->dataPtr->velPids[index].Init(1, 0.1, 0.01, 1, -1, 1000, -1000);
 }
 
 /////////////////////////////////////////////////
 void JointController::RemoveJoint(Joint *_joint)
 {
-  if (_joint)
+  if (!_joint)
+    return;
+
+  const std::string name = _joint->GetScopedName();
+  auto iter = this->dataPtr->indices.find(name);
+  if (iter == this->dataPtr->indices.end())
+    return;
+
+  const unsigned int index = iter->second;
+  this->dataPtr->joints.erase(name);
+  this->dataPtr->indices.erase(iter);
+
+  this->dataPtr->jointList.erase(this->dataPtr->jointList.begin() + index);
+  this->dataPtr->posPids.erase(this->dataPtr->posPids.begin() + index);
+  this->dataPtr->velPids.erase(this->dataPtr->velPids.begin() + index);
+  this->dataPtr->forces.erase(this->dataPtr->forces.begin() + index);
+  this->dataPtr->positions.erase(this->dataPtr->positions.begin() + index);
+  this->dataPtr->velocities.erase(this->dataPtr->velocities.begin() + index);
+  this->dataPtr->commands.erase(this->dataPtr->commands.begin() + index);
+
+  // Shift the indices of the joints after the removed one
+  for (auto &entry : this->dataPtr->indices)
   {
-    this->dataPtr->joints.erase(_joint->GetScopedName());
-    this->dataPtr->posPids.erase(_joint->GetScopedName());
-    this->dataPtr->velPids.erase(_joint->GetScopedName());
+    if (entry.second > index)
+      --entry.second;
+  }
+
+  this->dataPtr->nameIndices.clear();
+  for (unsigned int i = 0; i < this->dataPtr->jointList.size(); ++i)
+  {
+    this->dataPtr->nameIndices.emplace(
+        this->dataPtr->jointList[i]->GetName(), i);
   }
 }
 
@@ -91,23 +141,13 @@ void JointController::RemoveJoint(Joint *_joint)
 void JointController::Reset()
 {
   // Reset setpoints and feed-forward.
-  this->dataPtr->positions.clear();
-  this->dataPtr->velocities.clear();
-  this->dataPtr->forces.clear();
+  std::fill(this->dataPtr->commands.begin(), this->dataPtr->commands.end(), 0);
 
-  std::map<std::string, common::PID>::iterator iter;
+  for (auto &pid : this->dataPtr->posPids)
+    pid.Reset();
 
-  for (iter = this->dataPtr->posPids.begin();
-    iter != this->dataPtr->posPids.end(); ++iter)
-  {
-    iter->second.Reset();
-  }
-
-  for (iter = this->dataPtr->velPids.begin();
-    iter != this->dataPtr->velPids.end(); ++iter)
-  {
-    iter->second.Reset();
-  }
+  for (auto &pid : this->dataPtr->velPids)
+    pid.Reset();
 }
 
 /////////////////////////////////////////////////
@@ -123,41 +163,31 @@ void JointController::Update()
   // TODO: fix this when World::ResetTime is improved
   if (stepTime > 0)
   {
-    if (!this->dataPtr->forces.empty())
+    // Apply the commands of every joint in one pass over the arrays
+    const size_t count = this->dataPtr->jointList.size();
+    for (size_t i = 0; i < count; ++i)
     {
-      std::map<std::string, double>::iterator iter;
-      for (iter = this->dataPtr->forces.begin();
-          iter != this->dataPtr->forces.end(); ++iter)
-      {
-        this->dataPtr->joints[iter->first]->SetForce(0, iter->second);
-      }
-    }
+      const uint8_t commands = this->dataPtr->commands[i];
+      if (!commands)
+        continue;
 
-    if (!this->dataPtr->positions.empty())
-    {
-      std::map<std::string, double>::iterator iter;
+      Joint *joint = this->dataPtr->jointList[i].get();
+
+      if (commands & JointControllerPrivate::FORCE)
+        joint->SetForce(0, this->dataPtr->forces[i]);
 
-      for (iter = this->dataPtr->positions.begin();
-           iter != this->dataPtr->positions.end(); ++iter)
+      if (commands & JointControllerPrivate::POSITION)
       {
-        double cmd = this->dataPtr->posPids[iter->first].Update(
-            this->dataPtr->joints[iter->first]->Position(0) -
-            iter->second, stepTime);
-        this->dataPtr->joints[iter->first]->SetForce(0, cmd);
+        double cmd = this->dataPtr->posPids[i].Update(
+            joint->Position(0) - this->dataPtr->positions[i], stepTime);
+        joint->SetForce(0, cmd);
       }
-    }
-
-    if (!this->dataPtr->velocities.empty())
-    {
-      std::map<std::string, double>::iterator iter;
 
-      for (iter = this->dataPtr->velocities.begin();
-           iter != this->dataPtr->velocities.end(); ++iter)
+      if (commands & JointControllerPrivate::VELOCITY)
       {
-        double cmd = this->dataPtr->velPids[iter->first].Update(
-            this->dataPtr->joints[iter->first]->GetVelocity(0) - iter->second,
-            stepTime);
-        this->dataPtr->joints[iter->first]->SetForce(0, cmd);
+        double cmd = this->dataPtr->velPids[i].Update(
+            joint->GetVelocity(0) - this->dataPtr->velocities[i], stepTime);
+        joint->SetForce(0, cmd);
       }
     }
   }
@@ -189,47 +219,45 @@ bool JointController::OnJointCmdReq(const ignition::msgs::StringMsg &_req,
   const std::string &jointName = _req.data();
   _rep.set_name(jointName);
 
-  if (this->dataPtr->forces.find(jointName) !=
-      this->dataPtr->forces.end())
+  auto iter = this->dataPtr->indices.find(jointName);
+  if (iter == this->dataPtr->indices.end())
+    return true;
+
+  const unsigned int index = iter->second;
+  const uint8_t commands = this->dataPtr->commands[index];
+
+  if (commands & JointControllerPrivate::FORCE)
   {
-    _rep.mutable_force_optional()->set_data(this->dataPtr->forces[jointName]);
+    _rep.mutable_force_optional()->set_data(this->dataPtr->forces[index]);
   }
 
-  if (this->dataPtr->positions.find(jointName) !=
-      this->dataPtr->positions.end())
+  if (commands & JointControllerPrivate::POSITION)
   {
     _rep.mutable_position()->mutable_target_optional()->set_data(
-        this->dataPtr->positions[jointName]);
+        this->dataPtr->positions[index]);
   }
 
-  if (this->dataPtr->velocities.find(jointName) !=
-      this->dataPtr->velocities.end())
+  if (commands & JointControllerPrivate::VELOCITY)
   {
     _rep.mutable_velocity()->mutable_target_optional()->set_data(
-        this->dataPtr->velocities[jointName]);
+        this->dataPtr->velocities[index]);
   }
 
-  if (this->dataPtr->posPids.find(jointName) !=
-      this->dataPtr->posPids.end())
-  {
-    _rep.mutable_position()->mutable_p_gain_optional()->set_data(
-        this->dataPtr->posPids[jointName].GetPGain());
-    _rep.mutable_position()->mutable_d_gain_optional()->set_data(
-        this->dataPtr->posPids[jointName].GetDGain());
-    _rep.mutable_position()->mutable_i_gain_optional()->set_data(
-        this->dataPtr->posPids[jointName].GetIGain());
-  }
-
-  if (this->dataPtr->velPids.find(jointName) !=
-      this->dataPtr->velPids.end())
-  {
-    _rep.mutable_velocity()->mutable_p_gain_optional()->set_data(
-        this->dataPtr->velPids[jointName].GetPGain());
-    _rep.mutable_velocity()->mutable_d_gain_optional()->set_data(
-        this->dataPtr->velPids[jointName].GetDGain());
-    _rep.mutable_velocity()->mutable_i_gain_optional()->set_data(
-        this->dataPtr->velPids[jointName].GetIGain());
-  }
+  const common::PID &posPid = this->dataPtr->posPids[index];
+  _rep.mutable_position()->mutable_p_gain_optional()->set_data(
+      posPid.GetPGain());
+  _rep.mutable_position()->mutable_d_gain_optional()->set_data(
+      posPid.GetDGain());
+  _rep.mutable_position()->mutable_i_gain_optional()->set_data(
+      posPid.GetIGain());
+
+  const common::PID &velPid = this->dataPtr->velPids[index];
+  _rep.mutable_velocity()->mutable_p_gain_optional()->set_data(
+      velPid.GetPGain());
+  _rep.mutable_velocity()->mutable_d_gain_optional()->set_data(
+      velPid.GetDGain());
+  _rep.mutable_velocity()->mutable_i_gain_optional()->set_data(
+      velPid.GetIGain());
 
   return true;
 }
@@ -237,84 +265,46 @@ bool JointController::OnJointCmdReq(const ignition::msgs::StringMsg &_req,
 /////////////////////////////////////////////////
 void JointController::OnJointCommand(const ignition::msgs::JointCmd &_msg)
 {
-  std::map<std::string, JointPtr>::iterator iter;
-  iter = this->dataPtr->joints.find(_msg.name());
-  if (iter != this->dataPtr->joints.end())
+  auto iter = this->dataPtr->indices.find(_msg.name());
+  if (iter != this->dataPtr->indices.end())
   {
-    if (_msg.reset())
-    {
-      if (this->dataPtr->forces.find(_msg.name()) !=
-          this->dataPtr->forces.end())
-      {
-        this->dataPtr->forces.erase(this->dataPtr->forces.find(_msg.name()));
-      }
-
-      if (this->dataPtr->positions.find(_msg.name()) !=
-          this->dataPtr->positions.end())
-      {
-        this->dataPtr->positions.erase(
-            this->dataPtr->positions.find(_msg.name()));
-      }
+    const unsigned int index = iter->second;
 
-      if (this->dataPtr->velocities.find(_msg.name()) !=
-          this->dataPtr->velocities.end())
-      {
-        this->dataPtr->velocities.erase(
-            this->dataPtr->velocities.find(_msg.name()));
-      }
-    }
+    if (_msg.reset())
+      this->dataPtr->commands[index] = 0;
 
     if (_msg.has_force_optional())
-      this->dataPtr->forces[_msg.name()] = _msg.force_optional().data();
+      this->SetForce(index, _msg.force_optional().data());
 
     if (_msg.has_position())
     {
       if (_msg.position().has_target_optional())
       {
-        if (!this->SetPositionTarget(_msg.name(),
-            _msg.position().target_optional().data()))
-        {
-          gzerr << "Unable to set position target for joint["
-            << _msg.name() << "]. Joint is not found.\n";
-        }
+        this->SetPositionTarget(index,
+            _msg.position().target_optional().data());
       }
 
+      common::PID &pid = this->dataPtr->posPids[index];
+
       if (_msg.position().has_p_gain_optional())
-      {
-        this->dataPtr->posPids[_msg.name()].SetPGain(
-            _msg.position().p_gain_optional().data());
-      }
+        pid.SetPGain(_msg.position().p_gain_optional().data());
 
       if (_msg.position().has_i_gain_optional())
-      {
-        this->dataPtr->posPids[_msg.name()].SetIGain(
-            _msg.position().i_gain_optional().data());
-      }
+        pid.SetIGain(_msg.position().i_gain_optional().data());
 
       if (_msg.position().has_d_gain_optional())
-      {
-        this->dataPtr->posPids[_msg.name()].SetDGain(
-            _msg.position().d_gain_optional().data());
-      }
+        pid.SetDGain(_msg.position().d_gain_optional().data());
 
       if (_msg.position().has_i_max_optional())
-      {
-        this->dataPtr->posPids[_msg.name()].SetIMax(
-            _msg.position().i_max_optional().data());
-      }
+        pid.SetIMax(_msg.position().i_max_optional().data());
 
       if (_msg.position().has_i_min_optional())
-      {
-        this->dataPtr->posPids[_msg.name()].SetIMin(
-            _msg.position().i_min_optional().data());
-      }
+        pid.SetIMin(_msg.position().i_min_optional().data());
 
       if (_msg.position().has_limit_optional())
       {
-        this->dataPtr->posPids[_msg.name()].SetCmdMax(
-            _msg.position().limit_optional().data());
-        this->dataPtr->posPids[_msg.name()].SetCmdMin(
-            -_msg.position().limit_optional().data());
+        pid.SetCmdMax(_msg.position().limit_optional().data());
+        pid.SetCmdMin(-_msg.position().limit_optional().data());
       }
     }
 
@@ -322,50 +312,31 @@ void JointController::OnJointCommand(const ignition::msgs::JointCmd &_msg)
     {
       if (_msg.velocity().has_target_optional())
       {
-        if (!this->SetVelocityTarget(_msg.name(),
-            _msg.velocity().target_optional().data()))
-        {
-          gzerr << "Unable to set velocity target for joint["
-            << _msg.name() << "]. Joint is not found.\n";
-        }
+        this->SetVelocityTarget(index,
+            _msg.velocity().target_optional().data());
       }
 
+      common::PID &pid = this->dataPtr->velPids[index];
+
       if (_msg.velocity().has_p_gain_optional())
-      {
-        this->dataPtr->velPids[_msg.name()].SetPGain(
-            _msg.velocity().p_gain_optional().data());
-      }
+        pid.SetPGain(_msg.velocity().p_gain_optional().data());
 
       if (_msg.velocity().has_i_gain_optional())
-      {
-        this->dataPtr->velPids[_msg.name()].SetIGain(
-            _msg.velocity().i_gain_optional().data());
-      }
+        pid.SetIGain(_msg.velocity().i_gain_optional().data());
 
       if (_msg.velocity().has_d_gain_optional())
-      {
-        this->dataPtr->velPids[_msg.name()].SetDGain(
-            _msg.velocity().d_gain_optional().data());
-      }
+        pid.SetDGain(_msg.velocity().d_gain_optional().data());
 
       if (_msg.velocity().has_i_max_optional())
-      {
-        this->dataPtr->velPids[_msg.name()].SetIMax(
-            _msg.velocity().i_max_optional().data());
-      }
+        pid.SetIMax(_msg.velocity().i_max_optional().data());
 
       if (_msg.velocity().has_i_min_optional())
-      {
-        this->dataPtr->velPids[_msg.name()].SetIMin(
-            _msg.velocity().i_min_optional().data());
-      }
+        pid.SetIMin(_msg.velocity().i_min_optional().data());
 
       if (_msg.velocity().has_limit_optional())
       {
-        this->dataPtr->velPids[_msg.name()].SetCmdMax(
-            _msg.velocity().limit_optional().data());
-        this->dataPtr->velPids[_msg.name()].SetCmdMin(
-            -_msg.velocity().limit_optional().data());
+        pid.SetCmdMax(_msg.velocity().limit_optional().data());
+        pid.SetCmdMin(-_msg.velocity().limit_optional().data());
       }
     }
   }
@@ -392,24 +363,55 @@ void JointController::SetJointPositions(
 {
   // go through all joints in this model and update each one
   //   for each joint update, recursively update all children
-  std::map<std::string, JointPtr>::iterator iter;
-  std::map<std::string, double>::const_iterator jiter;
+  std::vector<unsigned int> &indices = this->dataPtr->positionIndices;
+  std::vector<double> &values = this->dataPtr->positionValues;
+  indices.clear();
+  values.clear();
 
-  for (iter = this->dataPtr->joints.begin();
-      iter != this->dataPtr->joints.end(); ++iter)
+  std::map<std::string, double>::const_iterator jiter;
+  for (auto &entry : this->dataPtr->indices)
   {
+    const JointPtr &joint = this->dataPtr->jointList[entry.second];
+
     // First try name without scope, i.e. joint_name
-    jiter = _jointPositions.find(iter->second->GetName());
+    jiter = _jointPositions.find(joint->GetName());
 
     if (jiter == _jointPositions.end())
     {
       // Second try name with scope, i.e. model_name::joint_name
-      jiter = _jointPositions.find(iter->second->GetScopedName());
+      jiter = _jointPositions.find(entry.first);
       if (jiter == _jointPositions.end())
         continue;
     }
 
-    this->SetJointPosition(iter->second, jiter->second);
+    indices.push_back(entry.second);
+    values.push_back(jiter->second);
+  }
+
+  this->SetJointPositions(indices, values);
+}
+
+//////////////////////////////////////////////////
+void JointController::SetJointPositions(
+    const std::vector<unsigned int> &_indices,
+    const std::vector<double> &_positions)
+{
+  if (_indices.size() != _positions.size())
+  {
+    gzerr << "SetJointPositions got " << _indices.size() << " indices and "
+          << _positions.size() << " positions\n";
+    return;
+  }
+
+  for (size_t i = 0; i < _indices.size(); ++i)
+  {
+    if (_indices[i] < this->dataPtr->jointList.size())
+    {
+      this->SetJointPosition(this->dataPtr->jointList[_indices[i]],
+          _positions[i]);
+    }
+    else
+      gzwarn << "SetJointPositions index [" << _indices[i] << "] not found\n";
   }
 }
 
@@ -432,45 +434,94 @@ std::map<std::string, JointPtr> JointController::GetJoints() const
   return this->dataPtr->joints;
 }
 
+/////////////////////////////////////////////////
+int JointController::JointIndex(const std::string &_jointName) const
+{
+  auto iter = this->dataPtr->indices.find(_jointName);
+  if (iter != this->dataPtr->indices.end())
+    return static_cast<int>(iter->second);
+
+  iter = this->dataPtr->nameIndices.find(_jointName);
+  if (iter != this->dataPtr->nameIndices.end())
+    return static_cast<int>(iter->second);
+
+  return -1;
+}
+
+/////////////////////////////////////////////////
+unsigned int JointController::JointCount() const
+{
+  return this->dataPtr->jointList.size();
+}
+
 /////////////////////////////////////////////////
 std::map<std::string, common::PID> JointController::GetPositionPIDs() const
 {
-  return this->dataPtr->posPids;
+  std::map<std::string, common::PID> result;
+  for (auto &entry : this->dataPtr->indices)
+    result[entry.first] = this->dataPtr->posPids[entry.second];
+  return result;
 }
 
 /////////////////////////////////////////////////
 std::map<std::string, common::PID> JointController::GetVelocityPIDs() const
 {
-  return this->dataPtr->velPids;
+  std::map<std::string, common::PID> result;
+  for (auto &entry : this->dataPtr->indices)
+    result[entry.first] = this->dataPtr->velPids[entry.second];
+  return result;
 }
 
 /////////////////////////////////////////////////
 std::map<std::string, double> JointController::GetForces() const
 {
-  return this->dataPtr->forces;
+  std::map<std::string, double> result;
+  for (auto &entry : this->dataPtr->indices)
+  {
+    if (this->dataPtr->commands[entry.second] & JointControllerPrivate::FORCE)
+      result[entry.first] = this->dataPtr->forces[entry.second];
+  }
+  return result;
 }
 
 /////////////////////////////////////////////////
 std::map<std::string, double> JointController::GetPositions() const
 {
-  return this->dataPtr->positions;
+  std::map<std::string, double> result;
+  for (auto &entry : this->dataPtr->indices)
+  {
+    if (this->dataPtr->commands[entry.second] &
+        JointControllerPrivate::POSITION)
+    {
+      result[entry.first] = this->dataPtr->positions[entry.second];
+    }
+  }
+  return result;
 }
 
 /////////////////////////////////////////////////
 std::map<std::string, double> JointController::GetVelocities() const
 {
-  return this->dataPtr->velocities;
+  std::map<std::string, double> result;
+  for (auto &entry : this->dataPtr->indices)
+  {
+    if (this->dataPtr->commands[entry.second] &
+        JointControllerPrivate::VELOCITY)
+    {
+      result[entry.first] = this->dataPtr->velocities[entry.second];
+    }
+  }
+  return result;
 }
 
 //////////////////////////////////////////////////
 void JointController::SetPositionPID(const std::string &_jointName,
                                      const common::PID &_pid)
 {
-  std::map<std::string, JointPtr>::iterator iter;
-  iter = this->dataPtr->joints.find(_jointName);
+  auto iter = this->dataPtr->indices.find(_jointName);
 
-  if (iter != this->dataPtr->joints.end())
-    this->dataPtr->posPids[_jointName] = _pid;
+  if (iter != this->dataPtr->indices.end())
+    this->SetPositionPID(iter->second, _pid);
   else
     gzerr << "Unable to find joint with name[" << _jointName << "]\n";
 }
@@ -479,27 +530,19 @@ void JointController::SetPositionPID(const std::string &_jointName,
 bool JointController::SetPositionTarget(const std::string &_jointName,
     const double _target)
 {
-  bool result = false;
-
-  if (this->dataPtr->posPids.find(_jointName) !=
-      this->dataPtr->posPids.end())
-  {
-    this->dataPtr->positions[_jointName] = _target;
-    result = true;
-  }
-
-  return result;
+  auto iter = this->dataPtr->indices.find(_jointName);
+  return iter != this->dataPtr->indices.end() &&
+    this->SetPositionTarget(iter->second, _target);
 }
 
 //////////////////////////////////////////////////
 void JointController::SetVelocityPID(const std::string &_jointName,
                                      const common::PID &_pid)
 {
-  std::map<std::string, JointPtr>::iterator iter;
-  iter = this->dataPtr->joints.find(_jointName);
+  auto iter = this->dataPtr->indices.find(_jointName);
 
-  if (iter != this->dataPtr->joints.end())
-    this->dataPtr->velPids[_jointName] = _pid;
+  if (iter != this->dataPtr->indices.end())
+    this->SetVelocityPID(iter->second, _pid);
   else
     gzerr << "Unable to find joint with name[" << _jointName << "]\n";
 }
@@ -508,30 +551,111 @@ void JointController::SetVelocityPID(const std::string &_jointName,
 bool JointController::SetVelocityTarget(const std::string &_jointName,
     const double _target)
 {
-  bool result = false;
-
-  if (this->dataPtr->velPids.find(_jointName) !=
-      this->dataPtr->velPids.end())
-  {
-    this->dataPtr->velocities[_jointName] = _target;
-    result = true;
-  }
-
-  return result;
+  auto iter = this->dataPtr->indices.find(_jointName);
+  return iter != this->dataPtr->indices.end() &&
+    this->SetVelocityTarget(iter->second, _target);
 }
 
 /////////////////////////////////////////////////
 bool JointController::SetForce(const std::string &_jointName,
     const double _force)
 {
-  bool result = false;
+  auto iter = this->dataPtr->indices.find(_jointName);
+  return iter != this->dataPtr->indices.end() &&
+    this->SetForce(iter->second, _force);
+}
 
-  if (this->dataPtr->joints.find(_jointName) !=
-      this->dataPtr->joints.end())
-  {
-    this->dataPtr->forces[_jointName] = _force;
-    result = true;
-  }
+/////////////////////////////////////////////////
+bool JointController::SetPositionPID(const unsigned int _index,
+    const common::PID &_pid)
+{
+  if (_index >= this->dataPtr->jointList.size())
+    return false;
 
-  return result;
+  this->dataPtr->posPids[_index] = _pid;
+  return true;
+}
+
+/////////////////////////////////////////////////
+bool JointController::SetPositionTarget(const unsigned int _index,
+    const double _target)
+{
+  if (_index >= this->dataPtr->jointList.size())
+    return false;
+
+  this->dataPtr->positions[_index] = _target;
+  this->dataPtr->commands[_index] |= JointControllerPrivate::POSITION;
+  return true;
+}
+
+/////////////////////////////////////////////////
+bool JointController::SetVelocityPID(const unsigned int _index,
+    const common::PID &_pid)
+{
+  if (_index >= this->dataPtr->jointList.size())
+    return false;
+
+  this->dataPtr->velPids[_index] = _pid;
+  return true;
+}
+
+/////////////////////////////////////////////////
+bool JointController::SetVelocityTarget(const unsigned int _index,
+    const double _target)
+{
+  if (_index >= this->dataPtr->jointList.size())
+    return false;
+
+  this->dataPtr->velocities[_index] = _target;
+  this->dataPtr->commands[_index] |= JointControllerPrivate::VELOCITY;
+  return true;
+}
+
+/////////////////////////////////////////////////
+bool JointController::SetForce(const unsigned int _index, const double _force)
+{
+  if (_index >= this->dataPtr->jointList.size())
+    return false;
+
+  this->dataPtr->forces[_index] = _force;
+  this->dataPtr->commands[_index] |= JointControllerPrivate::FORCE;
+  return true;
+}
+
+/////////////////////////////////////////////////
+bool JointController::SetPositionTargets(const std::vector<double> &_targets)
+{
+  if (_targets.size() != this->dataPtr->jointList.size())
+    return false;
+
+  std::copy(_targets.begin(), _targets.end(),
+      this->dataPtr->positions.begin());
+  for (auto &commands : this->dataPtr->commands)
+    commands |= JointControllerPrivate::POSITION;
+  return true;
+}
+
+/////////////////////////////////////////////////
+bool JointController::SetVelocityTargets(const std::vector<double> &_targets)
+{
+  if (_targets.size() != this->dataPtr->jointList.size())
+    return false;
+
+  std::copy(_targets.begin(), _targets.end(),
+      this->dataPtr->velocities.begin());
+  for (auto &commands : this->dataPtr->commands)
+    commands |= JointControllerPrivate::VELOCITY;
+  return true;
+}
+
+/////////////////////////////////////////////////
+bool JointController::SetForces(const std::vector<double> &_forces)
+{
+  if (_forces.size() != this->dataPtr->jointList.size())
+    return false;
+
+  std::copy(_forces.begin(), _forces.end(), this->dataPtr->forces.begin());
+  for (auto &commands : this->dataPtr->commands)
+    commands |= JointControllerPrivate::FORCE;
+  return true;
 }
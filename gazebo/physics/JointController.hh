@@ -116,6 +116,84 @@ namespace gazebo
       /// \return False if the joint was not found.
       public: bool SetForce(const std::string &_jointName, const double _force);
 
+      /// \brief Get the index of a joint, to control it with the index
+      /// based functions, which avoid the name lookups of the functions
+      /// above. Joints are indexed in the order they were added, and
+      /// removing a joint shifts the indices of the joints after it.
+      /// \param[in] _jointName Scoped name of the joint, or its name if
+      /// no joint has that scoped name.
+      /// \return Index of the joint, -1 if the joint was not found.
+      public: int JointIndex(const std::string &_jointName) const;
+
+      /// \brief Get the number of controlled joints.
+      /// \return Number of joints.
+      public: unsigned int JointCount() const;
+
+      /// \brief Set the position PID values for a joint.
+      /// \param[in] _index Index of the joint.
+      /// \param[in] _pid New position PID controller.
+      /// \return False if the index is out of range.
+      /// \sa JointIndex
+      public: bool SetPositionPID(const unsigned int _index,
+                  const common::PID &_pid);
+
+      /// \brief Set the target position for the position PID controller.
+      /// \param[in] _index Index of the joint.
+      /// \param[in] _target Position target.
+      /// \return False if the index is out of range.
+      /// \sa JointIndex
+      public: bool SetPositionTarget(const unsigned int _index,
+                  const double _target);
+
+      /// \brief Set the velocity PID values for a joint.
+      /// \param[in] _index Index of the joint.
+      /// \param[in] _pid New velocity PID controller.
+      /// \return False if the index is out of range.
+      /// \sa JointIndex
+      public: bool SetVelocityPID(const unsigned int _index,
+                  const common::PID &_pid);
+
+      /// \brief Set the target velocity for the velocity PID controller.
+      /// \param[in] _index Index of the joint.
+      /// \param[in] _target Velocity target.
+      /// \return False if the index is out of range.
+      /// \sa JointIndex
+      public: bool SetVelocityTarget(const unsigned int _index,
+                  const double _target);
+
+      /// \brief Set the applied effort for a joint.
+      /// This force will persist across time steps.
+      /// \param[in] _index Index of the joint.
+      /// \param[in] _force Force to apply.
+      /// \return False if the index is out of range.
+      /// \sa JointIndex
+      public: bool SetForce(const unsigned int _index, const double _force);
+
+      /// \brief Set the position targets of all the joints at once.
+      /// \param[in] _targets One position target per joint, in index
+      /// order.
+      /// \return False if the number of targets is not JointCount().
+      public: bool SetPositionTargets(const std::vector<double> &_targets);
+
+      /// \brief Set the velocity targets of all the joints at once.
+      /// \param[in] _targets One velocity target per joint, in index
+      /// order.
+      /// \return False if the number of targets is not JointCount().
+      public: bool SetVelocityTargets(const std::vector<double> &_targets);
+
+      /// \brief Set the applied efforts of all the joints at once.
+      /// \param[in] _forces One force per joint, in index order.
+      /// \return False if the number of forces is not JointCount().
+      public: bool SetForces(const std::vector<double> &_forces);
+
+      /// \brief Set the positions of a set of joints by index, in the
+      /// given order.
+      /// \param[in] _indices Indices of the joints.
+      /// \param[in] _positions Position of each joint of _indices.
+      /// \sa JointController::SetJointPosition(JointPtr, double)
+      public: void SetJointPositions(const std::vector<unsigned int> &_indices,
+                  const std::vector<double> &_positions);
+
       /// \brief Get all the position PID controllers.
       /// \return A map<joint_name, PID> for all the position PID
       /// controllers.
@@ -17,8 +17,10 @@
 #ifndef _GAZEBO_JOINTCONTROLLER_PRIVATE_HH_
 #define _GAZEBO_JOINTCONTROLLER_PRIVATE_HH_
 
+#include <cstdint>
 #include <string>
 #include <map>
+#include <vector>
 #include <ignition/transport.hh>
 
 #include "gazebo/transport/TransportTypes.hh"
@@ -32,6 +34,19 @@ namespace gazebo
   {
     class JointControllerPrivate
     {
+      /// \brief Commands set on a joint.
+      public: enum Command
+              {
+                /// \brief A force is applied.
+                FORCE = 1,
+
+                /// \brief A position target is set.
+                POSITION = 2,
+
+                /// \brief A velocity target is set.
+                VELOCITY = 4
+              };
+
       /// \brief Model to control.
       public: ModelPtr model;
 
@@ -41,20 +56,41 @@ namespace gazebo
       /// \brief Map of joint names to the joint pointer.
       public: std::map<std::string, JointPtr> joints;
 
+      /// \brief Map of joint scoped names to the joint index.
+      public: std::map<std::string, unsigned int> indices;
+
+      /// \brief Map of joint names to the index of the first joint added
+      /// with that name.
+      public: std::map<std::string, unsigned int> nameIndices;
+
+      /// \brief Controlled joints. The state of the joint at index i is at
+      /// index i of the vectors below.
+      public: std::vector<JointPtr> jointList;
+
       /// \brief Position PID controllers.
-      public: std::map<std::string, common::PID> posPids;
+      public: std::vector<common::PID> posPids;
 
       /// \brief Velocity PID controllers.
-      public: std::map<std::string, common::PID> velPids;
+      public: std::vector<common::PID> velPids;
 
       /// \brief Forces applied to joints.
-      public: std::map<std::string, double> forces;
+      public: std::vector<double> forces;
+
+      /// \brief Joint position targets.
+      public: std::vector<double> positions;
+
+      /// \brief Joint velocity targets.
+      public: std::vector<double> velocities;
+
+      /// \brief Commands set on each joint, a combination of Command
+      /// values.
+      public: std::vector<uint8_t> commands;
 
-      /// \brief Joint positions.
-      public: std::map<std::string, double> positions;
+      /// \brief Joint indices resolved by SetJointPositions.
+      public: std::vector<unsigned int> positionIndices;
 
-      /// \brief Joint velocities.
-      public: std::map<std::string, double> velocities;
+      /// \brief Joint positions set by SetJointPositions.
+      public: std::vector<double> positionValues;
 
       /// \brief Node for communication.
       /// \deprecated See JointControllerPrivate::node.
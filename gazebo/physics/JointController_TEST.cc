@@ -350,6 +350,87 @@ TEST_F(JointControllerTest, JointCmd)
   EXPECT_DOUBLE_EQ(rep.velocity().d_gain_optional().data(), 9);
 }
 
+/////////////////////////////////////////////////
+TEST_F(JointControllerTest, JointIndex)
+{
+  // Create a dummy model
+  physics::ModelPtr model(new physics::Model(physics::BasePtr()));
+  EXPECT_TRUE(model != NULL);
+
+  // Create the joint controller
+  physics::JointControllerPtr jointController(
+      new physics::JointController(model));
+  EXPECT_TRUE(jointController != NULL);
+
+  physics::JointPtr joint1(new FakeJoint(model));
+  joint1->SetName("joint1");
+  physics::JointPtr joint2(new FakeJoint(model));
+  joint2->SetName("joint2");
+  physics::JointPtr joint3(new FakeJoint(model));
+  joint3->SetName("joint3");
+
+  jointController->AddJoint(joint1);
+  jointController->AddJoint(joint2);
+  jointController->AddJoint(joint3);
+  EXPECT_EQ(jointController->JointCount(), 3u);
+
+  // Joints are indexed in the order they were added
+  EXPECT_EQ(jointController->JointIndex(joint1->GetScopedName()), 0);
+  EXPECT_EQ(jointController->JointIndex(joint2->GetScopedName()), 1);
+  EXPECT_EQ(jointController->JointIndex("joint3"), 2);
+  EXPECT_EQ(jointController->JointIndex("my_bad_name"), -1);
+
+  // Index and name based functions share the same state
+  EXPECT_TRUE(jointController->SetPositionTarget(1u, 1.5));
+  EXPECT_TRUE(jointController->SetVelocityTarget(2u, 2.5));
+  EXPECT_TRUE(jointController->SetForce(0u, 3.5));
+  EXPECT_TRUE(jointController->SetPositionPID(1u, common::PID(4, 1, 9)));
+  EXPECT_FALSE(jointController->SetPositionTarget(3u, 1.5));
+  EXPECT_FALSE(jointController->SetForce(3u, 1.5));
+
+  std::map<std::string, double> positions = jointController->GetPositions();
+  EXPECT_EQ(positions.size(), 1u);
+  EXPECT_DOUBLE_EQ(positions[joint2->GetScopedName()], 1.5);
+  std::map<std::string, double> velocities =
+    jointController->GetVelocities();
+  EXPECT_EQ(velocities.size(), 1u);
+  EXPECT_DOUBLE_EQ(velocities[joint3->GetScopedName()], 2.5);
+  std::map<std::string, double> forces = jointController->GetForces();
+  EXPECT_EQ(forces.size(), 1u);
+  EXPECT_DOUBLE_EQ(forces[joint1->GetScopedName()], 3.5);
+  EXPECT_DOUBLE_EQ(
+      jointController->GetPositionPIDs()[joint2->GetScopedName()].GetPGain(),
+      4);
+
+  // Set the targets of all the joints at once
+  EXPECT_FALSE(jointController->SetPositionTargets({1.0, 2.0}));
+  EXPECT_TRUE(jointController->SetPositionTargets({1.0, 2.0, 3.0}));
+  EXPECT_TRUE(jointController->SetVelocityTargets({4.0, 5.0, 6.0}));
+  EXPECT_TRUE(jointController->SetForces({7.0, 8.0, 9.0}));
+  positions = jointController->GetPositions();
+  EXPECT_EQ(positions.size(), 3u);
+  EXPECT_DOUBLE_EQ(positions[joint3->GetScopedName()], 3.0);
+  EXPECT_EQ(jointController->GetVelocities().size(), 3u);
+  EXPECT_EQ(jointController->GetForces().size(), 3u);
+
+  // Removing a joint shifts the indices of the joints after it
+  jointController->RemoveJoint(joint2.get());
+  EXPECT_EQ(jointController->JointCount(), 2u);
+  EXPECT_EQ(jointController->JointIndex(joint2->GetScopedName()), -1);
+  EXPECT_EQ(jointController->JointIndex(joint3->GetScopedName()), 1);
+  positions = jointController->GetPositions();
+  EXPECT_EQ(positions.size(), 2u);
+  EXPECT_DOUBLE_EQ(positions[joint1->GetScopedName()], 1.0);
+  EXPECT_DOUBLE_EQ(positions[joint3->GetScopedName()], 3.0);
+
+  // Reset clears the targets of every joint
+  jointController->Reset();
+  EXPECT_TRUE(jointController->GetPositions().empty());
+  EXPECT_TRUE(jointController->GetVelocities().empty());
+  EXPECT_TRUE(jointController->GetForces().empty());
+  EXPECT_EQ(jointController->GetPositionPIDs().size(), 2u);
+}
+
 /////////////////////////////////////////////////
 int main(int argc, char **argv)
 {
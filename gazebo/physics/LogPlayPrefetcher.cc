@@ -0,0 +1,439 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include <sdf/sdf.hh>
+
+#include "gazebo/common/Console.hh"
+#include "gazebo/physics/WorldState.hh"
+#include "gazebo/util/LogPlay.hh"
+#include "gazebo/physics/LogPlayPrefetcher.hh"
+
+using namespace gazebo;
+using namespace physics;
+
+namespace gazebo
+{
+  namespace physics
+  {
+    /// \internal
+    /// \brief Private data for LogPlayPrefetcher.
+    ///
+    /// The decoded states form a window of consecutive states of the log.
+    /// States are identified by an index that is only meaningful relative
+    /// to other indices, and that restarts when the log is moved. The
+    /// position of util::LogPlay, the cursor, is always at one end of the
+    /// window, or at the current state when the window is empty.
+    class LogPlayPrefetcherPrivate
+    {
+      /// \brief Body of the decoding thread.
+      public: void Run();
+
+      /// \brief Get the next state the decoding thread should decode.
+      /// \param[out] _dir Direction to extend the window in.
+      /// \param[out] _move Number of states to move the log by before
+      /// stepping in that direction.
+      /// \return True if there is a state to decode.
+      public: bool NextWork(int &_dir, int64_t &_move) const;
+
+      /// \brief Parse a frame of the log.
+      /// \param[in] _data The frame.
+      /// \return The state.
+      public: std::shared_ptr<WorldState> Decode(const std::string &_data);
+
+      /// \brief Drop the states that are further than depth from the
+      /// current state, except the one at the cursor.
+      public: void Trim();
+
+      /// \brief Wait until the decoding thread no longer uses the log, and
+      /// discard the decoded states.
+      /// \param[in] _lock Lock of mutex.
+      public: void Clear(std::unique_lock<std::mutex> &_lock);
+
+      /// \brief Move to a state that is not decoded, on the calling thread.
+      /// \param[in] _step Number of states to move.
+      /// \param[out] _state The state moved to.
+      /// \param[in] _lock Lock of mutex.
+      /// \return True if at least one state was moved.
+      public: bool Jump(const int _step, std::shared_ptr<WorldState> &_state,
+                  std::unique_lock<std::mutex> &_lock);
+
+      /// \brief Index of the last decoded state.
+      /// \return The index, first - 1 if there are no decoded states.
+      public: int64_t Last() const
+              {
+                return this->first + static_cast<int64_t>(this->states.size())
+                  - 1;
+              }
+
+      /// \brief Number of states to decode ahead and to keep behind.
+      public: unsigned int depth = 1;
+
+      /// \brief The decoded states.
+      public: std::deque<std::shared_ptr<WorldState>> states;
+
+      /// \brief Index of the first decoded state.
+      public: int64_t first = 0;
+
+      /// \brief Index of the state playback is at.
+      public: int64_t current = 0;
+
+      /// \brief Index of the state util::LogPlay is at.
+      public: int64_t cursor = 0;
+
+      /// \brief Direction playback last moved in, 1 or -1.
+      public: int direction = 1;
+
+      /// \brief True if the log has no state after the last decoded one.
+      public: bool endForward = false;
+
+      /// \brief True if the log has no state before the first decoded one.
+      public: bool endBackward = false;
+
+      /// \brief True while the decoding thread uses the log without
+      /// holding mutex.
+      public: bool busy = false;
+
+      /// \brief True to stop the decoding thread.
+      public: bool stop = false;
+
+      /// \brief Protects the members above.
+      public: std::mutex mutex;
+
+      /// \brief Notified when the members above change.
+      public: std::condition_variable condition;
+
+      /// \brief Element the frames are parsed into.
+      public: sdf::ElementPtr stateSDF;
+
+      /// \brief The decoding thread.
+      public: std::thread thread;
+    };
+  }
+}
+
+/////////////////////////////////////////////////
+bool LogPlayPrefetcherPrivate::NextWork(int &_dir, int64_t &_move) const
+{
+  // Fill the direction playback moves in first, then the other one
+  for (const int dir : {this->direction, -this->direction})
+  {
+    if (dir > 0 ? this->endForward : this->endBackward)
+      continue;
+
+    if (this->states.empty())
+    {
+      _dir = dir;
+      _move = 0;
+      return true;
+    }
+
+    const int64_t edge = dir > 0 ? this->Last() : this->first;
+    if ((edge - this->current) * dir >= this->depth)
+      continue;
+
+    _dir = dir;
+    _move = edge - this->cursor;
+    return true;
+  }
+  return false;
+}
+
+/////////////////////////////////////////////////
+std::shared_ptr<WorldState> LogPlayPrefetcherPrivate::Decode(
+    const std::string &_data)
+{
+  this->stateSDF->Clear();
+  sdf::readString(_data, this->stateSDF);
+
+  auto state = std::make_shared<WorldState>();
+  state->Load(this->stateSDF);
+  return state;
+}
+
+/////////////////////////////////////////////////
+void LogPlayPrefetcherPrivate::Trim()
+{
+  while (!this->states.empty() && this->cursor != this->first &&
+      this->current - this->first > this->depth)
+  {
+    this->states.pop_front();
+    ++this->first;
+    this->endBackward = false;
+  }
+
+  while (!this->states.empty() && this->cursor != this->Last() &&
+      this->Last() - this->current > this->depth)
+  {
+    this->states.pop_back();
+    this->endForward = false;
+  }
+}
+
+/////////////////////////////////////////////////
+void LogPlayPrefetcherPrivate::Clear(std::unique_lock<std::mutex> &_lock)
+{
+  this->condition.wait(_lock, [this] {return !this->busy;});
+
+  this->states.clear();
+  this->first = 0;
+  this->current = 0;
+  this->cursor = 0;
+  this->endForward = false;
+  this->endBackward = false;
+}
+
+/////////////////////////////////////////////////
+void LogPlayPrefetcherPrivate::Run()
+{
+  std::unique_lock<std::mutex> lock(this->mutex);
+  while (true)
+  {
+    int dir = 1;
+    int64_t move = 0;
+    this->condition.wait(lock, [&]
+    {
+      return this->stop || this->NextWork(dir, move);
+    });
+    if (this->stop)
+      return;
+
+    this->busy = true;
+    lock.unlock();
+
+    // Move the log to the end of the window being extended, then step
+    // past it and parse the new frame.
+    std::string data;
+    const bool moved = move == 0 ||
+        util::LogPlay::Instance()->Step(static_cast<int>(move), data);
+    const bool stepped = moved && util::LogPlay::Instance()->Step(dir, data);
+    std::shared_ptr<WorldState> state;
+    if (stepped)
+      state = this->Decode(data);
+
+    lock.lock();
+    this->busy = false;
+
+    if (!moved)
+    {
+      gzerr << "Unable to move to a decoded state of the log\n";
+      this->endForward = true;
+      this->endBackward = true;
+    }
+    else if (!stepped)
+    {
+      this->cursor += move;
+      if (dir > 0)
+        this->endForward = true;
+      else
+        this->endBackward = true;
+    }
+    else
+    {
+      this->cursor += move + dir;
+      if (dir > 0)
+      {
+        if (this->states.empty())
+          this->first = this->cursor;
+        this->states.push_back(state);
+      }
+      else
+      {
+        this->states.push_front(state);
+        this->first = this->cursor;
+      }
+      this->Trim();
+    }
+
+    this->condition.notify_all();
+  }
+}
+
+/////////////////////////////////////////////////
+bool LogPlayPrefetcherPrivate::Jump(const int _step,
+    std::shared_ptr<WorldState> &_state, std::unique_lock<std::mutex> &_lock)
+{
+  this->condition.wait(_lock, [this] {return !this->busy;});
+
+  const int dir = _step > 0 ? 1 : -1;
+  const int64_t target = this->current + _step;
+
+  // Start from the decoded state nearest to the target, the current
+  // state may be a position util::LogPlay can not step back to.
+  int64_t edge = this->cursor;
+  if (!this->states.empty())
+    edge = dir > 0 ? this->Last() : this->first;
+
+  std::string data;
+  if (edge != this->cursor &&
+      !util::LogPlay::Instance()->Step(
+        static_cast<int>(edge - this->cursor), data))
+  {
+    gzerr << "Unable to move to a decoded state of the log\n";
+    return false;
+  }
+  this->cursor = edge;
+
+  if (!util::LogPlay::Instance()->Step(static_cast<int>(target - edge), data))
+  {
+    // The log ends before the target, stop at its last state
+    if (edge == this->current || this->states.empty())
+      return false;
+    this->current = edge;
+    _state = this->states[edge - this->first];
+    return true;
+  }
+
+  // Step() stops at the end of the log, so the position is no longer
+  // known relative to the window: start a new one.
+  _state = this->Decode(data);
+  this->states.clear();
+  this->states.push_back(_state);
+  this->first = 0;
+  this->current = 0;
+  this->cursor = 0;
+  this->endForward = false;
+  this->endBackward = false;
+  this->condition.notify_all();
+  return true;
+}
+
+/////////////////////////////////////////////////
+LogPlayPrefetcher::LogPlayPrefetcher(const unsigned int _depth)
+  : dataPtr(new LogPlayPrefetcherPrivate)
+{
+  this->dataPtr->depth = std::max(_depth, 1u);
+  this->dataPtr->stateSDF.reset(new sdf::Element);
+  sdf::initFile("state.sdf", this->dataPtr->stateSDF);
+
+  this->dataPtr->thread =
+    std::thread(&LogPlayPrefetcherPrivate::Run, this->dataPtr.get());
+}
+
+/////////////////////////////////////////////////
+LogPlayPrefetcher::~LogPlayPrefetcher()
+{
+  {
+    std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+    this->dataPtr->stop = true;
+  }
+  this->dataPtr->condition.notify_all();
+  this->dataPtr->thread.join();
+}
+
+/////////////////////////////////////////////////
+unsigned int LogPlayPrefetcher::Depth() const
+{
+  return this->dataPtr->depth;
+}
+
+/////////////////////////////////////////////////
+bool LogPlayPrefetcher::Step(const int _step,
+    std::shared_ptr<WorldState> &_state)
+{
+  if (_step == 0)
+    return false;
+
+  std::unique_lock<std::mutex> lock(this->dataPtr->mutex);
+
+  const int dir = _step > 0 ? 1 : -1;
+  const int64_t target = this->dataPtr->current + _step;
+  if (this->dataPtr->direction != dir)
+  {
+    this->dataPtr->direction = dir;
+    this->dataPtr->condition.notify_all();
+  }
+
+  auto decoded = [&]
+  {
+    return !this->dataPtr->states.empty() &&
+      target >= this->dataPtr->first && target <= this->dataPtr->Last();
+  };
+
+  // Large steps are not worth decoding every state in between
+  if (!decoded() && static_cast<unsigned int>(std::abs(_step)) >
+      this->dataPtr->depth)
+  {
+    return this->dataPtr->Jump(_step, _state, lock);
+  }
+
+  this->dataPtr->condition.wait(lock, [&]
+  {
+    return decoded() ||
+      (dir > 0 ? this->dataPtr->endForward : this->dataPtr->endBackward);
+  });
+
+  int64_t index = target;
+  if (!decoded())
+  {
+    // The log ends before the target, stop at its last state
+    if (this->dataPtr->states.empty())
+      return false;
+    index = dir > 0 ? this->dataPtr->Last() : this->dataPtr->first;
+    if ((index - this->dataPtr->current) * dir <= 0)
+      return false;
+  }
+
+  this->dataPtr->current = index;
+  _state = this->dataPtr->states[index - this->dataPtr->first];
+
+  // Moving makes room for more states ahead
+  this->dataPtr->Trim();
+  this->dataPtr->condition.notify_all();
+  return true;
+}
+
+/////////////////////////////////////////////////
+bool LogPlayPrefetcher::Seek(const common::Time &_time)
+{
+  std::unique_lock<std::mutex> lock(this->dataPtr->mutex);
+  this->dataPtr->Clear(lock);
+  this->dataPtr->direction = 1;
+  const bool result = util::LogPlay::Instance()->Seek(_time);
+  this->dataPtr->condition.notify_all();
+  return result;
+}
+
+/////////////////////////////////////////////////
+bool LogPlayPrefetcher::Rewind()
+{
+  std::unique_lock<std::mutex> lock(this->dataPtr->mutex);
+  this->dataPtr->Clear(lock);
+  this->dataPtr->direction = 1;
+  const bool result = util::LogPlay::Instance()->Rewind();
+  this->dataPtr->condition.notify_all();
+  return result;
+}
+
+/////////////////////////////////////////////////
+bool LogPlayPrefetcher::Forward()
+{
+  std::unique_lock<std::mutex> lock(this->dataPtr->mutex);
+  this->dataPtr->Clear(lock);
+  this->dataPtr->direction = -1;
+  const bool result = util::LogPlay::Instance()->Forward();
+  this->dataPtr->condition.notify_all();
+  return result;
+}
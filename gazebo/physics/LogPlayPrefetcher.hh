@@ -0,0 +1,96 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#ifndef GAZEBO_PHYSICS_LOGPLAYPREFETCHER_HH_
+#define GAZEBO_PHYSICS_LOGPLAYPREFETCHER_HH_
+
+#include <memory>
+
+#include "gazebo/common/Time.hh"
+#include "gazebo/util/system.hh"
+
+namespace gazebo
+{
+  namespace physics
+  {
+    class WorldState;
+
+    /// \addtogroup gazebo_physics
+    /// \{
+
+    /// Forward declare private data class.
+    class LogPlayPrefetcherPrivate;
+
+    /// \class LogPlayPrefetcher LogPlayPrefetcher.hh physics/physics.hh
+    /// \brief Decodes the states of the open util::LogPlay log ahead of
+    /// playback on a background thread.
+    ///
+    /// The thread steps the log and parses its frames into WorldState
+    /// objects, keeping up to Depth() states decoded ahead of the current
+    /// one in the direction playback last moved, and up to Depth() states
+    /// behind it, so stepping back does not decode again. Seek, Rewind and
+    /// Forward discard the decoded states.
+    ///
+    /// While a LogPlayPrefetcher exists it owns the position in the log:
+    /// the log must only be stepped and moved through it.
+    class GZ_PHYSICS_VISIBLE LogPlayPrefetcher
+    {
+      /// \brief Constructor. Starts decoding from the current position in
+      /// the log.
+      /// \param[in] _depth Number of states to decode ahead, at least one.
+      public: explicit LogPlayPrefetcher(const unsigned int _depth);
+
+      /// \brief Destructor. Stops the decoding thread.
+      public: virtual ~LogPlayPrefetcher();
+
+      /// \brief Get the number of states decoded ahead.
+      /// \return The depth given to the constructor.
+      public: unsigned int Depth() const;
+
+      /// \brief Move a number of states forward or backward in the log,
+      /// like util::LogPlay::Step(const int, std::string &). Blocks until
+      /// the state is decoded.
+      /// \param[in] _step Number of states to move, negative to move
+      /// backward.
+      /// \param[out] _state The state moved to. It is shared with the
+      /// states kept for stepping back.
+      /// \return True if at least one state was moved.
+      public: bool Step(const int _step, std::shared_ptr<WorldState> &_state);
+
+      /// \brief Discard the decoded states and jump to a time in the log,
+      /// see util::LogPlay::Seek.
+      /// \param[in] _time The target simulation time.
+      /// \return True on success.
+      public: bool Seek(const common::Time &_time);
+
+      /// \brief Discard the decoded states and jump to the beginning of
+      /// the log, see util::LogPlay::Rewind.
+      /// \return True on success.
+      public: bool Rewind();
+
+      /// \brief Discard the decoded states and jump to the end of the log,
+      /// see util::LogPlay::Forward.
+      /// \return True on success.
+      public: bool Forward();
+
+      /// \internal
+      /// \brief Private data pointer.
+      private: std::unique_ptr<LogPlayPrefetcherPrivate> dataPtr;
+    };
+    /// \}
+  }
+}
+#endif
@@ -0,0 +1,150 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <gtest/gtest.h>
+#include <boost/filesystem.hpp>
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gazebo/physics/LogPlayPrefetcher.hh"
+#include "gazebo/physics/WorldState.hh"
+#include "gazebo/util/LogPlay.hh"
+#include "test_config.h"
+#include "test/util.hh"
+
+using namespace gazebo;
+
+class LogPlayPrefetcherTest : public gazebo::testing::AutoLogFixture
+{
+  /// \brief Open a test log and read the simulation time of every state
+  /// without prefetching.
+  /// \return Simulation time of every state.
+  public: std::vector<common::Time> OpenLog();
+};
+
+/////////////////////////////////////////////////
+std::vector<common::Time> LogPlayPrefetcherTest::OpenLog()
+{
+  boost::filesystem::path logFilePath(TEST_PATH);
+  logFilePath /= boost::filesystem::path("logs");
+  logFilePath /= boost::filesystem::path("state.log");
+
+  util::LogPlay *player = util::LogPlay::Instance();
+  player->Open(logFilePath.string());
+
+  sdf::ElementPtr stateSDF(new sdf::Element);
+  sdf::initFile("state.sdf", stateSDF);
+
+  std::vector<common::Time> times;
+  std::string frame;
+  while (player->Step(frame))
+  {
+    stateSDF->Clear();
+    sdf::readString(frame, stateSDF);
+    times.push_back(physics::WorldState(stateSDF).GetSimTime());
+  }
+  player->Rewind();
+  return times;
+}
+
+/////////////////////////////////////////////////
+TEST_F(LogPlayPrefetcherTest, Step)
+{
+  const std::vector<common::Time> times = this->OpenLog();
+  ASSERT_GT(times.size(), 20u);
+
+  physics::LogPlayPrefetcher prefetcher(4);
+  EXPECT_EQ(prefetcher.Depth(), 4u);
+
+  // Play the whole log
+  std::shared_ptr<physics::WorldState> state;
+  for (size_t i = 0; i < times.size(); ++i)
+  {
+    ASSERT_TRUE(prefetcher.Step(1, state)) << i;
+    EXPECT_EQ(state->GetSimTime(), times[i]) << i;
+  }
+  EXPECT_FALSE(prefetcher.Step(1, state));
+
+  // Step back from the end
+  const size_t last = times.size() - 1;
+  for (size_t i = 1; i <= 10; ++i)
+  {
+    ASSERT_TRUE(prefetcher.Step(-1, state)) << i;
+    EXPECT_EQ(state->GetSimTime(), times[last - i]) << i;
+  }
+
+  // Steps within the depth and beyond it
+  ASSERT_TRUE(prefetcher.Step(3, state));
+  EXPECT_EQ(state->GetSimTime(), times[last - 7]);
+  ASSERT_TRUE(prefetcher.Step(-10, state));
+  EXPECT_EQ(state->GetSimTime(), times[last - 17]);
+  ASSERT_TRUE(prefetcher.Step(2, state));
+  EXPECT_EQ(state->GetSimTime(), times[last - 15]);
+
+  // A step past the end stops at the last state
+  ASSERT_TRUE(prefetcher.Step(100, state));
+  EXPECT_EQ(state->GetSimTime(), times[last]);
+}
+
+/////////////////////////////////////////////////
+TEST_F(LogPlayPrefetcherTest, Move)
+{
+  const std::vector<common::Time> times = this->OpenLog();
+  ASSERT_GT(times.size(), 20u);
+
+  physics::LogPlayPrefetcher prefetcher(8);
+  std::shared_ptr<physics::WorldState> state;
+  for (size_t i = 0; i < 5; ++i)
+    ASSERT_TRUE(prefetcher.Step(1, state));
+
+  // Rewind, the first state is not before the beginning
+  EXPECT_TRUE(prefetcher.Rewind());
+  ASSERT_TRUE(prefetcher.Step(1, state));
+  EXPECT_EQ(state->GetSimTime(), times[0]);
+  EXPECT_FALSE(prefetcher.Step(-1, state));
+
+  // Forward, the last state is stepped back to
+  EXPECT_TRUE(prefetcher.Forward());
+  EXPECT_FALSE(prefetcher.Step(1, state));
+  ASSERT_TRUE(prefetcher.Step(-1, state));
+  EXPECT_EQ(state->GetSimTime(), times.back());
+  ASSERT_TRUE(prefetcher.Step(-1, state));
+  EXPECT_EQ(state->GetSimTime(), times[times.size() - 2]);
+
+  // Seek to the middle of the log
+  const size_t middle = times.size() / 2;
+  EXPECT_TRUE(prefetcher.Seek(times[middle]));
+  ASSERT_TRUE(prefetcher.Step(1, state));
+  auto found = std::find(times.begin(), times.end(), state->GetSimTime());
+  ASSERT_TRUE(found != times.end());
+  const size_t index = found - times.begin();
+  EXPECT_LE(index, middle + 1);
+  EXPECT_GE(index + 1, middle);
+  ASSERT_TRUE(prefetcher.Step(1, state));
+  EXPECT_EQ(state->GetSimTime(), times[index + 1]);
+  ASSERT_TRUE(prefetcher.Step(-1, state));
+  EXPECT_EQ(state->GetSimTime(), times[index]);
+}
+
+/////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
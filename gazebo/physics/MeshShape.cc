@@ -112,6 +112,18 @@ ignition::math::Vector3d MeshShape::Size() const
   return this->sdf->Get<ignition::math::Vector3d>("scale");
 }
 
+//////////////////////////////////////////////////
+const common::Mesh *MeshShape::Mesh() const
+{
+  return this->mesh;
+}
+
+//////////////////////////////////////////////////
+const common::SubMesh *MeshShape::SubMesh() const
+{
+  return this->submesh;
+}
+
 //////////////////////////////////////////////////
 std::string MeshShape::GetMeshURI() const
 {
@@ -69,6 +69,15 @@ namespace gazebo
       /// \param[in] _scale Scaling factor.
       public: void SetScale(const ignition::math::Vector3d &_scale);
 
+      /// \brief Get the mesh data, without scaling.
+      /// \return The mesh, null if it could not be loaded.
+      public: const common::Mesh *Mesh() const;
+
+      /// \brief Get the submesh used from within the mesh, centered if the
+      /// SDF asks for it.
+      /// \return The submesh, null if the whole mesh is used.
+      public: const common::SubMesh *SubMesh() const;
+
       /// \brief Populate a msgs::Geometry message with data from this
       /// shape.
       /// \param[out] _msg Message to fill.
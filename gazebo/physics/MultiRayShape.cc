@@ -16,7 +16,10 @@
 */
 #include "gazebo/common/Exception.hh"
 #include "gazebo/msgs/msgs.hh"
+#include "gazebo/physics/Collision.hh"
 #include "gazebo/physics/MultiRayShape.hh"
+#include "gazebo/physics/RayQuery.hh"
+#include "gazebo/physics/World.hh"
 
 using namespace gazebo;
 using namespace physics;
@@ -183,7 +186,30 @@ void MultiRayShape::Update()
   }
 
   // do actual collision checks
-  this->UpdateRays();
+  WorldPtr world = this->GetWorld();
+  if (world && world->RayQuery().Enabled())
+  {
+    std::vector<RayQueryRay> queryRays(raySize);
+    for (unsigned int i = 0; i < raySize; ++i)
+    {
+      this->rays[i]->GlobalPoints(queryRays[i].start, queryRays[i].end);
+    }
+
+    RayQueryResult result;
+    world->RayQuery().Cast(queryRays, result);
+
+    for (unsigned int i = 0; i < raySize; ++i)
+    {
+      const RayQueryHit &hit = result.hits[i];
+      if (!hit.collision)
+        continue;
+      this->rays[i]->SetLength(hit.distance);
+      this->rays[i]->SetRetro(hit.retro);
+      this->rays[i]->SetCollisionName(hit.collision->GetScopedName());
+    }
+  }
+  else
+    this->UpdateRays();
 
   // for plugin
   this->newLaserScans();
@@ -33,6 +33,7 @@
 #include "gazebo/physics/World.hh"
 #include "gazebo/physics/PhysicsEngine.hh"
 #include "gazebo/physics/PresetManager.hh"
+#include "gazebo/physics/RayQuery.hh"
 
 using namespace gazebo;
 using namespace physics;
@@ -243,6 +244,19 @@ bool PhysicsEngine::SetParam(const std::string &_key,
       this->world->SetMagneticField(
           any_cast<ignition::math::Vector3d>(copy));
     }
+    else if (_key == "model_update_threads")
+    {
+      int value = any_cast<int>(_value);
+      if (value < 0)
+      {
+        gzerr << "model_update_threads must be non-negative, got "
+              << value << std::endl;
+        return false;
+      }
+      this->world->SetModelUpdateThreads(value);
+    }
+    else if (_key == "batch_ray_queries")
+      this->world->RayQuery().SetEnabled(any_cast<bool>(_value));
     else
     {
       gzwarn << "SetParam failed for [" << _key << "] in physics engine "
@@ -295,6 +309,10 @@ bool PhysicsEngine::GetParam(const std::string &_key,
     _value = this->world->Gravity();
   else if (_key == "magnetic_field")
     _value = this->world->MagneticField();
+  else if (_key == "model_update_threads")
+    _value = static_cast<int>(this->world->ModelUpdateThreads());
+  else if (_key == "batch_ray_queries")
+    _value = this->world->RayQuery().Enabled();
   else
   {
     gzwarn << "GetParam failed for [" << _key << "] in physics engine "
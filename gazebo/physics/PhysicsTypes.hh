@@ -48,6 +48,7 @@ namespace gazebo
     class JointController;
     class Contact;
     class PresetManager;
+    class RayQuery;
     class UserCmd;
     class UserCmdManager;
     class PhysicsEngine;
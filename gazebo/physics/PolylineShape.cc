@@ -96,6 +96,12 @@ double PolylineShape::GetHeight() const
   return this->sdf->Get<double>("height");
 }
 
+//////////////////////////////////////////////////
+const common::Mesh *PolylineShape::Mesh() const
+{
+  return this->mesh;
+}
+
 //////////////////////////////////////////////////
 void PolylineShape::SetScale(const ignition::math::Vector3d &_scale)
 {
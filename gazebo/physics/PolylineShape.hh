@@ -53,6 +53,10 @@ namespace gazebo
       /// \return The height of the polylines.
       public: double GetHeight() const;
 
+      /// \brief Get the mesh extruded from the polylines.
+      /// \return The mesh, null if it could not be created.
+      public: const common::Mesh *Mesh() const;
+
       /// \brief Fill in the values for a geomertry message.
       /// \param[out] _msg The geometry message to fill.
       public: void FillMsg(msgs::Geometry &_msg);
@@ -94,7 +98,7 @@ namespace gazebo
       private: virtual void SetHeight(const double &_height);
 
       /// \brief Pointer to the mesh data.
-      protected: const common::Mesh *mesh;
+      protected: const common::Mesh *mesh = nullptr;
     };
     /// \}
   }
@@ -0,0 +1,1457 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#include <tbb/parallel_for.h>
+#include <tbb/blocked_range.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <tuple>
+#include <utility>
+
+#include <ignition/math/Matrix3.hh>
+#include <ignition/math/Pose3.hh>
+
+#include "gazebo/common/Console.hh"
+#include "gazebo/common/Mesh.hh"
+#include "gazebo/physics/BoxShape.hh"
+#include "gazebo/physics/Collision.hh"
+#include "gazebo/physics/CylinderShape.hh"
+#include "gazebo/physics/HeightmapShape.hh"
+#include "gazebo/physics/Link.hh"
+#include "gazebo/physics/MeshShape.hh"
+#include "gazebo/physics/Model.hh"
+#include "gazebo/physics/PhysicsEngine.hh"
+#include "gazebo/physics/PlaneShape.hh"
+#include "gazebo/physics/PolylineShape.hh"
+#include "gazebo/physics/SphereShape.hh"
+#include "gazebo/physics/World.hh"
+#include "gazebo/physics/RayQuery.hh"
+
+using namespace gazebo;
+using namespace physics;
+
+namespace
+{
+  /// \brief Number of rays traced together.
+  const int kLanes = 4;
+
+  /// \brief Maximum number of primitives in a leaf of a hierarchy.
+  const unsigned int kLeafSize = 4;
+
+  /// \brief Inverse direction used for axes the ray is parallel to. It
+  /// is finite so the slab test never computes 0 * inf.
+  const float kParallel = 1e30f;
+
+  /// \brief Axis aligned bounds in double precision.
+  struct Bounds
+  {
+    /// \brief Minimum corner.
+    double min[3];
+
+    /// \brief Maximum corner.
+    double max[3];
+  };
+
+  /// \brief Node of a bounding volume hierarchy. The two children of an
+  /// inner node are stored next to each other.
+  struct BVHNode
+  {
+    /// \brief Minimum corner, rounded outwards to float.
+    float min[3];
+
+    /// \brief Maximum corner, rounded outwards to float.
+    float max[3];
+
+    /// \brief First child of an inner node, or first primitive of a leaf.
+    uint32_t index;
+
+    /// \brief Number of primitives of a leaf, zero for inner nodes.
+    uint16_t count;
+
+    /// \brief Axis the primitives of an inner node were split along.
+    uint16_t axis;
+  };
+
+  /// \brief Bounding volume hierarchy over a set of primitives, built by
+  /// splitting at the median centroid along the longest axis.
+  class BVH
+  {
+    /// \brief Build the hierarchy.
+    /// \param[in] _bounds Bounds of every primitive.
+    public: void Build(const std::vector<Bounds> &_bounds)
+    {
+      this->nodes.clear();
+      this->prims.resize(_bounds.size());
+      if (_bounds.empty())
+        return;
+
+      for (uint32_t i = 0; i < this->prims.size(); ++i)
+        this->prims[i] = i;
+
+      this->nodes.reserve(2 * _bounds.size());
+      this->nodes.emplace_back();
+      this->BuildNode(_bounds, 0, 0, static_cast<uint32_t>(_bounds.size()));
+    }
+
+    /// \brief Build a node and its children.
+    /// \param[in] _bounds Bounds of every primitive.
+    /// \param[in] _node Index of the node.
+    /// \param[in] _begin First primitive of the node.
+    /// \param[in] _end One past the last primitive of the node.
+    private: void BuildNode(const std::vector<Bounds> &_bounds,
+                 const uint32_t _node, const uint32_t _begin,
+                 const uint32_t _end)
+    {
+      Bounds box;
+      Bounds centers;
+      for (int a = 0; a < 3; ++a)
+      {
+        box.min[a] = centers.min[a] = std::numeric_limits<double>::max();
+        box.max[a] = centers.max[a] = -std::numeric_limits<double>::max();
+      }
+      for (uint32_t i = _begin; i < _end; ++i)
+      {
+        const Bounds &b = _bounds[this->prims[i]];
+        for (int a = 0; a < 3; ++a)
+        {
+          box.min[a] = std::min(box.min[a], b.min[a]);
+          box.max[a] = std::max(box.max[a], b.max[a]);
+          const double c = 0.5 * (b.min[a] + b.max[a]);
+          centers.min[a] = std::min(centers.min[a], c);
+          centers.max[a] = std::max(centers.max[a], c);
+        }
+      }
+
+      BVHNode &node = this->nodes[_node];
+      for (int a = 0; a < 3; ++a)
+      {
+        // float bounds must contain the double bounds, and are padded so
+        // the float slab test never misses a primitive it grazes
+        const double pad = 1e-5 *
+            (std::max(std::abs(box.min[a]), std::abs(box.max[a])) + 1.0);
+        node.min[a] = static_cast<float>(box.min[a] - pad);
+        node.max[a] = static_cast<float>(box.max[a] + pad);
+      }
+
+      const uint32_t count = _end - _begin;
+      if (count <= kLeafSize)
+      {
+        node.index = _begin;
+        node.count = static_cast<uint16_t>(count);
+        node.axis = 0;
+        return;
+      }
+
+      int axis = 0;
+      for (int a = 1; a < 3; ++a)
+      {
+        if (centers.max[a] - centers.min[a] >
+            centers.max[axis] - centers.min[axis])
+        {
+          axis = a;
+        }
+      }
+
+      const uint32_t mid = _begin + count / 2;
+      std::nth_element(this->prims.begin() + _begin,
+          this->prims.begin() + mid, this->prims.begin() + _end,
+          [&_bounds, axis](const uint32_t _a, const uint32_t _b)
+          {
+            return _bounds[_a].min[axis] + _bounds[_a].max[axis] <
+                   _bounds[_b].min[axis] + _bounds[_b].max[axis];
+          });
+
+      const uint32_t child = static_cast<uint32_t>(this->nodes.size());
+      node.index = child;
+      node.count = 0;
+      node.axis = static_cast<uint16_t>(axis);
+
+      // node is invalidated by the emplace_back calls
+      this->nodes.emplace_back();
+      this->nodes.emplace_back();
+      this->BuildNode(_bounds, child, _begin, mid);
+      this->BuildNode(_bounds, child + 1, mid, _end);
+    }
+
+    /// \brief Nodes, the root first.
+    public: std::vector<BVHNode> nodes;
+
+    /// \brief Primitive indices in leaf order.
+    public: std::vector<uint32_t> prims;
+  };
+
+  struct SceneTarget;
+
+  /// \brief Rays traced together, in structure of arrays layout so the
+  /// node tests of all lanes compile to vector instructions.
+  struct RayPacket
+  {
+    /// \brief Set up lane _i.
+    /// \param[in] _i Lane.
+    /// \param[in] _origin Start of the ray.
+    /// \param[in] _dir Unit direction of the ray.
+    /// \param[in] _length Length of the ray.
+    void Set(const int _i, const ignition::math::Vector3d &_origin,
+        const ignition::math::Vector3d &_dir, const double _length)
+    {
+      for (int a = 0; a < 3; ++a)
+      {
+        this->origin[a][_i] = _origin[a];
+        this->dir[a][_i] = _dir[a];
+        this->o[a][_i] = static_cast<float>(_origin[a]);
+        this->inv[a][_i] = std::abs(_dir[a]) > 1e-30 ?
+            static_cast<float>(1.0 / _dir[a]) :
+            (std::signbit(_dir[a]) ? -kParallel : kParallel);
+      }
+      this->hit[_i] = nullptr;
+      this->Shorten(_i, _length);
+    }
+
+    /// \brief Disable lane _i.
+    /// \param[in] _i Lane.
+    void Clear(const int _i)
+    {
+      for (int a = 0; a < 3; ++a)
+      {
+        this->origin[a][_i] = this->dir[a][_i] = 0;
+        this->o[a][_i] = 0;
+        this->inv[a][_i] = kParallel;
+      }
+      this->best[_i] = -1;
+      this->tmax[_i] = -1;
+      this->hit[_i] = nullptr;
+    }
+
+    /// \brief Set the distance a lane still has to search.
+    /// \param[in] _i Lane.
+    /// \param[in] _t Distance of the closest hit so far.
+    void Shorten(const int _i, const double _t)
+    {
+      this->best[_i] = _t;
+      this->tmax[_i] = std::nextafter(static_cast<float>(_t),
+          std::numeric_limits<float>::max());
+    }
+
+    /// \brief Lanes whose ray intersect a node.
+    /// \param[in] _node The node.
+    /// \return Bit i is set if lane i intersects the node.
+    int Test(const BVHNode &_node) const
+    {
+      int mask = 0;
+      for (int i = 0; i < kLanes; ++i)
+      {
+        const float x0 = (_node.min[0] - this->o[0][i]) * this->inv[0][i];
+        const float x1 = (_node.max[0] - this->o[0][i]) * this->inv[0][i];
+        const float y0 = (_node.min[1] - this->o[1][i]) * this->inv[1][i];
+        const float y1 = (_node.max[1] - this->o[1][i]) * this->inv[1][i];
+        const float z0 = (_node.min[2] - this->o[2][i]) * this->inv[2][i];
+        const float z1 = (_node.max[2] - this->o[2][i]) * this->inv[2][i];
+        const float tNear = std::max(
+            std::max(std::min(x0, x1), std::min(y0, y1)),
+            std::max(std::min(z0, z1), 0.0f));
+        const float tFar = std::min(
+            std::min(std::max(x0, x1), std::max(y0, y1)),
+            std::min(std::max(z0, z1), this->tmax[i]));
+        mask |= static_cast<int>(tNear <= tFar) << i;
+      }
+      return mask;
+    }
+
+    /// \brief Start of the rays.
+    double origin[3][kLanes];
+
+    /// \brief Unit direction of the rays.
+    double dir[3][kLanes];
+
+    /// \brief Distance of the closest hit, or the ray length, negative
+    /// for disabled lanes.
+    double best[kLanes];
+
+    /// \brief Start of the rays, for node tests.
+    float o[3][kLanes];
+
+    /// \brief Inverse direction of the rays, for node tests.
+    float inv[3][kLanes];
+
+    /// \brief best rounded up, for node tests.
+    float tmax[kLanes];
+
+    /// \brief Closest collision hit by each lane.
+    const SceneTarget *hit[kLanes];
+  };
+
+  /// \brief Trace a packet through a hierarchy.
+  /// \param[in] _bvh The hierarchy.
+  /// \param[in,out] _packet Rays, shortened by the hits.
+  /// \param[in] _leaf Called with a primitive and the lanes that reach
+  /// its leaf, tests them and shortens the lanes that hit it.
+  template<typename LeafFunc>
+  void Traverse(const BVH &_bvh, RayPacket &_packet, LeafFunc _leaf)
+  {
+    if (_bvh.nodes.empty())
+      return;
+
+    uint32_t stack[64];
+    int top = 0;
+    stack[top++] = 0;
+    while (top > 0)
+    {
+      const BVHNode &node = _bvh.nodes[stack[--top]];
+      const int mask = _packet.Test(node);
+      if (!mask)
+        continue;
+
+      if (node.count > 0)
+      {
+        for (uint32_t i = node.index; i < node.index + node.count; ++i)
+          _leaf(_bvh.prims[i], mask);
+        continue;
+      }
+
+      // visit the near child first, as seen by the first active lane, so
+      // far children are often culled by the hits of near ones
+      int lane = 0;
+      while (!(mask & (1 << lane)))
+        ++lane;
+      const bool negative = _packet.dir[node.axis][lane] < 0;
+      stack[top++] = node.index + (negative ? 0 : 1);
+      stack[top++] = node.index + (negative ? 1 : 0);
+    }
+  }
+
+  /// \brief Intersect a ray with a triangle, from both sides.
+  /// \param[in] _v0 First vertex.
+  /// \param[in] _v1 Second vertex.
+  /// \param[in] _v2 Third vertex.
+  /// \param[in] _o Ray start.
+  /// \param[in] _d Ray direction.
+  /// \return Distance to the hit, negative on a miss.
+  double IntersectTriangle(const double _v0[3], const double _v1[3],
+      const double _v2[3], const double _o[3], const double _d[3])
+  {
+    double e1[3], e2[3], s[3];
+    for (int a = 0; a < 3; ++a)
+    {
+      e1[a] = _v1[a] - _v0[a];
+      e2[a] = _v2[a] - _v0[a];
+      s[a] = _o[a] - _v0[a];
+    }
+
+    const double p[3] = {_d[1] * e2[2] - _d[2] * e2[1],
+                         _d[2] * e2[0] - _d[0] * e2[2],
+                         _d[0] * e2[1] - _d[1] * e2[0]};
+    const double det = e1[0] * p[0] + e1[1] * p[1] + e1[2] * p[2];
+    if (std::abs(det) < 1e-30)
+      return -1;
+    const double invDet = 1.0 / det;
+
+    const double u = (s[0] * p[0] + s[1] * p[1] + s[2] * p[2]) * invDet;
+    if (u < 0 || u > 1)
+      return -1;
+
+    const double q[3] = {s[1] * e1[2] - s[2] * e1[1],
+                         s[2] * e1[0] - s[0] * e1[2],
+                         s[0] * e1[1] - s[1] * e1[0]};
+    const double v = (_d[0] * q[0] + _d[1] * q[1] + _d[2] * q[2]) * invDet;
+    if (v < 0 || u + v > 1)
+      return -1;
+
+    return (e2[0] * q[0] + e2[1] * q[1] + e2[2] * q[2]) * invDet;
+  }
+
+  /// \brief Triangles of a mesh or polyline in the frame of their
+  /// collision, with scaling applied.
+  class TriangleMesh
+  {
+    /// \brief Build the hierarchy and the bounds over the triangles.
+    public: void Build()
+    {
+      std::vector<Bounds> triangles(this->indices.size() / 3);
+      for (int a = 0; a < 3; ++a)
+      {
+        this->bounds.min[a] = std::numeric_limits<double>::max();
+        this->bounds.max[a] = -std::numeric_limits<double>::max();
+      }
+      for (size_t t = 0; t < triangles.size(); ++t)
+      {
+        Bounds &b = triangles[t];
+        for (int a = 0; a < 3; ++a)
+        {
+          b.min[a] = std::numeric_limits<double>::max();
+          b.max[a] = -std::numeric_limits<double>::max();
+        }
+        for (int k = 0; k < 3; ++k)
+        {
+          const float *v = &this->vertices[this->indices[t * 3 + k] * 3];
+          for (int a = 0; a < 3; ++a)
+          {
+            b.min[a] = std::min(b.min[a], static_cast<double>(v[a]));
+            b.max[a] = std::max(b.max[a], static_cast<double>(v[a]));
+          }
+        }
+        for (int a = 0; a < 3; ++a)
+        {
+          this->bounds.min[a] = std::min(this->bounds.min[a], b.min[a]);
+          this->bounds.max[a] = std::max(this->bounds.max[a], b.max[a]);
+        }
+      }
+      this->bvh.Build(triangles);
+    }
+
+    /// \brief Intersect a ray with a triangle, from both sides.
+    /// \param[in] _t Triangle index.
+    /// \param[in] _o Ray start.
+    /// \param[in] _d Ray direction.
+    /// \return Distance to the hit, negative on a miss.
+    public: double Intersect(const uint32_t _t, const double _o[3],
+                const double _d[3]) const
+    {
+      double v[3][3];
+      for (int k = 0; k < 3; ++k)
+      {
+        const float *vertex = &this->vertices[this->indices[_t * 3 + k] * 3];
+        for (int a = 0; a < 3; ++a)
+          v[k][a] = vertex[a];
+      }
+      return IntersectTriangle(v[0], v[1], v[2], _o, _d);
+    }
+
+    /// \brief Vertex coordinates, three per vertex.
+    public: std::vector<float> vertices;
+
+    /// \brief Vertex indices, three per triangle.
+    public: std::vector<uint32_t> indices;
+
+    /// \brief Hierarchy over the triangles.
+    public: BVH bvh;
+
+    /// \brief Bounds of the triangles.
+    public: Bounds bounds;
+  };
+
+  /// \brief Copy the triangles of a mesh or submesh.
+  /// \param[in] _mesh The mesh or submesh.
+  /// \param[in] _scale Scaling factor.
+  /// \param[out] _triangles Triangles to fill.
+  template<typename T>
+  void CopyTriangles(const T *_mesh, const ignition::math::Vector3d &_scale,
+      TriangleMesh &_triangles)
+  {
+    float *vertices = nullptr;
+    int *indices = nullptr;
+    _mesh->FillArrays(&vertices, &indices);
+
+    const unsigned int vertexCount = _mesh->GetVertexCount();
+    _triangles.vertices.resize(vertexCount * 3);
+    for (unsigned int i = 0; i < vertexCount; ++i)
+    {
+      for (int a = 0; a < 3; ++a)
+      {
+        _triangles.vertices[i * 3 + a] =
+            static_cast<float>(vertices[i * 3 + a] * _scale[a]);
+      }
+    }
+
+    // a trailing partial triangle is dropped
+    const unsigned int indexCount = _mesh->GetIndexCount() / 3 * 3;
+    _triangles.indices.resize(indexCount);
+    for (unsigned int i = 0; i < indexCount; ++i)
+      _triangles.indices[i] = static_cast<uint32_t>(indices[i]);
+
+    delete [] vertices;
+    delete [] indices;
+  }
+
+  /// \brief Type of a SceneObject.
+  enum class ObjectType
+  {
+    /// \brief Box with half sizes in SceneObject::size.
+    BOX,
+
+    /// \brief Sphere with the radius in SceneObject::size.X().
+    SPHERE,
+
+    /// \brief Cylinder along Z, with the radius in SceneObject::size.X()
+    /// and the half length in SceneObject::size.Y().
+    CYLINDER,
+
+    /// \brief Triangles in SceneObject::mesh.
+    MESH,
+
+    /// \brief Heightmap in SceneObject::heightmap, with the half sizes in
+    /// SceneObject::size.X() and Y() and the height offset in
+    /// SceneObject::size.Z().
+    HEIGHTMAP
+  };
+
+  /// \brief Collision a ray can hit.
+  struct SceneTarget
+  {
+    /// \brief Laser retro value of the collision.
+    double retro;
+
+    /// \brief The collision.
+    CollisionPtr collision;
+
+    /// \brief Link of the collision, only compared with the link a batch
+    /// excludes.
+    const Link *link = nullptr;
+  };
+
+  /// \brief A collision copied into the scene.
+  struct SceneObject : public SceneTarget
+  {
+    /// \brief Shape of the collision.
+    ObjectType type;
+
+    /// \brief Transpose of the world rotation of the collision.
+    ignition::math::Matrix3d toLocal;
+
+    /// \brief World position of the collision.
+    ignition::math::Vector3d pos;
+
+    /// \brief Shape dimensions, see ObjectType.
+    ignition::math::Vector3d size;
+
+    /// \brief Triangles of a mesh object.
+    std::shared_ptr<const TriangleMesh> mesh;
+
+    /// \brief Shape of a heightmap object.
+    HeightmapShapePtr heightmap;
+
+    /// \brief Number of vertices along each side of a heightmap object.
+    int vertexCount = 0;
+
+    /// \brief Lowest height of a heightmap object, offset included.
+    double minZ = 0;
+
+    /// \brief Highest height of a heightmap object, offset included.
+    double maxZ = 0;
+  };
+
+  /// \brief An infinite plane copied into the scene.
+  struct ScenePlane : public SceneTarget
+  {
+    /// \brief Unit normal in the world frame.
+    ignition::math::Vector3d normal;
+
+    /// \brief Distance of the plane from the origin along the normal.
+    double offset;
+  };
+
+  /// \brief Collisions of the scene that are rebuilt together.
+  struct SceneLayer
+  {
+    /// \brief Objects in the hierarchy.
+    std::vector<SceneObject> objects;
+
+    /// \brief Planes, which have no bounds and are tested by every ray.
+    std::vector<ScenePlane> planes;
+
+    /// \brief Hierarchy over objects.
+    BVH bvh;
+
+    /// \brief Collisions the layer was built from and their world poses.
+    std::vector<std::pair<const Collision *, ignition::math::Pose3d>>
+        sources;
+
+    /// \brief Version of the layer, different for every layer built.
+    uint64_t version = 0;
+  };
+
+  /// \brief Intersect a ray with a convex object in its local frame.
+  /// A ray that starts inside the object hits it where it leaves.
+  /// \param[in] _object The object.
+  /// \param[in] _o Ray start in the frame of the object.
+  /// \param[in] _d Ray direction in the frame of the object.
+  /// \return Distance to the hit, negative on a miss.
+  double IntersectConvex(const SceneObject &_object,
+      const ignition::math::Vector3d &_o, const ignition::math::Vector3d &_d)
+  {
+    double lo = -std::numeric_limits<double>::max();
+    double hi = std::numeric_limits<double>::max();
+
+    switch (_object.type)
+    {
+      case ObjectType::BOX:
+      {
+        for (int a = 0; a < 3; ++a)
+        {
+          const double h = _object.size[a];
+          if (std::abs(_d[a]) < 1e-12)
+          {
+            if (_o[a] < -h || _o[a] > h)
+              return -1;
+            continue;
+          }
+          double t0 = (-h - _o[a]) / _d[a];
+          double t1 = (h - _o[a]) / _d[a];
+          if (t0 > t1)
+            std::swap(t0, t1);
+          lo = std::max(lo, t0);
+          hi = std::min(hi, t1);
+        }
+        break;
+      }
+      case ObjectType::SPHERE:
+      {
+        const double r = _object.size.X();
+        const double b = _o.Dot(_d);
+        const double c = _o.SquaredLength() - r * r;
+        const double k = b * b - c;
+        if (k < 0)
+          return -1;
+        const double s = std::sqrt(k);
+        lo = -b - s;
+        hi = -b + s;
+        break;
+      }
+      case ObjectType::CYLINDER:
+      {
+        const double r = _object.size.X();
+        const double h = _object.size.Y();
+        if (std::abs(_d.Z()) < 1e-12)
+        {
+          if (_o.Z() < -h || _o.Z() > h)
+            return -1;
+        }
+        else
+        {
+          double t0 = (-h - _o.Z()) / _d.Z();
+          double t1 = (h - _o.Z()) / _d.Z();
+          if (t0 > t1)
+            std::swap(t0, t1);
+          lo = t0;
+          hi = t1;
+        }
+
+        const double a = _d.X() * _d.X() + _d.Y() * _d.Y();
+        const double b = _o.X() * _d.X() + _o.Y() * _d.Y();
+        const double c = _o.X() * _o.X() + _o.Y() * _o.Y() - r * r;
+        if (a < 1e-24)
+        {
+          if (c > 0)
+            return -1;
+        }
+        else
+        {
+          const double k = b * b - a * c;
+          if (k < 0)
+            return -1;
+          const double s = std::sqrt(k);
+          lo = std::max(lo, (-b - s) / a);
+          hi = std::min(hi, (-b + s) / a);
+        }
+        break;
+      }
+      default:
+        return -1;
+    }
+
+    if (lo > hi)
+      return -1;
+    return lo >= 0 ? lo : hi;
+  }
+
+  /// \brief Intersect a ray with a heightmap in its local frame. Only
+  /// the cells the ray crosses are tested, nearest first, so a ray reads
+  /// the heights under it and never the whole heightmap.
+  /// \param[in] _object The heightmap object.
+  /// \param[in] _o Ray start in the frame of the object.
+  /// \param[in] _d Ray direction in the frame of the object.
+  /// \param[in] _length Distance searched along the ray.
+  /// \return Distance to the hit, negative on a miss.
+  double IntersectHeightmap(const SceneObject &_object,
+      const ignition::math::Vector3d &_o, const ignition::math::Vector3d &_d,
+      const double _length)
+  {
+    // Same layout as the heightfields of the physics engines: columns
+    // along X, rows along -Y, centered on the collision. The ray is
+    // walked in cell coordinates, where vertex (x, y) is at (x, y).
+    const int last = _object.vertexCount - 1;
+    const double dx = 2.0 * _object.size.X() / last;
+    const double dy = 2.0 * _object.size.Y() / last;
+    const double o[3] = {(_o.X() + _object.size.X()) / dx,
+                         (_object.size.Y() - _o.Y()) / dy, _o.Z()};
+    const double d[3] = {_d.X() / dx, -_d.Y() / dy, _d.Z()};
+    const double lo[3] = {0, 0, _object.minZ};
+    const double hi[3] = {static_cast<double>(last),
+                          static_cast<double>(last), _object.maxZ};
+
+    // clip the ray to the bounds of the heightmap
+    double tEnter = 0;
+    double tExit = _length;
+    for (int a = 0; a < 3; ++a)
+    {
+      if (std::abs(d[a]) < 1e-12)
+      {
+        if (o[a] < lo[a] || o[a] > hi[a])
+          return -1;
+        continue;
+      }
+      double t0 = (lo[a] - o[a]) / d[a];
+      double t1 = (hi[a] - o[a]) / d[a];
+      if (t0 > t1)
+        std::swap(t0, t1);
+      tEnter = std::max(tEnter, t0);
+      tExit = std::min(tExit, t1);
+    }
+    if (tEnter > tExit)
+      return -1;
+
+    int cell[2];
+    int step[2];
+    double tNext[2];
+    double tDelta[2];
+    for (int a = 0; a < 2; ++a)
+    {
+      cell[a] = std::min(std::max(static_cast<int>(
+          std::floor(o[a] + tEnter * d[a])), 0), last - 1);
+      step[a] = d[a] < 0 ? -1 : 1;
+      if (std::abs(d[a]) < 1e-12)
+      {
+        tNext[a] = tDelta[a] = std::numeric_limits<double>::max();
+        continue;
+      }
+      tNext[a] = (cell[a] + (d[a] < 0 ? 0 : 1) - o[a]) / d[a];
+      tDelta[a] = 1.0 / std::abs(d[a]);
+    }
+
+    const double origin[3] = {_o.X(), _o.Y(), _o.Z()};
+    const double dir[3] = {_d.X(), _d.Y(), _d.Z()};
+    const HeightmapShape &heightmap = *_object.heightmap;
+    while (true)
+    {
+      // corners of the cell, split into triangles like the meshes of the
+      // physics engines
+      double v[4][3];
+      for (int k = 0; k < 4; ++k)
+      {
+        const int x = cell[0] + (k & 1);
+        const int y = cell[1] + (k >> 1);
+        v[k][0] = x * dx - _object.size.X();
+        v[k][1] = _object.size.Y() - y * dy;
+        v[k][2] = heightmap.GetHeight(x, y) + _object.size.Z();
+      }
+
+      double best = -1;
+      for (const double t : {IntersectTriangle(v[0], v[1], v[2], origin, dir),
+                             IntersectTriangle(v[1], v[3], v[2], origin, dir)})
+      {
+        if (t >= 0 && (best < 0 || t < best))
+          best = t;
+      }
+      if (best >= 0)
+        return best;
+
+      const int a = tNext[0] < tNext[1] ? 0 : 1;
+      if (tNext[a] > tExit)
+        return -1;
+      cell[a] += step[a];
+      if (cell[a] < 0 || cell[a] >= last)
+        return -1;
+      tNext[a] += tDelta[a];
+    }
+  }
+
+  /// \brief Trace a packet through a layer.
+  /// \param[in] _layer The layer.
+  /// \param[in,out] _packet Rays, shortened by the hits.
+  /// \param[in] _exclude Link whose collisions are not hit, or null.
+  void TraceLayer(const SceneLayer &_layer, RayPacket &_packet,
+      const Link *_exclude)
+  {
+    Traverse(_layer.bvh, _packet,
+        [&_layer, &_packet, _exclude](const uint32_t _index, const int _mask)
+    {
+      const SceneObject &object = _layer.objects[_index];
+      if (_exclude && object.link == _exclude)
+        return;
+
+      if (object.type != ObjectType::MESH)
+      {
+        for (int i = 0; i < kLanes; ++i)
+        {
+          if (!(_mask & (1 << i)))
+            continue;
+          const ignition::math::Vector3d o = object.toLocal *
+              (ignition::math::Vector3d(_packet.origin[0][i],
+                _packet.origin[1][i], _packet.origin[2][i]) - object.pos);
+          const ignition::math::Vector3d d = object.toLocal *
+              ignition::math::Vector3d(_packet.dir[0][i],
+                _packet.dir[1][i], _packet.dir[2][i]);
+          const double t = object.type == ObjectType::HEIGHTMAP ?
+              IntersectHeightmap(object, o, d, _packet.best[i]) :
+              IntersectConvex(object, o, d);
+          if (t >= 0 && t <= _packet.best[i] &&
+              (t < _packet.best[i] || !_packet.hit[i]))
+          {
+            _packet.Shorten(i, t);
+            _packet.hit[i] = &object;
+          }
+        }
+        return;
+      }
+
+      // trace the lanes that reach the object through its triangles, in
+      // the frame of the object
+      RayPacket local;
+      for (int i = 0; i < kLanes; ++i)
+      {
+        if (!(_mask & (1 << i)))
+        {
+          local.Clear(i);
+          continue;
+        }
+        const ignition::math::Vector3d o = object.toLocal *
+            (ignition::math::Vector3d(_packet.origin[0][i],
+              _packet.origin[1][i], _packet.origin[2][i]) - object.pos);
+        const ignition::math::Vector3d d = object.toLocal *
+            ignition::math::Vector3d(_packet.dir[0][i],
+              _packet.dir[1][i], _packet.dir[2][i]);
+        local.Set(i, o, d, _packet.best[i]);
+      }
+
+      const TriangleMesh &mesh = *object.mesh;
+      Traverse(mesh.bvh, local,
+          [&mesh, &local, &object](const uint32_t _triangle,
+            const int _lanes)
+      {
+        for (int i = 0; i < kLanes; ++i)
+        {
+          if (!(_lanes & (1 << i)))
+            continue;
+          const double o[3] = {local.origin[0][i], local.origin[1][i],
+                               local.origin[2][i]};
+          const double d[3] = {local.dir[0][i], local.dir[1][i],
+                               local.dir[2][i]};
+          const double t = mesh.Intersect(_triangle, o, d);
+          if (t >= 0 && t <= local.best[i] &&
+              (t < local.best[i] || !local.hit[i]))
+          {
+            local.Shorten(i, t);
+            local.hit[i] = &object;
+          }
+        }
+      });
+
+      for (int i = 0; i < kLanes; ++i)
+      {
+        if (local.hit[i] && (local.best[i] < _packet.best[i] ||
+            !_packet.hit[i]))
+        {
+          _packet.Shorten(i, local.best[i]);
+          _packet.hit[i] = &object;
+        }
+      }
+    });
+
+    for (auto const &plane : _layer.planes)
+    {
+      if (_exclude && plane.link == _exclude)
+        continue;
+
+      for (int i = 0; i < kLanes; ++i)
+      {
+        if (_packet.best[i] < 0)
+          continue;
+        const double k = plane.normal.X() * _packet.dir[0][i] +
+                         plane.normal.Y() * _packet.dir[1][i] +
+                         plane.normal.Z() * _packet.dir[2][i];
+        if (std::abs(k) < 1e-12)
+          continue;
+        const double t = (plane.offset -
+            plane.normal.X() * _packet.origin[0][i] -
+            plane.normal.Y() * _packet.origin[1][i] -
+            plane.normal.Z() * _packet.origin[2][i]) / k;
+        if (t >= 0 && t <= _packet.best[i] &&
+            (t < _packet.best[i] || !_packet.hit[i]))
+        {
+          _packet.Shorten(i, t);
+          _packet.hit[i] = &plane;
+        }
+      }
+    }
+  }
+
+  /// \brief Layers the rays of a batch are cast against.
+  struct Scene
+  {
+    /// \brief World iteration the scene was built at.
+    uint32_t iterations = 0;
+
+    /// \brief Static collisions, shared between scenes while they stay
+    /// in place.
+    std::shared_ptr<const SceneLayer> staticLayer;
+
+    /// \brief Other collisions.
+    std::shared_ptr<const SceneLayer> dynamicLayer;
+  };
+
+  /// \brief Key of the triangle cache: mesh key and scale.
+  using MeshKey = std::tuple<std::string, double, double, double>;
+}
+
+namespace gazebo
+{
+  namespace physics
+  {
+    /// \internal
+    /// \brief Private data for RayQuery.
+    class RayQueryPrivate
+    {
+      /// \brief Constructor.
+      /// \param[in] _world Reference to the world.
+      public: explicit RayQueryPrivate(physics::World &_world)
+              : world(_world)
+              {
+              }
+
+      /// \brief Get a scene that reflects the current world iteration,
+      /// building it if needed.
+      /// \return The scene.
+      public: std::shared_ptr<const Scene> CurrentScene();
+
+      /// \brief Add the collisions of a model and its nested models that
+      /// rays can hit.
+      /// \param[in] _model The model.
+      /// \param[out] _static Static collisions.
+      /// \param[out] _dynamic Other collisions.
+      public: void Collect(const ModelPtr &_model,
+                  std::vector<CollisionPtr> &_static,
+                  std::vector<CollisionPtr> &_dynamic);
+
+      /// \brief Get whether a layer was built from collisions that are
+      /// still at the same poses.
+      /// \param[in] _layer The layer, may be null.
+      /// \param[in] _collisions Collisions of the layer.
+      /// \param[in] _poses World pose of every collision.
+      /// \return True if the layer can be reused.
+      public: static bool Unchanged(
+                  const std::shared_ptr<const SceneLayer> &_layer,
+                  const std::vector<CollisionPtr> &_collisions,
+                  const std::vector<ignition::math::Pose3d> &_poses);
+
+      /// \brief Build a layer.
+      /// \param[in] _collisions Collisions of the layer.
+      /// \param[in] _poses World pose of every collision.
+      /// \return The layer.
+      public: std::shared_ptr<SceneLayer> BuildLayer(
+                  const std::vector<CollisionPtr> &_collisions,
+                  const std::vector<ignition::math::Pose3d> &_poses);
+
+      /// \brief Copy a collision into a layer.
+      /// \param[in] _collision The collision.
+      /// \param[in] _pose World pose of the collision.
+      /// \param[in,out] _layer The layer.
+      public: void AddCollision(const CollisionPtr &_collision,
+                  const ignition::math::Pose3d &_pose, SceneLayer &_layer);
+
+      /// \brief Get the triangles of a mesh or polyline shape,
+      /// from the cache if another collision uses them.
+      /// \param[in] _shape The shape.
+      /// \return The triangles, null if the shape has none.
+      public: std::shared_ptr<const TriangleMesh> Triangles(
+                  const ShapePtr &_shape);
+
+      /// \brief The world.
+      public: physics::World &world;
+
+      /// \brief True if ray sensors use batched queries.
+      public: bool enabled = false;
+
+      /// \brief Returns true if rays can hit a collision.
+      public: std::function<bool(const Collision &)> filter;
+
+      /// \brief Protects scene, the layers, meshes and unsupported.
+      public: std::mutex mutex;
+
+      /// \brief Latest scene.
+      public: std::shared_ptr<const Scene> scene;
+
+      /// \brief Latest static layer.
+      public: std::shared_ptr<const SceneLayer> staticLayer;
+
+      /// \brief Latest layer of the other collisions.
+      public: std::shared_ptr<const SceneLayer> dynamicLayer;
+
+      /// \brief Version of the last layer built.
+      public: uint64_t version = 0;
+
+      /// \brief Triangles shared between collisions that use the same
+      /// mesh and scale.
+      public: std::map<MeshKey, std::weak_ptr<const TriangleMesh>> meshes;
+
+      /// \brief Collisions with a shape that rays can not hit, which have
+      /// already been reported.
+      public: std::set<std::string> unsupported;
+    };
+  }
+}
+
+//////////////////////////////////////////////////
+std::shared_ptr<const Scene> RayQueryPrivate::CurrentScene()
+{
+  {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    if (this->scene && this->scene->iterations == this->world.Iterations() &&
+        !this->world.IsPaused())
+    {
+      return this->scene;
+    }
+  }
+
+  // Collisions are read under the physics update mutex, which is locked
+  // before the query mutex, as it is when the physics thread casts rays.
+  PhysicsEnginePtr physics = this->world.Physics();
+  boost::recursive_mutex::scoped_lock physicsLock(
+      *physics->GetPhysicsUpdateMutex());
+  std::lock_guard<std::mutex> lock(this->mutex);
+
+  const uint32_t iterations = this->world.Iterations();
+  if (this->scene && this->scene->iterations == iterations &&
+      !this->world.IsPaused())
+  {
+    return this->scene;
+  }
+
+  std::vector<CollisionPtr> staticCollisions;
+  std::vector<CollisionPtr> dynamicCollisions;
+  for (auto const &model : this->world.Models())
+    this->Collect(model, staticCollisions, dynamicCollisions);
+
+  std::vector<ignition::math::Pose3d> staticPoses;
+  staticPoses.reserve(staticCollisions.size());
+  for (auto const &collision : staticCollisions)
+    staticPoses.push_back(collision->WorldPose());
+
+  // The static layer is reused until a static collision is added,
+  // removed or moved.
+  if (!Unchanged(this->staticLayer, staticCollisions, staticPoses))
+    this->staticLayer = this->BuildLayer(staticCollisions, staticPoses);
+
+  std::vector<ignition::math::Pose3d> dynamicPoses;
+  dynamicPoses.reserve(dynamicCollisions.size());
+  for (auto const &collision : dynamicCollisions)
+    dynamicPoses.push_back(collision->WorldPose());
+
+  // So is the other layer while every collision is at rest
+  if (!Unchanged(this->dynamicLayer, dynamicCollisions, dynamicPoses))
+    this->dynamicLayer = this->BuildLayer(dynamicCollisions, dynamicPoses);
+
+  std::shared_ptr<Scene> newScene(new Scene);
+  newScene->iterations = iterations;
+  newScene->staticLayer = this->staticLayer;
+  newScene->dynamicLayer = this->dynamicLayer;
+  this->scene = newScene;
+
+  // Drop the triangles no layer uses anymore
+  for (auto iter = this->meshes.begin(); iter != this->meshes.end();)
+  {
+    if (iter->second.expired())
+      iter = this->meshes.erase(iter);
+    else
+      ++iter;
+  }
+
+  return this->scene;
+}
+
+//////////////////////////////////////////////////
+void RayQueryPrivate::Collect(const ModelPtr &_model,
+    std::vector<CollisionPtr> &_static, std::vector<CollisionPtr> &_dynamic)
+{
+  for (auto const &link : _model->GetLinks())
+  {
+    for (auto const &collision : link->GetCollisions())
+    {
+      if (!collision || collision->HasType(Base::SENSOR_COLLISION))
+        continue;
+
+      ShapePtr shape = collision->GetShape();
+      if (!shape || shape->HasType(Base::RAY_SHAPE) ||
+          shape->HasType(Base::MULTIRAY_SHAPE))
+      {
+        continue;
+      }
+
+      if (this->filter && !this->filter(*collision))
+        continue;
+
+      if (collision->IsStatic())
+        _static.push_back(collision);
+      else
+        _dynamic.push_back(collision);
+    }
+  }
+
+  for (auto const &nested : _model->NestedModels())
+    this->Collect(nested, _static, _dynamic);
+}
+
+//////////////////////////////////////////////////
+bool RayQueryPrivate::Unchanged(
+    const std::shared_ptr<const SceneLayer> &_layer,
+    const std::vector<CollisionPtr> &_collisions,
+    const std::vector<ignition::math::Pose3d> &_poses)
+{
+  if (!_layer || _layer->sources.size() != _collisions.size())
+    return false;
+
+  for (size_t i = 0; i < _collisions.size(); ++i)
+  {
+    if (_layer->sources[i].first != _collisions[i].get() ||
+        _layer->sources[i].second != _poses[i])
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+//////////////////////////////////////////////////
+std::shared_ptr<SceneLayer> RayQueryPrivate::BuildLayer(
+    const std::vector<CollisionPtr> &_collisions,
+    const std::vector<ignition::math::Pose3d> &_poses)
+{
+  std::shared_ptr<SceneLayer> layer(new SceneLayer);
+  layer->version = ++this->version;
+  layer->sources.reserve(_collisions.size());
+  layer->objects.reserve(_collisions.size());
+  for (size_t i = 0; i < _collisions.size(); ++i)
+  {
+    layer->sources.emplace_back(_collisions[i].get(), _poses[i]);
+    this->AddCollision(_collisions[i], _poses[i], *layer);
+  }
+
+  std::vector<Bounds> bounds(layer->objects.size());
+  for (size_t i = 0; i < layer->objects.size(); ++i)
+  {
+    const SceneObject &object = layer->objects[i];
+
+    ignition::math::Vector3d lo = -object.size;
+    ignition::math::Vector3d hi = object.size;
+    if (object.type == ObjectType::SPHERE)
+    {
+      lo = -ignition::math::Vector3d::One * object.size.X();
+      hi = ignition::math::Vector3d::One * object.size.X();
+    }
+    else if (object.type == ObjectType::CYLINDER)
+    {
+      hi.Set(object.size.X(), object.size.X(), object.size.Y());
+      lo = -hi;
+    }
+    else if (object.type == ObjectType::MESH)
+    {
+      lo.Set(object.mesh->bounds.min[0], object.mesh->bounds.min[1],
+          object.mesh->bounds.min[2]);
+      hi.Set(object.mesh->bounds.max[0], object.mesh->bounds.max[1],
+          object.mesh->bounds.max[2]);
+    }
+    else if (object.type == ObjectType::HEIGHTMAP)
+    {
+      lo.Set(-object.size.X(), -object.size.Y(), object.minZ);
+      hi.Set(object.size.X(), object.size.Y(), object.maxZ);
+    }
+
+    // world bounds of the rotated local bounds
+    const ignition::math::Matrix3d toWorld = object.toLocal.Transposed();
+    const ignition::math::Vector3d center =
+        toWorld * ((lo + hi) * 0.5) + object.pos;
+    const ignition::math::Vector3d half = (hi - lo) * 0.5;
+    for (int a = 0; a < 3; ++a)
+    {
+      const double extent = std::abs(toWorld(a, 0)) * half.X() +
+                            std::abs(toWorld(a, 1)) * half.Y() +
+                            std::abs(toWorld(a, 2)) * half.Z();
+      bounds[i].min[a] = center[a] - extent;
+      bounds[i].max[a] = center[a] + extent;
+    }
+  }
+  layer->bvh.Build(bounds);
+
+  return layer;
+}
+
+//////////////////////////////////////////////////
+void RayQueryPrivate::AddCollision(const CollisionPtr &_collision,
+    const ignition::math::Pose3d &_pose, SceneLayer &_layer)
+{
+  ShapePtr shape = _collision->GetShape();
+
+  if (shape->HasType(Base::PLANE_SHAPE))
+  {
+    ScenePlane plane;
+    plane.normal = _pose.Rot().RotateVector(
+        boost::static_pointer_cast<PlaneShape>(shape)->Normal()).Normalize();
+    plane.offset = plane.normal.Dot(_pose.Pos());
+    plane.retro = _collision->GetLaserRetro();
+    plane.collision = _collision;
+    plane.link = _collision->GetLink().get();
+    _layer.planes.push_back(plane);
+    return;
+  }
+
+  SceneObject object;
+  if (shape->HasType(Base::BOX_SHAPE))
+  {
+    object.type = ObjectType::BOX;
+    object.size = boost::static_pointer_cast<BoxShape>(shape)->Size() * 0.5;
+  }
+  else if (shape->HasType(Base::SPHERE_SHAPE))
+  {
+    object.type = ObjectType::SPHERE;
+    object.size.X(boost::static_pointer_cast<SphereShape>(shape)->GetRadius());
+  }
+  else if (shape->HasType(Base::CYLINDER_SHAPE))
+  {
+    CylinderShapePtr cylinder = boost::static_pointer_cast<CylinderShape>(
+        shape);
+    object.type = ObjectType::CYLINDER;
+    object.size.Set(cylinder->GetRadius(), cylinder->GetLength() * 0.5, 0);
+  }
+  else if (shape->HasType(Base::HEIGHTMAP_SHAPE))
+  {
+    // Heightmaps are walked cell by cell along each ray, so no triangles
+    // are built and only the heights under the rays are read
+    object.heightmap = boost::static_pointer_cast<HeightmapShape>(shape);
+    const ignition::math::Vector2i count = object.heightmap->VertexCount();
+    if (count.X() < 2 || count.X() != count.Y())
+      return;
+    const ignition::math::Vector3d size = object.heightmap->Size();
+    const double offset = object.heightmap->Pos().Z();
+    object.type = ObjectType::HEIGHTMAP;
+    object.size.Set(size.X() * 0.5, size.Y() * 0.5, offset);
+    object.vertexCount = count.X();
+    object.minZ = object.heightmap->GetMinHeight() + offset;
+    object.maxZ = object.heightmap->GetMaxHeight() + offset;
+  }
+  else if (shape->HasType(Base::MESH_SHAPE) ||
+           shape->HasType(Base::POLYLINE_SHAPE))
+  {
+    object.type = ObjectType::MESH;
+    object.mesh = this->Triangles(shape);
+    if (!object.mesh)
+      return;
+  }
+  else
+  {
+    if (this->unsupported.insert(_collision->GetScopedName()).second)
+    {
+      gzwarn << "Batched ray queries do not support the shape of collision ["
+             << _collision->GetScopedName() << "], rays will not hit it\n";
+    }
+    return;
+  }
+
+  object.toLocal = ignition::math::Matrix3d(_pose.Rot()).Transposed();
+  object.pos = _pose.Pos();
+  object.retro = _collision->GetLaserRetro();
+  object.collision = _collision;
+  object.link = _collision->GetLink().get();
+  _layer.objects.push_back(object);
+}
+
+//////////////////////////////////////////////////
+std::shared_ptr<const TriangleMesh> RayQueryPrivate::Triangles(
+    const ShapePtr &_shape)
+{
+  MeshKey key;
+  ignition::math::Vector3d scale = ignition::math::Vector3d::One;
+  const common::Mesh *mesh = nullptr;
+  const common::SubMesh *submesh = nullptr;
+
+  if (_shape->HasType(Base::MESH_SHAPE))
+  {
+    MeshShapePtr meshShape = boost::static_pointer_cast<MeshShape>(_shape);
+    mesh = meshShape->Mesh();
+    submesh = meshShape->SubMesh();
+    if (!mesh)
+      return nullptr;
+
+    // Meshes are loaded once by the MeshManager, so the mesh name, the
+    // submesh name and the center flag identify the triangles
+    scale = meshShape->Size();
+    std::string name = mesh->GetName();
+    if (submesh)
+    {
+      sdf::ElementPtr submeshElem =
+          meshShape->GetSDF()->GetElement("submesh");
+      name += "::" + submeshElem->Get<std::string>("name");
+      if (submeshElem->HasElement("center") &&
+          submeshElem->Get<bool>("center"))
+      {
+        name += "::center";
+      }
+    }
+    key = MeshKey(name, scale.X(), scale.Y(), scale.Z());
+  }
+  else if (_shape->HasType(Base::POLYLINE_SHAPE))
+  {
+    mesh = boost::static_pointer_cast<PolylineShape>(_shape)->Mesh();
+    if (!mesh)
+      return nullptr;
+    key = MeshKey(mesh->GetName(), 1, 1, 1);
+  }
+  else
+  {
+    return nullptr;
+  }
+
+  auto iter = this->meshes.find(key);
+  if (iter != this->meshes.end())
+  {
+    std::shared_ptr<const TriangleMesh> cached = iter->second.lock();
+    if (cached)
+      return cached;
+  }
+
+  std::shared_ptr<TriangleMesh> triangles(new TriangleMesh);
+  if (submesh)
+    CopyTriangles(submesh, scale, *triangles);
+  else
+    CopyTriangles(mesh, scale, *triangles);
+  if (triangles->indices.empty())
+    return nullptr;
+
+  triangles->Build();
+  this->meshes[key] = triangles;
+  return triangles;
+}
+
+//////////////////////////////////////////////////
+RayQuery::RayQuery(physics::World &_world)
+  : dataPtr(new RayQueryPrivate(_world))
+{
+}
+
+//////////////////////////////////////////////////
+RayQuery::~RayQuery()
+{
+}
+
+//////////////////////////////////////////////////
+void RayQuery::SetEnabled(const bool _enabled)
+{
+  this->dataPtr->enabled = _enabled;
+}
+
+//////////////////////////////////////////////////
+bool RayQuery::Enabled() const
+{
+  return this->dataPtr->enabled;
+}
+
+//////////////////////////////////////////////////
+void RayQuery::SetFilter(
+    const std::function<bool(const Collision &)> &_filter)
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  this->dataPtr->filter = _filter;
+  this->dataPtr->scene.reset();
+  this->dataPtr->staticLayer.reset();
+  this->dataPtr->dynamicLayer.reset();
+}
+
+//////////////////////////////////////////////////
+void RayQuery::Reset()
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  this->dataPtr->scene.reset();
+  this->dataPtr->staticLayer.reset();
+  this->dataPtr->dynamicLayer.reset();
+  this->dataPtr->unsupported.clear();
+}
+
+//////////////////////////////////////////////////
+void RayQuery::Cast(const std::vector<RayQueryRay> &_rays,
+    RayQueryResult &_result, const RayQueryLayers _layers,
+    const Link *_exclude)
+{
+  std::shared_ptr<const Scene> scene = this->dataPtr->CurrentScene();
+
+  _result.hits.resize(_rays.size());
+  _result.scene = scene;
+  _result.staticVersion = scene->staticLayer->version;
+  _result.dynamicVersion = scene->dynamicLayer->version;
+
+  const bool castStatic = _layers != RayQueryLayers::DYNAMIC;
+  const bool castDynamic = _layers != RayQueryLayers::STATIC;
+
+  const size_t count = _rays.size();
+  const size_t packets = (count + kLanes - 1) / kLanes;
+
+  // Consecutive rays of a sensor are close to each other, so a packet of
+  // them mostly visits the same nodes.
+  tbb::parallel_for(tbb::blocked_range<size_t>(0, packets, 16),
+      [&](const tbb::blocked_range<size_t> &_range)
+  {
+    for (size_t p = _range.begin(); p != _range.end(); ++p)
+    {
+      RayPacket packet;
+      double length[kLanes];
+      for (int i = 0; i < kLanes; ++i)
+      {
+        const size_t r = p * kLanes + i;
+        length[i] = 0;
+        if (r >= count)
+        {
+          packet.Clear(i);
+          continue;
+        }
+
+        ignition::math::Vector3d dir = _rays[r].end - _rays[r].start;
+        length[i] = dir.Length();
+        if (length[i] <= 0)
+        {
+          packet.Clear(i);
+          continue;
+        }
+        packet.Set(i, _rays[r].start, dir / length[i], length[i]);
+      }
+
+      if (castStatic)
+        TraceLayer(*scene->staticLayer, packet, _exclude);
+      if (castDynamic)
+        TraceLayer(*scene->dynamicLayer, packet, _exclude);
+
+      for (int i = 0; i < kLanes; ++i)
+      {
+        const size_t r = p * kLanes + i;
+        if (r >= count)
+          break;
+
+        RayQueryHit &hit = _result.hits[r];
+        hit.distance = length[i];
+        hit.retro = 0;
+        hit.collision = nullptr;
+        if (!packet.hit[i])
+          continue;
+
+        hit.distance = packet.best[i];
+        hit.retro = packet.hit[i]->retro;
+        hit.collision = packet.hit[i]->collision.get();
+      }
+    }
+  });
+}
@@ -0,0 +1,171 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#ifndef GAZEBO_PHYSICS_RAYQUERY_HH_
+#define GAZEBO_PHYSICS_RAYQUERY_HH_
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include <ignition/math/Vector3.hh>
+
+#include "gazebo/util/system.hh"
+
+namespace gazebo
+{
+  namespace physics
+  {
+    class Collision;
+    class Link;
+    class World;
+
+    /// \addtogroup gazebo_physics
+    /// \{
+
+    /// Forward declare private data class.
+    class RayQueryPrivate;
+
+    /// \brief A ray cast by RayQuery, from start to end in the world frame.
+    class GZ_PHYSICS_VISIBLE RayQueryRay
+    {
+      /// \brief Start point of the ray.
+      public: ignition::math::Vector3d start;
+
+      /// \brief End point of the ray.
+      public: ignition::math::Vector3d end;
+    };
+
+    /// \brief Closest hit of a RayQueryRay.
+    class GZ_PHYSICS_VISIBLE RayQueryHit
+    {
+      /// \brief Distance from the start of the ray to the hit, or the
+      /// length of the ray if nothing was hit.
+      public: double distance = 0;
+
+      /// \brief Laser retro value of the hit collision, zero on a miss.
+      public: double retro = 0;
+
+      /// \brief The hit collision, null on a miss. Valid as long as the
+      /// RayQueryResult holding the hit exists.
+      public: Collision *collision = nullptr;
+    };
+
+    /// \brief Collisions a batch of rays is cast against.
+    enum class RayQueryLayers
+    {
+      /// \brief All the collisions.
+      ALL,
+
+      /// \brief Static collisions only.
+      STATIC,
+
+      /// \brief Collisions that are not static only.
+      DYNAMIC
+    };
+
+    /// \brief Hits of a batch of rays cast with RayQuery::Cast.
+    class GZ_PHYSICS_VISIBLE RayQueryResult
+    {
+      /// \brief One hit per ray, in the order of the rays.
+      public: std::vector<RayQueryHit> hits;
+
+      /// \brief Version of the static collisions the rays were cast
+      /// against. It only changes when a static collision is added,
+      /// removed or moved, so hits against static collisions can be
+      /// cached while it stays the same.
+      public: uint64_t staticVersion = 0;
+
+      /// \brief Version of the other collisions the rays were cast
+      /// against. It stays the same while they are all at rest.
+      public: uint64_t dynamicVersion = 0;
+
+      /// \brief Scene the rays were cast against, which keeps the hit
+      /// collisions alive.
+      public: std::shared_ptr<const void> scene;
+    };
+
+    /// \class RayQuery RayQuery.hh physics/physics.hh
+    /// \brief Casts batches of rays against the collisions of a world on
+    /// the CPU, independently of the physics engine.
+    ///
+    /// The collisions are copied into a scene with a bounding volume
+    /// hierarchy over static collisions and one over the other
+    /// collisions. The static hierarchy is reused until a static collision
+    /// is added, removed or moved, and the other one is rebuilt at most
+    /// once per world iteration, when one of its collisions moved. Rays
+    /// can be cast against either hierarchy alone, so results against
+    /// static collisions can be cached. Rays are traced in packets of four
+    /// that share a traversal of the hierarchies, and the packets of a
+    /// batch are traced in parallel.
+    ///
+    /// Boxes, spheres, cylinders, planes, meshes, polylines and
+    /// heightmaps are supported, other shapes are not hit. Like the rays
+    /// of the physics engines, a ray that starts inside a solid shape hits
+    /// it where it leaves the shape. Heightmaps are not turned into
+    /// triangles: each ray walks the cells it crosses and reads only the
+    /// heights of those cells.
+    class GZ_PHYSICS_VISIBLE RayQuery
+    {
+      /// \brief Constructor.
+      /// \param[in] _world Reference to the world.
+      public: explicit RayQuery(physics::World &_world);
+
+      /// \brief Destructor.
+      public: virtual ~RayQuery();
+
+      /// \brief Enable or disable batched ray queries for the ray sensors
+      /// of the world. This can also be set through the
+      /// "batch_ray_queries" physics parameter.
+      /// \param[in] _enabled True to let MultiRayShape, SonarSensor and
+      /// WirelessTransmitter cast their rays with this class.
+      public: void SetEnabled(const bool _enabled);
+
+      /// \brief Get whether ray sensors cast their rays with this class.
+      /// \return True if batched ray queries are enabled.
+      public: bool Enabled() const;
+
+      /// \brief Set the function that decides which collisions rays can
+      /// hit. Physics engines set it to skip the collisions their own rays
+      /// skip. Sensor collisions and rays are never hit.
+      /// \param[in] _filter Returns true if rays can hit a collision.
+      public: void SetFilter(
+                  const std::function<bool(const Collision &)> &_filter);
+
+      /// \brief Cast a batch of rays. An empty batch only fills in the
+      /// versions of the result.
+      /// \param[in] _rays Rays to cast.
+      /// \param[out] _result The closest hit of every ray.
+      /// \param[in] _layers Collisions to cast the rays against.
+      /// \param[in] _exclude Link whose collisions the rays pass through,
+      /// such as the link a sensor is attached to. Null to hit every link.
+      public: void Cast(const std::vector<RayQueryRay> &_rays,
+                  RayQueryResult &_result,
+                  const RayQueryLayers _layers = RayQueryLayers::ALL,
+                  const Link *_exclude = nullptr);
+
+      /// \brief Discard the scene, so the next batch rebuilds it.
+      public: void Reset();
+
+      /// \internal
+      /// \brief Private data pointer.
+      private: std::unique_ptr<RayQueryPrivate> dataPtr;
+    };
+    /// \}
+  }
+}
+#endif
@@ -0,0 +1,319 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gazebo/physics/physics.hh"
+#include "gazebo/physics/RayQuery.hh"
+#include "gazebo/test/ServerFixture.hh"
+#include "test/util.hh"
+
+using namespace gazebo;
+
+class RayQueryTest : public ServerFixture
+{
+  /// \brief Load a world with a box, a sphere and a cylinder above the
+  /// ground plane.
+  /// \return The world.
+  public: physics::WorldPtr LoadShapes();
+
+  /// \brief Name of the model hit by a ray.
+  /// \param[in] _hit The hit.
+  /// \return Model name, empty on a miss.
+  public: static std::string ModelName(const physics::RayQueryHit &_hit);
+};
+
+/////////////////////////////////////////////////
+physics::WorldPtr RayQueryTest::LoadShapes()
+{
+  this->Load("worlds/empty.world", true);
+  physics::WorldPtr world = physics::get_world("default");
+
+  this->SpawnBox("box", ignition::math::Vector3d::One,
+      ignition::math::Vector3d(0, 0, 2), ignition::math::Vector3d::Zero, true);
+  this->SpawnSphere("sphere", ignition::math::Vector3d(0, 3, 2),
+      ignition::math::Vector3d::Zero, true, true);
+  this->SpawnCylinder("cylinder", ignition::math::Vector3d(0, -3, 2),
+      ignition::math::Vector3d::Zero, true);
+
+  return world;
+}
+
+/////////////////////////////////////////////////
+std::string RayQueryTest::ModelName(const physics::RayQueryHit &_hit)
+{
+  if (!_hit.collision)
+    return "";
+  return _hit.collision->GetModel()->GetName();
+}
+
+/////////////////////////////////////////////////
+TEST_F(RayQueryTest, Shapes)
+{
+  physics::WorldPtr world = this->LoadShapes();
+  ASSERT_TRUE(world != nullptr);
+
+  std::vector<physics::RayQueryRay> rays(6);
+  rays[0] = {{-5, 0, 2}, {5, 0, 2}};
+  rays[1] = {{-5, 3, 2}, {5, 3, 2}};
+  rays[2] = {{-5, -3, 2}, {5, -3, 2}};
+  rays[3] = {{10, 10, 5}, {10, 10, -5}};
+  rays[4] = {{10, 10, 5}, {10, 10, 6}};
+  rays[5] = {{0, 0, 2}, {5, 0, 2}};
+
+  physics::RayQueryResult result;
+  world->RayQuery().Cast(rays, result);
+  ASSERT_EQ(result.hits.size(), rays.size());
+
+  EXPECT_EQ(ModelName(result.hits[0]), "box");
+  EXPECT_NEAR(result.hits[0].distance, 4.5, 1e-6);
+  EXPECT_EQ(ModelName(result.hits[1]), "sphere");
+  EXPECT_NEAR(result.hits[1].distance, 4.5, 1e-6);
+  EXPECT_EQ(ModelName(result.hits[2]), "cylinder");
+  EXPECT_NEAR(result.hits[2].distance, 4.5, 1e-6);
+  EXPECT_EQ(ModelName(result.hits[3]), "ground_plane");
+  EXPECT_NEAR(result.hits[3].distance, 5.0, 1e-6);
+
+  // A miss reports the length of the ray
+  EXPECT_TRUE(result.hits[4].collision == nullptr);
+  EXPECT_NEAR(result.hits[4].distance, 1.0, 1e-6);
+
+  // A ray that starts inside a shape hits it where it leaves the shape
+  EXPECT_EQ(ModelName(result.hits[5]), "box");
+  EXPECT_NEAR(result.hits[5].distance, 0.5, 1e-6);
+
+  // Compare with the rays of the physics engine
+  physics::RayShapePtr ray = boost::dynamic_pointer_cast<physics::RayShape>(
+      world->Physics()->CreateShape("ray", physics::CollisionPtr()));
+  ASSERT_TRUE(ray != nullptr);
+  for (size_t i = 0; i < 4; ++i)
+  {
+    double dist;
+    std::string entityName;
+    ray->SetPoints(rays[i].start, rays[i].end);
+    ray->GetIntersection(dist, entityName);
+    EXPECT_EQ(entityName, result.hits[i].collision->GetScopedName()) << i;
+    EXPECT_NEAR(dist, result.hits[i].distance, 1e-4) << i;
+  }
+}
+
+/////////////////////////////////////////////////
+TEST_F(RayQueryTest, Update)
+{
+  physics::WorldPtr world = this->LoadShapes();
+  ASSERT_TRUE(world != nullptr);
+
+  std::vector<physics::RayQueryRay> rays(1);
+  rays[0] = {{-5, 0, 2}, {5, 0, 2}};
+
+  physics::RayQueryResult result;
+  world->RayQuery().Cast(rays, result);
+  EXPECT_EQ(ModelName(result.hits[0]), "box");
+
+  // Moving a static model rebuilds the static hierarchy
+  physics::ModelPtr box = world->ModelByName("box");
+  ASSERT_TRUE(box != nullptr);
+  box->SetWorldPose(ignition::math::Pose3d(0, 0, 4, 0, 0, 0));
+  world->RayQuery().Cast(rays, result);
+  EXPECT_TRUE(result.hits[0].collision == nullptr);
+  EXPECT_NEAR(result.hits[0].distance, 10.0, 1e-6);
+
+  box->SetWorldPose(ignition::math::Pose3d(1, 0, 2, 0, 0, 0));
+  world->RayQuery().Cast(rays, result);
+  EXPECT_EQ(ModelName(result.hits[0]), "box");
+  EXPECT_NEAR(result.hits[0].distance, 5.5, 1e-6);
+
+  // Filtered collisions are not hit
+  world->RayQuery().SetFilter([](const physics::Collision &_collision)
+  {
+    return _collision.GetModel()->GetName() != "box";
+  });
+  world->RayQuery().Cast(rays, result);
+  EXPECT_TRUE(result.hits[0].collision == nullptr);
+}
+
+/////////////////////////////////////////////////
+TEST_F(RayQueryTest, Layers)
+{
+  physics::WorldPtr world = this->LoadShapes();
+  ASSERT_TRUE(world != nullptr);
+
+  this->SpawnBox("dynamic_box", ignition::math::Vector3d::One,
+      ignition::math::Vector3d(0, 6, 2), ignition::math::Vector3d::Zero,
+      false);
+  physics::ModelPtr dynamicBox = world->ModelByName("dynamic_box");
+  ASSERT_TRUE(dynamicBox != nullptr);
+
+  std::vector<physics::RayQueryRay> rays(2);
+  rays[0] = {{-5, 0, 2}, {5, 0, 2}};
+  rays[1] = {{-5, 6, 2}, {5, 6, 2}};
+
+  physics::RayQueryResult result;
+  world->RayQuery().Cast(rays, result);
+  EXPECT_EQ(ModelName(result.hits[0]), "box");
+  EXPECT_EQ(ModelName(result.hits[1]), "dynamic_box");
+  const uint64_t staticVersion = result.staticVersion;
+  const uint64_t dynamicVersion = result.dynamicVersion;
+  EXPECT_NE(staticVersion, 0u);
+  EXPECT_NE(dynamicVersion, 0u);
+
+  world->RayQuery().Cast(rays, result, physics::RayQueryLayers::STATIC);
+  EXPECT_EQ(ModelName(result.hits[0]), "box");
+  EXPECT_TRUE(result.hits[1].collision == nullptr);
+
+  world->RayQuery().Cast(rays, result, physics::RayQueryLayers::DYNAMIC);
+  EXPECT_TRUE(result.hits[0].collision == nullptr);
+  EXPECT_EQ(ModelName(result.hits[1]), "dynamic_box");
+
+  // Nothing moved, so neither version changes, and an empty batch reports
+  // them too
+  world->RayQuery().Cast(std::vector<physics::RayQueryRay>(), result);
+  EXPECT_TRUE(result.hits.empty());
+  EXPECT_EQ(result.staticVersion, staticVersion);
+  EXPECT_EQ(result.dynamicVersion, dynamicVersion);
+
+  // Moving a dynamic model only changes the dynamic version
+  dynamicBox->SetWorldPose(ignition::math::Pose3d(0, 6, 3, 0, 0, 0));
+  world->RayQuery().Cast(rays, result);
+  EXPECT_EQ(result.staticVersion, staticVersion);
+  EXPECT_NE(result.dynamicVersion, dynamicVersion);
+
+  // Moving a static model changes the static version
+  physics::ModelPtr box = world->ModelByName("box");
+  ASSERT_TRUE(box != nullptr);
+  box->SetWorldPose(ignition::math::Pose3d(0, 0, 4, 0, 0, 0));
+  world->RayQuery().Cast(rays, result);
+  EXPECT_NE(result.staticVersion, staticVersion);
+}
+
+/////////////////////////////////////////////////
+TEST_F(RayQueryTest, Param)
+{
+  this->Load("worlds/empty.world", true);
+  physics::WorldPtr world = physics::get_world("default");
+  ASSERT_TRUE(world != nullptr);
+  physics::PhysicsEnginePtr physics = world->Physics();
+  ASSERT_TRUE(physics != nullptr);
+
+  EXPECT_FALSE(world->RayQuery().Enabled());
+  EXPECT_TRUE(physics->SetParam("batch_ray_queries", true));
+  EXPECT_TRUE(world->RayQuery().Enabled());
+
+  boost::any value;
+  EXPECT_TRUE(physics->GetParam("batch_ray_queries", value));
+  EXPECT_TRUE(boost::any_cast<bool>(value));
+
+  world->RayQuery().SetEnabled(false);
+  EXPECT_FALSE(boost::any_cast<bool>(physics->GetParam("batch_ray_queries")));
+}
+
+/////////////////////////////////////////////////
+TEST_F(RayQueryTest, ExcludeLink)
+{
+  physics::WorldPtr world = this->LoadShapes();
+  ASSERT_TRUE(world != nullptr);
+
+  physics::ModelPtr box = world->ModelByName("box");
+  ASSERT_TRUE(box != nullptr);
+  physics::LinkPtr link = box->GetLink();
+  ASSERT_TRUE(link != nullptr);
+
+  std::vector<physics::RayQueryRay> rays(2);
+  rays[0] = {{0, 0, 5}, {0, 0, -5}};
+  rays[1] = {{0, 3, 5}, {0, 3, -5}};
+
+  physics::RayQueryResult result;
+  world->RayQuery().Cast(rays, result);
+  EXPECT_EQ(ModelName(result.hits[0]), "box");
+  EXPECT_NEAR(result.hits[0].distance, 2.5, 1e-6);
+
+  // The rays pass through the excluded link and hit what is behind it
+  world->RayQuery().Cast(rays, result, physics::RayQueryLayers::ALL,
+      link.get());
+  EXPECT_EQ(ModelName(result.hits[0]), "ground_plane");
+  EXPECT_NEAR(result.hits[0].distance, 5.0, 1e-6);
+  EXPECT_EQ(ModelName(result.hits[1]), "sphere");
+}
+
+/////////////////////////////////////////////////
+TEST_F(RayQueryTest, Heightmap)
+{
+  this->Load("worlds/heightmap.world", true);
+  physics::WorldPtr world = physics::get_world("default");
+  ASSERT_TRUE(world != nullptr);
+
+  physics::ModelPtr model = world->ModelByName("heightmap");
+  ASSERT_TRUE(model != nullptr);
+  physics::HeightmapShapePtr heightmap =
+      boost::dynamic_pointer_cast<physics::HeightmapShape>(
+      model->GetLink("link")->GetCollision("collision")->GetShape());
+  ASSERT_TRUE(heightmap != nullptr);
+
+  // Vertical rays onto vertices away from the boxes at the corners
+  const int vertSize = heightmap->VertexCount().X();
+  const ignition::math::Vector3d size = heightmap->Size();
+  const double dx = size.X() / (vertSize - 1);
+  const double dy = size.Y() / (vertSize - 1);
+  std::vector<std::pair<int, int>> vertices;
+  for (int y = vertSize / 4; y <= 3 * vertSize / 4; y += vertSize / 8)
+  {
+    for (int x = vertSize / 4; x <= 3 * vertSize / 4; x += vertSize / 8)
+      vertices.emplace_back(x, y);
+  }
+
+  std::vector<physics::RayQueryRay> rays;
+  for (auto const &vertex : vertices)
+  {
+    const double x = -0.5 * size.X() + vertex.first * dx;
+    const double y = 0.5 * size.Y() - vertex.second * dy;
+    rays.push_back({{x, y, 50}, {x, y, -50}});
+  }
+
+  physics::RayQueryResult result;
+  world->RayQuery().Cast(rays, result);
+  ASSERT_EQ(result.hits.size(), rays.size());
+  for (size_t i = 0; i < rays.size(); ++i)
+  {
+    EXPECT_EQ(ModelName(result.hits[i]), "heightmap") << i;
+    const double height = heightmap->GetHeight(vertices[i].first,
+        vertices[i].second) + heightmap->Pos().Z();
+    EXPECT_NEAR(result.hits[i].distance, 50 - height, 1e-4) << i;
+  }
+
+  // A ray that runs along the terrain hits the same point as the ray
+  // that drops onto it there
+  rays.resize(1);
+  rays[0] = {{-20, 5, 20}, {20, -5, -20}};
+  world->RayQuery().Cast(rays, result);
+  ASSERT_EQ(result.hits.size(), 1u);
+  ASSERT_EQ(ModelName(result.hits[0]), "heightmap");
+  const ignition::math::Vector3d point = rays[0].start +
+      (rays[0].end - rays[0].start).Normalize() * result.hits[0].distance;
+  rays[0] = {{point.X(), point.Y(), 50}, {point.X(), point.Y(), -50}};
+  world->RayQuery().Cast(rays, result);
+  ASSERT_EQ(ModelName(result.hits[0]), "heightmap");
+  EXPECT_NEAR(50 - result.hits[0].distance, point.Z(), 1e-4);
+}
+
+/////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -22,8 +22,12 @@
 
 #include <sdf/sdf.hh>
 
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
 #include <deque>
 #include <list>
+#include <memory>
 #include <set>
 #include <string>
 #include <vector>
@@ -73,10 +77,12 @@
 #include "gazebo/physics/PhysicsFactory.hh"
 #include "gazebo/physics/Atmosphere.hh"
 #include "gazebo/physics/AtmosphereFactory.hh"
+#include "gazebo/physics/RayQuery.hh"
 #include "gazebo/physics/PresetManager.hh"
 #include "gazebo/physics/UserCmdManager.hh"
 #include "gazebo/physics/Model.hh"
 #include "gazebo/physics/Light.hh"
+#include "gazebo/physics/LogPlayPrefetcher.hh"
 #include "gazebo/physics/Actor.hh"
 #include "gazebo/physics/Wind.hh"
 #include "gazebo/physics/WorldPrivate.hh"
@@ -108,6 +114,35 @@ class ModelUpdate_TBB
   private: Model_V *models;
 };
 
+/// \brief Check whether a model can be updated concurrently with other
+/// top-level models, which is the case when all of its joints, including
+/// the joints of nested models, only connect links of the model itself.
+/// \param[in] _model Model, or nested model, to check.
+/// \param[in] _topModel Top-level model that owns _model.
+/// \return True if updating _model only touches state owned by _topModel.
+static bool ModelUpdateIsolated(const ModelPtr &_model,
+    const ModelPtr &_topModel)
+{
+  for (auto const &joint : _model->GetJoints())
+  {
+    LinkPtr parentLink = joint->GetParent();
+    LinkPtr childLink = joint->GetChild();
+    if ((parentLink && parentLink->GetParentModel() != _topModel) ||
+        (childLink && childLink->GetParentModel() != _topModel))
+    {
+      return false;
+    }
+  }
+
+  for (auto const &nested : _model->NestedModels())
+  {
+    if (!ModelUpdateIsolated(nested, _topModel))
+      return false;
+  }
+
+  return true;
+}
+
 //////////////////////////////////////////////////
 World::World(const std::string &_name)
   : dataPtr(new WorldPrivate)
@@ -134,7 +169,8 @@ World::World(const std::string &_name)
   this->dataPtr->sensorsInitialized = false;
 
   this->dataPtr->currentStateBuffer = 0;
-  this->dataPtr->stateToggle = 0;
+  this->dataPtr->logStateChanged = true;
+  this->dataPtr->logResync = true;
 
   this->dataPtr->pluginsLoaded = false;
 
@@ -148,6 +184,8 @@ World::World(const std::string &_name)
   this->dataPtr->enableWind = true;
   this->dataPtr->enableAtmosphere = true;
 
+  this->dataPtr->rayQuery.reset(new physics::RayQuery(*this));
+
   this->dataPtr->sleepOffset = common::Time(0);
 
   this->dataPtr->prevStatTime = common::Time::GetWallTime();
@@ -353,13 +391,9 @@ void World::Load(sdf::ElementPtr _sdf)
       this->ModelByIndex(i)->LoadJoints();
   }
 
-  // TODO: Performance test to see if TBB model updating is necessary
-  // Choose threaded or unthreaded model updating depending on the number of
-  // models in the scene
-  // if (this->ModelCount() < 20)
+  // Models are updated serially unless model update threads are requested
+  // through SetModelUpdateThreads or the "model_update_threads" parameter
   this->dataPtr->modelUpdateFunc = &World::ModelUpdateSingleLoop;
-  // else
-  // this->dataPtr->modelUpdateFunc = &World::ModelUpdateTBB;
 
   event::Events::worldCreated(this->Name());
 
@@ -436,11 +470,8 @@ void World::Init(UpdateScenePosesFunc _func)
   this->dataPtr->testRay = boost::dynamic_pointer_cast<RayShape>(
       this->Physics()->CreateShape("ray", CollisionPtr()));
 
-  this->dataPtr->prevStates[0].SetWorld(shared_from_this());
-  this->dataPtr->prevStates[1].SetWorld(shared_from_this());
-
-  this->dataPtr->prevStates[0].SetName(this->Name());
-  this->dataPtr->prevStates[1].SetName(this->Name());
+  this->dataPtr->logState.SetWorld(shared_from_this());
+  this->dataPtr->logState.SetName(this->Name());
 
   this->dataPtr->updateInfo.worldName = this->Name();
 
@@ -546,14 +577,16 @@ void World::RunLoop()
 
   this->dataPtr->prevStepWallTime = common::Time::GetWallTime();
 
-  // Get the first state
-  this->dataPtr->prevStates[0] = WorldState(shared_from_this());
-  this->dataPtr->prevStates[1] = WorldState(shared_from_this());
-  this->dataPtr->stateToggle = 0;
+  // The log worker loads the first state
+  this->dataPtr->logResync = true;
 
   this->dataPtr->logThread =
     new std::thread(std::bind(&World::LogWorker, this));
 
+  this->dataPtr->publishStop = false;
+  this->dataPtr->publishThread =
+    new std::thread(std::bind(&World::PublishWorker, this));
+
   if (!util::LogPlay::Instance()->IsOpen())
   {
     for (this->dataPtr->iterations = 0; !this->dataPtr->stop &&
@@ -566,16 +599,51 @@ void World::RunLoop()
   else
   {
     this->dataPtr->enablePhysicsEngine = false;
+
+    // Decode the log ahead of playback on another thread
+    unsigned int prefetch = 32;
+    const char *env = std::getenv("GAZEBO_LOG_PLAY_PREFETCH");
+    if (env)
+    {
+      const int value = std::atoi(env);
+      if (value >= 0)
+        prefetch = value;
+      else
+        gzwarn << "Ignoring invalid GAZEBO_LOG_PLAY_PREFETCH[" << env << "]\n";
+    }
+    if (prefetch > 0)
+    {
+      std::lock_guard<std::recursive_mutex> lock(
+          this->dataPtr->worldUpdateMutex);
+      this->dataPtr->logPlayPrefetcher.reset(new LogPlayPrefetcher(prefetch));
+    }
+
     for (this->dataPtr->iterations = 0; !this->dataPtr->stop &&
         (!this->dataPtr->stopIterations ||
          (this->dataPtr->iterations < this->dataPtr->stopIterations));)
     {
       this->LogStep();
     }
+
+    std::lock_guard<std::recursive_mutex> lock(
+        this->dataPtr->worldUpdateMutex);
+    this->dataPtr->logPlayPrefetcher.reset();
   }
 
   this->dataPtr->stop = true;
 
+  if (this->dataPtr->publishThread)
+  {
+    {
+      std::lock_guard<std::mutex> lock(this->dataPtr->publishMutex);
+      this->dataPtr->publishStop = true;
+    }
+    this->dataPtr->publishCondition.notify_all();
+    this->dataPtr->publishThread->join();
+    delete this->dataPtr->publishThread;
+    this->dataPtr->publishThread = nullptr;
+  }
+
   if (this->dataPtr->logThread)
   {
     this->dataPtr->logCondition.notify_all();
@@ -600,8 +668,31 @@ void World::LogStep()
       if (!this->IsPaused() && this->dataPtr->stepInc == 0)
         this->dataPtr->stepInc = 1;
 
-      std::string data;
-      if (!util::LogPlay::Instance()->Step(this->dataPtr->stepInc, data))
+      // The prefetcher has the state decoded already, otherwise parse it
+      // from the log on this thread.
+      WorldState *playState = &this->dataPtr->logPlayState;
+      std::shared_ptr<WorldState> prefetchedState;
+      bool stepped;
+      if (this->dataPtr->logPlayPrefetcher)
+      {
+        stepped = this->dataPtr->logPlayPrefetcher->Step(
+            this->dataPtr->stepInc, prefetchedState);
+        if (stepped)
+          playState = prefetchedState.get();
+      }
+      else
+      {
+        std::string data;
+        stepped = util::LogPlay::Instance()->Step(this->dataPtr->stepInc, data);
+        if (stepped)
+        {
+          this->dataPtr->logPlayStateSDF->Clear();
+          sdf::readString(data, this->dataPtr->logPlayStateSDF);
+          this->dataPtr->logPlayState.Load(this->dataPtr->logPlayStateSDF);
+        }
+      }
+
+      if (!stepped)
       {
         // There are no more chunks, time to exit.
         this->SetPaused(true);
@@ -611,21 +702,16 @@ void World::LogStep()
       {
         this->dataPtr->stepInc = 1;
 
-        this->dataPtr->logPlayStateSDF->Clear();
-        sdf::readString(data, this->dataPtr->logPlayStateSDF);
-
-        this->dataPtr->logPlayState.Load(this->dataPtr->logPlayStateSDF);
-
         // If it's the first step, we're going back in time or
         // rt factor is close to zero, don't sleep.
         if ((this->dataPtr->logPlayRealTimeFactor > 1e-5) &&
             (this->dataPtr->logLastStatePlayedRealTime != common::Time(0)) &&
             (this->dataPtr->logLastStatePlayedSimTime != common::Time(0)) &&
             (this->dataPtr->logLastStatePlayedSimTime <
-               this->dataPtr->logPlayState.GetSimTime()))
+             playState->GetSimTime()))
         {
           common::Time timeUntilNextStep =
-              common::Time((this->dataPtr->logPlayState.GetSimTime()
+              common::Time((playState->GetSimTime()
                            - this->dataPtr->logLastStatePlayedSimTime).Double()
                            / this->dataPtr->logPlayRealTimeFactor);
           common::Time realTimeOfNextStep =
@@ -642,14 +728,12 @@ void World::LogStep()
         // increase the iteration counter in logPlayState.
         if (!util::LogPlay::Instance()->HasIterations())
         {
-          this->dataPtr->logPlayState.SetIterations(
-            this->dataPtr->iterations + 1);
+          playState->SetIterations(this->dataPtr->iterations + 1);
         }
 
         this->dataPtr->logLastStatePlayedRealTime = common::Time::GetWallTime();
-        this->dataPtr->logLastStatePlayedSimTime =
-            this->dataPtr->logPlayState.GetSimTime();
-        this->SetState(this->dataPtr->logPlayState);
+        this->dataPtr->logLastStatePlayedSimTime = playState->GetSimTime();
+        this->SetState(*playState);
         this->Update();
       }
 
@@ -854,6 +938,14 @@ void World::Update()
   // Wait for logging to finish, if it's running.
   if (util::LogRecord::Instance()->Running())
   {
+    // Changes are only tracked for the log worker while recording, so the
+    // whole state has to be reloaded when recording starts.
+    if (!this->dataPtr->logRecording)
+    {
+      this->dataPtr->logRecording = true;
+      this->dataPtr->logResync = true;
+    }
+
     std::unique_lock<std::mutex> lock(this->dataPtr->logMutex);
 
     // It's possible the logWorker thread never processed the previous
@@ -871,6 +963,9 @@ void World::Update()
   this->dataPtr->updateInfo.realTime = this->RealTime();
   event::Events::beforePhysicsUpdate(this->dataPtr->updateInfo);
 
+  if (!util::LogRecord::Instance()->Running())
+    this->dataPtr->logRecording = false;
+
   IGN_PROFILE_END();
   DIAG_TIMER_LAP("World::Update", "Events::beforePhysicsUpdate");
 
@@ -898,6 +993,22 @@ void World::Update()
         dirtyEntity->SetWorldPose(dirtyEntity->DirtyPose(), false);
       }
 
+      // Tell the log worker which models moved
+      if (this->dataPtr->logRecording && !this->dataPtr->dirtyPoses.empty())
+      {
+        std::lock_guard<std::mutex> lock(this->dataPtr->logChangeMutex);
+        Base *prevParent = nullptr;
+        for (auto &dirtyEntity : this->dataPtr->dirtyPoses)
+        {
+          // Links of the same model are usually next to each other
+          if (dirtyEntity->GetParent().get() == prevParent)
+            continue;
+          prevParent = dirtyEntity->GetParent().get();
+          this->dataPtr->logChangedModels.insert(
+              dirtyEntity->GetParentModel());
+        }
+      }
+
       this->dataPtr->dirtyPoses.clear();
       IGN_PROFILE_END();
     }
@@ -913,8 +1024,12 @@ void World::Update()
   DIAG_TIMER_LAP("World::Update", "LogRecordNotify");
 
   IGN_PROFILE_BEGIN("PublishContacts");
-  // Output the contact information
-  this->dataPtr->physicsEngine->GetContactManager()->PublishContacts();
+  // Output the contact information. When the world runs its own loop,
+  // the contacts are only copied here, and published by PublishWorker.
+  if (this->dataPtr->publishThread)
+    this->dataPtr->physicsEngine->GetContactManager()->SnapshotContacts();
+  else
+    this->dataPtr->physicsEngine->GetContactManager()->PublishContacts();
 
   IGN_PROFILE_END();
   DIAG_TIMER_LAP("World::Update", "ContactManager::PublishContacts");
@@ -1008,9 +1123,19 @@ void World::Fini()
     this->dataPtr->rootElement->Fini();
     this->dataPtr->rootElement.reset();
   }
-  this->dataPtr->prevStates[0].SetWorld(WorldPtr());
-  this->dataPtr->prevStates[1].SetWorld(WorldPtr());
-  this->dataPtr->prevUnfilteredState.SetWorld(WorldPtr());
+  {
+    std::lock_guard<std::mutex> lock(this->dataPtr->entityIndexMutex);
+    this->dataPtr->entityNames.clear();
+    this->dataPtr->entityIds.clear();
+  }
+  this->dataPtr->logState.SetWorld(WorldPtr());
+  {
+    std::lock_guard<std::mutex> lock(this->dataPtr->logChangeMutex);
+    this->dataPtr->logChangedModels.clear();
+    this->dataPtr->logChangedLights.clear();
+    this->dataPtr->logInsertedModels.clear();
+    this->dataPtr->logInsertedLights.clear();
+  }
   this->dataPtr->logPlayState.SetWorld(WorldPtr());
   this->dataPtr->states[0].clear();
   this->dataPtr->states[1].clear();
@@ -1021,6 +1146,10 @@ void World::Fini()
   this->dataPtr->atmosphere.reset();
   this->dataPtr->wind.reset();
 
+  // Release the collisions held by the ray query scene
+  if (this->dataPtr->rayQuery)
+    this->dataPtr->rayQuery->Reset();
+
   // Engine shouldn't outlive world
   if (this->dataPtr->physicsEngine)
     this->dataPtr->physicsEngine->Fini();
@@ -1101,6 +1230,12 @@ PresetManagerPtr World::PresetMgr() const
   return this->dataPtr->presetManager;
 }
 
+//////////////////////////////////////////////////
+RayQuery &World::RayQuery() const
+{
+  return *this->dataPtr->rayQuery;
+}
+
 //////////////////////////////////////////////////
 common::SphericalCoordinatesPtr World::SphericalCoords() const
 {
@@ -1142,17 +1277,97 @@ void World::SetMagneticField(const ignition::math::Vector3d &_mag)
 //////////////////////////////////////////////////
 BasePtr World::BaseByName(const std::string &_name) const
 {
-  if (this->dataPtr->rootElement)
-    return this->dataPtr->rootElement->GetByName(_name);
-  else
+  BasePtr root = this->dataPtr->rootElement;
+  if (!root)
     return BasePtr();
+
+  if (root->GetName() == _name)
+    return root;
+
+  Base_V matches;
+  {
+    std::lock_guard<std::mutex> lock(this->dataPtr->entityIndexMutex);
+    auto range = this->dataPtr->entityNames.equal_range(_name);
+    for (auto iter = range.first; iter != range.second; ++iter)
+    {
+      BasePtr entity = iter->second.second.lock();
+      if (entity)
+        matches.push_back(entity);
+    }
+  }
+
+  // Ignore entities that have been detached from the world
+  matches.erase(std::remove_if(matches.begin(), matches.end(),
+        [&root](const BasePtr &_entity)
+        {
+          BasePtr p = _entity;
+          while (p->GetParent())
+            p = p->GetParent();
+          return p != root;
+        }), matches.end());
+
+  if (matches.size() <= 1u)
+    return matches.empty() ? BasePtr() : matches.front();
+
+  // Several entities match, e.g. links with the same name in different
+  // models. Search the tree to return the first match, as before.
+  return root->GetByName(_name);
+}
+
+//////////////////////////////////////////////////
+BasePtr World::BaseById(const uint32_t _id) const
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->entityIndexMutex);
+  auto iter = this->dataPtr->entityIds.find(_id);
+  if (iter != this->dataPtr->entityIds.end())
+    return iter->second.lock();
+  return BasePtr();
 }
 
 /////////////////////////////////////////////////
 ModelPtr World::ModelById(unsigned int _id) const
 {
-  return boost::dynamic_pointer_cast<Model>(
-      this->dataPtr->rootElement->GetById(_id));
+  // Only models at the top level of the world
+  BasePtr entity = this->BaseById(_id);
+  if (!entity || entity->GetParent() != this->dataPtr->rootElement)
+    return ModelPtr();
+
+  return boost::dynamic_pointer_cast<Model>(entity);
+}
+
+//////////////////////////////////////////////////
+void World::_AddToEntityIndex(const BasePtr &_entity)
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->entityIndexMutex);
+
+  auto value = std::make_pair(_entity->GetId(), boost::weak_ptr<Base>(_entity));
+  this->dataPtr->entityNames.emplace(_entity->GetScopedName(), value);
+  if (_entity->GetName() != _entity->GetScopedName())
+    this->dataPtr->entityNames.emplace(_entity->GetName(), value);
+
+  this->dataPtr->entityIds[_entity->GetId()] = _entity;
+}
+
+//////////////////////////////////////////////////
+void World::_RemoveFromEntityIndex(const uint32_t _id,
+    const std::string &_name, const std::string &_scopedName)
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->entityIndexMutex);
+
+  for (const std::string &key : {_scopedName, _name})
+  {
+    auto range = this->dataPtr->entityNames.equal_range(key);
+    for (auto iter = range.first; iter != range.second; ++iter)
+    {
+      if (iter->second.first == _id)
+      {
+        this->dataPtr->entityNames.erase(iter);
+        break;
+      }
+    }
+  }
+
+  this->dataPtr->entityIds.erase(_id);
 }
 
 //////////////////////////////////////////////////
@@ -1214,6 +1429,12 @@ ModelPtr World::LoadModel(sdf::ElementPtr _sdf , BasePtr _parent)
 
   this->PublishModelPose(model);
   this->dataPtr->models.push_back(model);
+
+  if (model && util::LogRecord::Instance()->Running())
+  {
+    std::lock_guard<std::mutex> lock(this->dataPtr->logChangeMutex);
+    this->dataPtr->logInsertedModels.push_back(model);
+  }
   return model;
 }
 
@@ -1250,6 +1471,12 @@ LightPtr World::LoadLight(const sdf::ElementPtr &_sdf, const BasePtr &_parent)
   // /light/info topic for this, see issue #2288
   this->dataPtr->lightFactoryPub->Publish(*msg);
 
+  if (util::LogRecord::Instance()->Running())
+  {
+    std::lock_guard<std::mutex> lock(this->dataPtr->logChangeMutex);
+    this->dataPtr->logInsertedLights.push_back(light);
+  }
+
   return light;
 }
 
@@ -1270,6 +1497,12 @@ ActorPtr World::LoadActor(sdf::ElementPtr _sdf , BasePtr _parent)
   this->PublishModelPose(actor);
   this->dataPtr->models.push_back(actor);
 
+  if (util::LogRecord::Instance()->Running())
+  {
+    std::lock_guard<std::mutex> lock(this->dataPtr->logChangeMutex);
+    this->dataPtr->logInsertedModels.push_back(actor);
+  }
+
   return actor;
 }
 
@@ -1592,13 +1825,19 @@ void World::ProcessPlaybackControlMsgs()
     if (msg.has_seek())
     {
       common::Time targetSimTime = msgs::Convert(msg.seek());
-      util::LogPlay::Instance()->Seek(targetSimTime);
+      if (this->dataPtr->logPlayPrefetcher)
+        this->dataPtr->logPlayPrefetcher->Seek(targetSimTime);
+      else
+        util::LogPlay::Instance()->Seek(targetSimTime);
       this->dataPtr->stepInc = 1;
     }
 
     if (msg.has_rewind() && msg.rewind())
     {
-      util::LogPlay::Instance()->Rewind();
+      if (this->dataPtr->logPlayPrefetcher)
+        this->dataPtr->logPlayPrefetcher->Rewind();
+      else
+        util::LogPlay::Instance()->Rewind();
       this->dataPtr->stepInc = 1;
       if (!util::LogPlay::Instance()->HasIterations())
         this->dataPtr->iterations = 0;
@@ -1606,7 +1845,10 @@ void World::ProcessPlaybackControlMsgs()
 
     if (msg.has_forward() && msg.forward())
     {
-      util::LogPlay::Instance()->Forward();
+      if (this->dataPtr->logPlayPrefetcher)
+        this->dataPtr->logPlayPrefetcher->Forward();
+      else
+        util::LogPlay::Instance()->Forward();
       this->dataPtr->stepInc = -1;
       this->SetPaused(true);
       // ToDo: Update iterations if the log doesn't have it.
@@ -1682,12 +1924,67 @@ void World::BuildSceneMsg(msgs::Scene &_scene, BasePtr _entity)
 
 
 //////////////////////////////////////////////////
-// void World::ModelUpdateTBB()
-// {
-//   tbb::parallel_for (tbb::blocked_range<size_t>(0,
-//   this->dataPtr->models.size(), 10),
-//       ModelUpdate_TBB(&this->dataPtr->models));
-// }
+void World::SetModelUpdateThreads(const unsigned int _threads)
+{
+  std::lock_guard<std::recursive_mutex> lock(this->dataPtr->worldUpdateMutex);
+
+  this->dataPtr->modelUpdateThreads = _threads;
+  if (_threads > 0)
+  {
+    this->dataPtr->modelUpdateArena.reset(new tbb::task_arena(_threads));
+    this->dataPtr->modelUpdateFunc = &World::ModelUpdateTBB;
+  }
+  else
+  {
+    this->dataPtr->modelUpdateArena.reset();
+    this->dataPtr->modelUpdateFunc = &World::ModelUpdateSingleLoop;
+  }
+}
+
+//////////////////////////////////////////////////
+unsigned int World::ModelUpdateThreads() const
+{
+  return this->dataPtr->modelUpdateThreads;
+}
+
+//////////////////////////////////////////////////
+void World::ModelUpdateTBB()
+{
+  this->dataPtr->parallelUpdateModels.clear();
+  this->dataPtr->serialUpdateEntities.clear();
+
+  for (unsigned int i = 0; i < this->dataPtr->rootElement->GetChildCount(); ++i)
+  {
+    BasePtr child = this->dataPtr->rootElement->GetChild(i);
+    if (child->HasType(Base::MODEL))
+    {
+      ModelPtr model = boost::static_pointer_cast<Model>(child);
+
+      // Static models have nothing to update
+      if (model->IsStatic())
+        continue;
+
+      if (ModelUpdateIsolated(model, model))
+      {
+        this->dataPtr->parallelUpdateModels.push_back(model);
+        continue;
+      }
+    }
+    this->dataPtr->serialUpdateEntities.push_back(child);
+  }
+
+  Model_V *models = &this->dataPtr->parallelUpdateModels;
+  this->dataPtr->modelUpdateArena->execute([models]()
+  {
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, models->size()),
+        ModelUpdate_TBB(models));
+  });
+
+  // Models with joints to other models could touch state owned by a model
+  // that is being updated concurrently, so they are updated afterwards.
+  for (auto &entity : this->dataPtr->serialUpdateEntities)
+    entity->Update();
+}
 
 //////////////////////////////////////////////////
 void World::ModelUpdateSingleLoop()
@@ -2686,9 +2983,9 @@ bool World::OnLog(std::ostringstream &_stream)
     // Clear everything.
     this->dataPtr->states[0].clear();
     this->dataPtr->states[1].clear();
-    this->dataPtr->stateToggle = 0;
-    this->dataPtr->prevStates[0] = WorldState();
-    this->dataPtr->prevStates[1] = WorldState();
+
+    // Make sure the next log starts with a complete state
+    this->dataPtr->logStateChanged = true;
   }
 
   this->LogModelResources();
@@ -2702,86 +2999,30 @@ void World::ProcessMessages()
   {
     std::lock_guard<std::recursive_mutex> lock(this->dataPtr->receiveMutex);
 
-    if ((this->dataPtr->posePub && this->dataPtr->posePub->HasConnections()) ||
-      // When ready to use the direct API for updating scene poses from server,
-      // uncomment the following line:
-         this->dataPtr->updateScenePoses ||
-        (this->dataPtr->poseLocalPub &&
-         this->dataPtr->poseLocalPub->HasConnections()))
-    {
-      msgs::PosesStamped msg;
-
-      // Time stamp this PosesStamped message
-      msgs::Set(msg.mutable_time(), this->SimTime());
-
-      if (!this->dataPtr->publishModelPoses.empty() ||
-          !this->dataPtr->publishLightPoses.empty())
-      {
-        for (auto const &model : this->dataPtr->publishModelPoses)
-        {
-          std::list<ModelPtr> modelList;
-          modelList.push_back(model);
-          while (!modelList.empty())
-          {
-            ModelPtr m = modelList.front();
-            modelList.pop_front();
-            msgs::Pose *poseMsg = msg.add_pose();
-
-            // Publish the model's relative pose
-            poseMsg->set_name(m->GetScopedName());
-            poseMsg->set_id(m->GetId());
-            msgs::Set(poseMsg, m->RelativePose());
-
-            // Publish each of the model's child links relative poses
-            Link_V links = m->GetLinks();
-            for (auto const &link : links)
-            {
-              poseMsg = msg.add_pose();
-              poseMsg->set_name(link->GetScopedName());
-              poseMsg->set_id(link->GetId());
-              msgs::Set(poseMsg, link->RelativePose());
-            }
-
-            // add all nested models to the queue
-            Model_V models = m->NestedModels();
-            for (auto const &n : models)
-              modelList.push_back(n);
-          }
-        }
+    // The publish thread checks for subscribers, so the physics thread
+    // doesn't wait on the transport locks.
+    bool subscribers = this->dataPtr->publishThread ?
+        this->dataPtr->poseSubscribers.load() : this->PoseSubscribers();
 
-        for (auto const &light : this->dataPtr->publishLightPoses)
-        {
-          msgs::Pose *poseMsg = msg.add_pose();
+    if (subscribers || this->dataPtr->updateScenePoses)
+      this->SnapshotPoses();
 
-          // Publish the light's pose
-          poseMsg->set_name(light->GetScopedName());
-          poseMsg->set_id(light->GetId());
-          msgs::Set(poseMsg, light->RelativePose());
-        }
+    this->dataPtr->publishModelPoses.clear();
+    this->dataPtr->publishLightPoses.clear();
+  }
 
-        if (this->dataPtr->posePub && this->dataPtr->posePub->HasConnections())
-          this->dataPtr->posePub->Publish(msg);
-      }
+  // In lockstep the scene must receive the poses of this step before the
+  // sensors render, so they are published on the physics thread.
+  if (!this->dataPtr->publishThread || this->dataPtr->updateScenePoses)
+    this->PublishPoseSnapshot();
 
-      if (this->dataPtr->poseLocalPub &&
-          this->dataPtr->poseLocalPub->HasConnections())
-      {
-        // rendering::Scene depends on this timestamp, which is used by
-        // rendering sensors to time stamp their data
-        this->dataPtr->poseLocalPub->Publish(msg);
-      }
-
-      // When ready to use the direct API for updating scene poses from server,
-      // uncomment the following lines:
-      // Execute callback to export Pose msg
-      if (this->dataPtr->updateScenePoses)
-      {
-        this->dataPtr->updateScenePoses(this->Name(), msg);
-      }
+  if (this->dataPtr->publishThread)
+  {
+    {
+      std::lock_guard<std::mutex> lock(this->dataPtr->publishMutex);
+      this->dataPtr->publishRequested = true;
     }
-
-    this->dataPtr->publishModelPoses.clear();
-    this->dataPtr->publishLightPoses.clear();
+    this->dataPtr->publishCondition.notify_one();
   }
 
   {
@@ -2866,6 +3107,194 @@ void World::ProcessMessages()
   }
 }
 
+//////////////////////////////////////////////////
+bool World::PoseSubscribers() const
+{
+  return (this->dataPtr->posePub &&
+          this->dataPtr->posePub->HasConnections()) ||
+         (this->dataPtr->poseLocalPub &&
+          this->dataPtr->poseLocalPub->HasConnections());
+}
+
+//////////////////////////////////////////////////
+/// \brief Append the relative pose of an entity to a pose snapshot.
+/// \param[in,out] _snapshot The snapshot.
+/// \param[in] _entity The entity.
+static void AddPoseRecord(PoseSnapshot &_snapshot, const Entity &_entity)
+{
+  if (_snapshot.count == _snapshot.poses.size())
+    _snapshot.poses.emplace_back();
+
+  PoseRecord &record = _snapshot.poses[_snapshot.count++];
+  record.id = _entity.GetId();
+  record.name = _entity.GetScopedName();
+  record.pose = _entity.RelativePose();
+}
+
+//////////////////////////////////////////////////
+void World::SnapshotPoses()
+{
+  PoseSnapshot &snapshot = this->dataPtr->poseFill;
+
+  // Time stamp this PosesStamped message
+  snapshot.time = this->SimTime();
+  snapshot.count = 0;
+  snapshot.merged = false;
+
+  auto &queue = this->dataPtr->poseModelQueue;
+  for (auto const &model : this->dataPtr->publishModelPoses)
+  {
+    queue.clear();
+    queue.push_back(model.get());
+    for (size_t i = 0; i < queue.size(); ++i)
+    {
+      Model *m = queue[i];
+
+      // Publish the model's relative pose
+      AddPoseRecord(snapshot, *m);
+
+      // Publish each of the model's child links relative poses
+      for (auto const &link : m->GetLinks())
+        AddPoseRecord(snapshot, *link);
+
+      // add all nested models to the queue
+      for (auto const &n : m->NestedModels())
+        queue.push_back(n.get());
+    }
+  }
+
+  // Publish the light's pose
+  for (auto const &light : this->dataPtr->publishLightPoses)
+    AddPoseRecord(snapshot, *light);
+
+  snapshot.ready = true;
+
+  std::lock_guard<std::mutex> lock(this->dataPtr->poseSnapshotMutex);
+  PoseSnapshot &pending = this->dataPtr->posePending;
+  if (!pending.ready)
+  {
+    std::swap(snapshot, pending);
+  }
+  else
+  {
+    // The publish thread fell behind. Merge the poses into the pending
+    // snapshot, so its message has the latest pose of every entity that
+    // moved since the previous message. Each entity keeps a single record,
+    // so the snapshot never grows beyond the number of entities.
+    auto &index = this->dataPtr->posePendingIndex;
+    if (!pending.merged)
+    {
+      index.clear();
+      for (size_t i = 0; i < pending.count; ++i)
+        index[pending.poses[i].id] = i;
+    }
+
+    for (size_t i = 0; i < snapshot.count; ++i)
+    {
+      const PoseRecord &record = snapshot.poses[i];
+      auto iter = index.find(record.id);
+      if (iter != index.end())
+      {
+        pending.poses[iter->second] = record;
+        continue;
+      }
+
+      if (pending.count == pending.poses.size())
+        pending.poses.emplace_back();
+      index[record.id] = pending.count;
+      pending.poses[pending.count++] = record;
+    }
+    pending.time = snapshot.time;
+    pending.merged = true;
+  }
+  snapshot.ready = false;
+}
+
+//////////////////////////////////////////////////
+bool World::PublishPoseSnapshot()
+{
+  std::lock_guard<std::mutex> publishLock(this->dataPtr->posePublishMutex);
+
+  {
+    std::lock_guard<std::mutex> lock(this->dataPtr->poseSnapshotMutex);
+    if (!this->dataPtr->posePending.ready)
+      return false;
+    std::swap(this->dataPtr->posePending, this->dataPtr->posePublish);
+    this->dataPtr->posePending.ready = false;
+  }
+
+  const PoseSnapshot &snapshot = this->dataPtr->posePublish;
+
+  msgs::PosesStamped msg;
+  msgs::Set(msg.mutable_time(), snapshot.time);
+  for (size_t i = 0; i < snapshot.count; ++i)
+  {
+    const PoseRecord &record = snapshot.poses[i];
+    msgs::Pose *poseMsg = msg.add_pose();
+    poseMsg->set_name(record.name);
+    poseMsg->set_id(record.id);
+    msgs::Set(poseMsg, record.pose);
+  }
+
+  if (snapshot.count > 0 &&
+      this->dataPtr->posePub && this->dataPtr->posePub->HasConnections())
+  {
+    this->dataPtr->posePub->Publish(msg);
+  }
+
+  if (this->dataPtr->poseLocalPub &&
+      this->dataPtr->poseLocalPub->HasConnections())
+  {
+    // rendering::Scene depends on this timestamp, which is used by
+    // rendering sensors to time stamp their data
+    this->dataPtr->poseLocalPub->Publish(msg);
+  }
+
+  // Execute callback to export Pose msg
+  if (this->dataPtr->updateScenePoses)
+    this->dataPtr->updateScenePoses(this->Name(), msg);
+
+  this->dataPtr->posePublish.ready = false;
+  return true;
+}
+
+//////////////////////////////////////////////////
+void World::PublishWorker()
+{
+  IGN_PROFILE_THREAD_NAME("World::PublishWorker");
+
+  std::unique_lock<std::mutex> lock(this->dataPtr->publishMutex);
+  while (!this->dataPtr->publishStop)
+  {
+    // Also wake up periodically, to notice new pose subscribers.
+    this->dataPtr->publishCondition.wait_for(lock,
+        std::chrono::milliseconds(100), [this]
+        {
+          return this->dataPtr->publishRequested ||
+                 this->dataPtr->publishStop;
+        });
+    this->dataPtr->publishRequested = false;
+    lock.unlock();
+
+    // Requests made while the messages are published are served by the
+    // next iteration, with the data of the latest steps.
+    this->dataPtr->poseSubscribers = this->PoseSubscribers();
+
+    if (!this->dataPtr->updateScenePoses)
+    {
+      IGN_PROFILE("PublishPoses");
+      this->PublishPoseSnapshot();
+    }
+
+    {
+      IGN_PROFILE("PublishContacts");
+      this->dataPtr->physicsEngine->GetContactManager()->PublishSnapshot();
+    }
+
+    lock.lock();
+  }
+}
+
 //////////////////////////////////////////////////
 void World::PublishWorldStats()
 {
@@ -2911,6 +3340,12 @@ void World::PublishModelPose(physics::ModelPtr _model)
 
   // Only add if the model name is not in the list
   this->dataPtr->publishModelPoses.insert(_model);
+
+  if (_model && util::LogRecord::Instance()->Running())
+  {
+    std::lock_guard<std::mutex> logLock(this->dataPtr->logChangeMutex);
+    this->dataPtr->logChangedModels.insert(_model);
+  }
 }
 
 //////////////////////////////////////////////////
@@ -2929,6 +3364,12 @@ void World::PublishLightPose(const physics::LightPtr _light)
 
   // Only add if the light name is not in the list
   this->dataPtr->publishLightPoses.insert(_light);
+
+  if (_light && util::LogRecord::Instance()->Running())
+  {
+    std::lock_guard<std::mutex> logLock(this->dataPtr->logChangeMutex);
+    this->dataPtr->logChangedLights.insert(_light);
+  }
 }
 
 //////////////////////////////////////////////////
@@ -2941,72 +3382,107 @@ void World::LogWorker()
 
   GZ_ASSERT(self, "Self pointer to World is invalid");
 
-  // Init the prevUnfilteredState
-  this->dataPtr->prevUnfilteredState.Load(self);
-
   while (!this->dataPtr->stop)
   {
-    // get unfiltered world state
-    WorldState unfilteredState;
+    // Take the changes recorded since the previous iteration. A resync
+    // reloads everything, so the changes can be discarded in that case.
+    bool resync = this->dataPtr->logResync.exchange(false);
+    Model_V changedModels;
+    Light_V changedLights;
+    Model_V insertedModels;
+    Light_V insertedLights;
+    std::vector<std::string> deletions;
     {
-      std::lock_guard<std::mutex> dLock(this->dataPtr->entityDeleteMutex);
-      unfilteredState.Load(self);
+      std::lock_guard<std::mutex> cLock(this->dataPtr->logChangeMutex);
+      if (!resync)
+      {
+        changedModels.assign(this->dataPtr->logChangedModels.begin(),
+            this->dataPtr->logChangedModels.end());
+        changedLights.assign(this->dataPtr->logChangedLights.begin(),
+            this->dataPtr->logChangedLights.end());
+        insertedModels.swap(this->dataPtr->logInsertedModels);
+        insertedLights.swap(this->dataPtr->logInsertedLights);
+        deletions.swap(this->dataPtr->logDeletions);
+      }
+      this->dataPtr->logChangedModels.clear();
+      this->dataPtr->logChangedLights.clear();
+      this->dataPtr->logInsertedModels.clear();
+      this->dataPtr->logInsertedLights.clear();
+      this->dataPtr->logDeletions.clear();
+    }
+
+    // Only compile the filter when it changes
+    std::string filterStr = util::LogRecord::Instance()->Filter();
+    if (filterStr != this->dataPtr->logFilter)
+    {
+      this->dataPtr->logFilter = filterStr;
+      this->dataPtr->logFiltered = WorldState::ModelFilterRegex(filterStr,
+          this->dataPtr->logFilterRegex);
+      resync = true;
     }
 
-    // compute world state diff and find out about insertions and deletions
+    // Insertions and deletions are recorded for all entities, regardless
+    // of the filter.
     std::vector<std::string> insertions;
-    std::vector<std::string> deletions;
-    bool insertDelete = false;
+    for (auto const &model : insertedModels)
+      insertions.push_back(model->UnscaledSDF()->ToString(""));
+    for (auto const &light : insertedLights)
+      insertions.push_back(light->GetSDF()->ToString(""));
+    bool insertDelete = !insertions.empty() || !deletions.empty();
 
+    if (resync)
+    {
+      std::lock_guard<std::mutex> dLock(this->dataPtr->entityDeleteMutex);
+      this->dataPtr->logState.LoadWithFilter(self, filterStr);
+      this->dataPtr->logStateChanged = true;
+    }
+    else
     {
-      WorldState unfilteredDiffState = unfilteredState -
-          this->dataPtr->prevUnfilteredState;
-      if (!unfilteredDiffState.IsZero())
+      // Reload the state of the changed models that pass the filter
+      if (this->dataPtr->logFiltered)
+      {
+        changedModels.erase(std::remove_if(changedModels.begin(),
+            changedModels.end(), [this](const ModelPtr &_model)
+            {
+              return !boost::regex_match(_model->GetName(),
+                  this->dataPtr->logFilterRegex);
+            }), changedModels.end());
+      }
+
+      if (!changedModels.empty() || !changedLights.empty() ||
+          !deletions.empty())
       {
-        insertions = unfilteredDiffState.Insertions();
-        deletions = unfilteredDiffState.Deletions();
-        insertDelete = !insertions.empty() || !deletions.empty();
+        this->dataPtr->logStateChanged = true;
       }
+
+      std::lock_guard<std::mutex> dLock(this->dataPtr->entityDeleteMutex);
+      this->dataPtr->logState.LoadChanged(self, changedModels, changedLights,
+          deletions);
     }
-    this->dataPtr->prevUnfilteredState = unfilteredState;
 
     // Throttle state capture based on log recording frequency.
     auto simTime = this->SimTime();
     if ((simTime - this->dataPtr->logLastStateTime >=
         util::LogRecord::Instance()->Period()) || insertDelete)
     {
-      int currState = (this->dataPtr->stateToggle + 1) % 2;
-
-      std::string filterStr = util::LogRecord::Instance()->Filter();
-      // compute diff for filtered states
-      {
-        std::lock_guard<std::mutex> dLock(this->dataPtr->entityDeleteMutex);
-        this->dataPtr->prevStates[currState].LoadWithFilter(self, filterStr);
-      }
-      WorldState diffState = this->dataPtr->prevStates[currState] -
-          this->dataPtr->prevStates[this->dataPtr->stateToggle];
       this->dataPtr->logPrevIteration = this->dataPtr->iterations;
 
-      if (!diffState.IsZero() || insertDelete)
+      if (this->dataPtr->logStateChanged || insertDelete)
       {
-        this->dataPtr->stateToggle = currState;
-        {
-          // Store the entire current state (instead of the diffState). A slow
-          // moving link may never be captured if only diff state is recorded.
-          std::lock_guard<std::mutex> bLock(this->dataPtr->logBufferMutex);
-
-          this->dataPtr->prevStates[currState].SetInsertions(insertions);
-          this->dataPtr->prevStates[currState].SetDeletions(deletions);
-          this->dataPtr->states[this->dataPtr->currentStateBuffer].push_back(
-              this->dataPtr->prevStates[currState]);
-
-          // Tell the logger to update, once the number of states exceeds 1000
-          if (this->dataPtr->states[this->dataPtr->currentStateBuffer].size() >
-              1000)
-          {
-            util::LogRecord::Instance()->Notify();
-          }
-        }
+        this->dataPtr->logStateChanged = false;
+
+        // Store the entire current state (instead of only the changes). A
+        // slow moving link may never be captured if only diffs are recorded.
+        std::lock_guard<std::mutex> bLock(this->dataPtr->logBufferMutex);
+
+        auto &buffer = this->dataPtr->states[this->dataPtr->currentStateBuffer];
+        buffer.push_back(this->dataPtr->logState);
+        buffer.back().SetInsertions(insertions);
+        buffer.back().SetDeletions(deletions);
+
+        // Tell the logger to update, once the number of states exceeds 1000
+        if (buffer.size() > 1000)
+          util::LogRecord::Instance()->Notify();
       }
 
       this->dataPtr->logLastStateTime = simTime;
@@ -3151,6 +3627,33 @@ void World::RemoveModel(const std::string &_name)
       }
     }
   }
+
+  // Tell the log worker about the deletion.
+  {
+    std::lock_guard<std::mutex> lock2(this->dataPtr->logChangeMutex);
+    for (auto model = this->dataPtr->logChangedModels.begin();
+             model != this->dataPtr->logChangedModels.end(); ++model)
+    {
+      if ((*model)->GetName() == _name || (*model)->GetScopedName() == _name)
+      {
+        this->dataPtr->logChangedModels.erase(model);
+        break;
+      }
+    }
+
+    for (auto light = this->dataPtr->logChangedLights.begin();
+             light != this->dataPtr->logChangedLights.end(); ++light)
+    {
+      if ((*light)->GetName() == _name || (*light)->GetScopedName() == _name)
+      {
+        this->dataPtr->logChangedLights.erase(light);
+        break;
+      }
+    }
+
+    if (util::LogRecord::Instance()->Running())
+      this->dataPtr->logDeletions.push_back(_name);
+  }
 }
 
 /////////////////////////////////////////////////
@@ -151,6 +151,11 @@ namespace gazebo
       /// \return Pointer to the preset manager.
       public: PresetManagerPtr PresetMgr() const;
 
+      /// \brief Get a reference to the batched ray query engine of the
+      /// world, which casts rays without going through the physics engine.
+      /// \return Reference to the ray query engine.
+      public: physics::RayQuery &RayQuery() const;
+
       /// \brief Get a reference to the wind used by the world.
       /// \return Reference to the wind.
       public: physics::Wind &Wind() const;
@@ -179,6 +184,23 @@ namespace gazebo
       /// \param[in] _mag New magnetic field vector.
       public: void SetMagneticField(const ignition::math::Vector3d &_mag);
 
+      /// \brief Set the number of threads used to update models.
+      /// With zero threads all models are updated serially on the physics
+      /// thread. Otherwise, top-level models whose joints only connect
+      /// their own links are updated concurrently, and remaining models are
+      /// updated serially afterwards. A model updated concurrently may only
+      /// touch its own links, joints and joint controller; Joint update
+      /// callbacks connected by plugins must be thread-safe in this mode.
+      /// This can also be set through the "model_update_threads" physics
+      /// parameter.
+      /// \param[in] _threads Number of model update threads.
+      public: void SetModelUpdateThreads(const unsigned int _threads);
+
+      /// \brief Get the number of threads used to update models.
+      /// \return Number of model update threads, zero if models are updated
+      /// serially.
+      public: unsigned int ModelUpdateThreads() const;
+
       /// \brief Get the number of models.
       /// \return The number of models in the World.
       public: unsigned int ModelCount() const;
@@ -249,11 +271,19 @@ namespace gazebo
 
       /// \brief Get an element by name.
       /// Searches the list of entities, and return a pointer to the model
-      /// with a matching _name.
+      /// with a matching _name. The _name can be a scoped name, or the
+      /// name of the entity. The search uses an index of the entities, so
+      /// it doesn't depend on the number of entities in the world.
       /// \param[in] _name The name of the Model to find.
       /// \return A pointer to the entity, or NULL if no entity was found.
       public: BasePtr BaseByName(const std::string &_name) const;
 
+      /// \brief Get an element by id.
+      /// \param[in] _id The id of the element to find.
+      /// \return A pointer to the entity, or NULL if no entity was found.
+      /// \sa Base::GetId
+      public: BasePtr BaseById(const uint32_t _id) const;
+
       /// \brief Get a model by name.
       /// This function is the same as BaseByName, but limits the search to
       /// only models.
@@ -438,6 +468,22 @@ namespace gazebo
       /// \param[in] _entity Entity that has moved.
       public: void _AddDirty(Entity *_entity);
 
+      /// \internal
+      /// \brief Add an entity to the index used by BaseByName and
+      /// BaseById. Only Base should call this function.
+      /// \param[in] _entity Entity to add, under its current name, scoped
+      /// name and id.
+      public: void _AddToEntityIndex(const BasePtr &_entity);
+
+      /// \internal
+      /// \brief Remove an entity from the index used by BaseByName and
+      /// BaseById. Only Base should call this function.
+      /// \param[in] _id Id of the entity.
+      /// \param[in] _name Name the entity was added with.
+      /// \param[in] _scopedName Scoped name the entity was added with.
+      public: void _RemoveFromEntityIndex(const uint32_t _id,
+                  const std::string &_name, const std::string &_scopedName);
+
       /// \brief Get whether sensors have been initialized.
       /// \return True if sensors have been initialized.
       public: bool SensorsInitialized() const;
@@ -557,7 +603,8 @@ namespace gazebo
       /// \param[in] _msg The model message.
       private: void OnModelMsg(ConstModelPtr &_msg);
 
-      /// \brief TBB version of model updating.
+      /// \brief TBB version of model updating. Updates isolated models in
+      /// parallel, see SetModelUpdateThreads.
       private: void ModelUpdateTBB();
 
       /// \brief Single loop version of model updating.
@@ -616,6 +663,22 @@ namespace gazebo
       /// \brief Thread function for logging state data.
       private: void LogWorker();
 
+      /// \brief Thread function that builds and publishes the pose and
+      /// contact messages copied by the physics thread.
+      private: void PublishWorker();
+
+      /// \brief Copy the poses of the entities that moved, to be
+      /// published by PublishPoseSnapshot.
+      private: void SnapshotPoses();
+
+      /// \brief Publish the poses copied by SnapshotPoses.
+      /// \return True if a snapshot was published.
+      private: bool PublishPoseSnapshot();
+
+      /// \brief Check if the pose topics have subscribers.
+      /// \return True if the pose topics have subscribers.
+      private: bool PoseSubscribers() const;
+
       /// \brief Register items in the introspection service.
       private: void RegisterIntrospectionItems();
 
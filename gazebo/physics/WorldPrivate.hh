@@ -17,18 +17,25 @@
 #ifndef GAZEBO_PHYSICS_WORLDPRIVATE_HH_
 #define GAZEBO_PHYSICS_WORLDPRIVATE_HH_
 
+#include <tbb/task_arena.h>
+
+#include <boost/regex.hpp>
+#include <boost/weak_ptr.hpp>
+
 #include <atomic>
 #include <deque>
 #include <vector>
 #include <list>
 #include <memory>
 #include <set>
+#include <unordered_map>
 #include <sdf/sdf.hh>
 #include <string>
 #include <mutex>
 #include <thread>
 #include <condition_variable>
 
+#include <ignition/math/Pose3.hh>
 #include <ignition/transport.hh>
 
 #include "gazebo/common/Event.hh"
@@ -39,6 +46,7 @@
 
 #include "gazebo/transport/TransportTypes.hh"
 
+#include "gazebo/physics/LogPlayPrefetcher.hh"
 #include "gazebo/physics/PhysicsTypes.hh"
 #include "gazebo/physics/WorldState.hh"
 
@@ -46,6 +54,41 @@ namespace gazebo
 {
   namespace physics
   {
+    /// \brief Relative pose of an entity, copied on the physics thread.
+    class PoseRecord
+    {
+      /// \brief Id of the entity.
+      public: uint32_t id = 0;
+
+      /// \brief Scoped name of the entity.
+      public: std::string name;
+
+      /// \brief Pose of the entity relative to its parent.
+      public: ignition::math::Pose3d pose;
+    };
+
+    /// \brief Poses of the entities that moved, waiting to be published
+    /// in a msgs::PosesStamped message.
+    class PoseSnapshot
+    {
+      /// \brief Pose records. Only the first count are valid, the others
+      /// are kept to reuse their memory.
+      public: std::vector<PoseRecord> poses;
+
+      /// \brief Number of valid records.
+      public: size_t count = 0;
+
+      /// \brief Simulation time of the last step in the snapshot.
+      public: common::Time time;
+
+      /// \brief True if the snapshot holds several steps. Each entity
+      /// still has a single record, with its latest pose.
+      public: bool merged = false;
+
+      /// \brief True if the snapshot has not been published yet.
+      public: bool ready = false;
+    };
+
     /// \brief Private data class for World.
     class WorldPrivate
     {
@@ -62,6 +105,9 @@ namespace gazebo
       /// The world owns this pointer.
       public: std::unique_ptr<Atmosphere> atmosphere;
 
+      /// \brief Batched ray query engine. The world owns this pointer.
+      public: std::unique_ptr<RayQuery> rayQuery;
+
       /// \brief Pointer the spherical coordinates data.
       public: common::SphericalCoordinatesPtr sphericalCoordinates;
 
@@ -158,6 +204,19 @@ namespace gazebo
       /// \brief Function pointer to the model update function.
       public: void (World::*modelUpdateFunc)();
 
+      /// \brief Number of threads used to update models. Zero updates
+      /// models serially.
+      public: unsigned int modelUpdateThreads = 0;
+
+      /// \brief Task arena that bounds model update concurrency.
+      public: std::unique_ptr<tbb::task_arena> modelUpdateArena;
+
+      /// \brief Models updated concurrently during the current step.
+      public: Model_V parallelUpdateModels;
+
+      /// \brief Entities updated serially during the current step.
+      public: Base_V serialUpdateEntities;
+
       /// \brief Last time a world statistics message was sent.
       public: common::Time prevStatTime;
 
@@ -176,6 +235,18 @@ namespace gazebo
       /// \brief Mutex to protext loading of lights.
       public: std::mutex loadLightMutex;
 
+      /// \brief Entities by scoped name, and by name if it differs from
+      /// the scoped name. Each value holds the id of the entity, which
+      /// is used to remove it.
+      public: std::unordered_multimap<std::string,
+              std::pair<uint32_t, boost::weak_ptr<Base>>> entityNames;
+
+      /// \brief Entities by id.
+      public: std::unordered_map<uint32_t, boost::weak_ptr<Base>> entityIds;
+
+      /// \brief Mutex to protect entityNames and entityIds.
+      public: mutable std::mutex entityIndexMutex;
+
       /// \TODO: Add an accessor for this, and make it private
       /// Used in Entity.cc.
       /// Entity::Reset to call Entity::SetWorldPose and Entity::SetRelativePose
@@ -265,15 +336,48 @@ namespace gazebo
       /// \brief Keep track of current state buffer being updated
       public: int currentStateBuffer;
 
-      /// \brief Buffer of prev states
-      public: WorldState prevStates[2];
+      /// \brief Filtered world state kept up to date by the log worker.
+      /// Only entities that changed are reloaded on each log iteration.
+      public: WorldState logState;
+
+      /// \brief Filter string logState was built with.
+      public: std::string logFilter;
 
-      /// \brief Previous unfiltered state. Used for determining insertions
-      /// and deletions
-      public: WorldState prevUnfilteredState;
+      /// \brief Model name regex compiled from logFilter.
+      public: boost::regex logFilterRegex;
 
-      /// \brief Int used to toggle between prevStates
-      public: int stateToggle;
+      /// \brief True if logFilterRegex must be applied to model names.
+      public: bool logFiltered = false;
+
+      /// \brief True when logState changed since the last recorded state.
+      public: std::atomic_bool logStateChanged;
+
+      /// \brief True when the log worker must reload logState from the
+      /// whole world, e.g. because changes were not tracked.
+      public: std::atomic_bool logResync;
+
+      /// \brief True while changes are tracked for the log worker. Only
+      /// accessed by the physics thread.
+      public: bool logRecording = false;
+
+      /// \brief Mutex to protect the log change lists.
+      public: std::mutex logChangeMutex;
+
+      /// \brief Models whose state changed since the last log iteration.
+      public: std::set<ModelPtr> logChangedModels;
+
+      /// \brief Lights whose state changed since the last log iteration.
+      public: std::set<LightPtr> logChangedLights;
+
+      /// \brief Models inserted since the last log iteration.
+      public: Model_V logInsertedModels;
+
+      /// \brief Lights inserted since the last log iteration.
+      public: Light_V logInsertedLights;
+
+      /// \brief Names of the models and lights deleted since the last log
+      /// iteration.
+      public: std::vector<std::string> logDeletions;
 
       /// \brief State from from log file.
       public: sdf::ElementPtr logPlayStateSDF;
@@ -281,6 +385,10 @@ namespace gazebo
       /// \brief Current state when playing from a log file.
       public: WorldState logPlayState;
 
+      /// \brief Decodes the log ahead of playback, null when the log is
+      /// decoded on the world thread.
+      public: std::unique_ptr<LogPlayPrefetcher> logPlayPrefetcher;
+
       /// \brief Store a factory SDF object to improve speed at which
       /// objects are inserted via the factory.
       public: sdf::SDFPtr factorySDF;
@@ -383,6 +491,49 @@ namespace gazebo
       /// \brief Callback function intended to call the scene with updated Poses
       public: UpdateScenePosesFunc updateScenePoses;
 
+      /// \brief Thread that builds and publishes the pose and contact
+      /// messages, so the physics thread only copies their data.
+      public: std::thread *publishThread = nullptr;
+
+      /// \brief Protects publishRequested and publishStop.
+      public: std::mutex publishMutex;
+
+      /// \brief Wakes up the publish thread.
+      public: std::condition_variable publishCondition;
+
+      /// \brief True when the physics thread has new data to publish.
+      public: bool publishRequested = false;
+
+      /// \brief True when the publish thread must exit.
+      public: bool publishStop = false;
+
+      /// \brief True if the pose topics had subscribers when the publish
+      /// thread last checked.
+      public: std::atomic<bool> poseSubscribers{false};
+
+      /// \brief Poses being copied by the physics thread.
+      public: PoseSnapshot poseFill;
+
+      /// \brief Poses waiting to be published.
+      public: PoseSnapshot posePending;
+
+      /// \brief Poses being published.
+      public: PoseSnapshot posePublish;
+
+      /// \brief Protects posePending. It is only held to swap or merge
+      /// the snapshots.
+      public: std::mutex poseSnapshotMutex;
+
+      /// \brief Serializes the publication of pose snapshots.
+      public: std::mutex posePublishMutex;
+
+      /// \brief Models whose poses are being copied, reused every step.
+      public: std::vector<Model *> poseModelQueue;
+
+      /// \brief Index of the record of each entity in posePending, once
+      /// it holds several steps. Protected by poseSnapshotMutex.
+      public: std::unordered_map<uint32_t, size_t> posePendingIndex;
+
       /// \brief SDF World DOM object
       public: std::unique_ptr<sdf::World> worldSDFDom;
     };
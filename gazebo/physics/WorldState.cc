@@ -99,37 +99,16 @@ void WorldState::Load(const WorldPtr _world)
   this->insertions.clear();
   this->deletions.clear();
 
-  std::string filter = worldStateFilter;
-  std::list<std::string> mainParts, parts;
-  boost::split(mainParts, filter, boost::is_any_of("/"));
-
-  // Create the model filter
-  if (!mainParts.empty())
-  {
-    boost::split(parts, mainParts.front(), boost::is_any_of("."));
-    if (parts.empty() && !mainParts.front().empty())
-      parts.push_back(mainParts.front());
-  }
-  std::list<std::string>::iterator partIter = parts.begin();
+  // The filter regex is compiled once for all the models
+  boost::regex regex;
+  bool filtered = ModelFilterRegex(worldStateFilter, regex);
 
   // Add a state for all the models that match the filter
   Model_V models = _world->Models();
   for (Model_V::const_iterator iter = models.begin();
        iter != models.end(); ++iter)
   {
-    bool add = true;
-
-    // The first element in the filter must be a model name or a star.
-    if (partIter != parts.end() && !parts.empty() &&
-        !(*partIter).empty() && (*partIter) != "*")
-    {
-      std::string regexStr = *partIter;
-      boost::replace_all(regexStr, "*", ".*");
-      boost::regex regex(regexStr);
-      add = boost::regex_match((*iter)->GetName(), regex);
-    }
-
-    if (add)
+    if (!filtered || boost::regex_match((*iter)->GetName(), regex))
     {
       this->modelStates[(*iter)->GetName()].Load(*iter, this->realTime,
           this->simTime, this->iterations);
@@ -157,6 +136,58 @@ void WorldState::Load(const WorldPtr _world)
   }
 }
 
+/////////////////////////////////////////////////
+void WorldState::LoadChanged(const WorldPtr _world, const Model_V &_models,
+    const Light_V &_lights, const std::vector<std::string> &_removed)
+{
+  this->world = _world;
+  this->name = _world->Name();
+  this->wallTime = common::Time::GetWallTime();
+  this->simTime = _world->SimTime();
+  this->realTime = _world->RealTime();
+  this->iterations = _world->Iterations();
+  this->insertions.clear();
+  this->deletions.clear();
+
+  for (const auto &removed : _removed)
+  {
+    this->modelStates.erase(removed);
+    this->lightStates.erase(removed);
+  }
+
+  for (const auto &model : _models)
+  {
+    this->modelStates[model->GetName()].Load(model, this->realTime,
+        this->simTime, this->iterations);
+  }
+
+  for (const auto &light : _lights)
+  {
+    this->lightStates[light->GetName()].Load(light, this->realTime,
+        this->simTime, this->iterations);
+  }
+}
+
+/////////////////////////////////////////////////
+bool WorldState::ModelFilterRegex(const std::string &_filter,
+    boost::regex &_regex)
+{
+  std::list<std::string> mainParts, parts;
+  boost::split(mainParts, _filter, boost::is_any_of("/"));
+
+  // The first element in the filter must be a model name or a star.
+  if (!mainParts.empty())
+    boost::split(parts, mainParts.front(), boost::is_any_of("."));
+
+  if (parts.empty() || parts.front().empty() || parts.front() == "*")
+    return false;
+
+  std::string regexStr = parts.front();
+  boost::replace_all(regexStr, "*", ".*");
+  _regex.assign(regexStr);
+  return true;
+}
+
 /////////////////////////////////////////////////
 void WorldState::Load(const sdf::ElementPtr _elem)
 {
@@ -461,12 +492,10 @@ WorldState &WorldState::operator=(const WorldState &_state)
   }
 
   // Copy the insertions
-  std::copy(_state.insertions.begin(),
-            _state.insertions.end(), this->insertions.begin());
+  this->insertions = _state.insertions;
 
   // Copy the deletions
-  std::copy(_state.deletions.begin(),
-            _state.deletions.end(), this->deletions.begin());
+  this->deletions = _state.deletions;
 
   return *this;
 }
@@ -78,6 +78,28 @@ namespace gazebo
       public: void LoadWithFilter(const WorldPtr _world,
           const std::string &_filter);
 
+      /// \brief Update the state from a World, reloading only the given
+      /// entities.
+      ///
+      /// The states of _models and _lights are reloaded, the states named
+      /// in _removed are dropped and all other states are kept as they are.
+      /// Time information is always taken from the world.
+      /// \param[in] _world Pointer to a world
+      /// \param[in] _models Top-level models whose state changed.
+      /// \param[in] _lights Lights whose state changed.
+      /// \param[in] _removed Names of models and lights that were removed.
+      public: void LoadChanged(const WorldPtr _world, const Model_V &_models,
+          const Light_V &_lights, const std::vector<std::string> &_removed);
+
+      /// \brief Get the regular expression that a filter string applies to
+      /// model names, see LoadWithFilter.
+      /// \param[in] _filter String for filtering models states.
+      /// \param[out] _regex Regular expression model names must match.
+      /// \return False if the filter accepts every model, in which case
+      /// _regex is not set.
+      public: static bool ModelFilterRegex(const std::string &_filter,
+          boost::regex &_regex);
+
       /// \brief Load state from SDF element.
       ///
       /// Set a WorldState from an SDF element containing WorldState info.
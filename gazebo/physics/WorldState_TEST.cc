@@ -358,3 +358,63 @@ TEST_F(WorldStateTest, Times)
   EXPECT_EQ(worldState.GetWallTime(), common::Time(2));
   EXPECT_EQ(worldState.GetRealTime(), common::Time(3));
 }
+
+//////////////////////////////////////////////////
+TEST_F(WorldStateTest, LoadChanged)
+{
+  // Load a world
+  this->Load("worlds/shapes.world", true);
+  physics::WorldPtr world = physics::get_world("default");
+  ASSERT_TRUE(world != nullptr);
+
+  physics::ModelPtr box = world->ModelByName("box");
+  ASSERT_TRUE(box != nullptr);
+  physics::ModelPtr sphere = world->ModelByName("sphere");
+  ASSERT_TRUE(sphere != nullptr);
+
+  physics::WorldState worldState(world);
+  unsigned int modelCount = worldState.GetModelStateCount();
+  EXPECT_GT(modelCount, 2u);
+
+  ignition::math::Pose3d spherePose = sphere->WorldPose();
+  box->SetWorldPose(ignition::math::Pose3d(1, 2, 3, 0, 0, 0));
+  sphere->SetWorldPose(ignition::math::Pose3d(4, 5, 6, 0, 0, 0));
+
+  // Only the box state is reloaded
+  world->Step(1);
+  worldState.LoadChanged(world, {box}, {}, {});
+  EXPECT_EQ(worldState.GetModelStateCount(), modelCount);
+  EXPECT_EQ(worldState.GetSimTime(), world->SimTime());
+  EXPECT_EQ(worldState.GetIterations(), world->Iterations());
+  EXPECT_EQ(worldState.GetModelState("box").Pose().Pos(),
+      box->WorldPose().Pos());
+  EXPECT_EQ(worldState.GetModelState("sphere").Pose(), spherePose);
+
+  // Removed states are dropped
+  worldState.LoadChanged(world, {}, {}, {"sphere"});
+  EXPECT_EQ(worldState.GetModelStateCount(), modelCount - 1);
+  EXPECT_FALSE(worldState.HasModelState("sphere"));
+  EXPECT_TRUE(worldState.HasModelState("box"));
+}
+
+//////////////////////////////////////////////////
+TEST_F(WorldStateTest, ModelFilterRegex)
+{
+  boost::regex regex;
+
+  // Filters that accept every model
+  EXPECT_FALSE(physics::WorldState::ModelFilterRegex("", regex));
+  EXPECT_FALSE(physics::WorldState::ModelFilterRegex("*", regex));
+  EXPECT_FALSE(physics::WorldState::ModelFilterRegex("*.link", regex));
+  EXPECT_FALSE(physics::WorldState::ModelFilterRegex("*/pose", regex));
+
+  // Only the model part of the filter is used
+  EXPECT_TRUE(physics::WorldState::ModelFilterRegex("box*.link/pose", regex));
+  EXPECT_TRUE(boost::regex_match("box", regex));
+  EXPECT_TRUE(boost::regex_match("box_2", regex));
+  EXPECT_FALSE(boost::regex_match("sphere", regex));
+
+  EXPECT_TRUE(physics::WorldState::ModelFilterRegex("sphere", regex));
+  EXPECT_TRUE(boost::regex_match("sphere", regex));
+  EXPECT_FALSE(boost::regex_match("sphere_2", regex));
+}
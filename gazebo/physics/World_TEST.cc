@@ -216,6 +216,45 @@ TEST_F(WorldTest, Stop)
   EXPECT_TRUE(world->Running());
 }
 
+//////////////////////////////////////////////////
+TEST_F(WorldTest, ModelUpdateThreads)
+{
+  this->Load("worlds/shapes.world", true);
+
+  auto world = physics::get_world("default");
+  ASSERT_NE(nullptr, world);
+
+  auto physics = world->Physics();
+  ASSERT_NE(nullptr, physics);
+
+  // Serial model updates by default
+  EXPECT_EQ(0u, world->ModelUpdateThreads());
+  int threads = -1;
+  EXPECT_NO_THROW(threads =
+      boost::any_cast<int>(physics->GetParam("model_update_threads")));
+  EXPECT_EQ(0, threads);
+
+  // Enable parallel model updates through the physics param
+  EXPECT_TRUE(physics->SetParam("model_update_threads", 4));
+  EXPECT_EQ(4u, world->ModelUpdateThreads());
+  EXPECT_FALSE(physics->SetParam("model_update_threads", -1));
+  EXPECT_EQ(4u, world->ModelUpdateThreads());
+
+  // Models keep falling under gravity and coming to rest on the ground
+  world->Step(1000);
+  for (auto const &model : world->Models())
+  {
+    if (model->IsStatic())
+      continue;
+    EXPECT_GT(model->WorldPose().Pos().Z(), 0.0) << model->GetName();
+    EXPECT_LT(model->WorldPose().Pos().Z(), 1.0) << model->GetName();
+  }
+
+  world->SetModelUpdateThreads(0);
+  EXPECT_EQ(0u, world->ModelUpdateThreads());
+  world->Step(10);
+}
+
 //////////////////////////////////////////////////
 int main(int argc, char **argv)
 {
@@ -169,6 +169,22 @@ void ODECollision::SetCollideBits(unsigned int _bits)
     dGeomSetCollideBits((dGeomID)this->spaceId, _bits);
 }
 
+//////////////////////////////////////////////////
+unsigned int ODECollision::GetCategoryBits() const
+{
+  if (this->collisionId)
+    return dGeomGetCategoryBits(this->collisionId);
+  return 0;
+}
+
+//////////////////////////////////////////////////
+unsigned int ODECollision::GetCollideBits() const
+{
+  if (this->collisionId)
+    return dGeomGetCollideBits(this->collisionId);
+  return 0;
+}
+
 //////////////////////////////////////////////////
 ignition::math::AxisAlignedBox ODECollision::BoundingBox() const
 {
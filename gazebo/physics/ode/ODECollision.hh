@@ -74,6 +74,14 @@ namespace gazebo
       // Documentation inherited.
       public: virtual void SetCollideBits(unsigned int bits);
 
+      /// \brief Get the category bits, used during collision detection.
+      /// \return The bits, zero if there is no ODE geom.
+      public: unsigned int GetCategoryBits() const;
+
+      /// \brief Get the collide bits, used during collision detection.
+      /// \return The bits, zero if there is no ODE geom.
+      public: unsigned int GetCollideBits() const;
+
       // Documentation inherited.
       public: virtual ignition::math::AxisAlignedBox BoundingBox() const;
 
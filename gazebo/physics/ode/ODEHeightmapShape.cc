@@ -15,6 +15,7 @@
  *
 */
 #include "gazebo/common/Exception.hh"
+#include "gazebo/common/HeightmapTiles.hh"
 #include "gazebo/physics/ode/ODECollision.hh"
 #include "gazebo/physics/ode/ODEHeightmapShape.hh"
 
@@ -26,6 +27,9 @@ ODEHeightmapShape::ODEHeightmapShape(CollisionPtr _parent)
     : HeightmapShape(_parent)
 {
   this->flipY = false;
+
+  // ODE looks the heights of a tiled terrain up with a callback
+  this->SetTilesSupported(true);
 }
 
 //////////////////////////////////////////////////
@@ -40,6 +44,16 @@ dReal ODEHeightmapShape::GetHeightCallback(void *_data, int _x, int _y)
   return static_cast<ODEHeightmapShape*>(_data)->GetHeight(_x, _y);
 }
 
+//////////////////////////////////////////////////
+/// \brief Height callback of a tiled terrain.
+/// \param[in] _data The tiles of the terrain.
+/// \param[in] _x Index of the vertex along x.
+/// \param[in] _y Index of the vertex along y.
+/// \return The height at the vertex.
+static dReal tiledHeightCallback(void *_data, int _x, int _y)
+{
+  return static_cast<const common::HeightmapTiles *>(_data)->Height(_x, _y);
+}
 
 //////////////////////////////////////////////////
 // creates the ODE height field. Only enabled if the height data type is float.
@@ -110,19 +124,38 @@ void ODEHeightmapShape::Init()
 
 
   // Step 3: Setup a callback method for ODE
-  setOdeHeightfieldDetails(
-      this->odeData,
-      this->heights.data(),
-      // in meters
-      this->Size().X(),
-      // in meters
-      this->Size().Y(),
-      // number of vertices
-      this->vertSize,
-      // vertical (z-axis) offset
-      this->Pos().Z(),
-      // vertical thickness for closing the height map mesh
-      1.0);
+  if (this->Tiled())
+  {
+    // The heights are sampled from the tiles as ODE needs them
+    dGeomHeightfieldDataBuildCallback(
+        this->odeData,
+        const_cast<common::HeightmapTiles *>(this->Tiles()),
+        &tiledHeightCallback,
+        this->Size().X(),   // width (in meters)
+        this->Size().Y(),   // height (in meters)
+        this->vertSize,     // width (sampling size)
+        this->vertSize,     // height (sampling size)
+        1.0,                // vertical (z-axis) scaling
+        this->Pos().Z(),    // vertical (z-axis) offset
+        1.0,                // vertical thickness for closing the mesh
+        0);                 // wrap mode
+  }
+  else
+  {
+    setOdeHeightfieldDetails(
+        this->odeData,
+        this->heights.data(),
+        // in meters
+        this->Size().X(),
+        // in meters
+        this->Size().Y(),
+        // number of vertices
+        this->vertSize,
+        // vertical (z-axis) offset
+        this->Pos().Z(),
+        // vertical thickness for closing the height map mesh
+        1.0);
+  }
 
   // Step 4: Restrict the bounds of the AABB to improve efficiency
   dGeomHeightfieldDataSetBounds(this->odeData, this->GetMinHeight(),
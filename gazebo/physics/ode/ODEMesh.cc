@@ -14,6 +14,13 @@
  * limitations under the License.
  *
 */
+#include <map>
+#include <mutex>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <utility>
+
 #include "gazebo/common/Mesh.hh"
 #include "gazebo/common/Assert.hh"
 #include "gazebo/common/Console.hh"
@@ -22,9 +29,171 @@
 #include "gazebo/physics/ode/ODEPhysics.hh"
 #include "gazebo/physics/ode/ODEMesh.hh"
 
+namespace gazebo
+{
+  namespace physics
+  {
+    /// \internal
+    /// \brief Vertices, indices and ODE trimesh data of a mesh. The
+    /// OPCODE or GIMPACT model of the trimesh data points into the vertex
+    /// and index arrays, so they are released together.
+    class ODEMeshData
+    {
+      /// \brief Destructor.
+      public: ~ODEMeshData()
+      {
+        if (this->odeData)
+          dGeomTriMeshDataDestroy(this->odeData);
+        delete [] this->vertices;
+        delete [] this->indices;
+      }
+
+      /// \brief Array of vertex values.
+      public: float *vertices = nullptr;
+
+      /// \brief Array of index values.
+      public: int *indices = nullptr;
+
+      /// \brief ODE trimesh data.
+      public: dTriMeshDataID odeData = nullptr;
+    };
+  }
+}
+
 using namespace gazebo;
 using namespace physics;
 
+namespace
+{
+  /// \brief Key of the trimesh data cache: mesh key and scale.
+  using ODEMeshKey = std::tuple<std::string, double, double, double>;
+
+  /// \brief Trimesh data shared between the meshes that have the same
+  /// key and scale. An entry is removed when its data is released by the
+  /// last mesh that uses it.
+  class ODEMeshCache
+  {
+    /// \brief Protects entries.
+    public: std::mutex mutex;
+
+    /// \brief The shared trimesh data.
+    public: std::map<ODEMeshKey, std::weak_ptr<ODEMeshData>> entries;
+  };
+
+  /// \brief Get the trimesh data cache. It is never destroyed, since
+  /// meshes can be released during static destruction.
+  /// \return The cache.
+  ODEMeshCache &MeshCache()
+  {
+    static ODEMeshCache *cache = new ODEMeshCache;
+    return *cache;
+  }
+
+  /// \brief Copy and scale the vertices of a mesh or submesh, and build
+  /// its ODE trimesh data.
+  /// \param[in] _mesh The mesh or submesh.
+  /// \param[in] _scale Scaling factor.
+  /// \return The trimesh data.
+  template<typename T>
+  std::unique_ptr<ODEMeshData> BuildMeshData(const T *_mesh,
+      const ignition::math::Vector3d &_scale)
+  {
+    std::unique_ptr<ODEMeshData> data(new ODEMeshData);
+
+    unsigned int numVertices = _mesh->GetVertexCount();
+    unsigned int numIndices = _mesh->GetIndexCount();
+
+    // Get all the vertex and index data
+    _mesh->FillArrays(&data->vertices, &data->indices);
+
+    // Scale the vertex data
+    for (unsigned int j = 0;  j < numVertices; j++)
+    {
+      data->vertices[j*3+0] = data->vertices[j*3+0] * _scale.X();
+      data->vertices[j*3+1] = data->vertices[j*3+1] * _scale.Y();
+      data->vertices[j*3+2] = data->vertices[j*3+2] * _scale.Z();
+    }
+
+    /// This will hold the vertex data of the triangle mesh
+    data->odeData = dGeomTriMeshDataCreate();
+
+    // Build the ODE triangle mesh
+    dGeomTriMeshDataBuildSingle(data->odeData,
+        data->vertices, 3*sizeof(data->vertices[0]), numVertices,
+        data->indices, numIndices, 3*sizeof(data->indices[0]));
+
+    return data;
+  }
+
+  /// \brief Get the trimesh data of a mesh or submesh from the cache,
+  /// building it if no other mesh uses it.
+  /// \param[in] _mesh The mesh or submesh.
+  /// \param[in] _scale Scaling factor.
+  /// \param[in] _key Identifies the mesh data, empty to not share it.
+  /// \return The trimesh data.
+  template<typename T>
+  std::shared_ptr<ODEMeshData> MeshData(const T *_mesh,
+      const ignition::math::Vector3d &_scale, const std::string &_key)
+  {
+    if (_key.empty())
+      return std::shared_ptr<ODEMeshData>(BuildMeshData(_mesh, _scale));
+
+    ODEMeshKey key(_key, _scale.X(), _scale.Y(), _scale.Z());
+
+    ODEMeshCache &cache = MeshCache();
+    std::lock_guard<std::mutex> lock(cache.mutex);
+
+    auto iter = cache.entries.find(key);
+    if (iter != cache.entries.end())
+    {
+      std::shared_ptr<ODEMeshData> data = iter->second.lock();
+      if (data)
+        return data;
+    }
+
+    std::shared_ptr<ODEMeshData> data(BuildMeshData(_mesh, _scale).release(),
+        [key](ODEMeshData *_data)
+        {
+          {
+            ODEMeshCache &meshCache = MeshCache();
+            std::lock_guard<std::mutex> cacheLock(meshCache.mutex);
+            auto entry = meshCache.entries.find(key);
+            if (entry != meshCache.entries.end() && entry->second.expired())
+              meshCache.entries.erase(entry);
+          }
+          delete _data;
+        });
+    cache.entries[key] = data;
+
+    return data;
+  }
+
+  /// \brief Create the collision shape of a trimesh, or give its geom
+  /// new trimesh data.
+  /// \param[in] _odeData The trimesh data.
+  /// \param[in] _collision Pointer to the collision object.
+  void CreateMesh(dTriMeshDataID _odeData, ODECollisionPtr _collision)
+  {
+    if (_collision->GetCollisionId() == nullptr)
+    {
+      _collision->SetSpaceId(dSimpleSpaceCreate(_collision->GetSpaceId()));
+      _collision->SetCollision(dCreateTriMesh(_collision->GetSpaceId(),
+            _odeData, 0, 0, 0), true);
+    }
+    else
+    {
+      dGeomTriMeshSetData(_collision->GetCollisionId(), _odeData);
+    }
+  }
+}
+
+// TODO added here for ABI compatibility
+// move to a private data pointer in ODEMesh when merging forward.
+static std::map<const ODEMesh *, std::shared_ptr<ODEMeshData>> gODEMeshData;
+
+/// \brief Mutex that protects gODEMeshData.
+static std::mutex gODEMeshDataMutex;
+
 //////////////////////////////////////////////////
 ODEMesh::ODEMesh()
 {
@@ -36,9 +205,32 @@ ODEMesh::ODEMesh()
 //////////////////////////////////////////////////
 ODEMesh::~ODEMesh()
 {
-  delete [] this->vertices;
-  delete [] this->indices;
-  dGeomTriMeshDataDestroy(this->odeData);
+  // The trimesh data is released with the last mesh that uses it
+  std::shared_ptr<ODEMeshData> data;
+  {
+    std::lock_guard<std::mutex> lock(gODEMeshDataMutex);
+    auto iter = gODEMeshData.find(this);
+    if (iter != gODEMeshData.end())
+    {
+      data = iter->second;
+      gODEMeshData.erase(iter);
+    }
+  }
+}
+
+//////////////////////////////////////////////////
+size_t ODEMesh::CacheSize()
+{
+  ODEMeshCache &cache = MeshCache();
+  std::lock_guard<std::mutex> lock(cache.mutex);
+
+  size_t count = 0;
+  for (auto const &entry : cache.entries)
+  {
+    if (!entry.second.expired())
+      ++count;
+  }
+  return count;
 }
 
 //////////////////////////////////////////////////
@@ -82,74 +274,64 @@ void ODEMesh::Update()
 //////////////////////////////////////////////////
 void ODEMesh::Init(const common::SubMesh *_subMesh, ODECollisionPtr _collision,
     const ignition::math::Vector3d &_scale)
+{
+  this->Init(_subMesh, _collision, _scale, "");
+}
+
+//////////////////////////////////////////////////
+void ODEMesh::Init(const common::SubMesh *_subMesh, ODECollisionPtr _collision,
+    const ignition::math::Vector3d &_scale, const std::string &_key)
 {
   if (!_subMesh)
     return;
 
-  unsigned int numVertices = _subMesh->GetVertexCount();
-  unsigned int numIndices = _subMesh->GetIndexCount();
-
-  this->vertices = nullptr;
-  this->indices = nullptr;
-
   // Get all the vertex and index data
-  _subMesh->FillArrays(&this->vertices, &this->indices);
+  std::shared_ptr<ODEMeshData> meshData = MeshData(_subMesh, _scale, _key);
 
   this->collisionId = _collision->GetCollisionId();
 
-  this->CreateMesh(numVertices, numIndices, _collision, _scale);
+  CreateMesh(meshData->odeData, _collision);
+  this->vertices = meshData->vertices;
+  this->indices = meshData->indices;
+  this->odeData = meshData->odeData;
+
+  // The previous data, if any, is released once the geom no longer uses it
+  {
+    std::lock_guard<std::mutex> lock(gODEMeshDataMutex);
+    std::swap(gODEMeshData[this], meshData);
+  }
+
+  memset(this->transform, 0, 32*sizeof(dReal));
+  this->transformIndex = 0;
 }
 
 //////////////////////////////////////////////////
 void ODEMesh::Init(const common::Mesh *_mesh, ODECollisionPtr _collision,
     const ignition::math::Vector3d &_scale)
 {
-  if (!_mesh)
-    return;
-
-  unsigned int numVertices = _mesh->GetVertexCount();
-  unsigned int numIndices = _mesh->GetIndexCount();
-
-  this->vertices = nullptr;
-  this->indices = nullptr;
-
-  // Get all the vertex and index data
-  _mesh->FillArrays(&this->vertices, &this->indices);
-
-  this->collisionId = _collision->GetCollisionId();
-  this->CreateMesh(numVertices, numIndices, _collision, _scale);
+  this->Init(_mesh, _collision, _scale, "");
 }
 
 //////////////////////////////////////////////////
-void ODEMesh::CreateMesh(unsigned int _numVertices, unsigned int _numIndices,
-    ODECollisionPtr _collision, const ignition::math::Vector3d &_scale)
+void ODEMesh::Init(const common::Mesh *_mesh, ODECollisionPtr _collision,
+    const ignition::math::Vector3d &_scale, const std::string &_key)
 {
-  /// This will hold the vertex data of the triangle mesh
-  if (this->odeData == nullptr)
-    this->odeData = dGeomTriMeshDataCreate();
+  if (!_mesh)
+    return;
 
-  // Scale the vertex data
-  for (unsigned int j = 0;  j < _numVertices; j++)
-  {
-    this->vertices[j*3+0] = this->vertices[j*3+0] * _scale.X();
-    this->vertices[j*3+1] = this->vertices[j*3+1] * _scale.Y();
-    this->vertices[j*3+2] = this->vertices[j*3+2] * _scale.Z();
-  }
+  // Get all the vertex and index data
+  std::shared_ptr<ODEMeshData> meshData = MeshData(_mesh, _scale, _key);
 
-  // Build the ODE triangle mesh
-  dGeomTriMeshDataBuildSingle(this->odeData,
-      this->vertices, 3*sizeof(this->vertices[0]), _numVertices,
-      this->indices, _numIndices, 3*sizeof(this->indices[0]));
+  this->collisionId = _collision->GetCollisionId();
+  CreateMesh(meshData->odeData, _collision);
+  this->vertices = meshData->vertices;
+  this->indices = meshData->indices;
+  this->odeData = meshData->odeData;
 
-  if (_collision->GetCollisionId() == nullptr)
-  {
-    _collision->SetSpaceId(dSimpleSpaceCreate(_collision->GetSpaceId()));
-    _collision->SetCollision(dCreateTriMesh(_collision->GetSpaceId(),
-          this->odeData, 0, 0, 0), true);
-  }
-  else
+  // The previous data, if any, is released once the geom no longer uses it
   {
-    dGeomTriMeshSetData(_collision->GetCollisionId(), this->odeData);
+    std::lock_guard<std::mutex> lock(gODEMeshDataMutex);
+    std::swap(gODEMeshData[this], meshData);
   }
 
   memset(this->transform, 0, 32*sizeof(dReal));
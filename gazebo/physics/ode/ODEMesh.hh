@@ -18,6 +18,8 @@
 #ifndef GAZEBO_PHYSICS_ODE_ODEMESH_HH_
 #define GAZEBO_PHYSICS_ODE_ODEMESH_HH_
 
+#include <string>
+
 #include <ignition/math/Vector3.hh>
 
 #include "gazebo/physics/ode/ODETypes.hh"
@@ -49,6 +51,19 @@ namespace gazebo
                       ODECollisionPtr _collision,
                       const ignition::math::Vector3d &_scale);
 
+      /// \brief Create a mesh collision shape using a submesh, sharing
+      /// its trimesh data with other meshes.
+      /// \param[in] _subMesh Pointer to the submesh.
+      /// \param[in] _collision Pointer to the collision object.
+      /// \param[in] _scale Scaling factor.
+      /// \param[in] _key Identifies the submesh data. Meshes initialized
+      /// with the same key and scale share their trimesh data. An empty
+      /// key disables sharing.
+      public: void Init(const common::SubMesh *_subMesh,
+                      ODECollisionPtr _collision,
+                      const ignition::math::Vector3d &_scale,
+                      const std::string &_key);
+
       /// \brief Create a mesh collision shape using a mesh.
       /// \param[in] _mesh Pointer to the mesh.
       /// \param[in] _collision Pointer to the collision object.
@@ -57,30 +72,41 @@ namespace gazebo
                       ODECollisionPtr _collision,
                       const ignition::math::Vector3d &_scale);
 
+      /// \brief Create a mesh collision shape using a mesh, sharing its
+      /// trimesh data with other meshes.
+      /// \param[in] _mesh Pointer to the mesh.
+      /// \param[in] _collision Pointer to the collision object.
+      /// \param[in] _scale Scaling factor.
+      /// \param[in] _key Identifies the mesh data. Meshes initialized
+      /// with the same key and scale share their trimesh data. An empty
+      /// key disables sharing.
+      public: void Init(const common::Mesh *_mesh,
+                      ODECollisionPtr _collision,
+                      const ignition::math::Vector3d &_scale,
+                      const std::string &_key);
+
+      /// \brief Get the number of trimesh data objects shared through
+      /// the cache, for testing.
+      /// \return Number of live cache entries.
+      public: static size_t CacheSize();
+
       /// \brief Update the collision mesh.
       public: virtual void Update();
 
-      /// \brief Helper function to create the collision shape.
-      /// \param[in] _numVertices Number of vertices.
-      /// \param[in] _numIndices Number of indices.
-      /// \param[in] _collision Pointer to the collision object.
-      private: void CreateMesh(unsigned int _numVertices,
-                   unsigned int _numIndices, ODECollisionPtr _collision,
-                   const ignition::math::Vector3d &_scale);
-
       /// \brief Transform matrix.
       private: dReal transform[16*2];
 
       /// \brief Transform matrix index.
       private: int transformIndex;
 
-      /// \brief Array of vertex values.
+      /// \brief Array of vertex values. Owned by the trimesh data, which
+      /// may be shared with other meshes.
       private: float *vertices;
 
-      /// \brief Array of index values.
+      /// \brief Array of index values. Owned by the trimesh data.
       private: int *indices;
 
-      /// \brief ODE trimesh data.
+      /// \brief ODE trimesh data. Owned by the trimesh data.
       private: dTriMeshDataID odeData;
 
       /// \brief The collision id that this mesh is attached to.
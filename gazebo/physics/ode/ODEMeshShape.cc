@@ -57,16 +57,29 @@ void ODEMeshShape::Init()
   if (!this->mesh)
     return;
 
+  // Collisions that use the same mesh, submesh and scale share their
+  // trimesh data. Meshes are loaded once by the MeshManager, so the mesh
+  // name identifies the data.
+  std::string key = this->mesh->GetName();
+
   if (this->submesh)
   {
+    sdf::ElementPtr submeshElem = this->sdf->GetElement("submesh");
+    key += "::" + submeshElem->Get<std::string>("name");
+    if (submeshElem->HasElement("center") &&
+        submeshElem->Get<bool>("center"))
+    {
+      key += "::center";
+    }
+
     this->odeMesh->Init(this->submesh,
         boost::static_pointer_cast<ODECollision>(this->collisionParent),
-        this->sdf->Get<ignition::math::Vector3d>("scale"));
+        this->sdf->Get<ignition::math::Vector3d>("scale"), key);
   }
   else
   {
     this->odeMesh->Init(this->mesh,
         boost::static_pointer_cast<ODECollision>(this->collisionParent),
-        this->sdf->Get<ignition::math::Vector3d>("scale"));
+        this->sdf->Get<ignition::math::Vector3d>("scale"), key);
   }
 }
@@ -48,6 +48,7 @@
 #include "gazebo/physics/Collision.hh"
 #include "gazebo/physics/MapShape.hh"
 #include "gazebo/physics/ContactManager.hh"
+#include "gazebo/physics/RayQuery.hh"
 
 #include "gazebo/physics/ode/ODECollision.hh"
 #include "gazebo/physics/ode/ODELink.hh"
@@ -98,31 +99,87 @@ class ContactUpdate_TBB
 };
 */
 
-class Colliders_TBB
+/// \brief Check the collide bitmasks of two collisions.
+/// \param[in] _collision1 First collision object.
+/// \param[in] _collision2 Second collision object.
+/// \return True if the two collisions should be collided.
+static bool ShouldCollide(const ODECollision *_collision1,
+                          const ODECollision *_collision2)
 {
-  public: Colliders_TBB(
-              std::vector<std::pair<ODECollision*, ODECollision*> > *_colliders,
-              ODEPhysics *_engine,
-              dContactGeom* _contactCollisions) :
-    colliders(_colliders),
-              engine(_engine), contactCollisions(_contactCollisions)
+  // Filter collisions based on collide bitmask.
+  if ((_collision1->GetSurface()->collideBitmask &
+        _collision2->GetSurface()->collideBitmask) == 0)
+    return false;
+
+  // Filter collisions based on contact bitmask if collide_without_contact is
+  // on.The bitmask is set mainly for speed improvements otherwise a collision
+  // with collide_without_contact may potentially generate a large number of
+  // contacts.
+  if (_collision1->GetSurface()->collideWithoutContact ||
+      _collision2->GetSurface()->collideWithoutContact)
   {
-    // dAllocateODEDataForThread(dAllocateMaskAll);
+    if ((_collision1->GetSurface()->collideWithoutContactBitmask &
+         _collision2->GetSurface()->collideWithoutContactBitmask) == 0)
+    {
+      return false;
+    }
   }
 
+  return true;
+}
+
+/// \brief Check whether dCollide may run on a worker thread for a geom.
+/// Geom transforms and heightfields keep scratch data inside the geom, so
+/// they are not safe to collide concurrently with other pairs.
+/// \param[in] _geom Geom to check.
+/// \return True if the geom can be collided concurrently.
+static bool ConcurrentCollideSafe(dGeomID _geom)
+{
+  int geomClass = dGeomGetClass(_geom);
+  return geomClass != dGeomTransformClass && geomClass != dHeightfieldClass;
+}
+
+/// \brief Narrow phase body run by the TBB workers. Each worker collides
+/// its share of the normal colliders into its own contact buffer.
+class Colliders_TBB
+{
+  public: explicit Colliders_TBB(ODEPhysicsPrivate *_data)
+          : data(_data) {}
+
   public: void operator() (const tbb::blocked_range<size_t> &_r) const
   {
-    for (size_t i = _r.begin(); i != _r.end(); i++)
+    std::vector<dContactGeom> &buffer = this->data->contactBuffers.local();
+
+    for (size_t i = _r.begin(); i != _r.end(); ++i)
     {
-      ODECollision *collision1 = (*this->colliders)[i].first;
-      ODECollision *collision2 = (*this->colliders)[i].second;
-      this->engine->Collide(collision1, collision2, contactCollisions);
+      ODECollision *collision1 = this->data->colliders[i].first;
+      ODECollision *collision2 = this->data->colliders[i].second;
+      ODEColliderContacts &result = this->data->colliderContacts[i];
+
+      dGeomID geom1 = collision1->GetCollisionId();
+      dGeomID geom2 = collision2->GetCollisionId();
+
+      if (!ConcurrentCollideSafe(geom1) || !ConcurrentCollideSafe(geom2))
+      {
+        result.count = -1;
+        continue;
+      }
+
+      result.buffer = &buffer;
+      result.offset = buffer.size();
+      result.count = 0;
+
+      if (!ShouldCollide(collision1, collision2))
+        continue;
+
+      buffer.resize(result.offset + MAX_COLLIDE_RETURNS);
+      result.count = dCollide(geom1, geom2, MAX_COLLIDE_RETURNS,
+          &buffer[result.offset], sizeof(buffer[0]));
+      buffer.resize(result.offset + result.count);
     }
   }
 
-  private: std::vector< std::pair<ODECollision*, ODECollision*> > *colliders;
-  private: ODEPhysics *engine;
-  private: dContactGeom* contactCollisions;
+  private: ODEPhysicsPrivate *data;
 };
 
 //////////////////////////////////////////////////
@@ -348,6 +405,18 @@ void ODEPhysics::OnPhysicsMsg(ConstPhysicsPtr &_msg)
 //////////////////////////////////////////////////
 void ODEPhysics::Init()
 {
+  // Batched ray queries hit the collisions that the rays of
+  // ODEMultiRayShape hit, which have category GZ_SENSOR_COLLIDE and
+  // collide bits ~GZ_SENSOR_COLLIDE.
+  this->world->RayQuery().SetFilter([](const Collision &_collision)
+  {
+    const ODECollision *collision =
+        dynamic_cast<const ODECollision *>(&_collision);
+    if (!collision || !collision->GetCollisionId())
+      return false;
+    return (collision->GetCollideBits() & GZ_SENSOR_COLLIDE) ||
+           (collision->GetCategoryBits() & ~GZ_SENSOR_COLLIDE);
+  });
 }
 
 //////////////////////////////////////////////////
@@ -382,10 +451,18 @@ void ODEPhysics::UpdateCollision()
 
   IGN_PROFILE_BEGIN("collideShapes");
   // Generate non-trimesh collisions.
-  for (i = 0; i < this->dataPtr->collidersCount; ++i)
+  if (this->dataPtr->collisionThreads > 0)
   {
-    this->Collide(this->dataPtr->colliders[i].first,
-        this->dataPtr->colliders[i].second, this->dataPtr->contactCollisions);
+    this->CollideParallel();
+  }
+  else
+  {
+    for (i = 0; i < this->dataPtr->collidersCount; ++i)
+    {
+      this->Collide(this->dataPtr->colliders[i].first,
+          this->dataPtr->colliders[i].second,
+          this->dataPtr->contactCollisions);
+    }
   }
   DIAG_TIMER_LAP("ODEPhysics::UpdateCollision", "collideShapes");
   IGN_PROFILE_END();
@@ -406,6 +483,44 @@ void ODEPhysics::UpdateCollision()
   DIAG_TIMER_STOP("ODEPhysics::UpdateCollision");
 }
 
+//////////////////////////////////////////////////
+void ODEPhysics::CollideParallel()
+{
+  unsigned int count = this->dataPtr->collidersCount;
+  if (count == 0)
+    return;
+
+  for (auto &buffer : this->dataPtr->contactBuffers)
+    buffer.clear();
+  this->dataPtr->colliderContacts.resize(count);
+
+  Colliders_TBB narrowPhase(this->dataPtr);
+  this->dataPtr->collisionArena->execute([&narrowPhase, count]()
+  {
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, count), narrowPhase);
+  });
+
+  // Create the contact joints in collider order, so joint creation,
+  // contact feedback and the contact manager see the same sequence as in
+  // the serial path.
+  for (unsigned int i = 0; i < count; ++i)
+  {
+    ODECollision *collision1 = this->dataPtr->colliders[i].first;
+    ODECollision *collision2 = this->dataPtr->colliders[i].second;
+    const ODEColliderContacts &result = this->dataPtr->colliderContacts[i];
+
+    if (result.count < 0)
+    {
+      this->Collide(collision1, collision2, this->dataPtr->contactCollisions);
+    }
+    else if (result.count > 0)
+    {
+      this->AddContactJoints(collision1, collision2,
+          &(*result.buffer)[result.offset], result.count);
+    }
+  }
+}
+
 //////////////////////////////////////////////////
 void ODEPhysics::UpdatePhysics()
 {
@@ -1013,25 +1128,9 @@ void ODEPhysics::CollisionCallback(void *_data, dGeomID _o1, dGeomID _o2)
 void ODEPhysics::Collide(ODECollision *_collision1, ODECollision *_collision2,
                          dContactGeom *_contactCollisions)
 {
-  // Filter collisions based on collide bitmask.
-  if ((_collision1->GetSurface()->collideBitmask &
-        _collision2->GetSurface()->collideBitmask) == 0)
+  if (!ShouldCollide(_collision1, _collision2))
     return;
 
-  // Filter collisions based on contact bitmask if collide_without_contact is
-  // on.The bitmask is set mainly for speed improvements otherwise a collision
-  // with collide_without_contact may potentially generate a large number of
-  // contacts.
-  if (_collision1->GetSurface()->collideWithoutContact ||
-      _collision2->GetSurface()->collideWithoutContact)
-  {
-    if ((_collision1->GetSurface()->collideWithoutContactBitmask &
-         _collision2->GetSurface()->collideWithoutContactBitmask) == 0)
-    {
-      return;
-    }
-  }
-
   /*
   if (_collision1->GetCollisionId() && _collision2->GetCollisionId())
   {
@@ -1044,7 +1143,24 @@ void ODEPhysics::Collide(ODECollision *_collision1, ODECollision *_collision2,
       << "2[" << (*pos2)[0]<< " " << (*pos2)[1] << " " << (*pos2)[2] << "]\n";
   }*/
 
-  unsigned int numc = 0;
+  // Generate the contacts
+  unsigned int numc = dCollide(_collision1->GetCollisionId(),
+      _collision2->GetCollisionId(), MAX_COLLIDE_RETURNS, _contactCollisions,
+      sizeof(_contactCollisions[0]));
+
+  // Return if no contacts.
+  if (numc == 0)
+    return;
+
+  this->AddContactJoints(_collision1, _collision2, _contactCollisions, numc);
+}
+
+//////////////////////////////////////////////////
+void ODEPhysics::AddContactJoints(ODECollision *_collision1,
+    ODECollision *_collision2, dContactGeom *_contactCollisions,
+    unsigned int _numc)
+{
+  unsigned int numc = _numc;
   dContact contact;
 
   // maxCollide must less than the size of this->dataPtr->indices
@@ -1062,14 +1178,6 @@ void ODEPhysics::Collide(ODECollision *_collision1, ODECollision *_collision2,
   if (_collision2->GetMaxContacts() < maxCollide)
     maxCollide = _collision2->GetMaxContacts();
 
-  // Generate the contacts
-  numc = dCollide(_collision1->GetCollisionId(), _collision2->GetCollisionId(),
-      MAX_COLLIDE_RETURNS, _contactCollisions, sizeof(_contactCollisions[0]));
-
-  // Return if no contacts.
-  if (numc == 0)
-    return;
-
   // Store the indices of the contacts.
   for (int i = 0; i < MAX_CONTACT_JOINTS; i++)
     this->dataPtr->indices[i] = i;
@@ -1541,6 +1649,11 @@ bool ODEPhysics::SetParam(const std::string &_key, const boost::any &_value)
       dWorldSetQuickStepExtraFrictionIterations(this->dataPtr->worldId,
         any_cast<int>(_value));
     }
+    else if (_key == "vectorized_rows")
+    {
+      dWorldSetQuickStepVectorizedRows(this->dataPtr->worldId,
+        any_cast<bool>(_value));
+    }
     else if (_key == "island_threads")
     {
       int value;
@@ -1555,6 +1668,23 @@ bool ODEPhysics::SetParam(const std::string &_key, const boost::any &_value)
       }
       dWorldSetIslandThreads(this->dataPtr->worldId, value);
     }
+    else if (_key == "collision_threads")
+    {
+      int value = any_cast<int>(_value);
+      if (value < 0)
+      {
+        gzerr << "collision_threads must be non-negative, got "
+              << value << "\n";
+        return false;
+      }
+
+      boost::recursive_mutex::scoped_lock lock(*this->physicsUpdateMutex);
+      this->dataPtr->collisionThreads = value;
+      if (value > 0)
+        this->dataPtr->collisionArena.reset(new tbb::task_arena(value));
+      else
+        this->dataPtr->collisionArena.reset();
+    }
     else if (_key == "ode_quiet")
     {
       bool odeQuiet = any_cast<bool>(_value);
@@ -1658,10 +1788,14 @@ bool ODEPhysics::GetParam(const std::string &_key, boost::any &_value) const
     _value = dWorldGetQuickStepWarmStartFactor(this->dataPtr->worldId);
   else if (_key == "extra_friction_iterations")
     _value = dWorldGetQuickStepExtraFrictionIterations(this->dataPtr->worldId);
+  else if (_key == "vectorized_rows")
+    _value = dWorldGetQuickStepVectorizedRows(this->dataPtr->worldId);
   else if (_key == "friction_model")
     _value = this->GetFrictionModel();
   else if (_key == "island_threads")
     _value = dWorldGetIslandThreads(this->dataPtr->worldId);
+  else if (_key == "collision_threads")
+    _value = this->dataPtr->collisionThreads;
   else if (_key == "ode_quiet")
     _value = dGetMessageHandler() != 0;
   else if (_key == "world_step_solver")
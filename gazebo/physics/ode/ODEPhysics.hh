@@ -315,6 +315,22 @@ namespace gazebo
       private: void AddCollider(ODECollision *_collision1,
                                 ODECollision *_collision2);
 
+      /// \brief Run dCollide over the normal colliders on the narrow
+      /// phase worker threads, then create their contact joints in
+      /// collider order so the result matches the serial path.
+      private: void CollideParallel();
+
+      /// \brief Create contact joints and contact feedback for contact
+      /// geoms generated between two collision objects.
+      /// \param[in] _collision1 First collision object.
+      /// \param[in] _collision2 Second collision object.
+      /// \param[in] _contactCollisions Array of generated contact geoms.
+      /// \param[in] _numc Number of contact geoms in _contactCollisions.
+      private: void AddContactJoints(ODECollision *_collision1,
+                                     ODECollision *_collision2,
+                                     dContactGeom *_contactCollisions,
+                                     unsigned int _numc);
+
       /// \internal
       /// \brief Private data pointer.
       private: ODEPhysicsPrivate *dataPtr;
@@ -18,7 +18,11 @@
 #ifndef _ODEPHYSICS_PRIVATE_HH_
 #define _ODEPHYSICS_PRIVATE_HH_
 
+#include <tbb/enumerable_thread_specific.h>
+#include <tbb/task_arena.h>
+
 #include <map>
+#include <memory>
 #include <string>
 #include <vector>
 #include <utility>
@@ -45,6 +49,21 @@ namespace gazebo
       public: dJointFeedback feedbacks[MAX_CONTACT_JOINTS];
     };
 
+    /// \brief Contacts generated for one collider pair by the parallel
+    /// narrow phase.
+    class ODEColliderContacts
+    {
+      /// \brief Worker buffer that holds the contact geoms.
+      public: std::vector<dContactGeom> *buffer = nullptr;
+
+      /// \brief Index of the first contact geom in buffer.
+      public: size_t offset = 0;
+
+      /// \brief Number of contact geoms generated. A negative value means
+      /// the pair was skipped by the workers and must be collided serially.
+      public: int count = -1;
+    };
+
     class ODEPhysicsPrivate
     {
       /// \brief Top-level world for all bodies
@@ -92,6 +111,20 @@ namespace gazebo
 
       /// \brief Maximum number of contact points per collision pair.
       public: unsigned int maxContacts;
+
+      /// \brief Number of threads used to collide normal colliders.
+      /// Zero collides every pair serially on the physics thread.
+      public: int collisionThreads = 0;
+
+      /// \brief Task arena that bounds the narrow phase concurrency.
+      public: std::unique_ptr<tbb::task_arena> collisionArena;
+
+      /// \brief Contact geom buffers, one per narrow phase worker.
+      public: tbb::enumerable_thread_specific<std::vector<dContactGeom> >
+              contactBuffers;
+
+      /// \brief Narrow phase results, indexed like colliders.
+      public: std::vector<ODEColliderContacts> colliderContacts;
     };
   }
 }
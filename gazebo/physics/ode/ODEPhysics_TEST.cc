@@ -16,9 +16,13 @@
 */
 
 #include <gtest/gtest.h>
+#include <cstring>
+#include <string>
+#include <vector>
 
 #include "gazebo/physics/physics.hh"
 #include "gazebo/physics/PhysicsEngine.hh"
+#include "gazebo/physics/ode/ODEMesh.hh"
 #include "gazebo/physics/ode/ODEPhysics.hh"
 #include "gazebo/physics/ode/ODETypes.hh"
 #include "gazebo/test/ServerFixture.hh"
@@ -30,6 +34,16 @@ class ODEPhysics_TEST : public ServerFixture
 {
   public: void PhysicsMsgParam();
   public: void OnPhysicsMsgResponse(ConstResponsePtr &_msg);
+
+  /// \brief Step a world serially and with 4 threads, and expect the
+  /// models to end at bit for bit the same poses.
+  /// \param[in] _world World to step, reset before each run.
+  /// \param[in] _param Physics parameter that sets the number of threads.
+  /// \param[in] _names Names of the models to compare.
+  public: void ExpectThreadsDeterministic(WorldPtr _world,
+              const std::string &_param,
+              const std::vector<std::string> &_names);
+
   public: static msgs::Physics physicsPubMsg;
   public: static msgs::Physics physicsResponseMsg;
 };
@@ -37,6 +51,46 @@ class ODEPhysics_TEST : public ServerFixture
 msgs::Physics ODEPhysics_TEST::physicsPubMsg;
 msgs::Physics ODEPhysics_TEST::physicsResponseMsg;
 
+/////////////////////////////////////////////////
+void ODEPhysics_TEST::ExpectThreadsDeterministic(WorldPtr _world,
+    const std::string &_param, const std::vector<std::string> &_names)
+{
+  const unsigned int steps = 500;
+  std::vector<std::vector<ignition::math::Pose3d>> poses;
+  for (auto const threads : {0, 4})
+  {
+    _world->Reset();
+    EXPECT_TRUE(_world->Physics()->SetParam(_param, threads));
+    _world->Step(steps);
+
+    std::vector<ignition::math::Pose3d> run;
+    for (auto const &name : _names)
+    {
+      ModelPtr model = _world->ModelByName(name);
+      ASSERT_TRUE(model != nullptr);
+      run.push_back(model->WorldPose());
+    }
+    poses.push_back(run);
+  }
+
+  // Pose3d::operator== is tolerant, so the components are compared bit for
+  // bit.
+  ASSERT_EQ(poses.size(), 2u);
+  for (unsigned int i = 0; i < _names.size(); ++i)
+  {
+    const ignition::math::Pose3d &serial = poses[0][i];
+    const ignition::math::Pose3d &parallel = poses[1][i];
+    const double serialValues[] = {serial.Pos().X(), serial.Pos().Y(),
+        serial.Pos().Z(), serial.Rot().W(), serial.Rot().X(),
+        serial.Rot().Y(), serial.Rot().Z()};
+    const double parallelValues[] = {parallel.Pos().X(), parallel.Pos().Y(),
+        parallel.Pos().Z(), parallel.Rot().W(), parallel.Rot().X(),
+        parallel.Rot().Y(), parallel.Rot().Z()};
+    EXPECT_EQ(0, std::memcmp(serialValues, parallelValues,
+        sizeof(serialValues))) << _names[i] << " with " << _param;
+  }
+}
+
 /////////////////////////////////////////////////
 /// Test setting and getting ode physics params
 TEST_F(ODEPhysics_TEST, PhysicsParam)
@@ -68,6 +122,7 @@ TEST_F(ODEPhysics_TEST, PhysicsParam)
   bool experimentalRowReordering = true;
   double warmStartFactor = 1.0;
   int extraFrictionIterations = 15;
+  bool vectorizedRows = false;
 
   // test setting/getting physics engine params
   EXPECT_TRUE(odePhysics->SetParam("solver_type", type));
@@ -92,6 +147,7 @@ TEST_F(ODEPhysics_TEST, PhysicsParam)
                                     warmStartFactor));
   EXPECT_TRUE(odePhysics->SetParam("extra_friction_iterations",
                                     extraFrictionIterations));
+  EXPECT_TRUE(odePhysics->SetParam("vectorized_rows", vectorizedRows));
 
   boost::any value;
   value = odePhysics->GetParam("solver_type");
@@ -136,6 +192,8 @@ TEST_F(ODEPhysics_TEST, PhysicsParam)
   value = odePhysics->GetParam("extra_friction_iterations");
   int extraFrictionIterationsRet = boost::any_cast<int>(value);
   EXPECT_EQ(extraFrictionIterations, extraFrictionIterationsRet);
+  value = odePhysics->GetParam("vectorized_rows");
+  EXPECT_EQ(vectorizedRows, boost::any_cast<bool>(value));
 
   // verify against equivalent functions
   EXPECT_EQ(type, odePhysics->GetStepType());
@@ -164,6 +222,7 @@ TEST_F(ODEPhysics_TEST, PhysicsParam)
   experimentalRowReordering = false;
   warmStartFactor = 0.9;
   extraFrictionIterations = 14;
+  vectorizedRows = true;
 
   EXPECT_TRUE(odePhysics->SetParam("solver_type", type));
   EXPECT_TRUE(odePhysics->SetParam("precon_iters", preconIters));
@@ -187,6 +246,7 @@ TEST_F(ODEPhysics_TEST, PhysicsParam)
                                     warmStartFactor));
   EXPECT_TRUE(odePhysics->SetParam("extra_friction_iterations",
                                     extraFrictionIterations));
+  EXPECT_TRUE(odePhysics->SetParam("vectorized_rows", vectorizedRows));
 
   value = odePhysics->GetParam("solver_type");
   typeRet = boost::any_cast<std::string>(value);
@@ -230,6 +290,8 @@ TEST_F(ODEPhysics_TEST, PhysicsParam)
   value = odePhysics->GetParam("extra_friction_iterations");
   extraFrictionIterationsRet = boost::any_cast<int>(value);
   EXPECT_EQ(extraFrictionIterations, extraFrictionIterationsRet);
+  value = odePhysics->GetParam("vectorized_rows");
+  EXPECT_EQ(vectorizedRows, boost::any_cast<bool>(value));
 
   EXPECT_EQ(type, odePhysics->GetStepType());
   EXPECT_EQ(preconIters, odePhysics->GetSORPGSPreconIters());
@@ -320,6 +382,32 @@ TEST_F(ODEPhysics_TEST, PhysicsParam)
     }
   }
 
+  // Test collision_threads
+  {
+    // collision_threads should be 0 by default
+    int collisionThreads = 1;
+    EXPECT_NO_THROW(collisionThreads =
+      boost::any_cast<int>(odePhysics->GetParam("collision_threads")));
+    EXPECT_EQ(collisionThreads, 0);
+
+    // try enabling threads, then disabling
+    std::vector<int> threads = {1, 2, 4, 0};
+    for (auto const collisionThreadsSet : threads)
+    {
+      EXPECT_TRUE(
+          odePhysics->SetParam("collision_threads", collisionThreadsSet));
+      EXPECT_NO_THROW(collisionThreads =
+        boost::any_cast<int>(odePhysics->GetParam("collision_threads")));
+      EXPECT_EQ(collisionThreads, collisionThreadsSet);
+    }
+
+    // negative thread counts are rejected
+    EXPECT_FALSE(odePhysics->SetParam("collision_threads", -1));
+    EXPECT_NO_THROW(collisionThreads =
+      boost::any_cast<int>(odePhysics->GetParam("collision_threads")));
+    EXPECT_EQ(collisionThreads, 0);
+  }
+
   // Test ode_quiet
   // convenient for disabling LCP internal error messages from world solver
   {
@@ -490,8 +578,101 @@ TEST_F(ODEPhysics_TEST, PhysicsMsgParam)
   PhysicsMsgParam();
 }
 
+/////////////////////////////////////////////////
+/// Test that the parallel narrow phase matches the serial one exactly
+TEST_F(ODEPhysics_TEST, CollisionThreadsDeterministic)
+{
+  Load("worlds/empty.world", true, "ode");
+  WorldPtr world = get_world("default");
+  ASSERT_TRUE(world != nullptr);
+
+  PhysicsEnginePtr physics = world->Physics();
+  ASSERT_TRUE(physics != nullptr);
+
+  // A loose pile of boxes that keeps colliding with itself and the ground
+  std::vector<std::string> names;
+  for (unsigned int i = 0; i < 12; ++i)
+  {
+    const std::string name = "box_" + std::to_string(i);
+    SpawnBox(name, ignition::math::Vector3d(0.5, 0.5, 0.5),
+        ignition::math::Vector3d(0.3 * (i % 3), 0.2 * (i % 4), 0.5 + 0.6 * i),
+        ignition::math::Vector3d(0.1 * i, 0.05 * i, 0.0));
+    names.push_back(name);
+  }
+
+  ExpectThreadsDeterministic(world, "collision_threads", names);
+}
+
+/////////////////////////////////////////////////
+/// Test that islands and the position correction solved on the scheduler
+/// match the serial solve exactly
+TEST_F(ODEPhysics_TEST, IslandThreadsDeterministic)
+{
+  Load("worlds/empty.world", true, "ode");
+  WorldPtr world = get_world("default");
+  ASSERT_TRUE(world != nullptr);
+
+  PhysicsEnginePtr physics = world->Physics();
+  ASSERT_TRUE(physics != nullptr);
+  EXPECT_TRUE(physics->SetParam("thread_position_correction", true));
+
+  // Stacks far enough apart to be separate islands, of different sizes
+  const unsigned int stackCount = 4;
+  std::vector<std::string> names;
+  for (unsigned int s = 0; s < stackCount; ++s)
+  {
+    for (unsigned int i = 0; i <= s * 2; ++i)
+    {
+      const std::string name =
+          "box_" + std::to_string(s) + "_" + std::to_string(i);
+      SpawnBox(name, ignition::math::Vector3d(0.5, 0.5, 0.5),
+          ignition::math::Vector3d(3.0 * s + 0.05 * i, 0.03 * i,
+              0.3 + 0.55 * i),
+          ignition::math::Vector3d(0.0, 0.0, 0.1 * i));
+      names.push_back(name);
+    }
+  }
+
+  ExpectThreadsDeterministic(world, "island_threads", names);
+}
+
+/////////////////////////////////////////////////
+TEST_F(ODEPhysics_TEST, SharedTrimeshData)
+{
+  Load("worlds/empty.world", true, "ode");
+  WorldPtr world = get_world("default");
+  ASSERT_TRUE(world != nullptr);
+
+  std::string meshPath = std::string(TEST_PATH) +
+      "/media/models/cube_20k/meshes/cube_20k.stl";
+  size_t cacheSize = ODEMesh::CacheSize();
+
+  // Collisions with the same mesh and scale share their trimesh data
+  SpawnTrimesh("mesh_0", meshPath, ignition::math::Vector3d::One,
+      ignition::math::Vector3d(0, 0, 1));
+  EXPECT_EQ(ODEMesh::CacheSize(), cacheSize + 1);
+  SpawnTrimesh("mesh_1", meshPath, ignition::math::Vector3d::One,
+      ignition::math::Vector3d(2, 0, 1));
+  EXPECT_EQ(ODEMesh::CacheSize(), cacheSize + 1);
+
+  // A different scale needs its own data
+  SpawnTrimesh("mesh_2", meshPath, ignition::math::Vector3d(2, 2, 2),
+      ignition::math::Vector3d(4, 0, 1));
+  EXPECT_EQ(ODEMesh::CacheSize(), cacheSize + 2);
+
+  // The shared data collides like separate copies would
+  world->Step(100);
+  for (auto const &name : {"mesh_0", "mesh_1", "mesh_2"})
+  {
+    ModelPtr model = world->ModelByName(name);
+    ASSERT_TRUE(model != nullptr);
+    EXPECT_GT(model->WorldPose().Pos().Z(), 0.0);
+  }
+}
+
 /////////////////////////////////////////////////
 /// Main
+/////////////////////////////////////////////////
 int main(int argc, char **argv)
 {
   ::testing::InitGoogleTest(&argc, argv);
@@ -352,6 +352,8 @@ void Camera::Init()
 //////////////////////////////////////////////////
 void Camera::Fini()
 {
+  this->dataPtr->videoSink.Stop();
+  this->dataPtr->saveSink.Stop();
   this->dataPtr->videoEncoder.Reset();
 
   if (this->saveFrameBuffer)
@@ -685,13 +687,16 @@ void Camera::PostRender()
     }
     else if (this->dataPtr->videoEncoder.IsEncoding())
     {
-      this->dataPtr->videoEncoder.AddFrame(buffer, width, height);
+      // The frame is encoded on the video sink's worker thread
+      this->dataPtr->videoSink.Push(buffer,
+          Camera::ImageByteSize(width, height, this->ImageFormat()),
+          width, height);
     }
 
     if (this->sdf->HasElement("save") &&
         this->sdf->GetElement("save")->Get<bool>("enabled"))
     {
-      this->SaveFrame(this->FrameFilename());
+      this->PushSaveFrame();
     }
 
     // do last minute conversion if Bayer pattern is requested, go from R8G8B8
@@ -1032,6 +1037,10 @@ void Camera::EnableSaveFrame(const bool _enable)
   sdf::ElementPtr elem = this->sdf->GetElement("save");
   elem->GetAttribute("enabled")->Set(_enable);
   this->captureData = _enable;
+
+  // Write the frames that are still queued
+  if (!_enable)
+    this->dataPtr->saveSink.Stop();
 }
 
 //////////////////////////////////////////////////
@@ -1185,6 +1194,36 @@ bool Camera::SaveFrame(const std::string &_filename)
                           this->ImageFormat(), _filename);
 }
 
+//////////////////////////////////////////////////
+void Camera::PushSaveFrame()
+{
+  const unsigned int width = this->ImageWidth();
+  const unsigned int height = this->ImageHeight();
+  const int depth = this->ImageDepth();
+  const std::string format = this->ImageFormat();
+
+  // The format and depth are the same for every frame in the sink, so
+  // it is restarted if they change.
+  if (!this->dataPtr->saveSink.Running() ||
+      this->dataPtr->saveSinkFormat != format ||
+      this->dataPtr->saveSinkDepth != depth)
+  {
+    this->dataPtr->saveSinkFormat = format;
+    this->dataPtr->saveSinkDepth = depth;
+    this->dataPtr->saveSink.Start(
+        [depth, format](const common::FrameSinkFrame &_frame)
+        {
+          Camera::SaveFrame(_frame.data.data(), _frame.width, _frame.height,
+              depth, format, _frame.name);
+        }, this->dataPtr->frameSinkCapacity, 1,
+        this->dataPtr->frameSinkPolicy);
+  }
+
+  this->dataPtr->saveSink.Push(this->saveFrameBuffer,
+      Camera::ImageByteSize(width, height, format), width, height,
+      this->FrameFilename());
+}
+
 //////////////////////////////////////////////////
 std::string Camera::FrameFilename()
 {
@@ -1442,13 +1481,30 @@ void Camera::SetCaptureDataOnce()
 bool Camera::StartVideo(const std::string &_format,
                         const std::string &_filename)
 {
-  return this->dataPtr->videoEncoder.Start(_format, _filename,
-      this->ImageWidth(), this->ImageHeight());
+  if (!this->dataPtr->videoEncoder.Start(_format, _filename,
+      this->ImageWidth(), this->ImageHeight()))
+  {
+    return false;
+  }
+
+  // The frames keep the time they were rendered at, so that the encoder
+  // drops the same frames as when they were added from the render thread.
+  common::VideoEncoder &encoder = this->dataPtr->videoEncoder;
+  this->dataPtr->videoSink.Start(
+      [&encoder](const common::FrameSinkFrame &_frame)
+      {
+        encoder.AddFrame(_frame.data.data(), _frame.width, _frame.height,
+            _frame.timestamp);
+      }, this->dataPtr->frameSinkCapacity, 1,
+      this->dataPtr->frameSinkPolicy);
+  return true;
 }
 
 //////////////////////////////////////////////////
 bool Camera::StopVideo()
 {
+  // Encode the frames that are still queued
+  this->dataPtr->videoSink.Stop();
   return this->dataPtr->videoEncoder.Stop();
 }
 
@@ -1457,16 +1513,38 @@ bool Camera::SaveVideo(const std::string &_filename)
 {
   // This will stop video encoding, save the video file, and reset
   // video encoding.
+  this->dataPtr->videoSink.Stop();
   return this->dataPtr->videoEncoder.SaveToFile(_filename);
 }
 
 //////////////////////////////////////////////////
 bool Camera::ResetVideo()
 {
+  this->dataPtr->videoSink.Stop();
   this->dataPtr->videoEncoder.Reset();
   return true;
 }
 
+//////////////////////////////////////////////////
+void Camera::SetFrameSinkPolicy(const common::FrameSinkPolicy _policy,
+    const unsigned int _capacity)
+{
+  this->dataPtr->frameSinkPolicy = _policy;
+  this->dataPtr->frameSinkCapacity = _capacity;
+}
+
+//////////////////////////////////////////////////
+common::FrameSinkStats Camera::VideoFrameSinkStats() const
+{
+  return this->dataPtr->videoSink.Stats();
+}
+
+//////////////////////////////////////////////////
+common::FrameSinkStats Camera::SaveFrameSinkStats() const
+{
+  return this->dataPtr->saveSink.Stats();
+}
+
 //////////////////////////////////////////////////
 void Camera::CreateRenderTexture(const std::string &_textureName)
 {
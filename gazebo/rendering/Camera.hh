@@ -41,6 +41,7 @@
 #include "gazebo/transport/Subscriber.hh"
 
 #include "gazebo/common/Event.hh"
+#include "gazebo/common/FrameSink.hh"
 #include "gazebo/common/PID.hh"
 #include "gazebo/common/Time.hh"
 
@@ -529,6 +530,28 @@ namespace gazebo
       /// always return true.
       public: bool ResetVideo();
 
+      /// \brief Set how the frames that are recorded to video or saved to
+      /// disk are queued. The frames are copied to a ring of buffers, and
+      /// encoded or written by a worker thread, so that the render thread
+      /// does not wait for them. Takes effect the next time video
+      /// recording starts, or frame saving is enabled.
+      /// \param[in] _policy What to do when the ring is full: drop the
+      /// frame, or wait for the worker to catch up.
+      /// \param[in] _capacity Number of frames in the ring.
+      /// \sa common::FrameSink
+      public: void SetFrameSinkPolicy(const common::FrameSinkPolicy _policy,
+                  const unsigned int _capacity = 4);
+
+      /// \brief Get the statistics of the frames queued for the video
+      /// encoder since video recording started.
+      /// \return The statistics.
+      public: common::FrameSinkStats VideoFrameSinkStats() const;
+
+      /// \brief Get the statistics of the frames queued to be saved to
+      /// disk since frame saving was enabled.
+      /// \return The statistics.
+      public: common::FrameSinkStats SaveFrameSinkStats() const;
+
       /// \brief Set the render target
       /// \param[in] _textureName Name of the new render texture
       public: void CreateRenderTexture(const std::string &_textureName);
@@ -827,6 +850,10 @@ namespace gazebo
       /// \return The frame's filename
       protected: std::string FrameFilename();
 
+      /// \brief Queue the current frame to be saved to disk by a worker
+      /// thread.
+      private: void PushSaveFrame();
+
       /// \brief Internal function used to indicate that an animation has
       /// completed.
       protected: virtual void AnimationComplete();
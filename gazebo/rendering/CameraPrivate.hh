@@ -19,10 +19,12 @@
 
 #include <deque>
 #include <mutex>
+#include <string>
 #include <utility>
 #include <list>
 #include <ignition/math/Pose3.hh>
 
+#include "gazebo/common/FrameSink.hh"
 #include "gazebo/common/PID.hh"
 #include "gazebo/common/VideoEncoder.hh"
 #include "gazebo/msgs/msgs.hh"
@@ -112,6 +114,26 @@ namespace gazebo
       /// \brief Video encoder.
       public: common::VideoEncoder videoEncoder;
 
+      /// \brief Hands the recorded frames to the video encoder on a worker
+      /// thread. Declared after the encoder, so that it stops first.
+      public: common::FrameSink videoSink;
+
+      /// \brief Writes the frames saved to disk on a worker thread.
+      public: common::FrameSink saveSink;
+
+      /// \brief Image format of the frames in saveSink.
+      public: std::string saveSinkFormat;
+
+      /// \brief Image depth of the frames in saveSink.
+      public: int saveSinkDepth = 0;
+
+      /// \brief What the frame sinks do when they are full.
+      public: common::FrameSinkPolicy frameSinkPolicy =
+                  common::FrameSinkPolicy::BLOCK;
+
+      /// \brief Number of frames each frame sink holds.
+      public: unsigned int frameSinkCapacity = 4;
+
       /// \brief If set to true, the camera yaws around a fixed axis.
       public: bool yawFixed;
 
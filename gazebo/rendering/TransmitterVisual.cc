@@ -14,6 +14,8 @@
  * limitations under the License.
  *
 */
+#include <algorithm>
+
 #include <boost/bind.hpp>
 
 #include <ignition/common/Profiler.hh>
@@ -94,8 +96,6 @@ void TransmitterVisual::Update()
   TransmitterVisualPrivate *dPtr =
       reinterpret_cast<TransmitterVisualPrivate *>(this->dataPtr);
 
-  gazebo::msgs::PropagationParticle p;
-
   boost::mutex::scoped_lock lock(dPtr->mutex);
 
   if (!dPtr->gridMsg || !dPtr->receivedMsg)
@@ -104,24 +104,50 @@ void TransmitterVisual::Update()
   // Update the visualization of the last propagation grid received
   dPtr->receivedMsg = false;
 
+  // The grid is either a list of particles or packed arrays
+  const msgs::PropagationGrid &grid = *dPtr->gridMsg;
+  const bool packed = grid.particle_size() == 0;
+  const int count = packed ?
+      std::min(grid.position_size() / 2, grid.signal_level_size()) :
+      grid.particle_size();
+
   if (dPtr->isFirst)
   {
-    for (int i = 0; i < dPtr->gridMsg->particle_size(); ++i)
+    for (int i = 0; i < count; ++i)
     {
-      p = dPtr->gridMsg->particle(i);
-      dPtr->points->AddPoint(p.x(), p.y(), 0.0);
+      if (packed)
+      {
+        dPtr->points->AddPoint(grid.position(2 * i),
+            grid.position(2 * i + 1), 0.0);
+      }
+      else
+      {
+        dPtr->points->AddPoint(grid.particle(i).x(), grid.particle(i).y(),
+            0.0);
+      }
     }
     dPtr->isFirst = false;
   }
 
   // Update the list of visual elements
-  for (int i = 0; i < dPtr->gridMsg->particle_size(); ++i)
+  for (int i = 0; i < count; ++i)
   {
-    p = dPtr->gridMsg->particle(i);
-    dPtr->points->SetPoint(i, ignition::math::Vector3d(p.x(), p.y(), 0));
+    double signalLevel;
+    if (packed)
+    {
+      dPtr->points->SetPoint(i, ignition::math::Vector3d(
+          grid.position(2 * i), grid.position(2 * i + 1), 0));
+      signalLevel = grid.signal_level(i);
+    }
+    else
+    {
+      const msgs::PropagationParticle &p = grid.particle(i);
+      dPtr->points->SetPoint(i, ignition::math::Vector3d(p.x(), p.y(), 0));
+      signalLevel = p.signal_level();
+    }
 
     // Crop the signal strength between 0 and 255
-    double strength = std::min(std::max(0.0, -p.signal_level()), 255.0);
+    double strength = std::min(std::max(0.0, -signalLevel), 255.0);
     // Normalize
     strength = 1.0 - (strength / 255.0);
 
@@ -15,6 +15,8 @@
  *
 */
 #include <boost/algorithm/string.hpp>
+#include <algorithm>
+#include <functional>
 #include <sstream>
 
 #include <ignition/common/Profiler.hh>
@@ -49,6 +51,15 @@ ContactSensor::ContactSensor()
 //////////////////////////////////////////////////
 ContactSensor::~ContactSensor()
 {
+  // The contact manager must not call a sensor destroyed without Fini
+  if (this->dataPtr->contactsListener >= 0 && this->world &&
+      this->world->Physics())
+  {
+    this->world->Physics()->GetContactManager()->DisconnectFilter(
+        this->dataPtr->filterName, this->dataPtr->contactsListener);
+    this->dataPtr->contactsListener = -1;
+  }
+
   this->dataPtr->collisions.clear();
 }
 
@@ -114,12 +125,15 @@ void ContactSensor::Load(const std::string &_worldName)
     // request the contact manager to publish messages to a custom topic for
     // this sensor
     physics::ContactManager *mgr = this->world->Physics()->GetContactManager();
-    std::string topic = mgr->CreateFilter(this->dataPtr->filterName,
-        this->dataPtr->collisions);
-    if (!this->dataPtr->contactSub)
+    mgr->CreateFilter(this->dataPtr->filterName, this->dataPtr->collisions);
+
+    // The sensor runs in the same process as the contact manager, so it
+    // gets the contacts directly instead of subscribing to the topic
+    if (this->dataPtr->contactsListener < 0)
     {
-      this->dataPtr->contactSub = this->node->Subscribe(topic,
-          &ContactSensor::OnContacts, this);
+      this->dataPtr->contactsListener = mgr->ConnectFilter(
+          this->dataPtr->filterName, std::bind(&ContactSensor::OnContacts,
+          this, std::placeholders::_1));
     }
   }
 }
@@ -139,72 +153,28 @@ bool ContactSensor::UpdateImpl(const bool /*_force*/)
   std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
 
   // Don't do anything if there is no new data to process.
-  if (this->dataPtr->incomingContacts.empty())
+  if (this->dataPtr->incomingSteps.empty())
     return false;
 
-  std::vector<std::string>::iterator collIter;
-  std::string collision1;
-
-  // Clear the outgoing contact message.
-  this->dataPtr->contactsMsg.clear_contact();
-
-  // Iterate over all the contact messages
-  for (auto iter = this->dataPtr->incomingContacts.begin();
-       iter != this->dataPtr->incomingContacts.end(); ++iter)
-  {
-    // Iterate over all the contacts in the message
-    for (int i = 0; i < (*iter)->contact_size(); ++i)
-    {
-      collision1 = (*iter)->contact(i).collision1();
-
-      // Try to find the first collision's name
-      collIter = std::find(this->dataPtr->collisions.begin(),
-          this->dataPtr->collisions.end(), collision1);
-
-      // If unable to find the first collision's name, try the second
-      if (collIter == this->dataPtr->collisions.end())
-      {
-        collision1 = (*iter)->contact(i).collision2();
-        collIter = std::find(this->dataPtr->collisions.begin(),
-            this->dataPtr->collisions.end(), collision1);
-      }
-
-      // If this sensor is monitoring one of the collision's in the
-      // contact, then add the contact to our outgoing message.
-      if (collIter != this->dataPtr->collisions.end())
-      {
-        int count = (*iter)->contact(i).position_size();
-
-        // Check to see if the contact arrays all have the same size.
-        if (count != (*iter)->contact(i).normal_size() ||
-            count != (*iter)->contact(i).wrench_size() ||
-            count != (*iter)->contact(i).depth_size())
-        {
-          gzerr << "Contact message has invalid array sizes\n";
-          continue;
-        }
-
-        // Copy the contact message.
-        msgs::Contact *contactMsg = this->dataPtr->contactsMsg.add_contact();
-        contactMsg->CopyFrom((*iter)->contact(i));
-      }
-    }
-  }
+  // The contacts received since the last update become the measured
+  // contacts. The previous ones are kept to reuse their memory.
+  std::swap(this->dataPtr->contacts, this->dataPtr->incomingContacts);
+  this->dataPtr->contactCount = this->dataPtr->incomingCount;
+  this->dataPtr->incomingCount = 0;
+  this->dataPtr->incomingSteps.clear();
 
   IGN_PROFILE_END();
   IGN_PROFILE_BEGIN("Publish");
 
-  // Clear the incoming contact list.
-  this->dataPtr->incomingContacts.clear();
-
   this->lastMeasurementTime = this->world->SimTime();
-  msgs::Set(this->dataPtr->contactsMsg.mutable_time(),
-            this->lastMeasurementTime);
+  this->dataPtr->contactsMsgStale = true;
 
   // Generate a outgoing message only if someone is listening.
   if (this->dataPtr->contactsPub &&
       this->dataPtr->contactsPub->HasConnections())
   {
+    this->dataPtr->UpdateContactsMsg(this->world->Name(),
+        this->lastMeasurementTime);
     this->dataPtr->contactsPub->Publish(this->dataPtr->contactsMsg);
   }
 
@@ -215,14 +185,20 @@ bool ContactSensor::UpdateImpl(const bool /*_force*/)
 //////////////////////////////////////////////////
 void ContactSensor::Fini()
 {
-  if (this->world && this->world->Running())
+  if (this->world && this->world->Physics())
   {
     physics::ContactManager *mgr =
         this->world->Physics()->GetContactManager();
-    mgr->RemoveFilter(this->dataPtr->filterName);
+    if (this->dataPtr->contactsListener >= 0)
+    {
+      mgr->DisconnectFilter(this->dataPtr->filterName,
+          this->dataPtr->contactsListener);
+    }
+    if (this->world->Running())
+      mgr->RemoveFilter(this->dataPtr->filterName);
   }
 
-  this->dataPtr->contactSub.reset();
+  this->dataPtr->contactsListener = -1;
   this->dataPtr->contactsPub.reset();
   Sensor::Fini();
 }
@@ -251,12 +227,13 @@ unsigned int ContactSensor::GetCollisionContactCount(
   std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
   unsigned int result = 0;
 
-  for (int i = 0; i < this->dataPtr->contactsMsg.contact_size(); ++i)
+  for (size_t i = 0; i < this->dataPtr->contactCount; ++i)
   {
-    if (this->dataPtr->contactsMsg.contact(i).collision1() == _collisionName ||
-        this->dataPtr->contactsMsg.contact(i).collision2() == _collisionName)
+    const physics::ContactRecord &contact = this->dataPtr->contacts[i];
+    if (contact.collision1 == _collisionName ||
+        contact.collision2 == _collisionName)
     {
-      result += this->dataPtr->contactsMsg.contact(i).position_size();
+      result += contact.positions.size();
     }
   }
 
@@ -267,14 +244,28 @@ unsigned int ContactSensor::GetCollisionContactCount(
 msgs::Contacts ContactSensor::Contacts() const
 {
   std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  this->dataPtr->UpdateContactsMsg(this->world->Name(),
+      this->lastMeasurementTime);
   return this->dataPtr->contactsMsg;
 }
 
+//////////////////////////////////////////////////
+void ContactSensor::ContactRecords(
+    std::vector<physics::ContactRecord> &_contacts) const
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  _contacts.resize(this->dataPtr->contactCount);
+  for (size_t i = 0; i < this->dataPtr->contactCount; ++i)
+    _contacts[i] = this->dataPtr->contacts[i];
+}
+
 //////////////////////////////////////////////////
 std::map<std::string, gazebo::physics::Contact> ContactSensor::Contacts(
     const std::string &_collisionName) const
 {
   std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  this->dataPtr->UpdateContactsMsg(this->world->Name(),
+      this->lastMeasurementTime);
 
   std::map<std::string, gazebo::physics::Contact> result;
 
@@ -304,20 +295,64 @@ std::map<std::string, gazebo::physics::Contact> ContactSensor::Contacts(
 }
 
 //////////////////////////////////////////////////
-void ContactSensor::OnContacts(ConstContactsPtr &_msg)
+void ContactSensor::OnContacts(const physics::ContactRecordSpan &_contacts)
 {
   std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
 
   // Only store information if the sensor is active
-  if (this->IsActive())
+  if (!this->IsActive())
+    return;
+
+  // Store the contacts for processing in UpdateImpl
+  size_t count = 0;
+  for (size_t i = 0; i < _contacts.Size(); ++i)
   {
-    // Store the contacts message for processing in UpdateImpl
-    this->dataPtr->incomingContacts.push_back(_msg);
+    const physics::ContactRecord &contact = _contacts[i];
+
+    // Keep the contact if this sensor is monitoring one of its collisions
+    auto const &collisions = this->dataPtr->collisions;
+    if (std::find(collisions.begin(), collisions.end(), contact.collision1) ==
+        collisions.end() &&
+        std::find(collisions.begin(), collisions.end(), contact.collision2) ==
+        collisions.end())
+    {
+      continue;
+    }
 
-    // Prevent the incomingContacts list to grow indefinitely.
-    if (this->dataPtr->incomingContacts.size() > 100)
-      this->dataPtr->incomingContacts.pop_front();
+    if (this->dataPtr->incomingCount ==
+        this->dataPtr->incomingContacts.size())
+    {
+      this->dataPtr->incomingContacts.emplace_back();
+    }
+    this->dataPtr->incomingContacts[this->dataPtr->incomingCount++] = contact;
+    ++count;
   }
+  this->dataPtr->incomingSteps.push_back(count);
+
+  // Prevent the incoming contacts to grow indefinitely.
+  if (this->dataPtr->incomingSteps.size() > 100)
+  {
+    auto begin = this->dataPtr->incomingContacts.begin();
+    std::rotate(begin, begin + this->dataPtr->incomingSteps.front(),
+        begin + this->dataPtr->incomingCount);
+    this->dataPtr->incomingCount -= this->dataPtr->incomingSteps.front();
+    this->dataPtr->incomingSteps.pop_front();
+  }
+}
+
+//////////////////////////////////////////////////
+void ContactSensorPrivate::UpdateContactsMsg(const std::string &_world,
+    const common::Time &_time)
+{
+  if (!this->contactsMsgStale)
+    return;
+
+  this->contactsMsg.clear_contact();
+  for (size_t i = 0; i < this->contactCount; ++i)
+    this->contacts[i].FillMsg(_world, *this->contactsMsg.add_contact());
+  msgs::Set(this->contactsMsg.mutable_time(), _time);
+
+  this->contactsMsgStale = false;
 }
 
 //////////////////////////////////////////////////
@@ -20,6 +20,7 @@
 #include <map>
 #include <string>
 #include <memory>
+#include <vector>
 
 #include "gazebo/msgs/msgs.hh"
 
@@ -29,6 +30,12 @@
 
 namespace gazebo
 {
+  namespace physics
+  {
+    class ContactRecord;
+    class ContactRecordSpan;
+  }
+
   /// \ingroup gazebo_sensors
   /// \brief Sensors namespace
   namespace sensors
@@ -94,10 +101,10 @@ namespace gazebo
       /// to publish all contacts generated within a timestep onto
       /// Gazebo topic ~/physics/contacts.
       ///
-      /// Each ContactSensor subscribes to the Gazebo ~/physics/contacts topic,
-      /// retrieves all contact pairs in a time step and filters them wthin
-      /// ContactSensor::OnContacts against <collision> body name
-      /// specified by the ContactSensor SDF.
+      /// Each ContactSensor creates a contact filter for the <collision>
+      /// bodies specified by the ContactSensor SDF, and receives the
+      /// filtered contact pairs of every time step in process from the
+      /// ContactManager, without messages.
       /// All collision pairs between ContactSensor <collision> body and
       /// other bodies in the world are stored in an array inside
       /// contacts.proto.
@@ -124,6 +131,14 @@ namespace gazebo
       ///    \li Time time          time at which this contact happened.
       public: msgs::Contacts Contacts() const;
 
+      /// \brief Get all the contacts for the ContactSensor without building
+      /// a message. Prefer this to Contacts() when the contacts are read at
+      /// every update.
+      /// \param[out] _contacts The contacts. It is resized to the number of
+      /// contacts, and the memory of its elements is reused.
+      public: void ContactRecords(
+                  std::vector<physics::ContactRecord> &_contacts) const;
+
       /// \brief Gets contacts of a collision
       /// \param[in] _collisionName Name of collision
       /// \return Container of contacts
@@ -133,8 +148,10 @@ namespace gazebo
       // Documentation inherited.
       public: virtual bool IsActive() const;
 
-      /// \brief Callback for contact messages from the physics engine.
-      private: void OnContacts(ConstContactsPtr &_msg);
+      /// \brief Callback for the contacts of a step from the contact
+      /// manager.
+      /// \param[in] _contacts Contacts of the sensor's filter.
+      private: void OnContacts(const physics::ContactRecordSpan &_contacts);
 
       /// \internal
       /// \brief Private data pointer
@@ -17,13 +17,14 @@
 #ifndef _GAZEBO_SENSORS_CONTACTSENSOR_PRIVATE_HH_
 #define _GAZEBO_SENSORS_CONTACTSENSOR_PRIVATE_HH_
 
+#include <deque>
 #include <vector>
-#include <list>
 #include <string>
 #include <mutex>
 
 #include "gazebo/transport/TransportTypes.hh"
 #include "gazebo/msgs/msgs.hh"
+#include "gazebo/physics/ContactManager.hh"
 
 namespace gazebo
 {
@@ -33,27 +34,50 @@ namespace gazebo
     /// \brief Contact sensor private data.
     class ContactSensorPrivate
     {
+      /// \brief Fill contactsMsg with the measured contacts, if it is out
+      /// of date.
+      /// \param[in] _world Name of the world.
+      /// \param[in] _time Time of the measurement.
+      public: void UpdateContactsMsg(const std::string &_world,
+                  const common::Time &_time);
+
       /// \brief Collisions this sensor monitors for contacts
       public: std::vector<std::string> collisions;
 
       /// \brief Output contact information.
       public: transport::PublisherPtr contactsPub;
 
-      /// \brief Subscription to contact messages from the physics engine
-      public: transport::SubscriberPtr contactSub;
+      /// \brief Id of the listener of the contact filter, -1 if not
+      /// connected.
+      public: int contactsListener = -1;
 
       /// \brief Mutex to protect reads and writes.
       public: mutable std::mutex mutex;
 
-      /// \brief Contacts message used to output sensor data.
+      /// \brief Contacts message used to output sensor data. It is only
+      /// filled in when it is published or requested.
       public: msgs::Contacts contactsMsg;
 
-      /// \type ContactMsgs_L
-      /// List of contact messages
-      typedef std::list<boost::shared_ptr<msgs::Contacts const> > ContactMsgs_L;
+      /// \brief True if contactsMsg doesn't hold the measured contacts.
+      public: bool contactsMsgStale = false;
+
+      /// \brief Measured contacts. Only the first contactCount are valid,
+      /// the others are kept to reuse their memory.
+      public: std::vector<physics::ContactRecord> contacts;
+
+      /// \brief Number of measured contacts.
+      public: size_t contactCount = 0;
+
+      /// \brief Contacts received since the last update. Only the first
+      /// incomingCount are valid.
+      public: std::vector<physics::ContactRecord> incomingContacts;
+
+      /// \brief Number of contacts received since the last update.
+      public: size_t incomingCount = 0;
 
-      /// \brief List of incoming messages.
-      public: ContactMsgs_L incomingContacts;
+      /// \brief Number of contacts received at each step since the last
+      /// update.
+      public: std::deque<size_t> incomingSteps;
 
       /// \brief Name of filter used to filter contact messages.
       public: std::string filterName;
@@ -14,6 +14,9 @@
  * limitations under the License.
  *
 */
+#include <functional>
+#include <typeinfo>
+
 #include <ignition/math/Helpers.hh>
 #include <ignition/math/Rand.hh>
 
@@ -92,6 +95,8 @@ GaussianNoiseModel::GaussianNoiseModel()
     dynamicBiasStdDev(0),
     dynamicBiasCorrTime(0)
 {
+  this->SetApplyBatch(std::bind(&GaussianNoiseModel::ApplyBatch, this,
+      std::placeholders::_1, std::placeholders::_2, std::placeholders::_3));
 }
 
 //////////////////////////////////////////////////
@@ -148,7 +153,7 @@ void GaussianNoiseModel::Fini()
 double GaussianNoiseModel::ApplyImpl(double _in, double _dt)
 {
   // Add independent (uncorrelated) Gaussian noise to each input value.
-  double whiteNoise = ignition::math::Rand::DblNormal(this->mean, this->stdDev);
+  double whiteNoise = this->SampleNormal(this->mean, this->stdDev);
 
   // Generate varying (correlated) bias for each input value.
   // This implementation is based on the one available in Rotors:
@@ -168,8 +173,7 @@ double GaussianNoiseModel::ApplyImpl(double _in, double _dt)
         tau / 2 * expm1(-2 * _dt / tau));
 
     const double phiD = exp(-_dt / tau);
-    this->bias = phiD * this->bias +
-      ignition::math::Rand::DblNormal(0, sigmaBD);
+    this->bias = phiD * this->bias + this->SampleNormal(0, sigmaBD);
   }
 
   double output = _in + this->bias + whiteNoise;
@@ -184,6 +188,31 @@ double GaussianNoiseModel::ApplyImpl(double _in, double _dt)
   return output;
 }
 
+//////////////////////////////////////////////////
+void GaussianNoiseModel::ApplyBatch(double *_data, const size_t _count,
+    const double _dt)
+{
+  // The dynamic bias is a random walk driven by every sample, so it is
+  // applied one value at a time. So is the noise of derived classes, which
+  // may override ApplyImpl.
+  if ((this->dynamicBiasStdDev > 0 && this->dynamicBiasCorrTime > 0) ||
+      typeid(*this) != typeid(GaussianNoiseModel))
+  {
+    for (size_t i = 0; i < _count; ++i)
+      _data[i] = this->ApplyImpl(_data[i], _dt);
+    return;
+  }
+
+  this->AddNormal(_data, _count, this->mean + this->bias, this->stdDev);
+
+  if (this->quantized &&
+      !ignition::math::equal(this->precision, 0.0, 1e-6))
+  {
+    for (size_t i = 0; i < _count; ++i)
+      _data[i] = std::round(_data[i] / this->precision) * this->precision;
+  }
+}
+
 //////////////////////////////////////////////////
 double GaussianNoiseModel::GetMean() const
 {
@@ -99,6 +99,14 @@ namespace gazebo
         /// \brief Sample the bias.
         private: void SampleBias();
 
+        /// \brief Apply noise in place to a buffer of values, for the batch
+        /// Apply.
+        /// \param[in,out] _data Values to apply noise to.
+        /// \param[in] _count Number of values.
+        /// \param[in] _dt Time elapsed since the previous batch.
+        private: void ApplyBatch(double *_data, const size_t _count,
+                     const double _dt);
+
         /// \brief If type starts with GAUSSIAN, the mean of the distribution
         /// from which we sample when adding noise.
         protected: double mean;
@@ -745,6 +745,9 @@ bool GpuRaySensor::UpdateImpl(const bool /*_force*/)
     }
   }
 
+  auto noise = this->noises.find(GPU_RAY_NOISE);
+  this->dataPtr->noiseIndices.clear();
+
   auto dataIter = this->dataPtr->laserCam->LaserDataBegin();
   auto dataEnd = this->dataPtr->laserCam->LaserDataEnd();
   for (int i = 0; dataIter != dataEnd; ++dataIter, ++i)
@@ -762,11 +765,10 @@ bool GpuRaySensor::UpdateImpl(const bool /*_force*/)
     {
       range = -ignition::math::INF_D;
     }
-    else if (this->noises.find(GPU_RAY_NOISE) != this->noises.end())
+    else if (noise != this->noises.end() && !ignition::math::isnan(range))
     {
-      range = this->noises[GPU_RAY_NOISE]->Apply(range);
-      range = ignition::math::clamp(range,
-          this->dataPtr->rangeMin, this->dataPtr->rangeMax);
+      // noise is applied to all the ranges in one batch below
+      this->dataPtr->noiseIndices.push_back(i);
     }
 
     range = ignition::math::isnan(range) ? this->dataPtr->rangeMax : range;
@@ -774,6 +776,23 @@ bool GpuRaySensor::UpdateImpl(const bool /*_force*/)
     scan->set_intensities(i, intensity);
   }
 
+  if (!this->dataPtr->noiseIndices.empty())
+  {
+    const std::vector<int> &indices = this->dataPtr->noiseIndices;
+    std::vector<double> &ranges = this->dataPtr->noiseRanges;
+    ranges.resize(indices.size());
+    for (size_t i = 0; i < indices.size(); ++i)
+      ranges[i] = scan->ranges(indices[i]);
+
+    noise->second->Apply(ranges.data(), ranges.size());
+
+    for (size_t i = 0; i < indices.size(); ++i)
+    {
+      scan->set_ranges(indices[i], ignition::math::clamp(ranges[i],
+          this->dataPtr->rangeMin, this->dataPtr->rangeMax));
+    }
+  }
+
   if (this->dataPtr->scanPub && this->dataPtr->scanPub->HasConnections())
     this->dataPtr->scanPub->Publish(this->dataPtr->laserMsg);
 
@@ -19,6 +19,7 @@
 
 #include <limits>
 #include <mutex>
+#include <vector>
 #include <sdf/sdf.hh>
 
 #include "gazebo/rendering/RenderTypes.hh"
@@ -79,6 +80,12 @@ namespace gazebo
       /// \brief Laser message to publish data.
       public: msgs::LaserScanStamped laserMsg;
 
+      /// \brief Indices of the ranges of a scan that noise is applied to.
+      public: std::vector<int> noiseIndices;
+
+      /// \brief Ranges that noise is applied to, in one batch.
+      public: std::vector<double> noiseRanges;
+
       /// \brief Parent entity of gpu ray sensor
       public: physics::EntityPtr parentEntity;
 
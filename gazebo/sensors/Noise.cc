@@ -15,16 +15,170 @@
  *
 */
 
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
 #include <boost/function.hpp>
+#include <ignition/math/Rand.hh>
+
 #include "gazebo/common/Assert.hh"
 #include "gazebo/common/Console.hh"
 
 #include "gazebo/sensors/GaussianNoiseModel.hh"
+#include "gazebo/sensors/NoisePrivate.hh"
 #include "gazebo/sensors/Noise.hh"
 
 using namespace gazebo;
 using namespace sensors;
 
+namespace
+{
+  /// \brief Number of noise models created, used to give every noise
+  /// model a different default seed.
+  std::atomic<uint32_t> g_noiseCount(0);
+
+  /// \brief Mix a value into a well distributed 64 bit value.
+  /// \param[in,out] _x State of the mixer, advanced by the call.
+  /// \return The next value.
+  uint64_t SplitMix64(uint64_t &_x)
+  {
+    uint64_t z = (_x += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+  }
+}
+
+// TODO added here for ABI compatibility
+// move to a private data pointer in Noise when merging forward.
+static std::unordered_map<const Noise *, std::unique_ptr<NoisePrivate>>
+    gNoiseData;
+
+/// \brief Mutex that protects gNoiseData.
+static std::mutex gNoiseDataMutex;
+
+//////////////////////////////////////////////////
+/// \brief Get the private data of a noise model.
+/// \param[in] _noise The noise model.
+/// \return The private data, which lives as long as the noise model.
+static NoisePrivate *noiseData(const Noise *_noise)
+{
+  std::lock_guard<std::mutex> lock(gNoiseDataMutex);
+  auto iter = gNoiseData.find(_noise);
+  GZ_ASSERT(iter != gNoiseData.end(), "Noise has no private data");
+  return iter->second.get();
+}
+
+/// \brief Noise model whose Apply is running on this thread.
+static thread_local const Noise *tApplyingNoise = nullptr;
+
+/// \brief Private data of tApplyingNoise.
+static thread_local NoisePrivate *tApplyingData = nullptr;
+
+namespace
+{
+  /// \brief Looks the private data of a noise model up once for an Apply
+  /// call, so that the samples drawn by ApplyImpl don't look it up again.
+  class ApplyScope
+  {
+    /// \brief Constructor.
+    /// \param[in] _noise The noise model being applied.
+    public: explicit ApplyScope(const Noise *_noise)
+      : prevNoise(tApplyingNoise), prevData(tApplyingData),
+        data(noiseData(_noise))
+    {
+      tApplyingNoise = _noise;
+      tApplyingData = this->data;
+    }
+
+    /// \brief Destructor. Restores the noise model of an enclosing Apply.
+    public: ~ApplyScope()
+    {
+      tApplyingNoise = this->prevNoise;
+      tApplyingData = this->prevData;
+    }
+
+    /// \brief Noise model of the enclosing Apply call.
+    private: const Noise *prevNoise;
+
+    /// \brief Private data of prevNoise.
+    private: NoisePrivate *prevData;
+
+    /// \brief Private data of the noise model being applied.
+    public: NoisePrivate *data;
+  };
+}
+
+//////////////////////////////////////////////////
+/// \brief Get the private data of a noise model, without a lookup when
+/// it is called from the Apply of that noise model.
+/// \param[in] _noise The noise model.
+/// \return The private data.
+static NoisePrivate *applyingData(const Noise *_noise)
+{
+  if (_noise == tApplyingNoise)
+    return tApplyingData;
+  return noiseData(_noise);
+}
+
+//////////////////////////////////////////////////
+void NoisePrivate::Seed(const uint32_t _seed)
+{
+  this->seed = _seed;
+  uint64_t x = _seed;
+  for (int i = 0; i < Lanes; ++i)
+  {
+    this->state0[i] = SplitMix64(x);
+    this->state1[i] = SplitMix64(x);
+  }
+  this->normalIndex = BlockSize;
+}
+
+//////////////////////////////////////////////////
+void NoisePrivate::Block(double *_out)
+{
+  // Uniform samples in (0, 1], produced by the streams side by side
+  double uniform[BlockSize];
+  for (int k = 0; k < BlockSize; k += Lanes)
+  {
+    for (int i = 0; i < Lanes; ++i)
+    {
+      uint64_t s1 = this->state0[i];
+      const uint64_t s0 = this->state1[i];
+      this->state0[i] = s0;
+      s1 ^= s1 << 23;
+      this->state1[i] = s1 ^ s0 ^ (s1 >> 18) ^ (s0 >> 5);
+      const uint64_t bits = (this->state1[i] + s0) >> 11;
+      uniform[k + i] = (static_cast<double>(bits) + 1.0) * 0x1.0p-53;
+    }
+  }
+
+  // Box-Muller transform of pairs of uniform samples
+  const int half = BlockSize / 2;
+  for (int k = 0; k < half; ++k)
+  {
+    const double r = std::sqrt(-2.0 * std::log(uniform[k]));
+    const double theta = 2.0 * M_PI * uniform[k + half];
+    _out[k] = r * std::cos(theta);
+    _out[k + half] = r * std::sin(theta);
+  }
+}
+
+//////////////////////////////////////////////////
+double NoisePrivate::Normal()
+{
+  if (this->normalIndex == BlockSize)
+  {
+    this->Block(this->normals);
+    this->normalIndex = 0;
+  }
+  return this->normals[this->normalIndex++];
+}
+
 //////////////////////////////////////////////////
 NoisePtr NoiseFactory::NewNoiseModel(sdf::ElementPtr _sdf,
     const std::string &_sensorType)
@@ -75,11 +229,18 @@ NoisePtr NoiseFactory::NewNoiseModel(sdf::ElementPtr _sdf,
 Noise::Noise(NoiseType _type)
   : type(_type)
 {
+  std::unique_ptr<NoisePrivate> data(new NoisePrivate);
+  data->Seed(ignition::math::Rand::Seed() + 0x9E3779B9u * g_noiseCount++);
+
+  std::lock_guard<std::mutex> lock(gNoiseDataMutex);
+  gNoiseData[this] = std::move(data);
 }
 
 //////////////////////////////////////////////////
 Noise::~Noise()
 {
+  std::lock_guard<std::mutex> lock(gNoiseDataMutex);
+  gNoiseData.erase(this);
 }
 
 //////////////////////////////////////////////////
@@ -115,7 +276,49 @@ double Noise::Apply(double _in, double _dt)
     }
   }
   else
+  {
+    ApplyScope scope(this);
     return this->ApplyImpl(_in, _dt);
+  }
+}
+
+//////////////////////////////////////////////////
+void Noise::Apply(double *_data, const size_t _count, const double _dt)
+{
+  if (this->type == NONE)
+    return;
+  else if (this->type == CUSTOM)
+  {
+    if (this->customNoiseCallbackTime)
+    {
+      for (size_t i = 0; i < _count; ++i)
+        _data[i] = this->customNoiseCallbackTime(_data[i], _dt);
+    }
+    else if (this->customNoiseCallback)
+    {
+      for (size_t i = 0; i < _count; ++i)
+        _data[i] = this->customNoiseCallback(_data[i]);
+    }
+    else
+    {
+      gzerr << "Custom noise callback function not set!"
+          << " Please call SetCustomNoiseCallback within a sensor plugin."
+          << std::endl;
+    }
+  }
+  else
+  {
+    ApplyScope scope(this);
+    if (scope.data->applyBatch)
+    {
+      scope.data->applyBatch(_data, _count, _dt);
+    }
+    else
+    {
+      for (size_t i = 0; i < _count; ++i)
+        _data[i] = this->ApplyImpl(_data[i], _dt);
+    }
+  }
 }
 
 //////////////////////////////////////////////////
@@ -124,6 +327,59 @@ double Noise::ApplyImpl(double _in, double /*_dt*/)
   return _in;
 }
 
+//////////////////////////////////////////////////
+void Noise::SetSeed(const uint32_t _seed)
+{
+  noiseData(this)->Seed(_seed);
+}
+
+//////////////////////////////////////////////////
+uint32_t Noise::Seed() const
+{
+  return noiseData(this)->seed;
+}
+
+//////////////////////////////////////////////////
+double Noise::SampleNormal(const double _mean, const double _stdDev)
+{
+  return _mean + _stdDev * applyingData(this)->Normal();
+}
+
+//////////////////////////////////////////////////
+void Noise::AddNormal(double *_data, const size_t _count,
+    const double _mean, const double _stdDev)
+{
+  // Scalar and batch draws take their samples from the same blocks, so
+  // they follow the same sequence
+  NoisePrivate &rng = *applyingData(this);
+  size_t i = 0;
+  while (i < _count)
+  {
+    if (rng.normalIndex == NoisePrivate::BlockSize)
+    {
+      rng.Block(rng.normals);
+      rng.normalIndex = 0;
+    }
+
+    const size_t n = std::min(_count - i,
+        static_cast<size_t>(NoisePrivate::BlockSize - rng.normalIndex));
+    const double *normals = rng.normals + rng.normalIndex;
+    for (size_t k = 0; k < n; ++k)
+      _data[i + k] += _mean + _stdDev * normals[k];
+
+    rng.normalIndex += static_cast<int>(n);
+    i += n;
+  }
+}
+
+//////////////////////////////////////////////////
+void Noise::SetApplyBatch(
+    const std::function<void(double *, const size_t, const double)>
+    &_applyBatch)
+{
+  noiseData(this)->applyBatch = _applyBatch;
+}
+
 //////////////////////////////////////////////////
 Noise::NoiseType Noise::GetNoiseType() const
 {
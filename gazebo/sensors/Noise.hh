@@ -18,6 +18,9 @@
 #ifndef _GAZEBO_NOISE_HH_
 #define _GAZEBO_NOISE_HH_
 
+#include <cstddef>
+#include <cstdint>
+#include <functional>
 #include <vector>
 #include <string>
 
@@ -82,12 +85,33 @@ namespace gazebo
       /// \return Data with noise applied.
       public: double Apply(double _in, double _dt = 0.0);
 
+      /// \brief Apply noise in place to a contiguous buffer of values, such
+      /// as the ranges of a scan. This gives the same distribution as
+      /// calling Apply on every value, without the per value overhead.
+      /// \param[in,out] _data Values to apply noise to.
+      /// \param[in] _count Number of values.
+      /// \param[in] _dt Time elapsed since the previous batch.
+      public: void Apply(double *_data, const size_t _count,
+                  const double _dt = 0.0);
+
       /// \brief Apply noise to input data value. This gets overriden by
       /// derived classes, and called by Apply.
       /// \param[in] _in Input data value.
       /// \return Data with noise applied.
       public: virtual double ApplyImpl(double _in, double _dt = 0.0);
 
+      /// \brief Set the seed of the random number generator of this noise
+      /// model. Every noise model has its own generator, seeded by default
+      /// from ignition::math::Rand::Seed() and the order in which the noise
+      /// models were created, so runs with the same seed are repeatable.
+      /// \param[in] _seed The seed.
+      public: void SetSeed(const uint32_t _seed);
+
+      /// \brief Get the seed of the random number generator of this noise
+      /// model.
+      /// \return The seed.
+      public: uint32_t Seed() const;
+
       /// \brief Finalize the noise model
       public: virtual void Fini();
 
@@ -123,6 +147,31 @@ namespace gazebo
       /// \param[in] _out Output stream
       public: virtual void Print(std::ostream &_out) const;
 
+      /// \brief Draw a sample from a normal distribution with the
+      /// generator of this noise model.
+      /// \param[in] _mean Mean of the distribution.
+      /// \param[in] _stdDev Standard deviation of the distribution.
+      /// \return The sample.
+      protected: double SampleNormal(const double _mean, const double _stdDev);
+
+      /// \brief Add samples of a normal distribution, drawn with the
+      /// generator of this noise model, to a buffer of values.
+      /// \param[in,out] _data Values to add the samples to.
+      /// \param[in] _count Number of values.
+      /// \param[in] _mean Mean of the distribution.
+      /// \param[in] _stdDev Standard deviation of the distribution.
+      protected: void AddNormal(double *_data, const size_t _count,
+                     const double _mean, const double _stdDev);
+
+      /// \brief Set the function the batch Apply calls instead of calling
+      /// ApplyImpl on every value. Derived classes set it in their
+      /// constructor when they can apply noise to a buffer faster.
+      /// \param[in] _applyBatch Applies noise in place to _count values,
+      /// with the time elapsed since the previous batch.
+      protected: void SetApplyBatch(
+                     const std::function<void(double *, const size_t,
+                     const double)> &_applyBatch);
+
       /// \brief Which type of noise we're applying
       private: NoiseType type;
 
@@ -0,0 +1,79 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#ifndef _GAZEBO_SENSORS_NOISE_PRIVATE_HH_
+#define _GAZEBO_SENSORS_NOISE_PRIVATE_HH_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+namespace gazebo
+{
+  namespace sensors
+  {
+    /// \internal
+    /// \brief Noise private data: the random number generator of a noise
+    /// model, and the batch implementation of its derived class.
+    ///
+    /// The generator runs Lanes independent xorshift128+ streams side by
+    /// side, so a block of uniform samples is produced with vector
+    /// instructions, and turns pairs of them into normal samples with the
+    /// Box-Muller transform.
+    class NoisePrivate
+    {
+      /// \brief Number of independent streams.
+      public: static const int Lanes = 4;
+
+      /// \brief Number of normal samples produced per block.
+      public: static const int BlockSize = 64;
+
+      /// \brief Seed the generator was last seeded with.
+      public: uint32_t seed = 0;
+
+      /// \brief State of the streams, in structure of arrays layout.
+      public: uint64_t state0[Lanes];
+
+      /// \brief State of the streams, in structure of arrays layout.
+      public: uint64_t state1[Lanes];
+
+      /// \brief Normal samples generated ahead for scalar draws.
+      public: double normals[BlockSize];
+
+      /// \brief Index of the next sample of normals to draw, BlockSize
+      /// once they are all drawn.
+      public: int normalIndex = BlockSize;
+
+      /// \brief Applies noise to a buffer in place of ApplyImpl, set by
+      /// the derived class.
+      public: std::function<void(double *, const size_t, const double)>
+              applyBatch;
+
+      /// \brief Set the seed of the generator and reset its state.
+      /// \param[in] _seed The seed.
+      public: void Seed(const uint32_t _seed);
+
+      /// \brief Fill a buffer with standard normal samples.
+      /// \param[out] _out Buffer of BlockSize samples.
+      public: void Block(double *_out);
+
+      /// \brief Draw one standard normal sample.
+      /// \return The sample.
+      public: double Normal();
+    };
+  }
+}
+#endif
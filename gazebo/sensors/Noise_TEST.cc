@@ -373,6 +373,119 @@ TEST_F(NoiseTest, OnApplyNoise)
   }
 }
 
+//////////////////////////////////////////////////
+TEST_F(NoiseTest, ApplyBatch)
+{
+  const size_t count = 1000;
+
+  // NONE leaves the values untouched
+  {
+    sensors::NoisePtr noise = sensors::NoiseFactory::NewNoiseModel(
+        NoiseSdf("none", 0, 0, 0, 0, 0));
+    std::vector<double> data(count, 42.0);
+    noise->Apply(data.data(), data.size());
+    for (auto const &value : data)
+      EXPECT_DOUBLE_EQ(value, 42.0);
+  }
+
+  // GAUSSIAN, compare the sample mean and variance like GaussianNoise
+  {
+    sensors::NoisePtr noise = sensors::NoiseFactory::NewNoiseModel(
+        NoiseSdf("gaussian", 10.0, 5.0, 100.0, 0, 0));
+    sensors::GaussianNoiseModelPtr noiseModel =
+        std::dynamic_pointer_cast<sensors::GaussianNoiseModel>(noise);
+    ASSERT_TRUE(noiseModel != nullptr);
+
+    std::vector<double> data(count, 42.0);
+    noise->Apply(data.data(), data.size());
+
+    boost::accumulators::accumulator_set<double,
+      boost::accumulators::stats<boost::accumulators::tag::mean,
+                                 boost::accumulators::tag::variance > > acc;
+    for (auto const &value : data)
+      acc(value);
+
+    double mean = noiseModel->GetMean() + noiseModel->GetBias();
+    double stddev = noiseModel->GetStdDev();
+    EXPECT_NEAR(boost::accumulators::mean(acc), 42.0 + mean,
+        g_sigma * stddev / sqrt(count));
+    double variance = stddev * stddev;
+    double sampleVariance2 = 2 * variance * variance / (count - 1);
+    EXPECT_NEAR(boost::accumulators::variance(acc),
+        variance, g_sigma * sqrt(sampleVariance2));
+  }
+
+  // GAUSSIAN_QUANTIZED rounds every value to the precision
+  {
+    sensors::NoisePtr noise = sensors::NoiseFactory::NewNoiseModel(
+        NoiseSdf("gaussian_quantized", 0, 0, 0, 0, 0.3));
+    std::vector<double> data = {0.32, 0.28, -12.92, -12.88};
+    noise->Apply(data.data(), data.size());
+    EXPECT_NEAR(data[0], 0.3, 1e-6);
+    EXPECT_NEAR(data[1], 0.3, 1e-6);
+    EXPECT_NEAR(data[2], -12.9, 1e-6);
+    EXPECT_NEAR(data[3], -12.9, 1e-6);
+  }
+
+  // CUSTOM calls the callback for every value
+  {
+    sensors::NoisePtr noise(new sensors::Noise(sensors::Noise::CUSTOM));
+    noise->SetCustomNoiseCallback(boost::bind(&OnApplyCustomNoise, _1));
+    std::vector<double> data = {1.0, 2.0, 3.0};
+    noise->Apply(data.data(), data.size());
+    EXPECT_DOUBLE_EQ(data[0], 2.0);
+    EXPECT_DOUBLE_EQ(data[1], 4.0);
+    EXPECT_DOUBLE_EQ(data[2], 6.0);
+  }
+}
+
+/// \brief Gaussian noise model that triples its input.
+class TripleNoiseModel : public sensors::GaussianNoiseModel
+{
+  // Documentation inherited.
+  public: double ApplyImpl(double _in, double /*_dt*/)
+  {
+    return _in * 3;
+  }
+};
+
+//////////////////////////////////////////////////
+TEST_F(NoiseTest, ApplyBatchDerived)
+{
+  // The batch Apply calls the ApplyImpl of classes derived from the
+  // Gaussian model
+  sensors::NoisePtr noise(new TripleNoiseModel);
+  std::vector<double> data = {1.0, 2.0, 3.0};
+  noise->Apply(data.data(), data.size());
+  EXPECT_DOUBLE_EQ(data[0], 3.0);
+  EXPECT_DOUBLE_EQ(data[1], 6.0);
+  EXPECT_DOUBLE_EQ(data[2], 9.0);
+}
+
+//////////////////////////////////////////////////
+TEST_F(NoiseTest, Seed)
+{
+  sensors::NoisePtr noise1 = sensors::NoiseFactory::NewNoiseModel(
+      NoiseSdf("gaussian", 0, 1.0, 0, 0, 0));
+  sensors::NoisePtr noise2 = sensors::NoiseFactory::NewNoiseModel(
+      NoiseSdf("gaussian", 0, 1.0, 0, 0, 0));
+
+  // Noise models get different default seeds
+  EXPECT_NE(noise1->Seed(), noise2->Seed());
+
+  // The same seed gives the same samples, whether they are drawn one at a
+  // time or in a batch
+  noise1->SetSeed(1234);
+  noise2->SetSeed(1234);
+  EXPECT_EQ(noise1->Seed(), 1234u);
+
+  std::vector<double> batch(200, 0.0);
+  noise2->Apply(batch.data(), 10);
+  noise2->Apply(batch.data() + 10, batch.size() - 10);
+  for (size_t i = 0; i < batch.size(); ++i)
+    EXPECT_DOUBLE_EQ(noise1->Apply(0.0), batch[i]) << i;
+}
+
 /////////////////////////////////////////////////
 int main(int argc, char **argv)
 {
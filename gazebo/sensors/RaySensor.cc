@@ -417,6 +417,10 @@ bool RaySensor::UpdateImpl(const bool /*_force*/)
   bool interp =
     ((rayCount != rangeCount) || (verticalRayCount != verticalRangeCount));
 
+  // currently supports only one noise model per laser sensor
+  auto noise = this->noises.find(RAY_NOISE);
+  this->dataPtr->noiseIndices.clear();
+
   // interpolate in vertical direction
   for (unsigned int j = 0; j < verticalRangeCount; ++j)
   {
@@ -487,19 +491,33 @@ bool RaySensor::UpdateImpl(const bool /*_force*/)
       {
         range = -ignition::math::INF_D;
       }
-      else if (this->noises.find(RAY_NOISE) !=
-               this->noises.end())
+      else if (noise != this->noises.end())
       {
-        // currently supports only one noise model per laser sensor
-        range = this->noises[RAY_NOISE]->Apply(range);
-        range = ignition::math::clamp(range,
-            this->RangeMin(), this->RangeMax());
+        // noise is applied to all the ranges in one batch below
+        this->dataPtr->noiseIndices.push_back(scan->ranges_size());
       }
 
       scan->add_ranges(range);
       scan->add_intensities(intensity);
     }
   }
+
+  if (!this->dataPtr->noiseIndices.empty())
+  {
+    const std::vector<int> &indices = this->dataPtr->noiseIndices;
+    std::vector<double> &ranges = this->dataPtr->noiseRanges;
+    ranges.resize(indices.size());
+    for (size_t i = 0; i < indices.size(); ++i)
+      ranges[i] = scan->ranges(indices[i]);
+
+    noise->second->Apply(ranges.data(), ranges.size());
+
+    for (size_t i = 0; i < indices.size(); ++i)
+    {
+      scan->set_ranges(indices[i], ignition::math::clamp(ranges[i],
+          this->RangeMin(), this->RangeMax()));
+    }
+  }
   IGN_PROFILE_END();
 
   IGN_PROFILE_BEGIN("Publish");
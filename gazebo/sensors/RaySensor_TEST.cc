@@ -16,6 +16,7 @@
 */
 
 #include <gtest/gtest.h>
+#include <cmath>
 #include <ignition/math/Helpers.hh>
 #include <sdf/sdf.hh>
 #include "gazebo/test/ServerFixture.hh"
@@ -199,6 +200,57 @@ TEST_F(RaySensor_TEST, LaserScanResolution)
 }
 
 /////////////////////////////////////////////////
+/////////////////////////////////////////////////
+/// \brief Test that batched ray queries measure the same ranges as the
+/// rays of the physics engine
+TEST_F(RaySensor_TEST, BatchedRays)
+{
+  Load("worlds/empty.world", true);
+  physics::WorldPtr world = physics::get_world("default");
+  ASSERT_TRUE(world != nullptr);
+
+  SpawnBox("box", ignition::math::Vector3d::One,
+      ignition::math::Vector3d(2, 0, 0.5), ignition::math::Vector3d::Zero,
+      true);
+  SpawnSphere("sphere", ignition::math::Vector3d(0, 3, 0.5),
+      ignition::math::Vector3d::Zero, true, true);
+  SpawnCylinder("cylinder", ignition::math::Vector3d(-2.5, -1, 0.5),
+      ignition::math::Vector3d::Zero, true);
+
+  // A full circle of rays, tilted down so some of them hit the ground
+  SpawnRaySensor("ray_model", "ray_sensor",
+      ignition::math::Vector3d(0, 0, 0.5), ignition::math::Vector3d::Zero,
+      -IGN_PI, IGN_PI, -0.3, 0.0, 0.08, 10.0, 0.01, 180, 4);
+
+  sensors::RaySensorPtr sensor = std::dynamic_pointer_cast<
+      sensors::RaySensor>(sensors::get_sensor("ray_sensor"));
+  ASSERT_TRUE(sensor != nullptr);
+
+  sensor->Update(true);
+  std::vector<double> perRay;
+  sensor->Ranges(perRay);
+
+  EXPECT_TRUE(world->Physics()->SetParam("batch_ray_queries", true));
+  sensor->Update(true);
+  std::vector<double> batched;
+  sensor->Ranges(batched);
+  EXPECT_TRUE(world->Physics()->SetParam("batch_ray_queries", false));
+
+  ASSERT_EQ(perRay.size(), batched.size());
+  unsigned int hits = 0;
+  for (unsigned int i = 0; i < perRay.size(); ++i)
+  {
+    if (std::isinf(perRay[i]))
+    {
+      EXPECT_TRUE(std::isinf(batched[i])) << i;
+      continue;
+    }
+    ++hits;
+    EXPECT_NEAR(perRay[i], batched[i], 1e-3) << i;
+  }
+  EXPECT_GT(hits, 0u);
+}
+
 int main(int argc, char **argv)
 {
   ::testing::InitGoogleTest(&argc, argv);
@@ -15,7 +15,17 @@
  *
 */
 
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <tbb/task_arena.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
 #include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
 #include <boost/bind.hpp>
 
 #include "gazebo/physics/Link.hh"
@@ -86,6 +96,101 @@ common::Time lastSimTime;
 /// \brief Last real time measured for performance metrics
 common::Time lastRealTime;
 
+namespace gazebo
+{
+  namespace sensors
+  {
+    /// \internal
+    /// \brief SensorContainer private data: the schedule of a container
+    /// of non-rendering sensors.
+    class SensorContainerPrivate
+    {
+      /// \brief Scheduling state of a sensor.
+      public: class State
+              {
+                /// \brief Simulation time at which the next update is due.
+                public: common::Time due;
+
+                /// \brief Measurement time of the sensor after its last
+                /// update.
+                public: common::Time lastMeasurement;
+
+                /// \brief Update statistics.
+                public: SensorUpdateStats stats;
+              };
+
+      /// \brief An entry of the queue.
+      public: class Entry
+              {
+                /// \brief Simulation time at which the sensor is due.
+                public: common::Time due;
+
+                /// \brief The sensor.
+                public: Sensor *sensor;
+
+                /// \brief Order entries so the earliest due is on top of a
+                /// heap.
+                /// \param[in] _other Entry to compare with.
+                /// \return True if this entry is due after _other.
+                public: bool operator<(const Entry &_other) const
+                        {
+                          return this->due > _other.due;
+                        }
+              };
+
+      /// \brief True if the sensors are scheduled.
+      public: bool scheduled = false;
+
+      /// \brief True when sensors were added or removed, or their update
+      /// times were reset, since the last update.
+      public: bool sensorsChanged = true;
+
+      /// \brief Heap of sensors, earliest due on top.
+      public: std::vector<Entry> queue;
+
+      /// \brief Scheduling state of each sensor.
+      public: std::unordered_map<const Sensor *, State> states;
+
+      /// \brief Sensors dispatched by the current pass.
+      public: std::vector<Entry> due;
+
+      /// \brief Number of threads that update the due sensors.
+      public: unsigned int threads = 1;
+
+      /// \brief Arena of the worker threads, null when threads is 1.
+      public: std::unique_ptr<tbb::task_arena> arena;
+    };
+  }
+}
+
+// TODO added here for ABI compatibility
+// move to a private data pointer in SensorContainer when merging forward.
+// The containers are private to SensorManager, so they are keyed by
+// address.
+static std::unordered_map<const void *,
+    std::unique_ptr<SensorContainerPrivate>> g_sensorContainerData;
+
+/// \brief Mutex that protects g_sensorContainerData.
+static std::mutex g_sensorContainerDataMutex;
+
+/// \brief Number of threads that update the due sensors of a scheduled
+/// container. Added here for ABI compatibility, SensorManager is a
+/// singleton.
+static std::atomic<unsigned int> g_sensorWorkerThreads(1);
+
+//////////////////////////////////////////////////
+/// \brief Get the private data of a sensor container.
+/// \param[in] _container The sensor container.
+/// \return The private data, which lives as long as the container.
+static SensorContainerPrivate *sensorContainerData(const void *_container)
+{
+  std::lock_guard<std::mutex> lock(g_sensorContainerDataMutex);
+  auto iter = g_sensorContainerData.find(_container);
+  GZ_ASSERT(iter != g_sensorContainerData.end(),
+      "SensorContainer has no private data");
+  return iter->second.get();
+}
+
 //////////////////////////////////////////////////
 SensorManager::SensorManager()
   : initialized(false), removeAllSensors(false)
@@ -95,9 +200,21 @@ SensorManager::SensorManager()
 
   // sensors::RAY container
   this->sensorContainers.push_back(new SensorContainer());
+  this->sensorContainers.back()->EnableScheduling();
 
   // sensors::OTHER container
   this->sensorContainers.push_back(new SensorContainer());
+  this->sensorContainers.back()->EnableScheduling();
+
+  const char *env = std::getenv("GAZEBO_SENSOR_THREADS");
+  if (env)
+  {
+    const int threads = std::atoi(env);
+    if (threads > 0)
+      this->SetWorkerThreads(threads);
+    else
+      gzwarn << "Ignoring invalid GAZEBO_SENSOR_THREADS[" << env << "]\n";
+  }
 }
 
 //////////////////////////////////////////////////
@@ -390,6 +507,38 @@ void SensorManager::ResetLastUpdateTimes()
   }
 }
 
+//////////////////////////////////////////////////
+bool SensorManager::UpdateStats(const std::string &_name,
+    SensorUpdateStats &_stats) const
+{
+  SensorPtr sensor = this->GetSensor(_name);
+  if (!sensor || sensor->Category() < 0 ||
+      sensor->Category() >= CATEGORY_COUNT)
+  {
+    return false;
+  }
+
+  boost::recursive_mutex::scoped_lock lock(this->mutex);
+  return this->sensorContainers[sensor->Category()]->UpdateStats(
+      sensor.get(), _stats);
+}
+
+//////////////////////////////////////////////////
+void SensorManager::SetWorkerThreads(const unsigned int _threads)
+{
+  boost::recursive_mutex::scoped_lock lock(this->mutex);
+  g_sensorWorkerThreads = std::max(1u, _threads);
+
+  for (auto &container : this->sensorContainers)
+    container->SetWorkerThreads(g_sensorWorkerThreads);
+}
+
+//////////////////////////////////////////////////
+unsigned int SensorManager::WorkerThreads() const
+{
+  return g_sensorWorkerThreads;
+}
+
 //////////////////////////////////////////////////
 double SensorManager::NextRequiredTimestamp()
 {
@@ -641,12 +790,18 @@ SensorManager::SensorContainer::SensorContainer()
   this->stop = true;
   this->initialized = false;
   this->runThread = nullptr;
+
+  std::lock_guard<std::mutex> lock(g_sensorContainerDataMutex);
+  g_sensorContainerData[this].reset(new SensorContainerPrivate);
 }
 
 //////////////////////////////////////////////////
 SensorManager::SensorContainer::~SensorContainer()
 {
   this->sensors.clear();
+
+  std::lock_guard<std::mutex> lock(g_sensorContainerDataMutex);
+  g_sensorContainerData.erase(this);
 }
 
 //////////////////////////////////////////////////
@@ -811,6 +966,15 @@ void SensorManager::SensorContainer::RunLoop()
     // Set the default sleep time
     eventTime = std::max(common::Time::Zero, sleepTime - diffTime);
 
+    // Sleep until the next sensor is due, if the container knows when
+    common::Time nextDue;
+    if (this->NextDueTime(nextDue))
+    {
+      common::Time simTime = world->SimTime();
+      if (nextDue > simTime)
+        eventTime = nextDue - simTime;
+    }
+
     // Make sure update time is reasonable.
     // During log playback, time can jump forward an arbitrary amount.
     if (diffTime.sec >= maxSensorUpdate && !util::LogPlay::Instance()->IsOpen())
@@ -848,6 +1012,14 @@ void SensorManager::SensorContainer::RunLoop()
 //////////////////////////////////////////////////
 void SensorManager::SensorContainer::Update(bool _force)
 {
+  // A forced update visits every sensor, and the next pass reschedules
+  // the ones that were not due.
+  if (!_force && sensorContainerData(this)->scheduled)
+  {
+    this->UpdateScheduled();
+    return;
+  }
+
   boost::recursive_mutex::scoped_lock lock(this->mutex);
 
   PublishPerformanceMetrics();
@@ -901,6 +1073,7 @@ void SensorManager::SensorContainer::AddSensor(SensorPtr _sensor)
   {
     boost::recursive_mutex::scoped_lock lock(this->mutex);
     this->sensors.push_back(_sensor);
+    sensorContainerData(this)->sensorsChanged = true;
     g_sensorsDirty = true;
   }
 
@@ -911,27 +1084,36 @@ void SensorManager::SensorContainer::AddSensor(SensorPtr _sensor)
 //////////////////////////////////////////////////
 bool SensorManager::SensorContainer::RemoveSensor(const std::string &_name)
 {
-  boost::recursive_mutex::scoped_lock lock(this->mutex);
-
-  Sensor_V::iterator iter;
-
   bool removed = false;
 
-  // Find the correct sensor based on name, and remove it.
-  for (iter = this->sensors.begin(); iter != this->sensors.end(); ++iter)
   {
-    GZ_ASSERT((*iter) != nullptr, "Sensor is null");
+    boost::recursive_mutex::scoped_lock lock(this->mutex);
+
+    Sensor_V::iterator iter;
 
-    if ((*iter)->ScopedName() == _name)
+    // Find the correct sensor based on name, and remove it.
+    for (iter = this->sensors.begin(); iter != this->sensors.end(); ++iter)
     {
-      (*iter)->Fini();
-      this->sensors.erase(iter);
-      removed = true;
-      break;
+      GZ_ASSERT((*iter) != nullptr, "Sensor is null");
+
+      if ((*iter)->ScopedName() == _name)
+      {
+        (*iter)->Fini();
+        this->sensors.erase(iter);
+        removed = true;
+        break;
+      }
     }
+
+    // The schedule is rebuilt from the sensors under the same lock
+    if (removed)
+      sensorContainerData(this)->sensorsChanged = true;
+    g_sensorsDirty = true;
   }
 
-  g_sensorsDirty = true;
+  // The run loop may be sleeping until the removed sensor is due
+  if (removed)
+    this->runCondition.notify_one();
 
   return removed;
 }
@@ -949,6 +1131,7 @@ void SensorManager::SensorContainer::ResetLastUpdateTimes()
     GZ_ASSERT((*iter) != nullptr, "Sensor is null");
     (*iter)->ResetLastUpdateTime();
   }
+  sensorContainerData(this)->sensorsChanged = true;
 
   // Tell the run loop that world time has been reset.
   this->runCondition.notify_one();
@@ -968,6 +1151,7 @@ void SensorManager::SensorContainer::RemoveSensors()
     (*iter)->Fini();
   }
 
+  sensorContainerData(this)->sensorsChanged = true;
   g_sensorsDirty = true;
 
   this->sensors.clear();
@@ -1005,6 +1189,207 @@ bool SensorManager::ImageSensorContainer::WaitForPrerendered(double _timeoutsec)
   return (ret == std::cv_status::no_timeout);
 }
 
+//////////////////////////////////////////////////
+/// \brief Get the update period of a sensor.
+/// \param[in] _sensor The sensor.
+/// \return The period, zero if the sensor updates as often as it can.
+static common::Time SensorPeriod(const Sensor *_sensor)
+{
+  const double rate = _sensor->UpdateRate();
+  return rate > 0 ? common::Time(1.0 / rate) : common::Time::Zero;
+}
+
+//////////////////////////////////////////////////
+void SensorManager::SensorContainer::EnableScheduling()
+{
+  boost::recursive_mutex::scoped_lock lock(this->mutex);
+  SensorContainerPrivate *data = sensorContainerData(this);
+  data->scheduled = true;
+  data->sensorsChanged = true;
+}
+
+//////////////////////////////////////////////////
+void SensorManager::SensorContainer::SetWorkerThreads(
+    const unsigned int _threads)
+{
+  boost::recursive_mutex::scoped_lock lock(this->mutex);
+  SensorContainerPrivate *data = sensorContainerData(this);
+
+  if (!data->scheduled || _threads == data->threads)
+    return;
+
+  data->threads = _threads;
+  data->arena.reset();
+  if (_threads > 1)
+    data->arena.reset(new tbb::task_arena(_threads));
+}
+
+//////////////////////////////////////////////////
+void SensorManager::SensorContainer::UpdateScheduled()
+{
+  boost::recursive_mutex::scoped_lock lock(this->mutex);
+  SensorContainerPrivate *data = sensorContainerData(this);
+
+  PublishPerformanceMetrics();
+
+  if (this->sensors.empty())
+  {
+    gzlog << "Updating a sensor container without any sensors.\n";
+    return;
+  }
+
+  physics::WorldPtr world = physics::get_world();
+  GZ_ASSERT(world != nullptr, "Pointer to World is null");
+  const common::Time now = world->SimTime();
+
+  auto &queue = data->queue;
+  auto &states = data->states;
+
+  // Rebuild the queue after sensors were added or removed. Sensors keep
+  // their due time, unless the world was reset and it is now too far
+  // ahead, and new sensors are due now.
+  if (data->sensorsChanged)
+  {
+    std::unordered_map<const Sensor *, SensorContainerPrivate::State>
+      previous;
+    previous.swap(states);
+    queue.clear();
+
+    for (auto &sensor : this->sensors)
+    {
+      GZ_ASSERT(sensor != nullptr, "Sensor is null");
+
+      auto &state = states[sensor.get()];
+      state.due = now;
+      state.lastMeasurement = sensor->LastMeasurementTime();
+
+      auto iter = previous.find(sensor.get());
+      if (iter != previous.end())
+      {
+        state.stats = iter->second.stats;
+        if (iter->second.due <= now + SensorPeriod(sensor.get()))
+          state.due = iter->second.due;
+      }
+      queue.push_back({state.due, sensor.get()});
+    }
+    std::make_heap(queue.begin(), queue.end());
+
+    data->sensorsChanged = false;
+  }
+
+  // Take the due sensors off the queue
+  auto &due = data->due;
+  due.clear();
+  while (!queue.empty() && queue.front().due <= now)
+  {
+    std::pop_heap(queue.begin(), queue.end());
+    due.push_back(queue.back());
+    queue.pop_back();
+  }
+
+  if (data->arena && due.size() > 1)
+  {
+    physics::PhysicsEnginePtr engine = world->Physics();
+    data->arena->execute([&]
+    {
+      tbb::parallel_for(tbb::blocked_range<size_t>(0, due.size(), 1),
+          [&](const tbb::blocked_range<size_t> &_range)
+      {
+        // Ray sensors use the collision engine, which keeps data per
+        // thread.
+        static thread_local bool threadInitialized = false;
+        if (!threadInitialized)
+        {
+          engine->InitForThread();
+          threadInitialized = true;
+        }
+
+        for (size_t i = _range.begin(); i != _range.end(); ++i)
+          due[i].sensor->Update(false);
+      });
+    });
+  }
+  else
+  {
+    for (auto &entry : due)
+    {
+      IGN_PROFILE_BEGIN(entry.sensor->Name().c_str());
+      entry.sensor->Update(false);
+      IGN_PROFILE_END();
+    }
+  }
+
+  // Record the updates, and schedule the sensors again
+  for (auto &entry : due)
+  {
+    Sensor *sensor = entry.sensor;
+    auto &state = states[sensor];
+    const common::Time period = SensorPeriod(sensor);
+
+    const common::Time measurement = sensor->LastMeasurementTime();
+    const bool updated = measurement != state.lastMeasurement;
+    if (updated)
+    {
+      SensorUpdateStats &stats = state.stats;
+      if (stats.updateCount > 0 && measurement > state.lastMeasurement)
+      {
+        const double rate =
+          1.0 / (measurement - state.lastMeasurement).Double();
+        stats.rate = ignition::math::equal(stats.rate, 0.0) ?
+          rate : 0.9 * stats.rate + 0.1 * rate;
+      }
+      stats.lateness = now - entry.due;
+      stats.maxLateness = std::max(stats.maxLateness, stats.lateness);
+      ++stats.updateCount;
+      state.lastMeasurement = measurement;
+    }
+
+    // Strict rate sensors decide themselves when to update, so they are
+    // visited on every pass, like sensors without an update rate. Other
+    // sensors keep their cadence, unless they fell a full period behind.
+    common::Time next = now;
+    if (!sensor->StrictRate() && period > common::Time::Zero)
+    {
+      next = (updated ? entry.due : sensor->LastUpdateTime()) + period;
+      if (next <= now)
+        next = now + period;
+    }
+
+    state.due = next;
+    queue.push_back({next, sensor});
+    std::push_heap(queue.begin(), queue.end());
+  }
+}
+
+//////////////////////////////////////////////////
+bool SensorManager::SensorContainer::NextDueTime(
+    common::Time &_time) const
+{
+  boost::recursive_mutex::scoped_lock lock(this->mutex);
+  SensorContainerPrivate *data = sensorContainerData(this);
+
+  if (!data->scheduled || data->sensorsChanged || data->queue.empty())
+    return false;
+
+  _time = data->queue.front().due;
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool SensorManager::SensorContainer::UpdateStats(
+    const Sensor *_sensor, SensorUpdateStats &_stats) const
+{
+  boost::recursive_mutex::scoped_lock lock(this->mutex);
+  SensorContainerPrivate *data = sensorContainerData(this);
+
+  auto iter = data->states.find(_sensor);
+  if (iter == data->states.end())
+    return false;
+
+  _stats = iter->second.stats;
+  return true;
+}
+
 /////////////////////////////////////////////////
 SimTimeEventHandler::SimTimeEventHandler()
 {
@@ -88,6 +88,26 @@ namespace gazebo
 
     /// \addtogroup gazebo_sensors
     /// \{
+
+    /// \class SensorUpdateStats SensorManager.hh sensors/sensors.hh
+    /// \brief Update statistics of a non-rendering sensor, as measured by
+    /// the SensorManager scheduler. Times are simulation times.
+    class GZ_SENSORS_VISIBLE SensorUpdateStats
+    {
+      /// \brief Time between when the last update of the sensor was due
+      /// and when it was dispatched.
+      public: common::Time lateness;
+
+      /// \brief Largest lateness since the sensor was added.
+      public: common::Time maxLateness;
+
+      /// \brief Achieved update rate in Hz, averaged over recent updates.
+      public: double rate = 0;
+
+      /// \brief Number of updates that produced a measurement.
+      public: uint64_t updateCount = 0;
+    };
+
     /// \class SensorManager SensorManager.hh sensors/sensors.hh
     /// \brief Class to manage and update all sensors
     class GZ_SENSORS_VISIBLE SensorManager : public SingletonT<SensorManager>
@@ -179,6 +199,29 @@ namespace gazebo
       /// \brief Reset last update times in all sensors.
       public: void ResetLastUpdateTimes();
 
+      /// \brief Get the update statistics of a non-rendering sensor.
+      /// \param[in] _name Scoped or leaf name of the sensor.
+      /// \param[out] _stats The statistics of the sensor.
+      /// \return False if the sensor does not exist or is a rendering
+      /// sensor, which are updated in lockstep with the world.
+      public: bool UpdateStats(const std::string &_name,
+                               SensorUpdateStats &_stats) const;
+
+      /// \brief Set the number of threads that update the due non-rendering
+      /// sensors of a container in parallel. The default is read from the
+      /// GAZEBO_SENSOR_THREADS environment variable, and is 1, which
+      /// updates them in the container thread.
+      ///
+      /// Sensor update callbacks may then run concurrently, and must not
+      /// look up or remove sensors through the SensorManager.
+      /// \param[in] _threads Number of threads, 0 is the same as 1.
+      public: void SetWorkerThreads(const unsigned int _threads);
+
+      /// \brief Get the number of threads that update the due
+      /// non-rendering sensors of a container.
+      /// \return Number of threads.
+      public: unsigned int WorkerThreads() const;
+
       /// \brief Block until all sensors do not need current world tick
       /// \param[in] _clk simulated clock of the world
       /// \param[in] _dt world time step
@@ -251,6 +294,38 @@ namespace gazebo
                  /// \brief Reset last update times in all sensors.
                  public: void ResetLastUpdateTimes();
 
+                 /// \brief Keep the sensors in a queue ordered by the
+                 /// simulation time of their next update, so each pass of
+                 /// Update only visits the due sensors and the run loop
+                 /// sleeps until the next one is due. Used for the
+                 /// non-rendering sensors.
+                 public: void EnableScheduling();
+
+                 /// \brief Set the number of threads that update the due
+                 /// sensors of a scheduled container.
+                 /// \param[in] _threads Number of threads.
+                 public: void SetWorkerThreads(const unsigned int _threads);
+
+                 /// \brief Get the update statistics of a sensor.
+                 /// \param[in] _sensor The sensor.
+                 /// \param[out] _stats The statistics of the sensor.
+                 /// \return False if the sensor is not in this container,
+                 /// or the container is not scheduled.
+                 public: bool UpdateStats(const Sensor *_sensor,
+                                          SensorUpdateStats &_stats) const;
+
+                 /// \brief Update the due sensors of a scheduled
+                 /// container.
+                 private: void UpdateScheduled();
+
+                 /// \brief Get the simulation time at which the next
+                 /// sensor of this container is due.
+                 /// \param[out] _time The due time.
+                 /// \return False if the container is not scheduled, in
+                 /// which case the run loop wakes up at the rate of its
+                 /// fastest sensor.
+                 private: bool NextDueTime(common::Time &_time) const;
+
                  /// \brief A loop to update the sensor. Used by the
                  /// runThread.
                  private: void RunLoop();
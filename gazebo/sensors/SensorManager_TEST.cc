@@ -159,6 +159,53 @@ TEST_F(SensorManager_TEST, InitRemove)
   printf("Done done\n");
 }
 
+/////////////////////////////////////////////////
+/// \brief Test the update statistics of scheduled sensors.
+TEST_F(SensorManager_TEST, UpdateStats)
+{
+  Load("worlds/empty.world");
+  sensors::SensorManager *mgr = sensors::SensorManager::Instance();
+  mgr->SetWorkerThreads(2);
+  EXPECT_EQ(mgr->WorkerThreads(), 2u);
+
+  SpawnRaySensor("ray_model_1", "ray_sensor_1");
+  SpawnRaySensor("ray_model_2", "ray_sensor_2");
+
+  sensors::SensorPtr sensor1 = mgr->GetSensor("ray_sensor_1");
+  sensors::SensorPtr sensor2 = mgr->GetSensor("ray_sensor_2");
+  ASSERT_TRUE(sensor1 != nullptr);
+  ASSERT_TRUE(sensor2 != nullptr);
+  sensor1->SetUpdateRate(50);
+  sensor2->SetUpdateRate(20);
+
+  // Unknown sensors have no statistics
+  sensors::SensorUpdateStats stats;
+  EXPECT_FALSE(mgr->UpdateStats("no_such_sensor", stats));
+
+  // Wait for a few updates of the slower sensor
+  int i = 0;
+  while (i < 100 && (!mgr->UpdateStats("ray_sensor_2", stats) ||
+        stats.updateCount < 20))
+  {
+    common::Time::MSleep(100);
+    ++i;
+  }
+  EXPECT_LT(i, 100);
+
+  sensors::SensorUpdateStats stats1;
+  sensors::SensorUpdateStats stats2;
+  EXPECT_TRUE(mgr->UpdateStats("ray_sensor_1", stats1));
+  EXPECT_TRUE(mgr->UpdateStats("ray_sensor_2", stats2));
+  EXPECT_GT(stats1.updateCount, stats2.updateCount);
+  EXPECT_NEAR(stats1.rate, 50, 5);
+  EXPECT_NEAR(stats2.rate, 20, 2);
+  EXPECT_GE(stats1.lateness, common::Time::Zero);
+  EXPECT_GE(stats1.maxLateness, stats1.lateness);
+
+  mgr->SetWorkerThreads(1);
+  EXPECT_EQ(mgr->WorkerThreads(), 1u);
+}
+
 /////////////////////////////////////////////////
 int main(int argc, char **argv)
 {
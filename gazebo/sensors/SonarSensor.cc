@@ -14,6 +14,7 @@
  * limitations under the License.
  *
 */
+#include <cmath>
 #include <boost/algorithm/string.hpp>
 
 #include <ignition/common/Profiler.hh>
@@ -25,6 +26,8 @@
 #include "gazebo/physics/PhysicsEngine.hh"
 #include "gazebo/physics/ContactManager.hh"
 #include "gazebo/physics/Collision.hh"
+#include "gazebo/physics/Link.hh"
+#include "gazebo/physics/RayQuery.hh"
 
 #include "gazebo/common/Assert.hh"
 
@@ -154,6 +157,18 @@ void SonarSensor::Load(const std::string &_worldName)
     this->dataPtr->sonarShape->SetScale(
         ignition::math::Vector3d(range*2, range*2, range*2));
     this->dataPtr->sonarMidPose = this->pose;
+
+    // Spread the rays evenly over the sphere with a Fibonacci lattice
+    const int rayCount = 64;
+    const double goldenAngle = M_PI * (3.0 - std::sqrt(5.0));
+    for (int i = 0; i < rayCount; ++i)
+    {
+      double z = 1.0 - (i + 0.5) * 2.0 / rayCount;
+      double r = std::sqrt(1.0 - z * z);
+      double phi = i * goldenAngle;
+      this->dataPtr->rayDirections.push_back(
+          ignition::math::Vector3d(r * std::cos(phi), r * std::sin(phi), z));
+    }
   }
   else
   {
@@ -173,6 +188,26 @@ void SonarSensor::Load(const std::string &_worldName)
     const auto offset = this->pose.Rot().RotateVector({0, 0, range * 0.5});
     this->dataPtr->sonarMidPose.Set(this->pose.Pos() - offset,
         this->pose.Rot());
+
+    // Fan of rays from the apex of the cone: one along its axis and rings
+    // of rays up to its half angle
+    const int ringCount = 4;
+    const int ringRayCount = 8;
+    const double halfAngle = range > 0 ?
+        std::atan(this->dataPtr->radius / range) : 0.0;
+    this->dataPtr->rayDirections.push_back(
+        ignition::math::Vector3d(0, 0, -1));
+    for (int i = 1; i <= ringCount; ++i)
+    {
+      double angle = halfAngle * i / ringCount;
+      for (int j = 0; j < ringRayCount; ++j)
+      {
+        double phi = 2.0 * M_PI * j / ringRayCount;
+        this->dataPtr->rayDirections.push_back(ignition::math::Vector3d(
+            std::sin(angle) * std::cos(phi), std::sin(angle) * std::sin(phi),
+            -std::cos(angle)));
+      }
+    }
   }
 
   this->dataPtr->sonarCollision->SetRelativePose(this->dataPtr->sonarMidPose);
@@ -298,11 +333,50 @@ bool SonarSensor::UpdateImpl(const bool /*_force*/)
 
   ignition::math::Vector3d pos;
 
-  // A 5-step hysteresis window was chosen to reduce range value from
-  // bouncing.
-  if (!this->dataPtr->incomingContacts.empty() ||
+  if (this->world->RayQuery().Enabled())
+  {
+    // Sample the sonar shape with rays instead of waiting for contacts,
+    // which gives the closest obstacle within the sampling resolution.
+    const double range = this->dataPtr->rangeMax - this->dataPtr->rangeMin;
+    std::vector<physics::RayQueryRay> rays(
+        this->dataPtr->rayDirections.size());
+    for (size_t i = 0; i < rays.size(); ++i)
+    {
+      rays[i].start = referencePose.Pos();
+      rays[i].end = referencePose.Pos() + referencePose.Rot().RotateVector(
+          this->dataPtr->rayDirections[i] * range);
+    }
+
+    // Like the sonar collision, the rays pass through the parent link, so
+    // obstacles behind it are still found
+    physics::LinkPtr parentLink =
+        boost::dynamic_pointer_cast<physics::Link>(
+        this->dataPtr->parentEntity);
+    physics::RayQueryResult result;
+    this->world->RayQuery().Cast(rays, result, physics::RayQueryLayers::ALL,
+        parentLink.get());
+
+    this->dataPtr->sonarMsg.mutable_sonar()->set_range(
+        this->dataPtr->rangeMax);
+    for (size_t i = 0; i < rays.size(); ++i)
+    {
+      const physics::RayQueryHit &hit = result.hits[i];
+      if (hit.collision &&
+          hit.distance < this->dataPtr->sonarMsg.sonar().range())
+      {
+        this->dataPtr->sonarMsg.mutable_sonar()->set_range(hit.distance);
+        msgs::Set(this->dataPtr->sonarMsg.mutable_sonar()->mutable_contact(),
+            this->dataPtr->rayDirections[i] * hit.distance);
+      }
+    }
+
+    this->dataPtr->incomingContacts.clear();
+  }
+  else if (!this->dataPtr->incomingContacts.empty() ||
       this->dataPtr->emptyContactCount > 5)
   {
+    // A 5-step hysteresis window was chosen to reduce range value from
+    // bouncing.
     this->dataPtr->sonarMsg.mutable_sonar()->set_range(
         this->dataPtr->rangeMax);
     this->dataPtr->emptyContactCount = 0;
@@ -19,6 +19,7 @@
 
 #include <list>
 #include <mutex>
+#include <vector>
 #include <ignition/math/Pose3.hh>
 
 #include "gazebo/msgs/msgs.hh"
@@ -78,6 +79,10 @@ namespace gazebo
       /// \brief Counts the number of times there were no contacts. This is
       /// used to reduce the range value jumping.
       public: int emptyContactCount;
+
+      /// \brief Unit directions, in the sensor frame, of the rays that
+      /// sample the sonar shape when batched ray queries are enabled.
+      public: std::vector<ignition::math::Vector3d> rayDirections;
     };
   }
 }
@@ -36,6 +36,11 @@ class SonarSensor_TEST : public ServerFixture,
   /// \param[in] _paused Start paused if true.
   public: void DemoWorld(const std::string &_physicsEngine, bool _paused);
 
+  /// \brief Test that the sonar of the demo world measures the same range
+  /// with batched ray queries as with contacts.
+  /// \param[in] _physicsEngine Name of physics engine to use.
+  public: void BatchedDemoWorld(const std::string &_physicsEngine);
+
   /// \brief Test sonar with just a ground plane.
   /// \param[in] _physicsEngine Name of physics engine to use.
   public: void GroundPlane(const std::string &_physicsEngine);
@@ -191,6 +196,41 @@ void SonarSensor_TEST::GroundPlane(const std::string &_physicsEngine)
   EXPECT_NEAR(sonar->Range(), 2.0, 0.01);
 }
 
+/////////////////////////////////////////////////
+void SonarSensor_TEST::BatchedDemoWorld(const std::string &_physicsEngine)
+{
+  if (_physicsEngine != "ode")
+  {
+    gzerr << "Sonar range sensing only works in ODE, issue #1038"
+          << std::endl;
+    return;
+  }
+
+  Load("worlds/sonar_demo.world", true, _physicsEngine);
+  sensors::SensorManager *mgr = sensors::SensorManager::Instance();
+
+  physics::WorldPtr world = physics::get_world();
+  ASSERT_TRUE(world != nullptr);
+  world->Step(100);
+  mgr->Update();
+
+  sensors::SonarSensorPtr sensor =
+    std::dynamic_pointer_cast<sensors::SonarSensor>(mgr->GetSensor("sonar"));
+  ASSERT_TRUE(sensor != nullptr);
+  ASSERT_EQ(sensor->Geometry(), std::string("cone"));
+
+  sensor->Update(true);
+  const double contactRange = sensor->Range();
+  EXPECT_NEAR(contactRange, 1.4999, 1e-3);
+
+  // The sonar starts inside the box of its parent link. Its rays pass
+  // through that box and find the same obstacle as the contacts.
+  EXPECT_TRUE(world->Physics()->SetParam("batch_ray_queries", true));
+  sensor->Update(true);
+  EXPECT_NEAR(sensor->Range(), contactRange, 1e-3);
+  EXPECT_TRUE(world->Physics()->SetParam("batch_ray_queries", false));
+}
+
 TEST_P(SonarSensor_TEST, CreateSonar)
 {
   std::string physics = std::get<0>(GetParam());
@@ -211,6 +251,12 @@ TEST_P(SonarSensor_TEST, DemoWorld)
   DemoWorld(physics, paused);
 }
 
+TEST_P(SonarSensor_TEST, BatchedDemoWorld)
+{
+  std::string physics = std::get<0>(GetParam());
+  BatchedDemoWorld(physics);
+}
+
 TEST_P(SonarSensor_TEST, GroundPlane)
 {
   std::string physics = std::get<0>(GetParam());
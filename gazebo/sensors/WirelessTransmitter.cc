@@ -14,6 +14,11 @@
  * limitations under the License.
  *
 */
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+
 #include <ignition/math/Rand.hh>
 
 #include "gazebo/msgs/msgs.hh"
@@ -37,6 +42,46 @@ const double WirelessTransmitterPrivate::ModelStdDev = 6.0;
 const double WirelessTransmitterPrivate::Step = 1.0;
 const double WirelessTransmitterPrivate::MaxRadius = 10.0;
 
+namespace
+{
+  /// \brief Get the terms of the Hata-Okumara propagation model that do
+  /// not depend on the receiver position.
+  /// \param[in] _power Transmitter power (dBm).
+  /// \param[in] _txGain Transmitter antenna gain (dBi).
+  /// \param[in] _rxGain Receiver antenna gain (dBi).
+  /// \param[in] _freq Frequency (MHz).
+  /// \return Received power before path loss (dBm).
+  double linkBudget(const double _power, const double _txGain,
+      const double _rxGain, const double _freq)
+  {
+    const double wavelength = common::SpeedOfLight / (_freq * 1000000);
+    return _power + _txGain + _rxGain + 20 * log10(wavelength) -
+        20 * log10(4 * M_PI);
+  }
+
+  /// \brief Get the distance term of the path loss, which is scaled by
+  /// the path loss exponent.
+  /// \param[in] _distance Distance between the antennas (m).
+  /// \return The distance term.
+  double distanceTerm(const double _distance)
+  {
+    return 10 * log10(std::max(1.0, _distance));
+  }
+
+  /// \brief Hata-Okumara propagation model.
+  /// \param[in] _linkBudget Result of linkBudget().
+  /// \param[in] _n Path loss exponent.
+  /// \param[in] _distanceTerm Result of distanceTerm().
+  /// \return Received power (dBm), with a random fading loss.
+  double propagation(const double _linkBudget, const double _n,
+      const double _distanceTerm)
+  {
+    const double x = std::abs(ignition::math::Rand::DblNormal(0.0,
+          WirelessTransmitterPrivate::ModelStdDev));
+    return _linkBudget - x - _n * _distanceTerm;
+  }
+}
+
 /////////////////////////////////////////////////
 WirelessTransmitter::WirelessTransmitter()
 : WirelessTransceiver(),
@@ -68,6 +113,32 @@ void WirelessTransmitter::Load(const std::string &_worldName)
     this->dataPtr->freq = 1.0;
   }
 
+  // Iterate using a rectangular grid, but only choose the points within
+  // a circunference of radius MaxRadius. The grid moves with the
+  // transmitter, so its points are only listed once.
+  this->dataPtr->cells.clear();
+  this->dataPtr->distanceTerms.clear();
+  this->dataPtr->gridMsg.Clear();
+  for (double x = -this->dataPtr->MaxRadius;
+       x <= this->dataPtr->MaxRadius; x += this->dataPtr->Step)
+  {
+    for (double y = -this->dataPtr->MaxRadius;
+         y <= this->dataPtr->MaxRadius; y += this->dataPtr->Step)
+    {
+      const ignition::math::Pose3d cell(x, y, 0.0, 0, 0, 0);
+      const double distance = cell.Pos().Length();
+      if (distance > this->dataPtr->MaxRadius)
+        continue;
+
+      this->dataPtr->cells.push_back(cell);
+      this->dataPtr->distanceTerms.push_back(distanceTerm(distance));
+      this->dataPtr->gridMsg.add_position(x);
+      this->dataPtr->gridMsg.add_position(y);
+    }
+  }
+  this->dataPtr->gridMsg.mutable_signal_level()->Resize(
+      static_cast<int>(this->dataPtr->cells.size()), 0.0);
+
   this->pub =
     this->node->Advertise<msgs::PropagationGrid>(this->Topic(), 30);
   GZ_ASSERT(this->pub != nullptr,
@@ -90,43 +161,99 @@ bool WirelessTransmitter::UpdateImpl(const bool /*_force*/)
 {
   this->referencePose = this->pose + this->parentEntity.lock()->WorldPose();
 
-  if (this->dataPtr->visualize)
+  if (!this->dataPtr->visualize)
+    return true;
+
+  WirelessTransmitterPrivate &d = *this->dataPtr;
+  const size_t count = d.cells.size();
+  d.obstructed.resize(count);
+
+  if (this->world->RayQuery().Enabled())
   {
-    msgs::PropagationGrid msg;
-    ignition::math::Pose3d pos;
-    ignition::math::Pose3d worldPose;
-    double strength;
-    msgs::PropagationParticle *p;
-
-    // Iterate using a rectangular grid, but only choose the points within
-    // a circunference of radius MaxRadius
-    for (double x = -this->dataPtr->MaxRadius;
-         x <= this->dataPtr->MaxRadius; x += this->dataPtr->Step)
+    physics::RayQuery &query = this->world->RayQuery();
+
+    // Obstacles are looked for again when the transmitter moves, and
+    // otherwise only against the collisions that changed since the last
+    // update, so a grid among static geometry is not cast again.
+    if (d.rays.size() != count || d.raysPose != this->referencePose)
     {
-      for (double y = -this->dataPtr->MaxRadius;
-           y <= this->dataPtr->MaxRadius; y += this->dataPtr->Step)
+      d.rays.resize(count);
+      for (size_t i = 0; i < count; ++i)
       {
-        pos.Set(x, y, 0.0, 0, 0, 0);
-
-        worldPose = pos + this->referencePose;
-
-        if (this->referencePose.Pos().Distance(worldPose.Pos()) <=
-            this->dataPtr->MaxRadius)
-        {
-          // For the propagation model assume the receiver antenna has the same
-          // gain as the transmitter
-          strength = this->SignalStrength(worldPose, this->Gain());
-
-          // Add a new particle to the grid
-          p = msg.add_particle();
-          p->set_x(x);
-          p->set_y(y);
-          p->set_signal_level(strength);
-        }
+        d.rays[i].start = this->referencePose.Pos();
+        d.rays[i].end = (d.cells[i] + this->referencePose).Pos();
+        if (d.rays[i].start == d.rays[i].end)
+          d.rays[i].end.Z() += 0.00001;
       }
+      d.raysPose = this->referencePose;
+      d.staticVersion = 0;
+      d.dynamicVersion = 0;
+    }
+
+    physics::RayQueryResult result;
+    query.Cast(std::vector<physics::RayQueryRay>(), result);
+
+    if (result.staticVersion != d.staticVersion)
+    {
+      query.Cast(d.rays, result, physics::RayQueryLayers::STATIC);
+      d.staticHits.resize(count);
+      for (size_t i = 0; i < count; ++i)
+        d.staticHits[i] = result.hits[i].collision != nullptr;
+      d.staticVersion = result.staticVersion;
+    }
+
+    if (result.dynamicVersion != d.dynamicVersion)
+    {
+      query.Cast(d.rays, result, physics::RayQueryLayers::DYNAMIC);
+      d.dynamicHits.resize(count);
+      for (size_t i = 0; i < count; ++i)
+        d.dynamicHits[i] = result.hits[i].collision != nullptr;
+      d.dynamicVersion = result.dynamicVersion;
     }
-    this->pub->Publish(msg);
+
+    for (size_t i = 0; i < count; ++i)
+      d.obstructed[i] = d.staticHits[i] || d.dynamicHits[i];
   }
+  else
+  {
+    // Batched queries may be enabled later, from a different pose
+    d.rays.clear();
+
+    // Acquire the mutex once for all the points, for avoiding race
+    // condition with the physics engine
+    boost::recursive_mutex::scoped_lock lock(*(
+          this->world->Physics()->GetPhysicsUpdateMutex()));
+
+    for (size_t i = 0; i < count; ++i)
+    {
+      ignition::math::Vector3d start = this->referencePose.Pos();
+      ignition::math::Vector3d end = (d.cells[i] + this->referencePose).Pos();
+      if (start == end)
+        end.Z() += 0.00001;
+
+      // ToDo: The ray intersects with my own collision model. Fix it.
+      std::string entityName;
+      double dist;
+      d.testRay->SetPoints(start, end);
+      d.testRay->GetIntersection(dist, entityName);
+      d.obstructed[i] = !entityName.empty();
+    }
+  }
+
+  // Propagation() for every point, assuming the receiver antenna has the
+  // same gain as the transmitter, with the terms that are the same for
+  // every point computed once.
+  const double budget =
+      linkBudget(this->Power(), this->Gain(), this->Gain(), this->Freq());
+  double *signalLevels = d.gridMsg.mutable_signal_level()->mutable_data();
+  for (size_t i = 0; i < count; ++i)
+  {
+    const double n = d.obstructed[i] ? WirelessTransmitterPrivate::NObstacle :
+        WirelessTransmitterPrivate::NEmpty;
+    signalLevels[i] = propagation(budget, n, d.distanceTerms[i]);
+  }
+
+  this->pub->Publish(d.gridMsg);
 
   return true;
 }
@@ -177,17 +304,17 @@ double WirelessTransmitter::SignalStrength(
     n = WirelessTransmitterPrivate::NObstacle;
   }
 
-  double distance = std::max(1.0,
-      this->referencePose.Pos().Distance(_receiver.Pos()));
-  double x = std::abs(ignition::math::Rand::DblNormal(0.0,
-        WirelessTransmitterPrivate::ModelStdDev));
-  double wavelength = common::SpeedOfLight / (this->Freq() * 1000000);
-
-  // Hata-Okumara propagation model
-  double rxPower = this->Power() + this->Gain() + _rxGain - x +
-      20 * log10(wavelength) - 20 * log10(4 * M_PI) - 10 * n * log10(distance);
+  return this->Propagation(
+      this->referencePose.Pos().Distance(_receiver.Pos()), n, _rxGain);
+}
 
-  return rxPower;
+/////////////////////////////////////////////////
+double WirelessTransmitter::Propagation(const double _distance,
+    const double _n, const double _rxGain) const
+{
+  return propagation(
+      linkBudget(this->Power(), this->Gain(), _rxGain, this->Freq()),
+      _n, distanceTerm(_distance));
 }
 
 /////////////////////////////////////////////////
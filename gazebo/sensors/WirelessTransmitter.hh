@@ -73,6 +73,15 @@ namespace gazebo
       /// \return The standard deviation of the propagation model.
       public: double ModelStdDev() const;
 
+      /// \brief Evaluate the propagation model.
+      /// \param[in] _distance Distance between transmitter and receiver.
+      /// \param[in] _n Path loss exponent, which depends on the obstacles
+      /// between transmitter and receiver.
+      /// \param[in] _rxGain Receiver gain value
+      /// \return Signal strength at the receiver (dBm).
+      private: double Propagation(const double _distance, const double _n,
+          const double _rxGain) const;
+
       /// \internal
       /// \brief Private data pointer
       private: std::unique_ptr<WirelessTransmitterPrivate> dataPtr;
@@ -17,8 +17,15 @@
 #ifndef _GAZEBO_SENSORS_WIRELESSTRANSMITTER_PRIVATE_HH_
 #define _GAZEBO_SENSORS_WIRELESSTRANSMITTER_PRIVATE_HH_
 
+#include <cstdint>
 #include <string>
+#include <vector>
+
+#include <ignition/math/Pose3.hh>
+
+#include "gazebo/msgs/msgs.hh"
 #include "gazebo/physics/PhysicsTypes.hh"
+#include "gazebo/physics/RayQuery.hh"
 
 namespace gazebo
 {
@@ -59,6 +66,43 @@ namespace gazebo
 
       // \brief Ray used to test for collisions when placing entities
       public: physics::RayShapePtr testRay;
+
+      /// \brief Propagation grid published for visualization. Its points
+      /// are set once, only the signal levels change.
+      public: msgs::PropagationGrid gridMsg;
+
+      /// \brief Pose of every point of the grid relative to the
+      /// transmitter.
+      public: std::vector<ignition::math::Pose3d> cells;
+
+      /// \brief 10 * log10 of the distance from the transmitter to every
+      /// point of the grid, for the propagation model.
+      public: std::vector<double> distanceTerms;
+
+      /// \brief True for the points of the grid with an obstacle between
+      /// them and the transmitter.
+      public: std::vector<uint8_t> obstructed;
+
+      /// \brief Rays from the transmitter to every point of the grid, cast
+      /// with the batched ray queries of the world.
+      public: std::vector<physics::RayQueryRay> rays;
+
+      /// \brief Reference pose the rays were built for.
+      public: ignition::math::Pose3d raysPose;
+
+      /// \brief Rays blocked by static collisions.
+      public: std::vector<uint8_t> staticHits;
+
+      /// \brief Rays blocked by other collisions.
+      public: std::vector<uint8_t> dynamicHits;
+
+      /// \brief Version of the static collisions staticHits were found
+      /// with, zero if they need to be found again.
+      public: uint64_t staticVersion = 0;
+
+      /// \brief Version of the other collisions dynamicHits were found
+      /// with, zero if they need to be found again.
+      public: uint64_t dynamicVersion = 0;
     };
   }
 }
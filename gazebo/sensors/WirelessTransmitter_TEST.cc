@@ -191,6 +191,19 @@ void WirelessTransmitter_TEST::TestUpdateImpl()
 
   std::lock_guard<std::mutex> lock(this->mutex);
   EXPECT_TRUE(this->receivedMsg);
+
+  // The grid is published as packed arrays
+  ASSERT_TRUE(this->gridMsg != nullptr);
+  EXPECT_EQ(this->gridMsg->particle_size(), 0);
+  EXPECT_GT(this->gridMsg->signal_level_size(), 0);
+  EXPECT_EQ(this->gridMsg->position_size(),
+      2 * this->gridMsg->signal_level_size());
+  for (int i = 0; i < this->gridMsg->signal_level_size(); ++i)
+  {
+    const double x = this->gridMsg->position(2 * i);
+    const double y = this->gridMsg->position(2 * i + 1);
+    EXPECT_LE(x * x + y * y, 100.0 + 1e-6);
+  }
 }
 
 /////////////////////////////////////////////////
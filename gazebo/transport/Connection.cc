@@ -49,10 +49,20 @@
 #include <stdio.h>
 #include <stdlib.h>
 
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
 #include <boost/bind.hpp>
 #include <boost/function.hpp>
 #include <boost/lexical_cast.hpp>
+#include <boost/make_shared.hpp>
+#include <boost/thread/shared_mutex.hpp>
 
+#include "gazebo/common/Assert.hh"
 #include "gazebo/common/Console.hh"
 #include "gazebo/msgs/msgs.hh"
 
@@ -68,6 +78,107 @@ extern void dummy_callback_fn(uint32_t);
 unsigned int Connection::idCounter = 0;
 IOManager *Connection::iomanager = NULL;
 
+/// \brief First byte of a binary header.
+static const char kBinaryHeaderMark = '\x01';
+
+/// \brief Largest size that fits in a hex header that advertises binary
+/// headers (a space followed by 7 hex digits).
+static const std::size_t kMaxAdvertiseSize = 0x0FFFFFFF;
+
+/// \brief Largest number of bytes that are batched into a single write.
+static const std::size_t kMaxBatchSize = 4096;
+
+namespace gazebo
+{
+  namespace transport
+  {
+    /// \brief A batch of framed messages that are written to a socket with
+    /// a single gather-write. The payloads are shared, not copied, so the
+    /// same serialized message can be queued on several connections.
+    class ConnectionWriteBatch
+    {
+      /// \brief Headers of the messages, HEADER_LENGTH bytes each.
+      public: std::string headers;
+
+      /// \brief Payloads of the messages.
+      public: std::vector<boost::shared_ptr<const std::string> > payloads;
+
+      /// \brief Callbacks used to notify a publisher when a message is
+      /// successfully sent, paired with the message ids.
+      public: std::vector<
+              std::pair<boost::function<void(uint32_t)>, uint32_t> > callbacks;
+
+      /// \brief Total number of bytes in the batch.
+      public: std::size_t size = 0;
+    };
+
+    /// \internal
+    /// \brief Private data for the Connection class
+    class ConnectionPrivate
+    {
+      /// \brief Outgoing batches of messages.
+      public: std::deque<ConnectionWriteBatch> writeQueue;
+
+      /// \brief True if the remote side can parse binary headers.
+      public: std::atomic<bool> binaryHeaders{false};
+    };
+  }
+}
+
+// TODO added here for ABI compatibility
+// move to a private data pointer in Connection when merging forward.
+static std::unordered_map<const Connection *,
+    std::unique_ptr<ConnectionPrivate>> gConnectionData;
+
+/// \brief Mutex that protects gConnectionData. Lookups share the lock, so
+/// connections never wait for each other, only for a connection being
+/// created or destroyed.
+static boost::shared_mutex gConnectionDataMutex;
+
+/// \brief Get the private data of a connection. Each call looks the
+/// connection up once and uses the pointer for the rest of the call.
+/// \param[in] _conn The connection.
+/// \return The private data, which lives as long as the connection, or
+/// nullptr if the connection is not constructed or already destroyed.
+static ConnectionPrivate *connectionData(const Connection *_conn)
+{
+  boost::shared_lock<boost::shared_mutex> lock(gConnectionDataMutex);
+  auto iter = gConnectionData.find(_conn);
+  GZ_ASSERT(iter != gConnectionData.end(), "Connection has no private data");
+  return iter != gConnectionData.end() ? iter->second.get() : nullptr;
+}
+
+/// \brief Append the header of a message to a batch.
+/// \param[in] _size Size of the message payload.
+/// \param[in] _binary True to write a binary header.
+/// \param[out] _batch Batch that receives the header.
+static void appendHeader(const std::size_t _size, const bool _binary,
+    ConnectionWriteBatch &_batch)
+{
+  if (_binary)
+  {
+    _batch.headers.push_back(kBinaryHeaderMark);
+    for (int i = 0; i < HEADER_LENGTH - 1; ++i)
+      _batch.headers.push_back(static_cast<char>((_size >> (8 * i)) & 0xFF));
+    return;
+  }
+
+  // A leading space tells the remote side that we can parse binary
+  // headers. Older versions skip the space when parsing the hex size.
+  char headerBuffer[HEADER_LENGTH + 1];
+  if (_size <= kMaxAdvertiseSize)
+  {
+    snprintf(headerBuffer, HEADER_LENGTH + 1, " %07x",
+        static_cast<unsigned int>(_size));
+  }
+  else
+  {
+    snprintf(headerBuffer, HEADER_LENGTH + 1, "%08x",
+        static_cast<unsigned int>(_size));
+  }
+  _batch.headers.append(headerBuffer, HEADER_LENGTH);
+}
+
 // Version 1.52 of boost has an address::is_unspecfied function, but
 // Version 1.46.1 (installed on ubuntu) does not. So this helper function
 // is stolen from adress::is_unspecified function in boost v1.52.
@@ -90,6 +201,11 @@ Connection::Connection()
   this->isOpen = false;
   this->dropMsgLogged = false;
 
+  {
+    boost::unique_lock<boost::shared_mutex> lock(gConnectionDataMutex);
+    gConnectionData[this].reset(new ConnectionPrivate);
+  }
+
   if (iomanager == NULL)
     iomanager = new IOManager();
 
@@ -126,6 +242,11 @@ Connection::~Connection()
 {
   this->Shutdown();
 
+  {
+    boost::unique_lock<boost::shared_mutex> lock(gConnectionDataMutex);
+    gConnectionData.erase(this);
+  }
+
   if (iomanager)
   {
     iomanager->DecCount();
@@ -302,26 +423,42 @@ void Connection::EnqueueMsg(const std::string &_buffer,
     return;
   }
 
-  char headerBuffer[HEADER_LENGTH + 1];
-  snprintf(headerBuffer, HEADER_LENGTH + 1, "%08x",
-      static_cast<unsigned int>(_buffer.size()));
+  this->EnqueueMsg(boost::make_shared<const std::string>(_buffer),
+      _cb, _id, _force);
+}
+
+//////////////////////////////////////////////////
+void Connection::EnqueueMsg(const boost::shared_ptr<const std::string> &_buffer,
+    boost::function<void(uint32_t)> _cb, uint32_t _id, bool _force)
+{
+  // Don't enqueue empty messages
+  if (!_buffer || _buffer->empty() || !this->IsOpen())
+  {
+    return;
+  }
+
+  ConnectionPrivate *data = connectionData(this);
+  if (!data)
+    return;
 
   {
     boost::recursive_mutex::scoped_lock lock(this->writeMutex);
 
-    if (this->writeQueue.empty() ||
-        (this->writeCount > 0 && this->writeQueue.size() == 1) ||
-        (this->writeQueue.back().size() + HEADER_LENGTH + _buffer.size() >
-         4096))
+    // Small messages are batched together, unless the last batch is
+    // already being written.
+    std::deque<ConnectionWriteBatch> &queue = data->writeQueue;
+    if (queue.empty() || (this->writeCount > 0 && queue.size() == 1) ||
+        (queue.back().size + HEADER_LENGTH + _buffer->size() >
+         kMaxBatchSize))
     {
-      this->writeQueue.push_back(std::string(headerBuffer) + _buffer);
-      this->callbacks.push_back({std::make_pair(_cb, _id)});
-    }
-    else
-    {
-      this->writeQueue.back() += std::string(headerBuffer) + _buffer;
-      this->callbacks.back().push_back(std::make_pair(_cb, _id));
+      queue.push_back(ConnectionWriteBatch());
     }
+
+    ConnectionWriteBatch &batch = queue.back();
+    appendHeader(_buffer->size(), data->binaryHeaders, batch);
+    batch.payloads.push_back(_buffer);
+    batch.callbacks.push_back(std::make_pair(_cb, _id));
+    batch.size += HEADER_LENGTH + _buffer->size();
   }
 
   if (_force)
@@ -335,19 +472,27 @@ void Connection::EnqueueMsg(const std::string &_buffer,
   }
 }
 
+//////////////////////////////////////////////////
+bool Connection::BinaryHeaders() const
+{
+  const ConnectionPrivate *data = connectionData(this);
+  return data && data->binaryHeaders;
+}
+
 /////////////////////////////////////////////////
 void Connection::ProcessWriteQueue(bool _blocking)
 {
+  ConnectionPrivate *data = connectionData(this);
   boost::recursive_mutex::scoped_lock lock(this->writeMutex);
 
-  if (!this->IsOpen())
+  if (!data || !this->IsOpen())
   {
     return;
   }
 
   // async_write should only be called when the last async_write has
   // completed. therefore we have to check the writeCount attribute
-  if (this->writeQueue.empty() || this->writeCount > 0)
+  if (data->writeQueue.empty() || this->writeCount > 0)
   {
     return;
   }
@@ -355,13 +500,21 @@ void Connection::ProcessWriteQueue(bool _blocking)
   this->writeCount++;
 
   // Write the serialized data to the socket. We use
-  // "gather-write" to send both the head and the data in
-  // a single write operation
+  // "gather-write" to send the headers and the shared payloads in
+  // a single write operation, without copying the payloads.
+  const ConnectionWriteBatch &batch = data->writeQueue.front();
+  std::vector<boost::asio::const_buffer> buffers;
+  buffers.reserve(batch.payloads.size() * 2);
+  for (std::size_t i = 0; i < batch.payloads.size(); ++i)
+  {
+    buffers.push_back(boost::asio::buffer(
+          batch.headers.data() + i * HEADER_LENGTH, HEADER_LENGTH));
+    buffers.push_back(boost::asio::buffer(*batch.payloads[i]));
+  }
+
   if (!_blocking)
   {
-    boost::asio::async_write(*this->socket,
-        boost::asio::buffer(this->writeQueue.front().c_str(),
-          this->writeQueue.front().size()),
+    boost::asio::async_write(*this->socket, buffers,
           common::weakBind(&Connection::OnWrite, this->shared_from_this(),
             boost::asio::placeholders::error));
   }
@@ -369,9 +522,7 @@ void Connection::ProcessWriteQueue(bool _blocking)
   {
     try
     {
-      boost::asio::write(*this->socket,
-          boost::asio::buffer(this->writeQueue.front().c_str(),
-            this->writeQueue.front().size()));
+      boost::asio::write(*this->socket, buffers);
     }
     catch(...)
     {
@@ -398,16 +549,15 @@ std::string Connection::GetRemoteURI() const
 void Connection::PostWrite()
 {
   // Call the callbacks, if not NULL
-  if (!this->callbacks.empty())
+  ConnectionPrivate *data = connectionData(this);
+  if (data && !data->writeQueue.empty())
   {
-    for (auto const &callback : this->callbacks.front())
+    for (auto const &callback : data->writeQueue.front().callbacks)
       if (!callback.first.empty())
         callback.first(callback.second);
-    this->callbacks.pop_front();
+    data->writeQueue.pop_front();
   }
 
-  if (!this->writeQueue.empty())
-    this->writeQueue.pop_front();
   this->writeCount--;
 }
 
@@ -487,9 +637,10 @@ void Connection::Close()
     this->acceptor = NULL;
   }
 
+  ConnectionPrivate *data = connectionData(this);
   boost::recursive_mutex::scoped_lock lock2(this->writeMutex);
-  this->writeQueue.clear();
-  this->callbacks.clear();
+  if (data)
+    data->writeQueue.clear();
 }
 
 //////////////////////////////////////////////////
@@ -630,6 +781,32 @@ unsigned int Connection::GetRemotePort() const
 std::size_t Connection::ParseHeader(const std::string &header)
 {
   std::size_t data_size = 0;
+
+  // Headers of older peers start with a hex digit and need no lookup
+  ConnectionPrivate *data = nullptr;
+  if (!header.empty() &&
+      (header[0] == kBinaryHeaderMark || header[0] == ' '))
+  {
+    data = connectionData(this);
+  }
+
+  if (!header.empty() && header[0] == kBinaryHeaderMark)
+  {
+    // A peer that sends binary headers can also parse them.
+    if (data)
+      data->binaryHeaders = true;
+    for (std::size_t i = 1; i < header.size() && i < HEADER_LENGTH; ++i)
+    {
+      data_size |= static_cast<std::size_t>(
+          static_cast<unsigned char>(header[i])) << (8 * (i - 1));
+    }
+    return data_size;
+  }
+
+  // The remote side advertises that it can parse binary headers.
+  if (data)
+    data->binaryHeaders = true;
+
   std::istringstream is(header);
 
   if (!(is >> std::hex >> data_size))
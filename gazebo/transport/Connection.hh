@@ -168,6 +168,26 @@ namespace gazebo
       /// to the socket, otherwise just enqueue the data for asynchronous write
       public: void EnqueueMsg(const std::string &_buffer, bool _force = false);
 
+      /// \brief Write shared data to the socket. The data is not copied,
+      /// so the same buffer can be enqueued on several connections. It must
+      /// not be modified after it has been enqueued.
+      /// \param[in] _buffer Data to write
+      /// \param[in] _cb If non-null, callback to be invoked after
+      /// transmission is complete.
+      /// \param[in] _id ID associated with the message data.
+      /// \param[in] _force If true, block until the data has been written
+      /// to the socket, otherwise just enqueue the data for asynchronous write
+      public: void EnqueueMsg(
+                  const boost::shared_ptr<const std::string> &_buffer,
+                  boost::function<void(uint32_t)> _cb, uint32_t _id,
+                  bool _force = false);
+
+      /// \brief Get whether outgoing messages are framed with binary
+      /// headers. Binary headers are used once the remote side has shown
+      /// that it can parse them, see ParseHeader.
+      /// \return True if binary headers are used.
+      public: bool BinaryHeaders() const;
+
       /// \brief Get the local URI
       /// \return The local URI
       public: std::string GetLocalURI() const;
@@ -356,7 +376,13 @@ namespace gazebo
       /// \param[in] _e Error code for accept method
       private: void OnAccept(const boost::system::error_code &_e);
 
-      /// \brief Parse a header to get the size of a packet
+      /// \brief Parse a header to get the size of a packet.
+      ///
+      /// A header is either 8 hex digits, optionally preceded by a space,
+      /// or a 0x01 byte followed by the size as 7 little endian bytes.
+      /// A header that starts with a space is sent by a peer that can
+      /// parse binary headers, and switches this connection to binary
+      /// headers for outgoing messages.
       /// \param[in] _header Header as a string
       private: std::size_t ParseHeader(const std::string &_header);
 
@@ -21,6 +21,7 @@
 #include "gazebo/common/Events.hh"
 #include "gazebo/transport/TopicManager.hh"
 #include "gazebo/transport/ConnectionManager.hh"
+#include "gazebo/transport/SharedMemoryRing.hh"
 
 #include "gazebo/gazebo_config.h"
 
@@ -483,6 +484,14 @@ void ConnectionManager::OnRead(ConnectionPtr _connection,
     SubscriptionTransportPtr subLink(new SubscriptionTransport());
     subLink->Init(_connection, sub.latching());
 
+    // Use the shared memory ring offered by a subscriber on the same host
+    if (sub.has_shm_name() && !subLink->OpenSharedMemory(sub.shm_name()))
+    {
+      gzlog << "Using TCP for topic[" << sub.topic()
+        << "], unable to open shared memory ring[" << sub.shm_name()
+        << "]\n";
+    }
+
     // Connect the publisher to this transport mechanism
     TopicManager::Instance()->ConnectPubToSub(sub.topic(), subLink);
   }
@@ -503,6 +512,11 @@ void ConnectionManager::Advertise(const std::string &topic,
   msg.set_host(this->serverConn->GetLocalAddress());
   msg.set_port(this->serverConn->GetLocalPort());
 
+  // Let subscribers on the same host use shared memory
+  const std::string &hostId = SharedMemoryRing::HostId();
+  if (!hostId.empty())
+    msg.set_host_id(hostId);
+
   this->masterConn->EnqueueMsg(msgs::Package("advertise", msg));
 }
 
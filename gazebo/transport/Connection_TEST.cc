@@ -16,9 +16,13 @@
 */
 
 #include <gtest/gtest.h>
+#include <condition_variable>
+#include <mutex>
 #include <string>
 #include <stdlib.h>
 
+#include <boost/make_shared.hpp>
+
 #include "gazebo/transport/Connection.hh"
 #include "test/util.hh"
 
@@ -64,6 +68,64 @@ TEST_F(Connection, IPWhiteList)
     setenv("GAZEBO_IP_WHITE_LIST", ipEnv, 1);
 }
 
+/////////////////////////////////////////////////
+TEST_F(Connection, BinaryHeaders)
+{
+  std::mutex mutex;
+  std::condition_variable accepted;
+  transport::ConnectionPtr serverConn;
+
+  transport::ConnectionPtr server(new transport::Connection());
+  server->Listen(0, [&](const transport::ConnectionPtr &_conn)
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        serverConn = _conn;
+        accepted.notify_one();
+      });
+
+  transport::ConnectionPtr client(new transport::Connection());
+  ASSERT_TRUE(client->Connect("127.0.0.1", server->GetLocalPort()));
+
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    ASSERT_TRUE(accepted.wait_for(lock, std::chrono::seconds(10),
+          [&] {return serverConn != nullptr;}));
+  }
+
+  // Nothing has been received yet, so both sides use hex headers.
+  EXPECT_FALSE(client->BinaryHeaders());
+  EXPECT_FALSE(serverConn->BinaryHeaders());
+
+  // The first message advertises binary headers.
+  std::string large(1 << 20, 'x');
+  client->EnqueueMsg(large, true);
+  std::string data;
+  ASSERT_TRUE(serverConn->Read(data));
+  EXPECT_EQ(data, large);
+  EXPECT_TRUE(serverConn->BinaryHeaders());
+
+  // The reply uses a binary header, and a shared payload can be enqueued
+  // more than once.
+  auto shared = boost::make_shared<const std::string>("shared payload");
+  serverConn->EnqueueMsg(shared, boost::function<void(uint32_t)>(), 0, true);
+  serverConn->EnqueueMsg(shared, boost::function<void(uint32_t)>(), 1, true);
+  ASSERT_TRUE(client->Read(data));
+  EXPECT_EQ(data, *shared);
+  ASSERT_TRUE(client->Read(data));
+  EXPECT_EQ(data, *shared);
+  EXPECT_TRUE(client->BinaryHeaders());
+
+  // Binary headers in the other direction.
+  client->EnqueueMsg(large, true);
+  ASSERT_TRUE(serverConn->Read(data));
+  EXPECT_EQ(data, large);
+
+  client->Shutdown();
+  serverConn->Shutdown();
+  server->Shutdown();
+}
+
+/////////////////////////////////////////////////
 int main(int argc, char **argv)
 {
   ::testing::InitGoogleTest(&argc, argv);
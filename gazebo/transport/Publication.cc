@@ -17,6 +17,9 @@
 
 #include <boost/bind.hpp>
 #include <boost/function.hpp>
+#include <map>
+#include <mutex>
+#include <string>
 #include "gazebo/common/WeakBind.hh"
 #include "SubscriptionTransport.hh"
 #include "Publication.hh"
@@ -28,6 +31,44 @@ using namespace transport;
 extern void dummy_callback_fn(uint32_t);
 unsigned int Publication::idCounter = 0;
 
+/////////////////////////////////////////////////
+/// \brief Hand a serialized message to a subscription. Remote
+/// subscriptions keep the shared buffer until it is written, other
+/// callbacks get a reference to it.
+/// \param[in] _callback The subscription.
+/// \param[in] _data The serialized message.
+/// \param[in] _cb If non-null, callback to be invoked when the message
+/// was sent.
+/// \param[in] _id ID associated with the message data.
+/// \return True if the subscription handled the message.
+static bool handleSharedData(const CallbackHelperPtr &_callback,
+    const boost::shared_ptr<const std::string> &_data,
+    boost::function<void(uint32_t)> _cb, uint32_t _id)
+{
+  if (!_callback->IsLocal())
+  {
+    SubscriptionTransport *transport =
+        dynamic_cast<SubscriptionTransport *>(_callback.get());
+    if (transport)
+      return transport->HandleSharedData(_data, _cb, _id);
+  }
+  return _callback->HandleData(*_data, _cb, _id);
+}
+
+/// \brief Serialized previous messages of a publication, by publisher id.
+typedef std::map<uint32_t, boost::shared_ptr<const std::string> >
+    PrevMsgData;
+
+// TODO added here for ABI compatibility
+// move to a member of Publication when merging forward.
+/// \brief Serialized form of the previous messages of each publication.
+/// An entry is created on first use, and dropped when the previous message
+/// of its publisher changes.
+static std::map<const Publication *, PrevMsgData> gPrevMsgData;
+
+/// \brief Mutex that protects gPrevMsgData.
+static std::mutex gPrevMsgDataMutex;
+
 //////////////////////////////////////////////////
 Publication::Publication(const std::string &_topic, const std::string &_msgType)
   : topic(_topic), msgType(_msgType), locallyAdvertised(false)
@@ -40,6 +81,9 @@ Publication::~Publication()
 {
   boost::mutex::scoped_lock lock(this->callbackMutex);
   this->publishers.clear();
+
+  std::lock_guard<std::mutex> dataLock(gPrevMsgDataMutex);
+  gPrevMsgData.erase(this);
 }
 
 //////////////////////////////////////////////////
@@ -90,9 +134,12 @@ void Publication::AddSubscription(const CallbackHelperPtr _callback)
       for (std::map<uint32_t, MessagePtr>::iterator pubIter =
           this->prevMsgs.begin(); pubIter != this->prevMsgs.end(); ++pubIter)
       {
-        if (pubIter->second)
+        boost::shared_ptr<const std::string> data =
+          this->SerializedPrevMsg(pubIter->first);
+        if (data)
         {
-          _callback->HandleMessage(pubIter->second);
+          handleSharedData(_callback, data,
+              boost::bind(&dummy_callback_fn, _1), 0);
         }
       }
       _callback->SetLatching(false);
@@ -105,6 +152,9 @@ void Publication::SetPrevMsg(uint32_t _pubId, MessagePtr _msg)
 {
   boost::mutex::scoped_lock lock(this->callbackMutex);
   this->prevMsgs[_pubId] = _msg;
+
+  std::lock_guard<std::mutex> dataLock(gPrevMsgDataMutex);
+  gPrevMsgData[this].erase(_pubId);
 }
 
 //////////////////////////////////////////////////
@@ -112,6 +162,9 @@ void Publication::ClearPrevMsgs()
 {
   boost::mutex::scoped_lock lock(this->callbackMutex);
   this->prevMsgs.clear();
+
+  std::lock_guard<std::mutex> dataLock(gPrevMsgDataMutex);
+  gPrevMsgData.erase(this);
 }
 
 //////////////////////////////////////////////////
@@ -319,14 +372,14 @@ int Publication::Publish(MessagePtr _msg, boost::function<void(uint32_t)> _cb,
 
     if (!this->callbacks.empty())
     {
-      std::string data;
-      _msg->SerializeToString(&data);
+      // Serialize once, and share the buffer with every callback.
+      boost::shared_ptr<const std::string> data = this->SerializedMsg(_msg);
       std::list<CallbackHelperPtr>::iterator cbIter;
       cbIter = this->callbacks.begin();
 
       while (cbIter != this->callbacks.end())
       {
-        if ((*cbIter)->HandleData(data, _cb, _id))
+        if (handleSharedData(*cbIter, data, _cb, _id))
         {
           ++result;
           ++cbIter;
@@ -524,3 +577,55 @@ MessagePtr Publication::GetPrevMsg(uint32_t _pubId)
     return MessagePtr();
 }
 
+//////////////////////////////////////////////////
+boost::shared_ptr<const std::string> Publication::GetPrevMsgData(
+    uint32_t _pubId)
+{
+  boost::mutex::scoped_lock lock(this->callbackMutex);
+  return this->SerializedPrevMsg(_pubId);
+}
+
+//////////////////////////////////////////////////
+boost::shared_ptr<const std::string> Publication::SerializedMsg(
+    const MessagePtr &_msg)
+{
+  // The message being sent is usually the latest message of its
+  // publisher, which latching subscriptions and Publisher::GetPrevMsg
+  // also need in serialized form.
+  for (auto const &prev : this->prevMsgs)
+  {
+    if (prev.second == _msg)
+      return this->SerializedPrevMsg(prev.first);
+  }
+
+  boost::shared_ptr<std::string> data(new std::string);
+  _msg->SerializeToString(data.get());
+  return data;
+}
+
+//////////////////////////////////////////////////
+boost::shared_ptr<const std::string> Publication::SerializedPrevMsg(
+    uint32_t _pubId)
+{
+  {
+    std::lock_guard<std::mutex> dataLock(gPrevMsgDataMutex);
+    PrevMsgData &prevMsgData = gPrevMsgData[this];
+    auto dataIter = prevMsgData.find(_pubId);
+    if (dataIter != prevMsgData.end())
+      return dataIter->second;
+  }
+
+  auto msgIter = this->prevMsgs.find(_pubId);
+  if (msgIter == this->prevMsgs.end() || !msgIter->second)
+    return boost::shared_ptr<const std::string>();
+
+  // Serialize outside of gPrevMsgDataMutex. The callbackMutex held by the
+  // caller keeps the previous message from changing meanwhile.
+  boost::shared_ptr<std::string> data(new std::string);
+  msgIter->second->SerializeToString(data.get());
+
+  std::lock_guard<std::mutex> dataLock(gPrevMsgDataMutex);
+  gPrevMsgData[this][_pubId] = data;
+  return data;
+}
+
@@ -146,6 +146,15 @@ namespace gazebo
       /// previous message.
       public: MessagePtr GetPrevMsg(uint32_t _pubId);
 
+      /// \brief Get the serialized previous message of a publisher. The
+      /// message is serialized at most once, and the returned buffer is
+      /// shared with the remote subscribers and latched subscriptions.
+      /// \param[in] _pubId ID of the publisher.
+      /// \return The serialized previous message. NULL if there is no
+      /// previous message.
+      public: boost::shared_ptr<const std::string> GetPrevMsgData(
+                  uint32_t _pubId);
+
       /// \brief Clear all previous messages for a publisher.
       public: void ClearPrevMsgs();
 
@@ -167,6 +176,21 @@ namespace gazebo
       /// \brief Remove nodes that have been marked for removal
       private: void RemoveNodes();
 
+      /// \brief Serialize a message, reusing the serialized previous
+      /// message of its publisher when possible. The callbackMutex must
+      /// be locked by the caller.
+      /// \param[in] _msg Message to serialize.
+      /// \return The serialized message.
+      private: boost::shared_ptr<const std::string> SerializedMsg(
+                   const MessagePtr &_msg);
+
+      /// \brief Serialize the previous message of a publisher once, and
+      /// cache the result. The callbackMutex must be locked by the caller.
+      /// \param[in] _pubId ID of the publisher.
+      /// \return The serialized previous message, or NULL.
+      private: boost::shared_ptr<const std::string> SerializedPrevMsg(
+                   uint32_t _pubId);
+
       /// \brief Unique if of the publication.
       private: unsigned int id;
 
@@ -16,9 +16,17 @@
 */
 #include <boost/bind.hpp>
 #include <boost/function.hpp>
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
 #include "gazebo/transport/TopicManager.hh"
 #include "gazebo/transport/ConnectionManager.hh"
 #include "gazebo/transport/PublicationTransport.hh"
+#include "gazebo/transport/SharedMemoryRing.hh"
 #include "gazebo/common/WeakBind.hh"
 
 using namespace gazebo;
@@ -26,18 +34,129 @@ using namespace transport;
 
 int PublicationTransport::counter = 0;
 
+/// \brief Size of the shared memory ring of a subscription, in bytes.
+static const uint64_t kSharedMemoryRingSize = 32 * 1024 * 1024;
+
+/// \brief Time to wait for a message in the shared memory ring before
+/// checking whether the ring was closed, in milliseconds.
+static const unsigned int kSharedMemoryReadTimeout = 100;
+
+namespace gazebo
+{
+  namespace transport
+  {
+    /// \internal
+    /// \brief Private data for the PublicationTransport class.
+    class PublicationTransportPrivate
+    {
+      /// \brief Protects the callback, and the order of the messages.
+      /// It is held while messages are passed along, so that the messages
+      /// of the connection and of the ring are passed one at a time.
+      public: std::mutex mutex;
+
+      /// \brief Signaled when a message of the connection was passed
+      /// along.
+      public: std::condition_variable connectionCond;
+
+      /// \brief Shared memory ring used by a publisher on the same host.
+      public: std::unique_ptr<SharedMemoryRing> ring;
+
+      /// \brief Thread that reads from the shared memory ring.
+      public: std::thread ringThread;
+
+      /// \brief Number of messages of the connection passed along.
+      public: uint64_t connectionCount = 0;
+
+      /// \brief True if ringData holds a message of the ring that was
+      /// published after a message of the connection not received yet.
+      public: bool ringPending = false;
+
+      /// \brief Message read from the ring, see ringPending.
+      public: std::string ringData;
+
+      /// \brief Number of messages the publisher sent through the
+      /// connection before ringData.
+      public: uint64_t ringTag = 0;
+    };
+  }
+}
+
+// TODO added here for ABI compatibility
+// move to a private data pointer in PublicationTransport when merging
+// forward.
+static std::map<const PublicationTransport *,
+    std::unique_ptr<PublicationTransportPrivate>> gPublicationData;
+
+/// \brief Mutex that protects gPublicationData.
+static std::mutex gPublicationDataMutex;
+
+/////////////////////////////////////////////////
+/// \brief Get the private data of a publication transport.
+/// \param[in] _pub The publication transport.
+/// \return The private data, which lives as long as the transport.
+static PublicationTransportPrivate *publicationData(
+    const PublicationTransport *_pub)
+{
+  std::lock_guard<std::mutex> lock(gPublicationDataMutex);
+  return gPublicationData.find(_pub)->second.get();
+}
+
+/////////////////////////////////////////////////
+/// \brief Pass along the messages of the ring that were published before
+/// the next message of the connection. The mutex of the private data must
+/// be locked.
+/// \param[in] _data Private data of the publication transport.
+/// \param[in] _cb Callback that receives the messages.
+static void deliverRing(PublicationTransportPrivate &_data,
+    const boost::function<void (const std::string &)> &_cb)
+{
+  if (!_data.ring)
+    return;
+
+  while (true)
+  {
+    if (!_data.ringPending)
+    {
+      _data.ringPending =
+        _data.ring->Read(_data.ringData, _data.ringTag, 0);
+    }
+
+    if (!_data.ringPending || _data.ringTag > _data.connectionCount)
+      return;
+
+    _data.ringPending = false;
+    if (_cb && !_data.ringData.empty())
+      _cb(_data.ringData);
+  }
+}
+
 /////////////////////////////////////////////////
 PublicationTransport::PublicationTransport(const std::string &_topic,
                                            const std::string &_msgType)
 : topic(_topic), msgType(_msgType)
 {
   this->id = counter++;
+
+  {
+    std::lock_guard<std::mutex> lock(gPublicationDataMutex);
+    gPublicationData[this].reset(new PublicationTransportPrivate);
+  }
+
   TopicManager::Instance()->UpdatePublications(this->topic, this->msgType);
 }
 
 /////////////////////////////////////////////////
 PublicationTransport::~PublicationTransport()
 {
+  PublicationTransportPrivate *data = publicationData(this);
+  if (data->ring)
+  {
+    data->ring->Close();
+    if (data->ringThread.joinable())
+      data->ringThread.join();
+    data->ring.reset();
+  }
+
   if (this->connection)
   {
     msgs::Subscribe sub;
@@ -52,10 +171,20 @@ PublicationTransport::~PublicationTransport()
     ConnectionManager::Instance()->RemoveConnection(this->connection);
   }
   this->callback.clear();
+
+  std::lock_guard<std::mutex> lock(gPublicationDataMutex);
+  gPublicationData.erase(this);
 }
 
 /////////////////////////////////////////////////
 void PublicationTransport::Init(const ConnectionPtr &_conn, bool _latched)
+{
+  this->Init(_conn, _latched, "");
+}
+
+/////////////////////////////////////////////////
+void PublicationTransport::Init(const ConnectionPtr &_conn, bool _latched,
+    const std::string &_hostId)
 {
   this->connection = _conn;
   msgs::Subscribe sub;
@@ -65,6 +194,24 @@ void PublicationTransport::Init(const ConnectionPtr &_conn, bool _latched)
   sub.set_port(this->connection->GetLocalPort());
   sub.set_latching(_latched);
 
+  // Offer a shared memory ring to a publisher on the same host. The
+  // connection is still read, since the publisher falls back to it when
+  // it can't open the ring, or for messages that don't fit in the ring.
+  PublicationTransportPrivate *data = publicationData(this);
+  if (!_hostId.empty() && _hostId == SharedMemoryRing::HostId() &&
+      SharedMemoryRing::UseFor(this->msgType))
+  {
+    std::unique_ptr<SharedMemoryRing> newRing(new SharedMemoryRing());
+    if (newRing->Create(SharedMemoryRing::UniqueName(),
+          kSharedMemoryRingSize))
+    {
+      sub.set_shm_name(newRing->Name());
+      data->ring = std::move(newRing);
+      data->ringThread = std::thread(&PublicationTransport::RunSharedMemory,
+          this);
+    }
+  }
+
   this->connection->EnqueueMsg(msgs::Package("sub", sub));
 
   // Put this in PublicationTransportPtr
@@ -78,9 +225,34 @@ void PublicationTransport::Init(const ConnectionPtr &_conn, bool _latched)
 void PublicationTransport::AddCallback(
     const boost::function<void(const std::string &)> &cb_)
 {
+  std::lock_guard<std::mutex> lock(publicationData(this)->mutex);
   this->callback = cb_;
 }
 
+/////////////////////////////////////////////////
+void PublicationTransport::RunSharedMemory()
+{
+  PublicationTransportPrivate *data = publicationData(this);
+  while (data->ring->IsOpen())
+  {
+    {
+      std::unique_lock<std::mutex> lock(data->mutex);
+      deliverRing(*data, this->callback);
+
+      // The next message of the ring was published after a message of
+      // the connection that has not been received yet.
+      if (data->ringPending)
+      {
+        data->connectionCond.wait_for(lock,
+            std::chrono::milliseconds(kSharedMemoryReadTimeout));
+        continue;
+      }
+    }
+
+    data->ring->Wait(kSharedMemoryReadTimeout);
+  }
+}
+
 /////////////////////////////////////////////////
 void PublicationTransport::OnPublish(const std::string &_data)
 {
@@ -92,8 +264,22 @@ void PublicationTransport::OnPublish(const std::string &_data)
 
     if (!_data.empty())
     {
-      if (this->callback)
-        (this->callback)(_data);
+      PublicationTransportPrivate *data = publicationData(this);
+      {
+        std::lock_guard<std::mutex> lock(data->mutex);
+
+        // The messages of the ring that were published before this one
+        // were written into the ring before this one was sent, so they
+        // can all be read now.
+        deliverRing(*data, this->callback);
+
+        if (this->callback)
+          (this->callback)(_data);
+        ++data->connectionCount;
+
+        deliverRing(*data, this->callback);
+      }
+      data->connectionCond.notify_all();
     }
   }
 }
@@ -119,6 +305,10 @@ std::string PublicationTransport::GetMsgType() const
 /////////////////////////////////////////////////
 void PublicationTransport::Fini()
 {
+  PublicationTransportPrivate *data = publicationData(this);
+  if (data->ring)
+    data->ring->Close();
+
   /// Cancel all async operatiopns.
   if (this->connection)
   {
@@ -55,6 +55,17 @@ namespace gazebo
       /// topic.
       public: void Init(const ConnectionPtr &_conn, bool _latched);
 
+      /// \brief Initialize the transport
+      /// \param[in] _conn The underlying connection.
+      /// \param[in] _latched True to grab the last message sent on the
+      /// topic.
+      /// \param[in] _hostId Host id advertised by the publisher. If it
+      /// matches SharedMemoryRing::HostId(), the publisher is asked to
+      /// send large sensor messages through shared memory instead of the
+      /// connection.
+      public: void Init(const ConnectionPtr &_conn, bool _latched,
+                  const std::string &_hostId);
+
       /// \brief Finalize the transport
       public: void Fini();
 
@@ -79,6 +90,10 @@ namespace gazebo
       /// \param[in] _data Data to be published.
       private: void OnPublish(const std::string &_data);
 
+      /// \brief Read messages from the shared memory ring until it is
+      /// closed, and pass them along in the order they were published.
+      private: void RunSharedMemory();
+
       /// \brief The topic for this publication transport.
       private: std::string topic;
 
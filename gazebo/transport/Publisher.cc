@@ -332,9 +332,10 @@ std::string Publisher::GetPrevMsg() const
   std::string result;
   if (this->publication)
   {
-    MessagePtr msg = this->publication->GetPrevMsg(this->id);
-    if (msg)
-      msg->SerializeToString(&result);
+    boost::shared_ptr<const std::string> data =
+      this->publication->GetPrevMsgData(this->id);
+    if (data)
+      result = *data;
   }
 
   return result;
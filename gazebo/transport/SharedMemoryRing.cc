@@ -0,0 +1,551 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+#include <boost/asio/ip/host_name.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <boost/interprocess/shared_memory_object.hpp>
+
+#ifndef _WIN32
+  #include <dirent.h>
+  #include <signal.h>
+  #include <unistd.h>
+#endif
+
+#include "gazebo/common/Console.hh"
+#include "gazebo/transport/SharedMemoryRing.hh"
+
+using namespace gazebo;
+using namespace transport;
+
+namespace ipc = boost::interprocess;
+
+/// \brief Marks an initialized ring ("GZSHMRN2"). The last character is
+/// the version of the layout of the control block.
+static const uint64_t kRingMagic = 0x324e524d4853415aULL;
+
+/// \brief Size of the prefix of each message: its length, followed by
+/// its tag.
+static const uint64_t kPrefixSize = sizeof(uint32_t) + sizeof(uint64_t);
+
+/// \brief Prefix of the names created by UniqueName. It is followed by
+/// the id of the process that created the segment.
+static const char kNamePrefix[] = "gazebo_shm_";
+
+namespace gazebo
+{
+  namespace transport
+  {
+    /// \internal
+    /// \brief Control block at the start of the shared memory segment.
+    /// The message data follows it.
+    ///
+    /// The ring holds no lock, so that an end that dies can't block the
+    /// other one: only the writer moves writePos, and only the reader moves
+    /// readPos. A position is stored after the bytes it covers are copied,
+    /// and loaded before they are, so each end sees complete messages and
+    /// free space only.
+    struct SharedMemoryRingHeader
+    {
+      /// \brief Set to kRingMagic once the ring is initialized.
+      uint64_t magic;
+
+      /// \brief Size of the data area in bytes.
+      uint64_t capacity;
+
+      /// \brief Total number of bytes read.
+      std::atomic<uint64_t> readPos;
+
+      /// \brief Total number of bytes written.
+      std::atomic<uint64_t> writePos;
+
+      /// \brief True once one end has closed the ring.
+      std::atomic<bool> closed;
+    };
+
+    /// \internal
+    /// \brief Private data for SharedMemoryRing.
+    class SharedMemoryRingPrivate
+    {
+      /// \brief Name of the shared memory segment.
+      public: std::string name;
+
+      /// \brief True if this object created the segment.
+      public: bool owner = false;
+
+      /// \brief Mapping of the segment.
+      public: ipc::mapped_region region;
+
+      /// \brief Control block, inside the mapping.
+      public: SharedMemoryRingHeader *header = nullptr;
+
+      /// \brief Data area, inside the mapping.
+      public: char *data = nullptr;
+
+      /// \brief Size of the data area, read once when the ring is created
+      /// or opened, so that the other end can't change it.
+      public: uint64_t capacity = 0;
+    };
+  }
+}
+
+/// \brief Longest sleep between two checks of the other end of a ring.
+static const std::chrono::microseconds kMaxPollDelay(1000);
+
+/// \internal
+/// \brief Sleeps for a growing delay until a deadline, between the checks
+/// of a ring.
+class RingPoll
+{
+  /// \brief Constructor.
+  /// \param[in] _timeoutMs Time to wait in total, in milliseconds.
+  public: explicit RingPoll(const unsigned int _timeoutMs)
+    : deadline(std::chrono::steady_clock::now() +
+               std::chrono::milliseconds(_timeoutMs))
+  {
+  }
+
+  /// \brief Sleep until the next check.
+  /// \return False if the deadline has passed.
+  public: bool Sleep()
+  {
+    const auto now = std::chrono::steady_clock::now();
+    if (now >= this->deadline)
+      return false;
+
+    std::this_thread::sleep_for(std::min<std::chrono::steady_clock::duration>(
+        this->delay, this->deadline - now));
+    this->delay = std::min(this->delay * 2, kMaxPollDelay);
+    return true;
+  }
+
+  /// \brief Time at which to stop waiting.
+  private: std::chrono::steady_clock::time_point deadline;
+
+  /// \brief Delay of the next sleep.
+  private: std::chrono::microseconds delay{10};
+};
+
+/////////////////////////////////////////////////
+/// \brief Offset of the data area from the start of the segment.
+static uint64_t DataOffset()
+{
+  const uint64_t align = 64;
+  return (sizeof(SharedMemoryRingHeader) + align - 1) / align * align;
+}
+
+
+/////////////////////////////////////////////////
+/// \brief Remove the segments created by processes that no longer run.
+/// A segment is removed by the publisher as soon as it opens it, so only
+/// the segments of subscribers that stopped before their publisher opened
+/// them are left behind.
+static void RemoveStaleSegments()
+{
+#ifdef __linux__
+  DIR *dir = opendir("/dev/shm");
+  if (!dir)
+    return;
+
+  const std::size_t prefixSize = sizeof(kNamePrefix) - 1;
+  for (struct dirent *entry = readdir(dir); entry; entry = readdir(dir))
+  {
+    const std::string name = entry->d_name;
+    if (name.compare(0, prefixSize, kNamePrefix) != 0)
+      continue;
+
+    char *end = nullptr;
+    const long pid = std::strtol(name.c_str() + prefixSize, &end, 10);
+    if (pid <= 0 || *end != '_')
+      continue;
+
+    if (kill(static_cast<pid_t>(pid), 0) != 0 && errno == ESRCH)
+    {
+      gzlog << "Removing stale shared memory segment[" << name << "]\n";
+      ipc::shared_memory_object::remove(name.c_str());
+    }
+  }
+  closedir(dir);
+#endif
+}
+
+/////////////////////////////////////////////////
+SharedMemoryRing::SharedMemoryRing()
+  : dataPtr(new SharedMemoryRingPrivate)
+{
+}
+
+/////////////////////////////////////////////////
+SharedMemoryRing::~SharedMemoryRing()
+{
+  this->Close();
+  if (this->dataPtr->owner)
+    ipc::shared_memory_object::remove(this->dataPtr->name.c_str());
+}
+
+/////////////////////////////////////////////////
+bool SharedMemoryRing::Create(const std::string &_name,
+    const uint64_t _capacity)
+{
+  RemoveStaleSegments();
+
+  if (_capacity <= kPrefixSize)
+  {
+    gzwarn << "Shared memory ring[" << _name << "] is too small\n";
+    return false;
+  }
+
+  try
+  {
+    ipc::shared_memory_object::remove(_name.c_str());
+    ipc::shared_memory_object shm(ipc::create_only, _name.c_str(),
+        ipc::read_write);
+    this->dataPtr->name = _name;
+    this->dataPtr->owner = true;
+
+    shm.truncate(DataOffset() + _capacity);
+    this->dataPtr->region = ipc::mapped_region(shm, ipc::read_write);
+  }
+  catch(ipc::interprocess_exception &_e)
+  {
+    gzwarn << "Unable to create shared memory segment[" << _name << "]: "
+      << _e.what() << std::endl;
+    return false;
+  }
+
+  char *base = static_cast<char *>(this->dataPtr->region.get_address());
+  SharedMemoryRingHeader *header = new (base) SharedMemoryRingHeader;
+
+  // The positions are shared between processes, which only works if they
+  // don't need a lock.
+  if (!header->readPos.is_lock_free() || !header->closed.is_lock_free())
+  {
+    gzwarn << "Shared memory rings need lock free atomics\n";
+    this->dataPtr->region = ipc::mapped_region();
+    return false;
+  }
+
+  header->capacity = _capacity;
+  header->readPos = 0;
+  header->writePos = 0;
+  header->closed = false;
+  std::atomic_thread_fence(std::memory_order_release);
+  header->magic = kRingMagic;
+
+  this->dataPtr->header = header;
+  this->dataPtr->data = base + DataOffset();
+  this->dataPtr->capacity = _capacity;
+
+  return true;
+}
+
+/////////////////////////////////////////////////
+bool SharedMemoryRing::Open(const std::string &_name)
+{
+  try
+  {
+    ipc::shared_memory_object shm(ipc::open_only, _name.c_str(),
+        ipc::read_write);
+    this->dataPtr->region = ipc::mapped_region(shm, ipc::read_write);
+  }
+  catch(ipc::interprocess_exception &_e)
+  {
+    gzlog << "Unable to open shared memory segment[" << _name << "]: "
+      << _e.what() << std::endl;
+    return false;
+  }
+
+  this->dataPtr->name = _name;
+  char *base = static_cast<char *>(this->dataPtr->region.get_address());
+  SharedMemoryRingHeader *header =
+    reinterpret_cast<SharedMemoryRingHeader *>(base);
+
+  const uint64_t regionSize = this->dataPtr->region.get_size();
+  if (regionSize < DataOffset() || header->magic != kRingMagic)
+  {
+    gzwarn << "Invalid shared memory segment[" << _name << "]\n";
+    this->dataPtr->region = ipc::mapped_region();
+    return false;
+  }
+  std::atomic_thread_fence(std::memory_order_acquire);
+
+  const uint64_t capacity = header->capacity;
+  if (capacity <= kPrefixSize || capacity > regionSize - DataOffset())
+  {
+    gzwarn << "Invalid shared memory segment[" << _name << "]\n";
+    this->dataPtr->region = ipc::mapped_region();
+    return false;
+  }
+
+  this->dataPtr->header = header;
+  this->dataPtr->data = base + DataOffset();
+  this->dataPtr->capacity = capacity;
+
+  // Both ends have mapped the segment, so its name is no longer needed.
+  // Removing it now frees the segment once both ends unmap it, even if
+  // one of them crashes.
+  ipc::shared_memory_object::remove(_name.c_str());
+  return true;
+}
+
+/////////////////////////////////////////////////
+void SharedMemoryRing::Close()
+{
+  SharedMemoryRingHeader *header = this->dataPtr->header;
+  if (!header)
+    return;
+
+  header->closed.store(true, std::memory_order_release);
+}
+
+/////////////////////////////////////////////////
+bool SharedMemoryRing::IsOpen() const
+{
+  SharedMemoryRingHeader *header = this->dataPtr->header;
+  return header && !header->closed.load(std::memory_order_acquire);
+}
+
+/////////////////////////////////////////////////
+std::string SharedMemoryRing::Name() const
+{
+  return this->dataPtr->name;
+}
+
+/////////////////////////////////////////////////
+uint64_t SharedMemoryRing::MaxMessageSize() const
+{
+  if (!this->dataPtr->header)
+    return 0;
+  return this->dataPtr->capacity - kPrefixSize;
+}
+
+/////////////////////////////////////////////////
+/// \brief Copy bytes into the ring, wrapping around its end.
+static void CopyIn(char *_ring, const uint64_t _capacity, const uint64_t _pos,
+    const char *_src, const uint64_t _size)
+{
+  uint64_t start = _pos % _capacity;
+  uint64_t first = std::min(_size, _capacity - start);
+  std::memcpy(_ring + start, _src, first);
+  std::memcpy(_ring, _src + first, _size - first);
+}
+
+/////////////////////////////////////////////////
+/// \brief Copy bytes out of the ring, wrapping around its end.
+static void CopyOut(const char *_ring, const uint64_t _capacity,
+    const uint64_t _pos, char *_dst, const uint64_t _size)
+{
+  uint64_t start = _pos % _capacity;
+  uint64_t first = std::min(_size, _capacity - start);
+  std::memcpy(_dst, _ring + start, first);
+  std::memcpy(_dst + first, _ring, _size - first);
+}
+
+/////////////////////////////////////////////////
+bool SharedMemoryRing::Write(const std::string &_data, const uint64_t _tag,
+    const unsigned int _timeoutMs)
+{
+  SharedMemoryRingHeader *header = this->dataPtr->header;
+  if (!header || _data.size() > this->MaxMessageSize() ||
+      _data.size() > UINT32_MAX)
+  {
+    return false;
+  }
+
+  const uint64_t capacity = this->dataPtr->capacity;
+  const uint64_t size = kPrefixSize + _data.size();
+  const uint64_t pos = header->writePos.load(std::memory_order_relaxed);
+
+  // Wait for enough free space. Only the writer moves writePos, so the
+  // space can't shrink once found.
+  RingPoll poll(_timeoutMs);
+  while (true)
+  {
+    if (header->closed.load(std::memory_order_acquire))
+      return false;
+
+    const uint64_t used =
+      pos - header->readPos.load(std::memory_order_acquire);
+    if (used > capacity)
+    {
+      gzerr << "Corrupt shared memory ring[" << this->dataPtr->name
+        << "], closing it\n";
+      this->Close();
+      return false;
+    }
+
+    if (capacity - used >= size)
+      break;
+
+    if (!poll.Sleep())
+      return false;
+  }
+
+  char prefix[kPrefixSize];
+  const uint32_t length = static_cast<uint32_t>(_data.size());
+  std::memcpy(prefix, &length, sizeof(length));
+  std::memcpy(prefix + sizeof(length), &_tag, sizeof(_tag));
+  CopyIn(this->dataPtr->data, capacity, pos, prefix, kPrefixSize);
+  CopyIn(this->dataPtr->data, capacity, pos + kPrefixSize,
+      _data.data(), _data.size());
+
+  header->writePos.store(pos + size, std::memory_order_release);
+  return true;
+}
+
+/////////////////////////////////////////////////
+bool SharedMemoryRing::Wait(const unsigned int _timeoutMs) const
+{
+  SharedMemoryRingHeader *header = this->dataPtr->header;
+  if (!header)
+    return false;
+
+  RingPoll poll(_timeoutMs);
+  while (!header->closed.load(std::memory_order_acquire))
+  {
+    if (header->writePos.load(std::memory_order_acquire) !=
+        header->readPos.load(std::memory_order_relaxed))
+    {
+      return true;
+    }
+
+    if (!poll.Sleep())
+      return false;
+  }
+  return false;
+}
+
+/////////////////////////////////////////////////
+bool SharedMemoryRing::Read(std::string &_data, uint64_t &_tag,
+    const unsigned int _timeoutMs)
+{
+  SharedMemoryRingHeader *header = this->dataPtr->header;
+  if (!header)
+    return false;
+
+  const uint64_t capacity = this->dataPtr->capacity;
+  const uint64_t pos = header->readPos.load(std::memory_order_relaxed);
+
+  // Wait for a message. Only the reader moves readPos, so the message
+  // can't be overwritten until it has been copied out.
+  uint64_t available = 0;
+  RingPoll poll(_timeoutMs);
+  while (true)
+  {
+    if (header->closed.load(std::memory_order_acquire))
+      return false;
+
+    available = header->writePos.load(std::memory_order_acquire) - pos;
+    if (available > 0)
+      break;
+
+    if (!poll.Sleep())
+      return false;
+  }
+
+  // The other end controls the prefix, so the message must lie within
+  // the bytes that were written, which the ring holds.
+  char prefix[kPrefixSize];
+  uint32_t length = 0;
+  if (available <= capacity && available >= kPrefixSize)
+  {
+    CopyOut(this->dataPtr->data, capacity, pos, prefix, kPrefixSize);
+    std::memcpy(&length, prefix, sizeof(length));
+  }
+  if (available > capacity || available < kPrefixSize ||
+      length > available - kPrefixSize)
+  {
+    gzerr << "Corrupt shared memory ring[" << this->dataPtr->name
+      << "], closing it\n";
+    this->Close();
+    return false;
+  }
+
+  std::memcpy(&_tag, prefix + sizeof(length), sizeof(_tag));
+  _data.resize(length);
+  if (length > 0)
+  {
+    CopyOut(this->dataPtr->data, capacity, pos + kPrefixSize,
+        &_data[0], length);
+  }
+
+  header->readPos.store(pos + kPrefixSize + length,
+      std::memory_order_release);
+  return true;
+}
+
+/////////////////////////////////////////////////
+std::string SharedMemoryRing::HostId()
+{
+  static const std::string hostId = []()
+  {
+    const char *env = std::getenv("GAZEBO_SHM_TRANSPORT");
+    if (env && std::string(env) == "0")
+      return std::string();
+
+#ifdef __linux__
+    // The boot id changes on every boot, and is shared by all the
+    // processes of the host. The host name tells apart containers that
+    // share the kernel but not necessarily /dev/shm.
+    std::ifstream bootIdFile("/proc/sys/kernel/random/boot_id");
+    std::string bootId;
+    if (!std::getline(bootIdFile, bootId) || bootId.empty())
+      return std::string();
+
+    boost::system::error_code ec;
+    std::string hostName = boost::asio::ip::host_name(ec);
+    return bootId + "/" + hostName;
+#else
+    return std::string();
+#endif
+  }();
+
+  return hostId;
+}
+
+/////////////////////////////////////////////////
+bool SharedMemoryRing::UseFor(const std::string &_msgType)
+{
+  return _msgType == "gazebo.msgs.Image" ||
+         _msgType == "gazebo.msgs.ImageStamped" ||
+         _msgType == "gazebo.msgs.ImagesStamped" ||
+         _msgType == "gazebo.msgs.PointCloud" ||
+         _msgType == "gazebo.msgs.LaserScanStamped";
+}
+
+/////////////////////////////////////////////////
+std::string SharedMemoryRing::UniqueName()
+{
+  static std::atomic<unsigned int> counter(0);
+
+  std::ostringstream stream;
+  stream << kNamePrefix;
+#ifndef _WIN32
+  stream << getpid() << "_";
+#endif
+  stream << std::hex << reinterpret_cast<uintptr_t>(&counter) << "_"
+    << std::dec << counter++;
+  return stream.str();
+}
@@ -0,0 +1,137 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#ifndef GAZEBO_TRANSPORT_SHAREDMEMORYRING_HH_
+#define GAZEBO_TRANSPORT_SHAREDMEMORYRING_HH_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "gazebo/util/system.hh"
+
+namespace gazebo
+{
+  namespace transport
+  {
+    // Forward declare private data.
+    class SharedMemoryRingPrivate;
+
+    /// \internal
+    /// \brief A single producer, single consumer ring buffer of messages
+    /// in a named shared memory segment. It is used in place of a TCP
+    /// connection to send the messages of a topic to a subscriber that
+    /// runs on the same host as the publisher.
+    ///
+    /// The subscriber creates the ring, and sends its name to the
+    /// publisher in the "sub" handshake. The publisher then opens the
+    /// ring, which removes its name, and writes its messages into it. If
+    /// the ring can't be opened (e.g. the processes don't share /dev/shm),
+    /// the TCP connection is used instead.
+    ///
+    /// Each message is stored with a tag. The transport uses it to tell
+    /// how many messages were sent through the TCP connection before the
+    /// message, so that the subscriber receives the messages of both paths
+    /// in the order they were published.
+    class GZ_TRANSPORT_VISIBLE SharedMemoryRing
+    {
+      /// \brief Constructor.
+      public: SharedMemoryRing();
+
+      /// \brief Destructor. Closes the ring, and removes the shared
+      /// memory segment if it was created by this object.
+      public: ~SharedMemoryRing();
+
+      /// \brief Create a new ring. This first removes the segments left
+      /// behind by processes that stopped before their ring was opened.
+      /// \param[in] _name Name of the shared memory segment.
+      /// \param[in] _capacity Size of the ring in bytes.
+      /// \return True on success.
+      public: bool Create(const std::string &_name, const uint64_t _capacity);
+
+      /// \brief Open a ring created by another process. The name of the
+      /// segment is removed once it is open, so that the segment is freed
+      /// when both ends unmap it, even if one of them crashes.
+      /// \param[in] _name Name of the shared memory segment.
+      /// \return True on success.
+      public: bool Open(const std::string &_name);
+
+      /// \brief Close the ring. Pending and future reads and writes on
+      /// both ends of the ring fail.
+      public: void Close();
+
+      /// \brief Is the ring open on both ends?
+      /// \return True if neither end has closed the ring.
+      public: bool IsOpen() const;
+
+      /// \brief Get the name of the shared memory segment.
+      /// \return Name of the segment.
+      public: std::string Name() const;
+
+      /// \brief Get the size of the largest message the ring can hold.
+      /// \return Size in bytes.
+      public: uint64_t MaxMessageSize() const;
+
+      /// \brief Write a message into the ring.
+      /// \param[in] _data The message.
+      /// \param[in] _tag Value stored with the message, and returned by
+      /// Read.
+      /// \param[in] _timeoutMs Time to wait for free space, in milliseconds.
+      /// Zero returns at once if the ring is full.
+      /// \return True if the message was written, false if the ring is
+      /// closed, the message is too large, or the ring stayed full.
+      public: bool Write(const std::string &_data, const uint64_t _tag,
+                         const unsigned int _timeoutMs);
+
+      /// \brief Wait for a message to be written into the ring, without
+      /// reading it.
+      /// \param[in] _timeoutMs Time to wait for a message, in milliseconds.
+      /// \return True if a message can be read.
+      public: bool Wait(const unsigned int _timeoutMs) const;
+
+      /// \brief Read a message from the ring.
+      /// \param[out] _data The message.
+      /// \param[out] _tag The tag the message was written with.
+      /// \param[in] _timeoutMs Time to wait for a message, in milliseconds.
+      /// \return True if a message was read. False if there was none, or if
+      /// the ring is closed or corrupt. A corrupt ring is closed.
+      public: bool Read(std::string &_data, uint64_t &_tag,
+                        const unsigned int _timeoutMs);
+
+      /// \brief Get an identifier of the host, used to find out if a
+      /// publisher and a subscriber can share memory.
+      /// \return The identifier, or an empty string if shared memory
+      /// transport is not supported or disabled with
+      /// GAZEBO_SHM_TRANSPORT=0.
+      public: static std::string HostId();
+
+      /// \brief Check if messages of a given type are sent through
+      /// shared memory to subscribers on the same host.
+      /// \param[in] _msgType Type of the messages.
+      /// \return True for large sensor messages.
+      public: static bool UseFor(const std::string &_msgType);
+
+      /// \brief Create a unique name for a new ring.
+      /// \return A shared memory segment name.
+      public: static std::string UniqueName();
+
+      /// \internal
+      /// \brief Private data pointer.
+      private: std::unique_ptr<SharedMemoryRingPrivate> dataPtr;
+    };
+  }
+}
+#endif
@@ -0,0 +1,232 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <gtest/gtest.h>
+#include <boost/interprocess/mapped_region.hpp>
+#include <boost/interprocess/shared_memory_object.hpp>
+#include <cstring>
+#include <string>
+#include <thread>
+
+#ifdef __linux__
+  #include <sys/wait.h>
+  #include <unistd.h>
+#endif
+
+#include "gazebo/transport/SharedMemoryRing.hh"
+#include "test/util.hh"
+
+using namespace gazebo;
+
+class SharedMemoryRing : public gazebo::testing::AutoLogFixture { };
+
+/////////////////////////////////////////////////
+TEST_F(SharedMemoryRing, WriteRead)
+{
+  transport::SharedMemoryRing writer, reader;
+  std::string name = transport::SharedMemoryRing::UniqueName();
+
+  ASSERT_TRUE(reader.Create(name, 64));
+  ASSERT_TRUE(writer.Open(name));
+  EXPECT_TRUE(writer.IsOpen());
+  EXPECT_EQ(name, writer.Name());
+  EXPECT_EQ(52u, writer.MaxMessageSize());
+
+  std::string data;
+  uint64_t tag = 0;
+  EXPECT_FALSE(reader.Wait(0));
+  EXPECT_FALSE(reader.Read(data, tag, 0));
+
+  // Fill the ring, wrapping around its end
+  for (int i = 0; i < 10; ++i)
+  {
+    std::string msg(20 + i, 'a' + i);
+    EXPECT_TRUE(writer.Write(msg, 1000 + i, 0));
+    EXPECT_TRUE(reader.Wait(0));
+    EXPECT_TRUE(reader.Read(data, tag, 0));
+    EXPECT_EQ(msg, data);
+    EXPECT_EQ(1000u + i, tag);
+  }
+
+  // Too large, and no space
+  EXPECT_FALSE(writer.Write(std::string(53, 'x'), 0, 0));
+  EXPECT_TRUE(writer.Write(std::string(30, 'x'), 0, 0));
+  EXPECT_FALSE(writer.Write(std::string(20, 'y'), 0, 10));
+  EXPECT_TRUE(reader.Read(data, tag, 0));
+  EXPECT_EQ(std::string(30, 'x'), data);
+  EXPECT_TRUE(writer.Write(std::string(20, 'y'), 0, 0));
+
+  // Closing one end closes both
+  reader.Close();
+  EXPECT_FALSE(writer.IsOpen());
+  EXPECT_FALSE(writer.Write("z", 0, 0));
+  EXPECT_FALSE(reader.Wait(0));
+  EXPECT_FALSE(reader.Read(data, tag, 0));
+}
+
+/////////////////////////////////////////////////
+TEST_F(SharedMemoryRing, OpenRemovesName)
+{
+  transport::SharedMemoryRing writer, reader, other;
+  std::string name = transport::SharedMemoryRing::UniqueName();
+
+  ASSERT_TRUE(reader.Create(name, 64));
+  ASSERT_TRUE(writer.Open(name));
+
+  // The segment can't be opened again, but both ends still use it
+  EXPECT_FALSE(other.Open(name));
+  std::string data;
+  uint64_t tag = 0;
+  EXPECT_TRUE(writer.Write("a", 7, 0));
+  EXPECT_TRUE(reader.Read(data, tag, 0));
+  EXPECT_EQ("a", data);
+  EXPECT_EQ(7u, tag);
+}
+
+/////////////////////////////////////////////////
+TEST_F(SharedMemoryRing, CorruptLength)
+{
+  namespace ipc = boost::interprocess;
+  transport::SharedMemoryRing writer, reader;
+  std::string name = transport::SharedMemoryRing::UniqueName();
+
+  ASSERT_TRUE(reader.Create(name, 64));
+
+  // Map the segment before the writer removes its name
+  ipc::shared_memory_object shm(ipc::open_only, name.c_str(),
+      ipc::read_write);
+  ipc::mapped_region region(shm, ipc::read_write);
+  ASSERT_TRUE(writer.Open(name));
+
+  // Find the prefix of a message from its tag, and claim the message is
+  // longer than the bytes written
+  const uint64_t tag = 0x1122334455667788ULL;
+  ASSERT_TRUE(writer.Write("abc", tag, 0));
+  char *base = static_cast<char *>(region.get_address());
+  char *tagPos = nullptr;
+  for (std::size_t i = sizeof(uint32_t);
+       i + sizeof(tag) <= region.get_size(); ++i)
+  {
+    if (std::memcmp(base + i, &tag, sizeof(tag)) == 0)
+      tagPos = base + i;
+  }
+  ASSERT_TRUE(tagPos != nullptr);
+  const uint32_t length = 40;
+  std::memcpy(tagPos - sizeof(length), &length, sizeof(length));
+
+  // The message is not read past the written bytes, and the ring is
+  // closed
+  std::string data;
+  uint64_t readTag = 0;
+  EXPECT_FALSE(reader.Read(data, readTag, 0));
+  EXPECT_FALSE(reader.IsOpen());
+  EXPECT_FALSE(writer.IsOpen());
+}
+
+/////////////////////////////////////////////////
+TEST_F(SharedMemoryRing, RemoveStale)
+{
+#ifdef __linux__
+  // Get the id of a process that no longer runs
+  pid_t pid = fork();
+  ASSERT_GE(pid, 0);
+  if (pid == 0)
+    _exit(0);
+  ASSERT_EQ(pid, waitpid(pid, nullptr, 0));
+
+  namespace ipc = boost::interprocess;
+  const std::string stale = "gazebo_shm_" + std::to_string(pid) + "_0_0";
+  {
+    ipc::shared_memory_object shm(ipc::open_or_create, stale.c_str(),
+        ipc::read_write);
+    shm.truncate(64);
+  }
+
+  // Creating a ring removes the segments of processes that no longer run,
+  // and keeps the others
+  transport::SharedMemoryRing live;
+  std::string name = transport::SharedMemoryRing::UniqueName();
+  ASSERT_TRUE(live.Create(name, 64));
+
+  transport::SharedMemoryRing reader;
+  ASSERT_TRUE(reader.Create(transport::SharedMemoryRing::UniqueName(), 64));
+
+  EXPECT_THROW(ipc::shared_memory_object(ipc::open_only, stale.c_str(),
+        ipc::read_only), ipc::interprocess_exception);
+
+  transport::SharedMemoryRing writer;
+  EXPECT_TRUE(writer.Open(name));
+#endif
+}
+
+/////////////////////////////////////////////////
+TEST_F(SharedMemoryRing, Threads)
+{
+  transport::SharedMemoryRing writer, reader;
+  std::string name = transport::SharedMemoryRing::UniqueName();
+
+  ASSERT_TRUE(reader.Create(name, 1024));
+  ASSERT_TRUE(writer.Open(name));
+
+  const int count = 10000;
+  std::thread writerThread([&]()
+  {
+    for (int i = 0; i < count; ++i)
+      EXPECT_TRUE(writer.Write(std::to_string(i), i, 1000));
+  });
+
+  std::string data;
+  uint64_t tag = 0;
+  for (int i = 0; i < count; ++i)
+  {
+    ASSERT_TRUE(reader.Read(data, tag, 1000));
+    EXPECT_EQ(std::to_string(i), data);
+    EXPECT_EQ(static_cast<uint64_t>(i), tag);
+  }
+  writerThread.join();
+}
+
+/////////////////////////////////////////////////
+TEST_F(SharedMemoryRing, OpenMissing)
+{
+  transport::SharedMemoryRing ring;
+  EXPECT_FALSE(ring.Open(transport::SharedMemoryRing::UniqueName()));
+  EXPECT_FALSE(ring.IsOpen());
+
+  std::string data;
+  uint64_t tag = 0;
+  EXPECT_FALSE(ring.Wait(0));
+  EXPECT_FALSE(ring.Read(data, tag, 0));
+  EXPECT_FALSE(ring.Write("a", 0, 0));
+}
+
+/////////////////////////////////////////////////
+TEST_F(SharedMemoryRing, UseFor)
+{
+  EXPECT_TRUE(transport::SharedMemoryRing::UseFor("gazebo.msgs.ImagesStamped"));
+  EXPECT_TRUE(transport::SharedMemoryRing::UseFor("gazebo.msgs.PointCloud"));
+  EXPECT_TRUE(
+      transport::SharedMemoryRing::UseFor("gazebo.msgs.LaserScanStamped"));
+  EXPECT_FALSE(transport::SharedMemoryRing::UseFor("gazebo.msgs.Pose"));
+}
+
+/////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -16,7 +16,11 @@
 */
 #include <boost/bind.hpp>
 #include <boost/function.hpp>
+#include <map>
+#include <memory>
+#include <mutex>
 #include "gazebo/transport/ConnectionManager.hh"
+#include "gazebo/transport/SharedMemoryRing.hh"
 #include "gazebo/transport/SubscriptionTransport.hh"
 
 using namespace gazebo;
@@ -24,6 +28,82 @@ using namespace transport;
 
 extern void dummy_callback_fn(uint32_t);
 
+namespace gazebo
+{
+  namespace transport
+  {
+    /// \internal
+    /// \brief Shared memory state of a subscription transport.
+    class SubscriptionTransportPrivate
+    {
+      /// \brief Shared memory ring created by the subscriber.
+      public: std::unique_ptr<SharedMemoryRing> ring;
+
+      /// \brief Number of messages sent through the connection since the
+      /// ring was opened. It is written with each message of the ring.
+      public: uint64_t connectionCount = 0;
+    };
+  }
+}
+
+// TODO added here for ABI compatibility
+// move to a private data pointer in SubscriptionTransport when merging
+// forward.
+/// \brief Shared memory state of the subscription transports that have
+/// opened a ring.
+static std::map<const SubscriptionTransport *,
+    std::unique_ptr<SubscriptionTransportPrivate>> gSharedMemoryData;
+
+/// \brief Mutex that protects gSharedMemoryData.
+static std::mutex gSharedMemoryDataMutex;
+
+//////////////////////////////////////////////////
+/// \brief Write a message into the shared memory ring of a subscription
+/// transport.
+/// \param[in] _sub The subscription transport.
+/// \param[in] _data The message.
+/// \param[in] _cb If non-null, callback to be invoked after the message
+/// was written.
+/// \param[in] _id ID associated with the message data.
+/// \return False if the message must be sent through the connection.
+static bool writeSharedMemory(const SubscriptionTransport *_sub,
+    const std::string &_data, boost::function<void(uint32_t)> _cb,
+    uint32_t _id)
+{
+  SubscriptionTransportPrivate *data = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(gSharedMemoryDataMutex);
+    auto iter = gSharedMemoryData.find(_sub);
+    if (iter == gSharedMemoryData.end())
+      return false;
+    data = iter->second.get();
+  }
+
+  // Messages larger than the ring, and messages the subscriber has no room
+  // for, go through the connection. The ring is never waited on, so that a
+  // slow subscriber doesn't hold up the publisher. The next message of the
+  // ring records how many went through the connection, so the subscriber
+  // still receives them in order.
+  if (_data.size() <= data->ring->MaxMessageSize() &&
+      data->ring->Write(_data, data->connectionCount, 0))
+  {
+    if (!_cb.empty())
+      _cb(_id);
+    return true;
+  }
+
+  // The subscriber closed the ring, use the connection from now on.
+  if (!data->ring->IsOpen())
+  {
+    std::lock_guard<std::mutex> lock(gSharedMemoryDataMutex);
+    gSharedMemoryData.erase(_sub);
+    return false;
+  }
+
+  ++data->connectionCount;
+  return false;
+}
+
 //////////////////////////////////////////////////
 SubscriptionTransport::SubscriptionTransport()
 {
@@ -32,6 +112,16 @@ SubscriptionTransport::SubscriptionTransport()
 //////////////////////////////////////////////////
 SubscriptionTransport::~SubscriptionTransport()
 {
+  {
+    std::lock_guard<std::mutex> lock(gSharedMemoryDataMutex);
+    auto iter = gSharedMemoryData.find(this);
+    if (iter != gSharedMemoryData.end())
+    {
+      iter->second->ring->Close();
+      gSharedMemoryData.erase(iter);
+    }
+  }
+
   ConnectionManager::Instance()->RemoveConnection(this->connection);
   this->connection.reset();
 }
@@ -43,12 +133,26 @@ void SubscriptionTransport::Init(ConnectionPtr _conn, bool _latching)
   this->latching = _latching;
 }
 
+//////////////////////////////////////////////////
+bool SubscriptionTransport::OpenSharedMemory(const std::string &_name)
+{
+  std::unique_ptr<SubscriptionTransportPrivate> data(
+      new SubscriptionTransportPrivate);
+  data->ring.reset(new SharedMemoryRing());
+  if (!data->ring->Open(_name))
+    return false;
+
+  std::lock_guard<std::mutex> lock(gSharedMemoryDataMutex);
+  gSharedMemoryData[this] = std::move(data);
+  return true;
+}
+
 //////////////////////////////////////////////////
 bool SubscriptionTransport::HandleMessage(MessagePtr _newMsg)
 {
-  std::string data;
-  _newMsg->SerializeToString(&data);
-  return this->HandleData(data, boost::bind(&dummy_callback_fn, _1), 0);
+  boost::shared_ptr<std::string> data(new std::string);
+  _newMsg->SerializeToString(data.get());
+  return this->HandleSharedData(data, boost::bind(&dummy_callback_fn, _1), 0);
 }
 
 //////////////////////////////////////////////////
@@ -58,7 +162,26 @@ bool SubscriptionTransport::HandleData(const std::string &_newdata,
   bool result = false;
   if (this->connection->IsOpen())
   {
-    this->connection->EnqueueMsg(_newdata, _cb, _id);
+    if (!writeSharedMemory(this, _newdata, _cb, _id))
+      this->connection->EnqueueMsg(_newdata, _cb, _id);
+    result = true;
+  }
+  else
+    this->connection.reset();
+
+  return result;
+}
+
+//////////////////////////////////////////////////
+bool SubscriptionTransport::HandleSharedData(
+    const boost::shared_ptr<const std::string> &_newdata,
+    boost::function<void(uint32_t)> _cb, uint32_t _id)
+{
+  bool result = false;
+  if (this->connection->IsOpen())
+  {
+    if (!writeSharedMemory(this, *_newdata, _cb, _id))
+      this->connection->EnqueueMsg(_newdata, _cb, _id);
     result = true;
   }
   else
@@ -50,6 +50,17 @@ namespace gazebo
       /// don't latch
       public: void Init(ConnectionPtr _conn, bool _latching);
 
+      /// \brief Send messages through a shared memory ring created by a
+      /// subscriber on the same host. The connection is still used for
+      /// messages that don't fit in the ring, when the subscriber does not
+      /// empty the ring in time, and if the ring is closed. The messages
+      /// written into the ring carry the number of messages sent through
+      /// the connection before them, so that the subscriber can receive
+      /// the messages in order.
+      /// \param[in] _name Name of the ring.
+      /// \return True if the ring was opened.
+      public: bool OpenSharedMemory(const std::string &_name);
+
       /// \brief Output a message to a connection
       /// \param[in] _newdata The message to be handled
       /// \return true if the message was handled successfully, false otherwise
@@ -59,6 +70,19 @@ namespace gazebo
       public: virtual bool HandleData(const std::string &_newdata,
                   boost::function<void(uint32_t)> _cb, uint32_t _id);
 
+      /// \brief Output a message to a connection without copying it. The
+      /// buffer is kept by the connection until it has been written.
+      /// Publication calls this instead of HandleData for remote
+      /// subscriptions.
+      /// \param[in] _newdata The message to be handled
+      /// \param[in] _cb If non-null, callback to be invoked after
+      /// transmission is complete.
+      /// \param[in] _id ID associated with the message data.
+      /// \return true if the message was handled successfully, false otherwise
+      public: bool HandleSharedData(
+                  const boost::shared_ptr<const std::string> &_newdata,
+                  boost::function<void(uint32_t)> _cb, uint32_t _id);
+
       // Documentation inherited
       public: virtual bool HandleMessage(MessagePtr _newMsg);
 
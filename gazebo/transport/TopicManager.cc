@@ -354,7 +354,7 @@ void TopicManager::ConnectSubToPub(const msgs::Publish &_pub)
         }
       }
 
-      publink->Init(conn, latched);
+      publink->Init(conn, latched, _pub.host_id());
 
       publication->AddTransport(publink);
     }
@@ -0,0 +1,580 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+#include <boost/iostreams/copy.hpp>
+#include <boost/iostreams/filter/zlib.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
+
+#include "gazebo/common/Console.hh"
+#include "gazebo/util/LogBinary.hh"
+
+using namespace gazebo;
+using namespace util;
+
+/// \brief Magic at the start of a binary log file.
+static const char kFileMagic[] = "GZLOGBIN";
+
+/// \brief Magic at the start of a block.
+static const char kBlockMagic[] = "GZBK";
+
+/// \brief Magic at the start of the index.
+static const char kIndexMagic[] = "GZIX";
+
+/// \brief Magic at the end of a complete binary log file.
+static const char kTrailerMagic[] = "GZLOGIDX";
+
+/// \brief Version of the binary layout.
+static const uint32_t kVersion = 1;
+
+/// \brief Size of the file header, without the header xml.
+static const size_t kFileHeaderSize = 16;
+
+/// \brief Size of a block header, without the frame table.
+static const size_t kBlockHeaderSize = 16;
+
+/// \brief Size of one entry of a frame table.
+static const size_t kFrameSize = 25;
+
+/// \brief Size of one entry of the block table.
+static const size_t kBlockEntrySize = 33;
+
+/// \brief Size of the trailer.
+static const size_t kTrailerSize = 16;
+
+/// \brief XML tags delimiting a frame.
+static const char kStartFrame[] = "<sdf ";
+static const char kEndFrame[] = "</sdf>";
+
+/////////////////////////////////////////////////
+static void PutU32(std::string &_out, const uint32_t _v)
+{
+  for (int i = 0; i < 4; ++i)
+    _out.push_back(static_cast<char>((_v >> (8 * i)) & 0xFF));
+}
+
+/////////////////////////////////////////////////
+static void PutU64(std::string &_out, const uint64_t _v)
+{
+  for (int i = 0; i < 8; ++i)
+    _out.push_back(static_cast<char>((_v >> (8 * i)) & 0xFF));
+}
+
+/////////////////////////////////////////////////
+static uint32_t GetU32(const char *_p)
+{
+  uint32_t v = 0;
+  for (int i = 0; i < 4; ++i)
+    v |= static_cast<uint32_t>(static_cast<unsigned char>(_p[i])) << (8 * i);
+  return v;
+}
+
+/////////////////////////////////////////////////
+static uint64_t GetU64(const char *_p)
+{
+  uint64_t v = 0;
+  for (int i = 0; i < 8; ++i)
+    v |= static_cast<uint64_t>(static_cast<unsigned char>(_p[i])) << (8 * i);
+  return v;
+}
+
+/////////////////////////////////////////////////
+static void PutTime(std::string &_out, const common::Time &_t)
+{
+  PutU32(_out, static_cast<uint32_t>(_t.sec));
+  PutU32(_out, static_cast<uint32_t>(_t.nsec));
+}
+
+/////////////////////////////////////////////////
+static common::Time GetTime(const char *_p)
+{
+  return common::Time(static_cast<int32_t>(GetU32(_p)),
+                      static_cast<int32_t>(GetU32(_p + 4)));
+}
+
+/////////////////////////////////////////////////
+/// \brief Find the text of an element inside a frame.
+static bool ElementText(const std::string &_frame, const std::string &_name,
+    std::string &_text)
+{
+  const std::string start = "<" + _name + ">";
+  const std::string end = "</" + _name + ">";
+
+  auto from = _frame.find(start);
+  if (from == std::string::npos)
+    return false;
+  from += start.size();
+
+  auto to = _frame.find(end, from);
+  if (to == std::string::npos)
+    return false;
+
+  _text = _frame.substr(from, to - from);
+  return true;
+}
+
+/////////////////////////////////////////////////
+void LogBinaryWriter::Start(const std::string &_headerXml, std::string &_out)
+{
+  this->offset = 0;
+  this->frameCount = 0;
+  this->lastTime = common::Time::Zero;
+  this->blocks.clear();
+
+  const size_t size = _out.size();
+  _out.append(kFileMagic, 8);
+  PutU32(_out, kVersion);
+  PutU32(_out, static_cast<uint32_t>(_headerXml.size()));
+  _out.append(_headerXml);
+
+  this->offset += _out.size() - size;
+}
+
+/////////////////////////////////////////////////
+unsigned int LogBinaryWriter::AppendBlock(const std::string &_frames,
+    std::string &_out)
+{
+  std::vector<LogBinaryFrame> frames;
+  std::string data;
+  data.reserve(_frames.size());
+
+  LogBinaryBlock block;
+  block.offset = this->offset;
+  block.firstFrame = this->frameCount;
+  block.startTime = block.endTime = this->lastTime;
+
+  const size_t endSize = sizeof(kEndFrame) - 1;
+  size_t from = _frames.find(kStartFrame);
+  while (from != std::string::npos)
+  {
+    size_t to = _frames.find(kEndFrame, from);
+    if (to == std::string::npos)
+    {
+      gzerr << "Unterminated <sdf> frame in binary log data\n";
+      break;
+    }
+    to += endSize;
+
+    LogBinaryFrame frame;
+    frame.offset = static_cast<uint32_t>(data.size());
+    frame.size = static_cast<uint32_t>(to - from);
+    data.append(_frames, from, to - from);
+
+    const std::string text = data.substr(frame.offset, frame.size);
+    std::string value;
+    if (ElementText(text, "sim_time", value))
+    {
+      std::stringstream ss(value);
+      ss >> frame.simTime;
+      frame.flags |= LogBinaryFrame::kHasTime;
+
+      if (!block.hasTime)
+        block.startTime = frame.simTime;
+      block.endTime = frame.simTime;
+      block.hasTime = true;
+      this->lastTime = frame.simTime;
+    }
+    if (ElementText(text, "iterations", value))
+    {
+      std::stringstream ss(value);
+      ss >> frame.iterations;
+      frame.flags |= LogBinaryFrame::kHasIterations;
+    }
+
+    frames.push_back(frame);
+    from = _frames.find(kStartFrame, to);
+  }
+
+  if (frames.empty())
+    return 0;
+
+  std::string compressed;
+  {
+    boost::iostreams::filtering_ostream out;
+    out.push(boost::iostreams::zlib_compressor());
+    out.push(std::back_inserter(compressed));
+    boost::iostreams::copy(boost::make_iterator_range(data), out);
+  }
+
+  const size_t size = _out.size();
+  _out.append(kBlockMagic, 4);
+  PutU32(_out, static_cast<uint32_t>(frames.size()));
+  PutU32(_out, static_cast<uint32_t>(compressed.size()));
+  PutU32(_out, static_cast<uint32_t>(data.size()));
+  for (auto const &frame : frames)
+  {
+    PutTime(_out, frame.simTime);
+    PutU64(_out, frame.iterations);
+    PutU32(_out, frame.offset);
+    PutU32(_out, frame.size);
+    _out.push_back(static_cast<char>(frame.flags));
+  }
+  _out.append(compressed);
+
+  block.frameCount = static_cast<uint32_t>(frames.size());
+  this->blocks.push_back(block);
+  this->frameCount += block.frameCount;
+  this->offset += _out.size() - size;
+
+  return block.frameCount;
+}
+
+/////////////////////////////////////////////////
+void LogBinaryWriter::Finish(std::string &_out)
+{
+  const uint64_t indexOffset = this->offset;
+  const size_t size = _out.size();
+
+  _out.append(kIndexMagic, 4);
+  PutU32(_out, static_cast<uint32_t>(this->blocks.size()));
+  for (auto const &block : this->blocks)
+  {
+    PutU64(_out, block.offset);
+    PutU32(_out, block.firstFrame);
+    PutU32(_out, block.frameCount);
+    PutTime(_out, block.startTime);
+    PutTime(_out, block.endTime);
+    _out.push_back(static_cast<char>(block.hasTime ? 1 : 0));
+  }
+
+  PutU64(_out, indexOffset);
+  _out.append(kTrailerMagic, 8);
+
+  this->offset += _out.size() - size;
+}
+
+/////////////////////////////////////////////////
+uint64_t LogBinaryWriter::Offset() const
+{
+  return this->offset;
+}
+
+/////////////////////////////////////////////////
+const std::vector<LogBinaryBlock> &LogBinaryWriter::Blocks() const
+{
+  return this->blocks;
+}
+
+/////////////////////////////////////////////////
+bool LogBinaryReader::IsBinary(const std::string &_filename)
+{
+  std::ifstream in(_filename, std::ios::binary);
+  char magic[8];
+  if (!in.read(magic, sizeof(magic)))
+    return false;
+  return std::memcmp(magic, kFileMagic, sizeof(magic)) == 0;
+}
+
+/////////////////////////////////////////////////
+bool LogBinaryReader::Open(const std::string &_filename)
+{
+  this->Close();
+
+  try
+  {
+    this->file.open(_filename);
+  }
+  catch(std::exception &_e)
+  {
+    gzerr << "Unable to map log file[" << _filename << "]: "
+          << _e.what() << std::endl;
+    return false;
+  }
+
+  const char *data = this->file.data();
+  const size_t size = this->file.size();
+
+  if (size < kFileHeaderSize || std::memcmp(data, kFileMagic, 8) != 0)
+  {
+    gzerr << "Log file[" << _filename << "] is not a binary log\n";
+    this->Close();
+    return false;
+  }
+
+  const uint32_t version = GetU32(data + 8);
+  if (version != kVersion)
+  {
+    gzerr << "Binary log version[" << version << "] in file[" << _filename
+          << "] is not supported\n";
+    this->Close();
+    return false;
+  }
+
+  const uint32_t headerSize = GetU32(data + 12);
+  if (kFileHeaderSize + headerSize > size)
+  {
+    gzerr << "Log file[" << _filename << "] has a truncated header\n";
+    this->Close();
+    return false;
+  }
+
+  this->headerXml.assign(data + kFileHeaderSize, headerSize);
+  this->dataOffset = kFileHeaderSize + headerSize;
+
+  bool corrupt = false;
+  if (!this->ReadIndex(corrupt))
+  {
+    if (corrupt)
+    {
+      gzerr << "Log file[" << _filename << "] has an index that does not "
+            << "match its blocks\n";
+      this->Close();
+      return false;
+    }
+
+    gzwarn << "Log file[" << _filename << "] has no index, the recording "
+           << "may have been interrupted. Rebuilding the index.\n";
+    this->RebuildIndex(this->dataOffset);
+  }
+
+  return true;
+}
+
+/////////////////////////////////////////////////
+void LogBinaryReader::Close()
+{
+  if (this->file.is_open())
+    this->file.close();
+  this->headerXml.clear();
+  this->blocks.clear();
+  this->dataOffset = 0;
+}
+
+/////////////////////////////////////////////////
+bool LogBinaryReader::BlockSize(const uint64_t _offset, const uint64_t _end,
+    uint64_t &_size) const
+{
+  // Every comparison subtracts from _end, so that a corrupt offset or size
+  // cannot overflow.
+  const char *data = this->file.data();
+  if (_end > this->file.size() || _offset < this->dataOffset ||
+      _offset > _end || _end - _offset < kBlockHeaderSize ||
+      std::memcmp(data + _offset, kBlockMagic, 4) != 0)
+  {
+    return false;
+  }
+
+  const uint64_t available = _end - _offset - kBlockHeaderSize;
+  const uint64_t framesSize =
+      static_cast<uint64_t>(GetU32(data + _offset + 4)) * kFrameSize;
+  const uint64_t compressedSize = GetU32(data + _offset + 8);
+  if (framesSize > available || compressedSize > available - framesSize)
+    return false;
+
+  _size = kBlockHeaderSize + framesSize + compressedSize;
+  return true;
+}
+
+/////////////////////////////////////////////////
+bool LogBinaryReader::ReadIndex(bool &_corrupt)
+{
+  _corrupt = false;
+
+  const char *data = this->file.data();
+  const uint64_t size = this->file.size();
+
+  if (size < this->dataOffset || size - this->dataOffset < kTrailerSize)
+    return false;
+
+  const char *trailer = data + size - kTrailerSize;
+  if (std::memcmp(trailer + 8, kTrailerMagic, 8) != 0)
+    return false;
+
+  const uint64_t indexEnd = size - kTrailerSize;
+  const uint64_t indexOffset = GetU64(trailer);
+  if (indexOffset < this->dataOffset || indexOffset > indexEnd ||
+      indexEnd - indexOffset < 8 ||
+      std::memcmp(data + indexOffset, kIndexMagic, 4) != 0)
+  {
+    return false;
+  }
+
+  const uint32_t count = GetU32(data + indexOffset + 4);
+  if ((indexEnd - indexOffset - 8) / kBlockEntrySize < count)
+    return false;
+
+  // The index is complete, so an entry that does not match a block within
+  // the file means the log is corrupt.
+  this->blocks.resize(count);
+  const char *p = data + indexOffset + 8;
+  uint64_t frameCount = 0;
+  for (auto &block : this->blocks)
+  {
+    block.offset = GetU64(p);
+    block.firstFrame = GetU32(p + 8);
+    block.frameCount = GetU32(p + 12);
+    block.startTime = GetTime(p + 16);
+    block.endTime = GetTime(p + 24);
+    block.hasTime = p[32] != 0;
+    p += kBlockEntrySize;
+
+    uint64_t blockSize;
+    if (!this->BlockSize(block.offset, indexOffset, blockSize) ||
+        GetU32(data + block.offset + 4) != block.frameCount ||
+        block.firstFrame != frameCount)
+    {
+      this->blocks.clear();
+      _corrupt = true;
+      return false;
+    }
+    frameCount += block.frameCount;
+  }
+
+  return true;
+}
+
+/////////////////////////////////////////////////
+bool LogBinaryReader::RebuildIndex(uint64_t _offset)
+{
+  const char *data = this->file.data();
+  const size_t size = this->file.size();
+
+  this->blocks.clear();
+
+  uint32_t frameCount = 0;
+  common::Time lastTime;
+  uint64_t blockSize;
+
+  // Stop at the first partially written block.
+  while (this->BlockSize(_offset, size, blockSize))
+  {
+    const char *p = data + _offset;
+    const uint32_t frames = GetU32(p + 4);
+
+    LogBinaryBlock block;
+    block.offset = _offset;
+    block.firstFrame = frameCount;
+    block.frameCount = frames;
+    block.startTime = block.endTime = lastTime;
+
+    const char *frame = p + kBlockHeaderSize;
+    for (uint32_t i = 0; i < frames; ++i, frame += kFrameSize)
+    {
+      if (!(frame[24] & LogBinaryFrame::kHasTime))
+        continue;
+
+      const common::Time t = GetTime(frame);
+      if (!block.hasTime)
+        block.startTime = t;
+      block.endTime = t;
+      block.hasTime = true;
+      lastTime = t;
+    }
+
+    this->blocks.push_back(block);
+    frameCount += frames;
+    _offset += blockSize;
+  }
+
+  return true;
+}
+
+/////////////////////////////////////////////////
+const std::string &LogBinaryReader::HeaderXml() const
+{
+  return this->headerXml;
+}
+
+/////////////////////////////////////////////////
+const std::vector<LogBinaryBlock> &LogBinaryReader::Blocks() const
+{
+  return this->blocks;
+}
+
+/////////////////////////////////////////////////
+uint64_t LogBinaryReader::FrameCount() const
+{
+  if (this->blocks.empty())
+    return 0;
+  return static_cast<uint64_t>(this->blocks.back().firstFrame) +
+    this->blocks.back().frameCount;
+}
+
+/////////////////////////////////////////////////
+size_t LogBinaryReader::BlockOfFrame(const uint64_t _frame) const
+{
+  auto iter = std::upper_bound(this->blocks.begin(), this->blocks.end(),
+      _frame, [](const uint64_t _f, const LogBinaryBlock &_b)
+      {
+        return _f < _b.firstFrame;
+      });
+
+  if (iter == this->blocks.begin() || _frame >= this->FrameCount())
+    return this->blocks.size();
+
+  return static_cast<size_t>(iter - this->blocks.begin()) - 1;
+}
+
+/////////////////////////////////////////////////
+bool LogBinaryReader::Frames(const size_t _block,
+    std::vector<LogBinaryFrame> &_frames) const
+{
+  if (_block >= this->blocks.size())
+    return false;
+
+  const char *p = this->file.data() + this->blocks[_block].offset;
+  const uint32_t count = GetU32(p + 4);
+
+  _frames.resize(count);
+  const char *frame = p + kBlockHeaderSize;
+  for (auto &f : _frames)
+  {
+    f.simTime = GetTime(frame);
+    f.iterations = GetU64(frame + 8);
+    f.offset = GetU32(frame + 16);
+    f.size = GetU32(frame + 20);
+    f.flags = static_cast<uint8_t>(frame[24]);
+    frame += kFrameSize;
+  }
+
+  return true;
+}
+
+/////////////////////////////////////////////////
+bool LogBinaryReader::Data(const size_t _block, std::string &_data) const
+{
+  if (_block >= this->blocks.size())
+    return false;
+
+  const char *p = this->file.data() + this->blocks[_block].offset;
+  const uint32_t count = GetU32(p + 4);
+  const uint32_t compressedSize = GetU32(p + 8);
+  const uint32_t size = GetU32(p + 12);
+  const char *compressed = p + kBlockHeaderSize + count * kFrameSize;
+
+  _data.clear();
+  _data.reserve(size);
+  try
+  {
+    boost::iostreams::filtering_istream in;
+    in.push(boost::iostreams::zlib_decompressor());
+    in.push(boost::make_iterator_range(compressed,
+          compressed + compressedSize));
+    boost::iostreams::copy(in, std::back_inserter(_data));
+  }
+  catch(std::exception &_e)
+  {
+    gzerr << "Unable to decompress block[" << _block << "]: "
+          << _e.what() << std::endl;
+    return false;
+  }
+
+  return _data.size() == size;
+}
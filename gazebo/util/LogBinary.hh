@@ -0,0 +1,231 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#ifndef _GAZEBO_UTIL_LOGBINARY_HH_
+#define _GAZEBO_UTIL_LOGBINARY_HH_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <boost/iostreams/device/mapped_file.hpp>
+
+#include "gazebo/common/Time.hh"
+#include "gazebo/util/system.hh"
+
+namespace gazebo
+{
+  namespace util
+  {
+    /// \internal
+    /// \brief Encoding name of binary log files, which are shared by
+    /// LogRecord, LogPlay and `gz log`.
+    ///
+    /// A binary log is a file header followed by a sequence of blocks
+    /// and a trailing index:
+    ///
+    ///   header:  "GZLOGBIN" u32 version, u32 size, <header> xml
+    ///   block:   "GZBK" u32 frames, u32 compressed, u32 uncompressed,
+    ///            frame table, zlib compressed frame data
+    ///   index:   "GZIX" u32 blocks, block table
+    ///   trailer: u64 index offset, "GZLOGIDX"
+    ///
+    /// Each block is compressed on its own, so it acts as a keyframe:
+    /// a frame is decoded by decompressing only the block that contains
+    /// it. The frame table of a block is stored uncompressed, and holds
+    /// the simulation time and iterations of every frame. All integers
+    /// are little endian. If the trailer is missing (e.g. the recording
+    /// was interrupted) the index is rebuilt by walking the block
+    /// headers.
+    static const char kLogBinaryEncoding[] = "bin";
+
+    /// \internal
+    /// \brief A frame (one <sdf> element) of a binary log file.
+    class LogBinaryFrame
+    {
+      /// \brief Flag set when the frame has a <sim_time>.
+      public: static const uint8_t kHasTime = 0x01;
+
+      /// \brief Flag set when the frame has an <iterations>.
+      public: static const uint8_t kHasIterations = 0x02;
+
+      /// \brief Simulation time of the frame.
+      public: common::Time simTime;
+
+      /// \brief Simulation iterations of the frame.
+      public: uint64_t iterations = 0;
+
+      /// \brief Offset of the frame in the uncompressed block data.
+      public: uint32_t offset = 0;
+
+      /// \brief Size of the frame in bytes.
+      public: uint32_t size = 0;
+
+      /// \brief Combination of kHasTime and kHasIterations.
+      public: uint8_t flags = 0;
+    };
+
+    /// \internal
+    /// \brief Index entry of a block of frames in a binary log file.
+    class LogBinaryBlock
+    {
+      /// \brief Offset of the block in the file.
+      public: uint64_t offset = 0;
+
+      /// \brief Index of the first frame of the block in the log.
+      public: uint32_t firstFrame = 0;
+
+      /// \brief Number of frames in the block.
+      public: uint32_t frameCount = 0;
+
+      /// \brief Simulation time of the first timed frame in the block.
+      public: common::Time startTime;
+
+      /// \brief Simulation time of the last timed frame in the block.
+      public: common::Time endTime;
+
+      /// \brief True if at least one frame of the block has a time.
+      public: bool hasTime = false;
+    };
+
+    /// \internal
+    /// \brief Produces the bytes of a binary log file. The writer keeps
+    /// track of the offset of every block, so all the output must be
+    /// written to the file in the order it was produced.
+    class GZ_UTIL_VISIBLE LogBinaryWriter
+    {
+      /// \brief Start a new log file.
+      /// \param[in] _headerXml The <header> element of the log.
+      /// \param[out] _out Buffer that receives the file header.
+      public: void Start(const std::string &_headerXml, std::string &_out);
+
+      /// \brief Compress a set of frames into a block.
+      /// \param[in] _frames Concatenated <sdf> frames.
+      /// \param[out] _out Buffer that receives the block.
+      /// \return Number of frames written.
+      public: unsigned int AppendBlock(const std::string &_frames,
+                                       std::string &_out);
+
+      /// \brief Finish the log file by writing the index.
+      /// \param[out] _out Buffer that receives the index and trailer.
+      public: void Finish(std::string &_out);
+
+      /// \brief Number of bytes produced since Start.
+      /// \return Bytes produced.
+      public: uint64_t Offset() const;
+
+      /// \brief Blocks written since Start.
+      /// \return The block index.
+      public: const std::vector<LogBinaryBlock> &Blocks() const;
+
+      /// \brief Bytes produced since Start.
+      private: uint64_t offset = 0;
+
+      /// \brief Number of frames written since Start.
+      private: uint32_t frameCount = 0;
+
+      /// \brief Time of the last timed frame, used for blocks that
+      /// have no timed frame.
+      private: common::Time lastTime;
+
+      /// \brief Index of the blocks written since Start.
+      private: std::vector<LogBinaryBlock> blocks;
+    };
+
+    /// \internal
+    /// \brief Memory maps a binary log file and gives access to its
+    /// blocks and frames.
+    class GZ_UTIL_VISIBLE LogBinaryReader
+    {
+      /// \brief Check if a file starts with the binary log magic.
+      /// \param[in] _filename Path to the file.
+      /// \return True if the file is a binary log.
+      public: static bool IsBinary(const std::string &_filename);
+
+      /// \brief Open a binary log file.
+      /// \param[in] _filename Path to the file.
+      /// \return True if the file was mapped and the index was read.
+      public: bool Open(const std::string &_filename);
+
+      /// \brief Unmap the file.
+      public: void Close();
+
+      /// \brief Get the <header> element of the log.
+      /// \return The header xml.
+      public: const std::string &HeaderXml() const;
+
+      /// \brief Get the block index.
+      /// \return The blocks of the log.
+      public: const std::vector<LogBinaryBlock> &Blocks() const;
+
+      /// \brief Get the number of frames in the log.
+      /// \return Number of frames.
+      public: uint64_t FrameCount() const;
+
+      /// \brief Get the index of the block that contains a frame.
+      /// \param[in] _frame Index of the frame in the log.
+      /// \return Block index, or Blocks().size() if out of range.
+      public: size_t BlockOfFrame(const uint64_t _frame) const;
+
+      /// \brief Read the frame table of a block. This does not
+      /// decompress the block.
+      /// \param[in] _block Index of the block.
+      /// \param[out] _frames Frame table of the block.
+      /// \return True on success.
+      public: bool Frames(const size_t _block,
+                          std::vector<LogBinaryFrame> &_frames) const;
+
+      /// \brief Decompress the data of a block.
+      /// \param[in] _block Index of the block.
+      /// \param[out] _data Concatenated frames of the block.
+      /// \return True on success.
+      public: bool Data(const size_t _block, std::string &_data) const;
+
+      /// \brief Rebuild the block index by walking the block headers.
+      /// \param[in] _offset Offset of the first block.
+      /// \return True if at least the header of the log was valid.
+      private: bool RebuildIndex(uint64_t _offset);
+
+      /// \brief Read the block table referenced by the trailer.
+      /// \param[out] _corrupt Set to true if the index is complete, but an
+      /// entry does not match a block within the file.
+      /// \return True if a complete and valid index was found.
+      private: bool ReadIndex(bool &_corrupt);
+
+      /// \brief Check that a block header is valid, and that the block ends
+      /// within the file.
+      /// \param[in] _offset Offset of the block.
+      /// \param[in] _end Offset the block must end at or before.
+      /// \param[out] _size Size of the block, in bytes.
+      /// \return True if the block is valid.
+      private: bool BlockSize(const uint64_t _offset, const uint64_t _end,
+                   uint64_t &_size) const;
+
+      /// \brief The mapped file.
+      private: boost::iostreams::mapped_file_source file;
+
+      /// \brief The <header> element of the log.
+      private: std::string headerXml;
+
+      /// \brief The block index.
+      private: std::vector<LogBinaryBlock> blocks;
+
+      /// \brief Offset of the first block.
+      private: uint64_t dataOffset = 0;
+    };
+  }
+}
+#endif
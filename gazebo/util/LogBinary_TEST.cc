@@ -0,0 +1,241 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#include <gtest/gtest.h>
+#include <boost/filesystem.hpp>
+
+#include <cstdint>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "gazebo/common/Time.hh"
+#include "gazebo/util/LogBinary.hh"
+#include "test/util.hh"
+
+using namespace gazebo;
+
+class LogBinary_TEST : public gazebo::testing::AutoLogFixture { };
+
+/////////////////////////////////////////////////
+/// \brief Create a state frame.
+/// \param[in] _i Frame number, used for the time and iterations.
+/// \return The frame.
+std::string StateFrame(const int _i)
+{
+  std::ostringstream stream;
+  stream << "<sdf version='1.6'><state world_name='default'>"
+         << "<sim_time>" << _i << " 500</sim_time>"
+         << "<iterations>" << _i * 10 << "</iterations>"
+         << "</state></sdf>";
+  return stream.str();
+}
+
+/////////////////////////////////////////////////
+/// \brief Write a log with a world frame and 10 state frames, in blocks
+/// of 4 frames.
+/// \param[in] _filename File to write.
+/// \param[in] _index True to write the trailing index.
+void WriteLog(const std::string &_filename, const bool _index)
+{
+  util::LogBinaryWriter writer;
+  std::string out;
+  writer.Start("<header><log_version>1.0</log_version></header>", out);
+  EXPECT_EQ(writer.AppendBlock("<sdf version ='1.6'>\n<world/></sdf>\n", out),
+      1u);
+
+  std::string frames;
+  for (int i = 0; i < 10; ++i)
+  {
+    frames += StateFrame(i);
+    if (i % 4 == 3)
+    {
+      EXPECT_EQ(writer.AppendBlock(frames, out), 4u);
+      frames.clear();
+    }
+  }
+  EXPECT_EQ(writer.AppendBlock(frames, out), 2u);
+  EXPECT_EQ(writer.AppendBlock("", out), 0u);
+  EXPECT_EQ(writer.Blocks().size(), 4u);
+
+  if (_index)
+    writer.Finish(out);
+  EXPECT_EQ(writer.Offset(), out.size());
+
+  std::ofstream file(_filename, std::ios::binary);
+  file.write(out.c_str(), out.size());
+}
+
+/////////////////////////////////////////////////
+/// \brief Check the content of a log written with WriteLog.
+/// \param[in] _filename File to read.
+void CheckLog(const std::string &_filename)
+{
+  EXPECT_TRUE(util::LogBinaryReader::IsBinary(_filename));
+
+  util::LogBinaryReader reader;
+  ASSERT_TRUE(reader.Open(_filename));
+  EXPECT_EQ(reader.HeaderXml(),
+      "<header><log_version>1.0</log_version></header>");
+  EXPECT_EQ(reader.FrameCount(), 11u);
+
+  auto const &blocks = reader.Blocks();
+  ASSERT_EQ(blocks.size(), 4u);
+  EXPECT_FALSE(blocks[0].hasTime);
+  EXPECT_TRUE(blocks[1].hasTime);
+  EXPECT_EQ(blocks[1].firstFrame, 1u);
+  EXPECT_EQ(blocks[1].startTime, common::Time(0, 500));
+  EXPECT_EQ(blocks[1].endTime, common::Time(3, 500));
+  EXPECT_EQ(blocks[3].firstFrame, 9u);
+  EXPECT_EQ(blocks[3].endTime, common::Time(9, 500));
+
+  EXPECT_EQ(reader.BlockOfFrame(0), 0u);
+  EXPECT_EQ(reader.BlockOfFrame(4), 1u);
+  EXPECT_EQ(reader.BlockOfFrame(5), 2u);
+  EXPECT_EQ(reader.BlockOfFrame(10), 3u);
+  EXPECT_EQ(reader.BlockOfFrame(11), blocks.size());
+
+  std::vector<util::LogBinaryFrame> frames;
+  std::string data;
+  ASSERT_TRUE(reader.Frames(2, frames));
+  ASSERT_TRUE(reader.Data(2, data));
+  ASSERT_EQ(frames.size(), 4u);
+  for (int i = 0; i < 4; ++i)
+  {
+    EXPECT_EQ(frames[i].flags, util::LogBinaryFrame::kHasTime |
+        util::LogBinaryFrame::kHasIterations);
+    EXPECT_EQ(frames[i].simTime, common::Time(4 + i, 500));
+    EXPECT_EQ(frames[i].iterations, (4u + i) * 10u);
+    EXPECT_EQ(data.substr(frames[i].offset, frames[i].size),
+        StateFrame(4 + i));
+  }
+
+  EXPECT_FALSE(reader.Frames(4, frames));
+  EXPECT_FALSE(reader.Data(4, data));
+}
+
+/////////////////////////////////////////////////
+/// \brief Write and read back a binary log.
+TEST_F(LogBinary_TEST, WriteRead)
+{
+  auto path = boost::filesystem::temp_directory_path() /
+    boost::filesystem::unique_path("gz_log_binary_%%%%%%");
+
+  WriteLog(path.string(), true);
+  CheckLog(path.string());
+
+  boost::filesystem::remove(path);
+}
+
+/////////////////////////////////////////////////
+/// \brief Read a binary log without its trailing index, as left behind by
+/// an interrupted recording.
+TEST_F(LogBinary_TEST, MissingIndex)
+{
+  auto path = boost::filesystem::temp_directory_path() /
+    boost::filesystem::unique_path("gz_log_binary_%%%%%%");
+
+  WriteLog(path.string(), false);
+
+  // Append a partial block, which must be ignored.
+  {
+    std::ofstream file(path.string(), std::ios::binary | std::ios::app);
+    file.write("GZBK\x02\x00\x00\x00", 8);
+  }
+
+  CheckLog(path.string());
+
+  boost::filesystem::remove(path);
+}
+
+/////////////////////////////////////////////////
+/// \brief Read a binary log whose index points outside of the file.
+TEST_F(LogBinary_TEST, CorruptIndex)
+{
+  auto path = boost::filesystem::temp_directory_path() /
+    boost::filesystem::unique_path("gz_log_binary_%%%%%%");
+
+  WriteLog(path.string(), true);
+
+  std::string log;
+  {
+    std::ifstream file(path.string(), std::ios::binary);
+    log.assign(std::istreambuf_iterator<char>(file),
+        std::istreambuf_iterator<char>());
+  }
+  ASSERT_GT(log.size(), 16u);
+
+  // The trailer starts with the little endian offset of the index, whose
+  // first entry starts with the offset of the first block.
+  uint64_t indexOffset = 0;
+  for (int i = 7; i >= 0; --i)
+  {
+    indexOffset = (indexOffset << 8) |
+        static_cast<unsigned char>(log[log.size() - 16 + i]);
+  }
+  ASSERT_LT(indexOffset + 16, log.size());
+
+  // Offsets that overflow, or are past the end of the file
+  for (const uint64_t offset :
+      {~uint64_t(0) - 4, uint64_t(log.size() - 20), uint64_t(3)})
+  {
+    std::string corrupt = log;
+    for (int i = 0; i < 8; ++i)
+      corrupt[indexOffset + 8 + i] = static_cast<char>(offset >> (8 * i));
+    {
+      std::ofstream file(path.string(), std::ios::binary | std::ios::trunc);
+      file.write(corrupt.c_str(), corrupt.size());
+    }
+
+    util::LogBinaryReader reader;
+    EXPECT_FALSE(reader.Open(path.string())) << offset;
+    EXPECT_EQ(reader.FrameCount(), 0u);
+  }
+
+  boost::filesystem::remove(path);
+}
+
+/////////////////////////////////////////////////
+/// \brief Files that are not binary logs.
+TEST_F(LogBinary_TEST, Invalid)
+{
+  EXPECT_FALSE(util::LogBinaryReader::IsBinary("non-existing-file"));
+
+  util::LogBinaryReader reader;
+  EXPECT_FALSE(reader.Open("non-existing-file"));
+
+  auto path = boost::filesystem::temp_directory_path() /
+    boost::filesystem::unique_path("gz_log_binary_%%%%%%");
+  {
+    std::ofstream file(path.string());
+    file << "<?xml version='1.0'?>\n<gazebo_log>\n";
+  }
+
+  EXPECT_FALSE(util::LogBinaryReader::IsBinary(path.string()));
+  EXPECT_FALSE(reader.Open(path.string()));
+  EXPECT_EQ(reader.FrameCount(), 0u);
+
+  boost::filesystem::remove(path);
+}
+
+/////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
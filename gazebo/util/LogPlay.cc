@@ -72,6 +72,20 @@ void LogPlay::Open(const std::string &_logFile)
   if (boost::filesystem::is_directory(path))
     gzthrow("Invalid logfile [" + _logFile + "]. This is a directory.");
 
+  this->dataPtr->binary = false;
+  this->dataPtr->binaryLog.Close();
+
+  // Binary logs are memory mapped and read through their index instead of
+  // being parsed as a whole.
+  if (LogBinaryReader::IsBinary(_logFile))
+  {
+    if (!this->dataPtr->OpenBinary(_logFile))
+      gzthrow("Error parsing log file");
+
+    this->ReadHeader();
+    return;
+  }
+
   // Flag use to indicate if a parser failure has occurred
   bool xmlParserFail = this->dataPtr->xmlDoc.LoadFile(_logFile.c_str()) !=
     tinyxml2::XML_SUCCESS;
@@ -436,6 +450,18 @@ bool LogPlay::Step(std::string &_data)
 {
   std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
 
+  if (this->dataPtr->binary)
+  {
+    const uint64_t next = this->dataPtr->frame + 1;
+    if (next >= this->dataPtr->binaryLog.FrameCount() ||
+        !this->dataPtr->BinaryFrame(next, _data))
+    {
+      return false;
+    }
+    this->dataPtr->frame = next;
+    return true;
+  }
+
   auto from = this->dataPtr->currentChunk.find(this->dataPtr->kStartFrame,
       this->dataPtr->end + this->dataPtr->kEndFrame.size());
   auto to = this->dataPtr->currentChunk.find(this->dataPtr->kEndFrame,
@@ -497,6 +523,17 @@ bool LogPlay::StepBack(std::string &_data)
 
   std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
 
+  if (this->dataPtr->binary)
+  {
+    if (this->dataPtr->frame < 1 ||
+        !this->dataPtr->BinaryFrame(this->dataPtr->frame - 1, _data))
+    {
+      return false;
+    }
+    --this->dataPtr->frame;
+    return true;
+  }
+
   if (this->dataPtr->start > 0)
   {
     from = this->dataPtr->currentChunk.rfind(
@@ -535,6 +572,13 @@ bool LogPlay::Rewind()
 {
   std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
 
+  // Skip the first frame, it doesn't have a world state.
+  if (this->dataPtr->binary)
+  {
+    this->dataPtr->frame = 0;
+    return this->dataPtr->binaryLog.FrameCount() > 0;
+  }
+
   this->dataPtr->currentChunk.clear();
   this->dataPtr->logCurrXml =
     this->dataPtr->logStartXml->FirstChildElement("chunk");
@@ -575,6 +619,12 @@ bool LogPlay::Forward()
 {
   std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
 
+  if (this->dataPtr->binary)
+  {
+    this->dataPtr->frame = this->dataPtr->binaryLog.FrameCount();
+    return this->dataPtr->frame > 0;
+  }
+
   // Get the last chunk.
   this->dataPtr->logCurrXml =
     this->dataPtr->logStartXml->LastChildElement("chunk");
@@ -600,6 +650,12 @@ bool LogPlay::Forward()
 /////////////////////////////////////////////////
 bool LogPlay::Seek(const common::Time &_time)
 {
+  if (this->dataPtr->binary)
+  {
+    std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+    return this->dataPtr->BinarySeek(_time);
+  }
+
   if (_time >= this->dataPtr->logEndTime)
   {
     this->Forward();
@@ -690,6 +746,9 @@ bool LogPlay::Seek(const common::Time &_time)
 /////////////////////////////////////////////////
 bool LogPlay::Chunk(unsigned int _index, std::string &_data) const
 {
+  if (this->dataPtr->binary)
+    return this->dataPtr->binaryLog.Data(_index, _data);
+
   unsigned int count = 0;
   this->dataPtr->logCurrXml =
     this->dataPtr->logStartXml->FirstChildElement("chunk");
@@ -778,6 +837,153 @@ bool LogPlayPrivate::ChunkData(
   return true;
 }
 
+/////////////////////////////////////////////////
+bool LogPlayPrivate::OpenBinary(const std::string &_logFile)
+{
+  if (!this->binaryLog.Open(_logFile))
+    return false;
+
+  // Wrap the header so that it can be read like the header of an XML log.
+  const std::string headerXml =
+    "<gazebo_log>" + this->binaryLog.HeaderXml() + "</gazebo_log>";
+  this->logStartXml = nullptr;
+  if (this->xmlDoc.Parse(headerXml.c_str()) == tinyxml2::XML_SUCCESS)
+    this->logStartXml = this->xmlDoc.FirstChildElement("gazebo_log");
+
+  if (!this->logStartXml)
+  {
+    gzerr << "Unable to parse the header of log file[" << _logFile << "]\n";
+    this->binaryLog.Close();
+    return false;
+  }
+
+  this->filename = _logFile;
+  this->binary = true;
+  this->encoding = kLogBinaryEncoding;
+  this->currentChunk.clear();
+  this->logCurrXml = nullptr;
+  this->frame = -1;
+  this->block = std::string::npos;
+  this->blockFrames.clear();
+  this->blockData.clear();
+
+  // The log times come from the index.
+  this->logStartTime = this->logEndTime = common::Time::Zero;
+  const auto &blocks = this->binaryLog.Blocks();
+  auto first = std::find_if(blocks.begin(), blocks.end(),
+      [](const LogBinaryBlock &_b) {return _b.hasTime;});
+  if (first != blocks.end())
+  {
+    this->logStartTime = first->startTime;
+    this->logEndTime = blocks.back().endTime;
+  }
+  else
+    gzwarn << "Unable to find <sim_time> tags in any frame." << std::endl;
+
+  // The initial iterations come from the frame tables of the first blocks.
+  this->initialIterations = 0;
+  this->iterationsFound = false;
+  std::vector<LogBinaryFrame> frames;
+  for (size_t i = 0; i < std::min(blocks.size(),
+        static_cast<size_t>(this->kNumChunksToTry)) &&
+      !this->iterationsFound; ++i)
+  {
+    this->binaryLog.Frames(i, frames);
+    for (auto const &f : frames)
+    {
+      if (f.flags & LogBinaryFrame::kHasIterations)
+      {
+        this->initialIterations = f.iterations;
+        this->iterationsFound = true;
+        break;
+      }
+    }
+  }
+
+  if (!this->iterationsFound)
+  {
+    gzwarn << "Unable to find <iterations>...</iterations> tags in the first "
+           << "frames. Assuming that the first <iterations> value is 0."
+           << std::endl;
+  }
+
+  return true;
+}
+
+/////////////////////////////////////////////////
+bool LogPlayPrivate::BinaryFrame(const uint64_t _frame, std::string &_data)
+{
+  const size_t index = this->binaryLog.BlockOfFrame(_frame);
+  if (index >= this->binaryLog.Blocks().size())
+    return false;
+
+  if (index != this->block)
+  {
+    if (!this->binaryLog.Frames(index, this->blockFrames) ||
+        !this->binaryLog.Data(index, this->blockData))
+    {
+      this->block = std::string::npos;
+      return false;
+    }
+    this->block = index;
+  }
+
+  const auto &f =
+    this->blockFrames[_frame - this->binaryLog.Blocks()[index].firstFrame];
+  if (static_cast<size_t>(f.offset) + f.size > this->blockData.size())
+  {
+    gzerr << "Invalid frame[" << _frame << "] in log file["
+          << this->filename << "]\n";
+    return false;
+  }
+
+  _data.assign(this->blockData, f.offset, f.size);
+  return true;
+}
+
+/////////////////////////////////////////////////
+bool LogPlayPrivate::BinarySeek(const common::Time &_time)
+{
+  const auto &blocks = this->binaryLog.Blocks();
+  const int64_t count = this->binaryLog.FrameCount();
+
+  // Same as LogPlay::Forward followed by two steps back.
+  if (_time >= this->logEndTime)
+  {
+    this->frame = std::max<int64_t>(count - 2, -1);
+    return true;
+  }
+
+  // Block times are monotonic, so the first block that can hold the
+  // target time is found with a binary search on the index.
+  auto iter = std::lower_bound(blocks.begin(), blocks.end(), _time,
+      [](const LogBinaryBlock &_b, const common::Time &_t)
+      {
+        return _b.endTime < _t;
+      });
+
+  std::vector<LogBinaryFrame> frames;
+  for (; iter != blocks.end(); ++iter)
+  {
+    if (!iter->hasTime)
+      continue;
+
+    this->binaryLog.Frames(iter - blocks.begin(), frames);
+    for (size_t i = 0; i < frames.size(); ++i)
+    {
+      if ((frames[i].flags & LogBinaryFrame::kHasTime) &&
+          frames[i].simTime >= _time)
+      {
+        this->frame = static_cast<int64_t>(iter->firstFrame + i) - 1;
+        return true;
+      }
+    }
+  }
+
+  this->frame = std::max<int64_t>(count - 2, -1);
+  return true;
+}
+
 /////////////////////////////////////////////////
 std::string LogPlay::Encoding() const
 {
@@ -787,6 +993,9 @@ std::string LogPlay::Encoding() const
 /////////////////////////////////////////////////
 unsigned int LogPlay::ChunkCount() const
 {
+  if (this->dataPtr->binary)
+    return this->dataPtr->binaryLog.Blocks().size();
+
   unsigned int count = 0;
   auto xml = this->dataPtr->logStartXml->FirstChildElement("chunk");
 
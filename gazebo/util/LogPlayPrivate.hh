@@ -27,8 +27,10 @@
 
 #include <mutex>
 #include <string>
+#include <vector>
 
 #include "gazebo/common/Time.hh"
+#include "gazebo/util/LogBinary.hh"
 #include "gazebo/util/system.hh"
 
 namespace gazebo
@@ -47,6 +49,24 @@ namespace gazebo
                   tinyxml2::XMLElement *_xml,
                   std::string &_data);
 
+      /// \brief Open a binary log file.
+      /// \param[in] _logFile The file to open.
+      /// \return True if the file was opened.
+      public: bool OpenBinary(const std::string &_logFile);
+
+      /// \brief Get a frame of the open binary log file. Only the block
+      /// that contains the frame is decompressed.
+      /// \param[in] _frame Index of the frame.
+      /// \param[out] _data Storage for the frame.
+      /// \return True if the frame was read.
+      public: bool BinaryFrame(const uint64_t _frame, std::string &_data);
+
+      /// \brief Position the open binary log file so that the next step
+      /// returns the first frame at or after a simulation time.
+      /// \param[in] _time Target simulation time.
+      /// \return True if the operation succeed.
+      public: bool BinarySeek(const common::Time &_time);
+
       /// \brief Max number of chunks to inspect when looking for XML elements.
       public: const unsigned int kNumChunksToTry = 2u;
 
@@ -111,6 +131,25 @@ namespace gazebo
       /// may not include this tag in the log files.
       public: bool iterationsFound = false;
 
+      /// \brief True if the open log file uses the binary encoding.
+      public: bool binary = false;
+
+      /// \brief Reader of the open binary log file.
+      public: LogBinaryReader binaryLog;
+
+      /// \brief Index of the last frame dispatched from the binary log
+      /// file, -1 if none.
+      public: int64_t frame = -1;
+
+      /// \brief Index of the block held in blockFrames and blockData.
+      public: size_t block = std::string::npos;
+
+      /// \brief Frame table of the decompressed binary block.
+      public: std::vector<LogBinaryFrame> blockFrames;
+
+      /// \brief Decompressed binary block.
+      public: std::string blockData;
+
       /// \brief A mutex to avoid race conditions.
       public: std::mutex mutex;
     };
@@ -17,11 +17,16 @@
 
 #include <gtest/gtest.h>
 #include <boost/filesystem.hpp>
+#include <fstream>
+#include <sstream>
 #include <string>
 #include <thread>
+#include <vector>
 #include "gazebo/common/CommonIface.hh"
 #include "gazebo/common/Time.hh"
+#include "gazebo/util/LogBinary.hh"
 #include "gazebo/util/LogPlay.hh"
+#include "gazebo/util/LogRecord.hh"
 #include "test_config.h"
 #include "test/util.hh"
 
@@ -457,6 +462,117 @@ TEST_F(LogPlay_TEST, NoEndTag)
 #endif
 }
 
+/////////////////////////////////////////////////
+/// \brief Test playback of a binary log file.
+TEST_F(LogPlay_TEST, Binary)
+{
+  // Write a binary log with a world frame and 10 states, 4 per block.
+  gazebo::util::LogBinaryWriter writer;
+  std::string out;
+  writer.Start("<header>\n<log_version>" GZ_LOG_VERSION "</log_version>\n"
+      "<gazebo_version>11.0.0</gazebo_version>\n"
+      "<rand_seed>1234</rand_seed>\n</header>\n", out);
+  writer.AppendBlock("<sdf version ='1.6'>\n<world/></sdf>\n", out);
+
+  std::vector<std::string> states;
+  std::string frames;
+  for (int i = 0; i < 10; ++i)
+  {
+    std::ostringstream stream;
+    stream << "<sdf version='1.6'><state world_name='default'>"
+           << "<sim_time>" << 10 + i << " 0</sim_time>"
+           << "<iterations>" << 100 + i << "</iterations>"
+           << "</state></sdf>";
+    states.push_back(stream.str());
+    frames += stream.str();
+    if (i % 4 == 3)
+    {
+      writer.AppendBlock(frames, out);
+      frames.clear();
+    }
+  }
+  writer.AppendBlock(frames, out);
+  writer.Finish(out);
+
+  auto path = boost::filesystem::temp_directory_path() /
+    boost::filesystem::unique_path("gz_log_play_%%%%%%.log");
+  {
+    std::ofstream file(path.string(), std::ios::binary);
+    file.write(out.c_str(), out.size());
+  }
+
+  gazebo::util::LogPlay *player = gazebo::util::LogPlay::Instance();
+  EXPECT_NO_THROW(player->Open(path.string()));
+  EXPECT_TRUE(player->IsOpen());
+  EXPECT_EQ(player->Encoding(), "bin");
+  EXPECT_EQ(player->LogVersion(), GZ_LOG_VERSION);
+  EXPECT_EQ(player->GazeboVersion(), "11.0.0");
+  EXPECT_EQ(player->RandSeed(), 1234u);
+  EXPECT_EQ(player->LogStartTime(), common::Time(10, 0));
+  EXPECT_EQ(player->LogEndTime(), common::Time(19, 0));
+  EXPECT_TRUE(player->HasIterations());
+  EXPECT_EQ(player->InitialIterations(), 100u);
+  EXPECT_EQ(player->ChunkCount(), 4u);
+
+  // The first frame is the world description.
+  std::string frame;
+  EXPECT_TRUE(player->Step(frame));
+  EXPECT_EQ(frame, "<sdf version ='1.6'>\n<world/></sdf>");
+  EXPECT_FALSE(player->StepBack(frame));
+
+  // Step forward across blocks, and back.
+  for (auto const &state : states)
+  {
+    EXPECT_TRUE(player->Step(frame));
+    EXPECT_EQ(frame, state);
+  }
+  EXPECT_FALSE(player->Step(frame));
+  EXPECT_TRUE(player->StepBack(frame));
+  EXPECT_EQ(frame, states[8]);
+  EXPECT_TRUE(player->Step(-3, frame));
+  EXPECT_EQ(frame, states[5]);
+
+  EXPECT_TRUE(player->Rewind());
+  EXPECT_TRUE(player->Step(frame));
+  EXPECT_EQ(frame, states[0]);
+
+  EXPECT_TRUE(player->Forward());
+  EXPECT_TRUE(player->StepBack(frame));
+  EXPECT_EQ(frame, states[9]);
+
+  // Seek returns the first state at or after the target time.
+  EXPECT_TRUE(player->Seek(common::Time(14.5)));
+  EXPECT_TRUE(player->Step(frame));
+  EXPECT_EQ(frame, states[5]);
+
+  EXPECT_TRUE(player->Seek(common::Time(12.0)));
+  EXPECT_TRUE(player->Step(frame));
+  EXPECT_EQ(frame, states[2]);
+
+  EXPECT_TRUE(player->Seek(common::Time(5.0)));
+  EXPECT_TRUE(player->Step(frame));
+  EXPECT_EQ(frame, states[0]);
+
+  EXPECT_TRUE(player->Seek(common::Time(25.0)));
+  EXPECT_TRUE(player->Step(frame));
+  EXPECT_EQ(frame, states[9]);
+
+  // A chunk is a decompressed block.
+  std::string chunk;
+  EXPECT_TRUE(player->Chunk(3, chunk));
+  EXPECT_EQ(chunk, states[8] + states[9]);
+  EXPECT_FALSE(player->Chunk(4, chunk));
+
+  // XML logs can still be opened afterwards.
+  boost::filesystem::path logFilePath(TEST_PATH);
+  logFilePath /= boost::filesystem::path("logs");
+  logFilePath /= boost::filesystem::path("state.log");
+  EXPECT_NO_THROW(player->Open(logFilePath.string()));
+  EXPECT_NE(player->Encoding(), "bin");
+
+  boost::filesystem::remove(path);
+}
+
 /////////////////////////////////////////////////
 int main(int argc, char **argv)
 {
@@ -186,9 +186,12 @@ bool LogRecord::Start(const std::string &_encoding, const std::string &_path)
   if (!boost::filesystem::exists(this->dataPtr->logCompletePath))
     boost::filesystem::create_directories(this->dataPtr->logCompletePath);
 
-  if (_encoding != "bz2" && _encoding != "txt" && _encoding != "zlib")
+  if (_encoding != "bz2" && _encoding != "txt" && _encoding != "zlib" &&
+      _encoding != kLogBinaryEncoding)
+  {
     gzthrow("Invalid log encoding[" + _encoding +
-            "]. Must be one of [bz2, zlib, txt]");
+            "]. Must be one of [bz2, zlib, txt, bin]");
+  }
 
   this->dataPtr->encoding = _encoding;
 
@@ -792,7 +795,12 @@ unsigned int LogRecordPrivate::Log::Update()
   if (this->logCB(stream))
   {
     std::string data = stream.str();
-    if (!data.empty())
+    if (!data.empty() && this->binary)
+    {
+      // Each update becomes an independently compressed block.
+      this->binaryWriter.AppendBlock(data, this->buffer);
+    }
+    else if (!data.empty())
     {
       const std::string &encodingLocal = this->parent->Encoding();
 
@@ -877,8 +885,17 @@ void LogRecordPrivate::Log::Stop()
     this->Update();
     this->Write();
 
-    std::string xmlEnd = "</gazebo_log>";
-    this->logFile.write(xmlEnd.c_str(), xmlEnd.size());
+    if (this->binary)
+    {
+      std::string index;
+      this->binaryWriter.Finish(index);
+      this->logFile.write(index.c_str(), index.size());
+    }
+    else
+    {
+      std::string xmlEnd = "</gazebo_log>";
+      this->logFile.write(xmlEnd.c_str(), xmlEnd.size());
+    }
 
     this->logFile.close();
   }
@@ -898,15 +915,22 @@ void LogRecordPrivate::Log::Start(const boost::filesystem::path &_path)
           << " The log file will be overwritten.\n";
 
   std::ostringstream stream;
-  stream << "<?xml version='1.0'?>\n"
-         << "<gazebo_log>\n"
-         << "<header>\n"
+  stream << "<header>\n"
          << "<log_version>" << GZ_LOG_VERSION << "</log_version>\n"
          << "<gazebo_version>" << GAZEBO_VERSION_FULL << "</gazebo_version>\n"
          << "<rand_seed>" << ignition::math::Rand::Seed() << "</rand_seed>\n"
          << "</header>\n";
 
-  this->buffer.append(stream.str());
+  this->binary = this->parent->Encoding() == kLogBinaryEncoding;
+  if (this->binary)
+  {
+    this->binaryWriter.Start(stream.str(), this->buffer);
+  }
+  else
+  {
+    this->buffer.append("<?xml version='1.0'?>\n<gazebo_log>\n");
+    this->buffer.append(stream.str());
+  }
 }
 
 //////////////////////////////////////////////////
@@ -38,7 +38,7 @@ namespace gazebo
     /// \sa LogRecord::Start
     class LogRecordParams
     {
-      /// \brief The type of encoding (txt, zlib, or bz2).
+      /// \brief The type of encoding (txt, zlib, bz2, or bin).
       public: std::string encoding = "zlib";
 
       /// \brief Path in which to store log files.
@@ -176,14 +176,15 @@ namespace gazebo
       public: bool Start(const LogRecordParams &_params);
 
       /// \brief Start the logger.
-      /// \param[in] _encoding The type of encoding (txt, zlib, or bz2).
+      /// \param[in] _encoding The type of encoding (txt, zlib, bz2, or bin).
       /// \param[in] _path Path in which to store log files.
       public: bool Start(const std::string &_encoding="zlib",
                          const std::string &_path="");
 
       /// \brief Get the encoding used.
-      /// \return Either [txt, zlib, or bz2], where txt is plain txt and bz2
-      /// and zlib are compressed data with Base64 encoding.
+      /// \return Either [txt, zlib, bz2, or bin], where txt is plain txt,
+      /// bz2 and zlib are compressed data with Base64 encoding, and bin is
+      /// a binary file of compressed blocks with a trailing time index.
       public: const std::string &Encoding() const;
 
       /// \brief Get the filename for a log object.
@@ -26,6 +26,8 @@
 #include <condition_variable>
 #include <boost/filesystem.hpp>
 
+#include "gazebo/util/LogBinary.hh"
+
 namespace gazebo
 {
   namespace util
@@ -101,6 +103,12 @@ namespace gazebo
 
         /// \brief Complete file path.
         public: boost::filesystem::path completePath;
+
+        /// \brief True if the log file uses the binary encoding.
+        public: bool binary = false;
+
+        /// \brief Produces the blocks and index of a binary log file.
+        public: LogBinaryWriter binaryWriter;
       };
 
       /// \def Log_M
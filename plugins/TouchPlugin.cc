@@ -17,8 +17,10 @@
 
 #include <functional>
 #include <string>
+#include <vector>
 #include <ignition/common/Profiler.hh>
 #include <gazebo/common/Assert.hh>
+#include <gazebo/physics/ContactManager.hh>
 #include <gazebo/physics/Model.hh>
 #include <gazebo/sensors/SensorManager.hh>
 #include <sdf/sdf.hh>
@@ -149,43 +151,49 @@ void TouchPlugin::OnUpdate(const common::UpdateInfo &_info)
 {
   IGN_PROFILE("TouchPlugin::OnUpdate");
   IGN_PROFILE_BEGIN("Update");
-  // Get all contacts across all sensors
-  msgs::Contacts contacts;
-
-  for (const auto &s : this->contactSensors)
-    contacts.MergeFrom(s->Contacts());
-
+  // Check the contacts of all sensors
   bool touching = false;
+  size_t contactCount = 0;
+
+  // Contacts of a sensor. Their memory is reused by every update that
+  // runs on this thread, from any plugin instance.
+  static thread_local std::vector<physics::ContactRecord> contacts;
 
-  for (int i = 0; i < contacts.contact_size(); ++i)
+  for (const auto &s : this->contactSensors)
   {
-    // Check for the target
-    bool col1Target = contacts.contact(i).collision1().find(this->target) !=
-        std::string::npos;
-    bool col2Target = contacts.contact(i).collision2().find(this->target) !=
-        std::string::npos;
-
-    if (col1Target || col2Target)
-      touching = true;
-
-    // Check for this model
-    bool col1Model = contacts.contact(i).collision1().find(this->modelName) !=
-        std::string::npos;
-    bool col2Model = contacts.contact(i).collision2().find(this->modelName) !=
-        std::string::npos;
-
-    // If the collisions are not target-model or model-target, we're touching
-    // something else
-    if (!((col1Target && col2Model) || (col1Model && col2Target)))
+    s->ContactRecords(contacts);
+    contactCount += contacts.size();
+
+    for (const auto &contact : contacts)
     {
-      if (touchStart != common::Time::Zero)
+      // Check for the target
+      bool col1Target = contact.collision1.find(this->target) !=
+          std::string::npos;
+      bool col2Target = contact.collision2.find(this->target) !=
+          std::string::npos;
+
+      if (col1Target || col2Target)
+        touching = true;
+
+      // Check for this model
+      bool col1Model = contact.collision1.find(this->modelName) !=
+          std::string::npos;
+      bool col2Model = contact.collision2.find(this->modelName) !=
+          std::string::npos;
+
+      // If the collisions are not target-model or model-target, we're
+      // touching something else
+      if (!((col1Target && col2Model) || (col1Model && col2Target)))
       {
-        gzmsg << "Touched something besides [" << this->target << "]"
-              << std::endl;
+        if (touchStart != common::Time::Zero)
+        {
+          gzmsg << "Touched something besides [" << this->target << "]"
+                << std::endl;
+        }
+        this->touchStart = common::Time::Zero;
+        IGN_PROFILE_END();
+        return;
       }
-      this->touchStart = common::Time::Zero;
-      IGN_PROFILE_END();
-      return;
     }
   }
 
@@ -193,7 +201,7 @@ void TouchPlugin::OnUpdate(const common::UpdateInfo &_info)
   if (!touching)
   {
     // Sanity check
-    if (contacts.contact_size() > 0)
+    if (contactCount > 0)
     {
       gzerr << "Not touching target, but touching something? "
             << "We shouldn't reach this point!" << std::endl;
@@ -16,12 +16,16 @@
 */
 
 #include <string.h>
+#include <algorithm>
+#include <cstdint>
+#include <vector>
 #include <ignition/math/Vector3.hh>
 
 // required for HAVE_DART_BULLET define
 #include <gazebo/gazebo_config.h>
 
 #include "gazebo/common/SystemPaths.hh"
+#include "gazebo/physics/RayQuery.hh"
 #include "gazebo/rendering/RenderingIface.hh"
 #include "gazebo/rendering/Scene.hh"
 #include "heights_cmp.h"
@@ -70,6 +74,10 @@ class HeightmapTest : public ServerFixture,
   public: void TerrainCollision(const std::string &_physicsEngine,
                                 const std::string &_dartCollision = "");
 
+  /// \brief Test dropping a sphere on an ODE terrain whose heights are
+  /// looked up in tiles, and compare the heights against the lookup table.
+  public: void OdeTiles();
+
   /// \brief Test loading a heightmap that has no visuals
   public: void NoVisual();
 
@@ -884,6 +892,90 @@ void HeightmapTest::TerrainCollision(const std::string &_physicsEngine,
   EXPECT_GE(spherePose.Pos().Z(), (minHeight + radius*0.99));
 }
 
+/////////////////////////////////////////////////
+void HeightmapTest::OdeTiles()
+{
+  // Tile every terrain, then drop the sphere on the tiled terrain
+  const uint64_t threshold = physics::HeightmapShape::TileThreshold();
+  physics::HeightmapShape::SetTileThreshold(0);
+  TerrainCollision("ode");
+  physics::HeightmapShape::SetTileThreshold(threshold);
+
+  physics::ModelPtr heightmap = GetModel("heightmap");
+  ASSERT_NE(heightmap, nullptr);
+  physics::HeightmapShapePtr heightmapShape =
+    boost::dynamic_pointer_cast<physics::HeightmapShape>(
+      heightmap->GetLink("link")->GetCollision("collision")->GetShape());
+  ASSERT_NE(heightmapShape, nullptr);
+  EXPECT_TRUE(heightmapShape->Tiled());
+
+  // The tiles have the heights of the lookup table ODE would have used
+  std::vector<float> heights;
+  heightmapShape->FillHeightfield(heights);
+  const int vertSize = heightmapShape->VertexCount().X();
+  ASSERT_EQ(heights.size(), static_cast<size_t>(vertSize * vertSize));
+  for (int y = 0; y < vertSize; ++y)
+  {
+    for (int x = 0; x < vertSize; ++x)
+    {
+      ASSERT_NEAR(heightmapShape->GetHeight(x, y),
+          heights[y * vertSize + x], 1e-5) << x << " " << y;
+    }
+  }
+  EXPECT_FLOAT_EQ(heightmapShape->GetMinHeight(),
+      *std::min_element(heights.begin(), heights.end()));
+  EXPECT_FLOAT_EQ(heightmapShape->GetMaxHeight(),
+      *std::max_element(heights.begin(), heights.end()));
+
+  // Normals of the tiled terrain are perpendicular to the slopes between
+  // the neighbours of each vertex, read from the lookup table
+  const ignition::math::Vector3d size = heightmapShape->Size();
+  const double dx = size.X() / (vertSize - 1);
+  const double dy = size.Y() / (vertSize - 1);
+  const int stride = std::max(vertSize / 8, 1);
+  for (int y = 1; y + 1 < vertSize; y += stride)
+  {
+    for (int x = 1; x + 1 < vertSize; x += stride)
+    {
+      const ignition::math::Vector3d normal = heightmapShape->Normal(x, y);
+      EXPECT_NEAR(normal.Length(), 1.0, 1e-6);
+      EXPECT_GT(normal.Z(), 0.0);
+      const ignition::math::Vector3d alongX(2 * dx, 0,
+          heights[y * vertSize + x + 1] - heights[y * vertSize + x - 1]);
+      const ignition::math::Vector3d alongY(0, -2 * dy,
+          heights[(y + 1) * vertSize + x] - heights[(y - 1) * vertSize + x]);
+      EXPECT_NEAR(normal.Dot(alongX), 0.0, 1e-4) << x << " " << y;
+      EXPECT_NEAR(normal.Dot(alongY), 0.0, 1e-4) << x << " " << y;
+    }
+  }
+
+  // Rays cast by the ray query land on the tiled heights
+  std::vector<physics::RayQueryRay> rays;
+  std::vector<float> expected;
+  for (int y = 0; y < vertSize; y += stride)
+  {
+    for (int x = 0; x < vertSize; x += stride)
+    {
+      const double px = -0.5 * size.X() + x * dx;
+      const double py = 0.5 * size.Y() - y * dy;
+      rays.push_back({{px, py, 100}, {px, py, -100}});
+      expected.push_back(heights[y * vertSize + x]);
+    }
+  }
+  physics::RayQueryResult result;
+  heightmap->GetWorld()->RayQuery().Cast(rays, result);
+  ASSERT_EQ(result.hits.size(), rays.size());
+  for (size_t i = 0; i < rays.size(); ++i)
+  {
+    if (result.hits[i].collision &&
+        result.hits[i].collision->GetModel() == heightmap)
+    {
+      EXPECT_NEAR(100 - result.hits[i].distance,
+          expected[i] + heightmapShape->Pos().Z(), 1e-4) << i;
+    }
+  }
+}
+
 /////////////////////////////////////////////////
 TEST_F(HeightmapTest, NotSquareImage)
 {
@@ -1101,6 +1193,12 @@ TEST_F(HeightmapTest, HeightmapCache)
   HeightmapCache();
 }
 
+/////////////////////////////////////////////////
+TEST_F(HeightmapTest, OdeTiles)
+{
+  OdeTiles();
+}
+
 INSTANTIATE_TEST_CASE_P(PhysicsEngines, HeightmapTest, PHYSICS_ENGINE_VALUES,);  // NOLINT
 
 /////////////////////////////////////////////////
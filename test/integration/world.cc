@@ -617,6 +617,57 @@ TEST_F(WorldTest, URI)
       "data://world/default/model/model_00/model/model_01/link/link_01");
 }
 
+/////////////////////////////////////////////////
+TEST_F(WorldTest, EntityIndex)
+{
+  Load("worlds/nested_model.world", true);
+  physics::WorldPtr world = physics::get_world("default");
+  ASSERT_TRUE(world != NULL);
+
+  // The root element
+  EXPECT_TRUE(world->BaseByName("default") != NULL);
+
+  // Scoped and unscoped names
+  physics::ModelPtr model = world->ModelByName("model_00");
+  ASSERT_TRUE(model != NULL);
+  physics::BasePtr nested = world->BaseByName("model_00::model_01");
+  ASSERT_TRUE(nested != NULL);
+  EXPECT_EQ(nested, world->BaseByName("model_01"));
+  physics::EntityPtr link =
+    world->EntityByName("model_00::model_01::link_01");
+  ASSERT_TRUE(link != NULL);
+  EXPECT_EQ(link, world->EntityByName("link_01"));
+  EXPECT_EQ(link, model->GetChild("model_01::link_01"));
+
+  // Ids
+  EXPECT_EQ(model, world->BaseById(model->GetId()));
+  EXPECT_EQ(link, world->BaseById(link->GetId()));
+
+  // Names that don't exist, or are the wrong type
+  EXPECT_TRUE(world->BaseByName("model_00::link_01") == NULL);
+  EXPECT_TRUE(world->ModelByName("link_01") == NULL);
+
+  // Renaming a model updates the scoped names of its children
+  model->SetName("renamed");
+  EXPECT_EQ(model, world->ModelByName("renamed"));
+  EXPECT_TRUE(world->ModelByName("model_00") == NULL);
+  EXPECT_EQ("renamed::model_01::link_01", link->GetScopedName());
+  EXPECT_EQ(link, world->EntityByName("renamed::model_01::link_01"));
+  EXPECT_TRUE(world->EntityByName("model_00::model_01::link_01") == NULL);
+  model->SetName("model_00");
+
+  // Removing a model removes its children
+  uint32_t linkId = link->GetId();
+  link.reset();
+  nested.reset();
+  world->RemoveModel(model);
+  model.reset();
+  EXPECT_TRUE(world->ModelByName("model_00") == NULL);
+  EXPECT_TRUE(world->EntityByName("model_00::model_01::link_01") == NULL);
+  EXPECT_TRUE(world->BaseById(linkId) == NULL);
+  EXPECT_TRUE(world->ModelByName("ground_plane") != NULL);
+}
+
 INSTANTIATE_TEST_CASE_P(PhysicsEngines, WorldTest, PHYSICS_ENGINE_VALUES,);  // NOLINT
 
 /////////////////////////////////////////////////
@@ -0,0 +1,143 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <string>
+#include <vector>
+
+#include "gazebo/transport/Connection.hh"
+#include "gazebo/transport/TransportIface.hh"
+#include "gazebo/test/ServerFixture.hh"
+
+using namespace gazebo;
+
+class MasterStressTest : public ServerFixture
+{
+  /// \brief Count the advertised topics of the test.
+  /// \return Number of topics whose name contains the test prefix.
+  public: static size_t TopicCount();
+};
+
+/// \brief Number of topics advertised and subscribed by the test.
+static const unsigned int g_topicCount = 2000;
+
+/// \brief Prefix of the topics of the test.
+static const char g_topicPrefix[] = "/gazebo/default/master_stress/";
+
+/////////////////////////////////////////////////
+size_t MasterStressTest::TopicCount()
+{
+  size_t count = 0;
+  std::map<std::string, std::list<std::string> > topics =
+    transport::getAdvertisedTopics();
+  for (auto const &msgType : topics)
+  {
+    for (auto const &topic : msgType.second)
+    {
+      if (topic.find(g_topicPrefix) == 0)
+        ++count;
+    }
+  }
+  return count;
+}
+
+/////////////////////////////////////////////////
+void OnMsg(ConstGzStringPtr &/*_msg*/)
+{
+}
+
+/////////////////////////////////////////////////
+TEST_F(MasterStressTest, AdvertiseSubscribeStorm)
+{
+  Load("worlds/empty.world");
+
+  transport::NodePtr node(new transport::Node());
+  node->Init("default");
+
+  std::vector<transport::PublisherPtr> pubs;
+  std::vector<transport::SubscriberPtr> subs;
+
+  // Advertise and subscribe to many topics at once
+  common::Time startTime = common::Time::GetWallTime();
+  for (unsigned int i = 0; i < g_topicCount; ++i)
+  {
+    std::string topic = "~/master_stress/topic_" + std::to_string(i);
+    pubs.push_back(node->Advertise<msgs::GzString>(topic));
+    subs.push_back(node->Subscribe(topic, &OnMsg));
+  }
+
+  // Wait for the master to announce all the publishers
+  int i = 0;
+  while (TopicCount() < g_topicCount && i < 600)
+  {
+    common::Time::MSleep(100);
+    ++i;
+  }
+  EXPECT_LT(i, 600);
+  common::Time endTime = common::Time::GetWallTime();
+  gzdbg << "Time to advertise and subscribe to " << g_topicCount
+        << " topics [" << endTime - startTime << "]\n";
+
+  // A new connection gets all the publishers when it connects
+  std::string host;
+  unsigned int port;
+  ASSERT_TRUE(transport::get_master_uri(host, port));
+
+  startTime = common::Time::GetWallTime();
+  transport::Connection conn;
+  ASSERT_TRUE(conn.Connect(host, port));
+
+  msgs::Packet packet;
+  std::string data;
+  for (unsigned int j = 0; j < 3 && packet.type() != "publishers_init"; ++j)
+  {
+    ASSERT_TRUE(conn.Read(data));
+    packet.ParseFromString(data);
+  }
+  ASSERT_EQ(packet.type(), "publishers_init");
+
+  msgs::Publishers publishers;
+  publishers.ParseFromString(packet.serialized_data());
+  EXPECT_GE(publishers.publisher_size(), static_cast<int>(g_topicCount));
+  endTime = common::Time::GetWallTime();
+  gzdbg << "Time to connect and get " << publishers.publisher_size()
+        << " publishers [" << endTime - startTime << "]\n";
+  conn.Shutdown();
+
+  // Unadvertise and unsubscribe from all the topics at once
+  startTime = common::Time::GetWallTime();
+  subs.clear();
+  pubs.clear();
+
+  i = 0;
+  while (TopicCount() > 0 && i < 600)
+  {
+    common::Time::MSleep(100);
+    ++i;
+  }
+  EXPECT_LT(i, 600);
+  endTime = common::Time::GetWallTime();
+  gzdbg << "Time to unadvertise and unsubscribe from " << g_topicCount
+        << " topics [" << endTime - startTime << "]\n";
+}
+
+/////////////////////////////////////////////////
+/// Main
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
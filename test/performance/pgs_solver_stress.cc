@@ -0,0 +1,149 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <map>
+#include <sstream>
+#include <string>
+
+#include "gazebo/physics/physics.hh"
+#include "gazebo/test/ServerFixture.hh"
+
+using namespace gazebo;
+
+class PGSSolverStressTest : public ServerFixture
+{
+  /// \brief Step the world from its initial state.
+  /// \param[in] _world World to step.
+  /// \param[in] _vectorized Value of the vectorized_rows parameter.
+  /// \param[out] _poses Final world pose of every link.
+  /// \return Wall time spent stepping.
+  public: common::Time Run(physics::WorldPtr _world, const bool _vectorized,
+              std::map<std::string, ignition::math::Pose3d> &_poses);
+
+  /// \brief Compare the scalar and vectorized PGS sweeps on a world.
+  /// \param[in] _world World to step.
+  public: void Compare(physics::WorldPtr _world);
+};
+
+/////////////////////////////////////////////////
+common::Time PGSSolverStressTest::Run(physics::WorldPtr _world,
+    const bool _vectorized,
+    std::map<std::string, ignition::math::Pose3d> &_poses)
+{
+  physics::PhysicsEnginePtr physics = _world->Physics();
+  EXPECT_TRUE(physics->SetParam("vectorized_rows", _vectorized));
+  _world->Reset();
+
+  common::Time startTime = common::Time::GetWallTime();
+  _world->Step(2000);
+  common::Time elapsed = common::Time::GetWallTime() - startTime;
+
+  _poses.clear();
+  for (auto const &model : _world->Models())
+  {
+    for (auto const &link : model->GetLinks())
+      _poses[link->GetScopedName()] = link->WorldPose();
+  }
+
+  gzdbg << "vectorized_rows [" << _vectorized << "] elapsed ["
+        << elapsed << "]\n";
+  return elapsed;
+}
+
+/////////////////////////////////////////////////
+void PGSSolverStressTest::Compare(physics::WorldPtr _world)
+{
+  ASSERT_TRUE(_world != nullptr);
+  physics::PhysicsEnginePtr physics = _world->Physics();
+  ASSERT_TRUE(physics != nullptr);
+  if (physics->GetType() != "ode")
+    return;
+
+  std::map<std::string, ignition::math::Pose3d> scalarPoses;
+  std::map<std::string, ignition::math::Pose3d> vectorPoses;
+  common::Time scalarTime = this->Run(_world, false, scalarPoses);
+  common::Time vectorTime = this->Run(_world, true, vectorPoses);
+
+  gzdbg << "scalar [" << scalarTime << "] vectorized [" << vectorTime
+        << "]\n";
+
+  // rows that share a body are solved in the same order, so the two sweeps
+  // follow the same trajectory
+  ASSERT_EQ(scalarPoses.size(), vectorPoses.size());
+  for (auto const &pose : scalarPoses)
+  {
+    const ignition::math::Pose3d &other = vectorPoses[pose.first];
+    EXPECT_NEAR(pose.second.Pos().Distance(other.Pos()), 0, 1e-6)
+        << pose.first;
+    EXPECT_NEAR(pose.second.Rot().Euler().Distance(other.Rot().Euler()), 0,
+        1e-6) << pose.first;
+  }
+}
+
+/////////////////////////////////////////////////
+TEST_F(PGSSolverStressTest, BoxStacks)
+{
+  Load("worlds/empty.world", true);
+  physics::WorldPtr world = physics::get_world("default");
+  ASSERT_TRUE(world != nullptr);
+
+  // 8 x 8 stacks of 5 boxes
+  for (int i = 0; i < 8; ++i)
+  {
+    for (int j = 0; j < 8; ++j)
+    {
+      for (int k = 0; k < 5; ++k)
+      {
+        std::ostringstream name;
+        name << "box_" << i << "_" << j << "_" << k;
+        SpawnBox(name.str(), ignition::math::Vector3d(0.5, 0.5, 0.5),
+            ignition::math::Vector3d(i * 1.0, j * 1.0, 0.25 + k * 0.5));
+      }
+    }
+  }
+
+  this->Compare(world);
+}
+
+/////////////////////////////////////////////////
+TEST_F(PGSSolverStressTest, Stacks)
+{
+  Load("worlds/stacks.world", true);
+  this->Compare(physics::get_world("default"));
+}
+
+/////////////////////////////////////////////////
+TEST_F(PGSSolverStressTest, FrictionSpheres)
+{
+  Load("test/worlds/friction_spheres.world", true);
+  this->Compare(physics::get_world("default"));
+}
+
+/////////////////////////////////////////////////
+TEST_F(PGSSolverStressTest, Gripper)
+{
+  Load("worlds/simple_gripper.world", true);
+  this->Compare(physics::get_world("default"));
+}
+
+/////////////////////////////////////////////////
+/// Main
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -15,7 +15,17 @@
  *
 */
 
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <set>
+#include <string>
+#include <vector>
+
 #include <boost/thread.hpp>
+#include "gazebo/transport/Publication.hh"
+#include "gazebo/transport/TopicManager.hh"
 #include "gazebo/test/ServerFixture.hh"
 #include "RAMLibrary.hh"
 
@@ -27,6 +37,71 @@ class TransportStressTest : public ServerFixture
 
 boost::mutex g_mutex;
 
+/// \brief Number of calls to operator new, used to report the number of
+/// allocations per published message.
+std::atomic<uint64_t> g_allocCount(0);
+
+/////////////////////////////////////////////////
+void *operator new(std::size_t _size)
+{
+  ++g_allocCount;
+  void *ptr = std::malloc(_size > 0 ? _size : 1);
+  if (!ptr)
+    throw std::bad_alloc();
+  return ptr;
+}
+
+/////////////////////////////////////////////////
+void operator delete(void *_ptr) noexcept
+{
+  std::free(_ptr);
+}
+
+/////////////////////////////////////////////////
+void operator delete(void *_ptr, std::size_t) noexcept
+{
+  std::free(_ptr);
+}
+
+/// \brief A remote-like subscription that records the buffers it
+/// receives, without sending them anywhere.
+class SharedDataCounter : public transport::CallbackHelper
+{
+  // Documentation inherited
+  public: virtual bool HandleData(const std::string &_newdata,
+              boost::function<void(uint32_t)> _cb, uint32_t _id)
+          {
+            boost::mutex::scoped_lock lock(g_mutex);
+            ++this->received;
+            this->buffers.push_back(&_newdata);
+            this->lastSize = _newdata.size();
+            if (!_cb.empty())
+              _cb(_id);
+            return true;
+          }
+
+  // Documentation inherited
+  public: virtual bool HandleMessage(MessagePtr /*_newMsg*/)
+          {
+            return true;
+          }
+
+  // Documentation inherited
+  public: virtual bool IsLocal() const
+          {
+            return false;
+          }
+
+  /// \brief Number of buffers received.
+  public: unsigned int received = 0;
+
+  /// \brief Addresses of the received buffers, in order of arrival.
+  public: std::vector<const std::string *> buffers;
+
+  /// \brief Size of the last received buffer.
+  public: std::size_t lastSize = 0;
+};
+
 unsigned int g_localPublishMessageCount = 0;
 unsigned int g_localPublishCount = 0;
 unsigned int g_totalExpectedMsgCount = 0;
@@ -236,6 +311,111 @@ TEST_F(TransportStressTest, ManyNodes)
   delete [] fakeData;
 }
 
+/////////////////////////////////////////////////
+// Publish a large message to many remote-like subscriptions and a local
+// subscriber. Each message must be serialized once, and the same buffer
+// must be shared by all the remote subscriptions and the latched copy.
+// Reports the throughput and the number of allocations per message.
+TEST_F(TransportStressTest, SerializeOnceFanOut)
+{
+  Load("worlds/empty.world");
+
+  const unsigned int subCount = 16;
+  g_localPublishMessageCount = 1000;
+  g_totalExpectedMsgCount = g_localPublishMessageCount;
+  g_localPublishCount = 0;
+
+  transport::NodePtr testNode = transport::NodePtr(new transport::Node());
+  testNode->Init("default");
+
+  const std::string topic = "~/test/fan_out__";
+  transport::PublisherPtr pub = testNode->Advertise<msgs::Image>(
+      topic, g_localPublishMessageCount);
+
+  transport::SubscriberPtr sub = testNode->Subscribe(topic, &LocalPublishCB);
+
+  transport::PublicationPtr publication =
+    transport::TopicManager::Instance()->FindPublication(
+        testNode->DecodeTopicName(topic));
+  ASSERT_TRUE(publication != NULL);
+
+  std::vector<boost::shared_ptr<SharedDataCounter> > counters;
+  for (unsigned int i = 0; i < subCount; ++i)
+  {
+    counters.push_back(boost::shared_ptr<SharedDataCounter>(
+          new SharedDataCounter()));
+    publication->AddSubscription(counters.back());
+  }
+
+  unsigned int width = 1024;
+  unsigned int height = 1024;
+  std::string fakeData(width * height, 'x');
+
+  msgs::Image fakeMsg;
+  fakeMsg.set_width(width);
+  fakeMsg.set_height(height);
+  fakeMsg.set_pixel_format(0);
+  fakeMsg.set_step(1);
+  fakeMsg.set_data(fakeData);
+
+  uint64_t startAllocs = g_allocCount;
+  common::Time startTime = common::Time::GetWallTime();
+
+  for (unsigned int i = 0; i < g_localPublishMessageCount; ++i)
+    pub->Publish(fakeMsg);
+
+  // Wait for all the messages
+  int waitCount = 0;
+  while (waitCount < 50)
+  {
+    {
+      boost::mutex::scoped_lock lock(g_mutex);
+      bool done = g_localPublishCount >= g_totalExpectedMsgCount;
+      for (auto const &counter : counters)
+        done = done && counter->received >= g_localPublishMessageCount;
+      if (done)
+        break;
+    }
+    common::Time::MSleep(100);
+    waitCount++;
+  }
+
+  common::Time diff = common::Time::GetWallTime() - startTime;
+  uint64_t allocs = g_allocCount - startAllocs;
+
+  EXPECT_LT(waitCount, 50);
+  EXPECT_EQ(g_totalExpectedMsgCount, g_localPublishCount);
+
+  // Every subscription got every message.
+  for (auto const &counter : counters)
+  {
+    EXPECT_EQ(g_localPublishMessageCount, counter->received);
+    ASSERT_EQ(g_localPublishMessageCount, counter->buffers.size());
+  }
+
+  // Each message was serialized once, into a buffer handed to all the
+  // subscriptions.
+  for (unsigned int i = 0; i < g_localPublishMessageCount; ++i)
+  {
+    std::set<const std::string *> buffers;
+    for (auto const &counter : counters)
+      buffers.insert(counter->buffers[i]);
+    EXPECT_EQ(1u, buffers.size()) << "message " << i;
+  }
+
+  // The latched message of the publisher is the last message sent.
+  EXPECT_EQ(counters.front()->lastSize, pub->GetPrevMsg().size());
+
+  double seconds = std::max(diff.Double(), 1e-9);
+  gzmsg << "Published " << g_localPublishMessageCount << " messages to "
+    << subCount << " remote and 1 local subscribers in " << diff << "\n"
+    << "  Throughput: " << g_localPublishMessageCount / seconds
+    << " msgs/sec\n"
+    << "  Allocations: "
+    << static_cast<double>(allocs) / g_localPublishMessageCount
+    << " per message" << std::endl;
+}
+
 /////////////////////////////////////////////////
 // Main function
 int main(int argc, char **argv)
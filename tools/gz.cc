@@ -1324,7 +1324,10 @@ int main(int argc, char **argv)
 
   if (iter != g_commandMap.end())
   {
-    g_commandMap[command]->Run(argc, argv);
+    // Only gz log reports a failure in its exit status, so that scripts
+    // can detect a truncated log. The other commands keep exiting with 0.
+    if (!g_commandMap[command]->Run(argc, argv) && command == "log")
+      result = -1;
   }
   else
   {
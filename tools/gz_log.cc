@@ -17,16 +17,13 @@
 #include <boost/algorithm/string.hpp>
 #include <boost/date_time/posix_time/posix_time.hpp>
 #include <boost/date_time/posix_time/posix_time_io.hpp>
-#include <boost/iostreams/filter/bzip2.hpp>
-#include <boost/iostreams/filter/zlib.hpp>
-#include <boost/iostreams/filtering_stream.hpp>
-#include <boost/iostreams/copy.hpp>
 
 #include <ignition/math/Pose3.hh>
 #include <ignition/math/Vector3.hh>
 
 #include <gazebo/util/util.hh>
 #include "gz_log.hh"
+#include "gz_log_stream.hh"
 
 sdf::ElementPtr g_stateSdf;
 
@@ -167,6 +164,11 @@ void JointFilter::Init(const std::string &_filter)
 
     if (this->parts.empty())
       this->parts.push_back(_filter);
+
+    // The first element in the filter must be a joint name or a star.
+    std::string regexStr = this->parts.front();
+    boost::replace_all(regexStr, "*", ".*");
+    this->regex = boost::regex(regexStr);
   }
 }
 
@@ -235,10 +237,7 @@ std::string JointFilter::Filter(gazebo::physics::ModelState &_state)
   partIter = this->parts.begin();
 
   // The first element in the filter must be a link name or a star.
-  std::string regexStr = *partIter;
-  boost::replace_all(regexStr, "*", ".*");
-  boost::regex regex(regexStr);
-  states = _state.GetJointStates(regex);
+  states = _state.GetJointStates(this->regex);
 
   ++partIter;
 
@@ -288,6 +287,14 @@ void LinkFilter::Init(const std::string &_filter)
 
     if (this->parts.empty())
       this->parts.push_back(_filter);
+
+    // The first element in the filter must be a link name or a star.
+    if (this->parts.front() != "*")
+    {
+      std::string regexStr = this->parts.front();
+      boost::replace_all(regexStr, "*", ".*");
+      this->regex = boost::regex(regexStr);
+    }
   }
 }
 
@@ -340,12 +347,7 @@ std::string LinkFilter::Filter(gazebo::physics::ModelState &_state)
 
   // The first element in the filter must be a link name or a star.
   if (*partIter != "*")
-  {
-    std::string regexStr = *partIter;
-    boost::replace_all(regexStr, "*", ".*");
-    boost::regex regex(regexStr);
-    states = _state.GetLinkStates(regex);
-  }
+    states = _state.GetLinkStates(this->regex);
   else
     states = _state.GetLinkStates();
 
@@ -396,6 +398,7 @@ void ModelFilter::Init(const std::string &_filter)
   this->linkFilter = NULL;
   this->jointFilter = NULL;
   this->parts.clear();
+  this->useRegex = false;
 
   if (_filter.empty())
     return;
@@ -412,6 +415,16 @@ void ModelFilter::Init(const std::string &_filter)
       this->parts.push_back(mainParts.front());
   }
 
+  // The first element in the filter must be a model name or a star.
+  this->useRegex = !this->parts.empty() && !this->parts.front().empty() &&
+      this->parts.front() != "*";
+  if (this->useRegex)
+  {
+    std::string regexStr = this->parts.front();
+    boost::replace_all(regexStr, "*", ".*");
+    this->regex = boost::regex(regexStr);
+  }
+
   if (mainParts.empty())
     return;
 
@@ -475,14 +488,8 @@ std::string ModelFilter::Filter(gazebo::physics::WorldState &_state)
   std::list<std::string>::iterator partIter = this->parts.begin();
 
   // The first element in the filter must be a model name or a star.
-  if (partIter != this->parts.end() && !this->parts.empty() &&
-      !(*partIter).empty() && (*partIter) != "*")
-  {
-    std::string regexStr = *partIter;
-    boost::replace_all(regexStr, "*", ".*");
-    boost::regex regex(regexStr);
-    states = _state.GetModelStates(regex);
-  }
+  if (this->useRegex)
+    states = _state.GetModelStates(this->regex);
   else
     states = _state.GetModelStates();
 
@@ -526,8 +533,10 @@ std::string ModelFilter::Filter(gazebo::physics::WorldState &_state)
 StateFilter::StateFilter(bool _xmlOutput, const std::string &_stamp,
               double _hz)
 : FilterBase(_xmlOutput, _stamp), filter(_xmlOutput, _stamp),
-  hz(_hz)
-{}
+  stateSdf(new sdf::Element), hz(_hz)
+{
+  sdf::initFile("state.sdf", this->stateSdf);
+}
 
 /////////////////////////////////////////////////
 void StateFilter::Init(const std::string &_filter)
@@ -536,36 +545,49 @@ void StateFilter::Init(const std::string &_filter)
 }
 
 /////////////////////////////////////////////////
-std::string StateFilter::Filter(const std::string &_stateString)
+void StateFilter::Load(const std::string &_stateString,
+    gazebo::physics::WorldState &_state)
 {
-  gazebo::physics::WorldState state;
-
   // Read and parse the state information
-  g_stateSdf->Clear();
-  sdf::readString(_stateString, g_stateSdf);
-  state.Load(g_stateSdf);
+  this->stateSdf->Clear();
+  sdf::readString(_stateString, this->stateSdf);
+  _state.Load(this->stateSdf);
+}
 
-  std::ostringstream result;
+/////////////////////////////////////////////////
+std::string StateFilter::Filter(const std::string &_stateString)
+{
+  gazebo::physics::WorldState state;
+  this->Load(_stateString, state);
 
   if (this->hz > 0.0 && this->prevTime != gazebo::common::Time::Zero)
   {
     if ((state.GetSimTime() - this->prevTime).Double() <
         1.0 / this->hz)
     {
-      return result.str();
+      return std::string();
     }
   }
 
+  this->prevTime = state.GetSimTime();
+  return this->Filter(state);
+}
+
+/////////////////////////////////////////////////
+std::string StateFilter::Filter(gazebo::physics::WorldState &_state)
+{
+  std::ostringstream result;
+
   if (this->xmlOutput)
   {
     result << "<sdf version='" << SDF_VERSION << "'>\n"
-      << "<state world_name='" << state.GetName() << "'>\n"
-      << "<sim_time>" << state.GetSimTime() << "</sim_time>\n"
-      << "<real_time>" << state.GetRealTime() << "</real_time>\n"
-      << "<wall_time>" << state.GetWallTime() << "</wall_time>\n"
-      << "<iterations>" << state.GetIterations() << "</iterations>\n";
+      << "<state world_name='" << _state.GetName() << "'>\n"
+      << "<sim_time>" << _state.GetSimTime() << "</sim_time>\n"
+      << "<real_time>" << _state.GetRealTime() << "</real_time>\n"
+      << "<wall_time>" << _state.GetWallTime() << "</wall_time>\n"
+      << "<iterations>" << _state.GetIterations() << "</iterations>\n";
 
-    auto insertions = state.Insertions();
+    auto insertions = _state.Insertions();
     if (insertions.size() > 0)
       result << "<insertions>" << std::endl;
     for (auto insertion : insertions)
@@ -573,7 +595,7 @@ std::string StateFilter::Filter(const std::string &_stateString)
     if (insertions.size() > 0)
       result << "</insertions>" << std::endl;
 
-    auto deletions = state.Deletions();
+    auto deletions = _state.Deletions();
     if (deletions.size() > 0)
       result << "<deletions>" << std::endl;
     for (auto deletion : deletions)
@@ -582,12 +604,11 @@ std::string StateFilter::Filter(const std::string &_stateString)
       result << "</deletions>" << std::endl;
   }
 
-  result << this->filter.Filter(state);
+  result << this->filter.Filter(_state);
 
   if (this->xmlOutput)
     result << "</state></sdf>\n";
 
-  this->prevTime = state.GetSimTime();
   return result.str();
 }
 
@@ -618,11 +639,20 @@ LogCommand::LogCommand()
      "encoding commands. By default, the output file will have the same "
      "encoding as the source file. Override with the --encoding option")
     ("encoding,n", po::value<std::string>(),
-     "Specify the encoding (txt, zlib, or bz2) for an output file. "
+     "Specify the encoding (txt, zlib, bz2, or bin) for an output file. "
      "Valid in conjunction with the output command. See also the "
      "--output argument.")
     ("filter", po::value<std::string>(),
-     "Filter output. Valid only with the echo, step, and output commands");
+     "Filter output. Valid only with the echo, step, and output commands")
+    ("stream", "Read the log file one chunk at a time, and decode and filter "
+     "the chunks on a pool of threads, instead of loading the whole file. "
+     "Valid with the echo and output commands.")
+    ("threads,j", po::value<unsigned int>(), "Number of threads used by "
+     "--stream. Defaults to the number of cores.")
+    ("columns", po::value<std::string>(), "Output the fields selected by "
+     "--filter as columns, in csv or bin format, instead of states. "
+     "Implies --stream.")
+    ("progress", "Report the progress and the throughput of --stream.");
 }
 
 /////////////////////////////////////////////////
@@ -668,6 +698,10 @@ bool LogCommand::RunImpl()
 
   raw = this->vm.count("raw");
 
+  const bool stream =
+    (this->vm.count("stream") || this->vm.count("columns")) &&
+    (this->vm.count("output") || this->vm.count("echo"));
+
   if (!this->vm.count("record"))
   {
     // Load the log file
@@ -681,6 +715,10 @@ bool LogCommand::RunImpl()
       return false;
     }
 
+    // Streams read the log file themselves
+    if (stream)
+      return this->Stream(filename, filter, raw, stamp, hz);
+
     // Load log file from string
     if (!this->LoadLogFromFile(filename))
     {
@@ -841,16 +879,31 @@ void LogCommand::Output(const std::string &_outFilename,
   std::string stateString, bufferString;
 
   std::string encoding = _encoding.empty() ? play->Encoding() : _encoding;
-  if (encoding != "txt" && encoding != "zlib" && encoding != "bz2")
+  const bool binary = encoding == gazebo::util::kLogBinaryEncoding;
+  if (encoding != "txt" && encoding != "zlib" && encoding != "bz2" && !binary)
   {
     std::cerr << "Invalid log file encoding[" << encoding << "]. "
-      << "Use one of: txt, bz2, zlib.\n";
+      << "Use one of: txt, bz2, zlib, bin.\n";
     outFile.close();
     return;
   }
 
   // Output the header
-  if (!_raw)
+  if (!_raw && binary)
+  {
+    // Binary logs only store the <header> element.
+    std::string header = play->Header();
+    const std::string endHeader = "</header>";
+    auto from = header.find("<header>");
+    auto to = header.find(endHeader);
+    if (from != std::string::npos && to != std::string::npos)
+      header = header.substr(from, to + endHeader.size() - from) + "\n";
+
+    std::string buffer;
+    this->binaryWriter.Start(header, buffer);
+    outFile.write(buffer.c_str(), buffer.size());
+  }
+  else if (!_raw)
   {
     std::string header = play->Header();
     outFile.write(header.c_str(), header.size());
@@ -883,7 +936,13 @@ void LogCommand::Output(const std::string &_outFilename,
   if (!bufferString.empty())
     this->OutputWriter(outFile, bufferString, _raw, encoding);
 
-  if (!_raw)
+  if (!_raw && binary)
+  {
+    std::string index;
+    this->binaryWriter.Finish(index);
+    outFile.write(index.c_str(), index.size());
+  }
+  else if (!_raw)
   {
     std::string endTag = "</gazebo_log>\n";
     outFile.write(endTag.c_str(), endTag.size());
@@ -1045,6 +1104,43 @@ int LogCommand::GetChar()
 # endif
 }
 
+/////////////////////////////////////////////////
+bool LogCommand::Stream(const std::string &_filename,
+    const std::string &_filter, const bool _raw,
+    const std::string &_stamp, const double _hz)
+{
+  LogStream stream(_filter, _raw, _stamp, _hz);
+
+  if (this->vm.count("threads"))
+    stream.SetThreads(this->vm["threads"].as<unsigned int>());
+
+  if (this->vm.count("columns") &&
+      !stream.SetColumns(this->vm["columns"].as<std::string>()))
+  {
+    std::cerr << "For more info: gz help log\n";
+    return false;
+  }
+
+  stream.SetProgress(this->vm.count("progress") > 0);
+
+  // Echo to screen
+  if (!this->vm.count("output"))
+    return stream.Run(_filename, std::cout, "txt");
+
+  const std::string outFilename = this->vm["output"].as<std::string>();
+  std::ofstream outFile(outFilename, std::fstream::out | std::ios::binary);
+  if (!outFile.is_open())
+  {
+    std::cerr << "Unable to open file[" << outFilename << "] for writing.\n";
+    return false;
+  }
+
+  const std::string encoding = this->vm.count("encoding") ?
+    this->vm["encoding"].as<std::string>() : "";
+
+  return stream.Run(_filename, outFile, encoding);
+}
+
 /////////////////////////////////////////////////
 bool LogCommand::LoadLogFromFile(const std::string &_filename)
 {
@@ -1072,45 +1168,16 @@ void LogCommand::OutputWriter(std::ofstream &_outFile,
     const std::string &_stateString, const bool _raw,
     const std::string &_encoding)
 {
-  if (!_raw)
+  if (!_raw && _encoding == gazebo::util::kLogBinaryEncoding)
+  {
+    std::string buffer;
+    this->binaryWriter.AppendBlock(_stateString, buffer);
+    _outFile.write(buffer.c_str(), buffer.size());
+  }
+  else if (!_raw)
   {
     std::string buffer = "<chunk encoding='" + _encoding + "'>\n<![CDATA[";
-
-    if (_encoding == "txt")
-      buffer.append(_stateString);
-    else if (_encoding == "zlib")
-    {
-      std::string str;
-
-      // Compress to zlib
-      {
-        boost::iostreams::filtering_ostream out;
-        out.push(boost::iostreams::zlib_compressor());
-        out.push(std::back_inserter(str));
-        boost::iostreams::copy(
-            boost::make_iterator_range(_stateString), out);
-      }
-
-      // Encode in base64.
-      Base64Encode(str.c_str(), str.size(), buffer);
-    }
-    else if (_encoding == "bz2")
-    {
-      std::string str;
-
-      // Compress to bzip2
-      {
-        boost::iostreams::filtering_ostream out;
-        out.push(boost::iostreams::bzip2_compressor());
-        out.push(std::back_inserter(str));
-        boost::iostreams::copy(
-            boost::make_iterator_range(_stateString), out);
-      }
-
-      // Encode in base64.
-      Base64Encode(str.c_str(), str.size(), buffer);
-    }
-
+    EncodeChunk(_stateString, _encoding, buffer);
     buffer.append("]]>\n</chunk>\n");
     _outFile.write(buffer.c_str(), buffer.size());
   }
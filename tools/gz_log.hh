@@ -20,7 +20,11 @@
 #include <string>
 #include <list>
 
+#include <boost/regex.hpp>
+#include <sdf/sdf.hh>
+
 #include <gazebo/physics/WorldState.hh>
+#include "gazebo/util/LogBinary.hh"
 #include "gz.hh"
 
 namespace gazebo
@@ -87,6 +91,9 @@ namespace gazebo
 
     /// \brief The list of filter strings.
     public: std::list<std::string> parts;
+
+    /// \brief Joint name expression, compiled once by Init.
+    private: boost::regex regex;
   };
 
   /// \brief Filter for link state.
@@ -117,6 +124,9 @@ namespace gazebo
 
     /// \brief The list of filter strings.
     public: std::list<std::string> parts;
+
+    /// \brief Link name expression, compiled once by Init.
+    private: boost::regex regex;
   };
 
   /// \brief Filter for model state.
@@ -156,6 +166,13 @@ namespace gazebo
 
     /// \brief Pointer to the joint filter.
     public: JointFilter *jointFilter;
+
+    /// \brief Model name expression, compiled once by Init.
+    private: boost::regex regex;
+
+    /// \brief True if the model name expression is used, false to filter
+    /// all the models.
+    private: bool useRegex = false;
   };
 
   /// \brief Filter interface for an entire state.
@@ -177,9 +194,25 @@ namespace gazebo
     /// \return Filtered string
     public: std::string Filter(const std::string &_stateString);
 
+    /// \brief Filter a state that is already parsed. The Hz rate is not
+    /// applied.
+    /// \param[in] _state The state to filter.
+    /// \return Filtered string
+    public: std::string Filter(gazebo::physics::WorldState &_state);
+
+    /// \brief Parse a state string. Each filter has its own SDF element,
+    /// so that filters can parse states on several threads.
+    /// \param[in] _stateString The state string.
+    /// \param[out] _state The parsed state.
+    public: void Load(const std::string &_stateString,
+                gazebo::physics::WorldState &_state);
+
     /// \brief Filter for a model.
     private: ModelFilter filter;
 
+    /// \brief SDF element the states are parsed into.
+    private: sdf::ElementPtr stateSdf;
+
     /// \brief Rate at which to output states.
     private: double hz;
 
@@ -254,6 +287,19 @@ namespace gazebo
     /// \return The size of the file in human readable format.
     private: std::string GetFileSizeStr(const std::string &_filename);
 
+    /// \brief Process a log file with a LogStream, without loading it
+    /// whole. The output goes to the --output file, or to the screen.
+    /// \param[in] _filename Name of the log file.
+    /// \param[in] _filter Filter string
+    /// \param[in] _raw True to output data without xml formatting.
+    /// \param[in] _stamp Type of stamp to apply.
+    /// Valid values are (sim,real,wall)
+    /// \param[in] _hz Hertz rate.
+    /// \return True on success.
+    private: bool Stream(const std::string &_filename,
+                 const std::string &_filter, const bool _raw,
+                 const std::string &_stamp, const double _hz);
+
     /// \brief Load a log file from a filename.
     /// \param[in] _filename Filename to open
     /// \return True on success.
@@ -264,11 +310,14 @@ namespace gazebo
     /// \param[in] _outFile Output file stream reference.
     /// \param[in] _stateString SDF state string to write
     /// \param[in] _raw True to output data without xml formatting.
-    /// \param[in] _encoding Encoding type: txt, zlib, bz2
+    /// \param[in] _encoding Encoding type: txt, zlib, bz2, bin
     private: void OutputWriter(std::ofstream &_outFile,
                  const std::string &_stateString,
                  const bool _raw, const std::string &_encoding);
 
+    /// \brief Produces the blocks and index of a binary output file.
+    private: gazebo::util::LogBinaryWriter binaryWriter;
+
     /// \brief Node pointer.
     private: gazebo::transport::NodePtr node;
   };
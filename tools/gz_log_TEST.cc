@@ -17,6 +17,8 @@
 #include <thread>
 #include <gtest/gtest.h>
 #include <boost/lexical_cast.hpp>
+#include <boost/algorithm/string/classification.hpp>
+#include <boost/algorithm/string/split.hpp>
 #include <boost/algorithm/string/trim.hpp>
 #include <gazebo/common/CommonIface.hh>
 #include <gazebo/common/Time.hh>
@@ -24,7 +26,12 @@
 #include <sdf/sdf_config.h>
 
 #include <stdio.h>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <sstream>
 #include <string>
+#include <vector>
 
 // This header file isn't needed if shasums are used
 // #include "test/data/pr2_state_log_expected.h"
@@ -474,6 +481,76 @@ TEST(gz_log, Output)
 #endif
 }
 
+/////////////////////////////////////////////////
+/// Check that 'gz log --stream' outputs the same states as without it
+TEST(gz_log, Stream)
+{
+  const std::string logFile =
+    std::string(PROJECT_SOURCE_PATH) + "/test/data/pr2_state.log";
+
+  for (auto const &filter :
+      {"pr2.pose.x", "pr2/r_upper*.pose", "pr2//r_upper_arm_roll_joint"})
+  {
+    std::string echo = custom_exec(GZ_LOG_PATH +
+        " -e -r --stamp sim --filter " + filter + " -f " + logFile);
+    std::string stream = custom_exec(GZ_LOG_PATH +
+        " -e -r --stream -j 3 --stamp sim --filter " + filter + " -f " +
+        logFile);
+    EXPECT_FALSE(stream.empty()) << filter;
+    EXPECT_EQ(echo, stream) << filter;
+  }
+
+  // Hz filter
+  std::string stream = custom_exec(GZ_LOG_PATH +
+      " -e -r --stream -z 1.0 --filter pr2.pose.z -f " + logFile);
+  boost::trim_right(stream);
+  EXPECT_EQ("-0.000008", stream);
+
+  // Columns
+  stream = custom_exec(GZ_LOG_PATH +
+      " -e --columns csv --filter pr2.pose.[x,z] -f " + logFile);
+  std::vector<std::string> lines;
+  boost::trim_right(stream);
+  boost::split(lines, stream, boost::is_any_of("\n"));
+  ASSERT_EQ(lines.size(), 3u);
+  EXPECT_EQ(lines[0], "sim_time,pr2.pose.x,pr2.pose.z");
+  EXPECT_EQ(lines[1].find("0.021344"), 0u);
+  EXPECT_EQ(lines[2].find("0.028958"), 0u);
+
+  // Streamed output file
+  std::ostringstream newFileStream;
+  newFileStream << "/tmp/__gz_log_stream_test" << std::this_thread::get_id()
+    << ".log";
+  custom_exec(GZ_LOG_PATH + " --stream -f " + logFile + " -o " +
+      newFileStream.str());
+
+  std::string origEcho = custom_exec(GZ_LOG_PATH + " -e -f " + logFile);
+  std::string newEcho = custom_exec(GZ_LOG_PATH + " -e -f " +
+      newFileStream.str());
+  EXPECT_FALSE(newEcho.empty());
+  EXPECT_EQ(origEcho, newEcho);
+
+  // A log that ends in the middle of a chunk is an error
+  const std::string truncatedFile = newFileStream.str() + ".truncated";
+  {
+    std::ifstream in(logFile, std::ios::binary);
+    const std::string data((std::istreambuf_iterator<char>(in)),
+        std::istreambuf_iterator<char>());
+    std::ofstream out(truncatedFile, std::ios::binary);
+    out << data.substr(0, data.rfind("</chunk>") - 16);
+  }
+  EXPECT_NE(0, std::system((GZ_LOG_PATH + " -e --stream -f " +
+      truncatedFile + " > /dev/null 2>&1").c_str()));
+
+  // So is an invalid name expression
+  EXPECT_NE(0, std::system((GZ_LOG_PATH +
+      " -e --columns csv --filter \"pr2(\" -f " + logFile +
+      " > /dev/null 2>&1").c_str()));
+
+  std::remove(newFileStream.str().c_str());
+  std::remove(truncatedFile.c_str());
+}
+
 /////////////////////////////////////////////////
 /// Main
 int main(int argc, char **argv)
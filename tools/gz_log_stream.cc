@@ -0,0 +1,1182 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+#include <cctype>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+#include <boost/algorithm/string.hpp>
+#include <boost/iostreams/copy.hpp>
+#include <boost/iostreams/filter/bzip2.hpp>
+#include <boost/iostreams/filter/zlib.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
+#include <boost/lexical_cast.hpp>
+
+#include <ignition/math/Vector3.hh>
+
+#include "gazebo/common/Base64.hh"
+#include "gz_log_stream.hh"
+
+using namespace gazebo;
+
+namespace
+{
+  /// \brief Start of a <chunk> element.
+  const std::string kChunkStart = "<chunk";
+
+  /// \brief End of a <chunk> element.
+  const std::string kChunkEnd = "</chunk>";
+
+  /// \brief Start of a CDATA section.
+  const std::string kCDataStart = "<![CDATA[";
+
+  /// \brief End of a CDATA section.
+  const std::string kCDataEnd = "]]>";
+
+  /// \brief Start of a state, same as LogPlay.
+  const std::string kStartFrame = "<sdf ";
+
+  /// \brief End of a state, same as LogPlay.
+  const std::string kEndFrame = "</sdf>";
+
+  /////////////////////////////////////////////////
+  /// \brief Get the value of an attribute of an XML start tag.
+  /// \param[in] _tag The start tag.
+  /// \param[in] _name Name of the attribute.
+  /// \return Value of the attribute, empty if it is missing.
+  std::string Attribute(const std::string &_tag, const std::string &_name)
+  {
+    auto from = _tag.find(_name + "=");
+    if (from == std::string::npos || from + _name.size() + 1 >= _tag.size())
+      return std::string();
+
+    from += _name.size() + 1;
+    const char quote = _tag[from];
+    const auto to = _tag.find(quote, from + 1);
+    if ((quote != '\'' && quote != '"') || to == std::string::npos)
+      return std::string();
+
+    return _tag.substr(from + 1, to - from - 1);
+  }
+
+  /////////////////////////////////////////////////
+  /// \brief Wrap data in a <chunk> element.
+  /// \param[in] _data The data.
+  /// \param[in] _encoding Encoding of the chunk: txt, zlib or bz2.
+  /// \return The chunk element.
+  std::string ChunkXml(const std::string &_data, const std::string &_encoding)
+  {
+    std::string chunk = "<chunk encoding='" + _encoding + "'>\n<![CDATA[";
+    EncodeChunk(_data, _encoding, chunk);
+    chunk.append("]]>\n</chunk>\n");
+    return chunk;
+  }
+
+  /////////////////////////////////////////////////
+  /// \brief Compile a name expression of a filter, where '*' matches any
+  /// sequence of characters.
+  /// \param[in] _name The name expression.
+  /// \param[out] _regex The regular expression.
+  /// \return False if the expression is not valid.
+  bool NameRegex(std::string _name, boost::regex &_regex)
+  {
+    boost::replace_all(_name, "*", ".*");
+    try
+    {
+      _regex = boost::regex(_name);
+    }
+    catch(const boost::regex_error &_e)
+    {
+      std::cerr << "Invalid name expression[" << _name << "]: "
+                << _e.what() << "\n";
+      return false;
+    }
+    return true;
+  }
+
+  /////////////////////////////////////////////////
+  /// \brief Get the time stamp of a state.
+  /// \param[in] _state The state.
+  /// \param[in] _stamp Type of stamp: sim, real, wall or iterations.
+  /// \return The time stamp.
+  double Stamp(const physics::State &_state, const std::string &_stamp)
+  {
+    if (_stamp == "real")
+      return _state.GetRealTime().Double();
+    else if (_stamp == "wall")
+      return _state.GetWallTime().Double();
+    else if (_stamp == "iterations")
+      return static_cast<double>(_state.GetIterations());
+    return _state.GetSimTime().Double();
+  }
+
+  /////////////////////////////////////////////////
+  /// \brief Get the name of the time stamp column.
+  /// \param[in] _stamp Type of stamp: sim, real, wall or iterations.
+  /// \return Name of the column.
+  std::string StampName(const std::string &_stamp)
+  {
+    if (_stamp == "real" || _stamp == "wall")
+      return _stamp + "_time";
+    else if (_stamp == "iterations")
+      return _stamp;
+    return "sim_time";
+  }
+
+  /////////////////////////////////////////////////
+  /// \brief Write a little endian 32 bit integer.
+  /// \param[in] _out Output stream.
+  /// \param[in] _value The value.
+  void PutU32(std::ostream &_out, const uint32_t _value)
+  {
+    char bytes[4];
+    for (int i = 0; i < 4; ++i)
+      bytes[i] = static_cast<char>((_value >> (8 * i)) & 0xFF);
+    _out.write(bytes, sizeof(bytes));
+  }
+
+  /////////////////////////////////////////////////
+  /// \brief Write a little endian 64 bit float.
+  /// \param[in] _out Output stream.
+  /// \param[in] _value The value.
+  void PutF64(std::ostream &_out, const double _value)
+  {
+    uint64_t bits;
+    std::memcpy(&bits, &_value, sizeof(bits));
+
+    char bytes[8];
+    for (int i = 0; i < 8; ++i)
+      bytes[i] = static_cast<char>((bits >> (8 * i)) & 0xFF);
+    _out.write(bytes, sizeof(bytes));
+  }
+}
+
+namespace gazebo
+{
+  /// \brief A filtered state.
+  class LogStreamState
+  {
+    /// \brief Sim time of the state, for the Hz rate.
+    public: common::Time simTime;
+
+    /// \brief Time stamp of the columns.
+    public: double stamp = 0;
+
+    /// \brief Filtered state, when the output is not in columns.
+    public: std::string text;
+
+    /// \brief Name of each column.
+    public: std::shared_ptr<const std::vector<std::string>> names;
+
+    /// \brief Value of each column.
+    public: std::vector<double> values;
+  };
+
+  /// \brief The filtered states of a chunk.
+  class LogStreamResult
+  {
+    /// \brief False if the chunk could not be decoded.
+    public: bool valid = true;
+
+    /// \brief Number of bytes of the file read up to the end of the chunk.
+    public: uint64_t position = 0;
+
+    /// \brief The world description, which is only in the first chunk.
+    public: std::string world;
+
+    /// \brief The filtered states.
+    public: std::vector<LogStreamState> states;
+
+    /// \brief The filtered states, already encoded as a <chunk> element.
+    public: std::string encoded;
+
+    /// \brief Number of states in the encoded chunk.
+    public: size_t encodedCount = 0;
+  };
+}
+
+/////////////////////////////////////////////////
+void gazebo::EncodeChunk(const std::string &_data,
+    const std::string &_encoding, std::string &_out)
+{
+  if (_encoding == "txt")
+  {
+    _out.append(_data);
+    return;
+  }
+
+  std::string str;
+  {
+    boost::iostreams::filtering_ostream out;
+    if (_encoding == "zlib")
+      out.push(boost::iostreams::zlib_compressor());
+    else if (_encoding == "bz2")
+      out.push(boost::iostreams::bzip2_compressor());
+    out.push(std::back_inserter(str));
+    boost::iostreams::copy(boost::make_iterator_range(_data), out);
+  }
+
+  // Encode in base64.
+  Base64Encode(str.c_str(), str.size(), _out);
+}
+
+/////////////////////////////////////////////////
+bool gazebo::DecodeChunk(const std::string &_data,
+    const std::string &_encoding, std::string &_out)
+{
+  if (_encoding == "txt")
+  {
+    _out = _data;
+    return true;
+  }
+
+  if (_encoding != "zlib" && _encoding != "bz2")
+  {
+    std::cerr << "Invalid chunk encoding[" << _encoding << "]\n";
+    return false;
+  }
+
+  // Decode the base64 string
+  const std::string buffer = Base64Decode(_data);
+
+  _out.clear();
+  try
+  {
+    boost::iostreams::filtering_istream in;
+    if (_encoding == "zlib")
+      in.push(boost::iostreams::zlib_decompressor());
+    else
+      in.push(boost::iostreams::bzip2_decompressor());
+    in.push(boost::make_iterator_range(buffer));
+    boost::iostreams::copy(in, std::back_inserter(_out));
+  }
+  catch(std::exception &_e)
+  {
+    std::cerr << "Unable to decompress a chunk: " << _e.what() << "\n";
+    return false;
+  }
+
+  return true;
+}
+
+/////////////////////////////////////////////////
+bool LogChunkReader::Open(const std::string &_filename)
+{
+  this->file.open(_filename, std::ios::in | std::ios::binary);
+  if (!this->file.is_open())
+  {
+    std::cerr << "Unable to open log file[" << _filename << "]\n";
+    return false;
+  }
+
+  this->file.seekg(0, std::ios::end);
+  this->size = this->file.tellg();
+  this->file.seekg(0, std::ios::beg);
+  this->count = 0;
+
+  // Binary logs are memory mapped, and their blocks are read from the map.
+  if (util::LogBinaryReader::IsBinary(_filename))
+  {
+    this->file.close();
+    if (!this->binaryLog.Open(_filename))
+    {
+      std::cerr << "Unable to open log file[" << _filename << "]\n";
+      return false;
+    }
+    this->binary = true;
+    this->headerXml = this->binaryLog.HeaderXml();
+    this->encoding = util::kLogBinaryEncoding;
+    return true;
+  }
+
+  // Read up to the start tag of the first chunk
+  size_t start = std::string::npos;
+  size_t tagEnd = std::string::npos;
+  while (tagEnd == std::string::npos)
+  {
+    start = this->buffer.find(kChunkStart);
+    if (start != std::string::npos)
+      tagEnd = this->buffer.find('>', start);
+
+    if (tagEnd == std::string::npos && !this->Fill())
+    {
+      std::cerr << "Unable to find the first chunk in log file["
+                << _filename << "]\n";
+      return false;
+    }
+  }
+
+  const std::string endHeader = "</header>";
+  const auto from = this->buffer.find("<header>");
+  const auto to = this->buffer.find(endHeader);
+  if (from == std::string::npos || to == std::string::npos || to > start)
+  {
+    std::cerr << "Unable to find the header of log file["
+              << _filename << "]\n";
+    return false;
+  }
+
+  this->headerXml = this->buffer.substr(from, to + endHeader.size() - from);
+  this->encoding = Attribute(
+      this->buffer.substr(start, tagEnd - start), "encoding");
+  this->pos = start;
+
+  return true;
+}
+
+/////////////////////////////////////////////////
+const std::string &LogChunkReader::HeaderXml() const
+{
+  return this->headerXml;
+}
+
+/////////////////////////////////////////////////
+const std::string &LogChunkReader::Encoding() const
+{
+  return this->encoding;
+}
+
+/////////////////////////////////////////////////
+uint64_t LogChunkReader::Size() const
+{
+  return this->size;
+}
+
+/////////////////////////////////////////////////
+bool LogChunkReader::Fill()
+{
+  if (!this->file.good())
+    return false;
+
+  // Drop what is consumed before reading more
+  this->buffer.erase(0, this->pos);
+  this->bufferOffset += this->pos;
+  this->pos = 0;
+
+  const size_t old = this->buffer.size();
+  this->buffer.resize(old + kReadSize);
+  this->file.read(&this->buffer[old], kReadSize);
+  this->buffer.resize(old + this->file.gcount());
+
+  return this->file.gcount() > 0;
+}
+
+/////////////////////////////////////////////////
+bool LogChunkReader::Next(LogStreamChunk &_chunk)
+{
+  if (this->binary)
+  {
+    const auto &blocks = this->binaryLog.Blocks();
+    if (this->count >= blocks.size())
+      return false;
+
+    _chunk.index = this->count;
+    _chunk.encoding = util::kLogBinaryEncoding;
+    _chunk.data.clear();
+    _chunk.position = this->count + 1 < blocks.size() ?
+        blocks[this->count + 1].offset : this->size;
+    ++this->count;
+    return true;
+  }
+
+  // Offset in the file up to which the end of the chunk was looked for, so
+  // that a large chunk is not searched again after every read.
+  uint64_t scanned = 0;
+
+  size_t start, tagEnd, close;
+  while (true)
+  {
+    close = std::string::npos;
+    tagEnd = std::string::npos;
+    start = this->buffer.find(kChunkStart, this->pos);
+    if (start != std::string::npos)
+      tagEnd = this->buffer.find('>', start);
+    if (tagEnd != std::string::npos)
+    {
+      size_t from = tagEnd;
+      if (scanned > this->bufferOffset)
+        from = std::max<size_t>(from, scanned - this->bufferOffset);
+      close = this->buffer.find(kChunkEnd, from);
+    }
+
+    if (close != std::string::npos)
+      break;
+
+    // The chunk is not complete: keep it, and read more of the file
+    const size_t keep = this->buffer.size() > kChunkEnd.size() ?
+        this->buffer.size() - kChunkEnd.size() : 0;
+    if (start != std::string::npos)
+    {
+      this->pos = start;
+      scanned = this->bufferOffset + std::max(keep, start);
+    }
+    else
+      this->pos = std::max(this->pos, keep);
+
+    if (!this->Fill())
+    {
+      if (start != std::string::npos)
+      {
+        std::cerr << "The log file ends in the middle of a chunk.\n";
+        this->failed = true;
+      }
+      return false;
+    }
+  }
+
+  _chunk.index = this->count++;
+  _chunk.encoding = Attribute(
+      this->buffer.substr(start, tagEnd - start), "encoding");
+
+  // The data is in a CDATA section
+  size_t from = tagEnd + 1;
+  size_t to = close;
+  const auto cdata = this->buffer.find(kCDataStart, from);
+  if (cdata != std::string::npos && cdata < close)
+  {
+    const auto cdataEnd = this->buffer.rfind(kCDataEnd, close);
+    if (cdataEnd != std::string::npos && cdataEnd >= cdata)
+    {
+      from = cdata + kCDataStart.size();
+      to = cdataEnd;
+    }
+  }
+  _chunk.data.assign(this->buffer, from, to - from);
+
+  this->pos = close + kChunkEnd.size();
+  _chunk.position = this->bufferOffset + this->pos;
+
+  return true;
+}
+
+/////////////////////////////////////////////////
+bool LogChunkReader::Failed() const
+{
+  return this->failed;
+}
+
+/////////////////////////////////////////////////
+bool LogChunkReader::Decode(const LogStreamChunk &_chunk,
+    std::string &_data) const
+{
+  if (_chunk.encoding == util::kLogBinaryEncoding)
+    return this->binary && this->binaryLog.Data(_chunk.index, _data);
+
+  if (_chunk.encoding.empty())
+  {
+    std::cerr << "Encoding missing for chunk[" << _chunk.index << "]\n";
+    return false;
+  }
+
+  return DecodeChunk(_chunk.data, _chunk.encoding, _data);
+}
+
+/////////////////////////////////////////////////
+bool ColumnFilter::Init(const std::string &_filter)
+{
+  this->allModels = true;
+  this->modelElements.clear();
+  this->hasLinks = false;
+  this->allLinks = true;
+  this->hasJoints = false;
+  this->jointAxes.clear();
+
+  std::vector<std::string> mainParts;
+  boost::split(mainParts, _filter, boost::is_any_of("/"));
+
+  // Model filter
+  std::vector<std::string> parts;
+  boost::split(parts, mainParts[0], boost::is_any_of("."));
+  this->allModels = parts[0].empty() || parts[0] == "*";
+  if (!this->allModels && !NameRegex(parts[0], this->modelRegex))
+    return false;
+
+  if (parts.size() > 1)
+  {
+    // Currently a model can only have a pose.
+    if (parts[1] == "pose")
+      this->modelElements = PoseElements(parts.size() > 2 ? parts[2] : "");
+    else
+      std::cerr << "Invalid model state component[" << parts[1] << "]\n";
+  }
+
+  // Link filter
+  if (mainParts.size() > 1 && !mainParts[1].empty())
+  {
+    boost::split(parts, mainParts[1], boost::is_any_of("."));
+    this->hasLinks = true;
+    this->allLinks = parts[0].empty() || parts[0] == "*";
+    if (!this->allLinks && !NameRegex(parts[0], this->linkRegex))
+      return false;
+
+    this->linkField = parts.size() > 1 ? parts[1] : "pose";
+    if (this->linkField != "pose" && this->linkField != "velocity" &&
+        this->linkField != "acceleration" && this->linkField != "wrench")
+    {
+      std::cerr << "Invalid link state component[" << this->linkField
+                << "]\n";
+      this->hasLinks = false;
+    }
+    this->linkElements = PoseElements(parts.size() > 2 ? parts[2] : "");
+  }
+
+  // Joint filter
+  if (mainParts.size() > 2 && !mainParts[2].empty())
+  {
+    boost::split(parts, mainParts[2], boost::is_any_of("."));
+    this->hasJoints = true;
+    if (!NameRegex(parts[0].empty() ? "*" : parts[0], this->jointRegex))
+      return false;
+
+    if (parts.size() > 1)
+    {
+      std::string axes = parts[1];
+      boost::erase_all(axes, "[");
+      boost::erase_all(axes, "]");
+
+      std::vector<std::string> elements;
+      boost::split(elements, axes, boost::is_any_of(","));
+      for (auto const &element : elements)
+      {
+        try
+        {
+          this->jointAxes.push_back(
+              boost::lexical_cast<unsigned int>(element));
+        }
+        catch(...)
+        {
+          std::cerr << "Invalid axis value[" << element << "]\n";
+        }
+      }
+    }
+  }
+
+  // Without a link or joint filter, the pose of the models is output.
+  if (this->modelElements.empty() && !this->hasLinks && !this->hasJoints)
+    this->modelElements = PoseElements("");
+
+  return true;
+}
+
+/////////////////////////////////////////////////
+std::string ColumnFilter::PoseElements(std::string _elements)
+{
+  // Remove brackets, if they exist
+  boost::erase_all(_elements, "[");
+  boost::erase_all(_elements, "]");
+  if (_elements.empty())
+    return "xyzrpa";
+
+  std::vector<std::string> elements;
+  boost::split(elements, _elements, boost::is_any_of(","));
+
+  std::string result;
+  for (auto const &element : elements)
+  {
+    const char c = element.empty() ? '\0' : std::tolower(element[0]);
+    if (element.size() == 1 && std::strchr("xyzrpa", c))
+      result += c;
+    else
+      std::cerr << "Invalid pose value[" << element << "]\n";
+  }
+
+  return result;
+}
+
+/////////////////////////////////////////////////
+void ColumnFilter::Pose(const ignition::math::Pose3d &_pose,
+    const std::string &_prefix, const std::string &_elements,
+    std::vector<std::string> &_names, std::vector<double> &_values)
+{
+  const ignition::math::Vector3d rpy = _pose.Rot().Euler();
+  for (const char c : _elements)
+  {
+    _names.push_back(_prefix + c);
+    switch (c)
+    {
+      case 'x':
+        _values.push_back(_pose.Pos().X());
+        break;
+      case 'y':
+        _values.push_back(_pose.Pos().Y());
+        break;
+      case 'z':
+        _values.push_back(_pose.Pos().Z());
+        break;
+      case 'r':
+        _values.push_back(rpy.X());
+        break;
+      case 'p':
+        _values.push_back(rpy.Y());
+        break;
+      default:
+        _values.push_back(rpy.Z());
+        break;
+    }
+  }
+}
+
+/////////////////////////////////////////////////
+void ColumnFilter::Filter(const physics::WorldState &_state,
+    std::vector<std::string> &_names, std::vector<double> &_values) const
+{
+  _names.clear();
+  _values.clear();
+
+  for (auto const &model : _state.GetModelStates())
+  {
+    if (!this->allModels && !boost::regex_match(model.first, this->modelRegex))
+      continue;
+
+    if (!this->modelElements.empty())
+    {
+      Pose(model.second.Pose(), model.first + ".pose.", this->modelElements,
+          _names, _values);
+    }
+
+    if (this->hasLinks)
+    {
+      for (auto const &link : model.second.GetLinkStates())
+      {
+        const std::string name = link.second.GetName();
+        if (!this->allLinks && !boost::regex_match(name, this->linkRegex))
+          continue;
+
+        const std::string prefix =
+            model.first + "::" + name + "." + this->linkField + ".";
+        if (this->linkField == "pose")
+        {
+          Pose(link.second.Pose(), prefix, this->linkElements,
+              _names, _values);
+        }
+        else if (this->linkField == "velocity")
+        {
+          Pose(link.second.Velocity(), prefix, this->linkElements,
+              _names, _values);
+        }
+        else if (this->linkField == "acceleration")
+        {
+          Pose(link.second.Acceleration(), prefix, this->linkElements,
+              _names, _values);
+        }
+        else
+        {
+          Pose(link.second.Wrench(), prefix, this->linkElements,
+              _names, _values);
+        }
+      }
+    }
+
+    if (this->hasJoints)
+    {
+      for (auto const &joint : model.second.GetJointStates())
+      {
+        const std::string name = joint.second.GetName();
+        if (!boost::regex_match(name, this->jointRegex))
+          continue;
+
+        const std::string prefix = model.first + "::" + name + ".";
+        const unsigned int count = joint.second.GetAngleCount();
+        if (this->jointAxes.empty())
+        {
+          for (unsigned int axis = 0; axis < count; ++axis)
+          {
+            _names.push_back(prefix + std::to_string(axis));
+            _values.push_back(joint.second.Position(axis));
+          }
+        }
+        else
+        {
+          for (const unsigned int axis : this->jointAxes)
+          {
+            if (axis >= count)
+              continue;
+            _names.push_back(prefix + std::to_string(axis));
+            _values.push_back(joint.second.Position(axis));
+          }
+        }
+      }
+    }
+  }
+}
+
+/////////////////////////////////////////////////
+LogStream::LogStream(const std::string &_filter, const bool _raw,
+    const std::string &_stamp, const double _hz)
+  : filter(_filter), raw(_raw), stamp(_stamp), hz(_hz)
+{
+}
+
+/////////////////////////////////////////////////
+void LogStream::SetThreads(const unsigned int _threads)
+{
+  this->threads = _threads;
+}
+
+/////////////////////////////////////////////////
+bool LogStream::SetColumns(const std::string &_format)
+{
+  if (_format != "csv" && _format != "bin")
+  {
+    std::cerr << "Invalid column format[" << _format << "]. "
+      << "Use one of: csv, bin.\n";
+    return false;
+  }
+
+  if (!this->columnFilter.Init(this->filter))
+    return false;
+
+  this->columns = _format;
+  return true;
+}
+
+/////////////////////////////////////////////////
+void LogStream::SetProgress(const bool _progress)
+{
+  this->progress = _progress;
+}
+
+/////////////////////////////////////////////////
+bool LogStream::Run(const std::string &_filename, std::ostream &_out,
+    const std::string &_encoding)
+{
+  LogChunkReader reader;
+  if (!reader.Open(_filename))
+    return false;
+
+  this->encoding = _encoding.empty() ? reader.Encoding() : _encoding;
+  const bool binaryOut = this->encoding == util::kLogBinaryEncoding;
+  const bool xmlOut = !this->raw && this->columns.empty();
+  if (xmlOut && this->encoding != "txt" && this->encoding != "zlib" &&
+      this->encoding != "bz2" && !binaryOut)
+  {
+    std::cerr << "Invalid log file encoding[" << this->encoding << "]. "
+      << "Use one of: txt, bz2, zlib, bin.\n";
+    return false;
+  }
+
+  this->size = reader.Size();
+  this->stateCount = 0;
+  this->prevTime = common::Time::Zero;
+  this->layout.reset();
+  this->layoutIndex.clear();
+  this->layoutWarned = false;
+  this->startTime = this->reportTime = common::Time::GetWallTime();
+
+  // Output the header
+  if (xmlOut && binaryOut)
+  {
+    std::string buffer;
+    this->binaryWriter.Start(reader.HeaderXml() + "\n", buffer);
+    _out.write(buffer.c_str(), buffer.size());
+  }
+  else if (xmlOut)
+  {
+    _out << "<?xml version='1.0'?>\n<gazebo_log>\n"
+         << reader.HeaderXml() << "\n";
+  }
+
+  unsigned int threadCount = this->threads;
+  if (threadCount == 0)
+    threadCount = std::max(1u, std::thread::hardware_concurrency());
+
+  // Each worker has its own filter, created here because loading the
+  // state description is not thread safe.
+  std::vector<std::unique_ptr<StateFilter>> filters;
+  for (unsigned int i = 0; i < threadCount; ++i)
+  {
+    filters.emplace_back(new StateFilter(xmlOut, this->stamp));
+    filters.back()->Init(this->filter);
+  }
+
+  // Chunks read and not written yet are bounded, so that the memory used
+  // does not depend on the size of the log.
+  const size_t window = 4 * threadCount;
+
+  std::mutex mutex;
+  std::condition_variable cond;
+  std::deque<LogStreamChunk> pending;
+  std::map<size_t, LogStreamResult> done;
+  size_t read = 0;
+  size_t written = 0;
+  bool eof = false;
+  bool stop = false;
+
+  std::thread readThread([&]()
+  {
+    LogStreamChunk chunk;
+    while (reader.Next(chunk))
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      cond.wait(lock, [&] {return stop || read - written < window;});
+      if (stop)
+        break;
+
+      ++read;
+      pending.push_back(std::move(chunk));
+      cond.notify_all();
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    eof = true;
+    cond.notify_all();
+  });
+
+  std::vector<std::thread> workers;
+  for (unsigned int i = 0; i < threadCount; ++i)
+  {
+    StateFilter *stateFilter = filters[i].get();
+    workers.push_back(std::thread([&, stateFilter]()
+    {
+      std::shared_ptr<const std::vector<std::string>> names;
+      while (true)
+      {
+        LogStreamChunk chunk;
+        {
+          std::unique_lock<std::mutex> lock(mutex);
+          cond.wait(lock, [&] {return stop || eof || !pending.empty();});
+          if (stop || pending.empty())
+            return;
+
+          chunk = std::move(pending.front());
+          pending.pop_front();
+        }
+
+        LogStreamResult result;
+        this->Process(reader, chunk, *stateFilter, names, result);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        done[chunk.index] = std::move(result);
+        cond.notify_all();
+      }
+    }));
+  }
+
+  // Write the chunks in the order of the log
+  bool success = true;
+  while (true)
+  {
+    LogStreamResult result;
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      cond.wait(lock, [&]
+          {return done.count(written) > 0 || (eof && written == read);});
+
+      auto iter = done.find(written);
+      if (iter == done.end())
+        break;
+
+      result = std::move(iter->second);
+      done.erase(iter);
+    }
+
+    const bool ok = this->Write(result, _out);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    ++written;
+    if (!ok)
+    {
+      stop = true;
+      success = false;
+    }
+    cond.notify_all();
+    if (!ok)
+      break;
+  }
+
+  readThread.join();
+  for (auto &worker : workers)
+    worker.join();
+
+  // A truncated log is an error, even though its complete chunks were
+  // output
+  if (!success || reader.Failed())
+    return false;
+
+  if (xmlOut && binaryOut)
+  {
+    std::string index;
+    this->binaryWriter.Finish(index);
+    _out.write(index.c_str(), index.size());
+  }
+  else if (xmlOut)
+    _out << "</gazebo_log>\n";
+
+  _out.flush();
+  if (this->progress)
+    this->Report(this->size, true);
+
+  return _out.good();
+}
+
+/////////////////////////////////////////////////
+void LogStream::Process(const LogChunkReader &_reader,
+    const LogStreamChunk &_chunk, StateFilter &_filter,
+    std::shared_ptr<const std::vector<std::string>> &_names,
+    LogStreamResult &_result) const
+{
+  _result.position = _chunk.position;
+
+  std::string data;
+  if (!_reader.Decode(_chunk, data))
+  {
+    _result.valid = false;
+    return;
+  }
+
+  const bool xmlOut = !this->raw && this->columns.empty();
+  bool first = _chunk.index == 0;
+  std::vector<std::string> names;
+
+  size_t end = 0;
+  while (true)
+  {
+    const auto from = data.find(kStartFrame, end);
+    if (from == std::string::npos)
+      break;
+    const auto to = data.find(kEndFrame, from);
+    if (to == std::string::npos)
+      break;
+    end = to + kEndFrame.size();
+
+    const std::string frame = data.substr(from, end - from);
+
+    // The first state of the log is the world description, which is only
+    // output in a log file, and without filtering.
+    if (first)
+    {
+      first = false;
+      if (xmlOut)
+        _result.world = frame;
+      continue;
+    }
+
+    physics::WorldState worldState;
+    _filter.Load(frame, worldState);
+
+    LogStreamState state;
+    state.simTime = worldState.GetSimTime();
+    if (this->columns.empty())
+      state.text = _filter.Filter(worldState);
+    else
+    {
+      state.stamp = Stamp(worldState, this->stamp);
+      this->columnFilter.Filter(worldState, names, state.values);
+
+      // States with the same columns share the names
+      if (!_names || *_names != names)
+        _names = std::make_shared<const std::vector<std::string>>(names);
+      state.names = _names;
+    }
+
+    _result.states.push_back(std::move(state));
+  }
+
+  // Without a Hz rate every state is output, so the chunk of the output log
+  // is encoded here rather than on the writing thread.
+  if (xmlOut && this->hz <= 0.0 &&
+      this->encoding != util::kLogBinaryEncoding)
+  {
+    std::string text;
+    for (auto const &state : _result.states)
+      text += state.text;
+
+    if (!text.empty())
+      _result.encoded = ChunkXml(text, this->encoding);
+    _result.encodedCount = _result.states.size();
+    _result.states.clear();
+  }
+}
+
+/////////////////////////////////////////////////
+bool LogStream::Write(LogStreamResult &_result, std::ostream &_out)
+{
+  if (!_result.valid)
+  {
+    std::cerr << "Unable to decode a chunk of the log file.\n";
+    return false;
+  }
+
+  const bool binaryOut = this->encoding == util::kLogBinaryEncoding;
+  const bool xmlOut = !this->raw && this->columns.empty();
+
+  if (!_result.world.empty())
+  {
+    std::string buffer;
+    if (binaryOut)
+      this->binaryWriter.AppendBlock(_result.world, buffer);
+    else
+      buffer = ChunkXml(_result.world, this->encoding);
+    _out.write(buffer.c_str(), buffer.size());
+  }
+
+  _out.write(_result.encoded.c_str(), _result.encoded.size());
+  this->stateCount += _result.encodedCount;
+
+  std::string text;
+  for (auto const &state : _result.states)
+  {
+    // Same Hz rate as StateFilter
+    if (this->hz > 0.0 && this->prevTime != common::Time::Zero &&
+        (state.simTime - this->prevTime).Double() < 1.0 / this->hz)
+    {
+      continue;
+    }
+    this->prevTime = state.simTime;
+    ++this->stateCount;
+
+    if (this->columns.empty())
+      text += state.text;
+    else
+      this->WriteRow(state, _out);
+  }
+
+  if (!text.empty())
+  {
+    if (!xmlOut)
+      _out.write(text.c_str(), text.size());
+    else if (binaryOut)
+    {
+      std::string buffer;
+      this->binaryWriter.AppendBlock(text, buffer);
+      _out.write(buffer.c_str(), buffer.size());
+    }
+    else
+    {
+      const std::string buffer = ChunkXml(text, this->encoding);
+      _out.write(buffer.c_str(), buffer.size());
+    }
+  }
+
+  if (this->progress)
+    this->Report(_result.position, false);
+
+  return _out.good();
+}
+
+/////////////////////////////////////////////////
+void LogStream::WriteRow(const LogStreamState &_state, std::ostream &_out)
+{
+  const bool csv = this->columns == "csv";
+
+  // The columns of the first state are output
+  if (!this->layout)
+  {
+    this->layout = _state.names;
+    for (size_t i = 0; i < this->layout->size(); ++i)
+      this->layoutIndex[(*this->layout)[i]] = i;
+
+    const std::string stampName = StampName(this->stamp);
+    if (csv)
+    {
+      _out << stampName;
+      for (auto const &name : *this->layout)
+        _out << "," << name;
+      _out << "\n";
+    }
+    else
+    {
+      _out.write("GZLOGCOL", 8);
+      PutU32(_out, 1);
+      PutU32(_out, static_cast<uint32_t>(this->layout->size() + 1));
+      PutU32(_out, static_cast<uint32_t>(stampName.size()));
+      _out.write(stampName.c_str(), stampName.size());
+      for (auto const &name : *this->layout)
+      {
+        PutU32(_out, static_cast<uint32_t>(name.size()));
+        _out.write(name.c_str(), name.size());
+      }
+    }
+  }
+
+  // Entities that appear or disappear change the columns of a state, which
+  // are then matched by name.
+  const std::vector<double> *values = &_state.values;
+  if (_state.names != this->layout && *_state.names != *this->layout)
+  {
+    this->row.assign(this->layout->size(),
+        std::numeric_limits<double>::quiet_NaN());
+    for (size_t i = 0; i < _state.names->size(); ++i)
+    {
+      auto iter = this->layoutIndex.find((*_state.names)[i]);
+      if (iter != this->layoutIndex.end())
+        this->row[iter->second] = _state.values[i];
+      else if (!this->layoutWarned)
+      {
+        std::cerr << "Column[" << (*_state.names)[i] << "] is not in the "
+                  << "first state, and is not output.\n";
+        this->layoutWarned = true;
+      }
+    }
+    values = &this->row;
+  }
+
+  if (csv)
+  {
+    char number[32];
+    std::string line;
+    snprintf(number, sizeof(number), "%.17g", _state.stamp);
+    line += number;
+    for (const double value : *values)
+    {
+      snprintf(number, sizeof(number), ",%.17g", value);
+      line += number;
+    }
+    line += "\n";
+    _out.write(line.c_str(), line.size());
+  }
+  else
+  {
+    PutF64(_out, _state.stamp);
+    for (const double value : *values)
+      PutF64(_out, value);
+  }
+}
+
+/////////////////////////////////////////////////
+void LogStream::Report(const uint64_t _position, const bool _done)
+{
+  const common::Time now = common::Time::GetWallTime();
+  if (!_done && (now - this->reportTime).Double() < 1.0)
+    return;
+  this->reportTime = now;
+
+  const double elapsed = std::max((now - this->startTime).Double(), 1e-6);
+  const double megabytes = _position / 1.0e6;
+
+  std::ostringstream stream;
+  stream.setf(std::ios::fixed);
+  stream.precision(1);
+  stream << "\r" << megabytes << " of " << this->size / 1.0e6 << " MB";
+  if (this->size > 0)
+    stream << " (" << 100.0 * _position / this->size << "%)";
+  stream << ", " << megabytes / elapsed << " MB/s, "
+         << this->stateCount / elapsed << " states/s";
+  if (_done)
+    stream << ", " << this->stateCount << " states in " << elapsed << " s\n";
+
+  std::cerr << stream.str() << std::flush;
+}
@@ -0,0 +1,361 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#ifndef GAZEBO_TOOLS_GZLOGSTREAM_HH_
+#define GAZEBO_TOOLS_GZLOGSTREAM_HH_
+
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <boost/regex.hpp>
+
+#include <gazebo/physics/WorldState.hh>
+#include "gazebo/util/LogBinary.hh"
+#include "gz_log.hh"
+
+namespace gazebo
+{
+  class LogStreamResult;
+  class LogStreamState;
+
+  /// \brief Encode data as the content of a <chunk> element.
+  /// \param[in] _data The data to encode.
+  /// \param[in] _encoding Encoding of the chunk: txt, zlib or bz2.
+  /// \param[out] _out The encoded data is appended to this string.
+  void EncodeChunk(const std::string &_data, const std::string &_encoding,
+      std::string &_out);
+
+  /// \brief Decode the content of a <chunk> element.
+  /// \param[in] _data The content of the chunk.
+  /// \param[in] _encoding Encoding of the chunk: txt, zlib or bz2.
+  /// \param[out] _out The decoded data.
+  /// \return True on success.
+  bool DecodeChunk(const std::string &_data, const std::string &_encoding,
+      std::string &_out);
+
+  /// \brief A chunk of a log file, as it is stored in the file.
+  class LogStreamChunk
+  {
+    /// \brief Index of the chunk in the file.
+    public: size_t index = 0;
+
+    /// \brief Encoding of the chunk.
+    public: std::string encoding;
+
+    /// \brief Encoded content of the chunk. Empty for the blocks of a
+    /// binary log, which are read from the mapped file.
+    public: std::string data;
+
+    /// \brief Number of bytes of the file read up to the end of the chunk.
+    public: uint64_t position = 0;
+  };
+
+  /// \brief Reads the chunks of a log file one at a time. Unlike
+  /// util::LogPlay, the file is never loaded whole, so the memory used does
+  /// not grow with the size of the log.
+  class LogChunkReader
+  {
+    /// \brief Open a log file, and read its header.
+    /// \param[in] _filename Path to the log file.
+    /// \return True on success.
+    public: bool Open(const std::string &_filename);
+
+    /// \brief Get the <header> element of the log.
+    /// \return The header xml.
+    public: const std::string &HeaderXml() const;
+
+    /// \brief Get the encoding of the first chunk of the log.
+    /// \return The encoding: txt, zlib, bz2 or bin.
+    public: const std::string &Encoding() const;
+
+    /// \brief Get the size of the file.
+    /// \return Size in bytes.
+    public: uint64_t Size() const;
+
+    /// \brief Read the next chunk. The chunk is not decoded, so that
+    /// the chunks can be decoded on other threads.
+    /// \param[out] _chunk The chunk.
+    /// \return False at the end of the file, or on error.
+    /// \sa Failed
+    public: bool Next(LogStreamChunk &_chunk);
+
+    /// \brief Get whether Next stopped on an error, such as a log file
+    /// that ends in the middle of a chunk, rather than at the end of the
+    /// log.
+    /// \return True on error.
+    public: bool Failed() const;
+
+    /// \brief Decode a chunk returned by Next. This is safe to call from
+    /// several threads, and while Next is called.
+    /// \param[in] _chunk The chunk.
+    /// \param[out] _data The states of the chunk.
+    /// \return True on success.
+    public: bool Decode(const LogStreamChunk &_chunk,
+                std::string &_data) const;
+
+    /// \brief Read more of the file into the buffer.
+    /// \return False if the end of the file was reached.
+    private: bool Fill();
+
+    /// \brief Number of bytes read from the file at once.
+    private: static const size_t kReadSize = 4 * 1024 * 1024;
+
+    /// \brief The XML log file.
+    private: std::ifstream file;
+
+    /// \brief The part of the XML log that is read.
+    private: std::string buffer;
+
+    /// \brief Offset in the buffer of the first byte not consumed.
+    private: size_t pos = 0;
+
+    /// \brief Offset in the file of the start of the buffer.
+    private: uint64_t bufferOffset = 0;
+
+    /// \brief The <header> element of the log.
+    private: std::string headerXml;
+
+    /// \brief Encoding of the first chunk.
+    private: std::string encoding;
+
+    /// \brief Size of the file.
+    private: uint64_t size = 0;
+
+    /// \brief Number of chunks read.
+    private: size_t count = 0;
+
+    /// \brief True if Next stopped on an error.
+    private: bool failed = false;
+
+    /// \brief True if the log is binary.
+    private: bool binary = false;
+
+    /// \brief The binary log.
+    private: gazebo::util::LogBinaryReader binaryLog;
+  };
+
+  /// \brief Extracts the numeric fields selected by a filter string from
+  /// world states. The filter string has the syntax of the --filter
+  /// option: model[.pose[.x,y,...]][/link[.field[.x,y,...]]][/joint[.axes]]
+  /// where the field of a link is one of pose, velocity, acceleration or
+  /// wrench. Each field gives a column, named after the scoped name of its
+  /// entity, for example "pr2::base_link.pose.x".
+  class ColumnFilter
+  {
+    /// \brief Initialize the filter.
+    /// \param[in] _filter The command line filter string.
+    /// \return False if a name expression of the filter is not valid.
+    public: bool Init(const std::string &_filter);
+
+    /// \brief Extract the selected fields of a state. This does not change
+    /// the filter, so that several threads can share it.
+    /// \param[in] _state The state.
+    /// \param[out] _names Name of each column.
+    /// \param[out] _values Value of each column.
+    public: void Filter(const gazebo::physics::WorldState &_state,
+                std::vector<std::string> &_names,
+                std::vector<double> &_values) const;
+
+    /// \brief Parse a list of pose elements.
+    /// \param[in] _elements Comma separated elements, such as "[x,y]".
+    /// \return The valid elements, in lower case, or "xyzrpa" if the list
+    /// is empty.
+    private: static std::string PoseElements(std::string _elements);
+
+    /// \brief Add the columns of a pose.
+    /// \param[in] _pose The pose.
+    /// \param[in] _prefix Prefix of the column names.
+    /// \param[in] _elements Elements of the pose to add.
+    /// \param[out] _names Name of each column.
+    /// \param[out] _values Value of each column.
+    private: static void Pose(const ignition::math::Pose3d &_pose,
+                 const std::string &_prefix, const std::string &_elements,
+                 std::vector<std::string> &_names,
+                 std::vector<double> &_values);
+
+    /// \brief True to add the columns of every model.
+    private: bool allModels = true;
+
+    /// \brief Model name expression.
+    private: boost::regex modelRegex;
+
+    /// \brief Pose elements of the models, empty for none.
+    private: std::string modelElements;
+
+    /// \brief True if there is a link filter.
+    private: bool hasLinks = false;
+
+    /// \brief True to add the columns of every link.
+    private: bool allLinks = true;
+
+    /// \brief Link name expression.
+    private: boost::regex linkRegex;
+
+    /// \brief Field of the links: pose, velocity, acceleration or wrench.
+    private: std::string linkField;
+
+    /// \brief Elements of the link field.
+    private: std::string linkElements;
+
+    /// \brief True if there is a joint filter.
+    private: bool hasJoints = false;
+
+    /// \brief Joint name expression.
+    private: boost::regex jointRegex;
+
+    /// \brief Axes of the joints, empty for all of them.
+    private: std::vector<unsigned int> jointAxes;
+  };
+
+  /// \brief Filters a log file on a pool of worker threads. The file is
+  /// read one chunk at a time, the chunks are decoded and filtered by the
+  /// workers, and the results are written in the order of the log. The
+  /// number of chunks in flight is bounded, so the memory used does not
+  /// depend on the size of the log.
+  class LogStream
+  {
+    /// \brief Constructor.
+    /// \param[in] _filter The command line filter string.
+    /// \param[in] _raw True to output data without xml formatting.
+    /// \param[in] _stamp Type of stamp to apply.
+    /// Valid values are (sim,real,wall,iterations)
+    /// \param[in] _hz Hertz rate.
+    public: LogStream(const std::string &_filter, const bool _raw,
+                const std::string &_stamp, const double _hz);
+
+    /// \brief Set the number of worker threads.
+    /// \param[in] _threads Number of threads, zero to use one per core.
+    public: void SetThreads(const unsigned int _threads);
+
+    /// \brief Output the selected fields as columns, instead of states.
+    /// \param[in] _format Either "csv" for comma separated values, or "bin"
+    /// for a binary table. The binary table starts with the 8 characters
+    /// "GZLOGCOL", followed by the version and the number of columns as
+    /// 32 bit integers, then the length and characters of the name of each
+    /// column. Each row follows as one 64 bit float per column. All the
+    /// numbers are little endian. The first column is the time stamp.
+    /// \return False if the format or the filter is not valid.
+    public: bool SetColumns(const std::string &_format);
+
+    /// \brief Report the progress and the throughput on the standard
+    /// error.
+    /// \param[in] _progress True to report the progress.
+    public: void SetProgress(const bool _progress);
+
+    /// \brief Filter a log file.
+    /// \param[in] _filename Path to the log file.
+    /// \param[in] _out Output stream.
+    /// \param[in] _encoding Encoding of the output log (txt, zlib, bz2 or
+    /// bin). If empty, the encoding of the source log file is used. Not
+    /// used for raw and column output.
+    /// \return True on success.
+    public: bool Run(const std::string &_filename, std::ostream &_out,
+                const std::string &_encoding);
+
+    /// \brief Filter a chunk of the log. This runs on a worker thread.
+    /// \param[in] _reader The log reader.
+    /// \param[in] _chunk The chunk.
+    /// \param[in] _filter Filter of the worker.
+    /// \param[in,out] _names Column names of the last state filtered by
+    /// the worker, shared by the states that have the same columns.
+    /// \param[out] _result The filtered states.
+    private: void Process(const LogChunkReader &_reader,
+                 const LogStreamChunk &_chunk, StateFilter &_filter,
+                 std::shared_ptr<const std::vector<std::string>> &_names,
+                 LogStreamResult &_result) const;
+
+    /// \brief Write the states of a chunk. This runs on the calling
+    /// thread, in the order of the log.
+    /// \param[in] _result The filtered states.
+    /// \param[in] _out Output stream.
+    /// \return True on success.
+    private: bool Write(LogStreamResult &_result, std::ostream &_out);
+
+    /// \brief Write a row of columns.
+    /// \param[in] _state The state that holds the columns.
+    /// \param[in] _out Output stream.
+    private: void WriteRow(const LogStreamState &_state,
+                 std::ostream &_out);
+
+    /// \brief Report the progress.
+    /// \param[in] _position Number of bytes of the log processed.
+    /// \param[in] _done True once the whole log is processed.
+    private: void Report(const uint64_t _position, const bool _done);
+
+    /// \brief The command line filter string.
+    private: std::string filter;
+
+    /// \brief True to output data without xml formatting.
+    private: bool raw;
+
+    /// \brief Type of stamp to apply.
+    private: std::string stamp;
+
+    /// \brief Hertz rate.
+    private: double hz;
+
+    /// \brief Previous sim time a state was output, for the Hz rate.
+    private: gazebo::common::Time prevTime;
+
+    /// \brief Number of worker threads.
+    private: unsigned int threads = 0;
+
+    /// \brief Column format, empty to output states.
+    private: std::string columns;
+
+    /// \brief Extracts the columns.
+    private: ColumnFilter columnFilter;
+
+    /// \brief Column names, set by the first state.
+    private: std::shared_ptr<const std::vector<std::string>> layout;
+
+    /// \brief Index of each column name.
+    private: std::unordered_map<std::string, size_t> layoutIndex;
+
+    /// \brief True once a state with a column that is not in the layout
+    /// was reported.
+    private: bool layoutWarned = false;
+
+    /// \brief Row of values, reused.
+    private: std::vector<double> row;
+
+    /// \brief Encoding of the output log.
+    private: std::string encoding;
+
+    /// \brief Produces the blocks and index of a binary output log.
+    private: gazebo::util::LogBinaryWriter binaryWriter;
+
+    /// \brief True to report the progress.
+    private: bool progress = false;
+
+    /// \brief Size of the log file.
+    private: uint64_t size = 0;
+
+    /// \brief Number of states output.
+    private: uint64_t stateCount = 0;
+
+    /// \brief Wall time when Run started.
+    private: gazebo::common::Time startTime;
+
+    /// \brief Wall time of the last progress report.
+    private: gazebo::common::Time reportTime;
+  };
+}
+#endif